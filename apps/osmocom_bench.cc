@@ -0,0 +1,393 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Soak benchmark of a device, for qualifying a host, USB controller and
+ * radio combination at sustained rates.
+ *
+ * A source is streamed into null sinks, a sink is fed from null sources,
+ * at every sample rate given (all rates the device lists by default) and
+ * for every variant of extra device arguments given, e.g. buffers= or
+ * latency_ms= settings. After a warm up, each point is measured for the
+ * given duration from get_stream_stats() and the process CPU time, and one
+ * CSV row per channel is written:
+ *
+ *  args,rate,chan,seconds,samples,msps,overflows,dropped,underruns,
+ *  high_water,lat_p50_us,lat_p90_us,lat_p99_us,lat_p999_us,lat_max_us,
+ *  cpu_pct,cpu_pct_per_msps
+ *
+ * msps is the sustained throughput of the channel, the latency columns
+ * are the upper bounds of the histogram buckets of latency=1 holding the
+ * percentiles (empty without them), cpu_pct is the CPU time of the whole
+ * process in percent of one core, cpu_pct_per_msps that per MS/s of all
+ * channels.
+ *
+ * usage: osmocom_bench --source=ARGS | --sink=ARGS [--rates=R[,R...]]
+ *                      [--extra=ARGS]... [--seconds=10] [--warmup=2]
+ *                      [--freq=F] [--csv=path]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/null_sink.h>
+#include <gnuradio/blocks/null_source.h>
+
+#include <osmosdr/source.h>
+#include <osmosdr/sink.h>
+
+static std::atomic<bool> g_stop( false );
+
+static void on_signal( int )
+{
+  g_stop = true;
+}
+
+static void usage( const char *prog )
+{
+  std::cerr << "usage: " << prog << " --source=ARGS | --sink=ARGS"
+            << " [--rates=R[,R...]] [--extra=ARGS]... [--seconds=10]"
+            << " [--warmup=2] [--freq=F] [--csv=path]" << std::endl;
+}
+
+/* sleep for secs, or until interrupted, returns false if interrupted */
+static bool wait_for( double secs )
+{
+  const std::chrono::steady_clock::time_point until =
+    std::chrono::steady_clock::now() +
+    std::chrono::duration_cast< std::chrono::steady_clock::duration >(
+      std::chrono::duration< double >( secs ) );
+
+  while ( ! g_stop && std::chrono::steady_clock::now() < until )
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+
+  return ! g_stop;
+}
+
+/* CPU time of the process, user and system, in seconds */
+static double cpu_seconds()
+{
+  struct rusage ru;
+  if ( getrusage( RUSAGE_SELF, &ru ) != 0 )
+    return 0;
+
+  return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+         ( ru.ru_utime.tv_usec + ru.ru_stime.tv_usec ) * 1e-6;
+}
+
+static std::vector< double > parse_rates( const std::string &list )
+{
+  std::vector< double > rates;
+  std::stringstream ss( list );
+  std::string item;
+
+  while ( std::getline( ss, item, ',' ) )
+    if ( item.size() )
+      rates.push_back( atof( item.c_str() ) );
+
+  return rates;
+}
+
+/* quote a device argument string for a CSV field */
+static std::string csv_quote( const std::string &s )
+{
+  std::string out = "\"";
+  for ( char c : s ) {
+    if ( '"' == c )
+      out += '"';
+    out += c;
+  }
+  return out + "\"";
+}
+
+/*
+ * Upper bound in us of the stream_stats_t::latency_us bucket holding the
+ * given fraction of the counts, or -1 without counts.
+ */
+static double percentile( const std::vector< uint64_t > &hist, double p )
+{
+  uint64_t total = 0;
+  for ( uint64_t n : hist )
+    total += n;
+
+  if ( ! total )
+    return -1;
+
+  const uint64_t want = std::max< uint64_t >( uint64_t( p * total + 0.5 ), 1 );
+  uint64_t seen = 0;
+
+  for ( size_t i = 0; i < hist.size(); i++ ) {
+    seen += hist[i];
+    if ( seen >= want )
+      return double( uint64_t(1) << ( i + 1 ) );
+  }
+
+  return double( uint64_t(1) << hist.size() );
+}
+
+static std::string latency_field( double us )
+{
+  if ( us < 0 )
+    return "";
+
+  std::ostringstream ss;
+  ss << us;
+  return ss.str();
+}
+
+/* the device of one sweep, with the flowgraph around it */
+class bench_device
+{
+public:
+  bench_device( bool sink, const std::string &args, double freq ) :
+    _tb( gr::make_top_block( "osmocom_bench" ) )
+  {
+    if ( sink ) {
+      _sink = osmosdr::sink::make( args );
+      _nchan = _sink->get_num_channels();
+      if ( freq > 0 )
+        _sink->set_center_freq( freq );
+
+      for ( size_t chan = 0; chan < _nchan; chan++ )
+        _tb->connect( gr::blocks::null_source::make( sizeof(gr_complex) ), 0,
+                      _sink, chan );
+    } else {
+      _source = osmosdr::source::make( args );
+      _nchan = _source->get_num_channels();
+      if ( freq > 0 )
+        _source->set_center_freq( freq );
+
+      for ( size_t chan = 0; chan < _nchan; chan++ )
+        _tb->connect( _source, chan,
+                      gr::blocks::null_sink::make( sizeof(gr_complex) ), 0 );
+    }
+  }
+
+  size_t num_channels() const { return _nchan; }
+
+  osmosdr::meta_range_t get_sample_rates()
+  {
+    return _sink ? _sink->get_sample_rates() : _source->get_sample_rates();
+  }
+
+  double set_sample_rate( double rate )
+  {
+    return _sink ? _sink->set_sample_rate( rate ) : _source->set_sample_rate( rate );
+  }
+
+  osmosdr::stream_stats_t get_stream_stats( size_t chan )
+  {
+    return _sink ? _sink->get_stream_stats( chan ) : _source->get_stream_stats( chan );
+  }
+
+  void start() { _tb->start(); }
+
+  void stop()
+  {
+    _tb->stop();
+    _tb->wait();
+  }
+
+private:
+  gr::top_block_sptr _tb;
+  osmosdr::source::sptr _source;
+  osmosdr::sink::sptr _sink;
+  size_t _nchan;
+};
+
+/* measure one rate of the device and write its rows */
+static bool run_point( bench_device &dev, const std::string &args, double rate,
+                       double warmup, double seconds, std::ostream &csv )
+{
+  const double actual = dev.set_sample_rate( rate );
+
+  dev.start();
+
+  if ( ! wait_for( warmup ) ) {
+    dev.stop();
+    return false;
+  }
+
+  std::vector< osmosdr::stream_stats_t > before;
+  for ( size_t chan = 0; chan < dev.num_channels(); chan++ )
+    before.push_back( dev.get_stream_stats( chan ) );
+
+  const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  const double cpu0 = cpu_seconds();
+
+  const bool complete = wait_for( seconds );
+
+  std::vector< osmosdr::stream_stats_t > after;
+  for ( size_t chan = 0; chan < dev.num_channels(); chan++ )
+    after.push_back( dev.get_stream_stats( chan ) );
+
+  const double cpu = cpu_seconds() - cpu0;
+  const double elapsed = std::chrono::duration< double >(
+                           std::chrono::steady_clock::now() - t0 ).count();
+
+  dev.stop();
+
+  if ( elapsed <= 0 )
+    return complete;
+
+  double total_msps = 0;
+  for ( size_t chan = 0; chan < dev.num_channels(); chan++ )
+    total_msps += ( after[chan].delivered - before[chan].delivered ) / elapsed / 1e6;
+
+  const double cpu_pct = 100.0 * cpu / elapsed;
+
+  for ( size_t chan = 0; chan < dev.num_channels(); chan++ ) {
+    const osmosdr::stream_stats_t &a = after[chan];
+    const osmosdr::stream_stats_t &b = before[chan];
+
+    std::vector< uint64_t > hist( a.latency_us.size() );
+    for ( size_t i = 0; i < hist.size(); i++ )
+      hist[i] = a.latency_us[i] - ( i < b.latency_us.size() ? b.latency_us[i] : 0 );
+
+    const uint64_t samples = a.delivered - b.delivered;
+
+    csv << csv_quote( args ) << "," << actual << "," << chan << ","
+        << elapsed << "," << samples << "," << samples / elapsed / 1e6 << ","
+        << a.overflows - b.overflows << "," << a.dropped - b.dropped << ","
+        << a.underruns - b.underruns << "," << a.high_water << ","
+        << latency_field( percentile( hist, 0.5 ) ) << ","
+        << latency_field( percentile( hist, 0.9 ) ) << ","
+        << latency_field( percentile( hist, 0.99 ) ) << ","
+        << latency_field( percentile( hist, 0.999 ) ) << ","
+        << latency_field( percentile( hist, 1.0 ) ) << ","
+        << cpu_pct << ","
+        << ( total_msps > 0 ? cpu_pct / total_msps : 0 ) << std::endl;
+  }
+
+  return complete;
+}
+
+int main( int argc, char **argv )
+{
+  std::string dev_args;
+  bool sink = false;
+  std::vector< double > rates;
+  std::vector< std::string > extras;
+  double seconds = 10;
+  double warmup = 2;
+  double freq = 0;
+  std::string csv_path;
+
+  for ( int i = 1; i < argc; i++ ) {
+    std::string arg = argv[i];
+
+    if ( arg.compare( 0, 9, "--source=" ) == 0 ) {
+      dev_args = arg.substr( 9 );
+      sink = false;
+    } else if ( arg.compare( 0, 7, "--sink=" ) == 0 ) {
+      dev_args = arg.substr( 7 );
+      sink = true;
+    } else if ( arg.compare( 0, 8, "--rates=" ) == 0 ) {
+      rates = parse_rates( arg.substr( 8 ) );
+    } else if ( arg.compare( 0, 8, "--extra=" ) == 0 ) {
+      extras.push_back( arg.substr( 8 ) );
+    } else if ( arg.compare( 0, 10, "--seconds=" ) == 0 ) {
+      seconds = atof( arg.c_str() + 10 );
+    } else if ( arg.compare( 0, 9, "--warmup=" ) == 0 ) {
+      warmup = atof( arg.c_str() + 9 );
+    } else if ( arg.compare( 0, 7, "--freq=" ) == 0 ) {
+      freq = atof( arg.c_str() + 7 );
+    } else if ( arg.compare( 0, 6, "--csv=" ) == 0 ) {
+      csv_path = arg.substr( 6 );
+    } else if ( arg == "-h" || arg == "--help" ) {
+      usage( argv[0] );
+      return 0;
+    } else {
+      usage( argv[0] );
+      return 1;
+    }
+  }
+
+  if ( seconds <= 0 || warmup < 0 ) {
+    usage( argv[0] );
+    return 1;
+  }
+
+  if ( extras.empty() )
+    extras.push_back( "" );
+
+  std::ofstream file;
+  if ( csv_path.size() ) {
+    file.open( csv_path.c_str() );
+    if ( ! file ) {
+      std::cerr << "Failed to open " << csv_path << std::endl;
+      return 1;
+    }
+  }
+  std::ostream &csv = csv_path.size() ? file : std::cout;
+
+  signal( SIGINT, on_signal );
+  signal( SIGTERM, on_signal );
+
+  csv << "args,rate,chan,seconds,samples,msps,overflows,dropped,underruns,"
+         "high_water,lat_p50_us,lat_p90_us,lat_p99_us,lat_p999_us,lat_max_us,"
+         "cpu_pct,cpu_pct_per_msps" << std::endl;
+
+  try {
+    for ( const std::string &extra : extras ) {
+      /* the latency histograms are opt-in */
+      std::string args = dev_args;
+      if ( extra.size() )
+        args += "," + extra;
+      if ( args.find( "latency=" ) == std::string::npos )
+        args += ",latency=1";
+
+      bench_device dev( sink, args, freq );
+
+      std::vector< double > points = rates;
+      if ( points.empty() )
+        points = dev.get_sample_rates().values();
+
+      for ( double rate : points ) {
+        std::cerr << "Measuring " << args << " at " << rate / 1e6
+                  << " MS/s" << std::endl;
+
+        if ( ! run_point( dev, args, rate, warmup, seconds, csv ) )
+          return 1;
+      }
+    }
+  } catch ( const std::exception &e ) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,25 @@
+INCLUDE(FindPkgConfig)
+PKG_CHECK_MODULES(PC_LIBUSB libusb-1.0)
+
+FIND_PATH(
+    LIBUSB_INCLUDE_DIRS
+    NAMES libusb.h
+    HINTS $ENV{LIBUSB_DIR}/include
+        ${PC_LIBUSB_INCLUDEDIR}
+    PATHS /usr/local/include/libusb-1.0
+          /usr/include/libusb-1.0
+    PATH_SUFFIXES libusb-1.0
+)
+
+FIND_LIBRARY(
+    LIBUSB_LIBRARIES
+    NAMES usb-1.0 usb
+    HINTS $ENV{LIBUSB_DIR}/lib
+        ${PC_LIBUSB_LIBDIR}
+    PATHS /usr/local/lib
+          /usr/lib
+)
+
+INCLUDE(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(LIBUSB DEFAULT_MSG LIBUSB_LIBRARIES LIBUSB_INCLUDE_DIRS)
+MARK_AS_ADVANCED(LIBUSB_LIBRARIES LIBUSB_INCLUDE_DIRS)
@@ -79,6 +79,11 @@ inputs:
 - domain: message
   id: command
   optional: true
+% if sourk == 'sink':
+- domain: message
+  id: trigger
+  optional: true
+% endif
 % if sourk == 'source':
 
 outputs:
@@ -93,6 +98,9 @@ outputs:
   id: async_msgs
   optional: true
 % endif
+- domain: message
+  id: status
+  optional: true
 
 templates:
   imports: |-
@@ -159,8 +167,10 @@ documentation: |-
   % if sourk == 'source':
    * RTL2832U based DVB-T dongles through librtlsdr
    * RTL-TCP spectrum server (see librtlsdr project)
+   * Any receiver served on the network by osmosdr_server
    * SDRplay RSP devices through SDRplay library
    * gnuradio .cfile input through libgnuradio-blocks
+   * Synthetic rate-accurate test source for load testing without hardware
    * RFSPACE SDR-IQ, SDR-IP, NetSDR (incl. X2 option)
    * AirSpy Wideband Receiver through libairspy
   % endif
@@ -179,10 +189,45 @@ documentation: |-
 
   Output Type:
   This parameter controls the data type of the stream in gnuradio. Only complex float32 samples are supported at the moment.
+  % if sourk == 'source':
+  Outside of GRC the native integer samples of a device can be requested with the cpu_format device argument instead, which changes the item size of its channels: cpu_format=cu8 for rtl and rtl_tcp, cs8 for hackrf, cs16 for bladerf (SC16 Q11, or cs8 with format=sc8) and airspy, cs16|cs8|cu8 for soapy and file, the sim format for sim.
+  % endif
 
   Device Arguments:
   The device argument is a comma delimited string used to locate devices on your system. Device arguments for multiple devices may be given by separating them with a space.
-  Use the device id or name/serial (if applicable) to specify a certain device or list of devices. If left blank, the first device found will be used.
+  Use the device id or name/serial (if applicable) to specify a certain device or list of devices. If left blank, the first device found will be used; all drivers are searched concurrently, each for at most enum_timeout seconds (default 5).
+  keep_open=N keeps a hackrf or bladerf device open for N seconds after the last block using it is gone, so a flowgraph rebuilt meanwhile reuses the handle instead of opening (and, for the bladeRF, checking the FPGA of) the device again.
+  Overflows and underruns are counted for get_stream_stats() and reported as O and U on stderr, quiet=1 counts them silently (rtl, rtl_tcp, hackrf, airspy, airspyhf, bladerf, rfspace, redpitaya, freesrp, soapy, sim and the file sink with async=1).
+  % if sourk == 'source':
+  latency=1 adds a histogram of the time from a USB transfer arriving until its samples leave the block to these statistics (rtl, hackrf, airspy, bladerf with async=1 and sim).
+  overflow=drop-newest|drop-oldest|block sets what the buffer of a source does once it is full, the same for all drivers: drop the new samples (default), discard the oldest ones to keep the latency low, or hold the device back until the flowgraph made room, for gap-free recordings; ring_mb=N makes the buffer at least N MiB (rtl, rtl_tcp, hackrf, airspy, airspyhf, sdrplay, rfspace, redpitaya, freesrp, sim).
+  Samples lost after the buffer of a device overflowed are marked by an rx_gap tag with their number on the first sample after the gap, and rx_time is anchored again there (rtl, hackrf, airspy, airspyhf, sdrplay, bladerf, rfspace, sim; soapy from the stream timestamps).
+  The same sources measure their actual sample rate against the host clock, by a least squares fit of the sample counter over the arrival times of the USB transfers or datagrams. get_measured_sample_rate() returns it once the fit spans 30 seconds; from then on rx_rate carries the measured rate and rx_time follows the fit, anchored again whenever the measurement moves by more than a ppm, so free-running devices don't drift against the wall clock.
+  A file source reads the SigMF metadata of name.sigmf-data, or the index given, for the format, rate and frequency, restores rx_time, rx_rate and rx_freq tags from its captures and seeks by time with seek_time(). pacing=clock meters the replay against the monotonic clock in blocks of pace_ms instead of through a throttle block.
+  A file source with nchan=N splits every file into N / files channels interleaved sample by sample; file='a;b' replays several files in lockstep, with one clock for all channels and the mapped reader (mmap=1, pacing=clock) implied.
+  align=N sample aligns the channels of several receivers sharing a clock, e.g. rtl dongles, searching up to N samples of offset: a window of align_len samples (default 4096) of channel 0 is cross-correlated with the others, nothing is delivered until all correlate better than align_corr (default 0.5), and an rx_time tag after a device lost samples measures again.
+  sync=pps starts several uhd or soapy devices sharing a 10 MHz reference and PPS sample aligned: their times are set at the same PPS edge and all of them start streaming start_delay seconds (default 2) later, by when the flowgraph has to run. set_start_time() does the same for a given device time. A soapy source activates all of its channels at that time and warns if the first timestamp of the stream is another one.
+  channels=f1:f2:... splits a single fc32 channel into narrowband channels at these offsets in Hz from the center frequency, one output each: a polyphase filterbank of chan_bins bins (default 32, even) shares one FFT between all of them, and each output is filtered to chan_bw (default 80% of a bin, at most 90%) at sample_rate / chan_bins; the filterbank gets longer the farther a channel edge reaches from its bin center. Set Num Channels to the number of offsets, the device settings are those of channel 0.
+  fft_size=N adds a "spectrum" message port posting the power spectrum of every channel fft_rate times a second (default 15): the average of fft_avg (default 4) consecutive Blackman-Harris windowed FFTs of N samples, as a dict of chan, freq, rate, item (its first sample) and power, an f32vector of the bins in dBFS from the lowest frequency up. The samples in between are not looked at, so a waterfall costs a fraction of a full rate FFT chain. Requires fc32 samples.
+  chan_backend=opencl mixes, filters and decimates these channels to the same rate on an OpenCL device instead of the CPU, the GPU chan_device=N (default 0) or any device where the system has no GPU, so only the narrowband channels come back from it. Requires gr-osmosdr built with OpenCL.
+  cpu=N binds the thread feeding the buffer of a device to a CPU core, rt_prio=N runs it with SCHED_FIFO real-time priority N and numa=1 allocates the buffer on the memory node of that core (rtl, rtl_tcp, hackrf, airspy, airspyhf, bladerf with async=1, rfspace, redpitaya and sim). hugepages=1 backs that buffer with 2 MB huge pages where the system provides them; buffers are pre-faulted when the device is opened and reused when it is opened again.
+  convert_threads=N converts large blocks of samples to fc32 with N threads instead of one, each taking a slice, and convert_cpu=N binds the extra ones to consecutive cores from N on; for the rates of bladeRF 2.0 and high rate soapy devices (bladerf, soapy with zerocopy=1).
+  fcd with mmap=1 reads the samples from the mmap'ed ALSA ring of the dongle in period=N frames (default 1024) with periods=N of them buffered (default 16), instead of through the audio source of gr-fcdproplus, which keeps controlling the dongle.
+  rtl with decim=N (2, 4, 8 up to 64) filters the raw samples with integer half-band stages and only converts the decimated stream to complex float, sample rates then refer to the decimated rate.
+  rtl, hackrf and airspy sources with soft_agc=D (dBFS, e.g. -20) level the mean power of their samples at D by a digital gain, applied and measured while the samples are converted, so no AGC block is needed downstream. The hardware gains stay where they are set. Requires cpu_format=fc32.
+  power_tags=N makes these sources tag the last item of every N samples with rx_power, a dict of the mean power and the peak of I and Q in dBFS, the number of I and Q values clipped and len=N, measured while the samples are converted and before soft_agc. Requires cpu_format=fc32.
+  squelch_db=D makes these sources forward only bursts: windows of 256 samples with a mean power of at least D dBFS, measured while the samples are converted, open the gate from pre=N samples before until post=N samples after them. The first sample of a burst is tagged rx_sob, the last one rx_eob, and rx_gap, rx_time and rx_rate tags account for the samples dropped in between. With power_tags the rx_power tags of the windows ending in a burst go on their last item, the others are left out. Requires cpu_format=fc32, and without decim (airspy) and sweeps.
+  record=path makes rtl (cu8), hackrf (cs8) and airspy (cs16) sources write the transfers of the device unconverted to path, from their reader thread through a ring of record_mb MiB (default 64) and a writer thread, next to the normal stream. A SigMF sidecar (path with .sigmf-data replaced by .sigmf-meta, or path.sigmf-meta) holds the rate and a capture with frequency and host time for the start and after every retune or gap, with the samples lost in osmosdr:lost, so the file source plays the recording back.
+  airspyhf with low_latency=1 buffers at most 16384 samples and hands them to the flowgraph as soon as they arrive, rather than waiting for full scheduler chunks.
+  hackrf with sweep= streams the firmware sweep of hackrf_sweep over the start:stop ranges in MHz instead of a single frequency: sweep_len samples per step of sweep_step Hz, at 20 MHz and a 15 MHz filter by default. Each block starts with an rx_freq tag of the frequency it was received at. Blocks that don't fit into the buffer are dropped whole, so overflow= must stay drop-newest.
+  A hackrf source and sink opened with half_duplex=1 on the same device share it in turns: the sink transmits from a tx_sob tag (it implies burst=1) until the burst has left the USB transfers, the source receives otherwise. After switching back the source drops settle_us=N microseconds (default 1000) of disturbed samples and tags rx_gap with everything missed. get_stream_stats() counts the switches with the time the last and the longest took. Zerocopy and sweep mode are not supported.
+  latency_ms=N sizes the buffers of an rtl source from the sample rate instead of buffers= and buflen=: each USB transfer holds half of N milliseconds and work() hands it out as soon as it arrived, the transfers queued cover half a second, and the reader restarts with new ones when the rate changes. A hackrf source hands out what arrived in half of N instead of waiting for three of its fixed 256 KiB transfers.
+  net=host[:port] receives a device served by osmosdr_server over UDP (port 1235 by default), which reads it once and sends the same datagrams to every client, or with --multicast=group[:port] to a multicast group the source joins with multicast=group[:port]. The server picks the wire format with --format=cs16|cs12|cs8|fc32, cs12 packing the samples into 3 bytes, or sends what a device with cpu_format= delivers; cpu_format= of the source may ask for the same. Settings are forwarded to the server and apply to all of its clients, unless it runs with --read-only. Lost datagrams are counted and tagged rx_gap.
+  % endif
+  % if sourk == 'sink':
+  A hackrf sink with latency_ms=N queues at most N milliseconds of samples for transmission, in chunks of a quarter of that, instead of the buffers= transfers of 256 KiB; prefill=P (percent, default 0) holds back transmission until that much of the queue is filled, at the start and after every underrun. burst=1 only transmits the samples from a tx_sob tag up to a tx_eob tag, queueing the end of each burst right away and sending silence in between without underruns.
+  ring_seconds=N makes a file sink keep the last N seconds in memory, or in the preallocated ring_file, and write them with the following post_seconds to a new file whenever a message arrives at the trigger port or a "trigger" stream tag passes. A symbol message or tag value names the file, otherwise name_0000.ext, name_0001.ext and so on are derived from file.
+  % endif
 
   Examples:
 
@@ -190,26 +235,54 @@ documentation: |-
   Lines ending with ... mean it's possible to bind devices together by specifying multiple device arguments separated with a space.
 
   % if sourk == 'source':
+    fcd=0[,mmap=1][,period=1024][,periods=16]
     rtl=serial_number ...
     rtl=0[,rtl_xtal=28.8e6][,tuner_xtal=28.8e6] ...
-    rtl=1[,buffers=32][,buflen=N*512] ...
+    rtl=1[,buffers=32][,buflen=N*512][,zerocopy=0|1] ...
+    rtl=0,align=2000[,align_len=4096][,align_corr=0.5][,cpu=2] rtl=1[,cpu=3] ...
     rtl=2[,direct_samp=0|1|2][,offset_tune=0|1][,bias=0|1] ...
-    rtl_tcp=127.0.0.1:1234[,psize=16384][,direct_samp=0|1|2][,offset_tune=0|1][,bias=0|1] ...
-    file='/path/to/your file',rate=1e6[,freq=100e6][,repeat=true][,throttle=true] ...
-    netsdr=127.0.0.1[:50000][,nchan=2]
-    sdr-ip=127.0.0.1[:50000]
-    cloudiq=127.0.0.1[:50000]
+    rtl=0,decim=8 ...
+    rtl=0,fft_size=1024[,fft_rate=15][,fft_avg=4] ...
+    rtl=0,record=/data/capture.sigmf-data[,record_mb=64] ...
+    rtl=0,latency_ms=20 ...
+    rtl=0,channels=-300e3:-112.5e3:25e3:412.5e3,chan_bins=96,chan_bw=12.5e3
+    rtl_tcp=127.0.0.1:1234[,psize=16384][,rcvbuf=N][,direct_samp=0|1|2][,offset_tune=0|1][,bias=0|1] ...
+    net=127.0.0.1[:1235][,multicast=239.1.2.3[:1235]][,rcvbuf=N][,timeout=2][,cpu_format=fc32|cs16|cs8|cu8] ...
+    file='/path/to/your file',rate=1e6[,freq=100e6][,repeat=true][,throttle=true][,mmap=0|1][,format=fc32|cu8|cs8|cs16|cs12][,scale=32768][,index=path.sigmf-meta][,pacing=throttle|clock][,pace_ms=10][,nchan=N] ...
+    file='/data/rx0.cu8;/data/rx1.cu8',nchan=2,format=cu8,rate=2.4e6 ...
+    sim=0[,rate=20e6][,freq=100e6][,transfer=131072][,buffers=15][,jitter=us][,format=cu8|cs8|cs16|fc32] ...
+    netsdr=127.0.0.1[:50000][,nchan=2][,bits=16|24][,rcvbuf=N]
+    sdr-ip=127.0.0.1[:50000][,bits=16|24][,rcvbuf=N]
+    cloudiq=127.0.0.1[:50000][,bits=16|24][,rcvbuf=N]
     sdr-iq=/dev/ttyUSB0
-    airspy=0[,bias=0|1][,linearity][,sensitivity]
+    airspy=0[,bias=0|1][,linearity][,sensitivity][,pack=0|1][,int16=0|1][,decim=2|4|8|16]
+    airspyhf=0[,low_latency=0|1]
+    soapy=0[,driver=...][,format=CF32|CS16|CS8|CU8][,zerocopy=0|1] ...
+    hackrf=0,sweep=2400:2500[:start:stop][,sweep_step=20e6][,sweep_offset=7.5e6][,sweep_len=8192][,sweep_style=interleaved|linear]
   % endif
   % if sourk == 'sink':
-    file='/path/to/your file',rate=1e6[,freq=100e6][,append=true][,throttle=true] ...
+    file='/path/to/your file',rate=1e6[,freq=100e6][,append=true][,throttle=true][,async=1][,format=fc32|cs16|cs8][,scale=N][,buffers=64][,chunk=4194304][,prealloc=bytes][,direct=1][,drop=1][,ring_seconds=N][,post_seconds=N][,ring_file=path] ...
+  % endif
+  % if sourk == 'source':
+    redpitaya=192.168.1.100[:1001][,rcvbuf=1048576][,cpu=N]
+  % else:
+    redpitaya=192.168.1.100[:1001][,sndbuf=N][,buffers=32][,cpu=N]
   % endif
-    redpitaya=192.168.1.100[:1001]
     freesrp=0[,fx3='path/to/fx3.img',fpga='path/to/fpga.bin',loopback]
-    hackrf=0[,buffers=32][,bias=0|1][,bias_tx=0|1]
-    bladerf=0[,tamer=internal|external|external_1pps][,smb=25e6]
+    hackrf=0[,buffers=32][,bias=0|1][,bias_tx=0|1][,zerocopy=0|1]
+    hackrf=0,half_duplex=1[,settle_us=1000]
+  % if sourk == 'sink':
+    hackrf=0,latency_ms=20[,prefill=50][,burst=1]
+  % endif
+    bladerf=0[,tamer=internal|external|external_1pps][,smb=25e6][,format=sc16|sc8]
     uhd[,serial=...][,lo_offset=0][,mcr=52e6][,nchan=2][,subdev='\\\\'B:0 A:0\\\\''] ...
+  % if sourk == 'source':
+    uhd,serial=...,sync=pps[,start_delay=2] uhd,serial=... ...
+    soapy,driver=lime,serial=...,sync=pps soapy,driver=lime,serial=... ...
+  % endif
+
+  Command Port:
+  Dicts posted to the command port retune the device without blocking the poster: any of freq, gain, rate, bw and antenna, for the channel chan (0 by default). Each command is answered on the status port with a dict of the values applied, or of the error.
 
   Num Channels:
   Selects the total number of channels in this multi-device configuration. Required when specifying multiple device arguments.
@@ -230,7 +303,8 @@ documentation: |-
     Manual: Keep last estimated correction when switched from Automatic to Manual.
     Automatic: Periodicallly find the best solution to compensate for DC offset.
 
-  This functionality is available for USRP devices only.
+  This functionality is available for USRP devices, and is done in software
+  while converting the samples for RTL-SDR, HackRF and Airspy devices.
 
   IQ Balance Mode:
   Controls the behavior of software IQ imbalance corrrection.
@@ -239,6 +313,8 @@ documentation: |-
     Automatic: Periodicallly find the best solution to compensate for image signals.
 
   This functionality depends on http://cgit.osmocom.org/cgit/gr-iqbal/
+  By default the estimation runs over every sample, the device argument iq_period=N (ms) only hands a block of iq_len samples (default 8192) to it every N ms while the correction still applies to every sample.
+  The correction blocks stay connected, Off passes the samples through them unchanged, so the mode can be switched while the flowgraph runs.
 
   Gain Mode:
   Chooses between the manual (default) and automatic gain mode where appropriate.
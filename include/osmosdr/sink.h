@@ -23,6 +23,7 @@
 #include <osmosdr/api.h>
 #include <osmosdr/ranges.h>
 #include <osmosdr/time_spec.h>
+#include <osmosdr/stream_stats.h>
 #include <gnuradio/hier_block2.h>
 
 namespace osmosdr {
@@ -371,6 +372,39 @@ public:
    * \param time_spec the new time
    */
   virtual void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec) = 0;
+
+  /*!
+   * Set the time at which the following settings take effect.
+   * Until clear_command_time(), calls like set_center_freq() or set_gain()
+   * are executed at that time. Devices without timed commands apply the
+   * settings immediately.
+   * \param time_spec the device time, see get_time_now()
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                                size_t mboard = 0) = 0;
+
+  /*!
+   * Apply the following settings immediately again.
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void clear_command_time(size_t mboard = 0) = 0;
+
+  /*!
+   * Get the streaming statistics of a channel: samples taken from the flowgraph,
+   * underruns and buffer usage. The counters are safe to poll while streaming.
+   * \param chan the channel index 0 to N-1
+   * \return the statistics accumulated since the device has been opened
+   */
+  virtual ::osmosdr::stream_stats_t get_stream_stats(size_t chan = 0) = 0;
+
+  /*!
+   * Forget the settings cached for the getters. They report what the
+   * setters applied and are read from the device only once otherwise;
+   * call this after the device has been changed behind the back of the
+   * block, e.g. by another application or through the device arguments.
+   */
+  virtual void clear_settings_cache() = 0;
 };
 
 } /* namespace osmosdr */
@@ -23,6 +23,7 @@
 #include <osmosdr/api.h>
 #include <osmosdr/ranges.h>
 #include <osmosdr/time_spec.h>
+#include <osmosdr/stream_stats.h>
 #include <gnuradio/hier_block2.h>
 
 namespace osmosdr {
@@ -67,6 +68,18 @@ public:
    */
   virtual bool seek( long seek_point, int whence, size_t chan = 0 ) = 0;
 
+  /*!
+   * \brief seek file to the sample recorded at \p time
+   *
+   * Recordings with an index holding timestamps, e.g. SigMF captures with
+   * core:datetime, are sought by absolute time, others by the time since
+   * the start of the file at its sample rate.
+   *
+   * \param time	time of the sample to continue with
+   * \return true on success
+   */
+  virtual bool seek_time( const osmosdr::time_spec_t &time, size_t chan = 0 ) = 0;
+
   /*!
    * Get the possible sample rates for the underlying radio hardware.
    * \return a range of rates in Sps
@@ -87,6 +100,15 @@ public:
    */
   virtual double get_sample_rate( void ) = 0;
 
+  /*!
+   * Get the sample rate of a channel measured against the host clock.
+   * Free-running devices deviate from the rate set by their clock error,
+   * the rx_rate and rx_time tags follow the measurement once known.
+   * \param chan the channel index 0 to N-1
+   * \return the measured rate in Sps, 0 until it is known
+   */
+  virtual double get_measured_sample_rate( size_t chan = 0 ) = 0;
+
   /*!
    * Get the tunable frequency range for the underlying radio hardware.
    * \param chan the channel index 0 to N-1
@@ -415,6 +437,83 @@ public:
    * \param time_spec the new time
    */
   virtual void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec) = 0;
+
+  /*!
+   * Set the time at which the following settings take effect.
+   * Until clear_command_time(), calls like set_center_freq() or set_gain()
+   * are queued up to that time and the first sample received with the new
+   * settings is marked by rx_time and rx_freq tags. Devices without timed
+   * commands apply the settings immediately.
+   * \param time_spec the device time, see get_time_now()
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                                size_t mboard = 0) = 0;
+
+  /*!
+   * Like set_command_time(), but the following settings take effect at a
+   * sample of the stream, counted like the items the block produced.
+   * Only supported by devices applying timed commands on the host.
+   * \param sample the index of the first sample with the new settings
+   * \param chan the channel index 0 to N-1
+   */
+  virtual void set_command_sample(uint64_t sample, size_t chan = 0) = 0;
+
+  /*!
+   * Apply the following settings immediately again.
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void clear_command_time(size_t mboard = 0) = 0;
+
+  /*!
+   * Start streaming at the given device time once the flowgraph starts,
+   * on every device at the same time. Combined with set_time_next_pps()
+   * this starts several receivers sharing a clock and PPS sample aligned.
+   * Has to be called before the flowgraph is started, with a time it will
+   * not have reached by then.
+   * \param time_spec the device time, see get_time_now()
+   * \return false if a device can't start at a given time
+   */
+  virtual bool set_start_time(const ::osmosdr::time_spec_t &time_spec) = 0;
+
+  /*!
+   * Sweep the channel over a list of center frequencies.
+   *
+   * The device is retuned from its streaming thread, the samples received
+   * while it settles are dropped and the first sample of every dwell is
+   * marked by rx_time and rx_freq tags with the frequency tuned to. The
+   * frequencies are visited in turn until clear_sweep().
+   *
+   * \param freqs the center frequencies in Hz
+   * \param dwell seconds of samples delivered at each frequency
+   * \param settle seconds of samples dropped after each retune
+   * \param chan the channel index 0 to N-1
+   * \return false if the device doesn't support sweeping
+   */
+  virtual bool set_sweep(const std::vector<double> &freqs,
+                         double dwell, double settle, size_t chan = 0) = 0;
+
+  /*!
+   * Stop sweeping and stay at the current frequency.
+   * \param chan the channel index 0 to N-1
+   */
+  virtual void clear_sweep(size_t chan = 0) = 0;
+
+  /*!
+   * Get the streaming statistics of a channel: samples handed to the flowgraph,
+   * overflows and buffer usage. The counters are safe to poll while streaming.
+   * \param chan the channel index 0 to N-1
+   * \return the statistics accumulated since the device has been opened
+   */
+  virtual ::osmosdr::stream_stats_t get_stream_stats(size_t chan = 0) = 0;
+
+  /*!
+   * Forget the settings cached for the getters. They report what the
+   * setters applied and are read from the device only once otherwise;
+   * call this after the device has been changed behind the back of the
+   * block, e.g. by another application or through the device arguments.
+   */
+  virtual void clear_settings_cache() = 0;
 };
 
 } /* namespace osmosdr */
@@ -0,0 +1,147 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_STREAM_H
+#define INCLUDED_OSMOSDR_STREAM_H
+
+#include <osmosdr/api.h>
+#include <osmosdr/ranges.h>
+#include <osmosdr/time_spec.h>
+#include <osmosdr/stream_stats.h>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+namespace osmosdr {
+
+/*!
+ * What a stream::read() call returned, from the rx_time and rx_freq tags
+ * of the driver.
+ */
+struct OSMOSDR_API rx_metadata_t
+{
+  //! time_spec is valid, the device has tagged the stream
+  bool has_time_spec;
+
+  //! sampling time of the first item returned
+  time_spec_t time_spec;
+
+  //! center frequency of the first item returned, 0 if unknown
+  double freq;
+
+  /*!
+   * The stream was anchored anew at item anchor_index of this read, e.g.
+   * after lost samples, a retune or a new sample rate; the time of the
+   * items from there on no longer follows from time_spec.
+   */
+  bool anchored;
+  size_t anchor_index;
+
+  //! the device has stopped delivering, e.g. a file without repeat
+  bool end_of_stream;
+
+  rx_metadata_t( void ) :
+    has_time_spec( false ), freq( 0 ), anchored( false ), anchor_index( 0 ),
+    end_of_stream( false )
+  {}
+};
+
+/*!
+ * \brief Reads the samples of a receiver without a flowgraph.
+ *
+ * The driver block of the device is run by read() on the calling thread,
+ * which hands it the buffers of the caller as its output, so neither the
+ * scheduler threads of a gr::top_block nor copies between block buffers
+ * are involved. The first device of the arguments is opened, the drivers
+ * implemented by a hierarchical block (fcd, file, uhd) are not supported.
+ */
+class OSMOSDR_API stream : boost::noncopyable
+{
+public:
+  typedef boost::shared_ptr< stream > sptr;
+
+  /*!
+   * Open and start the device, as osmosdr::source would.
+   * \param args the address to identify the hardware
+   */
+  static sptr open( const std::string & args = "" );
+
+  virtual ~stream() {}
+
+  virtual size_t get_num_channels( void ) = 0;
+
+  /*! the format of the items read, "fc32" unless set with cpu_format= */
+  virtual std::string get_cpu_format( void ) = 0;
+
+  /*! size of an item in bytes */
+  virtual size_t get_item_size( void ) = 0;
+
+  /*!
+   * Read nitems items of each channel into buffs.
+   *
+   * Returns once nitems have been read, the timeout has expired or the
+   * stream has ended. The timeout is checked between the reads of the
+   * driver, which may block for up to their own timeouts.
+   *
+   * \param buffs one buffer of nitems items per channel
+   * \param nitems number of items per channel
+   * \param timeout seconds to wait at most
+   * \param metadata filled in for the items returned
+   * \return the number of items per channel read
+   */
+  virtual size_t read( const std::vector< void * > &buffs, size_t nitems,
+                       double timeout, rx_metadata_t &metadata ) = 0;
+
+  /*! read() into the buffer of a single channel */
+  size_t read( void *buff, size_t nitems, double timeout, rx_metadata_t &metadata )
+  {
+    return read( std::vector< void * >( 1, buff ), nitems, timeout, metadata );
+  }
+
+  /*! stop and release the device, read() returns 0 afterwards */
+  virtual void close( void ) = 0;
+
+  virtual osmosdr::meta_range_t get_sample_rates( void ) = 0;
+  virtual double set_sample_rate( double rate ) = 0;
+  virtual double get_sample_rate( void ) = 0;
+
+  virtual osmosdr::freq_range_t get_freq_range( size_t chan = 0 ) = 0;
+  virtual double set_center_freq( double freq, size_t chan = 0 ) = 0;
+  virtual double get_center_freq( size_t chan = 0 ) = 0;
+
+  virtual osmosdr::gain_range_t get_gain_range( size_t chan = 0 ) = 0;
+  virtual bool set_gain_mode( bool automatic, size_t chan = 0 ) = 0;
+  virtual double set_gain( double gain, size_t chan = 0 ) = 0;
+  virtual double get_gain( size_t chan = 0 ) = 0;
+
+  virtual std::string set_antenna( const std::string & antenna, size_t chan = 0 ) = 0;
+  virtual std::string get_antenna( size_t chan = 0 ) = 0;
+
+  virtual double set_bandwidth( double bandwidth, size_t chan = 0 ) = 0;
+  virtual double get_bandwidth( size_t chan = 0 ) = 0;
+
+  virtual osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 ) = 0;
+};
+
+} /* namespace osmosdr */
+
+#endif /* INCLUDED_OSMOSDR_STREAM_H */
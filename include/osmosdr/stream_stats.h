@@ -0,0 +1,82 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_OSMOSDR_STREAM_STATS_H
+#define INCLUDED_OSMOSDR_STREAM_STATS_H
+
+#include <osmosdr/api.h>
+#include <stdint.h>
+#include <vector>
+
+namespace osmosdr{
+
+    /*!
+     * Streaming statistics of a single channel, accumulated since the
+     * device has been opened. Counters a device is unable to provide
+     * stay zero.
+     */
+    struct OSMOSDR_API stream_stats_t{
+        //! samples handed to (source) or taken from (sink) the flowgraph
+        uint64_t delivered;
+
+        //! number of times samples did not fit into the buffers
+        uint64_t overflows;
+
+        //! samples lost due to overflows
+        uint64_t dropped;
+
+        //! number of times a sink ran out of samples to transmit
+        uint64_t underruns;
+
+        //! maximum number of samples buffered between device and flowgraph
+        uint64_t high_water;
+
+        //! number of samples buffered at the time of the query
+        uint64_t fill;
+
+        /*!
+         * Histogram of the time from a transfer arriving from the device
+         * until its last sample has left work(). Entry i counts latencies
+         * below 2^(i+1) us and, for i > 0, of at least 2^i us, the last
+         * entry everything longer. Empty unless enabled with latency=1.
+         */
+        std::vector<uint64_t> latency_us;
+
+        //! direction switches of a device shared in half-duplex mode
+        uint64_t turnarounds;
+
+        //! time the last switch took until the first transfer, in us
+        uint64_t turnaround_us;
+
+        //! the longest switch so far, in us
+        uint64_t turnaround_max_us;
+
+        stream_stats_t(void):
+            delivered(0), overflows(0), dropped(0), underruns(0),
+            high_water(0), fill(0),
+            turnarounds(0), turnaround_us(0), turnaround_max_us(0)
+        {}
+    };
+
+} //namespace osmosdr
+
+#endif /* INCLUDED_OSMOSDR_STREAM_STATS_H */
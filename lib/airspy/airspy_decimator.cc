@@ -0,0 +1,114 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <stdexcept>
+
+#include "airspy_decimator.h"
+#include "airspy_fir_kernels.h"
+
+airspy_decimator::airspy_decimator() :
+  _decim(1)
+{
+}
+
+void airspy_decimator::set_decimation( unsigned int decim )
+{
+  if ( decim != 1 && decim != 2 && decim != 4 && decim != 8 && decim != 16 )
+    throw std::runtime_error( "Unsupported decimation, must be 1, 2, 4, 8 or 16" );
+
+  _decim = decim;
+  _stages.clear();
+
+  /* the stage running at the highest rate gets the widest transition band,
+   * the last /2 before the output gets the sharpest kernel */
+  for ( unsigned int remaining = decim; remaining > 1; remaining /= 2 )
+  {
+    const float *kernel;
+    size_t len;
+
+    switch ( remaining ) {
+    case 16: kernel = KERNEL_16_110; len = KERNEL_16_110_LEN; break;
+    case 8:  kernel = KERNEL_8_100;  len = KERNEL_8_100_LEN;  break;
+    case 4:  kernel = KERNEL_4_90;   len = KERNEL_4_90_LEN;   break;
+    default: kernel = KERNEL_2_80;   len = KERNEL_2_80_LEN;   break;
+    }
+
+    stage_t stage;
+    stage.fir.reset( new gr::filter::kernel::fir_filter_ccf(
+                       2, std::vector<float>( kernel, kernel + len ) ) );
+    _stages.push_back( stage );
+  }
+
+  reset();
+}
+
+void airspy_decimator::reset()
+{
+  for ( size_t i = 0; i < _stages.size(); i++ ) {
+    stage_t &stage = _stages[i];
+    stage.buf.assign( stage.fir->ntaps() - 1, gr_complex(0, 0) );
+  }
+}
+
+size_t airspy_decimator::process( const gr_complex *in, size_t nitems, gr_complex *out )
+{
+  if ( _stages.empty() ) {
+    if ( in != out )
+      memcpy( out, in, nitems * sizeof(gr_complex) );
+    return nitems;
+  }
+
+  /* make room for the input of every stage behind its history */
+  size_t n = nitems;
+  for ( size_t i = 0; i < _stages.size(); i++, n /= 2 ) {
+    stage_t &stage = _stages[i];
+    stage.buf.resize( stage.fir->ntaps() - 1 + n );
+  }
+
+  stage_t &first = _stages.front();
+  memcpy( &first.buf[first.fir->ntaps() - 1], in, nitems * sizeof(gr_complex) );
+
+  /* each stage filters straight into the input area of the next one */
+  n = nitems;
+  for ( size_t i = 0; i < _stages.size(); i++, n /= 2 ) {
+    stage_t &stage = _stages[i];
+    const size_t hist = stage.fir->ntaps() - 1;
+
+    gr_complex *dst = out;
+    if ( i + 1 < _stages.size() ) {
+      stage_t &next = _stages[i + 1];
+      dst = &next.buf[next.fir->ntaps() - 1];
+    }
+
+    stage.fir->filterNdec( dst, stage.buf.data(), n / 2, 2 );
+
+    /* keep the tail as history for the next call */
+    memmove( stage.buf.data(), &stage.buf[n], hist * sizeof(gr_complex) );
+  }
+
+  return nitems / _decim;
+}
@@ -0,0 +1,68 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_AIRSPY_DECIMATOR_H
+#define INCLUDED_AIRSPY_DECIMATOR_H
+
+#include <memory>
+#include <vector>
+
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/filter/fir_filter.h>
+
+/*!
+ * Cascade of decimate-by-2 half-band stages built from the Airspy kernels
+ * in airspy_fir_kernels.h. Each stage keeps its own filter history, so a
+ * stream can be fed in arbitrarily sized chunks as long as each chunk is a
+ * multiple of the total decimation factor.
+ *
+ * The FIR kernels are the VOLK backed gr-filter ones.
+ */
+class airspy_decimator
+{
+public:
+  airspy_decimator();
+
+  /*! \param decim total decimation, 1 (bypass), 2, 4, 8 or 16 */
+  void set_decimation( unsigned int decim );
+  unsigned int decimation() const { return _decim; }
+
+  /*! drop the filter history of all stages */
+  void reset();
+
+  /*!
+   * \param nitems number of input samples, a multiple of decimation()
+   * \return the number of samples written to out, nitems / decimation()
+   */
+  size_t process( const gr_complex *in, size_t nitems, gr_complex *out );
+
+private:
+  struct stage_t
+  {
+    std::shared_ptr<gr::filter::kernel::fir_filter_ccf> fir;
+    std::vector<gr_complex> buf; /* ntaps - 1 history followed by input */
+  };
+
+  unsigned int _decim;
+  std::vector<stage_t> _stages;
+};
+
+#endif /* INCLUDED_AIRSPY_DECIMATOR_H */
@@ -38,6 +38,7 @@
 
 #include <gnuradio/io_signature.h>
 
+
 #include "airspy_source_c.h"
 #include "airspy_fir_kernels.h"
 
@@ -83,8 +84,10 @@ static const int MAX_OUT = 1;	// maximum number of output streams
 airspy_source_c::airspy_source_c (const std::string &args)
   : gr::sync_block ("airspy_source_c",
         gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
-        gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
+        gr::io_signature::make(MIN_OUT, MAX_OUT,
+                               cpu_format_item_size( args_to_cpu_format( args, "cs16" ) ))),
     _dev(NULL),
+    _int16(false),
     _sample_rate(0),
     _center_freq(0),
     _freq_corr(0),
@@ -93,12 +96,17 @@ airspy_source_c::airspy_source_c (const std::string &args)
     _lna_gain(0),
     _mix_gain(0),
     _vga_gain(0),
-    _bandwidth(0)
+    _bandwidth(0),
+    _tuning(args)
 {
   int ret;
 
   dict_t dict = params_to_dict(args);
 
+  _stats.set_quiet( args_to_quiet( args ) );
+  _fifo.configure( args );
+  _fifo_i16.configure( args, 2 );
+
   _dev = NULL;
   ret = airspy_open( &_dev );
   AIRSPY_THROW_ON_ERROR(ret, "Failed to open AirSpy device")
@@ -135,6 +143,57 @@ airspy_source_c::airspy_source_c (const std::string &args)
 
   std::cerr << std::endl;
 
+  /* let libairspy deliver 16 bit IQ and do the float conversion (and the
+   * optional decimation) in work(), off the library's callback thread */
+  if ( dict.count( "int16" ) )
+    _int16 = boost::lexical_cast<bool>( dict["int16"] );
+
+  /* cs16 hands the 16 bit IQ samples of the library through unconverted */
+  _cpu_format = args_to_cpu_format( args, "cs16" );
+  if ( "cs16" == _cpu_format )
+    _int16 = true;
+
+  /* the recording takes the 16 bit IQ samples of the library */
+  if ( dict.count( "record" ) ) {
+    _int16 = true;
+    _record.open( dict["record"], "cs16", args );
+  }
+
+  if ( _int16 )
+  {
+    ret = airspy_set_sample_type( _dev, AIRSPY_SAMPLE_INT16_IQ );
+    AIRSPY_THROW_ON_ERROR(ret, "Failed to set INT16 IQ sample type")
+  }
+
+  if ( dict.count( "decim" ) )
+    _decimator.set_decimation( boost::lexical_cast<unsigned int>( dict["decim"] ) );
+
+  if ( "cs16" == _cpu_format && _decimator.decimation() > 1 )
+    throw std::runtime_error( "Decimation requires cpu_format=fc32" );
+
+  if ( dict.count( "latency" ) )
+    _latency.enable( boost::lexical_cast<bool>( dict["latency"] ) );
+
+  if ( dict.count( "soft_agc" ) ) {
+    if ( "cs16" == _cpu_format )
+      throw std::runtime_error( "soft_agc requires cpu_format=fc32" );
+    _dc.set_agc( boost::lexical_cast<double>( dict["soft_agc"] ) );
+  }
+
+  if ( dict.count( "power_tags" ) ) {
+    if ( "cs16" == _cpu_format )
+      throw std::runtime_error( "power_tags requires cpu_format=fc32" );
+    _dc.set_power_tags( boost::lexical_cast<size_t>( dict["power_tags"] ) * _decimator.decimation() );
+  }
+
+  if ( dict.count( "squelch_db" ) ) {
+    if ( "cs16" == _cpu_format || _decimator.decimation() > 1 )
+      throw std::runtime_error( "squelch_db requires cpu_format=fc32 and no decim" );
+    _dc.set_squelch( boost::lexical_cast<double>( dict["squelch_db"] ),
+                     dict.count( "pre" ) ? boost::lexical_cast<size_t>( dict["pre"] ) : 0,
+                     dict.count( "post" ) ? boost::lexical_cast<size_t>( dict["post"] ) : 0 );
+  }
+
   set_center_freq( (get_freq_range().start() + get_freq_range().stop()) / 2.0 );
   set_sample_rate( get_sample_rates().start() );
   set_bandwidth( 0 );
@@ -160,19 +219,29 @@ airspy_source_c::airspy_source_c (const std::string &args)
 
 /* pack 4 sets of 12 bits into 3 sets 16 bits for the data transfer across the
  * USB bus. The default is is unpacked, to transfer 12 bits across the USB bus
- * in 16 bit words. libairspy transparently unpacks if packing is enabled */
+ * in 16 bit words. libairspy transparently unpacks if packing is enabled.
+ *
+ * Packing cuts the bulk bandwidth by 25% (30 MB/s instead of 40 MB/s at
+ * 10 Msps IQ, i.e. 20 Msps real on the wire) at the price of one extra pass over every buffer in the libairspy
+ * consumer thread. That pass is a handful of shifts and masks per sample and
+ * cheap compared to the float IQ conversion which runs in the same thread,
+ * so combine pack=1 with int16=1 to move the expensive part into work(). */
   if ( dict.count( "pack" ) )
   {
     bool pack = boost::lexical_cast<bool>( dict["pack"] );
     int ret = airspy_set_packing(_dev, (uint8_t)pack);
     AIRSPY_THROW_ON_ERROR(ret, "Failed to set USB bit packing")
-  }
 
-  _fifo = new boost::circular_buffer<gr_complex>(5000000);
-  if (!_fifo) {
-    throw std::runtime_error( std::string(__FUNCTION__) + " " +
-                              "Failed to allocate a sample FIFO!" );
+    if ( pack )
+      std::cerr << "Using 12 bit packed USB transfers" << std::endl;
   }
+
+  _tuning.allocate( [this] {
+    if ( _int16 )
+      _fifo_i16.resize( 2 * 5000000 );
+    else
+      _fifo.resize( 5000000 );
+  } );
 }
 
 /*
@@ -199,51 +268,38 @@ airspy_source_c::~airspy_source_c ()
     }
     _dev = NULL;
   }
-
-  if (_fifo)
-  {
-    delete _fifo;
-    _fifo = NULL;
-  }
 }
 
 int airspy_source_c::_airspy_rx_callback(airspy_transfer *transfer)
 {
   airspy_source_c *obj = (airspy_source_c *)transfer->ctx;
 
+  /* the consumer thread of libairspy */
+  obj->_tuning.apply_once();
+
   return obj->airspy_rx_callback((float *)transfer->samples, transfer->sample_count);
 }
 
 int airspy_source_c::airspy_rx_callback(void *samples, int sample_count)
 {
-  size_t i, n_avail, to_copy, num_samples = sample_count;
-  float *sample = (float *)samples;
+  size_t to_copy, num_samples = sample_count;
 
-  _fifo_lock.lock();
-
-  n_avail = _fifo->capacity() - _fifo->size();
-  to_copy = (n_avail < num_samples ? n_avail : num_samples);
-
-  for (i = 0; i < to_copy; i++ )
-  {
-    /* Push sample to the fifo */
-    _fifo->push_back( gr_complex( *sample, *(sample+1) ) );
-
-    /* offset to the next I+Q sample */
-    sample += 2;
+  if ( _int16 ) {
+    _record.write( samples, num_samples * 2 * sizeof(int16_t) );
+    to_copy = _fifo_i16.push( (const int16_t *)samples, num_samples * 2 ) / 2;
+  } else {
+    /* interleaved float I/Q has the memory layout of gr_complex */
+    to_copy = _fifo.push( (const gr_complex *)samples, num_samples );
   }
 
-  _fifo_lock.unlock();
-
-  /* We have made some new samples available to the consumer in work() */
-  if (to_copy) {
-    //std::cerr << "+" << std::flush;
-    _samp_avail.notify_one();
-  }
+  _latency.arrived( to_copy );
+  _tagger.stored( to_copy / _decimator.decimation() );
 
   /* Indicate overrun, if neccesary */
-  if (to_copy < num_samples)
-    std::cerr << "O" << std::flush;
+  if (to_copy < num_samples) {
+    _stats.overflow( num_samples - to_copy );
+    _tagger.lost( (num_samples - to_copy) / _decimator.decimation() );
+  }
 
   return 0; // TODO: return -1 on error/stop
 }
@@ -253,6 +309,17 @@ bool airspy_source_c::start()
   if ( ! _dev )
     return false;
 
+  _fifo.clear();
+  _fifo.resume();
+  _fifo_i16.clear();
+  _fifo_i16.resume();
+  _decimator.reset();
+  _tagger.reset();
+  _latency.reset();
+  _tuning.reset();
+  _dc.reset();
+  _record.start( get_sample_rate() * _decimator.decimation(), get_center_freq() );
+
   int ret = airspy_start_rx( _dev, _airspy_rx_callback, (void *)this );
   if ( ret != AIRSPY_SUCCESS ) {
     std::cerr << "Failed to start RX streaming (" << ret << ")" << std::endl;
@@ -267,7 +334,11 @@ bool airspy_source_c::stop()
   if ( ! _dev )
     return false;
 
+  _fifo.interrupt();
+  _fifo_i16.interrupt();
+
   int ret = airspy_stop_rx( _dev );
+  _record.stop();
   if ( ret != AIRSPY_SUCCESS ) {
     std::cerr << "Failed to stop RX streaming (" << ret << ")" << std::endl;
     return false;
@@ -290,23 +361,83 @@ int airspy_source_c::work( int noutput_items,
   if ( ! running )
     return WORK_DONE;
 
-  std::unique_lock<std::mutex> lock(_fifo_lock);
+  if ( "cs16" == _cpu_format ) {
+    if ( ! _fifo_i16.wait_read( noutput_items * 2 ) )
+      return WORK_DONE;
 
-  /* Wait until we have the requested number of samples */
-  int n_samples_avail = _fifo->size();
+    size_t lost;
+    _fifo_i16.pop( (int16_t *)output_items[0], noutput_items * 2, &lost );
+    if ( lost ) {
+      _latency.consumed( lost / 2 );
+      _stats.overflow( lost / 2 );
+      _tagger.skipped( nitems_written( 0 ), lost / 2 );
+    }
+    _latency.consumed( noutput_items );
+    _tagger.update( this, noutput_items );
+    _stats.delivered( noutput_items );
 
-  while (n_samples_avail < noutput_items) {
-    _samp_avail.wait(lock);
-    n_samples_avail = _fifo->size();
+    return noutput_items;
   }
 
-  for(int i = 0; i < noutput_items; ++i) {
-    out[i] = _fifo->at(0);
-    _fifo->pop_front();
+  const size_t decim = _decimator.decimation();
+  const size_t ninput = noutput_items * decim;
+
+  gr_complex *dst = out;
+  if ( decim > 1 ) {
+    if ( _conv.size() < ninput )
+      _conv.assign( ninput );
+    dst = _conv.data();
   }
 
+  /* Wait until we have the requested number of samples */
+  if ( _int16 ) {
+    if ( ! _fifo_i16.wait_read( ninput * 2 ) )
+      return WORK_DONE;
+
+    size_t done = 0;
+    while ( done < ninput ) {
+      size_t len;
+      const int16_t *span = _fifo_i16.read_span( len );
+      if ( size_t lost = _fifo_i16.discarded() ) {
+        _latency.consumed( lost / 2 );
+        _stats.overflow( lost / 2 );
+        _tagger.skipped( nitems_written( 0 ) + done / decim, lost / 2 / decim );
+      }
+
+      len = std::min( len / 2, ninput - done );
+
+      _dc.convert( span, dst + done, len, 32768.0f );
+
+      _fifo_i16.consume( len * 2 );
+      done += len;
+    }
+    _latency.consumed( ninput );
+  } else {
+    if ( ! _fifo.wait_read( ninput ) )
+      return WORK_DONE;
+
+    size_t lost;
+    _fifo.pop( dst, ninput, &lost );
+    if ( lost ) {
+      _latency.consumed( lost );
+      _stats.overflow( lost );
+      _tagger.skipped( nitems_written( 0 ), lost / decim );
+    }
+    _dc.process( dst, ninput );
+    _latency.consumed( ninput );
+  }
+
+  if ( decim > 1 )
+    _decimator.process( dst, ninput, out );
+  else
+    noutput_items = _dc.gate( this, out, noutput_items, &_tagger );
+
   //std::cerr << "-" << std::flush;
 
+  _dc.tag_levels( this, noutput_items, decim );
+  _tagger.update( this, noutput_items );
+  _stats.delivered( noutput_items );
+
   return noutput_items;
 }
 
@@ -340,17 +471,31 @@ std::vector<std::string> airspy_source_c::get_devices()
   return devices;
 }
 
+std::string airspy_source_c::get_cpu_format()
+{
+  return _cpu_format;
+}
+
 size_t airspy_source_c::get_num_channels()
 {
   return 1;
 }
 
+osmosdr::stream_stats_t airspy_source_c::get_stream_stats( size_t chan )
+{
+  osmosdr::stream_stats_t stats = _stats.get();
+  stats.high_water = std::max( _fifo.high_water(), _fifo_i16.high_water() / 2 );
+  stats.fill = _int16 ? _fifo_i16.read_available() / 2 : _fifo.read_available();
+  _latency.get( stats );
+  return stats;
+}
+
 osmosdr::meta_range_t airspy_source_c::get_sample_rates()
 {
   osmosdr::meta_range_t range;
 
   for (size_t i = 0; i < _sample_rates.size(); i++)
-    range += osmosdr::range_t( _sample_rates[i].first );
+    range += osmosdr::range_t( _sample_rates[i].first / _decimator.decimation() );
 
   return range;
 }
@@ -365,7 +510,7 @@ double airspy_source_c::set_sample_rate( double rate )
 
     for( unsigned int i = 0; i < _sample_rates.size(); i++ )
     {
-      if( _sample_rates[i].first == rate )
+      if( _sample_rates[i].first == rate * _decimator.decimation() )
       {
         samp_rate_index = _sample_rates[i].second;
 
@@ -382,6 +527,8 @@ double airspy_source_c::set_sample_rate( double rate )
     ret = airspy_set_samplerate( _dev, samp_rate_index );
     if ( AIRSPY_SUCCESS == ret ) {
       _sample_rate = rate;
+      _tagger.set_rate( rate );
+      _record.set_rate( rate * _decimator.decimation() );
     } else {
       AIRSPY_THROW_ON_ERROR( ret, AIRSPY_FUNC_STR( "airspy_set_samplerate", rate ) )
     }
@@ -395,6 +542,11 @@ double airspy_source_c::get_sample_rate()
   return _sample_rate;
 }
 
+double airspy_source_c::get_measured_sample_rate( size_t chan )
+{
+  return _tagger.measured_rate();
+}
+
 osmosdr::freq_range_t airspy_source_c::get_freq_range( size_t chan )
 {
   osmosdr::freq_range_t range;
@@ -415,6 +567,8 @@ double airspy_source_c::set_center_freq( double freq, size_t chan )
     ret = airspy_set_freq( _dev, uint64_t(corr_freq) );
     if ( AIRSPY_SUCCESS == ret ) {
       _center_freq = freq;
+      _tagger.set_freq( freq );
+      _record.set_freq( freq );
     } else {
       AIRSPY_THROW_ON_ERROR( ret, AIRSPY_FUNC_STR( "airspy_set_freq", corr_freq ) )
     }
@@ -647,6 +801,16 @@ std::string airspy_source_c::get_antenna( size_t chan )
   return "RX";
 }
 
+void airspy_source_c::set_dc_offset_mode( int mode, size_t chan )
+{
+  _dc.set_mode( mode );
+}
+
+void airspy_source_c::set_dc_offset( const std::complex<double> &offset, size_t chan )
+{
+  _dc.set_offset( offset );
+}
+
 double airspy_source_c::set_bandwidth( double bandwidth, size_t chan )
 {
   if (bandwidth == 0.f)
@@ -658,7 +822,11 @@ double airspy_source_c::set_bandwidth( double bandwidth, size_t chan )
     int     size;
     const float  *kernel;
 
-    decim = (int)(_sample_rate / bandwidth);
+    /* libairspy's float conversion filter is not used for 16 bit IQ */
+    if ( _int16 )
+      return get_bandwidth( chan );
+
+    decim = (int)(_sample_rate * _decimator.decimation() / bandwidth);
 //    if (decim < 2)
 //    {
 //      kernel = 0;
@@ -22,16 +22,19 @@
 #ifndef INCLUDED_AIRSPY_SOURCE_C_H
 #define INCLUDED_AIRSPY_SOURCE_C_H
 
-#include <boost/circular_buffer.hpp>
-
-#include <mutex>
-#include <condition_variable>
-
 #include <gnuradio/sync_block.h>
 
 #include <libairspy/airspy.h>
 
 #include "source_iface.h"
+#include "sample_ring.h"
+#include "rx_tagger.h"
+#include "stream_counters.h"
+#include "latency_probe.h"
+#include "thread_tuning.h"
+#include "dc_remover.h"
+#include "raw_recorder.h"
+#include "airspy_decimator.h"
 
 class airspy_source_c;
 
@@ -89,10 +92,13 @@ public:
   static std::vector< std::string > get_devices();
 
   size_t get_num_channels( void );
+  std::string get_cpu_format( void );
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
   double get_sample_rate( void );
+  double get_measured_sample_rate( size_t chan = 0 );
 
   osmosdr::freq_range_t get_freq_range( size_t chan = 0 );
   double set_center_freq( double freq, size_t chan = 0 );
@@ -118,6 +124,9 @@ public:
   std::string set_antenna( const std::string & antenna, size_t chan = 0 );
   std::string get_antenna( size_t chan = 0 );
 
+  void set_dc_offset_mode( int mode, size_t chan = 0 );
+  void set_dc_offset( const std::complex<double> &offset, size_t chan = 0 );
+
   double set_bandwidth( double bandwidth, size_t chan = 0 );
   double get_bandwidth( size_t chan = 0 );
   osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
@@ -128,9 +137,17 @@ private:
 
   airspy_device *_dev;
 
-  boost::circular_buffer<gr_complex> *_fifo;
-  std::mutex _fifo_lock;
-  std::condition_variable _samp_avail;
+  bool _int16;
+  std::string _cpu_format;
+  sample_ring<gr_complex> _fifo;
+  sample_ring<int16_t> _fifo_i16;
+  pooled_buffer<gr_complex> _conv;
+  airspy_decimator _decimator;
+  rx_tagger _tagger;
+  stream_counters _stats;
+  dc_remover _dc;
+  raw_recorder _record;          /**< see record= */
+  latency_probe _latency;
 
   std::vector< std::pair<double, uint32_t> > _sample_rates;
   double _sample_rate;
@@ -148,6 +165,8 @@ private:
   double _mix_gain;
   double _vga_gain;
   double _bandwidth;
+
+  thread_tuning _tuning;
 };
 
 #endif /* INCLUDED_AIRSPY_SOURCE_C_H */
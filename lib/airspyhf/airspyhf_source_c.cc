@@ -55,6 +55,10 @@ using namespace boost::assign;
 #define AIRSPYHF_FUNC_STR(func, arg) \
   boost::str(boost::format(func "(%1%)") % arg) + " has failed"
 
+/* samples buffered by default, and at most with low_latency=1 */
+#define FIFO_SIZE 5000000
+#define LOW_LATENCY_FIFO_SIZE 16384
+
 airspyhf_source_c_sptr make_airspyhf_source_c (const std::string & args)
 {
   return gnuradio::get_initial_sptr(new airspyhf_source_c (args));
@@ -84,12 +88,20 @@ airspyhf_source_c::airspyhf_source_c (const std::string &args)
     _dev(NULL),
     _sample_rate(0),
     _center_freq(0),
-    _freq_corr(0)
+    _freq_corr(0),
+    _low_latency(false),
+    _tuning(args)
 {
   int ret;
 
   dict_t dict = params_to_dict(args);
 
+  _stats.set_quiet( args_to_quiet( args ) );
+  _fifo.configure( args );
+
+  if ( dict.count( "low_latency" ) )
+    _low_latency = boost::lexical_cast<bool>( dict["low_latency"] );
+
   _dev = NULL;
   ret = airspyhf_open( &_dev );
   AIRSPYHF_THROW_ON_ERROR(ret, "Failed to open Airspy HF+ device")
@@ -116,11 +128,13 @@ airspyhf_source_c::airspyhf_source_c (const std::string &args)
   set_center_freq( (get_freq_range().start() + get_freq_range().stop()) / 2.0 );
   set_sample_rate( get_sample_rates().start() );
 
-  _fifo = new boost::circular_buffer<gr_complex>(5000000);
-  if (!_fifo) {
-    throw std::runtime_error( std::string(__FUNCTION__) + " " +
-                              "Failed to allocate a sample FIFO!" );
-  }
+  /* a small ring bounds the backlog work() can fall behind by */
+  const size_t fifo_size = _low_latency ? LOW_LATENCY_FIFO_SIZE : FIFO_SIZE;
+  _tuning.allocate( [this, fifo_size] { _fifo.resize( fifo_size ); } );
+
+  if ( _low_latency )
+    std::cerr << "Low latency mode, buffering " << _fifo.capacity()
+              << " samples" << std::endl;
 }
 
 /*
@@ -147,51 +161,31 @@ airspyhf_source_c::~airspyhf_source_c ()
     }
     _dev = NULL;
   }
-
-  if (_fifo)
-  {
-    delete _fifo;
-    _fifo = NULL;
-  }
 }
 
 int airspyhf_source_c::_airspyhf_rx_callback(airspyhf_transfer_t *transfer)
 {
   airspyhf_source_c *obj = (airspyhf_source_c *)transfer->ctx;
 
+  /* the consumer thread of libairspyhf */
+  obj->_tuning.apply_once();
+
   return obj->airspyhf_rx_callback((float *)transfer->samples, transfer->sample_count);
 }
 
 int airspyhf_source_c::airspyhf_rx_callback(void *samples, int sample_count)
 {
-  size_t i, n_avail, to_copy, num_samples = sample_count;
-  float *sample = (float *)samples;
-
-  _fifo_lock.lock();
-
-  n_avail = _fifo->capacity() - _fifo->size();
-  to_copy = (n_avail < num_samples ? n_avail : num_samples);
-
-  for (i = 0; i < to_copy; i++ )
-  {
-    /* Push sample to the fifo */
-    _fifo->push_back( gr_complex( *sample, *(sample+1) ) );
-
-    /* offset to the next I+Q sample */
-    sample += 2;
-  }
-
-  _fifo_lock.unlock();
+  size_t to_copy, num_samples = sample_count;
 
-  /* We have made some new samples available to the consumer in work() */
-  if (to_copy) {
-    //std::cerr << "+" << std::flush;
-    _samp_avail.notify_one();
-  }
+  /* interleaved float I/Q has the memory layout of gr_complex */
+  to_copy = _fifo.push( (const gr_complex *)samples, num_samples );
+  _tagger.stored( to_copy );
 
   /* Indicate overrun, if neccesary */
-  if (to_copy < num_samples)
-    std::cerr << "O" << std::flush;
+  if (to_copy < num_samples) {
+    _stats.overflow( num_samples - to_copy );
+    _tagger.lost( num_samples - to_copy );
+  }
 
   return 0; // TODO: return -1 on error/stop
 }
@@ -201,6 +195,11 @@ bool airspyhf_source_c::start()
   if ( ! _dev )
     return false;
 
+  _fifo.clear();
+  _fifo.resume();
+  _tagger.reset();
+  _tuning.reset();
+
   int ret = airspyhf_start( _dev, _airspyhf_rx_callback, (void *)this );
   if ( ret != AIRSPYHF_SUCCESS ) {
     std::cerr << "Failed to start RX streaming (" << ret << ")" << std::endl;
@@ -215,6 +214,8 @@ bool airspyhf_source_c::stop()
   if ( ! _dev )
     return false;
 
+  _fifo.interrupt();
+
   int ret = airspyhf_stop( _dev );
   if ( ret != AIRSPYHF_SUCCESS ) {
     std::cerr << "Failed to stop RX streaming (" << ret << ")" << std::endl;
@@ -238,21 +239,30 @@ int airspyhf_source_c::work( int noutput_items,
   if ( ! running )
     return WORK_DONE;
 
-  std::unique_lock<std::mutex> lock(_fifo_lock);
+  size_t lost = 0;
+
+  if ( _low_latency ) {
+    /* hand out whatever arrived instead of waiting for noutput_items */
+    if ( ! _fifo.wait_read( 1 ) )
+      return WORK_DONE;
 
-  /* Wait until we have the requested number of samples */
-  int n_samples_avail = _fifo->size();
+    noutput_items = _fifo.pop( out, noutput_items, &lost );
+  } else {
+    /* Wait until we have the requested number of samples */
+    if ( ! _fifo.wait_read( noutput_items ) )
+      return WORK_DONE;
 
-  while (n_samples_avail < noutput_items) {
-    _samp_avail.wait(lock);
-    n_samples_avail = _fifo->size();
+    _fifo.pop( out, noutput_items, &lost );
   }
 
-  for(int i = 0; i < noutput_items; ++i) {
-    out[i] = _fifo->at(0);
-    _fifo->pop_front();
+  if ( lost ) {
+    _stats.overflow( lost );
+    _tagger.skipped( nitems_written( 0 ), lost );
   }
 
+  _tagger.update( this, noutput_items );
+  _stats.delivered( noutput_items );
+
   return noutput_items;
 }
 
@@ -279,6 +289,14 @@ size_t airspyhf_source_c::get_num_channels()
   return 1;
 }
 
+osmosdr::stream_stats_t airspyhf_source_c::get_stream_stats( size_t chan )
+{
+  osmosdr::stream_stats_t stats = _stats.get();
+  stats.high_water = _fifo.high_water();
+  stats.fill = _fifo.read_available();
+  return stats;
+}
+
 osmosdr::meta_range_t airspyhf_source_c::get_sample_rates()
 {
   osmosdr::meta_range_t range;
@@ -316,6 +334,7 @@ double airspyhf_source_c::set_sample_rate( double rate )
     ret = airspyhf_set_samplerate( _dev, samp_rate_index );
     if ( AIRSPYHF_SUCCESS == ret ) {
       _sample_rate = rate;
+      _tagger.set_rate( rate );
     } else {
       AIRSPYHF_THROW_ON_ERROR( ret, AIRSPYHF_FUNC_STR( "airspyhf_set_samplerate", rate ) )
     }
@@ -329,6 +348,11 @@ double airspyhf_source_c::get_sample_rate()
   return _sample_rate;
 }
 
+double airspyhf_source_c::get_measured_sample_rate( size_t chan )
+{
+  return _tagger.measured_rate();
+}
+
 osmosdr::freq_range_t airspyhf_source_c::get_freq_range( size_t chan )
 {
   osmosdr::freq_range_t range;
@@ -346,6 +370,7 @@ double airspyhf_source_c::set_center_freq( double freq, size_t chan )
     ret = airspyhf_set_freq( _dev, freq );
     if ( AIRSPYHF_SUCCESS == ret ) {
       _center_freq = freq;
+      _tagger.set_freq( freq );
     } else {
       AIRSPYHF_THROW_ON_ERROR( ret, AIRSPYHF_FUNC_STR( "airspyhf_set_freq", freq ) )
     }
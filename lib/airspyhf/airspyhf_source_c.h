@@ -22,16 +22,15 @@
 #ifndef INCLUDED_AIRSPYHF_SOURCE_C_H
 #define INCLUDED_AIRSPYHF_SOURCE_C_H
 
-#include <boost/circular_buffer.hpp>
-
-#include <mutex>
-#include <condition_variable>
-
 #include <gnuradio/sync_block.h>
 
 #include <libairspyhf/airspyhf.h>
 
 #include "source_iface.h"
+#include "sample_ring.h"
+#include "rx_tagger.h"
+#include "stream_counters.h"
+#include "thread_tuning.h"
 
 class airspyhf_source_c;
 
@@ -75,10 +74,12 @@ public:
   static std::vector< std::string > get_devices();
 
   size_t get_num_channels( void );
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
   double get_sample_rate( void );
+  double get_measured_sample_rate( size_t chan = 0 );
 
   osmosdr::freq_range_t get_freq_range( size_t chan = 0 );
   double set_center_freq( double freq, size_t chan = 0 );
@@ -105,14 +106,17 @@ private:
 
   airspyhf_device *_dev;
 
-  boost::circular_buffer<gr_complex> *_fifo;
-  std::mutex _fifo_lock;
-  std::condition_variable _samp_avail;
+  sample_ring<gr_complex> _fifo;
+  rx_tagger _tagger;
+  stream_counters _stats;
 
   std::vector< std::pair<double, uint32_t> > _sample_rates;
   double _sample_rate;
   double _center_freq;
   double _freq_corr;
+  bool _low_latency;
+
+  thread_tuning _tuning;
 };
 
 #endif /* INCLUDED_AIRSPY_SOURCE_C_H */
@@ -21,12 +21,15 @@
 #ifndef OSMOSDR_ARG_HELPERS_H
 #define OSMOSDR_ARG_HELPERS_H
 
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
 #include <vector>
 #include <map>
 
 #include <gnuradio/io_signature.h>
 
+#include <boost/algorithm/string/case_conv.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/tokenizer.hpp>
 #include <ciso646>
@@ -109,6 +112,93 @@ inline dict_t params_to_dict( const std::string &params )
   return result;
 }
 
+/*!
+ * Size of one complex sample in the given cpu_format. The UHD spellings
+ * sc16 and sc8 are accepted as aliases for cs16 and cs8.
+ */
+inline size_t cpu_format_item_size( const std::string &format )
+{
+  if ( format.empty() || "fc32" == format )
+    return sizeof(gr_complex);
+
+  if ( "fc64" == format )
+    return 2 * sizeof(double);
+
+  if ( "cs16" == format || "sc16" == format )
+    return 2 * sizeof(int16_t);
+
+  if ( "cs8" == format || "sc8" == format || "cu8" == format )
+    return 2 * sizeof(int8_t);
+
+  throw std::runtime_error("Unsupported cpu_format '" + format + "'");
+}
+
+/*!
+ * The cpu_format a device argument asks for, empty if none. The soapy
+ * driver also takes SoapySDR's own format=CS16|CS8|CU8|CF32 for it.
+ */
+inline std::string dict_to_cpu_format( dict_t &dict )
+{
+  if ( dict.count( "cpu_format" ) )
+    return dict["cpu_format"];
+
+  if ( dict.count( "soapy" ) && dict.count( "format" ) ) {
+    std::string format = boost::algorithm::to_lower_copy( dict["format"] );
+    return "cf32" == format ? "fc32" : format;
+  }
+
+  return "";
+}
+
+/*!
+ * Parse the cpu_format device argument of a driver that can deliver its
+ * native integer samples. Only "fc32" (the default) and the formats listed
+ * in native are allowed.
+ */
+inline std::string args_to_cpu_format( const std::string &args,
+                                       const std::vector< std::string > &native )
+{
+  dict_t dict = params_to_dict( args );
+
+  std::string format = dict_to_cpu_format( dict );
+
+  if ( format.empty() )
+    return "fc32";
+
+  if ( "sc16" == format )
+    format = "cs16";
+  else if ( "sc8" == format )
+    format = "cs8";
+
+  if ( "fc32" == format ||
+       std::find( native.begin(), native.end(), format ) != native.end() )
+    return format;
+
+  std::string supported = "fc32";
+  for (std::string fmt : native)
+    supported += ", " + fmt;
+
+  throw std::runtime_error("Unsupported cpu_format '" + format +
+                           "', must be one of " + supported);
+}
+
+inline std::string args_to_cpu_format( const std::string &args,
+                                       const std::string &native )
+{
+  return args_to_cpu_format( args, std::vector< std::string >( 1, native ) );
+}
+
+/*!
+ * Parse the quiet device argument. When set, drivers count overflows and
+ * underruns for get_stream_stats() without printing "O"/"U" to stderr.
+ */
+inline bool args_to_quiet( const std::string &args )
+{
+  dict_t dict = params_to_dict( args );
+
+  return dict.count( "quiet" ) && "1" == dict["quiet"];
+}
+
 struct is_nchan_argument
 {
   bool operator ()(const std::string &str)
@@ -117,7 +207,12 @@ struct is_nchan_argument
   }
 };
 
-inline gr::io_signature::sptr args_to_io_signature( const std::string &args )
+/*!
+ * \param cpu_format size the streams according to the cpu_format argument
+ * of every device instead of assuming complex float, used by the sources
+ */
+inline gr::io_signature::sptr args_to_io_signature( const std::string &args,
+                                                    bool cpu_format = false )
 {
   size_t max_nchan = 0;
   size_t dev_nchan = 0;
@@ -139,18 +234,29 @@ inline gr::io_signature::sptr args_to_io_signature( const std::string &args )
                   arg_list.end() );
 
   // try to parse device specific nchan values, assume 1 channel if none given
+  std::vector<int> sizes;
 
   for (std::string arg : arg_list)
   {
     dict_t dict = params_to_dict(arg);
+    size_t n = 1; // assume one channel if none given via args
+
     if (dict.count("nchan"))
-    {
-      dev_nchan += boost::lexical_cast<size_t>( dict["nchan"] );
-    }
-    else // no channels given via args
-    {
-      dev_nchan++; // assume one channel
+      n = boost::lexical_cast<size_t>( dict["nchan"] );
+
+    /* the channelizer of a source outputs the channels= list instead */
+    if (cpu_format && dict.count("channels")) {
+      n = std::count( dict["channels"].begin(), dict["channels"].end(), ':' ) + 1;
+      dev_nchan += n;
+      sizes.insert( sizes.end(), n, sizeof(gr_complex) );
+      continue;
     }
+
+    dev_nchan += n;
+    sizes.insert( sizes.end(), n,
+                  cpu_format ?
+                  cpu_format_item_size( dict_to_cpu_format( dict ) ) :
+                  sizeof(gr_complex) );
   }
 
   // if at least one nchan was given, perform a sanity check
@@ -158,7 +264,11 @@ inline gr::io_signature::sptr args_to_io_signature( const std::string &args )
     throw std::runtime_error("Wrong device arguments specified. Missing nchan?");
 
   const size_t nchan = std::max<size_t>(dev_nchan, 1); // assume at least one
-  return gr::io_signature::make(nchan, nchan, sizeof(gr_complex));
+
+  if ( sizes.empty() )
+    sizes.push_back( sizeof(gr_complex) );
+
+  return gr::io_signature::makev(nchan, nchan, sizes);
 }
 
 #endif // OSMOSDR_ARG_HELPERS_H
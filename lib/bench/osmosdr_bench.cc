@@ -0,0 +1,634 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Hardware-free micro benchmark of the driver data paths.
+ *
+ * Every case replays synthetic transfers through the same ring buffers and
+ * conversion kernels a driver uses between its device callback and work(),
+ * with the transfer sizes and ring dimensions of that driver. Producer and
+ * consumer run alternately on one thread, so the MS/s figure is the
+ * throughput of a single core.
+ *
+ * usage: osmosdr_bench [--format=text|csv|json] [--seconds=N] [filter]
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+
+#include "sample_convert.h"
+#include "sample_ring.h"
+#include "soft_agc.h"
+
+/*
+ * Count heap allocations, a data path is expected to run without any once
+ * streaming has started.
+ */
+static std::atomic<uint64_t> g_allocs( 0 );
+
+void *operator new( size_t size )
+{
+  g_allocs.fetch_add( 1, std::memory_order_relaxed );
+  if ( void *p = malloc( size ? size : 1 ) )
+    return p;
+  throw std::bad_alloc();
+}
+
+void *operator new[]( size_t size )
+{
+  return operator new( size );
+}
+
+/* out of line, so the compiler does not pair malloc() with delete */
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void operator delete( void *p ) noexcept { free( p ); }
+BENCH_NOINLINE void operator delete[]( void *p ) noexcept { free( p ); }
+BENCH_NOINLINE void operator delete( void *p, size_t ) noexcept { free( p ); }
+BENCH_NOINLINE void operator delete[]( void *p, size_t ) noexcept { free( p ); }
+
+/* items handed to work() per call, a typical GNU Radio output buffer */
+#define WORK_ITEMS 8192
+
+/* rtl_source_c and hackrf_source_c */
+#define USB_BUF_LEN (16 * 32 * 512)
+#define USB_BUF_NUM 15
+
+/* airspy_source_c */
+#define AIRSPY_TRANSFER 65536
+#define AIRSPY_FIFO 5000000
+
+/* bladerf_common */
+#define BLADERF_SAMPLES_PER_BUFFER (4 * 1024)
+#define BLADERF_NUM_BUFFERS 512
+
+/* rfspace_source_c, 1440 payload bytes per NetSDR/SDR-IP datagram */
+#define RFSPACE_PAYLOAD 1440
+#define RFSPACE_BATCH 32
+
+class bench_case
+{
+public:
+  bench_case( const std::string &name, const std::string &format ) :
+    _name( name ), _format( format ) {}
+  virtual ~bench_case() {}
+
+  const std::string &name() const { return _name; }
+  const std::string &format() const { return _format; }
+
+  /*! replay one device transfer and drain it, returns samples per channel */
+  virtual size_t iterate() = 0;
+
+protected:
+  static void fill( void *buf, size_t len )
+  {
+    unsigned char *p = (unsigned char *)buf;
+    uint32_t x = 0x12345678;
+
+    for ( size_t i = 0; i < len; i++ ) {
+      x = x * 1664525 + 1013904223;
+      p[i] = x >> 24;
+    }
+  }
+
+  std::string _name;
+  std::string _format;
+};
+
+/* the conversions with set_dc_offset_mode( DCOffsetAutomatic ), see dc_remover */
+static gr_complex bench_dc;
+
+static void convert_cu8_fc32_auto_dc( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  convert_cu8_fc32_dc( in, out, nitems, bench_dc, 1e-5f );
+}
+
+static void convert_cs8_fc32_auto_dc( const int8_t *in, gr_complex *out, size_t nitems )
+{
+  convert_cs8_fc32_dc( in, out, nitems, bench_dc, 1e-5f );
+}
+
+/* the same with soft_agc=-20, see soft_agc */
+static soft_agc bench_agc;
+
+static void convert_cu8_fc32_agc_dc( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  sample_level_t level;
+  convert_cu8_fc32_agc( in, out, nitems, bench_dc, 1e-5f, bench_agc.gain(), level );
+  bench_agc.update( level.power, nitems );
+}
+
+static void convert_cs8_fc32_agc_dc( const int8_t *in, gr_complex *out, size_t nitems )
+{
+  sample_level_t level;
+  convert_cs8_fc32_agc( in, out, nitems, bench_dc, 1e-5f, bench_agc.gain(), level );
+  bench_agc.update( level.power, nitems );
+}
+
+/*
+ * Device callback pushes bytes into a sample_ring, work() converts out of
+ * the contiguous read spans (rtl_source_c, hackrf_source_c).
+ */
+template <typename T>
+class usb_source_case : public bench_case
+{
+public:
+  typedef void (*convert_fn)( const T *, gr_complex *, size_t );
+
+  usb_source_case( const std::string &name, const std::string &format,
+                   convert_fn convert ) :
+    bench_case( name, format ),
+    _convert( convert ),
+    _transfer( USB_BUF_LEN ),
+    _out( WORK_ITEMS )
+  {
+    _ring.resize( USB_BUF_NUM * USB_BUF_LEN );
+    fill( &_transfer[0], _transfer.size() );
+  }
+
+  size_t iterate()
+  {
+    _ring.push( &_transfer[0], _transfer.size() );
+
+    size_t produced = 0;
+    while ( _ring.read_available() ) {
+      size_t len;
+      const T *buf = _ring.read_span( len );
+      const size_t nout = std::min( size_t(WORK_ITEMS), len / 2 );
+
+      _convert( buf, &_out[0], nout );
+      _ring.consume( nout * 2 );
+      produced += nout;
+    }
+
+    return produced;
+  }
+
+private:
+  convert_fn _convert;
+  sample_ring<T> _ring;
+  std::vector<T> _transfer;
+  std::vector<gr_complex> _out;
+};
+
+/* airspy_source_c with int16=1, raw samples are converted in work() */
+class airspy_i16_case : public bench_case
+{
+public:
+  airspy_i16_case() :
+    bench_case( "airspy_source_c", "cs16" ),
+    _transfer( 2 * AIRSPY_TRANSFER ),
+    _out( WORK_ITEMS )
+  {
+    _fifo.resize( 2 * AIRSPY_FIFO );
+    fill( &_transfer[0], _transfer.size() * sizeof(int16_t) );
+  }
+
+  size_t iterate()
+  {
+    _fifo.push( &_transfer[0], _transfer.size() );
+
+    size_t produced = 0;
+    while ( _fifo.read_available() ) {
+      size_t done = 0;
+      while ( done < WORK_ITEMS && _fifo.read_available() ) {
+        size_t len;
+        const int16_t *span = _fifo.read_span( len );
+        len = std::min( len / 2, WORK_ITEMS - done );
+
+        gr_complex *out = &_out[done];
+        convert_cs16_fc32_deinterleave( span, &out, 1, len, 32768.0f );
+        _fifo.consume( len * 2 );
+        done += len;
+      }
+      produced += done;
+    }
+
+    return produced;
+  }
+
+private:
+  sample_ring<int16_t> _fifo;
+  std::vector<int16_t> _transfer;
+  std::vector<gr_complex> _out;
+};
+
+/* airspy_source_c default, libairspy converts, the fifo copies fc32 */
+class airspy_fc32_case : public bench_case
+{
+public:
+  airspy_fc32_case() :
+    bench_case( "airspy_source_c", "fc32" ),
+    _transfer( AIRSPY_TRANSFER ),
+    _out( WORK_ITEMS )
+  {
+    _fifo.resize( AIRSPY_FIFO );
+    fill( &_transfer[0], _transfer.size() * sizeof(gr_complex) );
+  }
+
+  size_t iterate()
+  {
+    _fifo.push( &_transfer[0], _transfer.size() );
+
+    size_t produced = 0;
+    while ( size_t n = _fifo.pop( &_out[0], WORK_ITEMS ) )
+      produced += n;
+
+    return produced;
+  }
+
+private:
+  sample_ring<gr_complex> _fifo;
+  std::vector<gr_complex> _transfer;
+  std::vector<gr_complex> _out;
+};
+
+/*
+ * bladerf_source_c with async=1: libbladeRF buffers circulate through the
+ * _free and _full rings, work() splits the SC16 Q11 multiplex per channel.
+ */
+class bladerf_case : public bench_case
+{
+public:
+  explicit bladerf_case( size_t nchan ) :
+    bench_case( "bladerf_source_c", nchan > 1 ? "cs16x2" : "cs16" ),
+    _nchan( nchan ),
+    _storage( BLADERF_NUM_BUFFERS * BLADERF_SAMPLES_PER_BUFFER * 2 ),
+    _bufs( BLADERF_NUM_BUFFERS ),
+    _out( nchan, std::vector<gr_complex>( WORK_ITEMS ) ),
+    _outp( nchan )
+  {
+    fill( &_storage[0], _storage.size() * sizeof(int16_t) );
+
+    for ( size_t i = 0; i < _bufs.size(); i++ )
+      _bufs[i] = &_storage[i * BLADERF_SAMPLES_PER_BUFFER * 2];
+    for ( size_t c = 0; c < nchan; c++ )
+      _outp[c] = &_out[c][0];
+
+    _full.resize( BLADERF_NUM_BUFFERS );
+    _free.resize( BLADERF_NUM_BUFFERS );
+    _free.push( &_bufs[0], _bufs.size() );
+  }
+
+  size_t iterate()
+  {
+    /* stream callback: hand the filled buffer over, take a free one */
+    void *buf;
+    if ( _free.pop( &buf, 1 ) == 1 )
+      _full.push( &buf, 1 );
+
+    /* work(): drain the buffer into the per channel outputs */
+    size_t produced = 0;
+    while ( _full.pop( &buf, 1 ) == 1 ) {
+      const size_t nitems = BLADERF_SAMPLES_PER_BUFFER / _nchan;
+      const int16_t *in = (const int16_t *)buf;
+
+      for ( size_t done = 0; done < nitems; ) {
+        const size_t n = std::min( size_t(WORK_ITEMS), nitems - done );
+        convert_cs16_fc32_deinterleave( in + 2 * _nchan * done, &_outp[0],
+                                        _nchan, n, 2048.0f );
+        done += n;
+      }
+
+      _free.push( &buf, 1 );
+      produced += nitems;
+    }
+
+    return produced;
+  }
+
+private:
+  size_t _nchan;
+  std::vector<int16_t> _storage;
+  std::vector<void *> _bufs;
+  sample_ring<void *> _full;
+  sample_ring<void *> _free;
+  std::vector<std::vector<gr_complex> > _out;
+  std::vector<gr_complex *> _outp;
+};
+
+/*
+ * rfspace_source_c: a batch of datagrams is converted straight into the
+ * fifo through write_span() and read back by work().
+ */
+class rfspace_case : public bench_case
+{
+public:
+  explicit rfspace_case( bool is_24_bit ) :
+    bench_case( "rfspace_source_c", is_24_bit ? "cs24" : "cs16" ),
+    _24_bit( is_24_bit ),
+    _payload( RFSPACE_PAYLOAD ),
+    _out( WORK_ITEMS )
+  {
+    _fifo.resize( 5000000 );
+    fill( &_payload[0], _payload.size() );
+  }
+
+  size_t iterate()
+  {
+    const size_t sample_size = _24_bit ? 6 : 4;
+    const size_t rx_samples = RFSPACE_PAYLOAD / sample_size;
+
+    for ( int d = 0; d < RFSPACE_BATCH; d++ ) {
+      for ( size_t to_copy = 0; to_copy < rx_samples; ) {
+        size_t n_avail;
+        gr_complex *out = _fifo.write_span( n_avail );
+
+        n_avail = std::min( n_avail, rx_samples - to_copy );
+        if ( ! n_avail )
+          break;
+
+        if ( _24_bit )
+          convert_cs24_fc32( &_payload[sample_size * to_copy], out, n_avail );
+        else
+          convert_cs16_fc32_deinterleave( (const int16_t *)&_payload[sample_size * to_copy],
+                                          &out, 1, n_avail, 32768.0f );
+
+        _fifo.commit( n_avail );
+        to_copy += n_avail;
+      }
+    }
+
+    size_t produced = 0;
+    while ( size_t n = _fifo.pop( &_out[0], WORK_ITEMS ) )
+      produced += n;
+
+    return produced;
+  }
+
+private:
+  bool _24_bit;
+  sample_ring<gr_complex> _fifo;
+  std::vector<unsigned char> _payload;
+  std::vector<gr_complex> _out;
+};
+
+/*
+ * hackrf_sink_c: work() converts into the staging buffer, complete buffers
+ * are copied into the circular buffer the TX callback drains.
+ */
+class hackrf_sink_case : public bench_case
+{
+public:
+  hackrf_sink_case() :
+    bench_case( "hackrf_sink_c", "cs8" ),
+    _in( WORK_ITEMS ),
+    _buf( USB_BUF_LEN ),
+    _cbuf( USB_BUF_NUM * USB_BUF_LEN ),
+    _buf_used( 0 ),
+    _head( 0 )
+  {
+    for ( size_t i = 0; i < _in.size(); i++ )
+      _in[i] = gr_complex( (i % 255) / 255.0f - 0.5f, (i % 127) / 127.0f - 0.5f );
+  }
+
+  size_t iterate()
+  {
+    size_t consumed = 0;
+
+    while ( consumed < USB_BUF_LEN / 2 ) {
+      const size_t remaining = ( USB_BUF_LEN - _buf_used ) / 2;
+      const size_t count = std::min( size_t(WORK_ITEMS), remaining );
+
+      convert_fc32_cs8( &_in[0], &_buf[_buf_used], count );
+      _buf_used += count * 2;
+      consumed += count;
+
+      if ( _buf_used == USB_BUF_LEN ) {
+        /* cb_push_back(), followed by the TX callback cb_pop_front() */
+        memcpy( &_cbuf[_head], &_buf[0], USB_BUF_LEN );
+        _head = ( _head + USB_BUF_LEN ) % _cbuf.size();
+        _buf_used = 0;
+      }
+    }
+
+    return consumed;
+  }
+
+private:
+  std::vector<gr_complex> _in;
+  std::vector<int8_t> _buf;
+  std::vector<int8_t> _cbuf;
+  size_t _buf_used;
+  size_t _head;
+};
+
+struct bench_result
+{
+  std::string name;
+  std::string format;
+  uint64_t samples;
+  double seconds;
+  double msps;
+  double cycles_per_sample; /* negative if there is no cycle counter */
+  uint64_t allocs;
+};
+
+static uint64_t read_cycles()
+{
+#ifdef HAVE_RDTSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static bench_result run( bench_case &bc, double seconds )
+{
+  typedef std::chrono::steady_clock clock;
+
+  /* warm up caches and branch predictors before the timed loop */
+  for ( int i = 0; i < 16; i++ )
+    bc.iterate();
+
+  bench_result res;
+  res.name = bc.name();
+  res.format = bc.format();
+  res.samples = 0;
+
+  const uint64_t allocs = g_allocs.load();
+  const uint64_t cycles = read_cycles();
+  const clock::time_point start = clock::now();
+  const clock::time_point deadline =
+      start + std::chrono::duration_cast<clock::duration>(
+                std::chrono::duration<double>( seconds ) );
+  clock::time_point now;
+
+  do {
+    for ( int i = 0; i < 16; i++ )
+      res.samples += bc.iterate();
+    now = clock::now();
+  } while ( now < deadline );
+
+  const uint64_t elapsed_cycles = read_cycles() - cycles;
+
+  res.allocs = g_allocs.load() - allocs;
+  res.seconds = std::chrono::duration<double>( now - start ).count();
+  res.msps = res.samples / res.seconds / 1e6;
+#ifdef HAVE_RDTSC
+  res.cycles_per_sample = double(elapsed_cycles) / res.samples;
+#else
+  (void)elapsed_cycles;
+  res.cycles_per_sample = -1;
+#endif
+
+  return res;
+}
+
+static void print_results( const std::vector<bench_result> &results,
+                           const std::string &format )
+{
+  if ( format == "csv" ) {
+    printf( "case,format,arch,samples,seconds,msps,cycles_per_sample,allocs\n" );
+    for ( size_t i = 0; i < results.size(); i++ ) {
+      const bench_result &r = results[i];
+      printf( "%s,%s,%s,%llu,%.3f,%.2f,", r.name.c_str(), r.format.c_str(),
+              sample_convert_arch(), (unsigned long long)r.samples, r.seconds,
+              r.msps );
+      if ( r.cycles_per_sample >= 0 )
+        printf( "%.3f", r.cycles_per_sample );
+      printf( ",%llu\n", (unsigned long long)r.allocs );
+    }
+  } else if ( format == "json" ) {
+    printf( "{\n  \"arch\": \"%s\",\n  \"results\": [\n", sample_convert_arch() );
+    for ( size_t i = 0; i < results.size(); i++ ) {
+      const bench_result &r = results[i];
+      printf( "    { \"case\": \"%s\", \"format\": \"%s\", \"samples\": %llu, "
+              "\"seconds\": %.3f, \"msps\": %.2f, \"cycles_per_sample\": ",
+              r.name.c_str(), r.format.c_str(), (unsigned long long)r.samples,
+              r.seconds, r.msps );
+      if ( r.cycles_per_sample >= 0 )
+        printf( "%.3f", r.cycles_per_sample );
+      else
+        printf( "null" );
+      printf( ", \"allocs\": %llu }%s\n", (unsigned long long)r.allocs,
+              i + 1 < results.size() ? "," : "" );
+    }
+    printf( "  ]\n}\n" );
+  } else {
+    printf( "conversion kernels: %s\n\n", sample_convert_arch() );
+    printf( "%-18s %-7s %12s %12s %8s\n",
+            "case", "format", "MS/s/core", "cycles/S", "allocs" );
+    for ( size_t i = 0; i < results.size(); i++ ) {
+      const bench_result &r = results[i];
+      char cps[32] = "n/a";
+      if ( r.cycles_per_sample >= 0 )
+        snprintf( cps, sizeof(cps), "%.3f", r.cycles_per_sample );
+      printf( "%-18s %-7s %12.2f %12s %8llu\n", r.name.c_str(),
+              r.format.c_str(), r.msps, cps, (unsigned long long)r.allocs );
+    }
+  }
+}
+
+static void usage( const char *argv0 )
+{
+  fprintf( stderr,
+           "usage: %s [--format=text|csv|json] [--seconds=N] [filter]\n"
+           "  filter selects the cases whose name or name/format contains it\n",
+           argv0 );
+}
+
+int main( int argc, char **argv )
+{
+  std::string format = "text";
+  std::string filter;
+  double seconds = 1.0;
+
+  for ( int i = 1; i < argc; i++ ) {
+    std::string arg = argv[i];
+
+    if ( arg.compare( 0, 9, "--format=" ) == 0 ) {
+      format = arg.substr( 9 );
+      if ( format != "text" && format != "csv" && format != "json" ) {
+        usage( argv[0] );
+        return 1;
+      }
+    } else if ( arg.compare( 0, 10, "--seconds=" ) == 0 ) {
+      seconds = atof( arg.c_str() + 10 );
+      if ( seconds <= 0 ) {
+        usage( argv[0] );
+        return 1;
+      }
+    } else if ( arg == "-h" || arg == "--help" ) {
+      usage( argv[0] );
+      return 0;
+    } else {
+      filter = arg;
+    }
+  }
+
+  std::vector<bench_case *> cases;
+  cases.push_back( new usb_source_case<uint8_t>( "rtl_source_c", "cu8",
+                                                 convert_cu8_fc32 ) );
+  cases.push_back( new usb_source_case<int8_t>( "hackrf_source_c", "cs8",
+                                                convert_cs8_fc32 ) );
+  cases.push_back( new usb_source_case<uint8_t>( "rtl_source_c", "cu8+dc",
+                                                 convert_cu8_fc32_auto_dc ) );
+  cases.push_back( new usb_source_case<int8_t>( "hackrf_source_c", "cs8+dc",
+                                                convert_cs8_fc32_auto_dc ) );
+  cases.push_back( new usb_source_case<uint8_t>( "rtl_source_c", "cu8+agc",
+                                                 convert_cu8_fc32_agc_dc ) );
+  cases.push_back( new usb_source_case<int8_t>( "hackrf_source_c", "cs8+agc",
+                                                convert_cs8_fc32_agc_dc ) );
+  cases.push_back( new airspy_fc32_case() );
+  cases.push_back( new airspy_i16_case() );
+  cases.push_back( new bladerf_case( 1 ) );
+  cases.push_back( new bladerf_case( 2 ) );
+  cases.push_back( new rfspace_case( false ) );
+  cases.push_back( new rfspace_case( true ) );
+  cases.push_back( new hackrf_sink_case() );
+
+  std::vector<bench_result> results;
+  for ( size_t i = 0; i < cases.size(); i++ ) {
+    const std::string id = cases[i]->name() + "/" + cases[i]->format();
+
+    if ( filter.empty() || id.find( filter ) != std::string::npos )
+      results.push_back( run( *cases[i], seconds ) );
+
+    delete cases[i];
+  }
+
+  print_results( results, format );
+
+  return 0;
+}
@@ -39,6 +39,7 @@
 #include <boost/lexical_cast.hpp>
 
 #include "bladerf_common.h"
+#include "device_keepalive.h"
 
 /* Defaults for these values. */
 static size_t const NUM_BUFFERS = 512;
@@ -140,10 +141,17 @@ bladerf_common::bladerf_common() :
   _samples_per_buffer(NUM_SAMPLES_PER_BUFFER),
   _num_transfers(NUM_TRANSFERS),
   _stream_timeout(STREAM_TIMEOUT_MS),
-  _format(BLADERF_FORMAT_SC16_Q11)
+  _format(BLADERF_FORMAT_SC16_Q11),
+  _keep_open(0)
 {
 }
 
+bladerf_common::~bladerf_common()
+{
+  /* the next block for this device finds it in _devs meanwhile */
+  device_keepalive::get().hold(_dev, _keep_open);
+}
+
 /******************************************************************************
  * Protected methods
  ******************************************************************************/
@@ -158,6 +166,8 @@ void bladerf_common::init(dict_t const &dict, bladerf_direction direction)
   _pfx = boost::str(boost::format("[bladeRF %s] ")
           % (direction == BLADERF_TX ? "sink" : "source"));
 
+  _keep_open = args_to_keep_open(dict);
+
   /* libbladeRF verbosity */
   if (dict.count("verbosity")) {
     set_verbosity(_get(dict, "verbosity"));
@@ -313,10 +323,25 @@ void bladerf_common::init(dict_t const &dict, bladerf_direction direction)
     _stream_timeout = boost::lexical_cast<unsigned int>(_get(dict, "stream_timeout_ms"));
   }
 
-  if (dict.count("enable_metadata") > 0) {
-    _format = BLADERF_FORMAT_SC16_Q11_META;
+  bool sc8 = false;
+
+  if (dict.count("format")) {
+    std::string format = _get(dict, "format");
+
+    if (format == "sc8") {
+#ifdef BLADERF_HAVE_SC8
+      sc8 = true;
+#else
+      BLADERF_WARNING("SC8 samples require libbladeRF 2.5.0 or later, "
+                      "falling back to sc16");
+#endif
+    } else if (format != "sc16") {
+      BLADERF_WARNING("Invalid format: " << format);
+    }
   }
 
+  set_format(sc8, dict.count("enable_metadata") > 0);
+
   /* Require value to be >= 2 so we can ensure we have twice as many
    * buffers as transfers */
   if (_num_buffers <= 1) {
@@ -353,6 +378,44 @@ void bladerf_common::init(dict_t const &dict, bladerf_direction direction)
                 % _num_transfers));
 }
 
+void bladerf_common::set_format(bool sc8, bool metadata)
+{
+#ifdef BLADERF_HAVE_SC8
+  if (sc8) {
+    _format = metadata ? BLADERF_FORMAT_SC8_Q7_META : BLADERF_FORMAT_SC8_Q7;
+    return;
+  }
+#endif
+
+  _format = metadata ? BLADERF_FORMAT_SC16_Q11_META : BLADERF_FORMAT_SC16_Q11;
+}
+
+bool bladerf_common::format_is_sc8()
+{
+#ifdef BLADERF_HAVE_SC8
+  return BLADERF_FORMAT_SC8_Q7 == _format ||
+         BLADERF_FORMAT_SC8_Q7_META == _format;
+#else
+  return false;
+#endif
+}
+
+bool bladerf_common::format_has_metadata()
+{
+#ifdef BLADERF_HAVE_SC8
+  if (BLADERF_FORMAT_SC8_Q7_META == _format) {
+    return true;
+  }
+#endif
+
+  return BLADERF_FORMAT_SC16_Q11_META == _format;
+}
+
+size_t bladerf_common::format_sample_size()
+{
+  return format_is_sc8() ? 2 * sizeof(int8_t) : 2 * sizeof(int16_t);
+}
+
 std::vector<std::string> bladerf_common::devices()
 {
   struct bladerf_devinfo *devices;
@@ -107,6 +107,7 @@ public:
    * Public methods
    ****************************************************************************/
   bladerf_common();
+  ~bladerf_common();
 
 protected:
   /*****************************************************************************
@@ -125,10 +126,19 @@ protected:
    * REQUIRED:
    *  bladerf         a valid instance or serial number
    * USB INTERFACE CONTROL:
+   *  async           1 to receive through the asynchronous stream API
+   *                    ** Note: valid on receive channels only
+   *  latency         1 to measure callback to work() latency, needs async=1
+   *  convert_threads number of threads converting to fc32 (default: 1)
+   *                    ** Note: valid on receive channels only
+   *  convert_cpu     first core to bind the extra conversion threads to
    *  buffers         (default: NUM_BUFFERS)
    *  buflen          (default: NUM_SAMPLES_PER_BUFFER)
    *  stream_timeout  valid time in milliseconds (default: 3000)
    *  transfers       (default: NUM_TRANSFERS)
+   *  format          sc16, sc8 (default: sc16)
+   *                    ** Note: sc8 halves the USB bandwidth at the cost of
+   *                       dynamic range, requires libbladeRF >= 2.5.0
    * FPGA CONTROL:
    *  enable_metadata 1 to enable metadata
    *  fpga            a path to a valid .rbf file
@@ -146,12 +156,23 @@ protected:
    *  tamer           internal, external_1pps, external (default: internal)
    *  xb200           auto, auto3db, 50M, 144M, 222M, custom (default: auto)
    * MISC:
+   *  keep_open       seconds to keep the device open after the last block
+   *                    using it is gone, for the next one (default: 0)
    *  verbosity       verbose, debug, info, warning, error, critical, silent
    *                    (default: info)
    *                    ** Note: applies only to libbladeRF logging
    */
   void init(dict_t const &dict, bladerf_direction direction);
 
+  /* Select the sample format used on the wire */
+  void set_format(bool sc8, bool metadata);
+  /* Is the wire format SC8 Q7 instead of SC16 Q11? */
+  bool format_is_sc8();
+  /* Does the wire format carry metadata? */
+  bool format_has_metadata();
+  /* Size of one complex sample on the wire in bytes */
+  size_t format_sample_size();
+
   /* Get a vector of available devices */
   static std::vector<std::string> devices();
   /* Get the type of the open bladeRF board */
@@ -253,6 +274,7 @@ protected:
   unsigned int _stream_timeout; /**< timeout for backend transfers */
 
   bladerf_format _format;       /**< sample format to use */
+  double _keep_open;            /**< seconds _dev outlives this block */
 
   bladerf_channel_map _chanmap; /**< map of antennas to channels */
   bladerf_channel_enable_map _enables;  /**< enabled channels */
@@ -75,4 +75,10 @@
     #define bladerf_get_board_name(name) "bladerf1"
 
 #endif // libbladeRF < 1.8.1
+
+/* SC8 Q7 samples were added with libbladeRF 2.5.0 */
+#if defined(LIBBLADERF_API_VERSION) && (LIBBLADERF_API_VERSION >= 0x02050000)
+    #define BLADERF_HAVE_SC8
+#endif
+
 #endif // INCLUDED_BLADERF_COMPAT_H
@@ -39,6 +39,8 @@
 #include <volk/volk.h>
 
 #include "arg_helpers.h"
+#include "buffer_pool.h"
+#include "sample_convert.h"
 #include "bladerf_sink_c.h"
 #include "osmosdr/sink.h"
 
@@ -68,13 +70,16 @@ bladerf_sink_c::bladerf_sink_c(const std::string &args) :
   gr::sync_block( "bladerf_sink_c",
                   args_to_io_signature(args),
                   gr::io_signature::make(0, 0, 0)),
-  _16icbuf(NULL),
+  _rawbuf(NULL),
   _32fcbuf(NULL),
+  _convert(NULL),
   _in_burst(false),
   _running(false)
 {
   dict_t dict = params_to_dict(args);
 
+  _stats.set_quiet(args_to_quiet(args));
+
   /* Perform src/sink agnostic initializations */
   init(dict, BLADERF_TX);
 
@@ -155,6 +160,11 @@ size_t bladerf_sink_c::get_num_channels()
   return input_signature()->max_streams();
 }
 
+osmosdr::stream_stats_t bladerf_sink_c::get_stream_stats(size_t chan)
+{
+  return _stats.get();
+}
+
 bool bladerf_sink_c::start()
 {
   int status;
@@ -182,11 +192,11 @@ bool bladerf_sink_c::start()
     }
   }
 
-  /* Allocate memory for conversions in work() */
-  size_t alignment = volk_get_alignment();
-
-  _16icbuf = reinterpret_cast<int16_t *>(volk_malloc(2*_samples_per_buffer*sizeof(int16_t), alignment));
-  _32fcbuf = reinterpret_cast<gr_complex *>(volk_malloc(_samples_per_buffer*sizeof(gr_complex), alignment));
+  /* Allocate memory for conversions in work(), page aligned and reused
+   * across restarts by the buffer pool */
+  _rawbuf = buffer_pool::get().acquire(_samples_per_buffer*format_sample_size());
+  _32fcbuf = reinterpret_cast<gr_complex *>(buffer_pool::get().acquire(_samples_per_buffer*sizeof(gr_complex)));
+  _convert = select_convert();
 
   _running = true;
 
@@ -219,9 +229,9 @@ bool bladerf_sink_c::stop()
   }
 
   /* Deallocate conversion memory */
-  volk_free(_16icbuf);
-  volk_free(_32fcbuf);
-  _16icbuf = NULL;
+  buffer_pool::get().release(_rawbuf);
+  buffer_pool::get().release(_32fcbuf);
+  _rawbuf = NULL;
   _32fcbuf = NULL;
 
   return true;
@@ -232,7 +242,6 @@ int bladerf_sink_c::work(int noutput_items,
                           gr_vector_void_star &output_items)
 {
   int status;
-  size_t nstreams = num_streams(_layout);
 
   gr::thread::scoped_lock guard(d_mutex);
 
@@ -241,33 +250,14 @@ int bladerf_sink_c::work(int noutput_items,
     return 0;
   }
 
-  // copy the samples from input_items
-  gr_complex const **in = reinterpret_cast<gr_complex const **>(&input_items[0]);
-
-  if (nstreams > 1) {
-    // we need to interleave the streams as we copy
-    gr_complex *intl_out = _32fcbuf;
-
-    for (size_t i = 0; i < (noutput_items/nstreams); ++i) {
-      for (size_t n = 0; n < nstreams; ++n) {
-        memcpy(intl_out++, in[n]++, sizeof(gr_complex));
-      }
-    }
-  } else {
-    // no interleaving to do: simply copy everything
-    memcpy(_32fcbuf, in[0], noutput_items * sizeof(gr_complex));
-  }
-
-  // convert floating point to fixed point and scale
-  // input_items is gr_complex (2x float), so num_points is 2*noutput_items
-  volk_32f_s32f_convert_16i(_16icbuf, reinterpret_cast<float const *>(_32fcbuf),
-                            SCALING_FACTOR, 2*noutput_items);
+  (this->*_convert)(reinterpret_cast<gr_complex const * const *>(&input_items[0]),
+                    noutput_items);
 
   // transmit the samples from the temp buffer
-  if (BLADERF_FORMAT_SC16_Q11_META == _format) {
-    status = transmit_with_tags(_16icbuf, noutput_items);
+  if (format_has_metadata()) {
+    status = transmit_with_tags(_rawbuf, noutput_items);
   } else {
-    status = bladerf_sync_tx(_dev.get(), static_cast<void const *>(_16icbuf),
+    status = bladerf_sync_tx(_dev.get(), _rawbuf,
                              noutput_items, NULL, _stream_timeout);
   }
 
@@ -282,14 +272,60 @@ int bladerf_sink_c::work(int noutput_items,
     }
   } else {
     _failures = 0;
+    _stats.delivered(noutput_items);
   }
 
   return noutput_items;
 }
 
-int bladerf_sink_c::transmit_with_tags(int16_t const *samples,
+bladerf_sink_c::convert_t bladerf_sink_c::select_convert()
+{
+  // the channel layouts carry at most two streams
+  bool const mimo = num_streams(_layout) > 1;
+
+  if (format_is_sc8()) {
+    return mimo ? &bladerf_sink_c::convert<true, 2>
+                : &bladerf_sink_c::convert<true, 1>;
+  }
+
+  return mimo ? &bladerf_sink_c::convert<false, 2>
+              : &bladerf_sink_c::convert<false, 1>;
+}
+
+template <bool SC8, size_t NSTREAMS>
+void bladerf_sink_c::convert(gr_complex const * const *in,
+                             size_t noutput_items)
+{
+  gr_complex const *src = in[0];
+
+  if (NSTREAMS > 1) {
+    // we need to interleave the streams as we copy
+    gr_complex *intl_out = _32fcbuf;
+
+    for (size_t i = 0; i < (noutput_items/NSTREAMS); ++i) {
+      for (size_t n = 0; n < NSTREAMS; ++n) {
+        *intl_out++ = in[n][i];
+      }
+    }
+
+    src = _32fcbuf;
+  }
+
+  // convert floating point to fixed point and scale, a single stream
+  // straight from the input
+  if (SC8) {
+    convert_fc32_cs8(src, static_cast<int8_t *>(_rawbuf), noutput_items);
+  } else {
+    convert_fc32_cs16(src, static_cast<int16_t *>(_rawbuf),
+                      noutput_items, SCALING_FACTOR);
+  }
+}
+
+int bladerf_sink_c::transmit_with_tags(void const *samples,
                                         int noutput_items)
 {
+  char const *raw = static_cast<char const *>(samples);
+  size_t sample_size = format_sample_size();
   int status;
   int count = 0;
 
@@ -367,7 +403,7 @@ int bladerf_sink_c::transmit_with_tags(int16_t const *samples,
       BLADERF_DEBUG("TXing @ EOB [" << start_idx << ":" << end_idx << "]");
 
       status = bladerf_sync_tx(_dev.get(),
-                               static_cast<void const *>(&samples[2 * start_idx]),
+                               raw + start_idx * sample_size,
                                count, &meta, _stream_timeout);
       if (status != 0) {
         return status;
@@ -407,7 +443,7 @@ int bladerf_sink_c::transmit_with_tags(int16_t const *samples,
     BLADERF_DEBUG("TXing SOB [" << start_idx << ":" << end_idx << "]");
 
     status = bladerf_sync_tx(_dev.get(),
-                             static_cast<void const *>(&samples[2 * start_idx]),
+                             raw + start_idx * sample_size,
                              count, &meta, _stream_timeout);
   }
 
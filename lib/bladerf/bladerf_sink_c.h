@@ -24,6 +24,7 @@
 #include <gnuradio/sync_block.h>
 #include "sink_iface.h"
 #include "bladerf_common.h"
+#include "stream_counters.h"
 
 #include "osmosdr/ranges.h"
 
@@ -72,6 +73,7 @@ public:
 
   size_t get_max_channels(void);
   size_t get_num_channels(void);
+  osmosdr::stream_stats_t get_stream_stats(size_t chan = 0);
 
   bool start();
   bool stop();
@@ -120,19 +122,33 @@ public:
   void set_biastee_mode(const std::string &mode);
 
 private:
-  int transmit_with_tags(int16_t const *samples, int noutput_items);
+  int transmit_with_tags(void const *samples, int noutput_items);
+
+  /* Multiplex and convert noutput_items samples into _rawbuf. The format
+   * and stream count are fixed while streaming, start() picks the matching
+   * specialization once so the loops carry no branches */
+  typedef void (bladerf_sink_c::*convert_t)(gr_complex const * const *in,
+                                            size_t noutput_items);
+  convert_t select_convert();
+
+  template <bool SC8, size_t NSTREAMS>
+  void convert(gr_complex const * const *in, size_t noutput_items);
 
   // Sample-handling buffers
-  int16_t *_16icbuf;              /**< raw samples to bladeRF */
+  void *_rawbuf;                  /**< raw samples to bladeRF */
   gr_complex *_32fcbuf;           /**< intermediate buffer for conversions */
+  convert_t _convert;             /**< see select_convert() */
 
   bool _in_burst;                 /**< are we currently in a burst? */
   bool _running;                  /**< is the sink running? */
   bladerf_channel_layout _layout; /**< channel layout */
 
-  gr::thread::mutex d_mutex;      /**< mutex to protect set/work access */
+  gr::thread::mutex d_mutex;      /**< start()/stop() against work(), setters never take it */
+
+  stream_counters _stats;         /**< see get_stream_stats() */
 
-  /* Scaling factor used when converting from float to int16_t */
+  /* Scaling factor used when converting from float to int16_t, SC8 Q7
+   * samples are scaled by 127 to keep +1.0 from wrapping around */
   const float SCALING_FACTOR = 2048.0f;
 };
 
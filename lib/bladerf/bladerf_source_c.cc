@@ -39,7 +39,9 @@
 #include <volk/volk.h>
 
 #include "arg_helpers.h"
+#include "buffer_pool.h"
 #include "bladerf_source_c.h"
+#include "sample_convert.h"
 #include "osmosdr/source.h"
 
 using namespace boost::assign;
@@ -67,19 +69,34 @@ bladerf_source_c_sptr make_bladerf_source_c(const std::string &args)
 bladerf_source_c::bladerf_source_c(const std::string &args) :
   gr::sync_block( "bladerf_source_c",
                   gr::io_signature::make(0, 0, 0),
-                  args_to_io_signature(args)),
-  _16icbuf(NULL),
-  _32fcbuf(NULL),
+                  args_to_io_signature(args, true)),
+  _rawbuf(NULL),
+  _deliver(NULL),
+  _rx_in_place(false),
   _running(false),
-  _agcmode(BLADERF_GAIN_DEFAULT)
+  _agcmode(BLADERF_GAIN_DEFAULT),
+  _async(false),
+  _stream(NULL),
+  _stream_buffers(NULL),
+  _streaming(false),
+  _async_buf(NULL),
+  _async_offset(0),
+  _tuning(args),
+  _pool(args)
 {
   int status;
 
   dict_t dict = params_to_dict(args);
 
+  _stats.set_quiet(args_to_quiet(args));
+
   /* Perform src/sink agnostic initializations */
   init(dict, BLADERF_RX);
 
+  /* raw samples in the wire format, the output signature has been sized
+   * accordingly */
+  _cpu_format = args_to_cpu_format(args, format_is_sc8() ? "cs8" : "cs16");
+
   /* Handle setting of sampling mode */
   if (dict.count("sampling")) {
     bladerf_sampling sampling = BLADERF_SAMPLING_UNKNOWN;
@@ -101,6 +118,22 @@ bladerf_source_c::bladerf_source_c(const std::string &args) :
     }
   }
 
+  /* Asynchronous streaming: libbladeRF fills a pool of buffers from its own
+   * thread, work() only picks up buffers that are complete already */
+  if (dict.count("async")) {
+    _async = boost::lexical_cast<bool>(dict["async"]);
+  }
+
+  /* Latency instrumentation, only the async stream has a callback */
+  if (dict.count("latency")) {
+    _latency.enable(_async && boost::lexical_cast<bool>(dict["latency"]));
+  }
+
+  if (_async && format_has_metadata()) {
+    BLADERF_WARNING("Metadata is not supported in async mode, disabling it");
+    set_format(format_is_sc8(), false);
+  }
+
   /* Bias tee */
   if (dict.count("biastee")) {
     set_biastee_mode(dict["biastee"]);
@@ -157,7 +190,7 @@ bladerf_source_c::bladerf_source_c(const std::string &args) :
 
     set_output_signature(gr::io_signature::make(get_max_channels(),
                                                 get_max_channels(),
-                                                sizeof(gr_complex)));
+                                                cpu_format_item_size(_cpu_format)));
   }
 
   /* Set up constraints */
@@ -168,6 +201,7 @@ bladerf_source_c::bladerf_source_c(const std::string &args) :
 
   /* Set channel layout */
   _layout = (get_num_channels() > 1) ? BLADERF_RX_X2 : BLADERF_RX_X1;
+  _tagger.set_num_channels(num_streams(_layout));
 
   /* Initial wiring of antennas to channels */
   for (size_t ch = 0; ch < get_num_channels(); ++ch) {
@@ -208,11 +242,27 @@ size_t bladerf_source_c::get_max_channels()
   return bladerf_common::get_max_channels(BLADERF_RX);
 }
 
+std::string bladerf_source_c::get_cpu_format()
+{
+  return _cpu_format;
+}
+
 size_t bladerf_source_c::get_num_channels()
 {
   return output_signature()->max_streams();
 }
 
+osmosdr::stream_stats_t bladerf_source_c::get_stream_stats(size_t chan)
+{
+  osmosdr::stream_stats_t stats = _stats.get();
+  stats.high_water = _full.high_water() *
+                     (_samples_per_buffer / num_streams(_layout));
+  stats.fill = _full.read_available() *
+               (_samples_per_buffer / num_streams(_layout));
+  _latency.get(stats);
+  return stats;
+}
+
 bool bladerf_source_c::start()
 {
   int status;
@@ -221,11 +271,37 @@ bool bladerf_source_c::start()
 
   gr::thread::scoped_lock guard(d_mutex);
 
-  status = bladerf_sync_config(_dev.get(), _layout, _format, _num_buffers,
-                               _samples_per_buffer, _num_transfers,
-                               _stream_timeout);
-  if (status != 0) {
-    BLADERF_THROW_STATUS(status, "bladerf_sync_config failed");
+  if (_async) {
+    status = bladerf_init_stream(&_stream, _dev.get(), stream_callback,
+                                 &_stream_buffers, _num_buffers, _format,
+                                 _samples_per_buffer, _num_transfers, this);
+    if (status != 0) {
+      BLADERF_THROW_STATUS(status, "bladerf_init_stream failed");
+    }
+
+    status = bladerf_set_stream_timeout(_dev.get(), BLADERF_RX,
+                                        _stream_timeout);
+    if (status != 0) {
+      BLADERF_WARN_STATUS(status, "bladerf_set_stream_timeout failed");
+    }
+
+    /* libbladeRF submits the first _num_transfers buffers on its own, the
+     * remaining ones are handed out from the callback */
+    _full.resize(_num_buffers);
+    _free.resize(_num_buffers);
+    _full.resume();
+    _free.push(_stream_buffers + _num_transfers,
+               _num_buffers - _num_transfers);
+    _async_buf = NULL;
+    _async_offset = 0;
+    _latency.reset();
+  } else {
+    status = bladerf_sync_config(_dev.get(), _layout, _format, _num_buffers,
+                                 _samples_per_buffer, _num_transfers,
+                                 _stream_timeout);
+    if (status != 0) {
+      BLADERF_THROW_STATUS(status, "bladerf_sync_config failed");
+    }
   }
 
   for (size_t ch = 0; ch < get_max_channels(); ++ch) {
@@ -238,11 +314,22 @@ bool bladerf_source_c::start()
     }
   }
 
-  /* Allocate memory for conversions in work() */
-  size_t alignment = volk_get_alignment();
+  /* Allocate memory for conversions in work(), holds the multiplex of all
+   * streams for up to _samples_per_buffer items each, page aligned and
+   * reused across restarts by the buffer pool */
+  size_t nstreams = num_streams(_layout);
+
+  _rawbuf = buffer_pool::get().acquire(nstreams*_samples_per_buffer*format_sample_size());
+
+  _deliver = select_deliver();
+  _rx_in_place = ("fc32" != _cpu_format && nstreams == 1);
 
-  _16icbuf = reinterpret_cast<int16_t *>(volk_malloc(2*_samples_per_buffer*sizeof(int16_t), alignment));
-  _32fcbuf = reinterpret_cast<gr_complex *>(volk_malloc(_samples_per_buffer*sizeof(gr_complex), alignment));
+  _tagger.reset();
+
+  if (_async) {
+    _streaming = true;
+    _stream_thread = gr::thread::thread(boost::bind(&bladerf_source_c::stream_task, this));
+  }
 
   _running = true;
 
@@ -255,6 +342,10 @@ bool bladerf_source_c::stop()
 
   BLADERF_DEBUG("stopping source");
 
+  /* release a work() call waiting for the next buffer */
+  _streaming = false;
+  _full.interrupt();
+
   gr::thread::scoped_lock guard(d_mutex);
 
   if (!_running) {
@@ -264,6 +355,16 @@ bool bladerf_source_c::stop()
 
   _running = false;
 
+  if (_async) {
+    /* the callback returns BLADERF_STREAM_SHUTDOWN on the next transfer */
+    _stream_thread.join();
+    bladerf_deinit_stream(_stream);
+    _stream = NULL;
+    _stream_buffers = NULL;
+    _async_buf = NULL;
+    _full.resume();
+  }
+
   for (size_t ch = 0; ch < get_max_channels(); ++ch) {
     bladerf_channel brfch = BLADERF_CHANNEL_RX(ch);
     if (get_channel_enable(brfch)) {
@@ -275,10 +376,8 @@ bool bladerf_source_c::stop()
   }
 
   /* Deallocate conversion memory */
-  volk_free(_16icbuf);
-  volk_free(_32fcbuf);
-  _16icbuf = NULL;
-  _32fcbuf = NULL;
+  buffer_pool::get().release(_rawbuf);
+  _rawbuf = NULL;
 
   return true;
 }
@@ -299,20 +398,33 @@ int bladerf_source_c::work(int noutput_items,
     return 0;
   }
 
+  if (_async) {
+    int produced = work_async(noutput_items, output_items);
+    _tagger.update(this, produced);
+    if (produced > 0) {
+      _stats.delivered(produced);
+    }
+    return produced;
+  }
+
   // set up metadata
-  if (BLADERF_FORMAT_SC16_Q11_META == _format) {
+  if (format_has_metadata()) {
     memset(&meta, 0, sizeof(meta));
     meta.flags = BLADERF_META_FLAG_RX_NOW;
     meta_ptr = &meta;
   }
 
-  // grab samples into temp buffer
-  status = bladerf_sync_rx(_dev.get(), static_cast<void *>(_16icbuf),
-                           noutput_items, meta_ptr, _stream_timeout);
+  // in native mode a single stream is received straight into the output
+  void *rxbuf = _rx_in_place ? output_items[0] : _rawbuf;
+
+  // grab samples into temp buffer, noutput_items for each of the streams
+  status = bladerf_sync_rx(_dev.get(), rxbuf,
+                           noutput_items * nstreams, meta_ptr, _stream_timeout);
   if (status != 0) {
     BLADERF_WARNING(boost::str(boost::format("bladerf_sync_rx error: %s")
                     % bladerf_strerror(status)));
     ++_failures;
+    _tagger.retag();
 
     if (_failures >= MAX_CONSECUTIVE_FAILURES) {
       BLADERF_WARNING("Consecutive error limit hit. Shutting down.");
@@ -322,29 +434,200 @@ int bladerf_source_c::work(int noutput_items,
     _failures = 0;
   }
 
-  // convert from int16_t to float
-  // output_items is gr_complex (2x float), so num_points is 2*noutput_items
-  volk_16i_s32f_convert_32f(reinterpret_cast<float *>(_32fcbuf), _16icbuf,
-                            SCALING_FACTOR, 2*noutput_items);
+  if (meta_ptr && (meta.status & BLADERF_META_STATUS_OVERRUN)) {
+    _stats.overflow();
+    _tagger.retag();
+  }
 
-  // copy the samples into output_items
-  gr_complex **out = reinterpret_cast<gr_complex **>(&output_items[0]);
+  // single stream native samples have been received in place already
+  if (!_rx_in_place) {
+    (this->*_deliver)(_rawbuf, noutput_items, output_items, 0);
+  }
+
+  _tagger.update(this, noutput_items);
+  _stats.delivered(noutput_items);
 
-  if (nstreams > 1) {
-    // we need to deinterleave the multiplex as we copy
-    gr_complex const *deint_in = _32fcbuf;
+  return noutput_items;
+}
 
-    for (size_t i = 0; i < (noutput_items/nstreams); ++i) {
-      for (size_t n = 0; n < nstreams; ++n) {
-        memcpy(out[n]++, deint_in++, sizeof(gr_complex));
+int bladerf_source_c::work_async(int noutput_items,
+                                 gr_vector_void_star &output_items)
+{
+  size_t nstreams = num_streams(_layout);
+  size_t items_per_buffer = _samples_per_buffer / nstreams;
+  size_t sample_size = format_sample_size();
+  size_t produced = 0;
+
+  while (produced < size_t(noutput_items)) {
+    if (!_async_buf) {
+      // only wait if there is nothing to return yet
+      if (!_full.wait_read(1, produced ? 0 : _stream_timeout)) {
+        break;
       }
+
+      _full.pop(&_async_buf, 1);
+      _async_offset = 0;
+    }
+
+    size_t n = std::min(noutput_items - produced,
+                        items_per_buffer - _async_offset);
+
+    (this->*_deliver)(static_cast<char *>(_async_buf) +
+                        nstreams*_async_offset*sample_size,
+                      n, output_items, produced);
+
+    _async_offset += n;
+    produced += n;
+
+    // hand the buffer back to the callback
+    if (_async_offset == items_per_buffer) {
+      _free.push(&_async_buf, 1);
+      _latency.consumed(1);
+      _async_buf = NULL;
     }
-  } else {
-    // no deinterleaving to do: simply copy everything
-    memcpy(out[0], _32fcbuf, sizeof(gr_complex) * noutput_items);
   }
 
-  return noutput_items;
+  if (!produced && !_streaming) {
+    return WORK_DONE;
+  }
+
+  return produced;
+}
+
+bladerf_source_c::deliver_t bladerf_source_c::select_deliver()
+{
+  bool const sc8 = format_is_sc8();
+  bool const mimo = num_streams(_layout) > 1;
+
+  // the channel layouts carry at most two streams
+  if ("fc32" != _cpu_format) {
+    if (sc8) {
+      return mimo ? &bladerf_source_c::deliver_raw<uint16_t, 2>
+                  : &bladerf_source_c::deliver_copy<uint16_t>;
+    }
+
+    return mimo ? &bladerf_source_c::deliver_raw<uint32_t, 2>
+                : &bladerf_source_c::deliver_copy<uint32_t>;
+  }
+
+  if (sc8) {
+    return mimo ? &bladerf_source_c::deliver_fc32<true, 2>
+                : &bladerf_source_c::deliver_fc32<true, 1>;
+  }
+
+  return mimo ? &bladerf_source_c::deliver_fc32<false, 2>
+              : &bladerf_source_c::deliver_fc32<false, 1>;
+}
+
+template <typename PAIR>
+void bladerf_source_c::deliver_copy(void const *in, size_t nitems,
+                                    gr_vector_void_star &output_items,
+                                    size_t offset)
+{
+  memcpy(static_cast<PAIR *>(output_items[0]) + offset, in,
+         nitems * sizeof(PAIR));
+}
+
+template <typename PAIR, size_t NSTREAMS>
+void bladerf_source_c::deliver_raw(void const *in, size_t nitems,
+                                   gr_vector_void_star &output_items,
+                                   size_t offset)
+{
+  // deinterleave the multiplex, one I/Q pair is 32 bits wide for SC16 Q11
+  // and 16 bits wide for SC8 Q7
+  PAIR const *deint_in = static_cast<PAIR const *>(in);
+  PAIR *out[NSTREAMS];
+
+  for (size_t n = 0; n < NSTREAMS; ++n) {
+    out[n] = static_cast<PAIR *>(output_items[n]) + offset;
+  }
+
+  for (size_t i = 0; i < nitems; ++i) {
+    for (size_t n = 0; n < NSTREAMS; ++n) {
+      out[n][i] = *deint_in++;
+    }
+  }
+}
+
+template <bool SC8, size_t NSTREAMS>
+void bladerf_source_c::deliver_fc32(void const *in, size_t nitems,
+                                    gr_vector_void_star &output_items,
+                                    size_t offset)
+{
+  gr_complex *out[NSTREAMS];
+
+  for (size_t n = 0; n < NSTREAMS; ++n) {
+    out[n] = reinterpret_cast<gr_complex *>(output_items[n]) + offset;
+  }
+
+  // convert to float and split the multiplex in a single pass, sliced
+  // across the convert_threads
+  _pool.run(nitems, [&](size_t begin, size_t end) {
+    gr_complex *slice[NSTREAMS];
+
+    for (size_t n = 0; n < NSTREAMS; ++n) {
+      slice[n] = out[n] + begin;
+    }
+
+    if (SC8) {
+      convert_cs8_fc32_deinterleave(static_cast<int8_t const *>(in) +
+                                      begin * NSTREAMS * 2,
+                                    slice, NSTREAMS, end - begin);
+    } else {
+      convert_cs16_fc32_deinterleave(static_cast<int16_t const *>(in) +
+                                       begin * NSTREAMS * 2,
+                                     slice, NSTREAMS, end - begin,
+                                     SCALING_FACTOR);
+    }
+  });
+}
+
+void *bladerf_source_c::stream_callback(struct bladerf *dev,
+                                        struct bladerf_stream *stream,
+                                        struct bladerf_metadata *meta,
+                                        void *samples,
+                                        size_t num_samples,
+                                        void *user_data)
+{
+  bladerf_source_c *obj = static_cast<bladerf_source_c *>(user_data);
+  return obj->stream_callback(samples);
+}
+
+void *bladerf_source_c::stream_callback(void *samples)
+{
+  if (!_streaming) {
+    return BLADERF_STREAM_SHUTDOWN;
+  }
+
+  void *next;
+
+  if (_free.pop(&next, 1) != 1) {
+    // work() holds on to every other buffer, drop this one and refill it
+    _full.commit(0, 1);
+    _tagger.lost(_samples_per_buffer / num_streams(_layout));
+    _stats.overflow(_samples_per_buffer / num_streams(_layout));
+    return samples;
+  }
+
+  _full.push(&samples, 1);
+  _latency.arrived(1);
+  _tagger.stored(_samples_per_buffer / num_streams(_layout));
+
+  return next;
+}
+
+void bladerf_source_c::stream_task()
+{
+  /* libbladeRF runs the callbacks on this thread */
+  _tuning.apply();
+
+  int status = bladerf_stream(_stream, _layout);
+  if (status != 0) {
+    BLADERF_WARN_STATUS(status, "bladerf_stream failed");
+  }
+
+  _streaming = false;
+  _full.interrupt();
 }
 
 osmosdr::meta_range_t bladerf_source_c::get_sample_rates()
@@ -354,7 +637,10 @@ osmosdr::meta_range_t bladerf_source_c::get_sample_rates()
 
 double bladerf_source_c::set_sample_rate(double rate)
 {
-  return bladerf_common::set_sample_rate(rate, chan2channel(BLADERF_RX, 0));
+  rate = bladerf_common::set_sample_rate(rate, chan2channel(BLADERF_RX, 0));
+  _tagger.set_rate(rate);
+
+  return rate;
 }
 
 double bladerf_source_c::get_sample_rate()
@@ -362,6 +648,11 @@ double bladerf_source_c::get_sample_rate()
   return bladerf_common::get_sample_rate(chan2channel(BLADERF_RX, 0));
 }
 
+double bladerf_source_c::get_measured_sample_rate(size_t chan)
+{
+  return _tagger.measured_rate();
+}
+
 osmosdr::freq_range_t bladerf_source_c::get_freq_range(size_t chan)
 {
   return bladerf_common::freq_range(chan2channel(BLADERF_RX, chan));
@@ -369,7 +660,10 @@ osmosdr::freq_range_t bladerf_source_c::get_freq_range(size_t chan)
 
 double bladerf_source_c::set_center_freq(double freq, size_t chan)
 {
-  return bladerf_common::set_center_freq(freq, chan2channel(BLADERF_RX, chan));
+  freq = bladerf_common::set_center_freq(freq, chan2channel(BLADERF_RX, chan));
+  _tagger.set_freq(freq, chan);
+
+  return freq;
 }
 
 double bladerf_source_c::get_center_freq(size_t chan)
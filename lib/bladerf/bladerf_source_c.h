@@ -21,9 +21,18 @@
 #ifndef INCLUDED_BLADERF_SOURCE_C_H
 #define INCLUDED_BLADERF_SOURCE_C_H
 
+#include <atomic>
+
 #include <gnuradio/sync_block.h>
+#include <gnuradio/thread/thread.h>
 #include "source_iface.h"
 #include "bladerf_common.h"
+#include "sample_ring.h"
+#include "rx_tagger.h"
+#include "stream_counters.h"
+#include "latency_probe.h"
+#include "convert_pool.h"
+#include "thread_tuning.h"
 
 #include "osmosdr/ranges.h"
 
@@ -72,6 +81,8 @@ public:
 
   size_t get_max_channels(void);
   size_t get_num_channels(void);
+  std::string get_cpu_format(void);
+  osmosdr::stream_stats_t get_stream_stats(size_t chan = 0);
 
   bool start();
   bool stop();
@@ -83,6 +94,7 @@ public:
   osmosdr::meta_range_t get_sample_rates(void);
   double set_sample_rate(double rate);
   double get_sample_rate(void);
+  double get_measured_sample_rate(size_t chan = 0);
 
   osmosdr::freq_range_t get_freq_range(size_t chan = 0);
   double set_center_freq(double freq, size_t chan = 0);
@@ -127,17 +139,65 @@ public:
   void set_agc_mode(const std::string &agcmode);
 
 private:
+  /* Asynchronous stream API, see async=1 */
+  static void *stream_callback(struct bladerf *dev,
+                               struct bladerf_stream *stream,
+                               struct bladerf_metadata *meta,
+                               void *samples,
+                               size_t num_samples,
+                               void *user_data);
+  void *stream_callback(void *samples);
+  void stream_task();
+  int work_async(int noutput_items, gr_vector_void_star &output_items);
+
+  /* Convert or copy nitems multiplexed samples to the outputs at offset.
+   * The format and stream count are fixed while streaming, start() picks
+   * the matching specialization once so the loops carry no branches */
+  typedef void (bladerf_source_c::*deliver_t)(void const *in, size_t nitems,
+                                              gr_vector_void_star &output_items,
+                                              size_t offset);
+  deliver_t select_deliver();
+
+  template <typename PAIR>
+  void deliver_copy(void const *in, size_t nitems,
+                    gr_vector_void_star &output_items, size_t offset);
+  template <typename PAIR, size_t NSTREAMS>
+  void deliver_raw(void const *in, size_t nitems,
+                   gr_vector_void_star &output_items, size_t offset);
+  template <bool SC8, size_t NSTREAMS>
+  void deliver_fc32(void const *in, size_t nitems,
+                    gr_vector_void_star &output_items, size_t offset);
+
   // Sample-handling buffers
-  int16_t *_16icbuf;              /**< raw samples from bladeRF */
-  gr_complex *_32fcbuf;           /**< intermediate buffer to gnuradio */
+  void *_rawbuf;                  /**< raw samples from bladeRF */
+  std::string _cpu_format;        /**< fc32, or cs16/cs8 (raw samples) */
+  deliver_t _deliver;             /**< see select_deliver() */
+  bool _rx_in_place;              /**< sync samples go straight to the output */
 
   bool _running;                  /**< is the source running? */
   bladerf_channel_layout _layout; /**< channel layout */
   bladerf_gain_mode _agcmode;     /**< gain mode when AGC is enabled */
 
-  gr::thread::mutex d_mutex;      /**< mutex to protect set/work access */
-
-  /* Scaling factor used when converting from int16_t to float */
+  gr::thread::mutex d_mutex;      /**< start()/stop() against work(), setters never take it */
+
+  bool _async;                    /**< use bladerf_init_stream() */
+  struct bladerf_stream *_stream; /**< async stream handle */
+  void **_stream_buffers;         /**< buffers allocated by libbladeRF */
+  gr::thread::thread _stream_thread; /**< runs bladerf_stream() */
+  std::atomic<bool> _streaming;   /**< cleared to shut the stream down */
+  sample_ring<void *> _full;      /**< buffers filled by libbladeRF */
+  sample_ring<void *> _free;      /**< buffers consumed by work() */
+  void *_async_buf;               /**< buffer work() is reading from */
+  size_t _async_offset;           /**< items of _async_buf already read */
+
+  rx_tagger _tagger;              /**< rx_time/rx_rate/rx_freq tags */
+  stream_counters _stats;         /**< see get_stream_stats() */
+  latency_probe _latency;         /**< see latency=1 */
+  thread_tuning _tuning;          /**< of the async stream thread */
+  convert_pool _pool;             /**< see convert_threads= */
+
+  /* Scaling factor used when converting from int16_t to float, SC8 Q7
+   * samples always use a full scale of 128 */
   const float SCALING_FACTOR = 2048.0f;
 };
 
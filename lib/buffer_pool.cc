@@ -0,0 +1,180 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "buffer_pool.h"
+
+#define POOL_PAGE_SIZE (4 << 10)
+#define POOL_HUGEPAGE_SIZE (2 << 20)
+
+/* released bytes kept for reuse, beyond that they go back to the system */
+#define POOL_MAX_CACHED (256 << 20)
+
+static thread_local bool prefer_hugepages = false;
+
+buffer_pool &buffer_pool::get()
+{
+  /* never destroyed, rings of static objects may be released at exit */
+  static buffer_pool *instance = new buffer_pool;
+  return *instance;
+}
+
+buffer_pool::hugepage_scope::hugepage_scope( bool enable ) :
+  _previous( prefer_hugepages )
+{
+  prefer_hugepages = enable;
+}
+
+buffer_pool::hugepage_scope::~hugepage_scope()
+{
+  prefer_hugepages = _previous;
+}
+
+void *buffer_pool::acquire( size_t bytes )
+{
+  block_t block;
+  block.huge = prefer_hugepages;
+
+  const size_t page = block.huge ? POOL_HUGEPAGE_SIZE : POOL_PAGE_SIZE;
+  block.bytes = ( ( bytes ? bytes : 1 ) + page - 1 ) / page * page;
+
+  void *ptr = NULL;
+
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    std::multimap< std::pair< size_t, bool >, std::pair< void *, block_t > >::iterator it =
+      _free.find( std::make_pair( block.bytes, block.huge ) );
+
+    if ( it != _free.end() ) {
+      ptr = it->second.first;
+      block = it->second.second;
+      _cached -= block.bytes;
+      _free.erase( it );
+    }
+  }
+
+  if ( ! ptr )
+    ptr = allocate( block );
+
+  /* zeroing faults in every page now rather than in the streaming path */
+  memset( ptr, 0, block.bytes );
+
+  std::lock_guard< std::mutex > lock( _mutex );
+  _used[ ptr ] = block;
+
+  return ptr;
+}
+
+void buffer_pool::release( void *ptr )
+{
+  if ( ! ptr )
+    return;
+
+  block_t block;
+
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    std::map< void *, block_t >::iterator it = _used.find( ptr );
+    if ( it == _used.end() )
+      return;
+
+    block = it->second;
+    _used.erase( it );
+
+    if ( _cached + block.bytes <= POOL_MAX_CACHED ) {
+      _free.insert( std::make_pair( std::make_pair( block.bytes, block.huge ),
+                                    std::make_pair( ptr, block ) ) );
+      _cached += block.bytes;
+      return;
+    }
+  }
+
+  dispose( ptr, block );
+}
+
+void *buffer_pool::allocate( block_t &block )
+{
+  block.mapped = false;
+
+#if defined(__linux__) && defined(MAP_HUGETLB)
+  /* reserved huge pages first, transparent ones otherwise */
+  if ( block.huge ) {
+    void *ptr = mmap( NULL, block.bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+    if ( ptr != MAP_FAILED ) {
+      block.mapped = true;
+      return ptr;
+    }
+  }
+#endif
+
+  const size_t align = block.huge ? POOL_HUGEPAGE_SIZE : POOL_PAGE_SIZE;
+  void *ptr = NULL;
+
+#ifdef _WIN32
+  ptr = _aligned_malloc( block.bytes, align );
+#else
+  if ( posix_memalign( &ptr, align, block.bytes ) != 0 )
+    ptr = NULL;
+#endif
+
+  if ( ! ptr )
+    throw std::bad_alloc();
+
+#ifdef MADV_HUGEPAGE
+  if ( block.huge )
+    madvise( ptr, block.bytes, MADV_HUGEPAGE );
+#endif
+
+  return ptr;
+}
+
+void buffer_pool::dispose( void *ptr, const block_t &block )
+{
+#ifndef _WIN32
+  if ( block.mapped ) {
+    munmap( ptr, block.bytes );
+    return;
+  }
+#endif
+
+#ifdef _WIN32
+  _aligned_free( ptr );
+#else
+  ::free( ptr );
+#endif
+}
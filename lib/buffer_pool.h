@@ -0,0 +1,131 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_BUFFER_POOL_H
+#define INCLUDED_OSMOSDR_BUFFER_POOL_H
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+
+#include <osmosdr/api.h>
+
+/*!
+ * Process wide pool of the sample rings and scratch buffers of the drivers.
+ *
+ * Blocks are page aligned and pre-faulted when they are handed out, so the
+ * streaming threads do not take page faults on first use. Released blocks
+ * are kept for the next acquire() of the same size, which reuses the
+ * buffers of a device closed and opened again, or of a start() after a
+ * stop(), instead of returning them to the system.
+ *
+ * Inside a hugepage_scope, e.g. thread_tuning::allocate() with hugepages=1,
+ * blocks are backed by 2 MB huge pages where the system provides them, to
+ * cut down on TLB misses at high sample rates. Driver modules share the
+ * pool of gnuradio-osmosdr.
+ */
+class OSMOSDR_API buffer_pool
+{
+public:
+  static buffer_pool &get();
+
+  /*! a zeroed block of at least bytes, never NULL */
+  void *acquire( size_t bytes );
+
+  /*! hand a block from acquire() back to the pool, NULL is ignored */
+  void release( void *ptr );
+
+  /*! prefer huge pages for the blocks acquired by this thread meanwhile */
+  class hugepage_scope
+  {
+  public:
+    explicit hugepage_scope( bool enable );
+    ~hugepage_scope();
+
+  private:
+    bool _previous;
+  };
+
+private:
+  buffer_pool() : _cached( 0 ) {}
+
+  struct block_t
+  {
+    size_t bytes;   /**< rounded up to the page size */
+    bool huge;
+    bool mapped;    /**< from mmap() rather than the aligned heap */
+  };
+
+  void *allocate( block_t &block );
+  void dispose( void *ptr, const block_t &block );
+
+  std::mutex _mutex;
+  std::map< void *, block_t > _used;
+  std::multimap< std::pair< size_t, bool >, std::pair< void *, block_t > > _free;
+  size_t _cached;   /**< bytes held in _free */
+};
+
+/*!
+ * A buffer of n items from the buffer_pool, released on destruction.
+ * Only for trivially copyable items.
+ */
+template <typename T>
+class pooled_buffer
+{
+public:
+  pooled_buffer() : _data( NULL ), _size( 0 ) {}
+  explicit pooled_buffer( size_t n ) : _data( NULL ), _size( 0 ) { assign( n ); }
+  ~pooled_buffer() { reset(); }
+
+  /*! reallocate for n zeroed items, discards the content */
+  void assign( size_t n )
+  {
+    reset();
+    if ( n ) {
+      _data = static_cast< T * >( buffer_pool::get().acquire( n * sizeof(T) ) );
+      _size = n;
+    }
+  }
+
+  /*! give the storage back to the pool */
+  void reset()
+  {
+    buffer_pool::get().release( _data );
+    _data = NULL;
+    _size = 0;
+  }
+
+  T *data() { return _data; }
+  const T *data() const { return _data; }
+  size_t size() const { return _size; }
+
+  T &operator[]( size_t i ) { return _data[i]; }
+  const T &operator[]( size_t i ) const { return _data[i]; }
+
+private:
+  pooled_buffer( const pooled_buffer & );
+  pooled_buffer &operator=( const pooled_buffer & );
+
+  T *_data;
+  size_t _size;
+};
+
+#endif /* INCLUDED_OSMOSDR_BUFFER_POOL_H */
@@ -0,0 +1,137 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+
+#include "burst_gate.h"
+
+void burst_gate::reset()
+{
+  _count = 0;
+  _power = 0.0;
+  _measured = 0;
+  _known = 0;
+  _open.clear();
+  _held.clear();
+  _forwarded = 0;
+  _dropped = 0;
+  _runs.clear();
+}
+
+void burst_gate::trigger( uint64_t begin, uint64_t end )
+{
+  span_t span = { begin > _pre ? begin - _pre : 0, end + _post };
+
+  /* overlapping or adjacent spans make one burst */
+  if ( _open.size() && span.begin <= _open.back().end )
+    _open.back().end = std::max( _open.back().end, span.end );
+  else
+    _open.push_back( span );
+}
+
+int burst_gate::gate( gr::block *block, gr_complex *items, size_t nitems, rx_tagger *tagger )
+{
+  static const pmt::pmt_t SOB_KEY = pmt::string_to_symbol( "rx_sob" );
+  static const pmt::pmt_t EOB_KEY = pmt::string_to_symbol( "rx_eob" );
+
+  /* the held items come first, then the new ones */
+  const uint64_t begin = _forwarded;
+  const size_t held = _held.size();
+
+  /*
+   * An item is decided once the windows up to pre items after it are,
+   * and the one after it as well, for rx_eob to go on the last one.
+   * At most nitems are decided, for them to fit into items.
+   */
+  uint64_t limit = _known > _pre + 1 ? _known - _pre - 1 : 0;
+  limit = std::min( std::max( limit, begin ), begin + nitems );
+
+  if ( _out.size() < nitems )
+    _out.resize( nitems );
+
+  const uint64_t first = block->nitems_written( 0 );
+  size_t kept = 0;
+  uint64_t pos = begin;
+
+  _runs.clear();
+
+  while ( pos < limit ) {
+    if ( _open.empty() || _open.front().begin >= limit ) {
+      _dropped += limit - pos;
+      pos = limit;
+      break;
+    }
+
+    const span_t &span = _open.front();
+    if ( span.begin > pos ) {
+      _dropped += span.begin - pos;
+      pos = span.begin;
+    }
+
+    if ( pos == span.begin ) {
+      if ( tagger && _dropped )
+        tagger->skipped( first + kept, _dropped );
+      _dropped = 0;
+      block->add_item_tag( 0, first + kept, SOB_KEY, pmt::from_bool( true ) );
+    }
+
+    const uint64_t stop = std::min( span.end, limit );
+    if ( stop > pos ) {
+      const run_t run = { pos, first + kept, stop - pos };
+      _runs.push_back( run );
+    }
+
+    for ( uint64_t at = pos; at < stop; ) {
+      const size_t index = at - begin;
+      const gr_complex *src = index < held ? &_held[ index ] : items + ( index - held );
+      const size_t len = index < held ? std::min< uint64_t >( held - index, stop - at )
+                                      : stop - at;
+      memcpy( &_out[ kept ], src, len * sizeof(gr_complex) );
+      kept += len;
+      at += len;
+    }
+    pos = stop;
+
+    if ( stop == span.end ) {
+      block->add_item_tag( 0, first + kept - 1, EOB_KEY, pmt::from_bool( true ) );
+      _open.pop_front();
+    }
+  }
+
+  /* hold back the items not decided yet */
+  const size_t used = pos - begin;
+  if ( used < held ) {
+    _held.erase( _held.begin(), _held.begin() + used );
+    _held.insert( _held.end(), items, items + nitems );
+  } else {
+    _held.assign( items + ( used - held ), items + nitems );
+  }
+  _forwarded = pos;
+
+  memcpy( items, _out.data(), kept * sizeof(gr_complex) );
+
+  return kept;
+}
@@ -0,0 +1,174 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_BURST_GATE_H
+#define INCLUDED_OSMOSDR_BURST_GATE_H
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <vector>
+
+#include <gnuradio/block.h>
+
+#include <osmosdr/api.h>
+
+#include "sample_convert.h"
+#include "rx_tagger.h"
+
+/* samples the energy is averaged over, the resolution of the gate */
+#define BURST_GATE_WINDOW 256
+
+/*!
+ * The sparse capture of squelch_db=, pre= and post=: a source forwards
+ * only the bursts and drops the idle samples between them.
+ *
+ * The energy is measured by the *_agc conversion kernels while they
+ * convert, in windows of BURST_GATE_WINDOW samples. A window with a mean
+ * power of at least the squelch level (dBFS, before the software AGC)
+ * opens the gate from pre samples before it until post samples after it,
+ * closer bursts merge. apply() then reduces the items work() converted to
+ * the open ones. To decide about the pre samples of a burst it holds back
+ * the last pre + BURST_GATE_WINDOW samples or so until the next call.
+ *
+ * The first sample of a burst is tagged rx_sob, the last one rx_eob. The
+ * samples dropped before a burst are reported to the rx_tagger as
+ * skipped, so the burst carries an rx_gap tag with their number and fresh
+ * rx_time and rx_rate tags. Belongs to the thread calling work().
+ */
+class OSMOSDR_API burst_gate
+{
+public:
+  burst_gate() :
+    _threshold( 0.0 ),
+    _pre( 0 ),
+    _post( 0 ),
+    _enabled( false )
+  {
+    reset();
+  }
+
+  /*! gate at squelch_db dBFS with pre and post samples, before streaming */
+  void configure( double squelch_db, size_t pre, size_t post )
+  {
+    _threshold = std::pow( 10.0, squelch_db / 10.0 );
+    _pre = pre;
+    _post = post;
+    _enabled = true;
+  }
+
+  bool enabled() const { return _enabled; }
+
+  /*! streaming (re)starts, drops the samples held back */
+  void reset();
+
+  /*! items to convert at most, for the level to stay within one window */
+  size_t chunk( size_t nitems ) const
+  {
+    return _enabled ? std::min( nitems, size_t(BURST_GATE_WINDOW) - _count ) : nitems;
+  }
+
+  /*! the level of the next nitems items converted, with gain */
+  void add( const sample_level_t &level, size_t nitems, float gain )
+  {
+    _power += double(level.power) / ( double(gain) * gain );
+    _count += nitems;
+    _measured += nitems;
+
+    if ( _count < BURST_GATE_WINDOW )
+      return;
+
+    if ( _power / _count >= _threshold )
+      trigger( _measured - _count, _measured );
+
+    _known = _measured;
+    _count = 0;
+    _power = 0.0;
+  }
+
+  /*!
+   * Keep the open ones of the nitems items work() converted to items,
+   * moved to its front, and tag them.
+   * \return the number of items kept
+   */
+  int apply( gr::block *block, gr_complex *items, int nitems, rx_tagger *tagger )
+  {
+    if ( ! _enabled || nitems <= 0 )
+      return nitems;
+
+    return gate( block, items, nitems, tagger );
+  }
+
+  /*! items measured, and items decided by apply(), since reset() */
+  uint64_t measured() const { return _measured; }
+  uint64_t decided() const { return _forwarded; }
+
+  /*!
+   * The output offset the last apply() kept the given item (counted since
+   * reset()) at, false if it was dropped or decided by an earlier call.
+   */
+  bool locate( uint64_t item, uint64_t &offset ) const
+  {
+    for (const run_t &run : _runs)
+      if ( item >= run.begin && item < run.begin + run.len ) {
+        offset = run.offset + ( item - run.begin );
+        return true;
+      }
+
+    return false;
+  }
+
+private:
+  struct span_t
+  {
+    uint64_t begin;             /**< first open item, since reset() */
+    uint64_t end;
+  };
+
+  struct run_t
+  {
+    uint64_t begin;             /**< first item kept, since reset() */
+    uint64_t offset;            /**< its output offset */
+    uint64_t len;
+  };
+
+  void trigger( uint64_t begin, uint64_t end );
+  int gate( gr::block *block, gr_complex *items, size_t nitems, rx_tagger *tagger );
+
+  double _threshold;            /**< mean |x|^2 */
+  size_t _pre;
+  size_t _post;
+  bool _enabled;
+
+  size_t _count;                /**< items of the current window */
+  double _power;
+  uint64_t _measured;           /**< items measured since reset() */
+  uint64_t _known;              /**< items up to the last window closed */
+
+  std::deque< span_t > _open;   /**< open spans not completely forwarded */
+  std::vector< gr_complex > _held;
+  uint64_t _forwarded;          /**< item index of _held[0], since reset() */
+  uint64_t _dropped;            /**< items dropped since the last burst */
+  std::vector< gr_complex > _out;
+  std::vector< run_t > _runs;   /**< what the last apply() kept */
+};
+
+#endif /* INCLUDED_OSMOSDR_BURST_GATE_H */
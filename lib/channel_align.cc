@@ -0,0 +1,322 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+
+#include "arg_helpers.h"
+#include "channel_align.h"
+
+#define DEFAULT_ALIGN_LEN   4096
+#define DEFAULT_ALIGN_CORR  0.5
+
+channel_align_sptr make_channel_align( size_t nchan, size_t max_lag,
+                                       size_t len, double min_corr )
+{
+  return gnuradio::get_initial_sptr( new channel_align( nchan, max_lag, len, min_corr ) );
+}
+
+static std::string find_arg( const std::vector< std::string > &args,
+                             const std::string &key )
+{
+  for (const std::string &arg : args) {
+    dict_t dict = params_to_dict( arg );
+    if ( dict.count( key ) )
+      return dict[ key ];
+  }
+
+  return "";
+}
+
+size_t args_to_align_lag( const std::vector< std::string > &args )
+{
+  const std::string value = find_arg( args, "align" );
+  return value.empty() ? 0 : std::stoul( value );
+}
+
+size_t args_to_align_len( const std::vector< std::string > &args )
+{
+  const std::string value = find_arg( args, "align_len" );
+  return value.empty() ? DEFAULT_ALIGN_LEN : std::max< size_t >( std::stoul( value ), 64 );
+}
+
+double args_to_align_corr( const std::vector< std::string > &args )
+{
+  const std::string value = find_arg( args, "align_corr" );
+  return value.empty() ? DEFAULT_ALIGN_CORR : std::stod( value );
+}
+
+channel_align::channel_align( size_t nchan, size_t max_lag,
+                              size_t len, double min_corr ) :
+  gr::block( "channel_align",
+             gr::io_signature::make( nchan, nchan, sizeof(gr_complex) ),
+             gr::io_signature::make( nchan, nchan, sizeof(gr_complex) ) ),
+  _max_lag( max_lag ),
+  _len( len ),
+  _min_corr( min_corr ),
+  _state( MEASURE ),
+  _entered( false ),
+  _drop( nchan, 0 ),
+  _aligned( nchan, 0 ),
+  _carry( nchan ),
+  _rate( nchan, 0 )
+{
+  /* the items of each channel are shifted by its own lead */
+  set_tag_propagation_policy( TPP_DONT );
+}
+
+bool channel_align::start()
+{
+  _state = MEASURE;
+  _entered = false;
+
+  for (size_t chan = 0; chan < _carry.size(); chan++) {
+    _carry[chan].clear();
+    _rate[chan] = 0;
+  }
+
+  return gr::block::start();
+}
+
+void channel_align::forecast( int noutput_items, gr_vector_int &ninput_items_required )
+{
+  for (size_t chan = 0; chan < ninput_items_required.size(); chan++)
+    ninput_items_required[chan] = ( _state == PASS ) ? noutput_items :
+                                  ( _state == MEASURE ) ? int(window()) : 1;
+}
+
+/* finds the lag of every channel behind channel 0, false if one is unsure */
+bool channel_align::measure( const gr_vector_const_void_star &input_items )
+{
+  const size_t nchan = input_items.size();
+  const gr_complex *ref = (const gr_complex *)input_items[0] + _max_lag;
+
+  float ref_energy = 0;
+  for (size_t k = 0; k < _len; k++)
+    ref_energy += std::norm( ref[k] );
+
+  std::vector< long > lags( nchan, 0 );
+  std::vector< float > corrs( nchan, 1 );
+
+  for (size_t chan = 1; chan < nchan; chan++) {
+    const gr_complex *in = (const gr_complex *)input_items[chan];
+
+    /* energy of the window at lag -max_lag, slid along with the lag */
+    float energy = 0;
+    for (size_t k = 0; k < _len; k++)
+      energy += std::norm( in[k] );
+
+    float best = -1;
+    for (size_t pos = 0; pos <= 2 * _max_lag; pos++) {
+      if ( pos ) {
+        energy += std::norm( in[pos + _len - 1] ) - std::norm( in[pos - 1] );
+        energy = std::max( energy, 0.0f );
+      }
+
+      lv_32fc_t dot;
+      volk_32fc_x2_conjugate_dot_prod_32fc( &dot, in + pos, ref, _len );
+
+      const float corr = energy > 0 && ref_energy > 0 ?
+                         std::abs( dot ) / std::sqrt( energy * ref_energy ) : 0;
+      if ( corr > best ) {
+        best = corr;
+        lags[chan] = long(pos) - long(_max_lag);
+      }
+    }
+
+    corrs[chan] = best;
+    if ( best < _min_corr )
+      return false;
+  }
+
+  const long lead = *std::min_element( lags.begin(), lags.end() );
+
+  for (size_t chan = 0; chan < nchan; chan++) {
+    _drop[chan] = lags[chan] - lead;
+
+    if ( chan )
+      std::cerr << "Aligned channel " << chan << " at " << lags[chan]
+                << " samples (correlation " << corrs[chan] << ")" << std::endl;
+  }
+
+  return true;
+}
+
+/* consumes nitems of a channel, keeping their tags for the next output */
+void channel_align::drop( size_t chan, uint64_t nitems )
+{
+  const uint64_t first = nitems_read( chan );
+
+  std::vector< gr::tag_t > tags;
+  get_tags_in_range( tags, chan, first, first + nitems );
+  _carry[chan].insert( _carry[chan].end(), tags.begin(), tags.end() );
+
+  consume( chan, nitems );
+}
+
+/*
+ * Tags the first item kept after a drop with the tags of the dropped
+ * ones. Only the last rx_time is kept, advanced by the items dropped
+ * after it, or left out while no rx_rate tells their duration.
+ */
+void channel_align::carry( size_t chan )
+{
+  static const pmt::pmt_t TIME_KEY = pmt::string_to_symbol( "rx_time" );
+  static const pmt::pmt_t RATE_KEY = pmt::string_to_symbol( "rx_rate" );
+
+  const gr::tag_t *time = NULL;
+
+  for (const gr::tag_t &tag : _carry[chan])
+    if ( pmt::eq( tag.key, TIME_KEY ) )
+      time = &tag;
+    else if ( pmt::eq( tag.key, RATE_KEY ) )
+      _rate[chan] = pmt::to_double( tag.value );
+
+  for (gr::tag_t tag : _carry[chan]) {
+    if ( pmt::eq( tag.key, TIME_KEY ) )
+      continue;
+
+    tag.offset = nitems_written( chan );
+    add_item_tag( chan, tag );
+  }
+
+  if ( time && _rate[chan] > 0 ) {
+    uint64_t secs = pmt::to_uint64( pmt::tuple_ref( time->value, 0 ) );
+    double frac = pmt::to_double( pmt::tuple_ref( time->value, 1 ) ) +
+                  ( _aligned[chan] - time->offset ) / _rate[chan];
+
+    secs += uint64_t( std::floor( frac ) );
+    frac -= std::floor( frac );
+
+    add_item_tag( chan, nitems_written( chan ), TIME_KEY,
+                  pmt::make_tuple( pmt::from_uint64( secs ),
+                                   pmt::from_double( frac ) ),
+                  time->srcid );
+  }
+
+  _carry[chan].clear();
+}
+
+int channel_align::general_work( int noutput_items,
+                                 gr_vector_int &ninput_items,
+                                 gr_vector_const_void_star &input_items,
+                                 gr_vector_void_star &output_items )
+{
+  static const pmt::pmt_t TIME_KEY = pmt::string_to_symbol( "rx_time" );
+  static const pmt::pmt_t RATE_KEY = pmt::string_to_symbol( "rx_rate" );
+
+  const size_t nchan = input_items.size();
+
+  if ( _state == MEASURE ) {
+    for (size_t chan = 0; chan < nchan; chan++)
+      if ( ninput_items[chan] < int(window()) )
+        return 0;
+
+    if ( ! measure( input_items ) ) {
+      /* try the next window, dropping the same number keeps the offsets */
+      for (size_t chan = 0; chan < nchan; chan++)
+        drop( chan, _len );
+      return 0;
+    }
+
+    _state = DROP;
+  }
+
+  if ( _state == DROP ) {
+    bool done = true;
+
+    for (size_t chan = 0; chan < nchan; chan++) {
+      const uint64_t n = std::min< uint64_t >( _drop[chan], ninput_items[chan] );
+      drop( chan, n );
+      _drop[chan] -= n;
+      done = done && ! _drop[chan];
+    }
+
+    if ( ! done )
+      return 0;
+
+    _state = PASS;
+    _entered = false;
+    return 0;
+  }
+
+  if ( ! _entered ) {
+    _entered = true;
+
+    for (size_t chan = 0; chan < nchan; chan++) {
+      _aligned[chan] = nitems_read( chan );
+      carry( chan );
+    }
+  }
+
+  int nout = noutput_items;
+  for (size_t chan = 0; chan < nchan; chan++)
+    nout = std::min( nout, ninput_items[chan] );
+
+  /* stop in front of a discontinuity and measure again from there */
+  std::vector< std::vector< gr::tag_t > > tags( nchan );
+  bool again = false;
+
+  for (size_t chan = 0; chan < nchan; chan++) {
+    const uint64_t first = nitems_read( chan );
+    get_tags_in_range( tags[chan], chan, first, first + nout );
+
+    for (const gr::tag_t &tag : tags[chan])
+      if ( tag.offset > _aligned[chan] && tag.offset - first < uint64_t(nout) &&
+           pmt::eq( tag.key, TIME_KEY ) ) {
+        nout = int(tag.offset - first);
+        again = true;
+      }
+  }
+
+  for (size_t chan = 0; chan < nchan; chan++) {
+    const uint64_t first = nitems_read( chan );
+    const uint64_t written = nitems_written( chan );
+
+    memcpy( output_items[chan], input_items[chan], nout * sizeof(gr_complex) );
+
+    for (gr::tag_t tag : tags[chan])
+      if ( tag.offset < first + nout ) {
+        if ( pmt::eq( tag.key, RATE_KEY ) )
+          _rate[chan] = pmt::to_double( tag.value );
+
+        tag.offset = tag.offset - first + written;
+        add_item_tag( chan, tag );
+      }
+
+    consume( chan, nout );
+  }
+
+  if ( again )
+    _state = MEASURE;
+
+  return nout;
+}
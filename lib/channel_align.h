@@ -0,0 +1,93 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_CHANNEL_ALIGN_H
+#define INCLUDED_OSMOSDR_CHANNEL_ALIGN_H
+
+#include <string>
+#include <vector>
+
+#include <gnuradio/block.h>
+
+class channel_align;
+
+typedef boost::shared_ptr< channel_align > channel_align_sptr;
+
+/*!
+ * Sample aligns the channels of several receivers sharing a clock, e.g.
+ * an array of RTL dongles, which start streaming at different times.
+ *
+ * A window of len samples of channel 0 is cross-correlated with the other
+ * channels at lags of up to max_lag samples, and the leading channels
+ * drop their lead. Until every channel correlates with channel 0 better
+ * than min_corr, e.g. while no common reference burst is received, the
+ * windows are dropped and nothing is delivered. An rx_time tag after the
+ * alignment, meaning a device lost samples or was retuned, starts over.
+ *
+ * Only 2 * max_lag + len samples per channel are buffered, fc32 only.
+ */
+channel_align_sptr make_channel_align( size_t nchan, size_t max_lag,
+                                       size_t len, double min_corr );
+
+/*! the align=, align_len= and align_corr= args of any device, 0 for none */
+size_t args_to_align_lag( const std::vector< std::string > &args );
+size_t args_to_align_len( const std::vector< std::string > &args );
+double args_to_align_corr( const std::vector< std::string > &args );
+
+class channel_align : public gr::block
+{
+private:
+  friend channel_align_sptr make_channel_align( size_t nchan, size_t max_lag,
+                                                size_t len, double min_corr );
+
+  channel_align( size_t nchan, size_t max_lag, size_t len, double min_corr );
+
+public:
+  bool start();
+
+  void forecast( int noutput_items, gr_vector_int &ninput_items_required );
+
+  int general_work( int noutput_items,
+                    gr_vector_int &ninput_items,
+                    gr_vector_const_void_star &input_items,
+                    gr_vector_void_star &output_items );
+
+  /*! samples per channel buffered for a measurement */
+  size_t window() const { return 2 * _max_lag + _len; }
+
+private:
+  bool measure( const gr_vector_const_void_star &input_items );
+  void drop( size_t chan, uint64_t nitems );
+  void carry( size_t chan );
+
+  size_t _max_lag;
+  size_t _len;
+  double _min_corr;
+
+  enum { MEASURE, DROP, PASS } _state;
+  bool _entered;                        /**< PASS has started */
+  std::vector< uint64_t > _drop;        /**< lead left to drop per channel */
+  std::vector< uint64_t > _aligned;     /**< first item read after the drop */
+  std::vector< std::vector< gr::tag_t > > _carry; /**< tags of dropped items */
+  std::vector< double > _rate;          /**< last rx_rate seen per channel */
+};
+
+#endif /* INCLUDED_OSMOSDR_CHANNEL_ALIGN_H */
@@ -0,0 +1,247 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/blocks/stream_to_streams.h>
+#include <gnuradio/filter/firdes.h>
+
+#include "arg_helpers.h"
+#include "channelizer.h"
+#ifdef HAVE_OPENCL
+#include "channelizer_cl.h"
+#endif
+
+#define DEFAULT_CHAN_BINS     32
+#define PROTOTYPE_ATTEN_DB    70
+#define CHANNEL_ATTEN_DB      60
+
+/* the filterbank outputs twice the bin rate, the channels decimate by 2 */
+#define OVERSAMPLE            2
+
+channelizer_sptr make_channelizer( const std::vector< double > &offsets,
+                                   size_t bins, double bw,
+                                   const std::string &backend, size_t device )
+{
+  return gnuradio::get_initial_sptr( new channelizer( offsets, bins, bw,
+                                                      backend, device ) );
+}
+
+static std::string find_arg( const std::vector< std::string > &args,
+                             const std::string &key )
+{
+  for (const std::string &arg : args) {
+    dict_t dict = params_to_dict( arg );
+    if ( dict.count( key ) )
+      return dict[ key ];
+  }
+
+  return "";
+}
+
+std::vector< double > args_to_channels( const std::vector< std::string > &args )
+{
+  std::vector< double > offsets;
+
+  const std::string value = find_arg( args, "channels" );
+  if ( value.empty() )
+    return offsets;
+
+  /* commas separate the device arguments already */
+  std::vector< std::string > list;
+  boost::algorithm::split( list, value, boost::is_any_of( ":" ) );
+
+  for (const std::string &offset : list)
+    offsets.push_back( std::stod( offset ) );
+
+  return offsets;
+}
+
+size_t args_to_chan_bins( const std::vector< std::string > &args )
+{
+  const std::string value = find_arg( args, "chan_bins" );
+  return value.empty() ? DEFAULT_CHAN_BINS : std::stoul( value );
+}
+
+double args_to_chan_bw( const std::vector< std::string > &args )
+{
+  const std::string value = find_arg( args, "chan_bw" );
+  return value.empty() ? 0 : std::stod( value );
+}
+
+std::string args_to_chan_backend( const std::vector< std::string > &args )
+{
+  const std::string value = find_arg( args, "chan_backend" );
+  return value.empty() ? "cpu" : value;
+}
+
+size_t args_to_chan_device( const std::vector< std::string > &args )
+{
+  const std::string value = find_arg( args, "chan_device" );
+  return value.empty() ? 0 : std::stoul( value );
+}
+
+/*
+ * In units of the bin spacing: a channel reaches up to edge bins from the
+ * center of its bin, its offset from there plus bw / 2. So the prototype
+ * passes edge bins, and stops from 2 - edge bins on, which is all that
+ * aliases into edge bins at twice the bin rate. It gets longer as edge
+ * approaches 1, chan_bw is limited to keep it at most 0.95.
+ */
+static std::vector< float > prototype_taps( size_t bins, double edge )
+{
+  return gr::filter::firdes::low_pass_2( 1, bins, 1.0, 2 * ( 1.0 - edge ),
+                                         PROTOTYPE_ATTEN_DB );
+}
+
+channelizer::channelizer( const std::vector< double > &offsets,
+                          size_t bins, double bw,
+                          const std::string &backend, size_t device ) :
+  gr::hier_block2( "channelizer",
+                   gr::io_signature::make( 1, 1, sizeof(gr_complex) ),
+                   gr::io_signature::make( offsets.size(), offsets.size(),
+                                           sizeof(gr_complex) ) ),
+  _offsets( offsets ),
+  _bins( bins ),
+  _bw( bw ),
+  _rate( 0 )
+{
+  if ( offsets.empty() )
+    throw std::runtime_error("channels requires at least one offset.");
+
+  if ( bins < 2 || bins % OVERSAMPLE )
+    throw std::runtime_error("chan_bins must be an even number.");
+
+  if ( "opencl" == backend ) {
+#ifdef HAVE_OPENCL
+    _cl = make_channelizer_cl( offsets.size(), bins, device );
+
+    connect( self(), 0, _cl, 0 );
+    for (size_t i = 0; i < offsets.size(); i++)
+      connect( _cl, i, self(), i );
+
+    return;
+#else
+    throw std::runtime_error("chan_backend=opencl requires gr-osmosdr built with OpenCL.");
+#endif
+  } else if ( "cpu" != backend ) {
+    throw std::runtime_error("Unknown chan_backend '" + backend + "', must be cpu or opencl.");
+  }
+
+  /* until the rate is known, for a channel half a bin off at the default bw */
+  const std::vector< float > taps = prototype_taps( bins, 0.5 + 0.4 );
+
+  gr::blocks::stream_to_streams::sptr split =
+    gr::blocks::stream_to_streams::make( sizeof(gr_complex), bins );
+
+  _pfb = gr::filter::pfb_channelizer_ccf::make( bins, taps, OVERSAMPLE );
+
+  connect( self(), 0, split, 0 );
+  for (size_t i = 0; i < bins; i++)
+    connect( split, i, _pfb, i );
+
+  for (size_t i = 0; i < offsets.size(); i++) {
+    /* in units of its input rate, passes everything until that is known */
+    gr::filter::freq_xlating_fir_filter_ccf::sptr xlate =
+      gr::filter::freq_xlating_fir_filter_ccf::make( OVERSAMPLE,
+                                                     std::vector< float >( 1, 1.0f ),
+                                                     0, 1 );
+    connect( _pfb, i, xlate, 0 );
+    connect( xlate, 0, self(), i );
+
+    _xlate.push_back( xlate );
+  }
+}
+
+void channelizer::set_sample_rate( double rate )
+{
+  if ( ! (rate > 0) || rate == _rate )
+    return;
+
+  _rate = rate;
+
+  const double spacing = rate / _bins;
+
+  double bw = _bw > 0 ? _bw : 0.8 * spacing;
+  if ( bw > 0.9 * spacing ) {
+    std::cerr << "chan_bw " << bw << " exceeds the channel rate of "
+              << spacing << ", using " << 0.9 * spacing << "." << std::endl;
+    bw = 0.9 * spacing;
+  }
+
+  for (const double offset : _offsets)
+    if ( std::abs( offset ) + bw / 2 > rate / 2 )
+      std::cerr << "Channel at " << offset << " Hz exceeds the sample rate of "
+                << rate << "." << std::endl;
+
+#ifdef HAVE_OPENCL
+  if ( _cl ) {
+    /* the same response as the filterbank followed by a channel filter,
+     * passes bw / 2 and stops at the Nyquist rate of the output */
+    _cl->set_channels( rate,
+                       gr::filter::firdes::low_pass_2( 1, rate,
+                                                       ( bw + spacing ) / 4,
+                                                       ( spacing - bw ) / 2,
+                                                       CHANNEL_ATTEN_DB ),
+                       _offsets );
+    return;
+  }
+#endif
+
+  std::vector< int > map;
+  double edge = 0;
+
+  for (size_t i = 0; i < _offsets.size(); i++) {
+    const double offset = _offsets[i];
+
+    const long bin = std::lround( offset / spacing );
+    map.push_back( int( ( bin % long(_bins) + long(_bins) ) % long(_bins) ) );
+
+    const double residual = offset - bin * spacing;
+    edge = std::max( edge, ( std::abs( residual ) + bw / 2 ) / spacing );
+
+    _xlate[i]->set_center_freq( residual / ( OVERSAMPLE * spacing ) );
+  }
+
+  _pfb->set_taps( prototype_taps( _bins, edge ) );
+  _pfb->set_channel_map( map );
+
+  /* passes bw / 2 and stops at the output Nyquist rate */
+  const std::vector< float > taps =
+    gr::filter::firdes::low_pass_2( 1, OVERSAMPLE * spacing,
+                                    ( bw + spacing ) / 4,
+                                    ( spacing - bw ) / 2,
+                                    CHANNEL_ATTEN_DB );
+
+  for (gr::filter::freq_xlating_fir_filter_ccf::sptr &xlate : _xlate)
+    xlate->set_taps( taps );
+}
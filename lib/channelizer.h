@@ -0,0 +1,102 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_CHANNELIZER_H
+#define INCLUDED_OSMOSDR_CHANNELIZER_H
+
+#include <string>
+#include <vector>
+
+#include <gnuradio/hier_block2.h>
+#include <gnuradio/filter/pfb_channelizer_ccf.h>
+#include <gnuradio/filter/freq_xlating_fir_filter_ccf.h>
+
+class channelizer;
+class channelizer_cl;
+
+typedef boost::shared_ptr< channelizer > channelizer_sptr;
+
+/*!
+ * Extracts narrowband channels at the given offsets from the center
+ * frequency out of one wideband stream, each to an output of its own.
+ *
+ * A polyphase filterbank splits the stream into bins channels spaced
+ * sample_rate / bins apart, at twice that rate, with a single FFT per
+ * output sample for all of them. Each output then takes the bin closest
+ * to its offset, shifts the remainder to DC and filters it to bw before
+ * decimating to sample_rate / bins. So the cost per channel does not grow
+ * with the input rate, unlike a frequency translating filter per channel.
+ *
+ * The filterbank has to pass each channel's offset from the center of its
+ * bin plus bw / 2, up to 0.95 bins with bw limited to 0.9 bins. Its taps
+ * grow as that approaches a full bin, offsets close to bin centers or a
+ * narrower bw keep them short.
+ *
+ * With the opencl backend the channels are mixed, filtered and decimated
+ * to the same rate on an OpenCL device instead, see channelizer_cl.
+ *
+ * Nothing is selected until the sample rate is known.
+ */
+channelizer_sptr make_channelizer( const std::vector< double > &offsets,
+                                   size_t bins, double bw,
+                                   const std::string &backend = "cpu",
+                                   size_t device = 0 );
+
+/*!
+ * the channels=, chan_bins=, chan_bw=, chan_backend= and chan_device=
+ * args of any device, empty for none
+ */
+std::vector< double > args_to_channels( const std::vector< std::string > &args );
+size_t args_to_chan_bins( const std::vector< std::string > &args );
+double args_to_chan_bw( const std::vector< std::string > &args );
+std::string args_to_chan_backend( const std::vector< std::string > &args );
+size_t args_to_chan_device( const std::vector< std::string > &args );
+
+class channelizer : public gr::hier_block2
+{
+private:
+  friend channelizer_sptr make_channelizer( const std::vector< double > &offsets,
+                                            size_t bins, double bw,
+                                            const std::string &backend,
+                                            size_t device );
+
+  channelizer( const std::vector< double > &offsets, size_t bins, double bw,
+               const std::string &backend, size_t device );
+
+public:
+  /*! select the bins and design the channel filters for the input rate */
+  void set_sample_rate( double rate );
+
+  /*! the rate of every output */
+  double channel_rate() const { return _rate / _bins; }
+
+private:
+  std::vector< double > _offsets;
+  size_t _bins;
+  double _bw;
+  double _rate;
+
+  gr::filter::pfb_channelizer_ccf::sptr _pfb;
+  std::vector< gr::filter::freq_xlating_fir_filter_ccf::sptr > _xlate;
+  boost::shared_ptr< channelizer_cl > _cl; /**< unset with the cpu backend */
+};
+
+#endif /* INCLUDED_OSMOSDR_CHANNELIZER_H */
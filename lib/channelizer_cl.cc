@@ -0,0 +1,330 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <gnuradio/io_signature.h>
+
+#include "channelizer_cl.h"
+
+/* outputs per channel computed by one kernel launch */
+#define MAX_OUTPUT  8192
+
+/*
+ * out[c][k] = rot(phase[c] + k * step[c]) * sum_j taps[c][j] * in[k * decim + j]
+ * with the taps of each channel mixed down by its offset already.
+ */
+static const char *kernel_source =
+  "__kernel void ddc( __global const float2 *in, __global const float2 *taps,\n"
+  "                   __global const uint *phase, __global const uint *step,\n"
+  "                   const uint ntaps, const uint decim, const uint nout,\n"
+  "                   __global float2 *out )\n"
+  "{\n"
+  "  const uint k = get_global_id( 0 );\n"
+  "  const uint c = get_global_id( 1 );\n"
+  "  if ( k >= nout )\n"
+  "    return;\n"
+  "\n"
+  "  __global const float2 *x = in + k * decim;\n"
+  "  __global const float2 *h = taps + c * ntaps;\n"
+  "  float2 acc = (float2)( 0.0f, 0.0f );\n"
+  "\n"
+  "  for ( uint j = 0; j < ntaps; j++ ) {\n"
+  "    const float2 a = x[j];\n"
+  "    const float2 b = h[j];\n"
+  "    acc += (float2)( a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x );\n"
+  "  }\n"
+  "\n"
+  "  /* 2 pi / 2^32, the phase is a fraction of a cycle */\n"
+  "  const float angle = -(float)( phase[c] + k * step[c] ) * 1.4629180792671596e-9f;\n"
+  "  float co;\n"
+  "  const float si = sincos( angle, &co );\n"
+  "\n"
+  "  out[c * nout + k] = (float2)( acc.x * co - acc.y * si, acc.x * si + acc.y * co );\n"
+  "}\n";
+
+static void check( cl_int err, const char *what )
+{
+  if ( CL_SUCCESS != err )
+    throw std::runtime_error( std::string("OpenCL ") + what +
+                              " failed with error " + std::to_string( err ) + "." );
+}
+
+/* the index-th GPU of all platforms, or of all devices if there is none */
+static cl_device_id find_device( size_t index )
+{
+  cl_uint nplatforms = 0;
+  if ( CL_SUCCESS != clGetPlatformIDs( 0, NULL, &nplatforms ) || ! nplatforms )
+    throw std::runtime_error("No OpenCL platform found.");
+
+  std::vector< cl_platform_id > platforms( nplatforms );
+  check( clGetPlatformIDs( nplatforms, &platforms[0], NULL ), "clGetPlatformIDs" );
+
+  std::vector< cl_device_id > devices;
+
+  const cl_device_type types[] = { CL_DEVICE_TYPE_GPU, CL_DEVICE_TYPE_ALL };
+  for (cl_device_type type : types) {
+    for (cl_platform_id platform : platforms) {
+      cl_uint ndevices = 0;
+      if ( CL_SUCCESS != clGetDeviceIDs( platform, type, 0, NULL, &ndevices ) || ! ndevices )
+        continue;
+
+      std::vector< cl_device_id > ids( ndevices );
+      check( clGetDeviceIDs( platform, type, ndevices, &ids[0], NULL ), "clGetDeviceIDs" );
+      devices.insert( devices.end(), ids.begin(), ids.end() );
+    }
+
+    if ( devices.size() )
+      break;
+  }
+
+  if ( index >= devices.size() )
+    throw std::runtime_error("OpenCL device " + std::to_string( index ) +
+                             " not found, there are " +
+                             std::to_string( devices.size() ) + ".");
+
+  return devices[ index ];
+}
+
+channelizer_cl_sptr make_channelizer_cl( size_t nchan, size_t decim, size_t device )
+{
+  return gnuradio::get_initial_sptr( new channelizer_cl( nchan, decim, device ) );
+}
+
+channelizer_cl::channelizer_cl( size_t nchan, size_t decim, size_t device ) :
+  gr::sync_decimator( "channelizer_cl",
+                      gr::io_signature::make( 1, 1, sizeof(gr_complex) ),
+                      gr::io_signature::make( nchan, nchan, sizeof(gr_complex) ),
+                      decim ),
+  _nchan( nchan ),
+  _decim( decim ),
+  _ntaps( 0 ),
+  _updated( false ),
+  _rate( 1 ),
+  _offsets( nchan, 0.0 ),
+  _phase( nchan, 0 ),
+  _step( nchan, 0 ),
+  _ctx( NULL ),
+  _queue( NULL ),
+  _program( NULL ),
+  _kernel( NULL ),
+  _in( NULL ),
+  _taps( NULL ),
+  _phase_buf( NULL ),
+  _step_buf( NULL ),
+  _out( NULL )
+{
+  cl_device_id dev = find_device( device );
+
+  char name[256] = "";
+  clGetDeviceInfo( dev, CL_DEVICE_NAME, sizeof(name) - 1, name, NULL );
+  std::cerr << "Using OpenCL device " << device << ": " << name
+            << " for channelization" << std::endl;
+
+  cl_int err;
+
+  _ctx = clCreateContext( NULL, 1, &dev, NULL, NULL, &err );
+  check( err, "clCreateContext" );
+
+  _queue = clCreateCommandQueue( _ctx, dev, 0, &err );
+  check( err, "clCreateCommandQueue" );
+
+  _program = clCreateProgramWithSource( _ctx, 1, &kernel_source, NULL, &err );
+  check( err, "clCreateProgramWithSource" );
+
+  if ( CL_SUCCESS != clBuildProgram( _program, 1, &dev, NULL, NULL, NULL ) ) {
+    size_t len = 0;
+    clGetProgramBuildInfo( _program, dev, CL_PROGRAM_BUILD_LOG, 0, NULL, &len );
+
+    std::string log( len, '\0' );
+    if ( len )
+      clGetProgramBuildInfo( _program, dev, CL_PROGRAM_BUILD_LOG, len, &log[0], NULL );
+
+    throw std::runtime_error("OpenCL channelizer kernel failed to build: " + log);
+  }
+
+  _kernel = clCreateKernel( _program, "ddc", &err );
+  check( err, "clCreateKernel" );
+
+  _phase_buf = clCreateBuffer( _ctx, CL_MEM_READ_ONLY, nchan * sizeof(cl_uint), NULL, &err );
+  check( err, "clCreateBuffer" );
+  _step_buf = clCreateBuffer( _ctx, CL_MEM_READ_ONLY, nchan * sizeof(cl_uint), NULL, &err );
+  check( err, "clCreateBuffer" );
+  _out = clCreateBuffer( _ctx, CL_MEM_WRITE_ONLY,
+                         nchan * MAX_OUTPUT * sizeof(gr_complex), NULL, &err );
+  check( err, "clCreateBuffer" );
+
+  set_max_noutput_items( MAX_OUTPUT );
+
+  /* every decim-th sample until the rate is known */
+  upload( std::vector< float >( 1, 1.0f ) );
+  _updated = false;
+}
+
+channelizer_cl::~channelizer_cl()
+{
+  cl_mem bufs[] = { _in, _taps, _phase_buf, _step_buf, _out };
+  for (cl_mem buf : bufs)
+    if ( buf )
+      clReleaseMemObject( buf );
+
+  if ( _kernel )
+    clReleaseKernel( _kernel );
+  if ( _program )
+    clReleaseProgram( _program );
+  if ( _queue )
+    clReleaseCommandQueue( _queue );
+  if ( _ctx )
+    clReleaseContext( _ctx );
+}
+
+void channelizer_cl::alloc( size_t ntaps )
+{
+  if ( _in )
+    clReleaseMemObject( _in );
+  if ( _taps )
+    clReleaseMemObject( _taps );
+  _in = _taps = NULL;
+
+  cl_int err;
+
+  _in = clCreateBuffer( _ctx, CL_MEM_READ_ONLY,
+                        ( MAX_OUTPUT * _decim + ntaps - 1 ) * sizeof(gr_complex),
+                        NULL, &err );
+  check( err, "clCreateBuffer" );
+
+  _taps = clCreateBuffer( _ctx, CL_MEM_READ_ONLY,
+                          _nchan * ntaps * sizeof(gr_complex), NULL, &err );
+  check( err, "clCreateBuffer" );
+}
+
+void channelizer_cl::upload( const std::vector< float > &taps )
+{
+  if ( taps.size() != _ntaps ) {
+    alloc( taps.size() );
+    _ntaps = taps.size();
+    _updated = true;
+  }
+
+  /* reversed, as the kernel runs forward through the input, and mixed
+   * down by the offset of the channel */
+  std::vector< gr_complex > mixed( _nchan * _ntaps );
+
+  for (size_t c = 0; c < _nchan; c++) {
+    const double w = -2 * M_PI * _offsets[c] / _rate;
+
+    for (size_t j = 0; j < _ntaps; j++)
+      mixed[ c * _ntaps + j ] =
+        gr_complex( std::polar( double( taps[ _ntaps - 1 - j ] ), w * j ) );
+  }
+
+  check( clEnqueueWriteBuffer( _queue, _taps, CL_TRUE, 0,
+                               mixed.size() * sizeof(gr_complex), &mixed[0],
+                               0, NULL, NULL ), "clEnqueueWriteBuffer" );
+  check( clEnqueueWriteBuffer( _queue, _step_buf, CL_TRUE, 0,
+                               _nchan * sizeof(cl_uint), &_step[0],
+                               0, NULL, NULL ), "clEnqueueWriteBuffer" );
+}
+
+void channelizer_cl::set_channels( double rate, const std::vector< float > &taps,
+                                   const std::vector< double > &offsets )
+{
+  gr::thread::scoped_lock lock( d_setlock );
+
+  _rate = rate;
+  _offsets = offsets;
+
+  for (size_t c = 0; c < _nchan; c++) {
+    /* the cycles the mixer advances between two outputs */
+    double cycles = offsets[c] * _decim / rate;
+    cycles -= std::floor( cycles );
+
+    _step[c] = uint32_t( uint64_t( std::llround( cycles * 4294967296.0 ) ) );
+    _phase[c] = 0;
+  }
+
+  upload( taps );
+}
+
+int channelizer_cl::work( int noutput_items,
+                          gr_vector_const_void_star &input_items,
+                          gr_vector_void_star &output_items )
+{
+  gr::thread::scoped_lock lock( d_setlock );
+
+  /* the taps changed length, take the history along first */
+  if ( _updated ) {
+    set_history( _ntaps );
+    _updated = false;
+    return 0;
+  }
+
+  const cl_uint nout = std::min( noutput_items, MAX_OUTPUT );
+  const cl_uint ntaps = _ntaps;
+  const cl_uint decim = _decim;
+  const size_t nin = size_t( nout ) * _decim + _ntaps - 1;
+
+  /* the queue runs in order, the blocking read of the last channel
+   * waits for each of the commands */
+  check( clEnqueueWriteBuffer( _queue, _in, CL_FALSE, 0, nin * sizeof(gr_complex),
+                               input_items[0], 0, NULL, NULL ), "clEnqueueWriteBuffer" );
+  check( clEnqueueWriteBuffer( _queue, _phase_buf, CL_FALSE, 0,
+                               _nchan * sizeof(cl_uint), &_phase[0],
+                               0, NULL, NULL ), "clEnqueueWriteBuffer" );
+
+  const struct { size_t size; const void *value; } args[] = {
+    { sizeof(cl_mem), &_in },
+    { sizeof(cl_mem), &_taps },
+    { sizeof(cl_mem), &_phase_buf },
+    { sizeof(cl_mem), &_step_buf },
+    { sizeof(cl_uint), &ntaps },
+    { sizeof(cl_uint), &decim },
+    { sizeof(cl_uint), &nout },
+    { sizeof(cl_mem), &_out },
+  };
+
+  for (cl_uint i = 0; i < sizeof(args) / sizeof(args[0]); i++)
+    check( clSetKernelArg( _kernel, i, args[i].size, args[i].value ), "clSetKernelArg" );
+
+  const size_t global[2] = { nout, _nchan };
+  check( clEnqueueNDRangeKernel( _queue, _kernel, 2, NULL, global, NULL,
+                                 0, NULL, NULL ), "clEnqueueNDRangeKernel" );
+
+  for (size_t c = 0; c < _nchan; c++)
+    check( clEnqueueReadBuffer( _queue, _out, c + 1 == _nchan ? CL_TRUE : CL_FALSE,
+                                c * nout * sizeof(gr_complex), nout * sizeof(gr_complex),
+                                output_items[c], 0, NULL, NULL ), "clEnqueueReadBuffer" );
+
+  for (size_t c = 0; c < _nchan; c++)
+    _phase[c] += nout * _step[c];
+
+  return nout;
+}
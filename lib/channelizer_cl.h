@@ -0,0 +1,102 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_CHANNELIZER_CL_H
+#define INCLUDED_OSMOSDR_CHANNELIZER_CL_H
+
+#include <cstdint>
+#include <vector>
+
+#define CL_TARGET_OPENCL_VERSION 120
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+#include <gnuradio/sync_decimator.h>
+
+class channelizer_cl;
+
+typedef boost::shared_ptr< channelizer_cl > channelizer_cl_sptr;
+
+/*!
+ * The OpenCL backend of the channelizer, see chan_backend=opencl.
+ *
+ * One kernel mixes, filters and decimates every channel on the device,
+ * each work item computing one output sample of one channel, so only the
+ * decimated channels travel back to the host. The mixer is folded into
+ * per channel taps, the phase of each output is kept as a 32 bit fixed
+ * point fraction of a cycle on the host, so it stays exact however long
+ * the stream runs.
+ *
+ * Until set_channels() the outputs carry every decim-th input sample.
+ */
+channelizer_cl_sptr make_channelizer_cl( size_t nchan, size_t decim, size_t device );
+
+class channelizer_cl : public gr::sync_decimator
+{
+private:
+  friend channelizer_cl_sptr make_channelizer_cl( size_t nchan, size_t decim,
+                                                  size_t device );
+
+  channelizer_cl( size_t nchan, size_t decim, size_t device );
+
+public:
+  ~channelizer_cl();
+
+  /*!
+   * Filter with the low pass taps, designed for the input rate, and shift
+   * the channels at the offsets in Hz down to DC.
+   */
+  void set_channels( double rate, const std::vector< float > &taps,
+                     const std::vector< double > &offsets );
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  void upload( const std::vector< float > &taps );
+  void alloc( size_t ntaps );
+
+  size_t _nchan;
+  size_t _decim;
+  size_t _ntaps;
+  bool _updated;                  /**< history to adjust to _ntaps */
+
+  double _rate;
+  std::vector< double > _offsets;
+  std::vector< uint32_t > _phase; /**< of the next output, per channel */
+  std::vector< uint32_t > _step;  /**< per output, per channel */
+
+  cl_context _ctx;
+  cl_command_queue _queue;
+  cl_program _program;
+  cl_kernel _kernel;
+  cl_mem _in;
+  cl_mem _taps;
+  cl_mem _phase_buf;
+  cl_mem _step_buf;
+  cl_mem _out;
+};
+
+#endif /* INCLUDED_OSMOSDR_CHANNELIZER_CL_H */
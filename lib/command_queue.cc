@@ -0,0 +1,202 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+#include "command_queue.h"
+
+/* longest sleep between checks, pending items are also woken by stored() */
+#define MAX_WAIT_SECS 0.1
+
+command_queue::command_queue( rx_tagger *tagger ) :
+  _tagger( tagger ),
+  _running( false ),
+  _mode( IMMEDIATE ),
+  _item( 0 ),
+  _stored( 0 ),
+  _anchor( NO_ITEM ),
+  _wake_at( NO_ITEM )
+{
+}
+
+command_queue::~command_queue()
+{
+  shutdown();
+}
+
+void command_queue::shutdown()
+{
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _running = false;
+    _mode = IMMEDIATE;
+    _queue.clear();
+  }
+  _cond.notify_all();
+
+  if ( _thread.joinable() )
+    _thread.join();
+}
+
+void command_queue::set_time( const osmosdr::time_spec_t &time )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _mode = AT_TIME;
+  _time = time;
+}
+
+void command_queue::set_item( uint64_t item )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _mode = AT_ITEM;
+  _item = item;
+}
+
+void command_queue::clear()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _mode = IMMEDIATE;
+}
+
+bool command_queue::defer( const command_t &cmd )
+{
+  std::unique_lock< std::mutex > lock( _mutex );
+
+  /* a queued command being applied calls the setter again */
+  if ( _mode == IMMEDIATE || std::this_thread::get_id() == _thread.get_id() )
+    return false;
+
+  entry_t entry;
+  entry.by_item = ( _mode == AT_ITEM );
+  entry.item = _item;
+  entry.time = _time;
+  entry.cmd = cmd;
+  _queue.push_back( entry );
+
+  if ( ! _running ) {
+    if ( _thread.joinable() ) {
+      lock.unlock();
+      _thread.join();
+      lock.lock();
+    }
+    _running = true;
+    _thread = std::thread( &command_queue::run, this );
+  }
+
+  lock.unlock();
+  _cond.notify_all();
+
+  return true;
+}
+
+void command_queue::reset()
+{
+  _stored.store( 0 );
+  _anchor.store( NO_ITEM );
+  _cond.notify_all();
+}
+
+void command_queue::set_anchor( uint64_t item )
+{
+  uint64_t none = NO_ITEM;
+  if ( _anchor.compare_exchange_strong( none, item ) )
+    _cond.notify_all();
+}
+
+bool command_queue::due( const entry_t &entry )
+{
+  if ( entry.by_item ) {
+    const uint64_t anchor = _anchor.load();
+    return anchor != NO_ITEM && anchor + _stored.load() >= entry.item;
+  }
+
+  return osmosdr::time_spec_t::get_system_time() >= entry.time;
+}
+
+void command_queue::retag()
+{
+  if ( ! _tagger )
+    return;
+
+  const uint64_t anchor = _anchor.load();
+  _tagger->retag_at( anchor == NO_ITEM ? 0 : anchor + _stored.load() );
+}
+
+void command_queue::run()
+{
+  std::unique_lock< std::mutex > lock( _mutex );
+  bool applied = false;
+
+  while ( _running ) {
+    if ( _queue.size() && due( _queue.front() ) ) {
+      command_t cmd = _queue.front().cmd;
+      _queue.pop_front();
+
+      /* holds off the retag() of the setters until the batch is done */
+      if ( ! applied )
+        retag();
+
+      lock.unlock();
+      try {
+        cmd();
+      } catch ( const std::exception &e ) {
+        std::cerr << "Timed command failed: " << e.what() << std::endl;
+      }
+      lock.lock();
+
+      applied = true;
+      continue;
+    }
+
+    /* the batch is done, the next item received gets the new settings */
+    if ( applied )
+      retag();
+    applied = false;
+
+    if ( _queue.empty() ) {
+      _wake_at.store( NO_ITEM );
+      _cond.wait( lock );
+      continue;
+    }
+
+    const entry_t &next = _queue.front();
+    double wait = MAX_WAIT_SECS;
+
+    if ( next.by_item ) {
+      const uint64_t anchor = _anchor.load();
+      _wake_at.store( anchor == NO_ITEM ? NO_ITEM :
+                      next.item > anchor ? next.item - anchor : 0 );
+    } else {
+      wait = std::min( wait, ( next.time - osmosdr::time_spec_t::get_system_time() )
+                             .get_real_secs() );
+    }
+
+    _cond.wait_for( lock, std::chrono::duration< double >( std::max( wait, 0.0 ) ) );
+  }
+}
@@ -0,0 +1,128 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_COMMAND_QUEUE_H
+#define INCLUDED_OSMOSDR_COMMAND_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <osmosdr/api.h>
+#include <osmosdr/time_spec.h>
+
+#include "rx_tagger.h"
+
+/*!
+ * Timed commands for sources without them in hardware.
+ *
+ * While a command time is set, the driver hands its settings to defer()
+ * instead of applying them. They are applied in order on a thread of the
+ * queue once the host clock of get_time_now() reaches the command time,
+ * or once the given item of the stream has been received. The first item
+ * received afterwards is re-anchored in the rx_tagger, so its
+ * rx_time/rx_freq tags mark where the new settings start, up to the
+ * transfers the device had already queued.
+ *
+ * The capture side reports the items it stores with stored(), work()
+ * reports the stream index of the first of them with anchor().
+ */
+class OSMOSDR_API command_queue
+{
+public:
+  typedef std::function< void() > command_t;
+
+  explicit command_queue( rx_tagger *tagger = NULL );
+  ~command_queue();
+
+  /*! defer the following settings until get_system_time() reaches time */
+  void set_time( const osmosdr::time_spec_t &time );
+
+  /*! defer the following settings until the given item is received */
+  void set_item( uint64_t item );
+
+  /*! apply the following settings right away again */
+  void clear();
+
+  /*!
+   * Queue cmd at the command time, if one is set.
+   * \return false if the caller has to apply the setting itself
+   */
+  bool defer( const command_t &cmd );
+
+  /*! drop the pending commands, before the device goes away */
+  void shutdown();
+
+  /*! streaming (re)starts, nothing has been stored yet */
+  void reset();
+
+  /*! the capture side stored nitems more items for work() */
+  void stored( size_t nitems )
+  {
+    const uint64_t total = _stored.fetch_add( nitems ) + nitems;
+    if ( total >= _wake_at.load( std::memory_order_relaxed ) )
+      _cond.notify_one();
+  }
+
+  /*! the stream index of the first item stored since reset() */
+  void anchor( uint64_t item )
+  {
+    if ( _anchor.load( std::memory_order_relaxed ) == NO_ITEM )
+      set_anchor( item );
+  }
+
+private:
+  static const uint64_t NO_ITEM = ~uint64_t(0);
+
+  struct entry_t
+  {
+    bool by_item;
+    uint64_t item;
+    osmosdr::time_spec_t time;
+    command_t cmd;
+  };
+
+  void set_anchor( uint64_t item );
+  bool due( const entry_t &entry );
+  void retag();
+  void run();
+
+  rx_tagger *_tagger;
+
+  std::mutex _mutex;
+  std::condition_variable _cond;
+  std::deque< entry_t > _queue;
+  std::thread _thread;
+  bool _running;
+
+  enum { IMMEDIATE, AT_TIME, AT_ITEM } _mode;
+  osmosdr::time_spec_t _time;
+  uint64_t _item;
+
+  std::atomic< uint64_t > _stored;
+  std::atomic< uint64_t > _anchor;
+  std::atomic< uint64_t > _wake_at;  /**< stored count a pending item is due at */
+};
+
+#endif /* INCLUDED_OSMOSDR_COMMAND_QUEUE_H */
@@ -0,0 +1,78 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <iostream>
+
+#include <gnuradio/io_signature.h>
+
+#include "control_port.h"
+
+#define COMMAND_PORT pmt::string_to_symbol("command")
+#define STATUS_PORT pmt::string_to_symbol("status")
+
+control_port_sptr control_port::make( const handler_t &handler )
+{
+  return gnuradio::get_initial_sptr( new control_port( handler ) );
+}
+
+control_port::control_port( const handler_t &handler ) :
+  gr::block( "control_port",
+             gr::io_signature::make( 0, 0, 0 ),
+             gr::io_signature::make( 0, 0, 0 ) ),
+  _handler( handler )
+{
+  message_port_register_in( COMMAND_PORT );
+  message_port_register_out( STATUS_PORT );
+  set_msg_handler( COMMAND_PORT, std::bind( &control_port::handle_command, this,
+                                            std::placeholders::_1 ) );
+}
+
+void control_port::handle_command( pmt::pmt_t msg )
+{
+  pmt::pmt_t status;
+
+  try {
+    status = _handler( msg );
+  } catch ( std::exception &ex ) {
+    std::cerr << "Command failed: " << ex.what() << std::endl;
+
+    status = pmt::dict_add( pmt::make_dict(), pmt::intern( "error" ),
+                            pmt::intern( ex.what() ) );
+  }
+
+  message_port_pub( STATUS_PORT, status );
+}
+
+bool control_port::lookup( const pmt::pmt_t &cmd, const char *key, pmt::pmt_t &value )
+{
+  const pmt::pmt_t name = pmt::intern( key );
+
+  if ( ! pmt::dict_has_key( cmd, name ) )
+    return false;
+
+  value = pmt::dict_ref( cmd, name, PMT_NIL );
+  return true;
+}
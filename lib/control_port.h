@@ -0,0 +1,108 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_CONTROL_PORT_H
+#define INCLUDED_OSMOSDR_CONTROL_PORT_H
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include <gnuradio/block.h>
+
+class control_port;
+
+typedef boost::shared_ptr< control_port > control_port_sptr;
+
+/*!
+ * The command message port of osmosdr::source and osmosdr::sink.
+ *
+ * Controllers post dicts with any of the keys freq, gain, rate, bw and
+ * antenna, for the channel given by chan (0 by default). Messages are
+ * queued by the scheduler and handled on the thread of this block, so the
+ * poster never waits for the device; the settings are applied in order,
+ * rate first. A dict of what the device applied, or an error, is posted
+ * to the status port for each command.
+ */
+class control_port : public gr::block
+{
+public:
+  /*! applies a command, returning the status to post */
+  typedef std::function< pmt::pmt_t( const pmt::pmt_t &cmd ) > handler_t;
+
+  static control_port_sptr make( const handler_t &handler );
+
+  /*!
+   * Apply the settings of a command dict to a source or sink.
+   * \throws std::runtime_error for anything but a dict
+   */
+  template< typename T >
+  static pmt::pmt_t apply( T &dev, const pmt::pmt_t &cmd );
+
+private:
+  explicit control_port( const handler_t &handler );
+
+  void handle_command( pmt::pmt_t msg );
+
+  static bool lookup( const pmt::pmt_t &cmd, const char *key, pmt::pmt_t &value );
+
+  handler_t _handler;
+};
+
+template< typename T >
+pmt::pmt_t control_port::apply( T &dev, const pmt::pmt_t &cmd )
+{
+  if ( ! pmt::is_dict( cmd ) )
+    throw std::runtime_error( "commands are dicts of freq, gain, rate, bw, antenna and chan" );
+
+  pmt::pmt_t status = pmt::make_dict();
+  pmt::pmt_t value;
+
+  size_t chan = 0;
+  if ( lookup( cmd, "chan", value ) )
+    chan = pmt::to_long( value );
+  status = pmt::dict_add( status, pmt::intern( "chan" ), pmt::from_long( chan ) );
+
+  /* the bandwidth may follow the rate, so the rate goes first */
+  if ( lookup( cmd, "rate", value ) )
+    status = pmt::dict_add( status, pmt::intern( "rate" ),
+                            pmt::from_double( dev.set_sample_rate( pmt::to_double( value ) ) ) );
+
+  if ( lookup( cmd, "freq", value ) )
+    status = pmt::dict_add( status, pmt::intern( "freq" ),
+                            pmt::from_double( dev.set_center_freq( pmt::to_double( value ), chan ) ) );
+
+  if ( lookup( cmd, "bw", value ) )
+    status = pmt::dict_add( status, pmt::intern( "bw" ),
+                            pmt::from_double( dev.set_bandwidth( pmt::to_double( value ), chan ) ) );
+
+  if ( lookup( cmd, "gain", value ) )
+    status = pmt::dict_add( status, pmt::intern( "gain" ),
+                            pmt::from_double( dev.set_gain( pmt::to_double( value ), chan ) ) );
+
+  if ( lookup( cmd, "antenna", value ) )
+    status = pmt::dict_add( status, pmt::intern( "antenna" ),
+                            pmt::intern( dev.set_antenna( pmt::symbol_to_string( value ), chan ) ) );
+
+  return status;
+}
+
+#endif /* INCLUDED_OSMOSDR_CONTROL_PORT_H */
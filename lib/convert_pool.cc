@@ -0,0 +1,140 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+
+#include <boost/lexical_cast.hpp>
+
+#include <gnuradio/thread/thread.h>
+
+#include "arg_helpers.h"
+#include "convert_pool.h"
+
+/* items below which a slice costs more to hand out than to convert */
+#define MIN_SLICE   8192
+
+/* slices start at multiples of this, so the kernels stay in their SIMD loops */
+#define SLICE_ALIGN 64
+
+convert_pool::convert_pool( const std::string &args ) :
+  _nthreads( 1 ),
+  _cpu( -1 ),
+  _running( true ),
+  _job( NULL ),
+  _nitems( 0 ),
+  _slice( 0 ),
+  _active( 0 ),
+  _pending( 0 ),
+  _generation( 0 )
+{
+  dict_t dict = params_to_dict( args );
+
+  if ( dict.count( "convert_threads" ) )
+    _nthreads = std::max( 1, boost::lexical_cast< int >( dict["convert_threads"] ) );
+
+  if ( dict.count( "convert_cpu" ) )
+    _cpu = boost::lexical_cast< int >( dict["convert_cpu"] );
+
+  for (size_t i = 1; i < _nthreads; i++)
+    _workers.push_back( std::thread( &convert_pool::worker, this, i ) );
+}
+
+convert_pool::~convert_pool()
+{
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _running = false;
+  }
+  _start.notify_all();
+
+  for (std::thread &worker : _workers)
+    worker.join();
+}
+
+void convert_pool::run( size_t nitems, const job_t &job )
+{
+  const size_t nslices = std::min( _nthreads, nitems / MIN_SLICE );
+
+  if ( nslices < 2 ) {
+    job( 0, nitems );
+    return;
+  }
+
+  const size_t slice = ( ( nitems + nslices - 1 ) / nslices + SLICE_ALIGN - 1 ) /
+                       SLICE_ALIGN * SLICE_ALIGN;
+
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _job = &job;
+    _nitems = nitems;
+    _slice = slice;
+    _active = nslices;
+    _pending = nslices - 1;
+    _generation++;
+  }
+  _start.notify_all();
+
+  /* the first slice is ours */
+  job( 0, std::min( slice, nitems ) );
+
+  std::unique_lock< std::mutex > lock( _mutex );
+  _done.wait( lock, [this] { return ! _pending; } );
+  _job = NULL;
+}
+
+void convert_pool::worker( size_t index )
+{
+  if ( _cpu >= 0 )
+    gr::thread::thread_bind_to_processor( _cpu + int(index) - 1 );
+
+  uint64_t seen = 0;
+
+  std::unique_lock< std::mutex > lock( _mutex );
+
+  while ( true ) {
+    _start.wait( lock, [this, &seen] { return ! _running || _generation != seen; } );
+    if ( ! _running )
+      return;
+
+    seen = _generation;
+
+    /* run() waits for every worker with a slice, none misses its block */
+    if ( index >= _active )
+      continue;
+
+    const job_t *job = _job;
+    const size_t begin = std::min( index * _slice, _nitems );
+    const size_t end = std::min( begin + _slice, _nitems );
+
+    lock.unlock();
+    if ( begin < end )
+      (*job)( begin, end );
+    lock.lock();
+
+    if ( ! --_pending )
+      _done.notify_one();
+  }
+}
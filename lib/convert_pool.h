@@ -0,0 +1,83 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_CONVERT_POOL_H
+#define INCLUDED_OSMOSDR_CONVERT_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <osmosdr/api.h>
+
+/*!
+ * Worker threads sharing the conversion of large blocks of samples, from
+ * the convert_threads= and convert_cpu= device arguments.
+ *
+ * convert_threads=N converts with N threads, the calling one included,
+ * and convert_cpu=N binds the workers to consecutive cores from N on.
+ * Blocks too small to be worth waking the workers for are converted by
+ * the calling thread alone, as is everything without convert_threads.
+ */
+class OSMOSDR_API convert_pool
+{
+public:
+  /*! converts the items [begin, end) */
+  typedef std::function< void( size_t begin, size_t end ) > job_t;
+
+  explicit convert_pool( const std::string &args );
+  ~convert_pool();
+
+  /*! the number of threads converting a large block */
+  size_t threads() const { return _nthreads; }
+
+  /*!
+   * Run job over nitems items, split into slices aligned for the SIMD
+   * kernels, and return once all of them are done.
+   */
+  void run( size_t nitems, const job_t &job );
+
+private:
+  void worker( size_t index );
+
+  size_t _nthreads;
+  int _cpu;
+
+  std::mutex _mutex;
+  std::condition_variable _start;
+  std::condition_variable _done;
+  std::vector< std::thread > _workers;
+  bool _running;
+
+  /* the block being converted, guarded by _mutex */
+  const job_t *_job;
+  size_t _nitems;
+  size_t _slice;
+  size_t _active;               /**< threads with a slice, the caller included */
+  size_t _pending;              /**< workers not done with theirs */
+  uint64_t _generation;         /**< counts the blocks, wakes the workers */
+};
+
+#endif /* INCLUDED_OSMOSDR_CONVERT_POOL_H */
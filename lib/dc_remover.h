@@ -0,0 +1,240 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_DC_REMOVER_H
+#define INCLUDED_OSMOSDR_DC_REMOVER_H
+
+#include <atomic>
+#include <complex>
+
+#include <osmosdr/source.h>
+
+#include "sample_convert.h"
+#include "power_meter.h"
+#include "soft_agc.h"
+#include "burst_gate.h"
+
+/* per sample weight of the automatic DC estimate, about 1e5 samples */
+#define DC_REMOVER_ALPHA 1e-5f
+
+/*!
+ * The DC offset modes of set_dc_offset_mode() for drivers converting the
+ * samples themselves, by means of the *_dc conversion kernels so the
+ * correction rides along the pass over the samples the driver makes
+ * anyway. With set_agc(), set_power_tags() or set_squelch() the *_agc
+ * kernels also level or measure the result.
+ *
+ * Modes and the manual offset may be changed from any thread, convert()
+ * belongs to the thread calling work().
+ */
+class dc_remover
+{
+public:
+  dc_remover() :
+    _mode( osmosdr::source::DCOffsetOff ),
+    _offset_i( 0.0f ),
+    _offset_q( 0.0f ),
+    _offset_set( false ),
+    _dc( 0.0f, 0.0f ),
+    _none( 0.0f, 0.0f )
+  {
+  }
+
+  void set_mode( int mode ) { _mode = mode; }
+  int mode() const { return _mode; }
+
+  /*!
+   * The offset subtracted in manual mode, 1.0 is full scale. Until one is
+   * set manual mode keeps the last automatic estimate.
+   */
+  void set_offset( const std::complex<double> &offset )
+  {
+    _offset_i = float(offset.real());
+    _offset_q = float(offset.imag());
+    _offset_set = true;
+  }
+
+  /*! enable the software AGC, before streaming */
+  void set_agc( double ref_dbfs ) { _agc.set_reference( ref_dbfs ); }
+
+  /*! measure the level of every nitems samples, before streaming */
+  void set_power_tags( size_t nitems ) { _meter.set_length( nitems ); }
+
+  /*! forward only the bursts above squelch_db, before streaming */
+  void set_squelch( double squelch_db, size_t pre, size_t post )
+  {
+    _gate.configure( squelch_db, pre, post );
+  }
+
+  bool squelching() const { return _gate.enabled(); }
+
+  /*! streaming (re)starts */
+  void reset() { _gate.reset(); }
+
+  /*!
+   * Reduce the nitems items work() converted to the bursts, see
+   * burst_gate::apply().
+   */
+  int gate( gr::block *block, void *items, int nitems, rx_tagger *tagger )
+  {
+    return _gate.apply( block, (gr_complex *)items, nitems, tagger );
+  }
+
+  /*!
+   * Add the rx_power tags for the nitems work() produced, after gate()
+   * so they go on the items it kept.
+   */
+  void tag_levels( gr::block *block, size_t nitems, size_t decim = 1 )
+  {
+    if ( ! _meter.enabled() )
+      return;
+
+    if ( _gate.enabled() )
+      _meter.tag( block, _gate );
+    else
+      _meter.tag( block, nitems, decim );
+  }
+
+  void convert( const uint8_t *in, gr_complex *out, size_t nitems )
+  {
+    float alpha;
+    if ( measuring() ) {
+      gr_complex &dc = prepare_agc( alpha );
+      for (size_t n; nitems; in += n * 2, out += n, nitems -= n) {
+        sample_level_t level;
+        n = _gate.chunk( _meter.chunk( nitems ) );
+        convert_cu8_fc32_agc( in, out, n, dc, alpha, _agc.gain(), level );
+        measured( level, n );
+      }
+    } else if ( prepare( alpha ) )
+      convert_cu8_fc32_dc( in, out, nitems, _dc, alpha );
+    else
+      convert_cu8_fc32( in, out, nitems );
+  }
+
+  void convert( const int8_t *in, gr_complex *out, size_t nitems )
+  {
+    float alpha;
+    if ( measuring() ) {
+      gr_complex &dc = prepare_agc( alpha );
+      for (size_t n; nitems; in += n * 2, out += n, nitems -= n) {
+        sample_level_t level;
+        n = _gate.chunk( _meter.chunk( nitems ) );
+        convert_cs8_fc32_agc( in, out, n, dc, alpha, _agc.gain(), level );
+        measured( level, n );
+      }
+    } else if ( prepare( alpha ) )
+      convert_cs8_fc32_dc( in, out, nitems, _dc, alpha );
+    else
+      convert_cs8_fc32( in, out, nitems );
+  }
+
+  void convert( const int16_t *in, gr_complex *out, size_t nitems, float scale )
+  {
+    float alpha;
+    if ( measuring() ) {
+      gr_complex &dc = prepare_agc( alpha );
+      for (size_t n; nitems; in += n * 2, out += n, nitems -= n) {
+        sample_level_t level;
+        n = _gate.chunk( _meter.chunk( nitems ) );
+        convert_cs16_fc32_agc( in, out, n, scale, dc, alpha, _agc.gain(), level );
+        measured( level, n );
+      }
+    } else if ( prepare( alpha ) )
+      convert_cs16_fc32_dc( in, out, nitems, scale, _dc, alpha );
+    else
+      convert_cs16_fc32_deinterleave( in, &out, 1, nitems, scale );
+  }
+
+  /*! for samples delivered as complex float, in place */
+  void process( gr_complex *items, size_t nitems )
+  {
+    float alpha;
+    if ( measuring() ) {
+      gr_complex &dc = prepare_agc( alpha );
+      for (size_t n; nitems; items += n, nitems -= n) {
+        sample_level_t level;
+        n = _gate.chunk( _meter.chunk( nitems ) );
+        scale_fc32_agc( items, items, n, dc, alpha, _agc.gain(), level );
+        measured( level, n );
+      }
+    } else if ( prepare( alpha ) )
+      remove_dc_fc32( items, items, nitems, _dc, alpha );
+  }
+
+private:
+  /* false without correction, otherwise sets the weight of the update */
+  bool prepare( float &alpha )
+  {
+    switch ( _mode.load( std::memory_order_relaxed ) ) {
+    case osmosdr::source::DCOffsetManual:
+      if ( _offset_set.exchange( false ) )
+        _dc = gr_complex( _offset_i.load(), _offset_q.load() );
+      alpha = 0.0f;
+      return true;
+    case osmosdr::source::DCOffsetAutomatic:
+      alpha = DC_REMOVER_ALPHA;
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  /* the *_agc kernels level or measure the samples along the conversion */
+  bool measuring() const
+  {
+    return _agc.enabled() || _meter.enabled() || _gate.enabled();
+  }
+
+  /* of the samples converted with the current gain */
+  void measured( const sample_level_t &level, size_t nitems )
+  {
+    if ( _meter.enabled() )
+      _meter.add( level, nitems, _agc.gain() );
+    if ( _gate.enabled() )
+      _gate.add( level, nitems, _agc.gain() );
+    if ( _agc.enabled() )
+      _agc.update( level.power, nitems );
+  }
+
+  /* the estimate to remove along the AGC, zero without correction */
+  gr_complex &prepare_agc( float &alpha )
+  {
+    if ( prepare( alpha ) )
+      return _dc;
+
+    _none = gr_complex( 0.0f, 0.0f );
+    alpha = 0.0f;
+    return _none;
+  }
+
+  std::atomic<int> _mode;
+  std::atomic<float> _offset_i;
+  std::atomic<float> _offset_q;
+  std::atomic<bool> _offset_set;  /**< not yet taken over by convert() */
+  gr_complex _dc;               /**< the current estimate, of work() */
+  gr_complex _none;             /**< no estimate, for the AGC alone */
+  soft_agc _agc;
+  power_meter _meter;
+  burst_gate _gate;
+};
+
+#endif /* INCLUDED_OSMOSDR_DC_REMOVER_H */
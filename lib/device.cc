@@ -22,70 +22,15 @@
 #include <stdexcept>
 #include <boost/format.hpp>
 #include <algorithm>
-#include <mutex>
 #include <sstream>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
-#ifdef ENABLE_FCD
-#include <fcd_source_c.h>
-#endif
-
-#ifdef ENABLE_FILE
-#include <file_source_c.h>
-#endif
-
-#ifdef ENABLE_RTL
-#include <rtl_source_c.h>
-#endif
-
-#ifdef ENABLE_RTL_TCP
-#include <rtl_tcp_source_c.h>
-#endif
-
-#ifdef ENABLE_UHD
-#include <uhd_source_c.h>
-#endif
-
-#ifdef ENABLE_SDRPLAY
-#include <sdrplay_source_c.h>
-#endif
-
-#ifdef ENABLE_HACKRF
-#include <hackrf_source_c.h>
-#endif
-
-#ifdef ENABLE_BLADERF
-#include <bladerf_source_c.h>
-#endif
-
-#ifdef ENABLE_RFSPACE
-#include <rfspace_source_c.h>
-#endif
-
-#ifdef ENABLE_AIRSPY
-#include <airspy_source_c.h>
-#endif
-
-#ifdef ENABLE_AIRSPYHF
-#include <airspyhf_source_c.h>
-#endif
-
-#ifdef ENABLE_SOAPY
-#include <soapy_source_c.h>
-#endif
-
-#ifdef ENABLE_REDPITAYA
-#include <redpitaya_source_c.h>
-#endif
-
-#ifdef ENABLE_FREESRP
-#include <freesrp_source_c.h>
-#endif
-
 #include "arg_helpers.h"
+#include "device_cache.h"
+#include "driver_registry.h"
 
 using namespace osmosdr;
 
@@ -93,8 +38,6 @@ static const std::string args_delim = " ";
 static const std::string pairs_delim = ",";
 static const std::string pair_delim = "=";
 
-static std::mutex _device_mutex;
-
 device_t::device_t(const std::string &args)
 {
   dict_t dict = params_to_dict(args);
@@ -132,76 +75,37 @@ std::string device_t::to_string(void) const
 
 devices_t device::find(const device_t &hint)
 {
-  std::lock_guard<std::mutex> lock(_device_mutex);
-
   bool fake = true;
 
   if ( hint.count("nofake") )
     fake = false;
 
-  devices_t devices;
+  /* the fake entries differ, so do their cache entries */
+  const std::string opts = fake ? "" : ",nofake";
 
-#ifdef ENABLE_FCD
-  for (std::string dev : fcd_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_RTL
-  for (std::string dev : rtl_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_UHD
-  for (std::string dev : uhd_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_SDRPLAY
-  for (std::string dev : sdrplay_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_BLADERF
-  for (std::string dev : bladerf_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_HACKRF
-  for (std::string dev : hackrf_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_RFSPACE
-  for (std::string dev : rfspace_source_c::get_devices( fake ))
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_AIRSPY
-  for (std::string dev : airspy_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_AIRSPYHF
-  for (std::string dev : airspyhf_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_FREESRP
-  for (std::string dev : freesrp_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_SOAPY
-  for (std::string dev : soapy_source_c::get_devices())
-    devices.push_back( device_t(dev) );
-#endif
+  std::vector< device_cache::driver_t > drivers;
 
-  /* software-only sources should be appended at the very end,
+  /* software-only sources are ranked at the very end,
    * hopefully resulting in hardware sources to be shown first
    * in a graphical interface etc... */
+  for (const driver_registry::driver_t *driver : driver_registry::get().all()) {
+    if ( ! driver->source_devices )
+      continue;
 
-#ifdef ENABLE_RTL_TCP
-  for (std::string dev : rtl_tcp_source_c::get_devices( fake ))
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_REDPITAYA
-  for (std::string dev : redpitaya_source_c::get_devices( fake ))
-    devices.push_back( device_t(dev) );
-#endif
-#ifdef ENABLE_FILE
-  for (std::string dev : file_source_c::get_devices( fake ))
+    driver_registry::lister_t lister = driver->source_devices;
+    drivers.push_back( device_cache::driver_t{ driver->name + opts, driver->kind,
+                                               [lister, fake]{ return lister( fake ); } } );
+  }
+
+  /* all stale drivers are enumerated concurrently */
+  std::vector< std::string > found = device_cache::get().lookup( drivers,
+    hint.cast< double >( "cache_ttl", DEVICE_CACHE_TTL ),
+    hint.cast< double >( "enum_timeout", DEVICE_ENUM_TIMEOUT ) );
+
+  devices_t devices;
+
+  for (std::string dev : found)
     devices.push_back( device_t(dev) );
-#endif
 
   return devices;
 }
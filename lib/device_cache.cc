@@ -0,0 +1,232 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <atomic>
+#include <thread>
+
+#ifdef HAVE_LIBUSB_HOTPLUG
+#include <libusb.h>
+#endif
+
+#include "device_cache.h"
+
+namespace {
+
+/*
+ * Counts USB devices arriving and leaving, from a libusb context of its
+ * own serviced by a background thread. Inactive without hotplug support.
+ */
+class usb_monitor
+{
+public:
+  usb_monitor() :
+    _active( false ),
+    _running( false ),
+    _generation( 0 )
+  {
+#ifdef HAVE_LIBUSB_HOTPLUG
+    _ctx = NULL;
+
+    if ( libusb_init( &_ctx ) < 0 )
+      return;
+
+    if ( ! libusb_has_capability( LIBUSB_CAP_HAS_HOTPLUG ) ||
+         libusb_hotplug_register_callback( _ctx,
+             libusb_hotplug_event( LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED |
+                                   LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT ),
+             libusb_hotplug_flag( 0 ),
+             LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY,
+             LIBUSB_HOTPLUG_MATCH_ANY,
+             &usb_monitor::hotplug_cb, this, &_handle ) != LIBUSB_SUCCESS ) {
+      libusb_exit( _ctx );
+      _ctx = NULL;
+      return;
+    }
+
+    _running = true;
+    _thread = std::thread( &usb_monitor::event_loop, this );
+    _active = true;
+#endif
+  }
+
+  ~usb_monitor()
+  {
+#ifdef HAVE_LIBUSB_HOTPLUG
+    if ( ! _ctx )
+      return;
+
+    /* deregistering wakes up the event loop */
+    _running = false;
+    libusb_hotplug_deregister_callback( _ctx, _handle );
+    if ( _thread.joinable() )
+      _thread.join();
+
+    libusb_exit( _ctx );
+#endif
+  }
+
+  bool active() const { return _active; }
+
+  uint64_t generation() const { return _generation.load(); }
+
+private:
+#ifdef HAVE_LIBUSB_HOTPLUG
+  static int LIBUSB_CALL hotplug_cb( libusb_context *ctx, libusb_device *dev,
+                                     libusb_hotplug_event event, void *user_data )
+  {
+    usb_monitor *obj = (usb_monitor *)user_data;
+    obj->_generation++;
+
+    return 0; /* stay registered */
+  }
+
+  void event_loop()
+  {
+    while ( _running ) {
+      struct timeval tv = { 1, 0 };
+      libusb_handle_events_timeout_completed( _ctx, &tv, NULL );
+    }
+  }
+
+  libusb_context *_ctx;
+  libusb_hotplug_callback_handle _handle;
+#endif
+
+  bool _active;
+  std::atomic<bool> _running;
+  std::atomic<uint64_t> _generation;
+  std::thread _thread;
+};
+
+usb_monitor &monitor()
+{
+  static usb_monitor instance;
+  return instance;
+}
+
+}
+
+device_cache &device_cache::get()
+{
+  static device_cache instance;
+  return instance;
+}
+
+device_cache::device_cache()
+{
+  /* start watching before the first enumeration */
+  monitor();
+}
+
+bool device_cache::valid( const entry_t &entry, kind_t kind, double ttl ) const
+{
+  if ( STATIC == kind )
+    return true;
+
+  if ( monitor().active() && entry.usb_generation != monitor().generation() )
+    return false;
+
+  if ( USB == kind && monitor().active() )
+    return true;
+
+  return std::chrono::steady_clock::now() - entry.stamp <
+         std::chrono::duration< double >( ttl );
+}
+
+std::vector< std::string > device_cache::lookup( const std::vector< driver_t > &drivers,
+                                                 double ttl, double timeout )
+{
+  std::vector< std::vector< std::string > > lists( drivers.size() );
+  std::vector< size_t > stale( drivers.size() );
+  for ( size_t i = 0; i < stale.size(); i++ )
+    stale[i] = i;
+
+  std::unique_lock< std::mutex > lock( _mutex );
+
+  while ( stale.size() ) {
+    /* take the cached drivers, claim the stale ones nobody refreshes and
+     * leave those being refreshed by another thread for the next round */
+    std::vector< size_t > mine, busy;
+
+    for ( size_t i : stale ) {
+      std::map< std::string, entry_t >::const_iterator it = _entries.find( drivers[i].key );
+
+      if ( ttl > 0 && it != _entries.end() && valid( it->second, drivers[i].kind, ttl ) )
+        lists[i] = it->second.devices;
+      else if ( _refreshing.count( drivers[i].key ) )
+        busy.push_back( i );
+      else {
+        _refreshing.insert( drivers[i].key );
+        mine.push_back( i );
+      }
+    }
+
+    if ( mine.size() ) {
+      /* events during the enumeration invalidate what it found */
+      const uint64_t generation = monitor().generation();
+
+      lock.unlock();
+
+      device_enumerator enumerator( timeout );
+      for ( size_t i : mine )
+        enumerator.add( drivers[i].key, drivers[i].lister );
+
+      std::vector< bool > done;
+      std::vector< std::vector< std::string > > found = enumerator.each( done );
+
+      lock.lock();
+
+      for ( size_t j = 0; j < mine.size(); j++ ) {
+        const std::string &key = drivers[ mine[j] ].key;
+
+        lists[ mine[j] ] = found[j];
+        _refreshing.erase( key );
+
+        if ( ! done[j] )
+          continue;
+
+        entry_t &entry = _entries[ key ];
+        entry.devices = found[j];
+        entry.stamp = std::chrono::steady_clock::now();
+        entry.usb_generation = generation;
+      }
+
+      _refreshed.notify_all();
+    } else if ( busy.size() ) {
+      _refreshed.wait( lock );
+    }
+
+    stale.swap( busy );
+  }
+
+  lock.unlock();
+
+  std::vector< std::string > devices;
+  for ( const std::vector< std::string > &list : lists )
+    devices.insert( devices.end(), list.begin(), list.end() );
+
+  return devices;
+}
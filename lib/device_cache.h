@@ -0,0 +1,91 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_DEVICE_CACHE_H
+#define INCLUDED_OSMOSDR_DEVICE_CACHE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "device_enum.h"
+
+/* seconds the devices of network drivers are cached, see cache_ttl */
+#define DEVICE_CACHE_TTL 10.0
+
+/*!
+ * Process wide cache of the devices listed by the drivers, behind
+ * osmosdr::device::find().
+ *
+ * The devices of USB drivers stay valid until libusb reports a device
+ * arriving or leaving, or for the TTL where hotplug events are not
+ * available. Drivers finding devices on the network are re-enumerated
+ * after the TTL, and on hotplug events since some of their devices are
+ * attached by USB as well. Static lists, e.g. the fake file entries, are
+ * cached for good. A lookup hitting the cache only takes a short lock to
+ * copy the lists; stale drivers are enumerated concurrently, one refresh
+ * per driver at a time, and drivers which timed out are not cached. A
+ * lookup only waits for the refresh of a driver it needs itself.
+ */
+class device_cache
+{
+public:
+  enum kind_t { USB, NETWORK, STATIC };
+
+  struct driver_t
+  {
+    std::string key;            /**< driver name and enumeration options */
+    kind_t kind;
+    device_enumerator::lister_t lister;
+  };
+
+  static device_cache &get();
+
+  /*!
+   * The devices of all drivers in order, enumerating the stale ones with
+   * the given timeout. A ttl of 0 bypasses the cache.
+   */
+  std::vector< std::string > lookup( const std::vector< driver_t > &drivers,
+                                     double ttl, double timeout );
+
+private:
+  device_cache();
+
+  struct entry_t
+  {
+    std::vector< std::string > devices;
+    std::chrono::steady_clock::time_point stamp;
+    uint64_t usb_generation;
+  };
+
+  bool valid( const entry_t &entry, kind_t kind, double ttl ) const;
+
+  std::mutex _mutex;            /**< guards _entries and _refreshing */
+  std::condition_variable _refreshed;
+  std::map< std::string, entry_t > _entries;
+  std::set< std::string > _refreshing; /**< keys being enumerated */
+};
+
+#endif /* INCLUDED_OSMOSDR_DEVICE_CACHE_H */
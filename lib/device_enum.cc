@@ -0,0 +1,179 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/lexical_cast.hpp>
+
+#include "device_enum.h"
+#include "arg_helpers.h"
+
+namespace {
+
+/* outlives the enumerator when a driver misses the deadline */
+struct enum_state
+{
+  struct result
+  {
+    bool done;
+    std::vector< std::string > devices;
+  };
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::vector< result > results;
+};
+
+}
+
+device_enumerator::device_enumerator( double timeout ) :
+  _timeout( timeout )
+{
+}
+
+void device_enumerator::add( const std::string &name, lister_t lister )
+{
+  _drivers.push_back( std::make_pair( name, lister ) );
+}
+
+std::vector< std::string > device_enumerator::all()
+{
+  std::vector< bool > done;
+  std::vector< std::string > devices;
+
+  for ( const std::vector< std::string > &driver : run( false, done ) )
+    devices.insert( devices.end(), driver.begin(), driver.end() );
+
+  return devices;
+}
+
+std::string device_enumerator::first()
+{
+  std::vector< bool > done;
+
+  for ( const std::vector< std::string > &driver : run( true, done ) )
+    if ( driver.size() )
+      return driver.front();
+
+  return "";
+}
+
+std::vector< std::vector< std::string > >
+device_enumerator::each( std::vector< bool > &done )
+{
+  return run( false, done );
+}
+
+std::vector< std::vector< std::string > >
+device_enumerator::run( bool first, std::vector< bool > &done )
+{
+  std::shared_ptr< enum_state > state = std::make_shared< enum_state >();
+  state->results.resize( _drivers.size() );
+
+  for ( size_t i = 0; i < _drivers.size(); i++ ) {
+    state->results[i].done = false;
+
+    const std::string name = _drivers[i].first;
+    const lister_t lister = _drivers[i].second;
+
+    std::thread( [state, i, name, lister]() {
+      std::vector< std::string > devices;
+
+      try {
+        devices = lister();
+      } catch ( const std::exception &e ) {
+        std::cerr << "Enumerating " << name << " devices failed: " << e.what()
+                  << std::endl;
+      }
+
+      std::lock_guard< std::mutex > lock( state->mutex );
+      state->results[i].devices = devices;
+      state->results[i].done = true;
+      state->cond.notify_all();
+    } ).detach();
+  }
+
+  const std::chrono::steady_clock::time_point deadline =
+    std::chrono::steady_clock::now() +
+    std::chrono::duration_cast< std::chrono::steady_clock::duration >(
+      std::chrono::duration< double >( _timeout ) );
+
+  std::unique_lock< std::mutex > lock( state->mutex );
+
+  /* for first(), done once a prefix of drivers has answered and the last
+   * of them offers a device, or all drivers answered */
+  auto finished = [&]() {
+    for ( const enum_state::result &r : state->results ) {
+      if ( ! r.done )
+        return false;
+      if ( first && r.devices.size() )
+        return true;
+    }
+    return true;
+  };
+
+  state->cond.wait_until( lock, deadline, finished );
+
+  std::vector< std::vector< std::string > > devices( state->results.size() );
+  done.assign( state->results.size(), false );
+
+  for ( size_t i = 0; i < state->results.size(); i++ ) {
+    const enum_state::result &r = state->results[i];
+
+    if ( ! r.done ) {
+      std::cerr << "Enumerating " << _drivers[i].first << " devices timed out after "
+                << _timeout << " s, skipped." << std::endl;
+      continue;
+    }
+
+    devices[i] = r.devices;
+    done[i] = true;
+
+    /* less preferred drivers are not waited for once a device was found */
+    if ( first && r.devices.size() )
+      break;
+  }
+
+  return devices;
+}
+
+double args_to_enum_timeout( const std::vector< std::string > &args )
+{
+  for ( const std::string &arg : args ) {
+    dict_t dict = params_to_dict( arg );
+
+    if ( dict.count( "enum_timeout" ) )
+      return boost::lexical_cast< double >( dict["enum_timeout"] );
+  }
+
+  return DEVICE_ENUM_TIMEOUT;
+}
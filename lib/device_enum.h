@@ -0,0 +1,77 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_DEVICE_ENUM_H
+#define INCLUDED_OSMOSDR_DEVICE_ENUM_H
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* seconds a driver may spend in get_devices(), see enum_timeout */
+#define DEVICE_ENUM_TIMEOUT 5.0
+
+/*!
+ * Concurrent get_devices() of the compiled-in drivers.
+ *
+ * Every driver is enumerated on its own thread, so network discovery by
+ * uhd or soapy no longer adds up with the USB scans of the others. Drivers
+ * still running at the deadline are reported and skipped; their thread is
+ * left to finish in the background. An exception thrown by a driver only
+ * skips that driver.
+ */
+class device_enumerator
+{
+public:
+  typedef std::function< std::vector< std::string >() > lister_t;
+
+  explicit device_enumerator( double timeout = DEVICE_ENUM_TIMEOUT );
+
+  /*! add a driver, in order of preference */
+  void add( const std::string &name, lister_t lister );
+
+  /*! the devices of all drivers, in the order the drivers were added */
+  std::vector< std::string > all();
+
+  /*!
+   * The first device of the most preferred driver offering one, returned
+   * as soon as all drivers preferred over it are done, or "" if none.
+   */
+  std::string first();
+
+  /*!
+   * The devices of each driver, in the order the drivers were added.
+   * done tells which drivers answered before the deadline.
+   */
+  std::vector< std::vector< std::string > > each( std::vector< bool > &done );
+
+private:
+  std::vector< std::vector< std::string > > run( bool first, std::vector< bool > &done );
+
+  double _timeout;
+  std::vector< std::pair< std::string, lister_t > > _drivers;
+};
+
+/*! the enum_timeout device argument of any of args, or the default */
+double args_to_enum_timeout( const std::vector< std::string > &args );
+
+#endif /* INCLUDED_OSMOSDR_DEVICE_ENUM_H */
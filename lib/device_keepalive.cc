@@ -0,0 +1,105 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <vector>
+
+#include "device_keepalive.h"
+
+device_keepalive &device_keepalive::get()
+{
+  /* constructed after the static caches of the drivers, so the handles
+   * are closed at exit before those go away */
+  static device_keepalive instance;
+  return instance;
+}
+
+device_keepalive::~device_keepalive()
+{
+  std::multimap< clock::time_point, std::shared_ptr< void > > held;
+
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _running = false;
+    held.swap( _held );
+  }
+
+  _cond.notify_one();
+  if ( _thread.joinable() )
+    _thread.join();
+
+  /* the deleters run here, without the lock */
+  held.clear();
+}
+
+void device_keepalive::hold( const std::shared_ptr< void > &dev, double seconds )
+{
+  if ( ! dev || seconds <= 0 )
+    return;
+
+  const clock::time_point until = clock::now() +
+    std::chrono::duration_cast< clock::duration >(
+      std::chrono::duration< double >( seconds ) );
+
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  _held.insert( std::make_pair( until, dev ) );
+
+  if ( ! _running ) {
+    _running = true;
+    _thread = std::thread( &device_keepalive::run, this );
+  }
+
+  _cond.notify_one();
+}
+
+void device_keepalive::run()
+{
+  std::unique_lock< std::mutex > lock( _mutex );
+
+  while ( _running ) {
+    if ( _held.empty() ) {
+      _cond.wait( lock );
+      continue;
+    }
+
+    const clock::time_point next = _held.begin()->first;
+    if ( clock::now() < next ) {
+      _cond.wait_until( lock, next );
+      continue;
+    }
+
+    std::vector< std::shared_ptr< void > > expired;
+    while ( _held.size() && _held.begin()->first <= clock::now() ) {
+      expired.push_back( _held.begin()->second );
+      _held.erase( _held.begin() );
+    }
+
+    /* closing takes a while and may take the locks of the driver */
+    lock.unlock();
+    expired.clear();
+    lock.lock();
+  }
+}
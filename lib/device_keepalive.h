@@ -0,0 +1,83 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_DEVICE_KEEPALIVE_H
+#define INCLUDED_OSMOSDR_DEVICE_KEEPALIVE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <boost/lexical_cast.hpp>
+
+#include <osmosdr/api.h>
+
+#include "arg_helpers.h"
+
+/*!
+ * Keeps device handles open for a while after the last block using them
+ * is gone, from the keep_open=seconds device argument.
+ *
+ * Drivers sharing their handles through a weak_ptr cache (hackrf, bladerf)
+ * hand the handle to hold() when a block goes away. A block created for
+ * the same device meanwhile, e.g. when an application rebuilds its
+ * flowgraph, finds the handle still open in that cache, with the state the
+ * device was configured to, and skips opening, FPGA checks and
+ * calibration. Once the time is up without that, the handle is released
+ * and closed by its deleter. Handles still held at exit are closed then.
+ */
+class OSMOSDR_API device_keepalive
+{
+public:
+  static device_keepalive &get();
+
+  /*! keep a reference to dev for the given seconds, nothing for 0 */
+  void hold( const std::shared_ptr< void > &dev, double seconds );
+
+private:
+  typedef std::chrono::steady_clock clock;
+
+  device_keepalive() : _running( false ) {}
+  ~device_keepalive();
+
+  void run();
+
+  std::mutex _mutex;
+  std::condition_variable _cond;
+  std::multimap< clock::time_point, std::shared_ptr< void > > _held;
+  std::thread _thread;
+  bool _running;
+};
+
+/*! seconds to keep a device open after its last block, 0 by default */
+inline double args_to_keep_open( const dict_t &dict )
+{
+  dict_t::const_iterator it = dict.find( "keep_open" );
+  if ( it == dict.end() )
+    return 0;
+
+  return boost::lexical_cast< double >( it->second );
+}
+
+#endif /* INCLUDED_OSMOSDR_DEVICE_KEEPALIVE_H */
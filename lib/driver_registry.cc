@@ -0,0 +1,351 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef ENABLE_DRIVER_MODULES
+#include <dirent.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#endif
+
+#include <boost/algorithm/string.hpp>
+
+#include "driver_registry.h"
+
+#ifndef ENABLE_DRIVER_MODULES
+#ifdef ENABLE_FCD
+OSMOSDR_DRIVER( fcd );
+#endif
+#ifdef ENABLE_FILE
+OSMOSDR_DRIVER( file );
+#endif
+#ifdef ENABLE_SIM
+OSMOSDR_DRIVER( sim );
+#endif
+#ifdef ENABLE_RTL
+OSMOSDR_DRIVER( rtl );
+#endif
+#ifdef ENABLE_RTL_TCP
+OSMOSDR_DRIVER( rtl_tcp );
+#endif
+#ifdef ENABLE_NET
+OSMOSDR_DRIVER( net );
+#endif
+#ifdef ENABLE_UHD
+OSMOSDR_DRIVER( uhd );
+#endif
+#ifdef ENABLE_SDRPLAY
+OSMOSDR_DRIVER( sdrplay );
+#endif
+#ifdef ENABLE_HACKRF
+OSMOSDR_DRIVER( hackrf );
+#endif
+#ifdef ENABLE_BLADERF
+OSMOSDR_DRIVER( bladerf );
+#endif
+#ifdef ENABLE_RFSPACE
+OSMOSDR_DRIVER( rfspace );
+#endif
+#ifdef ENABLE_AIRSPY
+OSMOSDR_DRIVER( airspy );
+#endif
+#ifdef ENABLE_AIRSPYHF
+OSMOSDR_DRIVER( airspyhf );
+#endif
+#ifdef ENABLE_SOAPY
+OSMOSDR_DRIVER( soapy );
+#endif
+#ifdef ENABLE_REDPITAYA
+OSMOSDR_DRIVER( redpitaya );
+#endif
+#ifdef ENABLE_FREESRP
+OSMOSDR_DRIVER( freesrp );
+#endif
+#endif
+
+driver_registry &driver_registry::get()
+{
+  static driver_registry instance;
+  return instance;
+}
+
+driver_registry::driver_registry()
+{
+#ifndef ENABLE_DRIVER_MODULES
+#ifdef ENABLE_FCD
+  osmosdr_driver_register_fcd( *this );
+#endif
+#ifdef ENABLE_FILE
+  osmosdr_driver_register_file( *this );
+#endif
+#ifdef ENABLE_SIM
+  osmosdr_driver_register_sim( *this );
+#endif
+#ifdef ENABLE_RTL
+  osmosdr_driver_register_rtl( *this );
+#endif
+#ifdef ENABLE_RTL_TCP
+  osmosdr_driver_register_rtl_tcp( *this );
+#endif
+#ifdef ENABLE_NET
+  osmosdr_driver_register_net( *this );
+#endif
+#ifdef ENABLE_UHD
+  osmosdr_driver_register_uhd( *this );
+#endif
+#ifdef ENABLE_SDRPLAY
+  osmosdr_driver_register_sdrplay( *this );
+#endif
+#ifdef ENABLE_HACKRF
+  osmosdr_driver_register_hackrf( *this );
+#endif
+#ifdef ENABLE_BLADERF
+  osmosdr_driver_register_bladerf( *this );
+#endif
+#ifdef ENABLE_RFSPACE
+  osmosdr_driver_register_rfspace( *this );
+#endif
+#ifdef ENABLE_AIRSPY
+  osmosdr_driver_register_airspy( *this );
+#endif
+#ifdef ENABLE_AIRSPYHF
+  osmosdr_driver_register_airspyhf( *this );
+#endif
+#ifdef ENABLE_SOAPY
+  osmosdr_driver_register_soapy( *this );
+#endif
+#ifdef ENABLE_REDPITAYA
+  osmosdr_driver_register_redpitaya( *this );
+#endif
+#ifdef ENABLE_FREESRP
+  osmosdr_driver_register_freesrp( *this );
+#endif
+#endif
+}
+
+void driver_registry::add( const driver_t &driver )
+{
+  std::lock_guard< std::recursive_mutex > lock( _mutex );
+
+  /* find() hands out pointers into _drivers, so a node is never replaced */
+  if ( ! _drivers.insert( std::make_pair( driver.name, driver ) ).second ) {
+    std::cerr << "Driver " << driver.name << " is registered already, "
+              << "ignoring the second one." << std::endl;
+    return;
+  }
+
+  for (const std::string &alias : driver.aliases)
+    _aliases[ alias ] = driver.name;
+}
+
+const driver_registry::driver_t *driver_registry::find( const std::string &dev_type )
+{
+  std::lock_guard< std::recursive_mutex > lock( _mutex );
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    std::map< std::string, std::string >::const_iterator alias = _aliases.find( dev_type );
+    const std::string &name = alias != _aliases.end() ? alias->second : dev_type;
+
+    std::map< std::string, driver_t >::const_iterator it = _drivers.find( name );
+    if ( it != _drivers.end() )
+      return &it->second;
+
+    if ( attempt || ! load( name ) )
+      break;
+  }
+
+  return NULL;
+}
+
+std::vector< const driver_registry::driver_t * > driver_registry::all()
+{
+  std::lock_guard< std::recursive_mutex > lock( _mutex );
+
+  for (const std::string &module : module_names())
+    load( module );
+
+  std::vector< const driver_t * > drivers;
+  for (const std::map< std::string, driver_t >::value_type &entry : _drivers)
+    drivers.push_back( &entry.second );
+
+  std::stable_sort( drivers.begin(), drivers.end(),
+                    []( const driver_t *a, const driver_t *b ) {
+                      return a->rank < b->rank;
+                    } );
+
+  return drivers;
+}
+
+std::vector< std::string > driver_registry::names( bool sink )
+{
+  std::lock_guard< std::recursive_mutex > lock( _mutex );
+
+  std::vector< const driver_t * > drivers;
+  for (const std::map< std::string, driver_t >::value_type &entry : _drivers)
+    if ( sink ? bool(entry.second.make_sink) : bool(entry.second.make_source) )
+      drivers.push_back( &entry.second );
+
+  std::stable_sort( drivers.begin(), drivers.end(),
+                    []( const driver_t *a, const driver_t *b ) {
+                      return a->rank < b->rank;
+                    } );
+
+  std::vector< std::string > names;
+  for (const driver_t *driver : drivers)
+    names.push_back( driver->name );
+
+  for (const std::string &module : module_names())
+    if ( ! _drivers.count( module ) && ! _tried.count( module ) )
+      names.push_back( module );
+
+  return names;
+}
+
+#ifdef ENABLE_DRIVER_MODULES
+
+/* the module file of each driver, e.g. osmosdr-rtl.so */
+#define MODULE_PREFIX "osmosdr-"
+
+/* the historical aliases of the rfspace driver, for loading its module */
+static const char *module_aliases[][2] = {
+  { "sdr-iq", "rfspace" },
+  { "sdr-ip", "rfspace" },
+  { "netsdr", "rfspace" },
+  { "cloudiq", "rfspace" },
+};
+
+std::vector< std::string > driver_registry::module_dirs()
+{
+  std::vector< std::string > dirs;
+
+  const char *path = getenv( "OSMOSDR_MODULE_PATH" );
+  if ( path && *path )
+    boost::algorithm::split( dirs, path, boost::is_any_of( ":" ),
+                             boost::token_compress_on );
+
+  dirs.push_back( OSMOSDR_MODULE_DIR );
+
+  return dirs;
+}
+
+std::vector< std::string > driver_registry::module_names()
+{
+  const std::string prefix = MODULE_PREFIX;
+  const std::string suffix = OSMOSDR_MODULE_SUFFIX;
+
+  std::set< std::string > names;
+
+  for (const std::string &dir : module_dirs()) {
+    DIR *d = opendir( dir.c_str() );
+    if ( ! d )
+      continue;
+
+    while ( struct dirent *entry = readdir( d ) ) {
+      const std::string file = entry->d_name;
+
+      if ( file.size() > prefix.size() + suffix.size() &&
+           boost::algorithm::starts_with( file, prefix ) &&
+           boost::algorithm::ends_with( file, suffix ) )
+        names.insert( file.substr( prefix.size(),
+                                   file.size() - prefix.size() - suffix.size() ) );
+    }
+
+    closedir( d );
+  }
+
+  return std::vector< std::string >( names.begin(), names.end() );
+}
+
+bool driver_registry::load( const std::string &dev_type )
+{
+  std::string module = dev_type;
+
+  for (size_t i = 0; i < sizeof(module_aliases) / sizeof(module_aliases[0]); i++)
+    if ( dev_type == module_aliases[i][0] )
+      module = module_aliases[i][1];
+
+  /* other device arguments are looked up as well, they never name files */
+  if ( module.empty() ||
+       module.find_first_not_of( "abcdefghijklmnopqrstuvwxyz0123456789_-" ) != std::string::npos )
+    return false;
+
+  if ( _tried.count( module ) )
+    return false;
+
+  _tried.insert( module );
+
+  for (const std::string &dir : module_dirs()) {
+    const std::string path = dir + "/" MODULE_PREFIX + module + OSMOSDR_MODULE_SUFFIX;
+
+    struct stat st;
+    if ( stat( path.c_str(), &st ) != 0 )
+      continue;
+
+    /* modules stay loaded, the blocks they made may outlive any user */
+    void *handle = dlopen( path.c_str(), RTLD_NOW | RTLD_LOCAL );
+    if ( ! handle ) {
+      std::cerr << "Loading driver module " << path << " failed: "
+                << dlerror() << std::endl;
+      continue;
+    }
+
+    typedef void (*register_t)( driver_registry & );
+    register_t entry = (register_t) dlsym( handle, "osmosdr_driver_register" );
+    if ( ! entry ) {
+      std::cerr << "Driver module " << path << " has no registration function."
+                << std::endl;
+      dlclose( handle );
+      continue;
+    }
+
+    entry( *this );
+    return true;
+  }
+
+  return false;
+}
+
+#else
+
+std::vector< std::string > driver_registry::module_dirs()
+{
+  return std::vector< std::string >();
+}
+
+std::vector< std::string > driver_registry::module_names()
+{
+  return std::vector< std::string >();
+}
+
+bool driver_registry::load( const std::string &module )
+{
+  return false;
+}
+
+#endif
@@ -0,0 +1,150 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_DRIVER_REGISTRY_H
+#define INCLUDED_OSMOSDR_DRIVER_REGISTRY_H
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <osmosdr/api.h>
+#include <gnuradio/basic_block.h>
+
+#include "device_cache.h"
+#include "source_iface.h"
+#include "sink_iface.h"
+
+class driver_registry;
+
+/*
+ * Defines the registration function of a driver, which adds its
+ * driver_registry::driver_t. Built into gnuradio-osmosdr, it is called
+ * when the registry is set up; built as a module (ENABLE_DRIVER_MODULES),
+ * it is the entry point looked up after loading the module.
+ */
+#ifdef OSMOSDR_DRIVER_MODULE
+#define OSMOSDR_DRIVER( name ) \
+  extern "C" __GR_ATTR_EXPORT void osmosdr_driver_register( driver_registry &registry )
+#else
+#define OSMOSDR_DRIVER( name ) \
+  void osmosdr_driver_register_##name( driver_registry &registry )
+#endif
+
+/*!
+ * The drivers available to osmosdr::source, osmosdr::sink and
+ * osmosdr::device::find(), replacing the per driver #ifdef chains.
+ *
+ * With ENABLE_DRIVER_MODULES every lib/<driver> is a separate module in
+ * OSMOSDR_MODULE_DIR (or any directory of $OSMOSDR_MODULE_PATH), and a
+ * module is only loaded once its dev_type is asked for, so processes do
+ * not pay for the libraries, static initializers and memory of drivers
+ * they do not use. Enumerating all devices loads all modules.
+ */
+class OSMOSDR_API driver_registry
+{
+public:
+  struct source_block_t
+  {
+    gr::basic_block_sptr block;
+    source_iface *iface;
+  };
+
+  struct sink_block_t
+  {
+    gr::basic_block_sptr block;
+    sink_iface *iface;
+  };
+
+  typedef std::function< std::vector< std::string >( bool fake ) > lister_t;
+  typedef std::function< source_block_t( const std::string &args ) > source_maker_t;
+  typedef std::function< sink_block_t( const std::string &args ) > sink_maker_t;
+
+  struct driver_t
+  {
+    driver_t( const std::string &name, int rank, device_cache::kind_t kind ) :
+      name( name ), rank( rank ), kind( kind ) {}
+
+    std::string name;                   /**< the dev_type key */
+    std::vector< std::string > aliases; /**< further dev_type keys */
+    int rank;                           /**< preference, lowest first */
+    device_cache::kind_t kind;          /**< how its devices are cached */
+
+    lister_t source_devices;            /**< unset without source */
+    source_maker_t make_source;
+    lister_t sink_devices;              /**< unset without sink */
+    sink_maker_t make_sink;
+  };
+
+  static driver_registry &get();
+
+  /*!
+   * Called by the registration functions. A second driver of the same
+   * name is ignored, the first one stays registered.
+   */
+  void add( const driver_t &driver );
+
+  /*!
+   * The driver for a dev_type key or one of its aliases, loading its
+   * module if need be, or NULL.
+   */
+  const driver_t *find( const std::string &dev_type );
+
+  /*! all drivers by rank, loading every module */
+  std::vector< const driver_t * > all();
+
+  /*!
+   * The dev_types of the drivers with a sink, or with a source, followed
+   * by the modules not loaded yet, without loading them.
+   */
+  std::vector< std::string > names( bool sink );
+
+  template< typename sptr >
+  static source_block_t source( const sptr &src )
+  {
+    source_block_t block = { src, src.get() };
+    return block;
+  }
+
+  template< typename sptr >
+  static sink_block_t sink( const sptr &snk )
+  {
+    sink_block_t block = { snk, snk.get() };
+    return block;
+  }
+
+private:
+  driver_registry();
+
+  std::vector< std::string > module_dirs();
+  std::vector< std::string > module_names();
+  bool load( const std::string &module );
+
+  std::recursive_mutex _mutex;  /**< modules register while loading */
+  std::map< std::string, driver_t > _drivers;
+  std::map< std::string, std::string > _aliases;
+  std::set< std::string > _tried;
+};
+
+#endif /* INCLUDED_OSMOSDR_DRIVER_REGISTRY_H */
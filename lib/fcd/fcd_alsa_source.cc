@@ -0,0 +1,194 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+#include <stdexcept>
+
+#include <gnuradio/io_signature.h>
+
+#include "fcd_alsa_source.h"
+#include "sample_convert.h"
+
+/* how long work() waits for a period before returning empty handed */
+#define WAIT_MS  100
+
+fcd_alsa_source_sptr make_fcd_alsa_source( const std::string &device,
+                                           unsigned int rate,
+                                           unsigned int period,
+                                           unsigned int periods )
+{
+  return gnuradio::get_initial_sptr( new fcd_alsa_source( device, rate, period, periods ) );
+}
+
+static void check( int err, const std::string &what, const std::string &device )
+{
+  if ( err < 0 )
+    throw std::runtime_error( "Failed to " + what + " of " + device + ": " +
+                              snd_strerror( err ) );
+}
+
+fcd_alsa_source::fcd_alsa_source( const std::string &device, unsigned int rate,
+                                  unsigned int period, unsigned int periods ) :
+  gr::sync_block( "fcd_alsa_source",
+                  gr::io_signature::make( 0, 0, 0 ),
+                  gr::io_signature::make( 1, 1, sizeof(gr_complex) ) ),
+  _device( device ),
+  _pcm( NULL ),
+  _period( period )
+{
+  check( snd_pcm_open( &_pcm, device.c_str(), SND_PCM_STREAM_CAPTURE, 0 ),
+         "open", device );
+
+  snd_pcm_hw_params_t *hw;
+  snd_pcm_hw_params_alloca( &hw );
+
+  unsigned int actual = rate;
+  snd_pcm_uframes_t buffer = snd_pcm_uframes_t( period ) * std::max( periods, 2u );
+
+  try {
+    check( snd_pcm_hw_params_any( _pcm, hw ), "query", device );
+    check( snd_pcm_hw_params_set_access( _pcm, hw, SND_PCM_ACCESS_MMAP_INTERLEAVED ),
+           "select mmap access", device );
+    check( snd_pcm_hw_params_set_format( _pcm, hw, SND_PCM_FORMAT_S16_LE ),
+           "select S16_LE", device );
+    check( snd_pcm_hw_params_set_channels( _pcm, hw, 2 ), "select I/Q channels", device );
+    check( snd_pcm_hw_params_set_rate_near( _pcm, hw, &actual, NULL ),
+           "set the rate", device );
+    check( snd_pcm_hw_params_set_period_size_near( _pcm, hw, &_period, NULL ),
+           "set the period", device );
+    check( snd_pcm_hw_params_set_buffer_size_near( _pcm, hw, &buffer ),
+           "set the buffer", device );
+    check( snd_pcm_hw_params( _pcm, hw ), "configure", device );
+  } catch ( ... ) {
+    snd_pcm_close( _pcm );
+    throw;
+  }
+
+  if ( actual != rate )
+    std::cerr << device << " runs at " << actual << " instead of " << rate
+              << " S/s." << std::endl;
+
+  std::cerr << "Using ALSA mmap with " << buffer / _period << " periods of "
+            << _period << " frames." << std::endl;
+}
+
+fcd_alsa_source::~fcd_alsa_source()
+{
+  snd_pcm_close( _pcm );
+}
+
+bool fcd_alsa_source::start()
+{
+  snd_pcm_drop( _pcm );
+
+  if ( snd_pcm_prepare( _pcm ) < 0 || snd_pcm_start( _pcm ) < 0 ) {
+    std::cerr << "Failed to start capturing from " << _device << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool fcd_alsa_source::stop()
+{
+  snd_pcm_drop( _pcm );
+
+  return true;
+}
+
+/* restart after an overrun or a suspend, false if the device is gone */
+bool fcd_alsa_source::recover( int err )
+{
+  if ( -EPIPE == err ) {
+    /* work() fell behind the whole ALSA ring */
+    _stats.overflow();
+  } else if ( -ESTRPIPE == err ) {
+    while ( ( err = snd_pcm_resume( _pcm ) ) == -EAGAIN )
+      snd_pcm_wait( _pcm, WAIT_MS );
+    if ( 0 == err )
+      return true;
+  } else {
+    std::cerr << "Capturing from " << _device << " failed: "
+              << snd_strerror( err ) << std::endl;
+    return false;
+  }
+
+  return snd_pcm_prepare( _pcm ) >= 0 && snd_pcm_start( _pcm ) >= 0;
+}
+
+int fcd_alsa_source::work( int noutput_items,
+                           gr_vector_const_void_star &input_items,
+                           gr_vector_void_star &output_items )
+{
+  gr_complex *out = (gr_complex *)output_items[0];
+
+  snd_pcm_sframes_t avail = snd_pcm_avail_update( _pcm );
+
+  if ( 0 == avail ) {
+    int err = snd_pcm_wait( _pcm, WAIT_MS );
+    if ( err < 0 )
+      return recover( err ) ? 0 : WORK_DONE;
+
+    avail = snd_pcm_avail_update( _pcm );
+  }
+
+  if ( avail < 0 )
+    return recover( avail ) ? 0 : WORK_DONE;
+
+  const snd_pcm_uframes_t frames = std::min< snd_pcm_uframes_t >( avail, noutput_items );
+  snd_pcm_uframes_t done = 0;
+
+  /* at most two spans, before and after the end of the ring */
+  while ( done < frames ) {
+    const snd_pcm_channel_area_t *areas;
+    snd_pcm_uframes_t offset;
+    snd_pcm_uframes_t n = frames - done;
+
+    int err = snd_pcm_mmap_begin( _pcm, &areas, &offset, &n );
+    if ( err < 0 )
+      return recover( err ) ? int(done) : WORK_DONE;
+    if ( ! n )
+      break;
+
+    /* left is I, right is Q, interleaved */
+    const int16_t *iq = (const int16_t *)( (const char *)areas[0].addr +
+                                           ( areas[0].first + offset * areas[0].step ) / 8 );
+    gr_complex *dst = out + done;
+    convert_cs16_fc32_deinterleave( iq, &dst, 1, n, 32768.0f );
+
+    snd_pcm_sframes_t committed = snd_pcm_mmap_commit( _pcm, offset, n );
+    if ( committed < 0 || snd_pcm_uframes_t( committed ) != n )
+      return recover( committed < 0 ? committed : -EPIPE ) ? int(done) : WORK_DONE;
+
+    done += n;
+  }
+
+  _stats.delivered( done );
+
+  return done;
+}
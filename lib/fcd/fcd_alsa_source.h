@@ -0,0 +1,85 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_FCD_ALSA_SOURCE_H
+#define INCLUDED_FCD_ALSA_SOURCE_H
+
+#include <string>
+
+#include <alsa/asoundlib.h>
+
+#include <gnuradio/sync_block.h>
+
+#include "stream_counters.h"
+
+class fcd_alsa_source;
+
+typedef boost::shared_ptr< fcd_alsa_source > fcd_alsa_source_sptr;
+
+/*!
+ * Reads the USB audio interface of a FUNcube Dongle straight from the
+ * mmap'ed ALSA ring, converting the interleaved s16 I/Q into the output
+ * without the float channels and period buffers of gr-audio.
+ *
+ * \param device the ALSA hw device, e.g. hw:2
+ * \param rate 96000 for a V1.0, 192000 for a V2.0 dongle
+ * \param period frames per ALSA period, the latency work() sees
+ * \param periods periods in the ALSA ring, how long work() may stall
+ */
+fcd_alsa_source_sptr make_fcd_alsa_source( const std::string &device,
+                                           unsigned int rate,
+                                           unsigned int period,
+                                           unsigned int periods );
+
+class fcd_alsa_source : public gr::sync_block
+{
+private:
+  friend fcd_alsa_source_sptr make_fcd_alsa_source( const std::string &device,
+                                                     unsigned int rate,
+                                                     unsigned int period,
+                                                     unsigned int periods );
+
+  fcd_alsa_source( const std::string &device, unsigned int rate,
+                   unsigned int period, unsigned int periods );
+
+public:
+  ~fcd_alsa_source();
+
+  bool start();
+  bool stop();
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+  stream_counters &stats() { return _stats; }
+
+private:
+  bool recover( int err );
+
+  std::string _device;
+  snd_pcm_t *_pcm;
+  snd_pcm_uframes_t _period;
+
+  stream_counters _stats;
+};
+
+#endif /* INCLUDED_FCD_ALSA_SOURCE_H */
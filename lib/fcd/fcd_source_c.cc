@@ -32,6 +32,10 @@
 
 using namespace boost::assign;
 
+/* ALSA frames per period and periods in the ring with mmap=1 */
+#define DEFAULT_PERIOD   1024
+#define DEFAULT_PERIODS  16
+
 fcd_source_c_sptr make_fcd_source_c(const std::string &args)
 {
   return gnuradio::get_initial_sptr(new fcd_source_c(args));
@@ -141,10 +145,40 @@ fcd_source_c::fcd_source_c(const std::string &args) :
 
   std::cerr << "Using " << name() << " (" << dev_name << ")" << std::endl;
 
+  /*
+   * With mmap=1 the samples are read from the ALSA device here, the
+   * gr-fcdproplus block only controls the dongle over HID. It is given the
+   * null PCM instead, so the audio interface stays free, and isn't part of
+   * the flowgraph.
+   */
+  std::string audio_dev = dev_name;
+
+  if ( dict.count("mmap") && dict["mmap"] == "1" )
+  {
+#ifdef HAVE_ALSA
+    unsigned int period = DEFAULT_PERIOD, periods = DEFAULT_PERIODS;
+
+    if ( dict.count("period") )
+      period = boost::lexical_cast< unsigned int >( dict["period"] );
+
+    if ( dict.count("periods") )
+      periods = boost::lexical_cast< unsigned int >( dict["periods"] );
+
+    _alsa = make_fcd_alsa_source( dev_name, get_sample_rate(), period, periods );
+    _alsa->stats().set_quiet( args_to_quiet( args ) );
+    connect( _alsa, 0, self(), 0 );
+
+    audio_dev = "null";
+#else
+    throw std::runtime_error("mmap=1 requires gr-osmosdr built with ALSA.");
+#endif
+  }
+
   if ( FUNCUBE_V1 == _type )
   {
-    _src_v1 = gr::fcdproplus::fcd::make( dev_name );
-    connect( _src_v1, 0, self(), 0 );
+    _src_v1 = gr::fcdproplus::fcd::make( audio_dev );
+    if ( audio_dev == dev_name )
+      connect( _src_v1, 0, self(), 0 );
 
     set_gain( 20, "LNA" );
     set_gain( 12, "MIX" );
@@ -152,8 +186,9 @@ fcd_source_c::fcd_source_c(const std::string &args) :
 
   if ( FUNCUBE_V2 == _type )
   {
-    _src_v2 = gr::fcdproplus::fcdproplus::make( dev_name );
-    connect( _src_v2, 0, self(), 0 );
+    _src_v2 = gr::fcdproplus::fcdproplus::make( audio_dev );
+    if ( audio_dev == dev_name )
+      connect( _src_v2, 0, self(), 0 );
 
     set_gain( 1, "LNA" );
     set_gain( 1, "MIX" );
@@ -398,6 +433,16 @@ double fcd_source_c::get_gain( const std::string & name, size_t chan )
   return 0;
 }
 
+osmosdr::stream_stats_t fcd_source_c::get_stream_stats( size_t chan )
+{
+#ifdef HAVE_ALSA
+  if ( _alsa )
+    return _alsa->stats().get();
+#endif
+
+  return osmosdr::stream_stats_t();
+}
+
 std::vector< std::string > fcd_source_c::get_antennas( size_t chan )
 {
   std::vector< std::string > antennas;
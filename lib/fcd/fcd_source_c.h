@@ -27,6 +27,10 @@
 
 #include "source_iface.h"
 
+#ifdef HAVE_ALSA
+#include "fcd_alsa_source.h"
+#endif
+
 class fcd_source_c;
 
 typedef boost::shared_ptr< fcd_source_c > fcd_source_c_sptr;
@@ -75,6 +79,8 @@ public:
   double get_gain( size_t chan = 0 );
   double get_gain( const std::string & name, size_t chan = 0 );
 
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
   std::vector< std::string > get_antennas( size_t chan = 0 );
   std::string set_antenna( const std::string & antenna, size_t chan = 0 );
   std::string get_antenna( size_t chan = 0 );
@@ -83,6 +89,9 @@ private:
   dongle_type _type;
   gr::fcdproplus::fcd::sptr _src_v1;
   gr::fcdproplus::fcdproplus::sptr _src_v2;
+#ifdef HAVE_ALSA
+  fcd_alsa_source_sptr _alsa;
+#endif
   double _lna_gain, _mix_gain, _bb_gain, _freq;
   int _correct;
 };
@@ -0,0 +1,51 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+
+#include "file_convert_c.h"
+
+file_convert_c_sptr make_file_convert_c( const file_format &format )
+{
+  return gnuradio::get_initial_sptr( new file_convert_c( format ) );
+}
+
+file_convert_c::file_convert_c( const file_format &format ) :
+  gr::sync_block( "file_convert_c",
+                  gr::io_signature::make( 1, 1, format.item_size() ),
+                  gr::io_signature::make( 1, 1, sizeof(gr_complex) ) ),
+  _format( format )
+{
+}
+
+int file_convert_c::work( int noutput_items,
+                          gr_vector_const_void_star &input_items,
+                          gr_vector_void_star &output_items )
+{
+  _format.convert( input_items[0], (gr_complex *)output_items[0], noutput_items );
+
+  return noutput_items;
+}
@@ -0,0 +1,54 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FILE_CONVERT_C_H
+#define FILE_CONVERT_C_H
+
+#include <gnuradio/sync_block.h>
+
+#include "file_format.h"
+
+class file_convert_c;
+
+typedef boost::shared_ptr< file_convert_c > file_convert_c_sptr;
+
+file_convert_c_sptr make_file_convert_c( const file_format &format );
+
+/*!
+ * \brief Convert a stream of samples in a file_format to complex float.
+ */
+class file_convert_c : public gr::sync_block
+{
+private:
+  friend file_convert_c_sptr make_file_convert_c( const file_format &format );
+
+  file_convert_c( const file_format &format );
+
+public:
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  file_format _format;
+};
+
+#endif // FILE_CONVERT_C_H
@@ -0,0 +1,89 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FILE_ENCODER_H
+#define FILE_ENCODER_H
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <gnuradio/gr_complex.h>
+#include <volk/volk.h>
+
+#include "sample_convert.h"
+
+/*!
+ * Sample format written by file_sink_c, the counterpart of file_format:
+ *
+ *  fc32 - complex float, gnuradio .cfile
+ *  cs16 - signed 16 bit, full scale given by scale (default 32767)
+ *  cs8  - signed 8 bit, full scale given by scale (default 127)
+ */
+class file_encoder
+{
+public:
+  explicit file_encoder( const std::string &name = "fc32", float scale = 0 ) :
+    _name( name )
+  {
+    if ( "sc16" == _name )
+      _name = "cs16";
+    else if ( "sc8" == _name )
+      _name = "cs8";
+
+    if ( "fc32" == _name )
+      _item_size = sizeof(gr_complex);
+    else if ( "cs16" == _name )
+      _item_size = 2 * sizeof(int16_t);
+    else if ( "cs8" == _name )
+      _item_size = 2 * sizeof(int8_t);
+    else
+      throw std::runtime_error( "Unsupported file format '" + name +
+                                "', must be one of fc32, cs16, cs8" );
+
+    _scale = scale > 0 ? scale : ( "cs8" == _name ? 127.0f : 32767.0f );
+  }
+
+  const std::string &name() const { return _name; }
+
+  /*! bytes per complex sample in the file */
+  size_t item_size() const { return _item_size; }
+
+  /*! convert nitems complex float samples to this format */
+  void convert( const gr_complex *in, void *out, size_t nitems ) const
+  {
+    if ( "cs16" == _name )
+      volk_32f_s32f_convert_16i( (int16_t *)out, (const float *)in, _scale, nitems * 2 );
+    else if ( "cs8" == _name && 127.0f == _scale )
+      convert_fc32_cs8( in, (int8_t *)out, nitems );
+    else if ( "cs8" == _name )
+      volk_32f_s32f_convert_8i( (int8_t *)out, (const float *)in, _scale, nitems * 2 );
+    else
+      memcpy( out, in, nitems * sizeof(gr_complex) );
+  }
+
+private:
+  std::string _name;
+  float _scale;
+  size_t _item_size;
+};
+
+#endif // FILE_ENCODER_H
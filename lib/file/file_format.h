@@ -0,0 +1,132 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FILE_FORMAT_H
+#define FILE_FORMAT_H
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <gnuradio/gr_complex.h>
+
+#include "sample_convert.h"
+
+/*!
+ * Sample format of a recording replayed by file_source_c, see the format
+ * device argument. The integer formats are converted to complex float with
+ * the kernels shared with the hardware drivers:
+ *
+ *  fc32 - complex float, gnuradio .cfile
+ *  cu8  - unsigned 8 bit, rtl_sdr
+ *  cs8  - signed 8 bit, hackrf_transfer
+ *  cs16 - signed 16 bit, full scale given by scale (default 32768,
+ *         use 2048 for bladeRF SC16 Q11 recordings)
+ *  cs12 - packed signed 12 bit, bladeRF SC16 Q11 packed
+ */
+class file_format
+{
+public:
+  explicit file_format( const std::string &name = "fc32", float scale = 0 ) :
+    _name( name ),
+    _scale( scale > 0 ? scale : 32768.0f )
+  {
+    if ( "sc16" == _name )
+      _name = "cs16";
+    else if ( "sc8" == _name )
+      _name = "cs8";
+
+    if ( "fc32" == _name )
+      _item_size = sizeof(gr_complex);
+    else if ( "cs16" == _name )
+      _item_size = 2 * sizeof(int16_t);
+    else if ( "cs12" == _name )
+      _item_size = 3;
+    else if ( "cs8" == _name || "cu8" == _name )
+      _item_size = 2;
+    else
+      throw std::runtime_error( "Unsupported file format '" + name +
+                                "', must be one of fc32, cu8, cs8, cs16, cs12" );
+  }
+
+  const std::string &name() const { return _name; }
+
+  /*! bytes per complex sample in the file */
+  size_t item_size() const { return _item_size; }
+
+  /*! convert nitems samples of this format to complex float */
+  void convert( const void *in, gr_complex *out, size_t nitems ) const
+  {
+    if ( "cu8" == _name )
+      convert_cu8_fc32( (const uint8_t *)in, out, nitems );
+    else if ( "cs8" == _name )
+      convert_cs8_fc32( (const int8_t *)in, out, nitems );
+    else if ( "cs16" == _name )
+      convert_cs16_fc32_deinterleave( (const int16_t *)in, &out, 1, nitems, _scale );
+    else if ( "cs12" == _name )
+      convert_cs12_fc32( (const uint8_t *)in, out, nitems );
+    else
+      memcpy( out, in, nitems * sizeof(gr_complex) );
+  }
+
+  /*!
+   * Split nitems samples of nchan channels interleaved sample by sample
+   * into one buffer per channel, converting them to complex float if
+   * convert is set. cs12 only holds a single channel.
+   */
+  void deinterleave( const void *in, void * const *out, size_t nchan,
+                     size_t nitems, bool convert ) const
+  {
+    if ( 1 == nchan ) {
+      if ( convert )
+        this->convert( in, (gr_complex *)out[0], nitems );
+      else
+        memcpy( out[0], in, nitems * _item_size );
+      return;
+    }
+
+    gr_complex * const *fc = (gr_complex * const *)out;
+
+    if ( convert && "cu8" == _name )
+      convert_cu8_fc32_deinterleave( (const uint8_t *)in, fc, nchan, nitems );
+    else if ( convert && "cs8" == _name )
+      convert_cs8_fc32_deinterleave( (const int8_t *)in, fc, nchan, nitems );
+    else if ( convert && "cs16" == _name )
+      convert_cs16_fc32_deinterleave( (const int16_t *)in, fc, nchan, nitems, _scale );
+    else if ( "cs12" == _name )
+      throw std::runtime_error( "cs12 recordings hold a single channel." );
+    else {
+      /* samples already in the output format, fc32 or passed through */
+      const unsigned char *p = (const unsigned char *)in;
+
+      for (size_t i = 0; i < nitems; i++)
+        for (size_t c = 0; c < nchan; c++, p += _item_size)
+          memcpy( (unsigned char *)out[c] + i * _item_size, p, _item_size );
+    }
+  }
+
+private:
+  std::string _name;
+  float _scale;
+  size_t _item_size;
+};
+
+#endif // FILE_FORMAT_H
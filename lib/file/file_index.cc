@@ -0,0 +1,204 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "file_index.h"
+
+#ifdef _WIN32
+#define timegm _mkgmtime
+#endif
+
+#define SIGMF_DATA_EXT ".sigmf-data"
+#define SIGMF_META_EXT ".sigmf-meta"
+
+/* ISO 8601 in UTC as used by core:datetime, 2026-10-14T05:43:00.123456Z */
+static bool parse_datetime( const std::string &str, osmosdr::time_spec_t &time )
+{
+  struct tm tm;
+  int n = 0;
+
+  memset( &tm, 0, sizeof(tm) );
+
+  if ( sscanf( str.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d%n",
+               &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+               &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &n ) != 6 )
+    return false;
+
+  tm.tm_year -= 1900;
+  tm.tm_mon -= 1;
+
+  double frac = 0;
+  if ( size_t(n) < str.size() && '.' == str[n] )
+    frac = atof( str.c_str() + n );
+
+  time = osmosdr::time_spec_t( timegm( &tm ), frac );
+
+  return true;
+}
+
+static std::string sigmf_format( const std::string &datatype )
+{
+  if ( "cf32_le" == datatype || "cf32" == datatype )
+    return "fc32";
+  if ( "ci16_le" == datatype || "ci16" == datatype )
+    return "cs16";
+  if ( "ci8" == datatype )
+    return "cs8";
+  if ( "cu8" == datatype )
+    return "cu8";
+
+  throw std::runtime_error( "Unsupported SigMF datatype '" + datatype +
+                            "', must be one of cf32_le, ci16_le, ci8, cu8" );
+}
+
+file_index::file_index() :
+  _format( "fc32" ),
+  _rate( 0 ),
+  _has_time( false )
+{
+}
+
+file_index::file_index( const std::string &path ) :
+  _format( "fc32" ),
+  _rate( 0 ),
+  _has_time( false )
+{
+  namespace pt = boost::property_tree;
+
+  pt::ptree meta;
+
+  try {
+    pt::read_json( path, meta );
+
+    _format = sigmf_format( meta.get< std::string >( "global.core:datatype" ) );
+    _rate = meta.get< double >( "global.core:sample_rate", 0 );
+
+    _has_time = true;
+
+    for ( const pt::ptree::value_type &entry : meta.get_child( "captures", pt::ptree() ) ) {
+      capture c;
+
+      c.sample = entry.second.get< uint64_t >( "core:sample_start", 0 );
+      c.freq = entry.second.get< double >( "core:frequency", 0 );
+      c.has_time = parse_datetime( entry.second.get< std::string >( "core:datetime", "" ),
+                                   c.time );
+      _has_time = _has_time && c.has_time;
+
+      _captures.push_back( c );
+    }
+  } catch ( const pt::ptree_error &e ) {
+    throw std::runtime_error( "Failed to read the index '" + path + "': " + e.what() );
+  }
+
+  /* a recording without captures is one segment starting at sample 0 */
+  if ( _captures.empty() ) {
+    capture c = { 0, 0, false, osmosdr::time_spec_t() };
+    _captures.push_back( c );
+    _has_time = false;
+  }
+
+  std::sort( _captures.begin(), _captures.end(),
+             []( const capture &a, const capture &b ) { return a.sample < b.sample; } );
+}
+
+size_t file_index::capture_at( uint64_t sample ) const
+{
+  if ( _captures.empty() )
+    return 0;
+
+  std::vector< capture >::const_iterator it =
+    std::upper_bound( _captures.begin(), _captures.end(), sample,
+                      []( uint64_t s, const capture &c ) { return s < c.sample; } );
+
+  return it == _captures.begin() ? 0 : size_t( it - _captures.begin() ) - 1;
+}
+
+uint64_t file_index::next_start( size_t i ) const
+{
+  return i + 1 < _captures.size() ? _captures[i + 1].sample : ~uint64_t(0);
+}
+
+osmosdr::time_spec_t file_index::time_at( uint64_t sample ) const
+{
+  if ( ! _has_time || _rate <= 0 )
+    return osmosdr::time_spec_t( _rate > 0 ? sample / _rate : 0 );
+
+  const capture &c = _captures[ capture_at( sample ) ];
+
+  osmosdr::time_spec_t time = c.time;
+  time += osmosdr::time_spec_t( ( double(sample) - double(c.sample) ) / _rate );
+
+  return time;
+}
+
+uint64_t file_index::sample_at( const osmosdr::time_spec_t &time ) const
+{
+  if ( _rate <= 0 )
+    return 0;
+
+  if ( ! _has_time )
+    return uint64_t( std::max( time.get_real_secs(), 0.0 ) * _rate + 0.5 );
+
+  /* the last capture starting at or before time */
+  std::vector< capture >::const_iterator it =
+    std::upper_bound( _captures.begin(), _captures.end(), time,
+                      []( const osmosdr::time_spec_t &t, const capture &c ) { return t < c.time; } );
+
+  if ( it == _captures.begin() )
+    return _captures.front().sample;
+
+  const size_t i = size_t( it - _captures.begin() ) - 1;
+  const capture &c = _captures[i];
+
+  osmosdr::time_spec_t offset = time;
+  offset -= c.time;
+
+  /* times in a gap between captures resume with the next one */
+  const uint64_t sample = c.sample + uint64_t( offset.get_real_secs() * _rate + 0.5 );
+
+  return std::min( sample, next_start( i ) );
+}
+
+std::string file_index::meta_path( const std::string &data_path )
+{
+  const std::string ext = SIGMF_DATA_EXT;
+
+  if ( data_path.size() > ext.size() &&
+       0 == data_path.compare( data_path.size() - ext.size(), ext.size(), ext ) )
+    return data_path.substr( 0, data_path.size() - ext.size() ) + SIGMF_META_EXT;
+
+  return "";
+}
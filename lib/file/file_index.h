@@ -0,0 +1,89 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FILE_INDEX_H
+#define FILE_INDEX_H
+
+#include <string>
+#include <vector>
+
+#include <osmosdr/time_spec.h>
+
+/*!
+ * Sidecar index of a recording, read from SigMF metadata (.sigmf-meta).
+ *
+ * The global object supplies the sample format and rate, the captures
+ * array the segments of the recording: each starts at a sample with its
+ * own center frequency and, if core:datetime is present, the absolute time
+ * of that sample. A time maps to a sample by a binary search over the
+ * captures, which is a single lookup for the common one capture file.
+ */
+class file_index
+{
+public:
+  struct capture
+  {
+    uint64_t sample;            /**< core:sample_start */
+    double freq;                /**< core:frequency or 0 */
+    bool has_time;
+    osmosdr::time_spec_t time;  /**< core:datetime of the first sample */
+  };
+
+  file_index();
+
+  /*! parse the metadata at path, throws std::runtime_error on failure */
+  explicit file_index( const std::string &path );
+
+  bool empty() const { return _captures.empty(); }
+
+  /*! file_format name matching core:datatype */
+  const std::string &format() const { return _format; }
+
+  double sample_rate() const { return _rate; }
+
+  /*! true if every capture carries a timestamp */
+  bool has_time() const { return _has_time; }
+
+  const std::vector< capture > &captures() const { return _captures; }
+
+  /*! index of the capture holding sample */
+  size_t capture_at( uint64_t sample ) const;
+
+  /*! first sample of the capture following capture index i, or ~0 */
+  uint64_t next_start( size_t i ) const;
+
+  /*! time of sample, relative to the start of the file without timestamps */
+  osmosdr::time_spec_t time_at( uint64_t sample ) const;
+
+  /*! sample recorded at time, see time_at() */
+  uint64_t sample_at( const osmosdr::time_spec_t &time ) const;
+
+  /*! the metadata file belonging to a SigMF data file, or "" */
+  static std::string meta_path( const std::string &data_path );
+
+private:
+  std::string _format;
+  double _rate;
+  bool _has_time;
+  std::vector< capture > _captures;
+};
+
+#endif // FILE_INDEX_H
@@ -0,0 +1,326 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <gnuradio/io_signature.h>
+
+#include "file_mmap_source.h"
+
+/* 1 GiB windows where the address space allows, 64 MiB otherwise */
+#define WINDOW_SIZE_64 (uint64_t(1) << 30)
+#define WINDOW_SIZE_32 (uint64_t(1) << 26)
+
+file_mmap_source_sptr make_file_mmap_source( const file_format &format,
+                                             const std::vector< std::string > &filenames,
+                                             size_t nchan, bool repeat, bool convert )
+{
+  return gnuradio::get_initial_sptr(
+           new file_mmap_source( format, filenames, nchan, repeat, convert ) );
+}
+
+file_mmap_source::file_mmap_source( const file_format &format,
+                                    const std::vector< std::string > &filenames,
+                                    size_t nchan, bool repeat, bool convert ) :
+  gr::sync_block( "file_mmap_source",
+                  gr::io_signature::make( 0, 0, 0 ),
+                  gr::io_signature::make( nchan, nchan,
+                                          convert ? sizeof(gr_complex)
+                                                  : format.item_size() ) ),
+  _format( format ),
+  _file_chans( filenames.size() ? nchan / filenames.size() : 0 ),
+  _item_size( format.item_size() * _file_chans ),
+  _out_size( convert ? sizeof(gr_complex) : format.item_size() ),
+  _convert( convert ),
+  _repeat( repeat ),
+  _size( 0 ),
+  _pos( 0 ),
+  _page_size( 4096 ),
+  _window_size( 0 ),
+  _windows( filenames.size(), (unsigned char *)NULL ),
+  _window_offset( 0 ),
+  _window_len( 0 ),
+  _out( _file_chans ),
+  _retag( true )
+{
+  if ( ! _file_chans || nchan % filenames.size() )
+    throw std::runtime_error( "The number of channels must be a multiple of "
+                              "the number of files." );
+
+  if ( _file_chans > 1 && "cs12" == format.name() )
+    throw std::runtime_error( "cs12 recordings hold a single channel." );
+
+#ifdef _WIN32
+  throw std::runtime_error( "mmap=1 is not supported on this platform." );
+#else
+  for (const std::string &filename : filenames) {
+    int fd = open( filename.c_str(), O_RDONLY );
+    if ( fd < 0 ) {
+      const std::string err = strerror( errno );
+      close_files();
+      throw std::runtime_error( "Failed to open '" + filename + "': " + err );
+    }
+    _fds.push_back( fd );
+
+    struct stat st;
+    if ( fstat( fd, &st ) < 0 || st.st_size <= 0 ) {
+      close_files();
+      throw std::runtime_error( "Failed to map '" + filename +
+                                "': empty or not a regular file" );
+    }
+
+    /* a trailing partial item is never delivered */
+    const uint64_t size = uint64_t(st.st_size) - uint64_t(st.st_size) % _item_size;
+    if ( ! size ) {
+      close_files();
+      throw std::runtime_error( "File '" + filename + "' holds less than one item." );
+    }
+
+    if ( ! _size || size < _size ) {
+      if ( _size )
+        std::cerr << "File '" << filename << "' is shorter than the others, "
+                  << "replaying " << size / _item_size << " samples."
+                  << std::endl;
+      _size = size;
+    }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise( fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+  }
+
+  long page = sysconf( _SC_PAGESIZE );
+  if ( page > 0 )
+    _page_size = page;
+
+  /* the files share the address space on 32 bit hosts */
+  _window_size = sizeof(void *) >= 8 ? WINDOW_SIZE_64
+                                     : WINDOW_SIZE_32 / filenames.size();
+  _window_size = std::max( _window_size - _window_size % _page_size, _page_size );
+#endif
+}
+
+file_mmap_source::~file_mmap_source()
+{
+  unmap_window();
+  close_files();
+}
+
+void file_mmap_source::close_files()
+{
+#ifndef _WIN32
+  for (int fd : _fds)
+    close( fd );
+#endif
+
+  _fds.clear();
+}
+
+/*
+ * Map the window holding the byte at pos, of every file. Windows start at
+ * a page boundary and extend at least one whole window past pos (or to the
+ * end of the file) as long as the file is large enough, so an item never
+ * straddles the end.
+ */
+bool file_mmap_source::map_window( uint64_t pos )
+{
+#ifdef _WIN32
+  return false;
+#else
+  unmap_window();
+
+  const uint64_t offset = pos - pos % _page_size;
+  const size_t len = std::min( uint64_t(_window_size) + _page_size, _size - offset );
+
+  _window_offset = offset;
+  _window_len = len;
+
+  for (size_t f = 0; f < _fds.size(); f++) {
+    void *p = mmap( NULL, len, PROT_READ, MAP_SHARED, _fds[f], offset );
+    if ( MAP_FAILED == p ) {
+      std::cerr << "mmap failed: " << strerror( errno ) << std::endl;
+      unmap_window();
+      return false;
+    }
+
+    madvise( p, len, MADV_SEQUENTIAL );
+#ifdef MADV_HUGEPAGE
+    /* only honoured by filesystems with large folio support, harmless else */
+    madvise( p, len, MADV_HUGEPAGE );
+#endif
+#ifdef MADV_WILLNEED
+    madvise( p, std::min( len, size_t(16) << 20 ), MADV_WILLNEED );
+#endif
+
+    _windows[f] = (unsigned char *)p;
+  }
+
+  return true;
+#endif
+}
+
+void file_mmap_source::unmap_window()
+{
+  for (unsigned char *&window : _windows) {
+#ifndef _WIN32
+    if ( window )
+      munmap( window, _window_len );
+#endif
+    window = NULL;
+  }
+
+  _window_len = 0;
+}
+
+bool file_mmap_source::seek( long seek_point, int whence )
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+
+  const int64_t items = _size / _item_size;
+  int64_t target;
+
+  switch ( whence ) {
+  case SEEK_SET:
+    target = seek_point;
+    break;
+  case SEEK_CUR:
+    target = int64_t(_pos / _item_size) + seek_point;
+    break;
+  case SEEK_END:
+    target = items + seek_point;
+    break;
+  default:
+    return false;
+  }
+
+  if ( target < 0 || target > items )
+    return false;
+
+  /* the mapping is moved lazily by work() once the position leaves it */
+  _pos = uint64_t(target) * _item_size;
+  _retag = true;
+
+  return true;
+}
+
+void file_mmap_source::set_index( const file_index &index )
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+
+  _index = index;
+  _retag = true;
+}
+
+/* the tags gr-uhd attaches, for the output item holding sample, on every
+ * output */
+void file_mmap_source::tag( uint64_t item, uint64_t sample )
+{
+  static const pmt::pmt_t TIME_KEY = pmt::string_to_symbol( "rx_time" );
+  static const pmt::pmt_t RATE_KEY = pmt::string_to_symbol( "rx_rate" );
+  static const pmt::pmt_t FREQ_KEY = pmt::string_to_symbol( "rx_freq" );
+
+  const osmosdr::time_spec_t time = _index.time_at( sample );
+  const file_index::capture &c = _index.captures()[ _index.capture_at( sample ) ];
+
+  const pmt::pmt_t time_val =
+    pmt::make_tuple( pmt::from_uint64( time.get_full_secs() ),
+                     pmt::from_double( time.get_frac_secs() ) );
+
+  for (size_t chan = 0; chan < _fds.size() * _file_chans; chan++) {
+    add_item_tag( chan, item, TIME_KEY, time_val );
+    if ( _index.sample_rate() > 0 )
+      add_item_tag( chan, item, RATE_KEY, pmt::from_double( _index.sample_rate() ) );
+    add_item_tag( chan, item, FREQ_KEY, pmt::from_double( c.freq ) );
+  }
+}
+
+int file_mmap_source::work( int noutput_items,
+                            gr_vector_const_void_star &input_items,
+                            gr_vector_void_star &output_items )
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+
+  int produced = 0;
+
+  while ( produced < noutput_items ) {
+    if ( _pos >= _size ) {
+      if ( ! _repeat )
+        break;
+      _pos = 0;
+      _retag = true;
+    }
+
+    if ( ! _windows[0] || _pos < _window_offset ||
+         _pos + _item_size > _window_offset + _window_len ) {
+      if ( ! map_window( _pos ) )
+        return produced ? produced : WORK_DONE;
+    }
+
+    uint64_t avail = (_window_offset + _window_len - _pos) / _item_size;
+
+    if ( ! _index.empty() ) {
+      const uint64_t sample = _pos / _item_size;
+      const size_t capture = _index.capture_at( sample );
+
+      /* a new capture starts a new segment with its own tags */
+      if ( _retag || ( capture && sample == _index.captures()[capture].sample ) ) {
+        tag( nitems_written( 0 ) + produced, sample );
+        _retag = false;
+      }
+
+      avail = std::min( avail, _index.next_start( capture ) - sample );
+    }
+
+    const size_t n = std::min( uint64_t(noutput_items - produced), avail );
+
+    for (size_t f = 0; f < _windows.size(); f++) {
+      const unsigned char *in = _windows[f] + (_pos - _window_offset);
+
+      for (size_t c = 0; c < _file_chans; c++)
+        _out[c] = (unsigned char *)output_items[ f * _file_chans + c ] +
+                  produced * _out_size;
+
+      _format.deinterleave( in, &_out[0], _file_chans, n, _convert );
+    }
+
+    _pos += n * _item_size;
+    produced += n;
+  }
+
+  return produced ? produced : WORK_DONE;
+}
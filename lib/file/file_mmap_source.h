@@ -0,0 +1,114 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FILE_MMAP_SOURCE_H
+#define FILE_MMAP_SOURCE_H
+
+#include <mutex>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+
+#include "file_format.h"
+#include "file_index.h"
+
+class file_mmap_source;
+
+typedef boost::shared_ptr< file_mmap_source > file_mmap_source_sptr;
+
+file_mmap_source_sptr make_file_mmap_source( const file_format &format,
+                                             const std::vector< std::string > &filenames,
+                                             size_t nchan, bool repeat, bool convert );
+
+/*!
+ * \brief Replay a file by copying straight out of a memory mapping.
+ *
+ * Drop-in for gr::blocks::file_source used by mmap=1. The file is mapped
+ * through a sliding window, so captures larger than the address space work
+ * as well, and the kernel is told to read ahead sequentially. Every sample
+ * is copied exactly once, from the page cache into the output buffer, and
+ * seek() merely moves the read position. With convert set, integer formats
+ * are converted to complex float in that single pass.
+ *
+ * Given an index, rx_time, rx_rate and rx_freq tags are restored from it
+ * for the first sample produced, after every seek() and wrap around and at
+ * the start of each capture.
+ *
+ * Several files, or several channels interleaved sample by sample within
+ * each file, are replayed in lockstep: all files are mapped at the same
+ * offset, a read position, seek() and the tags are shared, and every file
+ * is split into nchan / filenames.size() outputs in the same pass, so the
+ * nchan outputs stay sample aligned. Replay ends with the shortest file.
+ */
+class file_mmap_source : public gr::sync_block
+{
+private:
+  friend file_mmap_source_sptr make_file_mmap_source( const file_format &format,
+                                                      const std::vector< std::string > &filenames,
+                                                      size_t nchan, bool repeat, bool convert );
+
+  file_mmap_source( const file_format &format,
+                    const std::vector< std::string > &filenames,
+                    size_t nchan, bool repeat, bool convert );
+
+public:
+  ~file_mmap_source();
+
+  /*! same semantics as gr::blocks::file_source::seek(), in items */
+  bool seek( long seek_point, int whence );
+
+  /*! tag the stream from index, see above */
+  void set_index( const file_index &index );
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  bool map_window( uint64_t pos );
+  void unmap_window();
+  void close_files();
+  void tag( uint64_t item, uint64_t sample );
+
+  file_format _format;
+  size_t _file_chans;           /**< channels interleaved in each file */
+  size_t _item_size;            /**< bytes per sample of all file_chans */
+  size_t _out_size;             /**< bytes per output item */
+  bool _convert;
+  bool _repeat;
+  std::vector< int > _fds;
+  uint64_t _size;               /**< usable size of the shortest file */
+  uint64_t _pos;                /**< read position in bytes */
+
+  size_t _page_size;
+  size_t _window_size;          /**< bytes mapped at a time, per file */
+  std::vector< unsigned char * > _windows; /**< current mappings or NULL */
+  uint64_t _window_offset;      /**< file offset of the mappings */
+  size_t _window_len;           /**< mapped bytes, per file */
+  std::vector< void * > _out;   /**< output pointers of one file */
+
+  file_index _index;
+  bool _retag;                  /**< tag the next sample produced */
+
+  std::mutex _mutex;            /**< serialize seek() and work() */
+};
+
+#endif // FILE_MMAP_SOURCE_H
@@ -0,0 +1,140 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/thread/thread.hpp>
+
+#include <gnuradio/io_signature.h>
+
+#include "file_pacer_c.h"
+
+/* falling behind by more than this restarts the schedule, a stalled
+ * flowgraph is not made up for with a burst */
+#define MAX_BACKLOG_SECS 1.0
+
+file_pacer_c_sptr make_file_pacer_c( size_t item_size, double rate, double block_ms,
+                                     size_t nchan )
+{
+  return gnuradio::get_initial_sptr( new file_pacer_c( item_size, rate, block_ms,
+                                                       nchan ) );
+}
+
+file_pacer_c::file_pacer_c( size_t item_size, double rate, double block_ms,
+                            size_t nchan ) :
+  gr::sync_block( "file_pacer_c",
+                  gr::io_signature::make( nchan, nchan, item_size ),
+                  gr::io_signature::make( nchan, nchan, item_size ) ),
+  _item_size( item_size ),
+  _block_ms( block_ms > 0 ? block_ms : 10 ),
+  _rate( rate ),
+  _anchored( false ),
+  _released( 0 )
+{
+}
+
+bool file_pacer_c::start()
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  _anchored = false;
+  return true;
+}
+
+void file_pacer_c::set_sample_rate( double rate )
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  _rate = rate;
+  _anchored = false;
+}
+
+double file_pacer_c::sample_rate()
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  return _rate;
+}
+
+int file_pacer_c::work( int noutput_items,
+                        gr_vector_const_void_star &input_items,
+                        gr_vector_void_star &output_items )
+{
+  int n = noutput_items;
+
+  std::unique_lock<std::mutex> lock( _mutex );
+
+  if ( _rate > 0 ) {
+    const double rate = _rate;
+
+    if ( ! _anchored ) {
+      _anchor = clock::now();
+      _released = 0;
+      _anchored = true;
+    }
+
+    /* wait until a whole block, or all the room there is, is due */
+    const uint64_t block = std::max( uint64_t( rate * _block_ms / 1000 ), uint64_t(1) );
+    const uint64_t want = std::min( uint64_t( noutput_items ), block );
+
+    const clock::time_point due_at = _anchor +
+      std::chrono::duration_cast< clock::duration >(
+        std::chrono::duration< double >( ( _released + want ) / rate ) );
+
+    clock::time_point now = clock::now();
+
+    if ( now < due_at ) {
+      lock.unlock();
+      boost::this_thread::sleep_for( boost::chrono::nanoseconds(
+        std::chrono::duration_cast< std::chrono::nanoseconds >( due_at - now ).count() ) );
+      lock.lock();
+      now = clock::now();
+
+      /* the rate changed while sleeping */
+      if ( ! _anchored )
+        return 0;
+    }
+
+    const double elapsed = std::chrono::duration< double >( now - _anchor ).count();
+    uint64_t due = uint64_t( elapsed * rate );
+    due = due > _released ? due - _released : 0;
+
+    if ( due > uint64_t( MAX_BACKLOG_SECS * rate ) + block ) {
+      _anchor = now - std::chrono::duration_cast< clock::duration >(
+                        std::chrono::duration< double >( want / rate ) );
+      _released = 0;
+      due = want;
+    }
+
+    n = int( std::min( uint64_t( noutput_items ), std::max( due, want ) ) );
+    _released += n;
+  }
+
+  lock.unlock();
+
+  for (size_t chan = 0; chan < output_items.size(); chan++)
+    memcpy( output_items[chan], input_items[chan], n * _item_size );
+
+  return n;
+}
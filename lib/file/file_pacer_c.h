@@ -0,0 +1,80 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FILE_PACER_C_H
+#define FILE_PACER_C_H
+
+#include <chrono>
+#include <mutex>
+
+#include <gnuradio/sync_block.h>
+
+class file_pacer_c;
+
+typedef boost::shared_ptr< file_pacer_c > file_pacer_c_sptr;
+
+file_pacer_c_sptr make_file_pacer_c( size_t item_size, double rate, double block_ms,
+                                     size_t nchan = 1 );
+
+/*!
+ * \brief Release items at a rate metered against the monotonic clock.
+ *
+ * Replaces gr::blocks::throttle for pacing=clock. Items are released in
+ * blocks of block_ms worth of samples: work() sleeps until a whole block is
+ * due and then passes everything due, so the stream neither bursts nor
+ * trickles through the flowgraph buffers a few items at a time. The
+ * schedule is anchored to a steady_clock time point and only re-anchored
+ * after a rate change or when the flowgraph fell behind by more than a
+ * second, so rounding never accumulates into drift. With nchan streams they
+ * are released together, as many items of each.
+ */
+class file_pacer_c : public gr::sync_block
+{
+private:
+  friend file_pacer_c_sptr make_file_pacer_c( size_t item_size, double rate,
+                                              double block_ms, size_t nchan );
+
+  file_pacer_c( size_t item_size, double rate, double block_ms, size_t nchan );
+
+public:
+  bool start();
+
+  void set_sample_rate( double rate );
+  double sample_rate();
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  typedef std::chrono::steady_clock clock;
+
+  size_t _item_size;
+  double _block_ms;
+
+  std::mutex _mutex;            /**< guards the rate and the anchor */
+  double _rate;
+  bool _anchored;
+  clock::time_point _anchor;
+  uint64_t _released;           /**< items released since _anchor */
+};
+
+#endif // FILE_PACER_C_H
@@ -0,0 +1,407 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <boost/lexical_cast.hpp>
+
+#include <gnuradio/io_signature.h>
+
+#include "file_ring_c.h"
+
+#include "arg_helpers.h"
+
+/* the dumper copies out of the store in pieces of this many bytes */
+#define DUMP_CHUNK_SIZE (1 << 20)
+
+/* minimum samples stored beyond ring_seconds */
+#define STORE_HEADROOM (1 << 18)
+
+#define TRIGGER_KEY pmt::string_to_symbol("trigger")
+
+/* the store uses POSIX memory mappings, file_sink_c refuses it on Windows */
+#ifndef _WIN32
+
+file_ring_c_sptr make_file_ring_c( const std::string &filename, double rate,
+                                   const std::string &args )
+{
+  return gnuradio::get_initial_sptr( new file_ring_c( filename, rate, args ) );
+}
+
+file_ring_c::file_ring_c( const std::string &filename, double rate,
+                          const std::string &args ) :
+  gr::sync_block( "file_ring_c",
+                  gr::io_signature::make( 1, 1, sizeof(gr_complex) ),
+                  gr::io_signature::make( 0, 0, 0 ) ),
+  _ring_items( 0 ),
+  _post_items( 0 ),
+  _store_items( 0 ),
+  _store( NULL ),
+  _store_len( 0 ),
+  _store_fd( -1 ),
+  _writing( 0 ),
+  _written( 0 ),
+  _running( false ),
+  _requested( false ),
+  _dumping( false ),
+  _trigger_at( 0 ),
+  _filename( filename ),
+  _dump_count( 0 )
+{
+  dict_t dict = params_to_dict( args );
+
+  double seconds = 0, post = 0;
+  float scale = 0;
+  std::string ring_file;
+
+  if ( dict.count( "ring_seconds" ) )
+    seconds = boost::lexical_cast< double >( dict["ring_seconds"] );
+
+  if ( dict.count( "post_seconds" ) )
+    post = boost::lexical_cast< double >( dict["post_seconds"] );
+
+  if ( dict.count( "ring_file" ) )
+    ring_file = dict["ring_file"];
+
+  if ( dict.count( "scale" ) )
+    scale = boost::lexical_cast< float >( dict["scale"] );
+
+  _format = file_encoder( dict.count( "format" ) ? dict["format"] : "fc32", scale );
+  _item_size = _format.item_size();
+
+  _stats.set_quiet( args_to_quiet( args ) );
+
+  if ( seconds <= 0 || rate <= 0 )
+    throw std::runtime_error( "ring_seconds and rate must be positive." );
+
+  _ring_items = std::max( uint64_t( seconds * rate ), uint64_t(1) );
+  _post_items = uint64_t( std::max( post, 0.0 ) * rate );
+
+  /* the headroom keeps the oldest samples of a dump from being overwritten
+   * by the work() call noticing the trigger and the ones following it */
+  _store_items = _ring_items + std::max( _ring_items / 8, uint64_t(STORE_HEADROOM) );
+  _store_len = _store_items * _item_size;
+
+  if ( ring_file.length() ) {
+    _store_fd = open( ring_file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0664 );
+    if ( _store_fd < 0 )
+      throw std::runtime_error( "Failed to open '" + ring_file + "': " +
+                                strerror( errno ) );
+
+    /* allocate the blocks now, a sparse file would fault them in live */
+    int err = posix_fallocate( _store_fd, 0, _store_len );
+    if ( err ) {
+      close( _store_fd );
+      throw std::runtime_error( "Failed to allocate " +
+                                boost::lexical_cast< std::string >( _store_len ) +
+                                " bytes for '" + ring_file + "': " + strerror( err ) );
+    }
+  }
+
+  int flags = _store_fd < 0 ? MAP_PRIVATE | MAP_ANONYMOUS : MAP_SHARED;
+#ifdef MAP_POPULATE
+  flags |= MAP_POPULATE;
+#endif
+
+  void *p = mmap( NULL, _store_len, PROT_READ | PROT_WRITE, flags, _store_fd, 0 );
+  if ( MAP_FAILED == p ) {
+    if ( _store_fd >= 0 )
+      close( _store_fd );
+    throw std::runtime_error( std::string( "Failed to map the ring store: " ) +
+                              strerror( errno ) );
+  }
+  _store = (unsigned char *)p;
+
+  message_port_register_in( TRIGGER_KEY );
+  set_msg_handler( TRIGGER_KEY, std::bind( &file_ring_c::handle_trigger, this,
+                                           std::placeholders::_1 ) );
+
+  std::cerr << "Keeping " << seconds << " s of " << _format.name() << " in "
+            << _store_len << " bytes of "
+            << ( _store_fd < 0 ? std::string( "memory" ) : "'" + ring_file + "'" )
+            << "." << std::endl;
+}
+
+file_ring_c::~file_ring_c()
+{
+  stop();
+
+  munmap( _store, _store_len );
+
+  if ( _store_fd >= 0 )
+    close( _store_fd );
+}
+
+bool file_ring_c::start()
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+
+  if ( _running )
+    return true;
+
+  _running = true;
+  _thread = std::thread( &file_ring_c::dumper, this );
+
+  return true;
+}
+
+bool file_ring_c::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+
+    if ( ! _running )
+      return true;
+
+    /* a dump in progress writes out what is in the store and ends */
+    _running = false;
+  }
+
+  _cond.notify_all();
+
+  if ( _thread.joinable() )
+    _thread.join();
+
+  return true;
+}
+
+void file_ring_c::trigger( const std::string &filename )
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+
+  _requested = true;
+  _requested_name = filename;
+}
+
+void file_ring_c::handle_trigger( pmt::pmt_t msg )
+{
+  trigger( pmt::is_symbol( msg ) ? pmt::symbol_to_string( msg ) : "" );
+}
+
+std::string file_ring_c::next_filename()
+{
+  std::string base = _filename, ext;
+
+  size_t dot = base.rfind( '.' );
+  size_t slash = base.rfind( '/' );
+  if ( dot != std::string::npos && ( slash == std::string::npos || dot > slash ) ) {
+    ext = base.substr( dot );
+    base = base.substr( 0, dot );
+  }
+
+  char num[16];
+  snprintf( num, sizeof(num), "_%04u", _dump_count++ );
+
+  return base + num + ext;
+}
+
+int file_ring_c::work( int noutput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items )
+{
+  const gr_complex *in = (const gr_complex *)input_items[0];
+  const uint64_t start = nitems_read( 0 );
+  uint64_t pos = start;
+  size_t left = noutput_items;
+
+  while ( left ) {
+    const size_t idx = pos % _store_items;
+    const size_t n = std::min( left, size_t( _store_items - idx ) );
+
+    _writing.store( pos + n, std::memory_order_release );
+    /* a release store alone lets the samples below be written before it,
+     * dump() pairs this with the acquire fence after its copy */
+    std::atomic_thread_fence( std::memory_order_release );
+    _format.convert( in, _store + idx * _item_size, n );
+    _written.store( pos + n, std::memory_order_release );
+
+    in += n;
+    pos += n;
+    left -= n;
+  }
+
+  std::vector<gr::tag_t> tags;
+  get_tags_in_window( tags, 0, 0, noutput_items, TRIGGER_KEY );
+
+  bool notify;
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+
+    if ( _requested || tags.size() ) {
+      if ( _dumping ) {
+        std::cerr << "Dump to " << _dump_name << " in progress, ignoring trigger."
+                  << std::endl;
+      } else {
+        _dumping = true;
+        _trigger_at = tags.size() ? tags[0].offset : start;
+
+        if ( _requested && _requested_name.length() )
+          _dump_name = _requested_name;
+        else if ( tags.size() && pmt::is_symbol( tags[0].value ) )
+          _dump_name = pmt::symbol_to_string( tags[0].value );
+        else
+          _dump_name = next_filename();
+      }
+
+      _requested = false;
+    }
+
+    /* also wakes a dump waiting for the samples after its trigger */
+    notify = _dumping;
+  }
+
+  if ( notify )
+    _cond.notify_one();
+
+  _stats.delivered( noutput_items );
+  _stats.fill_level( std::min( pos, _ring_items ) );
+
+  return noutput_items;
+}
+
+void file_ring_c::dumper()
+{
+  std::unique_lock<std::mutex> lock( _mutex );
+
+  while ( true ) {
+    _cond.wait( lock, [this]{ return ! _running || _dumping; } );
+
+    if ( ! _dumping )
+      break;
+
+    const std::string name = _dump_name;
+    const uint64_t trigger = _trigger_at;
+
+    lock.unlock();
+    dump( name, trigger );
+    lock.lock();
+
+    _dumping = false;
+  }
+}
+
+/*
+ * Write the samples from _ring_items before the trigger until _post_items
+ * after it, oldest first. The store is copied out piecewise and a piece is
+ * only written once _writing shows it was not overwritten during the copy.
+ */
+void file_ring_c::dump( const std::string &filename, uint64_t trigger )
+{
+  int fd = open( filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0664 );
+  if ( fd < 0 ) {
+    std::cerr << "Failed to open '" << filename << "': " << strerror( errno )
+              << std::endl;
+    return;
+  }
+
+  std::vector<unsigned char> bounce( DUMP_CHUNK_SIZE );
+  const size_t chunk_items = DUMP_CHUNK_SIZE / _item_size;
+
+  const uint64_t end = trigger + _post_items;
+  uint64_t cur = trigger > _ring_items ? trigger - _ring_items : 0;
+  uint64_t dumped = 0, lost = 0;
+  bool failed = false;
+
+  while ( cur < end && ! failed ) {
+    const uint64_t written = _written.load( std::memory_order_acquire );
+
+    /* the live stream lapped us, continue with the oldest sample left */
+    if ( written > cur + _store_items ) {
+      lost += written - _store_items - cur;
+      cur = written - _store_items;
+      continue;
+    }
+
+    if ( cur >= written ) {
+      std::unique_lock<std::mutex> lock( _mutex );
+      if ( ! _running )
+        break;
+      _cond.wait_for( lock, std::chrono::milliseconds( 100 ) );
+      continue;
+    }
+
+    const size_t idx = cur % _store_items;
+    const size_t n = std::min( { uint64_t( chunk_items ), std::min( written, end ) - cur,
+                                 uint64_t( _store_items - idx ) } );
+
+    memcpy( bounce.data(), _store + idx * _item_size, n * _item_size );
+
+    std::atomic_thread_fence( std::memory_order_acquire );
+    if ( _writing.load( std::memory_order_relaxed ) > cur + _store_items )
+      continue;
+
+    size_t done = 0;
+    while ( done < n * _item_size ) {
+      ssize_t ret = write( fd, bounce.data() + done, n * _item_size - done );
+      if ( ret < 0 ) {
+        if ( EINTR == errno )
+          continue;
+        std::cerr << "Writing '" << filename << "' failed: " << strerror( errno )
+                  << std::endl;
+        failed = true;
+        break;
+      }
+      done += ret;
+    }
+
+    cur += n;
+    dumped += n;
+  }
+
+  close( fd );
+
+  if ( lost )
+    _stats.overflow( lost );
+
+  std::cerr << "Dumped " << dumped << " samples to '" << filename << "'";
+  if ( lost )
+    std::cerr << ", " << lost << " overwritten before they were written";
+  std::cerr << "." << std::endl;
+}
+
+osmosdr::stream_stats_t file_ring_c::get_stream_stats()
+{
+  osmosdr::stream_stats_t stats = _stats.get();
+  stats.fill = std::min( _written.load(), _ring_items );
+  return stats;
+}
+
+#endif /* _WIN32 */
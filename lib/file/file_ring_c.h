@@ -0,0 +1,118 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FILE_RING_C_H
+#define FILE_RING_C_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <gnuradio/sync_block.h>
+
+#include "file_encoder.h"
+#include "stream_counters.h"
+
+class file_ring_c;
+
+typedef boost::shared_ptr< file_ring_c > file_ring_c_sptr;
+
+file_ring_c_sptr make_file_ring_c( const std::string &filename, double rate,
+                                   const std::string &args );
+
+/*!
+ * \brief Keep the last seconds of a stream and dump them on a trigger.
+ *
+ * Used by file_sink_c for ring_seconds=N. work() only copies the samples,
+ * converted to the file format, into a circular store preallocated for N
+ * seconds at the given rate, either in memory or in a fixed size file given
+ * by ring_file. A trigger, the "trigger" message port or a "trigger" stream
+ * tag, makes a background thread write the store out oldest first, followed
+ * by the post_seconds after the trigger. The live stream keeps overwriting
+ * the store meanwhile; samples overwritten before the dump got to them are
+ * counted as overflows.
+ *
+ * Each dump goes to a new file, <name>_<n><ext> derived from the file
+ * argument, unless the trigger message carries a file name as a symbol.
+ * Triggers arriving while a dump is in progress are ignored.
+ */
+class file_ring_c : public gr::sync_block
+{
+private:
+  friend file_ring_c_sptr make_file_ring_c( const std::string &filename, double rate,
+                                            const std::string &args );
+
+  file_ring_c( const std::string &filename, double rate, const std::string &args );
+
+public:
+  ~file_ring_c();
+
+  bool start();
+  bool stop();
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+  /*! dump the store as if a trigger arrived, to filename if not empty */
+  void trigger( const std::string &filename = "" );
+
+  osmosdr::stream_stats_t get_stream_stats();
+
+private:
+  void handle_trigger( pmt::pmt_t msg );
+  void dumper();
+  void dump( const std::string &filename, uint64_t trigger );
+  std::string next_filename();
+
+  file_encoder _format;
+  size_t _item_size;            /**< bytes per sample in the store */
+  uint64_t _ring_items;         /**< samples kept before a trigger */
+  uint64_t _post_items;         /**< samples dumped after a trigger */
+  uint64_t _store_items;        /**< _ring_items plus headroom */
+
+  unsigned char *_store;
+  size_t _store_len;
+  int _store_fd;                /**< ring_file or -1 for memory */
+
+  /* absolute sample counts, _writing is published before the store is
+   * overwritten and _written once the samples are complete */
+  std::atomic<uint64_t> _writing;
+  std::atomic<uint64_t> _written;
+
+  std::mutex _mutex;
+  std::condition_variable _cond;
+  bool _running;
+  bool _requested;              /**< trigger() not yet seen by work() */
+  std::string _requested_name;
+  bool _dumping;                /**< a dump is pending or in progress */
+  uint64_t _trigger_at;
+  std::string _dump_name;
+
+  std::string _filename;
+  unsigned int _dump_count;
+  std::thread _thread;
+
+  stream_counters _stats;
+};
+
+#endif // FILE_RING_C_H
@@ -46,6 +46,8 @@ file_sink_c::file_sink_c(const std::string &args) :
   std::string filename;
   bool append = false;
   bool throttle = false;
+  bool async = false;
+  bool ring = false;
   _freq = 0;
   _rate = 0;
 
@@ -66,28 +68,62 @@ file_sink_c::file_sink_c(const std::string &args) :
   if (dict.count("append"))
     append = ("true" == dict["append"] ? true : false);
 
+  /* integer formats and the write tuning options imply the writer thread */
+  if (dict.count("async"))
+    async = ("1" == dict["async"]);
+
+  if ((dict.count("format") && "fc32" != dict["format"]) ||
+      dict.count("direct") || dict.count("prealloc"))
+    async = true;
+
+  /* ring_seconds keeps the stream in memory and writes it on a trigger */
+  if (dict.count("ring_seconds"))
+    ring = true;
+
   if (!filename.length())
     throw std::runtime_error("No file name specified.");
 
   if (_freq < 0)
     throw std::runtime_error("Parameter 'freq' may not be negative.");
 
-  if (0 == _rate && throttle)
+  if (0 == _rate && (throttle || ring))
     throw std::runtime_error("Parameter 'rate' is missing in arguments.");
 
   _file_rate = _rate;
 
-  _sink = gr::blocks::file_sink::make( sizeof(gr_complex),
-                                           filename.c_str(),
-                                           append);
+  gr::basic_block_sptr sink;
+
+  if (ring) {
+#ifdef _WIN32
+    throw std::runtime_error("ring_seconds is not supported on this platform.");
+#else
+    _ring = make_file_ring_c( filename, _rate, args );
+    sink = _ring;
+
+    message_port_register_hier_in(pmt::string_to_symbol("trigger"));
+    msg_connect(self(), "trigger", _ring, "trigger");
+#endif
+  } else if (async) {
+#ifdef _WIN32
+    throw std::runtime_error("async=1 and format are not supported on this platform.");
+#else
+    _writer = make_file_writer_c( filename, args );
+    sink = _writer;
+#endif
+  } else {
+    _sink = gr::blocks::file_sink::make( sizeof(gr_complex),
+                                             filename.c_str(),
+                                             append);
+    sink = _sink;
+  }
 
   _throttle = gr::blocks::throttle::make( sizeof(gr_complex), _file_rate );
 
   if (throttle) {
     connect( self(), 0, _throttle, 0 );
-    connect( _throttle, 0, _sink, 0 );
+    connect( _throttle, 0, sink, 0 );
   } else {
-    connect( self(), 0, _sink, 0 );
+    connect( self(), 0, sink, 0 );
   }
 }
 
@@ -115,11 +151,27 @@ std::vector<std::string> file_sink_c::get_devices( bool fake )
   return devices;
 }
 
+bool file_sink_c::has_trigger( void )
+{
+  return _ring != NULL;
+}
+
 size_t file_sink_c::get_num_channels( void )
 {
   return 1;
 }
 
+osmosdr::stream_stats_t file_sink_c::get_stream_stats( size_t chan )
+{
+  if ( _writer )
+    return _writer->get_stream_stats();
+
+  if ( _ring )
+    return _ring->get_stream_stats();
+
+  return osmosdr::stream_stats_t();
+}
+
 osmosdr::meta_range_t file_sink_c::get_sample_rates( void )
 {
   osmosdr::meta_range_t range;
@@ -25,6 +25,8 @@
 #include <gnuradio/blocks/throttle.h>
 
 #include "sink_iface.h"
+#include "file_ring_c.h"
+#include "file_writer_c.h"
 
 class file_sink_c;
 
@@ -48,7 +50,11 @@ public:
 
   static std::vector< std::string > get_devices( bool fake = false );
 
+  /*! in ring_seconds mode, with a "trigger" message port */
+  bool has_trigger( void );
+
   size_t get_num_channels( void );
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
@@ -74,6 +80,8 @@ public:
 
 private:
   gr::blocks::file_sink::sptr _sink;
+  file_writer_c_sptr _writer;
+  file_ring_c_sptr _ring;
   gr::blocks::throttle::sptr _throttle;
   double _file_rate;
   double _freq, _rate;
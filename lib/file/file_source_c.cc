@@ -18,16 +18,20 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <algorithm>
 #include <fstream>
 #include <string>
 #include <sstream>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/assign.hpp>
 #include <boost/format.hpp>
 
 #include <gnuradio/io_signature.h>
 
 #include "file_source_c.h"
+#include "file_convert_c.h"
+#include "file_index.h"
 
 #include "arg_helpers.h"
 
@@ -41,19 +45,36 @@ file_source_c_sptr make_file_source_c(const std::string &args)
 file_source_c::file_source_c(const std::string &args) :
   gr::hier_block2("file_source_c",
                  gr::io_signature::make(0, 0, 0),
-                 gr::io_signature::make(1, 1, sizeof (gr_complex)))
+                 args_to_io_signature(args, true))
 {
   std::string filename;
+  std::vector< std::string > filenames;
   bool repeat = true;
   bool throttle = true;
+  bool mmap = false;
+  std::string pacing = "throttle";
+  double pace_ms = 10;
+  std::string index_path;
   _freq = 0;
   _rate = 0;
+  _nchan = 1;
 
   dict_t dict = params_to_dict(args);
 
   if (dict.count("file"))
     filename = dict["file"];
 
+  /* file='a;b' replays several recordings in lockstep */
+  boost::algorithm::split( filenames, filename, boost::is_any_of( ";" ),
+                           boost::token_compress_on );
+  filenames.erase( std::remove( filenames.begin(), filenames.end(), "" ),
+                   filenames.end() );
+  if (filenames.size())
+    filename = filenames.front();
+
+  if (dict.count("nchan"))
+    _nchan = boost::lexical_cast< size_t >( dict["nchan"] );
+
   if (dict.count("freq"))
     _freq = boost::lexical_cast< double >( dict["freq"] );
 
@@ -66,6 +87,78 @@ file_source_c::file_source_c(const std::string &args) :
   if (dict.count("throttle"))
     throttle = ("true" == dict["throttle"] ? true : false);
 
+  if (dict.count("mmap"))
+    mmap = ("1" == dict["mmap"] || "true" == dict["mmap"]);
+
+  if (dict.count("pacing"))
+    pacing = dict["pacing"];
+
+  if ("throttle" != pacing && "clock" != pacing)
+    throw std::runtime_error("Unsupported pacing '" + pacing +
+                             "', must be one of throttle, clock");
+
+  if (dict.count("pace_ms"))
+    pace_ms = boost::lexical_cast< double >( dict["pace_ms"] );
+
+  if (_nchan < 1 || _nchan % std::max< size_t >( filenames.size(), 1 ))
+    throw std::runtime_error("Parameter 'nchan' must be a multiple of the "
+                             "number of files.");
+
+  /* multiple channels are split by the mapped reader and share one clock,
+   * gr::blocks::throttle only paces a single stream */
+  if (_nchan > 1) {
+    mmap = true;
+    pacing = "clock";
+  }
+
+  /* SigMF recordings come with their index, others may name one */
+  index_path = file_index::meta_path(filename);
+  if (dict.count("index"))
+    index_path = dict["index"];
+
+  if (index_path.length()) {
+    _index = file_index( index_path );
+
+    if (!dict.count("rate"))
+      _rate = _index.sample_rate();
+
+    if (!dict.count("freq"))
+      _freq = _index.captures().front().freq;
+
+    /* only the mapped reader knows the file position of every sample */
+    mmap = true;
+  }
+
+  /* delivering the samples unconverted requires the file to hold them in
+   * the given cpu_format */
+  std::vector< std::string > formats;
+  formats.push_back("cs16");
+  formats.push_back("cs8");
+  formats.push_back("cu8");
+  _cpu_format = args_to_cpu_format(args, formats);
+
+  float scale = 0;
+  if (dict.count("scale"))
+    scale = boost::lexical_cast< float >( dict["scale"] );
+
+  std::string format_name = _cpu_format;
+  if (dict.count("format"))
+    format_name = dict["format"];
+  else if (!_index.empty())
+    format_name = _index.format();
+
+  file_format format( format_name, scale );
+
+  /* integer recordings are converted on the fly unless passed through */
+  const bool convert = ( format.name() != _cpu_format );
+
+  if ( convert && "fc32" != _cpu_format )
+    throw std::runtime_error("cpu_format '" + _cpu_format +
+                             "' does not match the file format '" +
+                             format.name() + "'.");
+
+  const size_t item_size = cpu_format_item_size(_cpu_format);
+
   if (!filename.length())
     throw std::runtime_error("No file name specified.");
 
@@ -77,17 +170,46 @@ file_source_c::file_source_c(const std::string &args) :
 
   _file_rate = _rate;
 
-  _source = gr::blocks::file_source::make( sizeof(gr_complex),
-                                           filename.c_str(),
-                                           repeat );
+  gr::basic_block_sptr source;
 
-  _throttle = gr::blocks::throttle::make( sizeof(gr_complex), _file_rate );
+  if (mmap) {
+    /* converts straight out of the mapping */
+    _mmap_source = make_file_mmap_source( format, filenames, _nchan,
+                                          repeat, convert );
+    source = _mmap_source;
 
-  if (throttle) {
-    connect( _source, 0, _throttle, 0 );
-    connect( _throttle, 0, self(), 0 );
+    if (!_index.empty())
+      _mmap_source->set_index( _index );
   } else {
-    connect( _source, 0, self(), 0 );
+    _source = gr::blocks::file_source::make( format.item_size(),
+                                             filename.c_str(),
+                                             repeat );
+    source = _source;
+
+    if (convert) {
+      file_convert_c_sptr converter = make_file_convert_c( format );
+      connect( _source, 0, converter, 0 );
+      source = converter;
+    }
+  }
+
+  gr::basic_block_sptr pacer;
+
+  if ("clock" == pacing) {
+    _pacer = make_file_pacer_c( item_size, _file_rate, pace_ms, _nchan );
+    pacer = _pacer;
+  } else {
+    _throttle = gr::blocks::throttle::make( item_size, _file_rate );
+    pacer = _throttle;
+  }
+
+  for (size_t chan = 0; chan < _nchan; chan++) {
+    if (throttle) {
+      connect( source, chan, pacer, chan );
+      connect( pacer, chan, self(), chan );
+    } else {
+      connect( source, chan, self(), chan );
+    }
   }
 }
 
@@ -115,16 +237,38 @@ std::vector<std::string> file_source_c::get_devices( bool fake )
   return devices;
 }
 
+std::string file_source_c::get_cpu_format( void )
+{
+  return _cpu_format;
+}
+
 size_t file_source_c::get_num_channels( void )
 {
-  return 1;
+  return _nchan;
 }
 
 bool file_source_c::seek( long seek_point, int whence , size_t chan )
 {
+    if ( _mmap_source )
+      return _mmap_source->seek( seek_point, whence );
+
     return _source->seek( seek_point, whence );
 }
 
+bool file_source_c::seek_time( const osmosdr::time_spec_t &time, size_t chan )
+{
+  uint64_t sample;
+
+  if ( !_index.empty() )
+    sample = _index.sample_at( time );
+  else if ( _file_rate > 0 && time.get_real_secs() >= 0 )
+    sample = uint64_t( time.get_real_secs() * _file_rate + 0.5 );
+  else
+    return false;
+
+  return seek( long(sample), SEEK_SET, chan );
+}
+
 osmosdr::meta_range_t file_source_c::get_sample_rates( void )
 {
   osmosdr::meta_range_t range;
@@ -143,7 +287,10 @@ double file_source_c::set_sample_rate( double rate )
               << std::endl;
   }
 
-  _throttle->set_sample_rate( rate );
+  if ( _pacer )
+    _pacer->set_sample_rate( rate );
+  else
+    _throttle->set_sample_rate( rate );
 
   _rate = rate;
 
@@ -25,6 +25,9 @@
 #include <gnuradio/blocks/throttle.h>
 
 #include "source_iface.h"
+#include "file_index.h"
+#include "file_mmap_source.h"
+#include "file_pacer_c.h"
 
 class file_source_c;
 
@@ -49,8 +52,10 @@ public:
   static std::vector< std::string > get_devices( bool fake = false );
 
   size_t get_num_channels( void );
+  std::string get_cpu_format( void );
 
   bool seek( long seek_point, int whence, size_t chan );
+  bool seek_time( const osmosdr::time_spec_t &time, size_t chan );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
@@ -76,7 +81,12 @@ public:
 
 private:
   gr::blocks::file_source::sptr _source;
+  file_mmap_source_sptr _mmap_source;
   gr::blocks::throttle::sptr _throttle;
+  file_pacer_c_sptr _pacer;
+  file_index _index;
+  std::string _cpu_format;
+  size_t _nchan;
   double _file_rate;
   double _freq, _rate;
 };
@@ -0,0 +1,326 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+
+#include "file_writer_c.h"
+
+#include "arg_helpers.h"
+
+/* O_DIRECT wants buffers, sizes and file offsets aligned to the logical
+ * block size, a page covers every device in use */
+#define DIRECT_ALIGN 4096
+
+#define DEFAULT_CHUNK_SIZE (4 << 20)
+#define DEFAULT_BUF_NUM 64
+
+/* the writer uses POSIX file I/O, file_sink_c refuses it on Windows */
+#ifndef _WIN32
+
+file_writer_c_sptr make_file_writer_c( const std::string &filename,
+                                       const std::string &args )
+{
+  return gnuradio::get_initial_sptr( new file_writer_c( filename, args ) );
+}
+
+file_writer_c::file_writer_c( const std::string &filename,
+                              const std::string &args ) :
+  gr::sync_block( "file_writer_c",
+                  gr::io_signature::make( 1, 1, sizeof(gr_complex) ),
+                  gr::io_signature::make( 0, 0, 0 ) ),
+  _drop( false ),
+  _direct( false ),
+  _fd( -1 ),
+  _chunk_size( DEFAULT_CHUNK_SIZE ),
+  _have_cur( false ),
+  _running( false ),
+  _failed( false )
+{
+  dict_t dict = params_to_dict( args );
+
+  size_t buf_num = DEFAULT_BUF_NUM;
+  uint64_t prealloc = 0;
+  bool append = false;
+
+  float scale = 0;
+  if ( dict.count( "scale" ) )
+    scale = boost::lexical_cast< float >( dict["scale"] );
+
+  _format = file_encoder( dict.count( "format" ) ? dict["format"] : "fc32", scale );
+  _item_size = _format.item_size();
+
+  if ( dict.count( "chunk" ) )
+    _chunk_size = boost::lexical_cast< size_t >( dict["chunk"] );
+
+  if ( dict.count( "buffers" ) )
+    buf_num = boost::lexical_cast< size_t >( dict["buffers"] );
+
+  if ( dict.count( "prealloc" ) )
+    prealloc = boost::lexical_cast< double >( dict["prealloc"] );
+
+  if ( dict.count( "append" ) )
+    append = ( "true" == dict["append"] );
+
+  if ( dict.count( "direct" ) )
+    _direct = ( "1" == dict["direct"] );
+
+  if ( dict.count( "drop" ) )
+    _drop = ( "1" == dict["drop"] );
+
+  _stats.set_quiet( args_to_quiet( args ) );
+
+  /* whole pages, which also hold a whole number of samples */
+  _chunk_size = std::max( _chunk_size, size_t(DIRECT_ALIGN) );
+  _chunk_size = ( _chunk_size + DIRECT_ALIGN - 1 ) / DIRECT_ALIGN * DIRECT_ALIGN;
+  buf_num = std::max( buf_num, size_t(2) );
+
+  _fd = open( filename.c_str(),
+              O_WRONLY | O_CREAT | ( append ? 0 : O_TRUNC ), 0664 );
+  if ( _fd < 0 )
+    throw std::runtime_error( "Failed to open '" + filename + "': " +
+                              strerror( errno ) );
+
+  off_t offset = append ? lseek( _fd, 0, SEEK_END ) : 0;
+
+  if ( prealloc ) {
+#if defined(__linux__) && defined(FALLOC_FL_KEEP_SIZE)
+    /* reserve the space without changing the file size */
+    if ( fallocate( _fd, FALLOC_FL_KEEP_SIZE, offset, prealloc ) < 0 )
+      std::cerr << "Preallocating " << prealloc << " bytes failed: "
+                << strerror( errno ) << std::endl;
+#else
+    std::cerr << "Preallocation is not supported on this platform." << std::endl;
+#endif
+  }
+
+  if ( _direct ) {
+#ifdef O_DIRECT
+    if ( offset % DIRECT_ALIGN ) {
+      std::cerr << "Appending at an unaligned offset, not using O_DIRECT."
+                << std::endl;
+      _direct = false;
+    } else if ( fcntl( _fd, F_SETFL, fcntl( _fd, F_GETFL ) | O_DIRECT ) < 0 ) {
+      std::cerr << "Enabling O_DIRECT failed: " << strerror( errno ) << std::endl;
+      _direct = false;
+    }
+#else
+    std::cerr << "O_DIRECT is not supported on this platform." << std::endl;
+    _direct = false;
+#endif
+  }
+
+  _full.resize( buf_num );
+  _free.resize( buf_num );
+
+  for ( size_t i = 0; i < buf_num; i++ ) {
+    unsigned char *p = (unsigned char *)volk_malloc( _chunk_size, DIRECT_ALIGN );
+    if ( ! p ) {
+      for ( unsigned char *c : _chunks )
+        volk_free( c );
+      close( _fd );
+      throw std::runtime_error( "Failed to allocate the write buffers." );
+    }
+    _chunks.push_back( p );
+  }
+
+  std::cerr << "Writing " << _format.name() << " through " << buf_num << " buffers of "
+            << _chunk_size << " bytes" << ( _direct ? " with O_DIRECT" : "" )
+            << "." << std::endl;
+}
+
+file_writer_c::~file_writer_c()
+{
+  stop();
+
+  if ( _fd >= 0 )
+    close( _fd );
+
+  for ( unsigned char *c : _chunks )
+    volk_free( c );
+}
+
+bool file_writer_c::start()
+{
+  if ( _running )
+    return true;
+
+  _full.clear();
+  _full.resume();
+  _free.clear();
+  _free.resume();
+
+  for ( unsigned char *p : _chunks ) {
+    chunk c = { p, 0 };
+    _free.push( &c, 1 );
+  }
+
+  _have_cur = false;
+  _running = true;
+  _thread = std::thread( &file_writer_c::writer, this );
+
+  return true;
+}
+
+bool file_writer_c::stop()
+{
+  if ( ! _running )
+    return true;
+
+  /* hand over the partially filled chunk, then let the writer drain */
+  if ( _have_cur && _cur.len )
+    _full.push( &_cur, 1 );
+  _have_cur = false;
+
+  _full.interrupt();
+  if ( _thread.joinable() )
+    _thread.join();
+
+  _running = false;
+
+  return true;
+}
+
+bool file_writer_c::write_chunk( const chunk &c )
+{
+#ifdef O_DIRECT
+  /* only the last chunk may be partial, write it through the page cache */
+  if ( _direct && c.len % DIRECT_ALIGN ) {
+    fcntl( _fd, F_SETFL, fcntl( _fd, F_GETFL ) & ~O_DIRECT );
+    _direct = false;
+  }
+#endif
+
+  size_t done = 0;
+
+  while ( done < c.len ) {
+    ssize_t ret = write( _fd, c.data + done, c.len - done );
+
+    if ( ret < 0 ) {
+      if ( EINTR == errno )
+        continue;
+
+      std::cerr << "Writing the file failed: " << strerror( errno ) << std::endl;
+      return false;
+    }
+
+    done += ret;
+  }
+
+  return true;
+}
+
+/*
+ * Writer thread. After stop() interrupted _full, wait_read() keeps
+ * returning true until every queued chunk has been written.
+ */
+void file_writer_c::writer()
+{
+  chunk c;
+
+  while ( _full.wait_read( 1 ) ) {
+    _full.pop( &c, 1 );
+
+    if ( ! _failed && ! write_chunk( c ) )
+      _failed = true;
+
+    c.len = 0;
+    _free.push( &c, 1 );
+  }
+}
+
+int file_writer_c::work( int noutput_items,
+                         gr_vector_const_void_star &input_items,
+                         gr_vector_void_star &output_items )
+{
+  const gr_complex *in = (const gr_complex *)input_items[0];
+  int consumed = 0;
+
+  if ( _failed )
+    return WORK_DONE;
+
+  while ( consumed < noutput_items ) {
+    if ( ! _have_cur ) {
+      if ( _free.pop( &_cur, 1 ) != 1 ) {
+        if ( _drop ) {
+          _stats.overflow( noutput_items - consumed );
+          break;
+        }
+
+        /* every chunk is queued, wait for the writer to catch up */
+        while ( ! _free.wait_read( 1, 100 ) ) {
+          boost::this_thread::interruption_point();
+          if ( _failed )
+            return WORK_DONE;
+        }
+        _free.pop( &_cur, 1 );
+      }
+      _have_cur = true;
+    }
+
+    const size_t n = std::min( ( _chunk_size - _cur.len ) / _item_size,
+                               size_t( noutput_items - consumed ) );
+
+    _format.convert( in + consumed, _cur.data + _cur.len, n );
+    _cur.len += n * _item_size;
+    consumed += n;
+
+    if ( _cur.len == _chunk_size ) {
+      _full.push( &_cur, 1 );
+      _have_cur = false;
+      _stats.fill_level( _full.read_available() * ( _chunk_size / _item_size ) );
+    }
+  }
+
+  _stats.delivered( consumed );
+
+  return noutput_items;
+}
+
+osmosdr::stream_stats_t file_writer_c::get_stream_stats()
+{
+  osmosdr::stream_stats_t stats = _stats.get();
+  stats.fill = _full.read_available() * ( _chunk_size / _item_size );
+  return stats;
+}
+
+#endif /* _WIN32 */
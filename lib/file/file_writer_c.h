@@ -0,0 +1,113 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FILE_WRITER_C_H
+#define FILE_WRITER_C_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+
+#include "file_encoder.h"
+#include "sample_ring.h"
+#include "stream_counters.h"
+
+class file_writer_c;
+
+typedef boost::shared_ptr< file_writer_c > file_writer_c_sptr;
+
+file_writer_c_sptr make_file_writer_c( const std::string &filename,
+                                       const std::string &args );
+
+/*!
+ * \brief Record complex float samples from a dedicated writer thread.
+ *
+ * Used by file_sink_c for async=1 or an integer format. work() converts
+ * the samples straight into page aligned chunks, which a writer thread
+ * hands to the kernel in large writes. Chunks circulate between work() and
+ * the writer through a pair of sample_rings, like the libbladeRF stream
+ * buffers, so filesystem stalls are absorbed by the chunks queued in
+ * between instead of stalling the flowgraph.
+ *
+ * Device arguments, see file_sink_c:
+ *  format=fc32|cs16|cs8 sample format written to the file
+ *  scale=N              full scale for the integer formats, default 32767
+ *                       for cs16 and 127 for cs8
+ *  chunk=N              bytes per write, default 4 MiB
+ *  buffers=N            chunks allocated, default 64
+ *  prealloc=N           reserve N bytes of disk space up front
+ *  direct=1             bypass the page cache with O_DIRECT
+ *  drop=1               discard samples instead of blocking when all
+ *                       chunks are queued, counted as overflows
+ */
+class file_writer_c : public gr::sync_block
+{
+private:
+  friend file_writer_c_sptr make_file_writer_c( const std::string &filename,
+                                                const std::string &args );
+
+  file_writer_c( const std::string &filename, const std::string &args );
+
+public:
+  ~file_writer_c();
+
+  bool start();
+  bool stop();
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+  osmosdr::stream_stats_t get_stream_stats();
+
+private:
+  struct chunk
+  {
+    unsigned char *data;
+    size_t len;
+  };
+
+  void writer();
+  bool write_chunk( const chunk &c );
+
+  file_encoder _format;
+  size_t _item_size;            /**< bytes per sample in the file */
+  bool _drop;
+  bool _direct;
+  int _fd;
+
+  size_t _chunk_size;
+  std::vector<unsigned char *> _chunks;
+  sample_ring<chunk> _full;     /**< chunks queued for the writer */
+  sample_ring<chunk> _free;     /**< chunks available to work() */
+  chunk _cur;                   /**< chunk work() is filling */
+  bool _have_cur;
+
+  std::thread _thread;
+  std::atomic<bool> _running;
+  std::atomic<bool> _failed;
+
+  stream_counters _stats;
+};
+
+#endif // FILE_WRITER_C_H
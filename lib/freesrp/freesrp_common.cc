@@ -94,7 +94,7 @@ freesrp_common::freesrp_common(const string &args)
         }
       }
 
-      if(dict.count("ignore_overflow"))
+      if(dict.count("ignore_overflow") || args_to_quiet(args))
       {
         _ignore_overflow = true;
       }
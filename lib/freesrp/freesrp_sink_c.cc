@@ -1,4 +1,5 @@
 #include "freesrp_sink_c.h"
+#include "sample_convert.h"
 
 using namespace FreeSRP;
 using namespace std;
@@ -75,6 +76,10 @@ int freesrp_sink_c::work(int noutput_items, gr_vector_const_void_star& input_ite
 {
     const gr_complex *in = (const gr_complex *) input_items[0];
 
+    // A FreeSRP sample is a pair of 12 bit values in int16_t
+    _conv_buf.resize(noutput_items);
+    convert_fc32_cs16(in, reinterpret_cast<int16_t *>(_conv_buf.data()), noutput_items, 2047.0f);
+
     unique_lock<std::mutex> lk(_buf_mut);
 
     // Wait until enough space is available
@@ -85,11 +90,7 @@ int freesrp_sink_c::work(int noutput_items, gr_vector_const_void_star& input_ite
 
     for(int i = 0; i < noutput_items; ++i)
     {
-        sample s;
-        s.i = (int16_t) (real(in[i]) * 2047.0f);
-        s.q = (int16_t) (imag(in[i]) * 2047.0f);
-
-        if(!_buf_queue.try_enqueue(s))
+        if(!_buf_queue.try_enqueue(_conv_buf[i]))
         {
             throw runtime_error("Failed to add sample to buffer. This should never happen. Available space reported to be " + to_string(_buf_available_space) + " samples, noutput_items=" + to_string(noutput_items) + ", i=" + to_string(i));
         }
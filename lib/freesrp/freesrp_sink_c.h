@@ -125,6 +125,7 @@ private:
     std::condition_variable _buf_cond{};
     size_t _buf_available_space = FREESRP_RX_TX_QUEUE_SIZE;
     moodycamel::ReaderWriterQueue<::FreeSRP::sample> _buf_queue{FREESRP_RX_TX_QUEUE_SIZE};
+    std::vector<::FreeSRP::sample> _conv_buf;
 };
 
 #endif /* INCLUDED_FREESRP_SINK_C_H */
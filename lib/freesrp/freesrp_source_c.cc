@@ -1,5 +1,7 @@
 #include "freesrp_source_c.h"
 
+#include "sample_convert.h"
+
 using namespace FreeSRP;
 using namespace std;
 
@@ -31,6 +33,11 @@ freesrp_source_c::freesrp_source_c (const string & args) : gr::sync_block ("free
     {
         throw runtime_error("FreeSRP not initialized!");
     }
+
+    _stats.set_quiet(_ignore_overflow);
+
+    _buf_queue.configure(args);
+    _buf_queue.resize(FREESRP_RX_TX_QUEUE_SIZE);
 }
 
 bool freesrp_source_c::start()
@@ -40,6 +47,9 @@ bool freesrp_source_c::start()
     {
         return false;
     }
+
+    _buf_queue.clear();
+    _buf_queue.resume();
     _srp->start_rx(std::bind(&freesrp_source_c::freesrp_rx_callback, this, std::placeholders::_1));
 
     _running = true;
@@ -49,72 +59,79 @@ bool freesrp_source_c::start()
 
 bool freesrp_source_c::stop()
 {
+    _running = false;
+    _buf_queue.interrupt();
+
     _srp->send_cmd({SET_DATAPATH_EN, 0});
     _srp->stop_rx();
 
-    _running = false;
+    if(_buf_queue.dropped() && !_ignore_overflow)
+    {
+        cerr << "FreeSRP RX buffer overflowed " << _buf_queue.overflows()
+             << " times, " << _buf_queue.dropped() << " samples dropped" << endl;
+    }
 
     return true;
 }
 
 void freesrp_source_c::freesrp_rx_callback(const vector<sample> &samples)
 {
-    unique_lock<std::mutex> lk(_buf_mut);
-
-    for(const sample &s : samples)
+    // Samples that don't fit are dropped and counted by the ring, the
+    // stream keeps running
+    size_t pushed = _buf_queue.push(samples.data(), samples.size());
+    if(pushed < samples.size())
     {
-        if(!_buf_queue.try_enqueue(s))
-        {
-	    if(!_ignore_overflow)
-	    {
-		throw runtime_error("RX buffer overflow");
-	    }
-        }
-        else
-        {
-            _buf_num_samples++;
-        }
+        _stats.overflow(samples.size() - pushed);
     }
-
-    _buf_cond.notify_one();
 }
 
 int freesrp_source_c::work(int noutput_items, gr_vector_const_void_star& input_items, gr_vector_void_star& output_items)
 {
     gr_complex *out = static_cast<gr_complex *>(output_items[0]);
 
-    unique_lock<std::mutex> lk(_buf_mut);
-
     if(!_running)
     {
-	return WORK_DONE;
+        return WORK_DONE;
     }
 
     // Wait until enough samples collected
-    while(_buf_num_samples < (unsigned int) noutput_items)
+    if(!_buf_queue.wait_read(noutput_items))
     {
-        _buf_cond.wait(lk);
+        return WORK_DONE;
     }
 
-    for(int i = 0; i < noutput_items; ++i)
+    int produced = 0;
+    while(produced < noutput_items)
     {
-        sample s;
-        if(!_buf_queue.try_dequeue(s))
-        {
-            // This should not be happening
-            throw runtime_error("Failed to get sample from buffer. This should never happen. Number of available samples reported to be " + to_string(_buf_num_samples) + ", noutput_items=" + to_string(noutput_items) + ", i=" + to_string(i));
-        }
-        else
+        size_t len;
+        const sample *s = _buf_queue.read_span(len);
+        if(size_t lost = _buf_queue.discarded())
         {
-            _buf_num_samples--;
+            _stats.overflow(lost);
         }
+        len = std::min(len, (size_t) (noutput_items - produced));
 
-        out[i] = gr_complex(((float) s.i) / 2048.0f, ((float) s.q) / 2048.0f);
+        // A FreeSRP sample is a pair of 12 bit values in int16_t
+        gr_complex *o = out + produced;
+        convert_cs16_fc32_deinterleave(reinterpret_cast<const int16_t *>(s), &o, 1, len, 2048.0f);
+
+        _buf_queue.consume(len);
+        produced += len;
     }
 
+    _stats.delivered(noutput_items);
+
     return noutput_items;
 }
 
+osmosdr::stream_stats_t freesrp_source_c::get_stream_stats( size_t chan )
+{
+    osmosdr::stream_stats_t stats = _stats.get();
+    stats.high_water = _buf_queue.high_water();
+    stats.fill = _buf_queue.read_available();
+    return stats;
+}
+
 double freesrp_source_c::set_sample_rate( double rate )
 {
     command cmd = _srp->make_command(SET_RX_SAMP_FREQ, rate);
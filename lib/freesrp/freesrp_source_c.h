@@ -29,14 +29,11 @@
 #include "source_iface.h"
 
 #include "freesrp_common.h"
-
-#include "readerwriterqueue/readerwriterqueue.h"
+#include "sample_ring.h"
+#include "stream_counters.h"
 
 #include <freesrp.hpp>
 
-#include <mutex>
-#include <condition_variable>
-
 class freesrp_source_c;
 
 /*
@@ -78,6 +75,7 @@ public:
     // From freesrp_common:
     static std::vector<std::string> get_devices() { return freesrp_common::get_devices(); };
     size_t get_num_channels( void ) { return freesrp_common::get_num_channels(); }
+    osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
     osmosdr::meta_range_t get_sample_rates( void ) { return freesrp_common::get_sample_rates(); }
     osmosdr::freq_range_t get_freq_range( size_t chan = 0 ) { return freesrp_common::get_freq_range(chan); }
     osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 ) { return freesrp_common::get_bandwidth_range(chan); }
@@ -122,10 +120,8 @@ private:
 
     bool _running = false;
 
-    std::mutex _buf_mut{};
-    std::condition_variable _buf_cond{};
-    size_t _buf_num_samples = 0;
-    moodycamel::ReaderWriterQueue<FreeSRP::sample> _buf_queue{FREESRP_RX_TX_QUEUE_SIZE};
+    sample_ring<FreeSRP::sample> _buf_queue;
+    stream_counters _stats;
 };
 
 #endif /* INCLUDED_FREESRP_SOURCE_C_H */
@@ -24,6 +24,7 @@
 #include "hackrf_common.h"
 
 #include "arg_helpers.h"
+#include "device_keepalive.h"
 
 int hackrf_common::_usage = 0;
 std::mutex hackrf_common::_usage_mutex;
@@ -31,6 +32,9 @@ std::mutex hackrf_common::_usage_mutex;
 std::map<std::string, std::weak_ptr<hackrf_device>> hackrf_common::_devs;
 std::mutex hackrf_common::_devs_mutex;
 
+std::map<hackrf_device *, std::weak_ptr<hackrf_duplex>> hackrf_duplex::_duplexes;
+std::mutex hackrf_duplex::_duplexes_mutex;
+
 hackrf_common::hackrf_common(const std::string &args) :
   _dev(NULL),
   _sample_rate(0),
@@ -39,7 +43,8 @@ hackrf_common::hackrf_common(const std::string &args) :
   _auto_gain(false),
   _bandwidth(0),
   _bias(false),
-  _started(false)
+  _started(false),
+  _keep_open(0)
 {
   int ret;
   hackrf_device *raw_dev;
@@ -53,6 +58,8 @@ hackrf_common::hackrf_common(const std::string &args) :
     target_serial = dict["hackrf"];
   }
 
+  _keep_open = args_to_keep_open(dict);
+
   {
     std::lock_guard<std::mutex> guard(_usage_mutex);
 
@@ -116,6 +123,9 @@ hackrf_common::hackrf_common(const std::string &args) :
 
   hackrf_device_list_free(list);
 
+  if (dict.count("half_duplex") && dict["half_duplex"] == "1")
+    _duplex = hackrf_duplex::get(_dev);
+
   uint8_t board_id;
   ret = hackrf_board_id_read(_dev.get(), &board_id);
   HACKRF_THROW_ON_ERROR(ret, "Failed to get HackRF board id")
@@ -130,6 +140,12 @@ hackrf_common::hackrf_common(const std::string &args) :
             << std::endl;
 }
 
+hackrf_common::~hackrf_common()
+{
+  /* the next block for this device finds it in _devs meanwhile */
+  device_keepalive::get().hold(_dev, _keep_open);
+}
+
 void hackrf_common::close(void *dev)
 {
   int ret = hackrf_close(static_cast<hackrf_device *>(dev));
@@ -422,3 +438,193 @@ void hackrf_common::stop()
 {
   _started = false;
 }
+
+std::shared_ptr<hackrf_duplex> hackrf_duplex::get(const hackrf_sptr &dev)
+{
+  std::lock_guard<std::mutex> guard(_duplexes_mutex);
+
+  std::shared_ptr<hackrf_duplex> duplex = _duplexes[dev.get()].lock();
+  if (!duplex) {
+    duplex = std::shared_ptr<hackrf_duplex>(new hackrf_duplex());
+    _duplexes[dev.get()] = duplex;
+  }
+
+  return duplex;
+}
+
+hackrf_duplex::hackrf_duplex() :
+  _running(true),
+  _busy(false),
+  _current(IDLE),
+  _tx_wanted(false),
+  _pending(IDLE),
+  _turnarounds(0),
+  _last_us(0),
+  _max_us(0)
+{
+  _thread = std::thread(&hackrf_duplex::run, this);
+}
+
+hackrf_duplex::~hackrf_duplex()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _running = false;
+  }
+  _cond.notify_all();
+
+  if (_thread.joinable())
+    _thread.join();
+}
+
+void hackrf_duplex::attach(direction_t dir, const action_t &start, const action_t &stop)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _start[dir] = start;
+    _stop[dir] = stop;
+  }
+  _cond.notify_all();
+}
+
+void hackrf_duplex::detach(direction_t dir)
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  _start[dir] = action_t();
+  if (TX == dir)
+    _tx_wanted = false;
+  _cond.notify_all();
+
+  /* the thread stops the direction with the actions still in place */
+  _cond.wait(lock, [this, dir] { return !_busy && _current != dir; });
+
+  _stop[dir] = action_t();
+  _cond.notify_all();
+}
+
+bool hackrf_duplex::attached(direction_t dir)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return bool(_start[dir]);
+}
+
+bool hackrf_duplex::transmitting()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _tx_wanted;
+}
+
+void hackrf_duplex::transmit(bool on)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_tx_wanted == on)
+      return;
+
+    _tx_wanted = on;
+    _requested = std::chrono::steady_clock::now();
+  }
+  _cond.notify_all();
+}
+
+void hackrf_duplex::arrived(direction_t dir)
+{
+  if (_pending.load(std::memory_order_relaxed) != dir)
+    return;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  int expected = dir;
+  if (!_pending.compare_exchange_strong(expected, IDLE))
+    return;
+
+  const uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - _requested).count();
+
+  _turnarounds++;
+  _last_us = us;
+  if (us > _max_us)
+    _max_us = us;
+}
+
+void hackrf_duplex::get_stats(osmosdr::stream_stats_t &stats) const
+{
+  stats.turnarounds = _turnarounds.load();
+  stats.turnaround_us = _last_us.load();
+  stats.turnaround_max_us = _max_us.load();
+}
+
+/* TX while the sink asks for it, otherwise RX, each if attached */
+hackrf_duplex::direction_t hackrf_duplex::target() const
+{
+  if (_tx_wanted && _start[TX])
+    return TX;
+
+  if (_start[RX])
+    return RX;
+
+  return IDLE;
+}
+
+/*
+ * Only this thread starts and stops streaming, never a callback of
+ * libhackrf, which hackrf_stop_rx() and hackrf_stop_tx() wait for. The
+ * transfers stay allocated in between, a switch costs the transceiver
+ * mode requests and the settings of the block taking over.
+ */
+void hackrf_duplex::run()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  while (true) {
+    _cond.wait(lock, [this] { return !_running || target() != _current; });
+
+    if (!_running)
+      break;
+
+    const direction_t from = _current;
+    const direction_t to = target();
+    const action_t stop = _stop[from];
+    const action_t start = _start[to];
+
+    _busy = true;
+    lock.unlock();
+
+    if (stop && !stop())
+      std::cerr << "Failed to stop HackRF streaming for the direction switch" << std::endl;
+
+    bool started = true;
+    if (start) {
+      /* streaming starting up is no turnaround */
+      if (from != IDLE || TX == to)
+        _pending = to;
+
+      started = start();
+      if (!started)
+        std::cerr << "Failed to start HackRF streaming for the direction switch" << std::endl;
+    }
+
+    lock.lock();
+    _current = started ? to : IDLE;
+    if (!started) {
+      _pending = IDLE;
+      /* don't retry right away, the next request does */
+      if (TX == to)
+        _tx_wanted = false;
+      else if (RX == to)
+        _start[RX] = action_t();
+    }
+    _busy = false;
+    _cond.notify_all();
+  }
+
+  const direction_t from = _current;
+  const action_t stop = _stop[from];
+  _current = IDLE;
+  lock.unlock();
+
+  if (stop)
+    stop();
+}
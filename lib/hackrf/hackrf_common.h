@@ -20,15 +20,21 @@
 #ifndef INCLUDED_HACKRF_COMMON_H
 #define INCLUDED_HACKRF_COMMON_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <boost/format.hpp>
 
 #include <osmosdr/ranges.h>
+#include <osmosdr/stream_stats.h>
 #include <libhackrf/hackrf.h>
 
 #define BUF_LEN  (16 * 32 * 512) /* must be multiple of 512 */
@@ -51,10 +57,82 @@
 
 typedef std::shared_ptr<hackrf_device> hackrf_sptr;
 
+/*!
+ * Half-duplex operation of a device shared by a source and a sink, both
+ * opened with half_duplex=1.
+ *
+ * The blocks attach how they start and stop streaming in their direction
+ * once, when the flowgraph starts. A thread of its own then switches the
+ * device: to TX while the sink holds it with transmit(true), i.e. from a
+ * tx_sob tag until the burst has left the transfers, and back to RX
+ * otherwise. The turnaround, from the request until the first transfer in
+ * the new direction reached its callback, is counted in the stream
+ * statistics of both blocks.
+ */
+class hackrf_duplex
+{
+public:
+  enum direction_t { IDLE, RX, TX };
+
+  typedef std::function< bool() > action_t;
+
+  /*! the state of the device, shared by all of its blocks */
+  static std::shared_ptr<hackrf_duplex> get( const hackrf_sptr &dev );
+
+  ~hackrf_duplex();
+
+  /*! register the way to start and stop streaming in dir */
+  void attach( direction_t dir, const action_t &start, const action_t &stop );
+
+  /*! stop streaming in dir if it does, and unregister, waits */
+  void detach( direction_t dir );
+
+  bool attached( direction_t dir );
+
+  /*! TX has been asked for and did not fail to start */
+  bool transmitting();
+
+  /*! take the device for TX or hand it back, without waiting */
+  void transmit( bool on );
+
+  /*! the first transfer in dir arrived, called from its callback */
+  void arrived( direction_t dir );
+
+  void get_stats( osmosdr::stream_stats_t &stats ) const;
+
+private:
+  hackrf_duplex();
+
+  direction_t target() const;
+  void run();
+
+  static std::map<hackrf_device *, std::weak_ptr<hackrf_duplex>> _duplexes;
+  static std::mutex _duplexes_mutex;
+
+  std::mutex _mutex;
+  std::condition_variable _cond;
+  std::thread _thread;
+  bool _running;
+  bool _busy;                   /**< the thread is switching */
+
+  action_t _start[3];
+  action_t _stop[3];
+  direction_t _current;
+  bool _tx_wanted;
+
+  std::chrono::steady_clock::time_point _requested;
+  std::atomic<int> _pending;    /**< direction being switched to, IDLE if none */
+
+  std::atomic<uint64_t> _turnarounds;
+  std::atomic<uint64_t> _last_us;
+  std::atomic<uint64_t> _max_us;
+};
+
 class hackrf_common
 {
 public:
   hackrf_common(const std::string &args);
+  ~hackrf_common();
 
 protected:
   static std::vector< std::string > get_devices();
@@ -89,6 +167,7 @@ protected:
   void stop();
 
   hackrf_sptr _dev;
+  std::shared_ptr<hackrf_duplex> _duplex;  /**< with half_duplex=1 only */
 
 private:
   static void close(void *dev);
@@ -107,6 +186,7 @@ private:
   double _bandwidth;
   bool _bias;
   bool _started;
+  double _keep_open;
 };
 
 #endif /* INCLUDED_HACKRF_COMMON_H */
@@ -0,0 +1,46 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "driver_registry.h"
+#include "hackrf_source_c.h"
+#include "hackrf_sink_c.h"
+
+OSMOSDR_DRIVER( hackrf )
+{
+  driver_registry::driver_t driver( "hackrf", 60, device_cache::USB );
+
+  driver.source_devices = []( bool ) { return hackrf_source_c::get_devices(); };
+  driver.make_source = []( const std::string &args ) {
+    return driver_registry::source( make_hackrf_source_c( args ) );
+  };
+
+  driver.sink_devices = []( bool ) { return hackrf_sink_c::get_devices(); };
+  driver.make_sink = []( const std::string &args ) {
+    return driver_registry::sink( make_hackrf_sink_c( args ) );
+  };
+
+  registry.add( driver );
+}
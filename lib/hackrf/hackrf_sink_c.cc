@@ -32,80 +32,28 @@
 #include <stdexcept>
 #include <iostream>
 #include <algorithm>
-#ifdef USE_AVX
-#include <immintrin.h>
-#elif USE_SSE2
-#include <emmintrin.h>
-#endif
+#include <cmath>
+#include <cstring>
+
+#include <boost/thread/thread.hpp>
 
 #include <gnuradio/io_signature.h>
 
 #include "hackrf_sink_c.h"
 
 #include "arg_helpers.h"
+#include "sample_convert.h"
 
-static inline bool cb_init(circular_buffer_t *cb, size_t capacity, size_t sz)
-{
-  cb->buffer = malloc(capacity * sz);
-  if(cb->buffer == NULL)
-    return false; // handle error
-  cb->buffer_end = (int8_t *)cb->buffer + capacity * sz;
-  cb->capacity = capacity;
-  cb->count = 0;
-  cb->sz = sz;
-  cb->head = cb->buffer;
-  cb->tail = cb->buffer;
-  return true;
-}
-
-static inline void cb_free(circular_buffer_t *cb)
-{
-  free(cb->buffer);
-  cb->buffer = NULL;
-  // clear out other fields too, just to be safe
-  cb->buffer_end = 0;
-  cb->capacity = 0;
-  cb->count = 0;
-  cb->sz = 0;
-  cb->head = 0;
-  cb->tail = 0;
-}
-
-static inline bool cb_has_room(circular_buffer_t *cb)
-{
-  if(cb->count == cb->capacity)
-    return false;
-  return true;
-}
+/* the silence queued by stop(), so the end doesn't get cut off */
+#define TX_TAIL_LEN     (5 * BUF_LEN)
 
-static inline bool cb_is_empty(circular_buffer_t *cb)
-{
-  return cb->count == 0;
-}
+/* chunks the latency target is split into at least, and their lower bound */
+#define LATENCY_CHUNKS  4
+#define MIN_CHUNK_LEN   512
 
-static inline bool cb_push_back(circular_buffer_t *cb, const void *item)
-{
-  if(cb->count == cb->capacity)
-    return false; // handle error
-  memcpy(cb->head, item, cb->sz);
-  cb->head = (int8_t *)cb->head + cb->sz;
-  if(cb->head == cb->buffer_end)
-    cb->head = cb->buffer;
-  cb->count++;
-  return true;
-}
-
-static inline bool cb_pop_front(circular_buffer_t *cb, void *item)
-{
-  if(cb->count == 0)
-    return false; // handle error
-  memcpy(item, cb->tail, cb->sz);
-  cb->tail = (int8_t *)cb->tail + cb->sz;
-  if(cb->tail == cb->buffer_end)
-    cb->tail = cb->buffer;
-  cb->count--;
-  return true;
-}
+/* silent transfers after a burst until half_duplex=1 switches back to RX,
+ * the number libhackrf keeps in flight */
+#define TX_FLUSH_TRANSFERS  4
 
 hackrf_sink_c_sptr make_hackrf_sink_c (const std::string & args)
 {
@@ -134,11 +82,28 @@ hackrf_sink_c::hackrf_sink_c (const std::string &args)
         gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
         gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
     hackrf_common::hackrf_common(args),
-    _buf(NULL),
+    _chunk_len(BUF_LEN),
+    _latency(0),
+    _prefill(0),
+    _have_cur(false),
+    _have_tx(false),
+    _prefilling(false),
+    _burst(false),
+    _in_burst(false),
+    _tx_idle(false),
+    _eob_queued(0),
+    _burst_open(false),
+    _bursts(0),
+    _flush(0),
+    _first_tx(false),
+    _draining(false),
+    _stopping(false),
     _vga_gain(0)
 {
   dict_t dict = params_to_dict(args);
 
+  _stats.set_quiet( args_to_quiet( args ) );
+
   _buf_num = 0;
 
   if (dict.count("buffers"))
@@ -147,9 +112,19 @@ hackrf_sink_c::hackrf_sink_c (const std::string &args)
   if (0 == _buf_num)
     _buf_num = BUF_NUM;
 
-  _stopping = false;
+  if (dict.count("latency_ms"))
+    _latency = std::max( std::stod(dict["latency_ms"]), 0.0 ) / 1000.0;
+
+  if (dict.count("prefill"))
+    _prefill = std::min( std::stoi(dict["prefill"]), 100 );
+
+  if (dict.count("burst"))
+    _burst = dict["burst"] == "1";
 
-  if ( BUF_NUM != _buf_num ) {
+  if (_duplex)
+    _burst = true; /* the bursts tell when the device is needed for TX */
+
+  if ( BUF_NUM != _buf_num && _latency == 0 ) {
     std::cerr << "Using " << _buf_num << " buffers of size " << BUF_LEN << "."
               << std::endl;
   }
@@ -167,9 +142,6 @@ hackrf_sink_c::hackrf_sink_c (const std::string &args)
     hackrf_common::set_bias(dict["bias_tx"] == "1");
   }
 
-  _buf = (int8_t *) malloc( BUF_LEN );
-
-  cb_init( &_cbuf, _buf_num, BUF_LEN );
 }
 
 /*
@@ -177,93 +149,238 @@ hackrf_sink_c::hackrf_sink_c (const std::string &args)
  */
 hackrf_sink_c::~hackrf_sink_c ()
 {
-  free(_buf);
-  _buf = NULL;
+  if (_duplex)
+    _duplex->detach( hackrf_duplex::TX );
+}
+
+/*
+ * Sizes the queue between work() and the TX callback for the sample rate
+ * streaming starts with: latency_ms= is split into chunks, so work() hands
+ * over samples at a fraction of the latency, otherwise there are _buf_num
+ * chunks of a whole transfer. The transfers libhackrf keeps in flight
+ * come on top of it.
+ */
+void hackrf_sink_c::setup_queue()
+{
+  size_t num = _buf_num;
+  _chunk_len = BUF_LEN;
+
+  if ( _latency > 0 ) {
+    const size_t depth = std::max< size_t >( _latency * get_sample_rate() * 2,
+                                             MIN_CHUNK_LEN );
+
+    _chunk_len = depth / LATENCY_CHUNKS / MIN_CHUNK_LEN * MIN_CHUNK_LEN;
+    _chunk_len = std::min< size_t >( std::max< size_t >( _chunk_len, MIN_CHUNK_LEN ),
+                                     BUF_LEN );
+    num = std::max< size_t >( depth / _chunk_len, 2 );
+  }
+
+  if ( _storage.size() != num * _chunk_len )
+    _storage.assign( num * _chunk_len );
+
+  /* the rings hold every chunk, never rejecting one */
+  _full.resize( num );
+  _free.resize( num );
+
+  for (size_t i = 0; i < num; i++) {
+    chunk c = { &_storage[i * _chunk_len], 0, false };
+    _free.push( &c, 1 );
+  }
 
-  cb_free( &_cbuf );
+  _have_cur = false;
+  _have_tx = false;
+  _prefilling = _prefill > 0;
+
+  _in_burst = false;
+  _tx_idle = _burst;
+  _eob_queued = 0;
+  _burst_open = false;
+  _flush = 0;
 }
 
-int hackrf_sink_c::_hackrf_tx_callback(hackrf_transfer *transfer)
+/*
+ * Takes the next chunk for work(), waiting for the TX callback to return
+ * one. False if streaming ended meanwhile.
+ */
+bool hackrf_sink_c::next_free()
 {
-  hackrf_sink_c *obj = (hackrf_sink_c *)transfer->tx_ctx;
-  return obj->hackrf_tx_callback(transfer->buffer, transfer->valid_length);
+  while ( ! _free.wait_read( 1, 100 ) ) {
+    boost::this_thread::interruption_point();
+    if ( _duplex ? ! _duplex->attached( hackrf_duplex::TX )
+                 : hackrf_is_streaming( _dev.get() ) != HACKRF_TRUE )
+      return false;
+
+    /* again if TX failed to start for this burst */
+    if ( _duplex && _burst_open )
+      _duplex->transmit( true );
+  }
+
+  _free.pop( &_cur, 1 );
+  _cur.len = 0;
+  _cur.last = false;
+  _have_cur = true;
+
+  return true;
 }
 
-int hackrf_sink_c::hackrf_tx_callback(unsigned char *buffer, uint32_t length)
+/* converts nitems into the queue, false if streaming ended meanwhile */
+bool hackrf_sink_c::queue_samples( const gr_complex *in, size_t nitems )
 {
-#if 0
-  for (unsigned int i = 0; i < length; ++i) /* simulate noise */
-    *buffer++ = rand() % 255;
-#else
-  {
-    std::lock_guard<std::mutex> lock(_buf_mutex);
+  size_t done = 0;
 
-    if ( ! cb_pop_front( &_cbuf, buffer ) ) {
-      memset(buffer, 0, length);
-      if (_stopping) {
-        _buf_cond.notify_one();
-        return -1;
-      } else {
-        std::cerr << "U" << std::flush;
-      }
-    } else {
-//      std::cerr << "-" << std::flush;
-      _buf_cond.notify_one();
+  while ( done < nitems ) {
+    if ( ! _have_cur && ! next_free() )
+      return false;
+
+    const size_t n = std::min( ( _chunk_len - _cur.len ) / 2, nitems - done );
+
+    convert_fc32_cs8( in + done, _cur.data + _cur.len, n );
+    _cur.len += n * 2;
+    done += n;
+
+    if ( _cur.len == _chunk_len ) {
+      _full.push( &_cur, 1 );
+      _have_cur = false;
+      _stats.fill_level( _full.read_available() * ( _chunk_len / 2 ) );
     }
   }
-#endif
-  return 0; // TODO: return -1 on error/stop
+
+  return true;
 }
 
-bool hackrf_sink_c::start()
+/* queues the rest of a burst right away, padded with silence */
+bool hackrf_sink_c::end_burst()
 {
-  if ( ! _dev.get() )
+  if ( ! _have_cur && ! next_free() )
     return false;
 
-  _stopping = false;
-  _buf_used = 0;
-  hackrf_common::start();
-  int ret = hackrf_start_tx( _dev.get(), _hackrf_tx_callback, (void *)this );
-  if ( ret != HACKRF_SUCCESS ) {
-    std::cerr << "Failed to start TX streaming (" << ret << ")" << std::endl;
-    return false;
-  }
+  memset( _cur.data + _cur.len, 0, _chunk_len - _cur.len );
+  _cur.len = _chunk_len;
+  _cur.last = true;
+
+  _eob_queued++;
+  _full.push( &_cur, 1 );
+  _have_cur = false;
+
   return true;
 }
 
-bool hackrf_sink_c::stop()
+int hackrf_sink_c::_hackrf_tx_callback(hackrf_transfer *transfer)
 {
-  int i;
+  hackrf_sink_c *obj = (hackrf_sink_c *)transfer->tx_ctx;
+  return obj->hackrf_tx_callback(transfer->buffer, transfer->valid_length);
+}
 
-  if ( ! _dev.get() )
-    return false;
+/*
+ * Between bursts with half_duplex=1, hands the device back to the source
+ * once the transfers libhackrf had in flight went out as well, unless
+ * work() started another burst meanwhile.
+ */
+void hackrf_sink_c::sent_silence()
+{
+  if ( ! _duplex || ++_flush != TX_FLUSH_TRANSFERS )
+    return;
+
+  const uint64_t bursts = _bursts;
 
-  {
-    std::unique_lock<std::mutex> lock(_buf_mutex);
+  if ( _burst_open || _eob_queued || _full.read_available() ) {
+    _flush--; /* look again after the next one */
+    return;
+  }
+
+  _duplex->transmit( false );
 
-    while ( ! cb_has_room(&_cbuf) )
-      _buf_cond.wait( lock );
+  /* a tx_sob may have been seen right before */
+  if ( _bursts != bursts )
+    _duplex->transmit( true );
+}
 
-    // Fill the rest of the current buffer with silence.
-    memset(_buf + _buf_used, 0, BUF_LEN - _buf_used);
-    cb_push_back( &_cbuf, _buf );
-    _buf_used = 0;
+int hackrf_sink_c::hackrf_tx_callback(unsigned char *buffer, uint32_t length)
+{
+  if ( _duplex && _first_tx.exchange( false ) )
+    _duplex->arrived( hackrf_duplex::TX );
 
-    // Add some more silence so the end doesn't get cut off.
-    memset(_buf, 0, BUF_LEN);
-    for (i = 0; i < 5; i++) {
-      while ( ! cb_has_room(&_cbuf) )
-        _buf_cond.wait( lock );
+  /* hold back until the prefill or a whole burst is queued, sending silence */
+  if ( _prefilling ) {
+    const size_t queued = _full.read_available();
 
-      cb_push_back( &_cbuf, _buf );
+    if ( queued * 100 < size_t(_prefill) * _full.capacity() &&
+         ! _draining && ! _eob_queued ) {
+      memset(buffer, 0, length);
+      if ( _tx_idle )
+        sent_silence();
+      return 0;
     }
 
-    _stopping = true;
+    _prefilling = false;
+  }
+
+  uint32_t done = 0;
+
+  while ( done < length ) {
+    if ( ! _have_tx ) {
+      if ( _full.pop( &_tx, 1 ) != 1 )
+        break;
+      _tx.len = 0;
+      _have_tx = true;
+      _tx_idle = false;
+      _flush = 0;
+    }
+
+    const size_t n = std::min< size_t >( _chunk_len - _tx.len, length - done );
+    memcpy( buffer + done, _tx.data + _tx.len, n );
+    _tx.len += n;
+    done += n;
+
+    if ( _tx.len == _chunk_len ) {
+      if ( _tx.last ) {
+        /* the next burst starts with the prefill again */
+        _eob_queued--;
+        _tx_idle = true;
+        _prefilling = _prefill > 0;
+      }
+
+      _free.push( &_tx, 1 );
+      _have_tx = false;
+    }
+  }
+
+  if ( done < length ) {
+    memset(buffer + done, 0, length - done);
+
+    if ( _stopping && ! _duplex )
+      return -1;
+
+    /* between bursts nothing is missing */
+    if ( _tx_idle ) {
+      if ( ! done )
+        sent_silence();
+      return 0;
+    }
+
+    _stats.underrun();
 
-    while (hackrf_is_streaming(_dev.get()) == HACKRF_TRUE)
-      _buf_cond.wait( lock );
+    /* start over with the prefill once at least that much is queued */
+    _prefilling = _prefill > 0;
   }
 
+  return 0;
+}
+
+bool hackrf_sink_c::start_tx()
+{
+  hackrf_common::start();
+  _first_tx = true;
+  int ret = hackrf_start_tx( _dev.get(), _hackrf_tx_callback, (void *)this );
+  if ( ret != HACKRF_SUCCESS ) {
+    std::cerr << "Failed to start TX streaming (" << ret << ")" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool hackrf_sink_c::stop_tx()
+{
   hackrf_common::stop();
   int ret = hackrf_stop_tx( _dev.get() );
   if ( ret != HACKRF_SUCCESS ) {
@@ -273,124 +390,140 @@ bool hackrf_sink_c::stop()
   return true;
 }
 
-#ifdef USE_AVX
-void convert_avx(const float* inbuf, int8_t* outbuf,const unsigned int count)
+bool hackrf_sink_c::start()
 {
-  __m256 mulme = _mm256_set_ps(127.0f, 127.0f, 127.0f, 127.0f, 127.0f, 127.0f, 127.0f, 127.0f);
-  for(unsigned int i=0; i<count;i++){
-
-  __m256i itmp3 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(&inbuf[i*16+0]), mulme));
-  __m256i itmp4 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(&inbuf[i*16+8]), mulme));
-
-  __m128i a1 = _mm256_extractf128_si256(itmp3, 1);
-  __m128i a0 = _mm256_castsi256_si128(itmp3);
-  __m128i a3 = _mm256_extractf128_si256(itmp4, 1);
-  __m128i a2 = _mm256_castsi256_si128(itmp4);
-
-  __m128i outshorts1 = _mm_packs_epi32(a0, a1);
-  __m128i outshorts2 = _mm_packs_epi32(a2, a3);
-
-  __m128i outbytes = _mm_packs_epi16(outshorts1, outshorts2);
+  if ( ! _dev.get() )
+    return false;
 
-  _mm_storeu_si128 ((__m128i*)&outbuf[i*16], outbytes);
+  _draining = false;
+  _stopping = false;
+  setup_queue();
+
+  /* streams from the first tx_sob on, see work() */
+  if ( _duplex ) {
+    _duplex->attach( hackrf_duplex::TX,
+                     [this] { return start_tx(); },
+                     [this] { return stop_tx(); } );
+    return true;
   }
+
+  return start_tx();
 }
 
-#elif USE_SSE2
-void convert_sse2(const float* inbuf, int8_t* outbuf,const unsigned int count)
+bool hackrf_sink_c::stop()
 {
-  const register __m128 mulme = _mm_set_ps( 127.0f, 127.0f, 127.0f, 127.0f );
-  __m128 itmp1,itmp2,itmp3,itmp4;
-  __m128i otmp1,otmp2,otmp3,otmp4;
-
-  __m128i outshorts1,outshorts2;
-  __m128i outbytes;
+  if ( ! _dev.get() )
+    return false;
 
-  for(unsigned int i=0; i<count;i++){
+  _draining = true;
 
-  itmp1 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+0]), mulme);
-  itmp2 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+4]), mulme);
-  itmp3 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+8]), mulme);
-  itmp4 = _mm_mul_ps(_mm_loadu_ps(&inbuf[i*16+12]), mulme);
+  if ( _duplex ) {
+    /* finish the burst in progress, the TX callback hands the device
+     * back once all of them went out */
+    if ( _in_burst && end_burst() ) {
+      _in_burst = false;
+      _burst_open = false;
+    }
 
-  otmp1 = _mm_cvtps_epi32(itmp1);
-  otmp2 = _mm_cvtps_epi32(itmp2);
-  otmp3 = _mm_cvtps_epi32(itmp3);
-  otmp4 = _mm_cvtps_epi32(itmp4);
+    while ( _duplex->transmitting() )
+      boost::this_thread::sleep_for( boost::chrono::milliseconds( 10 ) );
 
-  outshorts1 = _mm_packs_epi32(otmp1, otmp2);
-  outshorts2 = _mm_packs_epi32(otmp3, otmp4);
+    _stopping = true;
+    _duplex->detach( hackrf_duplex::TX );
+    return true;
+  }
 
-  outbytes = _mm_packs_epi16(outshorts1, outshorts2);
+  // Fill the rest of the current chunk with silence, then add some more
+  // so the end doesn't get cut off.
+  for (size_t tail = 0; tail < TX_TAIL_LEN; tail += _chunk_len) {
+    if ( ! _have_cur && ! next_free() )
+      break;
 
-  _mm_storeu_si128 ((__m128i*)&outbuf[i*16], outbytes);
+    memset(_cur.data + _cur.len, 0, _chunk_len - _cur.len);
+    _cur.len = _chunk_len;
+    _full.push( &_cur, 1 );
+    _have_cur = false;
   }
-}
-#endif
 
-void convert_default(float* inbuf, int8_t* outbuf,const unsigned int count)
-{
-  for(unsigned int i=0; i<count;i++){
-    outbuf[i]= inbuf[i]*127;
-  }
+  _stopping = true;
+
+  while (hackrf_is_streaming(_dev.get()) == HACKRF_TRUE)
+    boost::this_thread::sleep_for( boost::chrono::milliseconds( 10 ) );
+
+  return stop_tx();
 }
 
 int hackrf_sink_c::work( int noutput_items,
                          gr_vector_const_void_star &input_items,
                          gr_vector_void_star &output_items )
 {
+  static const pmt::pmt_t SOB_KEY = pmt::string_to_symbol( "tx_sob" );
+  static const pmt::pmt_t EOB_KEY = pmt::string_to_symbol( "tx_eob" );
+
   const gr_complex *in = (const gr_complex *) input_items[0];
 
-  {
-    std::unique_lock<std::mutex> lock(_buf_mutex);
+  if ( ! _burst ) {
+    if ( ! queue_samples( in, noutput_items ) )
+      return WORK_DONE;
 
-    while ( ! cb_has_room(&_cbuf) )
-      _buf_cond.wait( lock );
+    _stats.delivered( noutput_items );
+    return noutput_items;
   }
 
-  int8_t *buf = _buf + _buf_used;
-  unsigned int prev_buf_used = _buf_used;
-
-  unsigned int remaining = (BUF_LEN-_buf_used)/2; //complex
-
-  unsigned int count = std::min((unsigned int)noutput_items,remaining);
-  unsigned int sse_rem = count/8; // 8 complex = 16f==512bit for avx
-  unsigned int nosse_rem = count%8; // remainder
-
-#ifdef USE_AVX
-  convert_avx((float*)in, buf, sse_rem);
-  convert_default((float*)(in+sse_rem*8), buf+(sse_rem*8*2), nosse_rem*2);
-#elif USE_SSE2
-  convert_sse2((float*)in, buf, sse_rem);
-  convert_default((float*)(in+sse_rem*8), buf+(sse_rem*8*2), nosse_rem*2);
-#else
-  convert_default((float*)in, buf, count*2);
-#endif
+  /*
+   * Only the samples from a tx_sob up to and including a tx_eob are sent,
+   * the others are dropped unconverted. Between bursts the TX callback
+   * sends silence without counting underruns.
+   */
+  std::vector<gr::tag_t> tags;
+  get_tags_in_window( tags, 0, 0, noutput_items );
+
+  /* a single sample burst carries both tags */
+  std::stable_sort( tags.begin(), tags.end(),
+                    []( const gr::tag_t &a, const gr::tag_t &b ) {
+                      if ( a.offset != b.offset )
+                        return a.offset < b.offset;
+                      return pmt::eq( a.key, SOB_KEY ) && pmt::eq( b.key, EOB_KEY );
+                    } );
+
+  const uint64_t first = nitems_read(0);
+  size_t start = 0;
+  size_t queued = 0;
+
+  for (const gr::tag_t &tag : tags) {
+    const size_t idx = tag.offset - first;
+
+    if ( pmt::eq( tag.key, SOB_KEY ) ) {
+      if ( ! _in_burst ) {
+        start = idx;
+        _in_burst = true;
+
+        if ( _duplex ) {
+          _burst_open = true;
+          _bursts++;
+          _duplex->transmit( true );
+        }
+      }
+    } else if ( pmt::eq( tag.key, EOB_KEY ) && _in_burst ) {
+      if ( ! queue_samples( in + start, idx + 1 - start ) || ! end_burst() )
+        return WORK_DONE;
 
-  _buf_used += (sse_rem*8+nosse_rem)*2;
-  int items_consumed = sse_rem*8+nosse_rem;
+      queued += idx + 1 - start;
+      _in_burst = false;
+      _burst_open = false;
+    }
+  }
 
-  if((unsigned int)noutput_items >= remaining) {
-    {
-      std::lock_guard<std::mutex> lock(_buf_mutex);
+  if ( _in_burst ) {
+    if ( ! queue_samples( in + start, noutput_items - start ) )
+      return WORK_DONE;
 
-      if ( ! cb_push_back( &_cbuf, _buf ) ) {
-        _buf_used = prev_buf_used;
-        items_consumed = 0;
-        std::cerr << "O" << std::flush;
-      } else {
-//        std::cerr << "+" << std::flush;
-        _buf_used = 0;
-      }
-    }
+    queued += noutput_items - start;
   }
 
-  // Tell runtime system how many input items we consumed on
-  // each input stream.
-  consume_each(items_consumed);
+  _stats.delivered( queued );
 
-  // Tell runtime system how many output items we produced.
-  return 0;
+  return noutput_items;
 }
 
 std::vector<std::string> hackrf_sink_c::get_devices()
@@ -403,6 +536,15 @@ size_t hackrf_sink_c::get_num_channels()
   return 1;
 }
 
+osmosdr::stream_stats_t hackrf_sink_c::get_stream_stats( size_t chan )
+{
+  osmosdr::stream_stats_t stats = _stats.get();
+  stats.fill = _full.read_available() * ( _chunk_len / 2 );
+  if ( _duplex )
+    _duplex->get_stats( stats );
+  return stats;
+}
+
 osmosdr::meta_range_t hackrf_sink_c::get_sample_rates()
 {
   return hackrf_common::get_sample_rates();
@@ -23,27 +23,18 @@
 
 #include <gnuradio/sync_block.h>
 
-#include <condition_variable>
-#include <mutex>
+#include <atomic>
+#include <vector>
 
 #include <libhackrf/hackrf.h>
 
 #include "sink_iface.h"
 #include "hackrf_common.h"
+#include "sample_ring.h"
+#include "stream_counters.h"
 
 class hackrf_sink_c;
 
-typedef struct circular_buffer
-{
-  void *buffer;     // data buffer
-  void *buffer_end; // end of data buffer
-  size_t capacity;  // maximum number of items in the buffer
-  size_t count;     // number of items in the buffer
-  size_t sz;        // size of each item in the buffer
-  void *head;       // pointer to head
-  void *tail;       // pointer to tail
-} circular_buffer_t;
-
 /*
  * We use boost::shared_ptr's instead of raw pointers for all access
  * to gr::blocks (and many other data structures).  The shared_ptr gets
@@ -91,6 +82,7 @@ public:
   static std::vector< std::string > get_devices();
 
   size_t get_num_channels( void );
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
@@ -127,15 +119,53 @@ private:
   static int _hackrf_tx_callback(hackrf_transfer* transfer);
   int hackrf_tx_callback(unsigned char *buffer, uint32_t length);
 
-  circular_buffer_t _cbuf;
-  int8_t *_buf;
+  struct chunk
+  {
+    int8_t *data;
+    size_t len;
+    bool last;                  /**< ends a burst */
+  };
+
+  void setup_queue();
+  bool next_free();
+  bool queue_samples( const gr_complex *in, size_t nitems );
+  bool end_burst();
+
+  bool start_tx();
+  bool stop_tx();
+  void sent_silence();
+
+  pooled_buffer<int8_t> _storage;
+  size_t _chunk_len;            /**< bytes per chunk */
   unsigned int _buf_num;
-  unsigned int _buf_used;
-  bool _stopping;
-  std::mutex _buf_mutex;
-  std::condition_variable _buf_cond;
+  double _latency;              /**< seconds queued at most, 0 for _buf_num transfers */
+  unsigned int _prefill;        /**< percent of the queue filled before sending */
+
+  sample_ring<chunk> _full;     /**< chunks queued for the TX callback */
+  sample_ring<chunk> _free;     /**< chunks available to work() */
+  chunk _cur;                   /**< chunk work() is filling */
+  bool _have_cur;
+  chunk _tx;                    /**< chunk the TX callback is sending */
+  bool _have_tx;
+  bool _prefilling;             /**< TX callback waits for the prefill */
+
+  bool _burst;                  /**< only send between tx_sob and tx_eob tags */
+  bool _in_burst;               /**< work() is between tx_sob and tx_eob */
+  bool _tx_idle;                /**< TX callback sent the last burst */
+  std::atomic<unsigned int> _eob_queued; /**< queued chunks ending a burst */
+
+  /* half_duplex=1: the device is only ours from a tx_sob until the burst is out */
+  std::atomic<bool> _burst_open; /**< work() is between tx_sob and tx_eob */
+  std::atomic<uint64_t> _bursts; /**< tx_sob tags seen by work() */
+  unsigned int _flush;          /**< silent transfers since the last burst */
+  std::atomic<bool> _first_tx;  /**< TX was started, no transfer yet */
+
+  std::atomic<bool> _draining;  /**< stop() is flushing, no prefill */
+  std::atomic<bool> _stopping;  /**< end the stream once the queue is empty */
 
   double _vga_gain;
+
+  stream_counters _stats;
 };
 
 #endif /* INCLUDED_HACKRF_SINK_C_H */
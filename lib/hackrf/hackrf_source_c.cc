@@ -28,9 +28,12 @@
 #include "config.h"
 #endif
 
+#include <cmath>
 #include <stdexcept>
 #include <iostream>
 
+#include <boost/algorithm/string.hpp>
+
 #include <gnuradio/io_signature.h>
 
 #include "hackrf_source_c.h"
@@ -56,21 +59,53 @@ static const int MAX_IN = 0;	// maximum number of input streams
 static const int MIN_OUT = 1;	// minimum number of output streams
 static const int MAX_OUT = 1;	// maximum number of output streams
 
+/* sweep mode, the defaults follow hackrf_sweep */
+#define SWEEP_BLOCK_LEN   16384   /* bytes, each starting with a header */
+#define SWEEP_HEADER_LEN  16      /* bytes skipped, the header takes 10 */
+#define SWEEP_MAX_RANGES  10
+#define SWEEP_RATE        20e6
+#define SWEEP_BANDWIDTH   15e6
+#define SWEEP_OFFSET      7.5e6
+
+/* default of settle_us, the RX samples dropped after a half-duplex switch */
+#define DUPLEX_SETTLE_US  1000
+
 /*
  * The private constructor
  */
 hackrf_source_c::hackrf_source_c (const std::string &args)
   : gr::sync_block ("hackrf_source_c",
         gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
-        gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
+        gr::io_signature::make(MIN_OUT, MAX_OUT,
+                               cpu_format_item_size( args_to_cpu_format( args, "cs8" ) ))),
     hackrf_common::hackrf_common(args),
-    _buf(NULL),
+    _wait_len(0),
+    _latency_ms(0),
+    _zerocopy(false),
+    _running(false),
+    _zc_buf(NULL),
+    _buf_offset(0),
+    _samp_avail(0),
     _lna_gain(0),
-    _vga_gain(0)
+    _vga_gain(0),
+    _sweep_bytes(SWEEP_BLOCK_LEN),
+    _sweep_step(SWEEP_RATE),
+    _sweep_offset(SWEEP_OFFSET),
+    _sweep_linear(false),
+    _sweep_pushed(0),
+    _sweep_consumed(0),
+    _settle_us(DUPLEX_SETTLE_US),
+    _first_rx(false),
+    _paused(false),
+    _settle_left(0),
+    _tuning(args)
 {
   dict_t dict = params_to_dict(args);
 
-  _buf_num = _buf_len = _buf_head = _buf_used = _buf_offset = 0;
+  _stats.set_quiet( args_to_quiet( args ) );
+  _ring.configure( args, BYTES_PER_SAMPLE );
+
+  _buf_num = _buf_len = 0;
 
   if (dict.count("buffers"))
     _buf_num = std::stoi(dict["buffers"]);
@@ -78,27 +113,125 @@ hackrf_source_c::hackrf_source_c (const std::string &args)
 //  if (dict.count("buflen"))
 //    _buf_len = std::stoi(dict["buflen"]);
 
+  if (dict.count("latency_ms"))
+    _latency_ms = std::max( std::stod(dict["latency_ms"]), 0.0 );
+
+  if (dict.count("zerocopy"))
+    _zerocopy = dict["zerocopy"] == "1";
+
+  if (dict.count("latency"))
+    _latency.enable( dict["latency"] == "1" );
+  _cpu_format = args_to_cpu_format( args, "cs8" );
+  _native = ("cs8" == _cpu_format); /* pass the raw samples through */
+
+  if (dict.count("soft_agc")) {
+    if (_native)
+      throw std::runtime_error("soft_agc requires cpu_format=fc32.");
+    _dc.set_agc( std::stod(dict["soft_agc"]) );
+  }
+
+  if (dict.count("power_tags")) {
+    if (_native)
+      throw std::runtime_error("power_tags requires cpu_format=fc32.");
+    _dc.set_power_tags( std::stoul(dict["power_tags"]) );
+  }
+
   if (0 == _buf_num)
     _buf_num = BUF_NUM;
 
   if (0 == _buf_len || _buf_len % 512 != 0) /* len must be multiple of 512 */
     _buf_len = BUF_LEN;
 
-  _samp_avail = _buf_len / BYTES_PER_SAMPLE;
-
-  // create a lookup table for gr_complex values
-  for (unsigned int i = 0; i <= 0xff; i++) {
-    _lut.push_back( float(int8_t(i)) * (1.0f/128.0f) );
-  }
-
   if ( BUF_NUM != _buf_num || BUF_LEN != _buf_len ) {
     std::cerr << "Using " << _buf_num << " buffers of size " << _buf_len << "."
               << std::endl;
   }
 
+  _wait_len = 3 * _buf_len; // collect at least 3 buffers
+
+  if (dict.count("sweep")) {
+#ifndef HAVE_HACKRF_SWEEP
+    throw std::runtime_error("This libhackrf does not support sweep mode.");
+#else
+    std::vector< std::string > tokens;
+    boost::algorithm::split( tokens, dict["sweep"], boost::is_any_of(":") );
+
+    if ( tokens.size() < 2 || tokens.size() % 2 ||
+         tokens.size() > 2 * SWEEP_MAX_RANGES )
+      throw std::runtime_error("sweep expects up to 10 start:stop pairs in MHz.");
+
+    if (dict.count("sweep_step"))
+      _sweep_step = uint32_t(std::stod(dict["sweep_step"]));
+
+    if (dict.count("sweep_offset"))
+      _sweep_offset = uint32_t(std::stod(dict["sweep_offset"]));
+
+    if (dict.count("sweep_len")) {
+      /* samples per tuning, rounded up to whole blocks */
+      const uint32_t blocks = (std::stoul(dict["sweep_len"]) * BYTES_PER_SAMPLE
+                               + SWEEP_BLOCK_LEN - 1) / SWEEP_BLOCK_LEN;
+      _sweep_bytes = std::max<uint32_t>(blocks, 1) * SWEEP_BLOCK_LEN;
+    }
+
+    if (dict.count("sweep_style"))
+      _sweep_linear = dict["sweep_style"] == "linear";
+
+    if (_sweep_step < 1e6)
+      throw std::runtime_error("sweep_step must be at least 1 MHz.");
+
+    /* like hackrf_sweep, extend each range to whole steps */
+    for (size_t i = 0; i < tokens.size(); i += 2) {
+      const double start = std::stod(tokens[i]);
+      const double stop = std::stod(tokens[i + 1]);
+      const double steps = std::max(1.0, std::ceil((stop - start) * 1e6 / _sweep_step));
+
+      if (start < 0 || stop <= start || start + steps * _sweep_step / 1e6 > 7250)
+        throw std::runtime_error("Invalid sweep range " + tokens[i] + ":" + tokens[i + 1]);
+
+      _sweep_ranges.push_back( uint16_t(start) );
+      _sweep_ranges.push_back( uint16_t(start + steps * _sweep_step / 1e6) );
+    }
+
+    /* the firmware streams whole blocks, the ring takes the payload only */
+    _zerocopy = false;
+
+    /* the callback drops whole blocks that don't fit, a discarding or
+     * blocking ring would move the items under the rx_freq tags */
+    if (_ring.overflow() != sample_ring_base::DROP_NEWEST)
+      throw std::runtime_error("sweep requires overflow=drop-newest.");
+#endif
+  }
+
+  if (dict.count("record")) {
+    if (_sweep_ranges.size())
+      throw std::runtime_error("record does not work with sweep.");
+    _record.open( dict["record"], "cs8", args );
+  }
+
+  if (dict.count("squelch_db")) {
+    if (_native || _sweep_ranges.size())
+      throw std::runtime_error("squelch_db requires cpu_format=fc32 and no sweep.");
+    _dc.set_squelch( std::stod(dict["squelch_db"]),
+                     dict.count("pre") ? std::stoul(dict["pre"]) : 0,
+                     dict.count("post") ? std::stoul(dict["post"]) : 0 );
+  }
+
+  if (_duplex) {
+    if (_zerocopy || _sweep_ranges.size())
+      throw std::runtime_error("half_duplex supports neither zerocopy nor sweep.");
+
+    if (dict.count("settle_us"))
+      _settle_us = std::max( std::stod(dict["settle_us"]), 0.0 );
+  }
+
   set_center_freq( (get_freq_range().start() + get_freq_range().stop()) / 2.0 );
-  set_sample_rate( get_sample_rates().start() );
-  set_bandwidth( 0 );
+  if (_sweep_ranges.size()) {
+    set_sample_rate( SWEEP_RATE );
+    set_bandwidth( SWEEP_BANDWIDTH );
+  } else {
+    set_sample_rate( get_sample_rates().start() );
+    set_bandwidth( 0 );
+  }
 
   set_gain( 0 ); /* disable AMP gain stage by default to protect full sprectrum pre-amp from physical damage */
 
@@ -111,11 +244,11 @@ hackrf_source_c::hackrf_source_c (const std::string &args)
     hackrf_common::set_bias(dict["bias"] == "1");
   }
 
-  _buf = (unsigned char **) malloc(_buf_num * sizeof(unsigned char *));
-
-  if (_buf) {
-    for(unsigned int i = 0; i < _buf_num; ++i)
-      _buf[i] = (unsigned char *) malloc(_buf_len);
+  if (_zerocopy) {
+    /* samples are converted straight out of the libhackrf transfers */
+    std::cerr << "Using zero-copy transfer handoff." << std::endl;
+  } else {
+    _tuning.allocate( [this] { _ring.resize( _buf_num * _buf_len ); } );
   }
 }
 
@@ -124,41 +257,192 @@ hackrf_source_c::hackrf_source_c (const std::string &args)
  */
 hackrf_source_c::~hackrf_source_c ()
 {
-  if (_buf) {
-    for(unsigned int i = 0; i < _buf_num; ++i) {
-      free(_buf[i]);
-    }
+  if (_duplex)
+    _duplex->detach( hackrf_duplex::RX );
 
-    free(_buf);
-    _buf = NULL;
+  {
+    std::lock_guard<std::mutex> lock( _buf_mutex );
+    _running = false;
   }
+  _buf_cond.notify_all();
+  _ring.interrupt();
 }
 
 int hackrf_source_c::_hackrf_rx_callback(hackrf_transfer *transfer)
 {
   hackrf_source_c *obj = (hackrf_source_c *)transfer->rx_ctx;
+
+  /* the thread of libhackrf calling us */
+  obj->_tuning.apply_once();
+
+  if (obj->_sweep_ranges.size())
+    return obj->hackrf_sweep_callback(transfer->buffer, transfer->valid_length);
+
   return obj->hackrf_rx_callback(transfer->buffer, transfer->valid_length);
 }
 
 int hackrf_source_c::hackrf_rx_callback(unsigned char *buf, uint32_t len)
 {
-  {
-    std::lock_guard<std::mutex> lock(_buf_mutex);
+  if (_zerocopy) {
+    /* Hand the transfer over to work() and keep it from being resubmitted
+     * by libhackrf until it has been converted. The remaining transfers
+     * stay queued on the USB side meanwhile. */
+    std::unique_lock<std::mutex> lock( _buf_mutex );
 
-    int buf_tail = (_buf_head + _buf_used) % _buf_num;
-    memcpy(_buf[buf_tail], buf, len);
+    if (!_running)
+      return -1;
 
-    if (_buf_used == _buf_num) {
-      std::cerr << "O" << std::flush;
-      _buf_head = (_buf_head + 1) % _buf_num;
-    } else {
-      _buf_used++;
+    _record.write( buf, len );
+
+    _zc_buf = buf;
+    _buf_offset = 0;
+    _samp_avail = len / BYTES_PER_SAMPLE;
+    _latency.arrived( len );
+    _tagger.stored( len / BYTES_PER_SAMPLE );
+    _buf_cond.notify_all();
+
+    while (_zc_buf && _running)
+      _buf_cond.wait( lock );
+
+    _zc_buf = NULL;
+    return _running ? 0 : -1;
+  }
+
+  /* a non-zero return makes libhackrf end the streaming */
+  if (_ring.interrupted())
+    return -1;
+
+  if (_duplex && _first_rx.exchange( false )) {
+    _duplex->arrived( hackrf_duplex::RX );
+
+    /* back from transmitting: the first samples are disturbed by the
+     * switch, they are dropped and counted as lost with those missed */
+    if (_paused) {
+      const double rate = get_sample_rate();
+      const double away = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - _paused_at ).count();
+      const double missed = away * rate - len / BYTES_PER_SAMPLE;
+      const size_t settle = size_t( _settle_us * 1e-6 * rate );
+
+      _settle_left = settle * BYTES_PER_SAMPLE;
+      _tagger.lost( uint64_t( std::max( missed, 0.0 ) ) + settle );
+      _record.lost( uint64_t( std::max( missed, 0.0 ) ) + settle );
+    }
+  }
+
+  if (_settle_left) {
+    const size_t n = std::min<size_t>( _settle_left, len );
+    buf += n;
+    len -= n;
+    _settle_left -= n;
+
+    if (!len)
+      return 0;
+  }
+
+  _record.write( buf, len );
+
+  size_t pushed = _ring.push( buf, len );
+  _latency.arrived( pushed );
+  _tagger.stored( pushed / BYTES_PER_SAMPLE );
+  if (pushed < len) {
+    _stats.overflow( (len - pushed) / BYTES_PER_SAMPLE );
+    _tagger.lost( (len - pushed) / BYTES_PER_SAMPLE );
+  }
+
+  return 0;
+}
+
+/* Sweep transfers consist of blocks starting with 0x7f 0x7f and the
+ * frequency the block was received at, as little endian uint64_t. Each
+ * payload enters the ring whole, or is dropped, so the tags stay aligned. */
+int hackrf_source_c::hackrf_sweep_callback(unsigned char *buf, uint32_t len)
+{
+  const size_t size = SWEEP_BLOCK_LEN - SWEEP_HEADER_LEN;
+
+  if (_ring.interrupted())
+    return -1;
+
+  for (uint32_t offset = 0; offset + SWEEP_BLOCK_LEN <= len; offset += SWEEP_BLOCK_LEN) {
+    const unsigned char *block = buf + offset;
+
+    if (block[0] != 0x7f || block[1] != 0x7f)
+      continue;
+
+    uint64_t freq = 0;
+    for (int i = 9; i >= 2; i--)
+      freq = (freq << 8) | block[i];
+
+    if (_ring.write_available() < size) {
+      _stats.overflow( size / BYTES_PER_SAMPLE );
+      continue;
     }
+
+    {
+      std::lock_guard<std::mutex> lock( _sweep_mutex );
+      _sweep_tags.push_back( std::make_pair( _sweep_pushed,
+                                             double(freq) + _sweep_offset ) );
+    }
+
+    _ring.push( block + SWEEP_HEADER_LEN, size );
+    _latency.arrived( size );
+    _sweep_pushed += size / BYTES_PER_SAMPLE;
+  }
+
+  return 0;
+}
+
+bool hackrf_source_c::start_sweep()
+{
+#ifdef HAVE_HACKRF_SWEEP
+  {
+    std::lock_guard<std::mutex> lock( _sweep_mutex );
+    _sweep_tags.clear();
+    _sweep_pushed = 0;
+    _sweep_consumed = 0;
+  }
+
+  int ret = hackrf_init_sweep( _dev.get(), _sweep_ranges.data(),
+                               _sweep_ranges.size() / 2, _sweep_bytes,
+                               _sweep_step, _sweep_offset,
+                               _sweep_linear ? LINEAR : INTERLEAVED );
+  if ( ret != HACKRF_SUCCESS ) {
+    std::cerr << HACKRF_FORMAT_ERROR(ret, "Failed to initialize sweep") << std::endl;
+    return false;
   }
 
-  _buf_cond.notify_one();
+#ifdef HAVE_HACKRF_START_RX_SWEEP
+  ret = hackrf_start_rx_sweep( _dev.get(), _hackrf_rx_callback, (void *)this );
+#else
+  ret = hackrf_start_rx( _dev.get(), _hackrf_rx_callback, (void *)this );
+#endif
+  if ( ret != HACKRF_SUCCESS ) {
+    std::cerr << "Failed to start RX sweep (" << ret << ")" << std::endl;
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+/* marks the first sample of every sweep block with its frequency */
+void hackrf_source_c::tag_sweep( int produced )
+{
+  static const pmt::pmt_t FREQ_KEY = pmt::string_to_symbol( "rx_freq" );
 
-  return 0; // TODO: return -1 on error/stop
+  const uint64_t first = nitems_written( 0 );
+
+  std::lock_guard<std::mutex> lock( _sweep_mutex );
+
+  while ( _sweep_tags.size() &&
+          _sweep_tags.front().first < _sweep_consumed + produced ) {
+    const uint64_t item = first + _sweep_tags.front().first - _sweep_consumed;
+    add_item_tag( 0, item, FREQ_KEY, pmt::from_double( _sweep_tags.front().second ) );
+    _sweep_tags.pop_front();
+  }
+
+  _sweep_consumed += produced;
 }
 
 bool hackrf_source_c::start()
@@ -166,7 +450,43 @@ bool hackrf_source_c::start()
   if ( ! _dev.get() )
     return false;
 
+  _ring.clear();
+  _ring.resume();
+  _latency.reset();
+  _tagger.reset();
+  _tuning.reset();
+  _dc.reset();
+  _record.start( get_sample_rate(), get_center_freq() );
+
+  {
+    std::lock_guard<std::mutex> lock( _buf_mutex );
+    _running = true;
+    _zc_buf = NULL;
+  }
+
+  _paused = false;
+  _settle_left = 0;
+
+  /* streams whenever the sink does not transmit */
+  if (_duplex) {
+    _duplex->attach( hackrf_duplex::RX,
+                     [this] { return start_rx(); },
+                     [this] { return stop_rx(); } );
+    return true;
+  }
+
+  if (_sweep_ranges.size()) {
+    hackrf_common::start();
+    return start_sweep();
+  }
+
+  return start_rx();
+}
+
+bool hackrf_source_c::start_rx()
+{
   hackrf_common::start();
+  _first_rx = true;
   int ret = hackrf_start_rx( _dev.get(), _hackrf_rx_callback, (void *)this );
   if ( ret != HACKRF_SUCCESS ) {
     std::cerr << "Failed to start RX streaming (" << ret << ")" << std::endl;
@@ -175,13 +495,12 @@ bool hackrf_source_c::start()
   return true;
 }
 
-bool hackrf_source_c::stop()
+bool hackrf_source_c::stop_rx()
 {
-  if ( ! _dev.get() )
-    return false;
-
   hackrf_common::stop();
   int ret = hackrf_stop_rx( _dev.get() );
+  _paused_at = std::chrono::steady_clock::now();
+  _paused = true;
   if ( ret != HACKRF_SUCCESS ) {
     std::cerr << "Failed to stop RX streaming (" << ret << ")" << std::endl;
     return false;
@@ -189,59 +508,132 @@ bool hackrf_source_c::stop()
   return true;
 }
 
-int hackrf_source_c::work( int noutput_items,
-                        gr_vector_const_void_star &input_items,
-                        gr_vector_void_star &output_items )
+bool hackrf_source_c::stop()
 {
-  gr_complex *out = (gr_complex *)output_items[0];
+  if ( ! _dev.get() )
+    return false;
 
-  bool running = false;
+  {
+    std::lock_guard<std::mutex> lock( _buf_mutex );
+    _running = false;
+  }
+  _buf_cond.notify_all(); /* release a callback blocked in zerocopy mode */
+  _ring.interrupt();
 
-  if ( _dev.get() )
-    running = (hackrf_is_streaming( _dev.get() ) == HACKRF_TRUE);
+  bool ok = true;
+  if (_duplex)
+    _duplex->detach( hackrf_duplex::RX );
+  else
+    ok = stop_rx();
+
+  _record.stop();
 
+  return ok;
+}
+
+int hackrf_source_c::work_zerocopy( int noutput_items, void *out )
+{
   {
-    std::unique_lock<std::mutex> lock(_buf_mutex);
+    std::unique_lock<std::mutex> lock( _buf_mutex );
 
-    while (_buf_used < 3 && running) // collect at least 3 buffers
+    while (!_zc_buf && _running)
       _buf_cond.wait( lock );
   }
 
-  if ( ! running )
+  if (!_running)
     return WORK_DONE;
 
-  const uint8_t *buf = _buf[_buf_head] + _buf_offset * BYTES_PER_SAMPLE;
-#define TO_COMPLEX(p) gr_complex( _lut[(p)[0]], _lut[(p)[1]] )
+  /* the callback thread is parked until we release _zc_buf */
+  const int nout = std::min(noutput_items, _samp_avail);
+  const unsigned char *buf = _zc_buf + _buf_offset * BYTES_PER_SAMPLE;
 
-  if (noutput_items <= _samp_avail) {
-    for (int i = 0; i < noutput_items; ++i)
-      *out++ = TO_COMPLEX( buf + i*BYTES_PER_SAMPLE );
+  if (_native)
+    memcpy( out, buf, nout * BYTES_PER_SAMPLE );
+  else
+    _dc.convert( (const int8_t *)buf, (gr_complex *)out, nout );
 
-    _buf_offset += noutput_items;
-    _samp_avail -= noutput_items;
-  } else {
-    for (int i = 0; i < _samp_avail; ++i)
-      *out++ = TO_COMPLEX( buf + i*BYTES_PER_SAMPLE );
+  _samp_avail -= nout;
+  _buf_offset += nout;
+  _latency.consumed( nout * BYTES_PER_SAMPLE );
 
+  if (!_samp_avail) {
     {
-      std::lock_guard<std::mutex> lock(_buf_mutex);
+      std::lock_guard<std::mutex> lock( _buf_mutex );
+      _zc_buf = NULL;
+    }
+    _buf_cond.notify_all();
+  }
+
+  return nout;
+}
+
+int hackrf_source_c::work( int noutput_items,
+                        gr_vector_const_void_star &input_items,
+                        gr_vector_void_star &output_items )
+{
+  unsigned char *out = (unsigned char *)output_items[0];
+  const size_t item_size = _native ? BYTES_PER_SAMPLE : sizeof(gr_complex);
+  int produced = 0;
+
+  if (_zerocopy) {
+    produced = work_zerocopy( noutput_items, out );
+    produced = _dc.gate( this, output_items[0], produced, &_tagger );
+    if (produced >= 0)
+      _dc.tag_levels( this, produced );
+    _tagger.update( this, produced );
+    if (produced > 0)
+      _stats.delivered( produced );
+    return produced;
+  }
+
+  bool running = false;
+
+  if ( _duplex )
+    running = ! _ring.interrupted(); /* paused while the sink transmits */
+  else if ( _dev.get() )
+    running = (hackrf_is_streaming( _dev.get() ) == HACKRF_TRUE);
+
+  if ( running )
+    running = _ring.wait_read( _wait_len );
+
+  if ( ! running )
+    return WORK_DONE;
 
-      _buf_head = (_buf_head + 1) % _buf_num;
-      _buf_used--;
+  while (noutput_items) {
+    size_t len;
+    const uint8_t *buf = _ring.read_span( len );
+    if ( size_t lost = _ring.discarded() ) {
+      _latency.consumed( lost );
+      _stats.overflow( lost / BYTES_PER_SAMPLE );
+      _tagger.skipped( nitems_written( 0 ) + produced, lost / BYTES_PER_SAMPLE );
     }
 
-    buf = _buf[_buf_head];
+    const int nout = std::min(noutput_items, int(len / BYTES_PER_SAMPLE));
 
-    int remaining = noutput_items - _samp_avail;
+    if (!nout)
+      break;
 
-    for (int i = 0; i < remaining; ++i)
-      *out++ = TO_COMPLEX( buf + i*BYTES_PER_SAMPLE );
+    if (_native)
+      memcpy( out, buf, nout * BYTES_PER_SAMPLE );
+    else
+      _dc.convert( (const int8_t *)buf, (gr_complex *)out, nout );
+    _ring.consume( nout * BYTES_PER_SAMPLE );
+    _latency.consumed( nout * BYTES_PER_SAMPLE );
 
-    _buf_offset = remaining;
-    _samp_avail = (_buf_len / BYTES_PER_SAMPLE) - remaining;
+    out += nout * item_size;
+    produced += nout;
+    noutput_items -= nout;
   }
 
-  return noutput_items;
+  produced = _dc.gate( this, output_items[0], produced, &_tagger );
+  _dc.tag_levels( this, produced );
+  if (_sweep_ranges.size())
+    tag_sweep( produced );
+  else
+    _tagger.update( this, produced );
+  _stats.delivered( produced );
+
+  return produced;
 }
 
 std::vector<std::string> hackrf_source_c::get_devices()
@@ -249,6 +641,22 @@ std::vector<std::string> hackrf_source_c::get_devices()
   return hackrf_common::get_devices();
 }
 
+std::string hackrf_source_c::get_cpu_format()
+{
+  return _cpu_format;
+}
+
+osmosdr::stream_stats_t hackrf_source_c::get_stream_stats( size_t chan )
+{
+  osmosdr::stream_stats_t stats = _stats.get();
+  stats.high_water = _ring.high_water() / BYTES_PER_SAMPLE;
+  stats.fill = _ring.read_available() / BYTES_PER_SAMPLE;
+  _latency.get( stats );
+  if ( _duplex )
+    _duplex->get_stats( stats );
+  return stats;
+}
+
 size_t hackrf_source_c::get_num_channels()
 {
   return 1;
@@ -261,7 +669,19 @@ osmosdr::meta_range_t hackrf_source_c::get_sample_rates()
 
 double hackrf_source_c::set_sample_rate( double rate )
 {
-  return hackrf_common::set_sample_rate(rate);
+  rate = hackrf_common::set_sample_rate(rate);
+  _tagger.set_rate( rate );
+  _record.set_rate( rate );
+
+  /* latency_ms=N: libhackrf has transfers of fixed size, so work() hands
+   * out what arrived in half of N instead of waiting for 3 of them */
+  if ( _latency_ms > 0 )
+    _wait_len = std::min( std::max( (unsigned int)(rate * BYTES_PER_SAMPLE * _latency_ms / 2000)
+                                      / BYTES_PER_SAMPLE * BYTES_PER_SAMPLE,
+                                    (unsigned int)BYTES_PER_SAMPLE ),
+                          3 * _buf_len );
+
+  return rate;
 }
 
 double hackrf_source_c::get_sample_rate()
@@ -269,6 +689,11 @@ double hackrf_source_c::get_sample_rate()
   return hackrf_common::get_sample_rate();
 }
 
+double hackrf_source_c::get_measured_sample_rate( size_t chan )
+{
+  return _tagger.measured_rate();
+}
+
 osmosdr::freq_range_t hackrf_source_c::get_freq_range( size_t chan )
 {
   return hackrf_common::get_freq_range(chan);
@@ -276,7 +701,11 @@ osmosdr::freq_range_t hackrf_source_c::get_freq_range( size_t chan )
 
 double hackrf_source_c::set_center_freq( double freq, size_t chan )
 {
-  return hackrf_common::set_center_freq(freq, chan);
+  freq = hackrf_common::set_center_freq(freq, chan);
+  _tagger.set_freq( freq );
+  _record.set_freq( freq );
+
+  return freq;
 }
 
 double hackrf_source_c::get_center_freq( size_t chan )
@@ -428,6 +857,16 @@ std::string hackrf_source_c::get_antenna( size_t chan )
   return hackrf_common::get_antenna(chan);
 }
 
+void hackrf_source_c::set_dc_offset_mode( int mode, size_t chan )
+{
+  _dc.set_mode( mode );
+}
+
+void hackrf_source_c::set_dc_offset( const std::complex<double> &offset, size_t chan )
+{
+  _dc.set_offset( offset );
+}
+
 double hackrf_source_c::set_bandwidth( double bandwidth, size_t chan )
 {
   return hackrf_common::set_bandwidth(bandwidth, chan);
@@ -23,12 +23,22 @@
 
 #include <gnuradio/sync_block.h>
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 
 #include <libhackrf/hackrf.h>
 
 #include "source_iface.h"
+#include "sample_ring.h"
+#include "rx_tagger.h"
+#include "stream_counters.h"
+#include "latency_probe.h"
+#include "thread_tuning.h"
+#include "dc_remover.h"
+#include "raw_recorder.h"
 #include "hackrf_common.h"
 
 class hackrf_source_c;
@@ -87,10 +97,13 @@ public:
   static std::vector< std::string > get_devices();
 
   size_t get_num_channels( void );
+  std::string get_cpu_format( void );
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
   double get_sample_rate( void );
+  double get_measured_sample_rate( size_t chan = 0 );
 
   osmosdr::freq_range_t get_freq_range( size_t chan = 0 );
   double set_center_freq( double freq, size_t chan = 0 );
@@ -115,6 +128,9 @@ public:
   std::string set_antenna( const std::string & antenna, size_t chan = 0 );
   std::string get_antenna( size_t chan = 0 );
 
+  void set_dc_offset_mode( int mode, size_t chan = 0 );
+  void set_dc_offset( const std::complex<double> &offset, size_t chan = 0 );
+
   double set_bandwidth( double bandwidth, size_t chan = 0 );
   double get_bandwidth( size_t chan = 0 );
   osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
@@ -122,22 +138,61 @@ public:
 private:
   static int _hackrf_rx_callback(hackrf_transfer* transfer);
   int hackrf_rx_callback(unsigned char *buf, uint32_t len);
-
-  std::vector<float> _lut;
-
-  unsigned char **_buf;
+  int hackrf_sweep_callback(unsigned char *buf, uint32_t len);
+  int work_zerocopy( int noutput_items, void *out );
+  bool start_rx();
+  bool stop_rx();
+  bool start_sweep();
+  void tag_sweep( int produced );
+
+  sample_ring<unsigned char> _ring;
   unsigned int _buf_num;
   unsigned int _buf_len;
-  unsigned int _buf_head;
-  unsigned int _buf_used;
+  std::atomic<unsigned int> _wait_len;  /**< bytes work() waits for */
+  double _latency_ms;                   /**< latency_ms=N, 0 for 3 transfers */
+
+  /* zerocopy mode: transfer handed over by the callback, not yet consumed */
+  bool _zerocopy;
   std::mutex _buf_mutex;
   std::condition_variable _buf_cond;
-
+  bool _running;
+  unsigned char *_zc_buf;
   unsigned int _buf_offset;
   int _samp_avail;
 
+  std::string _cpu_format;
+
+  rx_tagger _tagger;
+  stream_counters _stats;
+  dc_remover _dc;
+  raw_recorder _record;          /**< see record= */
+  latency_probe _latency;
+  bool _native;
+
   double _lna_gain;
   double _vga_gain;
+
+  /* sweep mode: hackrf_init_sweep() ranges in MHz, empty when streaming */
+  std::vector<uint16_t> _sweep_ranges;
+  uint32_t _sweep_bytes;        /**< per tuning, a multiple of the block size */
+  uint32_t _sweep_step;         /**< Hz */
+  uint32_t _sweep_offset;       /**< Hz of the LO above the block frequency */
+  bool _sweep_linear;
+
+  /* the block frequencies by the index of the first sample of each block */
+  std::mutex _sweep_mutex;
+  std::deque< std::pair<uint64_t, double> > _sweep_tags;
+  uint64_t _sweep_pushed;       /**< by the callback since start() */
+  uint64_t _sweep_consumed;     /**< by work() since start() */
+
+  /* half_duplex=1: RX pauses while the sink transmits */
+  double _settle_us;            /**< dropped after switching back */
+  std::atomic<bool> _first_rx;  /**< RX was started, no transfer yet */
+  bool _paused;                 /**< RX was stopped for the sink before */
+  std::chrono::steady_clock::time_point _paused_at;
+  size_t _settle_left;          /**< bytes still to drop */
+
+  thread_tuning _tuning;
 };
 
 #endif /* INCLUDED_HACKRF_SOURCE_C_H */
@@ -0,0 +1,147 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_LATENCY_PROBE_H
+#define INCLUDED_OSMOSDR_LATENCY_PROBE_H
+
+#include <atomic>
+#include <chrono>
+
+#include <osmosdr/stream_stats.h>
+#include "sample_ring.h"
+
+/*!
+ * Callback-to-work latency instrumentation, enabled by latency=1.
+ *
+ * The producer reports every transfer it has queued with arrived(), the
+ * consumer reports what work() has taken out of the queue with consumed().
+ * Both count in the same unit the queue uses (bytes, items or buffers).
+ * Once the last unit of a transfer has been consumed, the time since its
+ * arrival is sorted into a histogram of power of two microsecond buckets.
+ *
+ * Arrival times are handed over through a wait-free ring, so neither side
+ * takes a lock and a disabled probe costs a single branch.
+ */
+class latency_probe
+{
+public:
+  /*! histogram buckets, the last one collects everything from 2^23 us on */
+  static const size_t BUCKETS = 24;
+
+  latency_probe() :
+    _enabled( false ),
+    _arrivals( 4096 ),
+    _written( 0 ),
+    _read( 0 )
+  {
+    for (size_t i = 0; i < BUCKETS; i++)
+      _hist[i].store( 0 );
+  }
+
+  void enable( bool enabled ) { _enabled = enabled; }
+  bool enabled() const { return _enabled; }
+
+  /*! forget queued arrivals, only call while not streaming */
+  void reset()
+  {
+    _arrivals.clear();
+    _written = 0;
+    _read = 0;
+  }
+
+  /*! producer: n units of a transfer have just been queued */
+  void arrived( size_t n )
+  {
+    if ( ! _enabled || ! n )
+      return;
+
+    _written += n;
+
+    /* a full ring drops the arrival, its units are then timed with the
+     * next transfer */
+    arrival a = { _written, clock::now() };
+    _arrivals.push( &a, 1 );
+  }
+
+  /*! consumer: n units have left the queue */
+  void consumed( size_t n )
+  {
+    if ( ! _enabled || ! n )
+      return;
+
+    _read += n;
+
+    clock::time_point now;
+    bool have_now = false;
+
+    size_t len;
+    const arrival *a = _arrivals.read_span( len );
+
+    while ( len && a->end <= _read ) {
+      if ( ! have_now ) {
+        now = clock::now();
+        have_now = true;
+      }
+
+      record( std::chrono::duration_cast< std::chrono::microseconds >(
+                now - a->time ).count() );
+
+      _arrivals.consume( 1 );
+      a = _arrivals.read_span( len );
+    }
+  }
+
+  /*! copy the histogram into stats */
+  void get( osmosdr::stream_stats_t &stats ) const
+  {
+    if ( ! _enabled )
+      return;
+
+    stats.latency_us.resize( BUCKETS );
+    for (size_t i = 0; i < BUCKETS; i++)
+      stats.latency_us[i] = _hist[i].load( std::memory_order_relaxed );
+  }
+
+private:
+  typedef std::chrono::steady_clock clock;
+
+  struct arrival {
+    uint64_t end;             /**< producer count after the transfer */
+    clock::time_point time;   /**< when it was queued */
+  };
+
+  void record( int64_t us )
+  {
+    size_t bucket = 0;
+    while ( bucket < BUCKETS - 1 && us >= (int64_t(2) << bucket) )
+      bucket++;
+
+    _hist[bucket].fetch_add( 1, std::memory_order_relaxed );
+  }
+
+  std::atomic<bool> _enabled;
+  sample_ring< arrival > _arrivals;
+  uint64_t _written;          /**< producer side only */
+  uint64_t _read;             /**< consumer side only */
+  std::atomic<uint64_t> _hist[BUCKETS];
+};
+
+#endif /* INCLUDED_OSMOSDR_LATENCY_PROBE_H */
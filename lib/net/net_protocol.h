@@ -0,0 +1,206 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_NET_PROTOCOL_H
+#define INCLUDED_OSMOSDR_NET_PROTOCOL_H
+
+#include <stdint.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <osmosdr/ranges.h>
+
+/*
+ * UDP protocol between osmosdr_server and net_source_c.
+ *
+ * Every datagram starts with a net_header_t, in the byte order of the
+ * host like the samples; the server and its clients have to agree on it.
+ *
+ * A client sends NET_SUBSCRIBE to the server port and repeats it as a
+ * keepalive at least every NET_KEEPALIVE_MS, or the server stops sending
+ * to it after NET_EXPIRE_MS. The server answers every subscription with
+ * NET_INFO and then sends every client the same NET_DATA datagrams, each
+ * encoded once. With multicast the data goes to the group only, clients
+ * then join the group and subscribe with NET_FLAG_MULTICAST for NET_INFO
+ * and to use NET_SET.
+ *
+ * NET_DATA carries nitems samples in the format of the header, the first
+ * of them at stream index sample. seq counts the datagrams, session
+ * changes whenever the server restarts its stream; a client detects lost
+ * datagrams from the gap between the sample index it expected and the one
+ * received.
+ *
+ * NET_INFO and NET_SET carry osmosdr style "key=value,..." text: the
+ * device description and its ranges in NET_INFO, the settings to apply in
+ * NET_SET, which the server answers with NET_INFO.
+ */
+
+#define NET_MAGIC          0x54454e4f /* "ONET" in little endian */
+#define NET_VERSION        1
+#define NET_DEFAULT_PORT   1235
+#define NET_KEEPALIVE_MS   1000
+#define NET_EXPIRE_MS      5000
+#define NET_MAX_DATAGRAM   65507 /* largest IPv4 UDP payload */
+#define NET_DEFAULT_MTU    1472  /* UDP payload fitting 1500 byte Ethernet */
+
+enum net_type_t {
+  NET_DATA = 0,        /**< server to client: samples */
+  NET_INFO = 1,        /**< server to client: device description */
+  NET_SUBSCRIBE = 2,   /**< client to server: subscription and keepalive */
+  NET_UNSUBSCRIBE = 3, /**< client to server: stop sending */
+  NET_SET = 4          /**< client to server: change settings */
+};
+
+enum net_format_t {
+  NET_FC32 = 0,        /**< complex float */
+  NET_CS16 = 1,        /**< signed 16 bit I/Q */
+  NET_CS12 = 2,        /**< packed signed 12 bit I/Q, 3 bytes per sample */
+  NET_CS8 = 3,         /**< signed 8 bit I/Q */
+  NET_CU8 = 4          /**< unsigned 8 bit I/Q, as rtl_tcp */
+};
+
+#define NET_FLAG_MULTICAST 0x01 /**< NET_SUBSCRIBE: receiving from the group */
+#define NET_FLAG_READONLY  0x02 /**< NET_INFO: NET_SET is ignored */
+
+struct net_header_t
+{
+  uint32_t magic;
+  uint8_t version;
+  uint8_t type;        /**< net_type_t */
+  uint8_t format;      /**< net_format_t of the payload */
+  uint8_t flags;
+  uint32_t session;    /**< changes with every stream the server starts */
+  uint32_t seq;        /**< NET_DATA: datagram counter of the session */
+  uint64_t sample;     /**< NET_DATA: stream index of the first sample */
+  double rate;         /**< sample rate of the device */
+  double freq;         /**< center frequency of the device */
+  uint32_t nitems;     /**< NET_DATA: samples, otherwise text bytes */
+  uint32_t reserved;
+};
+
+static_assert( sizeof(net_header_t) == 48, "net_header_t must not be padded" );
+
+inline net_header_t net_make_header( net_type_t type )
+{
+  net_header_t hdr;
+  memset( &hdr, 0, sizeof(hdr) );
+  hdr.magic = NET_MAGIC;
+  hdr.version = NET_VERSION;
+  hdr.type = type;
+  return hdr;
+}
+
+/*! false if len bytes at data are no datagram of this protocol */
+inline bool net_parse_header( const void *data, size_t len, net_header_t &hdr )
+{
+  if ( len < sizeof(hdr) )
+    return false;
+
+  memcpy( &hdr, data, sizeof(hdr) );
+
+  return NET_MAGIC == hdr.magic && NET_VERSION == hdr.version;
+}
+
+/*! bytes per complex sample of format, 0 if unknown */
+inline size_t net_item_size( int format )
+{
+  switch ( format ) {
+  case NET_FC32: return 8;
+  case NET_CS16: return 4;
+  case NET_CS12: return 3;
+  case NET_CS8:  return 2;
+  case NET_CU8:  return 2;
+  default:       return 0;
+  }
+}
+
+inline const char *net_format_name( int format )
+{
+  switch ( format ) {
+  case NET_FC32: return "fc32";
+  case NET_CS16: return "cs16";
+  case NET_CS12: return "cs12";
+  case NET_CS8:  return "cs8";
+  case NET_CU8:  return "cu8";
+  default:       return "unknown";
+  }
+}
+
+/*! the net_format_t of a cpu_format or format= name, -1 if unknown */
+inline int net_format_from_name( const std::string &name )
+{
+  if ( "fc32" == name )
+    return NET_FC32;
+  if ( "cs16" == name || "sc16" == name )
+    return NET_CS16;
+  if ( "cs12" == name )
+    return NET_CS12;
+  if ( "cs8" == name || "sc8" == name )
+    return NET_CS8;
+  if ( "cu8" == name )
+    return NET_CU8;
+  return -1;
+}
+
+/*! a range list as "start/stop/step:start/stop/step..." for NET_INFO */
+inline std::string net_format_ranges( const osmosdr::meta_range_t &ranges )
+{
+  std::string text;
+
+  for (const osmosdr::range_t &range : ranges) {
+    if ( text.size() )
+      text += ":";
+    text += boost::lexical_cast< std::string >( range.start() ) + "/" +
+            boost::lexical_cast< std::string >( range.stop() ) + "/" +
+            boost::lexical_cast< std::string >( range.step() );
+  }
+
+  return text;
+}
+
+/*! the inverse of net_format_ranges() */
+inline osmosdr::meta_range_t net_parse_ranges( const std::string &text )
+{
+  osmosdr::meta_range_t ranges;
+
+  std::vector< std::string > items;
+  boost::algorithm::split( items, text, boost::is_any_of( ":" ),
+                           boost::token_compress_on );
+
+  for (const std::string &item : items) {
+    std::vector< std::string > values;
+    boost::algorithm::split( values, item, boost::is_any_of( "/" ) );
+    if ( values.size() != 3 )
+      continue;
+
+    ranges.push_back( osmosdr::range_t( boost::lexical_cast< double >( values[0] ),
+                                        boost::lexical_cast< double >( values[1] ),
+                                        boost::lexical_cast< double >( values[2] ) ) );
+  }
+
+  return ranges;
+}
+
+#endif /* INCLUDED_OSMOSDR_NET_PROTOCOL_H */
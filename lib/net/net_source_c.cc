@@ -0,0 +1,708 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <gnuradio/io_signature.h>
+
+#include "net_source_c.h"
+#include "sample_convert.h"
+
+#define RING_SIZE       (16 * 1024 * 1024) /* bytes, in the format work() returns */
+#define DEFAULT_RCVBUF  (4 * 1024 * 1024)  /* bytes of socket receive buffer */
+#define DEFAULT_TIMEOUT 2.0                /* seconds to wait for the server */
+#define REPLY_MS        500                /* to wait for the answer to NET_SET */
+#define RECV_TIMEOUT_MS 100
+#define UDP_BATCH       16                 /* datagrams fetched per receive call */
+
+net_source_c_sptr make_net_source_c(const std::string &args)
+{
+  return gnuradio::get_initial_sptr(new net_source_c(args));
+}
+
+static std::vector< std::string > native_formats()
+{
+  std::vector< std::string > formats;
+  formats.push_back("cs16");
+  formats.push_back("cs8");
+  formats.push_back("cu8");
+  return formats;
+}
+
+net_source_c::net_source_c(const std::string &args) :
+  gr::sync_block("net_source_c",
+                 gr::io_signature::make(0, 0, 0),
+                 gr::io_signature::make(1, 1,
+                                        cpu_format_item_size( args_to_cpu_format( args, native_formats() ) ))),
+  _sock(-1),
+  _host("127.0.0.1"),
+  _port(NET_DEFAULT_PORT),
+  _multicast(false),
+  _format(-1),
+  _info_count(0),
+  _readonly(false),
+  _rate(0),
+  _freq(0),
+  _resync(true),
+  _session(0),
+  _seq(0),
+  _expected(0),
+  _format_warned(false),
+  _running(false),
+  _streaming(false),
+  _tuning(args)
+{
+  dict_t dict = params_to_dict(args);
+
+  _stats.set_quiet( args_to_quiet( args ) );
+
+  _cpu_format = args_to_cpu_format( args, native_formats() );
+  _item_size = cpu_format_item_size( _cpu_format );
+  _native = ( "fc32" != _cpu_format );
+
+  /* all item sizes are powers of two, so items never wrap in the ring */
+  _ring.configure( args, _item_size );
+
+  if (dict.count("net")) {
+    std::vector< std::string > tokens;
+    boost::algorithm::split( tokens, dict["net"], boost::is_any_of(":") );
+
+    if ( tokens[0].length() && (tokens.size() == 1 || tokens.size() == 2 ) )
+      _host = tokens[0];
+
+    if ( tokens.size() == 2 ) // port given
+      _port = boost::lexical_cast< unsigned short >( tokens[1] );
+  }
+
+  std::string group;
+  unsigned short group_port = _port;
+
+  if (dict.count("multicast")) {
+    std::vector< std::string > tokens;
+    boost::algorithm::split( tokens, dict["multicast"], boost::is_any_of(":") );
+
+    group = tokens[0];
+    if ( tokens.size() == 2 )
+      group_port = boost::lexical_cast< unsigned short >( tokens[1] );
+
+    _multicast = true;
+  }
+
+  double timeout = DEFAULT_TIMEOUT;
+  if (dict.count("timeout"))
+    timeout = boost::lexical_cast< double >( dict["timeout"] );
+
+  int rcvbuf = DEFAULT_RCVBUF;
+  if (dict.count("rcvbuf"))
+    rcvbuf = boost::lexical_cast< int >( dict["rcvbuf"] );
+
+  struct addrinfo hints, *res;
+  memset( &hints, 0, sizeof(hints) );
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+
+  if ( getaddrinfo( _host.c_str(), NULL, &hints, &res ) != 0 )
+    throw std::runtime_error( "Failed to resolve osmosdr server " + _host );
+
+  memcpy( &_server, res->ai_addr, sizeof(_server) );
+  _server.sin_port = htons( _port );
+  freeaddrinfo( res );
+
+  if ( (_sock = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP )) < 0 )
+    throw std::runtime_error( std::string("Failed to create UDP socket: ") + strerror(errno) );
+
+  struct sockaddr_in local;
+  memset( &local, 0, sizeof(local) );
+  local.sin_family = AF_INET;
+  local.sin_addr.s_addr = htonl( INADDR_ANY );
+
+  if ( _multicast ) {
+    int reuse = 1;
+    setsockopt( _sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse) );
+    local.sin_port = htons( group_port );
+  }
+
+  if ( setsockopt( _sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf) ) < 0 )
+    std::cerr << "Failed to set the UDP receive buffer size" << std::endl;
+
+  struct timeval tv = { 0, RECV_TIMEOUT_MS * 1000 };
+  setsockopt( _sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv) );
+
+  if ( bind( _sock, (struct sockaddr *)&local, sizeof(local) ) < 0 ) {
+    close( _sock );
+    throw std::runtime_error( std::string("Failed to bind UDP socket: ") + strerror(errno) );
+  }
+
+  if ( _multicast ) {
+    struct ip_mreq mreq;
+    memset( &mreq, 0, sizeof(mreq) );
+    mreq.imr_interface.s_addr = htonl( INADDR_ANY );
+
+    if ( inet_pton( AF_INET, group.c_str(), &mreq.imr_multiaddr ) != 1 ||
+         setsockopt( _sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq) ) < 0 ) {
+      close( _sock );
+      throw std::runtime_error( "Failed to join multicast group " + group );
+    }
+  }
+
+  _tuning.allocate( [this] { _ring.resize( RING_SIZE ); } );
+
+  _running = true;
+  _thread = std::thread( &net_source_c::receive_task, this );
+
+  /* an empty NET_SET only asks for NET_INFO, repeated in case it got lost */
+  bool described = false;
+  for (double waited = 0; ! described && waited < timeout; waited += REPLY_MS / 1000.0)
+    described = request( "" );
+
+  if ( ! described ) {
+    _running = false;
+    _thread.join();
+    close( _sock );
+    throw std::runtime_error( "No osmosdr server answering at " + _host + ":" +
+                              boost::lexical_cast< std::string >( _port ) );
+  }
+
+  if ( ! net_item_size( _format ) ||
+       ( _native && net_format_from_name( _cpu_format ) != _format ) ) {
+    _running = false;
+    _thread.join();
+    close( _sock );
+    throw std::runtime_error( "cpu_format '" + _cpu_format + "' does not match the " +
+                              net_format_name( _format ) + " samples of the server" );
+  }
+
+  std::cerr << "Using " << name() << " at " << _host << ":" << _port
+            << ", " << net_format_name( _format ) << " samples" << std::endl;
+}
+
+net_source_c::~net_source_c()
+{
+  stop();
+
+  _running = false;
+  if ( _thread.joinable() )
+    _thread.join();
+
+  close( _sock );
+}
+
+bool net_source_c::start()
+{
+  if ( _streaming )
+    return true;
+
+  _ring.clear();
+  _ring.resume();
+  _tagger.reset();
+  _resync = true;
+
+  _streaming = true;
+  send_message( NET_SUBSCRIBE, _multicast ? NET_FLAG_MULTICAST : 0 );
+
+  return true;
+}
+
+bool net_source_c::stop()
+{
+  if ( ! _streaming )
+    return true;
+
+  _streaming = false;
+  send_message( NET_UNSUBSCRIBE );
+  _ring.interrupt();
+
+  return true;
+}
+
+void net_source_c::send_message( uint8_t type, uint8_t flags, const std::string &text )
+{
+  std::vector< unsigned char > msg( sizeof(net_header_t) + text.size() );
+
+  net_header_t hdr = net_make_header( net_type_t(type) );
+  hdr.flags = flags;
+  hdr.nitems = text.size();
+
+  memcpy( &msg[0], &hdr, sizeof(hdr) );
+  memcpy( &msg[sizeof(hdr)], text.data(), text.size() );
+
+  sendto( _sock, &msg[0], msg.size(), 0,
+          (const struct sockaddr *)&_server, sizeof(_server) );
+}
+
+/* send settings to the server, true once it described the device again */
+bool net_source_c::request( const std::string &settings )
+{
+  std::unique_lock< std::mutex > lock( _info_mutex );
+  const uint64_t count = _info_count;
+
+  if ( settings.size() && _readonly )
+    std::cerr << "The osmosdr server at " << _host << ":" << _port
+              << " is read-only, ignoring " << settings << std::endl;
+
+  send_message( NET_SET, 0, settings );
+
+  return _info_cond.wait_for( lock, std::chrono::milliseconds( REPLY_MS ),
+                              [&] { return _info_count != count; } );
+}
+
+/* take the datagrams of the server and keep the subscription alive */
+void net_source_c::receive_task()
+{
+  _tuning.apply();
+
+  std::vector< unsigned char > data( UDP_BATCH * NET_MAX_DATAGRAM );
+  std::chrono::steady_clock::time_point keepalive = std::chrono::steady_clock::now();
+
+#ifdef __linux__
+  struct iovec iov[UDP_BATCH];
+  struct mmsghdr msgs[UDP_BATCH];
+
+  memset( msgs, 0, sizeof(msgs) );
+
+  for ( size_t i = 0; i < UDP_BATCH; i++ )
+  {
+    iov[i].iov_base = &data[i * NET_MAX_DATAGRAM];
+    iov[i].iov_len = NET_MAX_DATAGRAM;
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+#endif
+
+  while ( _running )
+  {
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if ( _streaming && now - keepalive > std::chrono::milliseconds( NET_KEEPALIVE_MS ) ) {
+      send_message( NET_SUBSCRIBE, _multicast ? NET_FLAG_MULTICAST : 0 );
+      keepalive = now;
+    }
+
+#ifdef __linux__
+    /* block for the first datagram only, then take what is queued */
+    int count = recvmmsg( _sock, msgs, UDP_BATCH, MSG_WAITFORONE, NULL );
+    if ( count < 0 )
+    {
+      if ( EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno )
+      {
+        std::cerr << "recvmmsg failed: " << strerror(errno) << std::endl;
+        break;
+      }
+
+      continue;
+    }
+
+    for ( int i = 0; i < count; i++ )
+      handle_datagram( &data[i * NET_MAX_DATAGRAM], msgs[i].msg_len );
+#else
+    ssize_t rx_bytes = recv( _sock, &data[0], NET_MAX_DATAGRAM, 0 );
+    if ( rx_bytes < 0 )
+    {
+      if ( EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno )
+      {
+        std::cerr << "recv failed: " << strerror(errno) << std::endl;
+        break;
+      }
+
+      continue;
+    }
+
+    handle_datagram( &data[0], rx_bytes );
+#endif
+  }
+
+  /* let work() return instead of waiting for samples that won't come */
+  _running = false;
+  _ring.interrupt();
+}
+
+void net_source_c::handle_datagram( const unsigned char *data, size_t length )
+{
+  net_header_t hdr;
+
+  if ( ! net_parse_header( data, length, hdr ) )
+    return;
+
+  const unsigned char *payload = data + sizeof(hdr);
+  const size_t payload_len = length - sizeof(hdr);
+
+  if ( NET_INFO == hdr.type && hdr.nitems <= payload_len ) {
+    handle_info( std::string( (const char *)payload, hdr.nitems ), hdr.flags );
+  } else if ( NET_DATA == hdr.type && _streaming ) {
+    if ( hdr.format != _format ) {
+      if ( ! _format_warned )
+        std::cerr << "Ignoring " << net_format_name( hdr.format ) << " samples from "
+                  << _host << ":" << _port << ", expected "
+                  << net_format_name( _format ) << std::endl;
+      _format_warned = true;
+      return;
+    }
+
+    if ( uint64_t( hdr.nitems ) * net_item_size( hdr.format ) <= payload_len )
+      handle_data( hdr, payload );
+  }
+}
+
+void net_source_c::handle_info( const std::string &text, uint8_t flags )
+{
+  dict_t info = params_to_dict( text );
+
+  std::lock_guard< std::mutex > lock( _info_mutex );
+
+  /* the first description fixes the format for the lifetime of the block */
+  if ( _format < 0 )
+    _format = net_format_from_name( info["format"] );
+
+  _info = info;
+  _readonly = flags & NET_FLAG_READONLY;
+
+  if ( info.count("rate") )
+    _rate = boost::lexical_cast< double >( info["rate"] );
+  if ( info.count("freq") )
+    _freq = boost::lexical_cast< double >( info["freq"] );
+
+  _info_count++;
+  _info_cond.notify_all();
+}
+
+void net_source_c::handle_data( const net_header_t &hdr, const unsigned char *payload )
+{
+  /* a new session restarts the sample index */
+  if ( _resync.exchange( false ) || hdr.session != _session ) {
+    _session = hdr.session;
+    _seq = hdr.seq - 1;
+    _expected = hdr.sample;
+    _tagger.retag();
+  }
+
+  /* duplicated or reordered behind a gap already reported */
+  if ( hdr.sample < _expected )
+    return;
+
+  if ( hdr.sample > _expected ) {
+    const uint64_t lost = hdr.sample - _expected;
+
+    if ( ! _stats.quiet() )
+      std::cerr << "Lost " << uint32_t( hdr.seq - _seq - 1 ) << " datagrams from "
+                << _host << ":" << _port << std::endl;
+
+    _stats.lost( lost );
+    _tagger.lost( lost );
+  }
+
+  _seq = hdr.seq;
+  _expected = hdr.sample + hdr.nitems;
+
+  /* another client may have retuned the server */
+  if ( hdr.rate != _rate || hdr.freq != _freq ) {
+    std::lock_guard< std::mutex > lock( _info_mutex );
+
+    if ( hdr.rate != _rate )
+      _tagger.set_rate( hdr.rate );
+    if ( hdr.freq != _freq )
+      _tagger.set_freq( hdr.freq );
+
+    _rate = hdr.rate;
+    _freq = hdr.freq;
+  }
+
+  const size_t stored = store( payload, hdr.nitems );
+
+  _tagger.stored( stored );
+
+  if ( stored < hdr.nitems ) {
+    _ring.commit( 0, (hdr.nitems - stored) * _item_size ); /* account the drop */
+    _tagger.lost( hdr.nitems - stored );
+    _stats.overflow( hdr.nitems - stored );
+  }
+}
+
+/* convert nitems samples of the wire format into the ring */
+size_t net_source_c::store( const unsigned char *in, size_t nitems )
+{
+  const size_t in_size = net_item_size( _format );
+  size_t done = 0;
+
+  while ( done < nitems )
+  {
+    size_t len;
+    unsigned char *span = _ring.write_span( len, (nitems - done) * _item_size );
+
+    const size_t n = std::min( len / _item_size, nitems - done );
+    if ( ! n )
+      break;
+
+    const unsigned char *src = in + done * in_size;
+    gr_complex *out = (gr_complex *)span;
+
+    if ( _native || NET_FC32 == _format )
+      memcpy( span, src, n * _item_size );
+    else if ( NET_CS16 == _format )
+      convert_cs16_fc32_deinterleave( (const int16_t *)src, &out, 1, n, 32768.0f );
+    else if ( NET_CS12 == _format )
+      convert_cs12_fc32( src, out, n );
+    else if ( NET_CS8 == _format )
+      convert_cs8_fc32( (const int8_t *)src, out, n );
+    else
+      convert_cu8_fc32( src, out, n );
+
+    _ring.commit( n * _item_size );
+    done += n;
+  }
+
+  return done;
+}
+
+int net_source_c::work(int noutput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+{
+  unsigned char *out = (unsigned char *)output_items[0];
+  int produced = 0;
+
+  /* never block the scheduler on the network, hand out what we have */
+  if (!_ring.wait_read( _item_size, 100 ))
+    return _streaming && _running ? 0 : WORK_DONE;
+
+  while (noutput_items) {
+    size_t len;
+    const unsigned char *buf = _ring.read_span( len );
+    if ( size_t lost = _ring.discarded() ) {
+      _stats.overflow( lost / _item_size );
+      _tagger.skipped( nitems_written( 0 ) + produced, lost / _item_size );
+    }
+
+    const int nout = std::min(noutput_items, int(len / _item_size));
+
+    if (!nout)
+      break;
+
+    memcpy( out, buf, nout * _item_size );
+    _ring.consume( nout * _item_size );
+
+    out += nout * _item_size;
+    produced += nout;
+    noutput_items -= nout;
+  }
+
+  _tagger.update( this, produced );
+  _stats.delivered( produced );
+
+  return produced;
+}
+
+std::string net_source_c::name()
+{
+  std::lock_guard< std::mutex > lock( _info_mutex );
+  return "osmosdr Network Client (" + _info["name"] + ")";
+}
+
+std::vector<std::string> net_source_c::get_devices( bool fake )
+{
+  std::vector<std::string> devices;
+
+  if ( fake )
+  {
+    std::string args = "net=localhost:" + boost::lexical_cast< std::string >( NET_DEFAULT_PORT );
+    args += ",label='osmosdr Network Server'";
+    devices.push_back( args );
+  }
+
+  return devices;
+}
+
+std::string net_source_c::get_cpu_format( void )
+{
+  return _cpu_format;
+}
+
+size_t net_source_c::get_num_channels( void )
+{
+  return 1;
+}
+
+osmosdr::stream_stats_t net_source_c::get_stream_stats( size_t chan )
+{
+  osmosdr::stream_stats_t stats = _stats.get();
+  stats.high_water = _ring.high_water() / _item_size;
+  stats.fill = _ring.read_available() / _item_size;
+  return stats;
+}
+
+osmosdr::meta_range_t net_source_c::get_sample_rates( void )
+{
+  std::lock_guard< std::mutex > lock( _info_mutex );
+  return net_parse_ranges( _info["rates"] );
+}
+
+double net_source_c::set_sample_rate( double rate )
+{
+  request( "rate=" + boost::lexical_cast< std::string >( rate ) );
+
+  return get_sample_rate();
+}
+
+double net_source_c::get_sample_rate( void )
+{
+  std::lock_guard< std::mutex > lock( _info_mutex );
+  return _rate;
+}
+
+double net_source_c::get_measured_sample_rate( size_t chan )
+{
+  return _tagger.measured_rate();
+}
+
+osmosdr::freq_range_t net_source_c::get_freq_range( size_t chan )
+{
+  std::lock_guard< std::mutex > lock( _info_mutex );
+  return net_parse_ranges( _info["freqs"] );
+}
+
+double net_source_c::set_center_freq( double freq, size_t chan )
+{
+  request( "freq=" + boost::lexical_cast< std::string >( freq ) );
+
+  return get_center_freq( chan );
+}
+
+double net_source_c::get_center_freq( size_t chan )
+{
+  std::lock_guard< std::mutex > lock( _info_mutex );
+  return _freq;
+}
+
+/* osmosdr::stream has no frequency correction to forward it to */
+double net_source_c::set_freq_corr( double ppm, size_t chan )
+{
+  return get_freq_corr( chan );
+}
+
+double net_source_c::get_freq_corr( size_t chan )
+{
+  return 0;
+}
+
+std::vector<std::string> net_source_c::get_gain_names( size_t chan )
+{
+  std::vector< std::string > names;
+  names.push_back( "RF" );
+  return names;
+}
+
+osmosdr::gain_range_t net_source_c::get_gain_range( size_t chan )
+{
+  std::lock_guard< std::mutex > lock( _info_mutex );
+  return net_parse_ranges( _info["gains"] );
+}
+
+osmosdr::gain_range_t net_source_c::get_gain_range( const std::string & name, size_t chan )
+{
+  return get_gain_range( chan );
+}
+
+bool net_source_c::set_gain_mode( bool automatic, size_t chan )
+{
+  request( std::string("gain_mode=") + (automatic ? "1" : "0") );
+
+  return get_gain_mode( chan );
+}
+
+bool net_source_c::get_gain_mode( size_t chan )
+{
+  std::lock_guard< std::mutex > lock( _info_mutex );
+  return "1" == _info["gain_mode"];
+}
+
+double net_source_c::set_gain( double gain, size_t chan )
+{
+  request( "gain=" + boost::lexical_cast< std::string >( gain ) );
+
+  return get_gain( chan );
+}
+
+double net_source_c::set_gain( double gain, const std::string & name, size_t chan )
+{
+  return set_gain( gain, chan );
+}
+
+double net_source_c::get_gain( size_t chan )
+{
+  std::lock_guard< std::mutex > lock( _info_mutex );
+  return _info.count("gain") ? boost::lexical_cast< double >( _info["gain"] ) : 0;
+}
+
+double net_source_c::get_gain( const std::string & name, size_t chan )
+{
+  return get_gain( chan );
+}
+
+std::vector< std::string > net_source_c::get_antennas( size_t chan )
+{
+  std::vector< std::string > antennas;
+  antennas.push_back( get_antenna( chan ) );
+  return antennas;
+}
+
+std::string net_source_c::set_antenna( const std::string & antenna, size_t chan )
+{
+  request( "antenna=" + antenna );
+
+  return get_antenna( chan );
+}
+
+std::string net_source_c::get_antenna( size_t chan )
+{
+  std::lock_guard< std::mutex > lock( _info_mutex );
+  return _info["antenna"];
+}
+
+double net_source_c::set_bandwidth( double bandwidth, size_t chan )
+{
+  request( "bandwidth=" + boost::lexical_cast< std::string >( bandwidth ) );
+
+  return get_bandwidth( chan );
+}
+
+double net_source_c::get_bandwidth( size_t chan )
+{
+  std::lock_guard< std::mutex > lock( _info_mutex );
+  return _info.count("bandwidth") ? boost::lexical_cast< double >( _info["bandwidth"] ) : 0;
+}
@@ -0,0 +1,160 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_NET_SOURCE_C_H
+#define INCLUDED_NET_SOURCE_C_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <netinet/in.h>
+
+#include <gnuradio/sync_block.h>
+
+#include "source_iface.h"
+#include "arg_helpers.h"
+#include "net_protocol.h"
+#include "sample_ring.h"
+#include "rx_tagger.h"
+#include "stream_counters.h"
+#include "thread_tuning.h"
+
+class net_source_c;
+
+typedef boost::shared_ptr< net_source_c > net_source_c_sptr;
+
+net_source_c_sptr make_net_source_c( const std::string & args = "" );
+
+/*!
+ * \brief Client of osmosdr_server, receiving the samples of a device
+ * served on the network.
+ *
+ * A receive thread subscribes to the server while the block is running,
+ * converts the datagrams of the wire format the server chose into the
+ * sample ring and keeps the subscription alive. Lost datagrams show up
+ * as a gap in the sample index of the server and are tagged rx_gap.
+ * The settings are forwarded to the server, which reports the values it
+ * applied; the server may be shared, so other clients may retune it too.
+ */
+class net_source_c :
+    public gr::sync_block,
+    public source_iface
+{
+private:
+  friend net_source_c_sptr make_net_source_c(const std::string &args);
+
+  net_source_c(const std::string &args);
+
+  void send_message( uint8_t type, uint8_t flags = 0,
+                     const std::string &text = "" );
+  bool request( const std::string &settings );
+  void receive_task();
+  void handle_datagram( const unsigned char *data, size_t length );
+  void handle_info( const std::string &text, uint8_t flags );
+  void handle_data( const net_header_t &hdr, const unsigned char *payload );
+  size_t store( const unsigned char *in, size_t nitems );
+
+public:
+  ~net_source_c();
+
+  bool start();
+  bool stop();
+
+  int work(int noutput_items,
+           gr_vector_const_void_star &input_items,
+           gr_vector_void_star &output_items);
+
+  std::string name();
+
+  static std::vector< std::string > get_devices( bool fake = false );
+
+  size_t get_num_channels( void );
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+  std::string get_cpu_format( void );
+
+  osmosdr::meta_range_t get_sample_rates( void );
+  double set_sample_rate( double rate );
+  double get_sample_rate( void );
+  double get_measured_sample_rate( size_t chan = 0 );
+
+  osmosdr::freq_range_t get_freq_range( size_t chan = 0 );
+  double set_center_freq( double freq, size_t chan = 0 );
+  double get_center_freq( size_t chan = 0 );
+  double set_freq_corr( double ppm, size_t chan = 0 );
+  double get_freq_corr( size_t chan = 0 );
+
+  std::vector<std::string> get_gain_names( size_t chan = 0 );
+  osmosdr::gain_range_t get_gain_range( size_t chan = 0 );
+  osmosdr::gain_range_t get_gain_range( const std::string & name, size_t chan = 0 );
+  bool set_gain_mode( bool automatic, size_t chan = 0 );
+  bool get_gain_mode( size_t chan = 0 );
+  double set_gain( double gain, size_t chan = 0 );
+  double set_gain( double gain, const std::string & name, size_t chan = 0 );
+  double get_gain( size_t chan = 0 );
+  double get_gain( const std::string & name, size_t chan = 0 );
+
+  std::vector< std::string > get_antennas( size_t chan = 0 );
+  std::string set_antenna( const std::string & antenna, size_t chan = 0 );
+  std::string get_antenna( size_t chan = 0 );
+
+  double set_bandwidth( double bandwidth, size_t chan = 0 );
+  double get_bandwidth( size_t chan = 0 );
+
+private:
+  int _sock;
+  struct sockaddr_in _server;
+  std::string _host;
+  unsigned short _port;
+  bool _multicast;
+
+  std::string _cpu_format;
+  int _format;                  /**< net_format_t the server sends */
+  size_t _item_size;            /**< bytes per item work() produces */
+  bool _native;                 /**< the items are stored as received */
+
+  /* the device as the last NET_INFO described it */
+  std::mutex _info_mutex;
+  std::condition_variable _info_cond;
+  uint64_t _info_count;
+  dict_t _info;
+  bool _readonly;
+  double _rate;
+  double _freq;
+
+  /* owned by the receive thread */
+  std::atomic<bool> _resync;    /**< start() restarts the sample index */
+  uint32_t _session;
+  uint32_t _seq;
+  uint64_t _expected;           /**< sample index of the next datagram */
+  bool _format_warned;
+
+  sample_ring<unsigned char> _ring;
+  stream_counters _stats;
+  rx_tagger _tagger;
+  std::atomic<bool> _running;   /**< the receive thread */
+  std::atomic<bool> _streaming; /**< start() to stop() */
+  std::thread _thread;
+  thread_tuning _tuning;
+};
+
+#endif // INCLUDED_NET_SOURCE_C_H
@@ -0,0 +1,182 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_POWER_METER_H
+#define INCLUDED_OSMOSDR_POWER_METER_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <gnuradio/block.h>
+
+#include "sample_convert.h"
+#include "burst_gate.h"
+
+/*!
+ * The level of every power_tags=N samples of a source, from what the
+ * *_agc conversion kernels measure while they convert, so a receiver
+ * needs no magnitude and averaging blocks at full rate to monitor it.
+ *
+ * tag() adds an rx_power tag on the last item of each window, a dict of
+ * its mean power and peak in dBFS, the number of I and Q values within 1 %
+ * of full scale and its length. The levels are those of the converted
+ * samples before the software AGC. Belongs to the thread calling work().
+ */
+class power_meter
+{
+public:
+  power_meter() :
+    _len( 0 ),
+    _items( 0 )
+  {
+    reset();
+  }
+
+  void set_length( size_t nitems )
+  {
+    _len = nitems;
+    _windows.reserve( 16 );
+  }
+
+  bool enabled() const { return _len > 0; }
+
+  /*! items to convert at most, for the level to stay within one window */
+  size_t chunk( size_t nitems ) const
+  {
+    return _len ? std::min( nitems, _len - _count ) : nitems;
+  }
+
+  /*! the level of nitems items converted with gain */
+  void add( const sample_level_t &level, size_t nitems, float gain )
+  {
+    _power += double(level.power) / ( double(gain) * gain );
+    _peak = std::max( _peak, level.peak / gain );
+    _clipped += level.clipped;
+    _count += nitems;
+    _items += nitems;
+
+    if ( _count < _len )
+      return;
+
+    const window_t window = { _items, _power / _count, _peak, _clipped };
+    _windows.push_back( window );
+    reset();
+  }
+
+  /*!
+   * Tag the windows closed since the last call. The block produced nitems
+   * in this call, from decim times as many items converted.
+   */
+  void tag( gr::block *block, size_t nitems, size_t decim = 1 )
+  {
+    static const pmt::pmt_t POWER_KEY = pmt::string_to_symbol( "rx_power" );
+
+    if ( _windows.empty() )
+      return;
+
+    const uint64_t first = block->nitems_written( 0 );
+    const uint64_t end = first + nitems;
+
+    for (const window_t &window : _windows) {
+      /* converted items since the end of the window, at the output rate */
+      const uint64_t after = ( _items - window.end ) / decim;
+      const uint64_t offset = after < nitems ? end - after - 1 : first;
+
+      block->add_item_tag( 0, offset, POWER_KEY, level( window, _len / decim ) );
+    }
+
+    _windows.clear();
+  }
+
+  /*!
+   * Tag the windows closed since the last call on the items gate kept of
+   * them, after its apply() in this call. A window stays until the gate
+   * has decided about its last item, and is not tagged if that was
+   * dropped, so the tags always mark the last item of their window.
+   */
+  void tag( gr::block *block, const burst_gate &gate )
+  {
+    static const pmt::pmt_t POWER_KEY = pmt::string_to_symbol( "rx_power" );
+
+    /* the gate counts from its last reset(), every item since is in both */
+    const uint64_t shift = _items - gate.measured();
+    size_t done = 0;
+
+    for (const window_t &window : _windows) {
+      if ( window.end > shift && window.end - shift > gate.decided() )
+        break;
+
+      uint64_t offset;
+      if ( window.end > shift && gate.locate( window.end - shift - 1, offset ) )
+        block->add_item_tag( 0, offset, POWER_KEY, level( window, _len ) );
+      done++;
+    }
+
+    _windows.erase( _windows.begin(), _windows.begin() + done );
+  }
+
+private:
+  struct window_t
+  {
+    uint64_t end;               /**< _items at its end */
+    double power;               /**< mean |x|^2 */
+    float peak;
+    uint64_t clipped;
+  };
+
+  static pmt::pmt_t level( const window_t &window, size_t len )
+  {
+    pmt::pmt_t value = pmt::make_dict();
+    value = pmt::dict_add( value, pmt::intern( "power" ),
+                           pmt::from_double( to_db( window.power, 10.0 ) ) );
+    value = pmt::dict_add( value, pmt::intern( "peak" ),
+                           pmt::from_double( to_db( window.peak, 20.0 ) ) );
+    value = pmt::dict_add( value, pmt::intern( "clipped" ),
+                           pmt::from_uint64( window.clipped ) );
+    value = pmt::dict_add( value, pmt::intern( "len" ),
+                           pmt::from_uint64( len ) );
+    return value;
+  }
+
+  static double to_db( double value, double factor )
+  {
+    return value > 0.0 ? factor * std::log10( value ) : -HUGE_VAL;
+  }
+
+  void reset()
+  {
+    _count = 0;
+    _power = 0.0;
+    _peak = 0.0f;
+    _clipped = 0;
+  }
+
+  size_t _len;
+  size_t _count;                /**< items of the current window */
+  uint64_t _items;              /**< items measured in total */
+  double _power;
+  float _peak;
+  uint64_t _clipped;
+  std::vector< window_t > _windows;
+};
+
+#endif /* INCLUDED_OSMOSDR_POWER_METER_H */
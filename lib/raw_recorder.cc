@@ -0,0 +1,302 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include "arg_helpers.h"
+#include "raw_recorder.h"
+
+#define SIGMF_DATA_EXT ".sigmf-data"
+#define SIGMF_META_EXT ".sigmf-meta"
+
+/* ISO 8601 in UTC as used by core:datetime, 2026-10-14T05:43:00.123456Z */
+static std::string format_datetime( const osmosdr::time_spec_t &time )
+{
+  const time_t secs = time.get_full_secs();
+  struct tm tm;
+  gmtime_r( &secs, &tm );
+
+  char buf[64];
+  snprintf( buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02d.%06dZ",
+            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+            tm.tm_hour, tm.tm_min, tm.tm_sec,
+            std::min( int( time.get_frac_secs() * 1e6 ), 999999 ) );
+
+  return buf;
+}
+
+raw_recorder::raw_recorder() :
+  _sample_size( 2 ),
+  _ring_size( 0 ),
+  _fd( -1 ),
+  _running( false ),
+  _lost( 0 ),
+  _retuned( false ),
+  _freq( 0 ),
+  _rate( 0 ),
+  _samples( 0 ),
+  _dirty( false )
+{
+}
+
+raw_recorder::~raw_recorder()
+{
+  stop();
+
+  if ( _fd >= 0 )
+    ::close( _fd );
+}
+
+void raw_recorder::open( const std::string &path, const std::string &format,
+                         const std::string &args )
+{
+  dict_t dict = params_to_dict( args );
+
+  if ( "cu8" == format ) {
+    _datatype = "cu8";
+    _sample_size = 2;
+  } else if ( "cs8" == format ) {
+    _datatype = "ci8";
+    _sample_size = 2;
+  } else if ( "cs16" == format ) {
+    _datatype = "ci16_le";
+    _sample_size = 4;
+  } else {
+    throw std::runtime_error( "Recording " + format + " samples is not supported." );
+  }
+
+  const std::string ext = SIGMF_DATA_EXT;
+  _data_path = path;
+  if ( path.size() > ext.size() &&
+       0 == path.compare( path.size() - ext.size(), ext.size(), ext ) )
+    _meta_path = path.substr( 0, path.size() - ext.size() ) + SIGMF_META_EXT;
+  else
+    _meta_path = path + SIGMF_META_EXT;
+
+  double mb = RAW_RECORDER_MB;
+  if ( dict.count( "record_mb" ) )
+    mb = boost::lexical_cast< double >( dict["record_mb"] );
+  _ring_size = size_t( std::max( mb, 1.0 ) * 1024 * 1024 );
+
+  _fd = ::open( path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0664 );
+  if ( _fd < 0 )
+    throw std::runtime_error( "Failed to open '" + path + "': " + strerror( errno ) );
+
+  _ring.resize( _ring_size );
+}
+
+void raw_recorder::start( double rate, double freq )
+{
+  if ( _fd < 0 || _running )
+    return;
+
+  _rate = rate;
+  _freq = freq;
+  _retuned = true;              /* the first transfer opens a capture */
+
+  _ring.clear();
+  _ring.resume();
+  _running = true;
+  _thread = std::thread( &raw_recorder::writer, this );
+}
+
+void raw_recorder::stop()
+{
+  if ( ! _running )
+    return;
+
+  /* the writer empties the ring before it returns */
+  _running = false;
+  _ring.interrupt();
+  if ( _thread.joinable() )
+    _thread.join();
+
+  write_meta();
+}
+
+void raw_recorder::set_freq( double freq )
+{
+  _freq = freq;
+  _retuned = true;
+}
+
+void raw_recorder::set_rate( double rate )
+{
+  _rate = rate;
+  _retuned = true;
+}
+
+void raw_recorder::record( const unsigned char *buf, size_t len )
+{
+  const uint64_t lost = _lost.exchange( 0 );
+
+  if ( _retuned.exchange( false ) || lost ) {
+    const double rate = _rate.load();
+
+    /* the buffer just arrived, its first sample a buffer length ago */
+    capture_t capture;
+    capture.sample = _samples;
+    capture.freq = _freq.load();
+    capture.rate = rate;
+    double now = std::chrono::duration< double >(
+                   std::chrono::system_clock::now().time_since_epoch() ).count();
+    if ( rate > 0 )
+      now -= double( len / _sample_size ) / rate;
+    capture.time = osmosdr::time_spec_t( now );
+    capture.lost = lost;
+
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    /* nothing recorded since the last one, e.g. while the ring is full */
+    if ( _captures.size() && _captures.back().sample == capture.sample ) {
+      capture.lost += _captures.back().lost;
+      _captures.back() = capture;
+    } else {
+      _captures.push_back( capture );
+    }
+    _dirty = true;
+  }
+
+  const size_t pushed = _ring.push( buf, len );
+  _samples += pushed / _sample_size;
+
+  /* what did not fit is a gap before the next transfer */
+  if ( pushed < len )
+    _lost.fetch_add( ( len - pushed ) / _sample_size );
+}
+
+void raw_recorder::writer()
+{
+  bool failed = false;
+
+  for (;;) {
+    const bool running = _running.load();
+
+    if ( ! _ring.wait_read( 1, 100 ) && ! running )
+      break;
+
+    size_t len;
+    const unsigned char *span = _ring.read_span( len );
+
+    size_t done = 0;
+    while ( done < len && ! failed ) {
+      const ssize_t n = ::write( _fd, span + done, len - done );
+      if ( n < 0 && EINTR == errno )
+        continue;
+      if ( n <= 0 ) {
+        std::cerr << "Writing the recording '" << _data_path << "' failed: "
+                  << strerror( errno ) << std::endl;
+        failed = true;
+        break;
+      }
+      done += n;
+    }
+    _ring.consume( len );
+
+    bool dirty;
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      dirty = _dirty;
+    }
+    if ( dirty )
+      write_meta();
+
+    if ( ! running && ! _ring.read_available() )
+      break;
+  }
+}
+
+void raw_recorder::write_meta()
+{
+  std::vector< capture_t > captures;
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    captures = _captures;
+    _dirty = false;
+  }
+
+  const double rate = captures.size() ? captures.front().rate : _rate.load();
+
+  std::ostringstream json;
+  json << std::setprecision( 15 );
+  json << "{\n"
+       << "  \"global\": {\n"
+       << "    \"core:datatype\": \"" << _datatype << "\",\n"
+       << "    \"core:sample_rate\": " << rate << ",\n"
+       << "    \"core:version\": \"1.0.0\",\n"
+       << "    \"core:recorder\": \"gr-osmosdr\"\n"
+       << "  },\n"
+       << "  \"captures\": [";
+
+  for (size_t i = 0; i < captures.size(); i++) {
+    const capture_t &c = captures[i];
+
+    json << ( i ? "," : "" ) << "\n    {\n"
+         << "      \"core:sample_start\": " << c.sample << ",\n"
+         << "      \"core:frequency\": " << c.freq << ",\n";
+    if ( c.rate != rate )
+      json << "      \"osmosdr:sample_rate\": " << c.rate << ",\n";
+    if ( c.lost )
+      json << "      \"osmosdr:lost\": " << c.lost << ",\n";
+    json << "      \"core:datetime\": \"" << format_datetime( c.time ) << "\"\n"
+         << "    }";
+  }
+
+  json << "\n  ],\n"
+       << "  \"annotations\": []\n"
+       << "}\n";
+
+  /* replaced in one go, a reader never sees half a sidecar */
+  const std::string tmp = _meta_path + ".tmp";
+  {
+    std::ofstream file( tmp.c_str(), std::ios::trunc );
+    file << json.str();
+    if ( ! file ) {
+      std::cerr << "Writing the recording index '" << _meta_path << "' failed."
+                << std::endl;
+      return;
+    }
+  }
+
+  if ( rename( tmp.c_str(), _meta_path.c_str() ) != 0 )
+    std::cerr << "Writing the recording index '" << _meta_path << "' failed: "
+              << strerror( errno ) << std::endl;
+}
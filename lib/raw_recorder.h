@@ -0,0 +1,139 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_RAW_RECORDER_H
+#define INCLUDED_OSMOSDR_RAW_RECORDER_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <osmosdr/api.h>
+#include <osmosdr/time_spec.h>
+
+#include "sample_ring.h"
+
+/* MiB queued for the writer thread by default, see record_mb */
+#define RAW_RECORDER_MB 64
+
+/*!
+ * The record=path device argument: the transfers of a source as the
+ * device delivers them, cu8, cs8 or cs16, written to disk next to the
+ * normal stream.
+ *
+ * The reader thread of the driver hands every transfer to write(), which
+ * only copies it into a ring of record_mb MiB. A writer thread of its own
+ * moves the ring to the file, so the disk never stalls the reader. What
+ * does not fit into the ring is dropped from the recording and counted
+ * as lost, like the samples the device itself lost.
+ *
+ * A SigMF sidecar goes next to the data, path with .sigmf-data replaced
+ * by .sigmf-meta or path.sigmf-meta otherwise, so the file source plays
+ * the recording back with its format, rate and frequency. Every gap, and
+ * every retune, starts a new capture at the sample following it, with the
+ * host time of that sample as core:datetime and the samples lost before
+ * it as osmosdr:lost. The sidecar is rewritten whenever a capture is
+ * added and when streaming stops.
+ *
+ * open() and close() belong to the driver, start() and stop() to its
+ * start() and stop(), write() and lost() to the reader thread, the
+ * setters may be called from any thread.
+ */
+class OSMOSDR_API raw_recorder
+{
+public:
+  raw_recorder();
+  ~raw_recorder();
+
+  /*!
+   * Record to path in format with record_mb= from args, before streaming.
+   * \throws std::runtime_error if the file cannot be created
+   */
+  void open( const std::string &path, const std::string &format,
+             const std::string &args );
+
+  bool enabled() const { return _fd >= 0; }
+
+  /*! streaming starts at rate and freq, the first transfer opens a capture */
+  void start( double rate, double freq );
+
+  /*! streaming stops, the ring is written out */
+  void stop();
+
+  /*! the next transfer starts a capture at the new frequency */
+  void set_freq( double freq );
+
+  /*! the next transfer starts a capture, noting the new rate */
+  void set_rate( double rate );
+
+  /*! a transfer of len bytes the reader thread just received */
+  void write( const void *buf, size_t len )
+  {
+    if ( _fd >= 0 )
+      record( (const unsigned char *)buf, len );
+  }
+
+  /*! nitems samples were lost by the device right before the next transfer */
+  void lost( uint64_t nitems )
+  {
+    if ( _fd >= 0 )
+      _lost.fetch_add( nitems );
+  }
+
+private:
+  struct capture_t
+  {
+    uint64_t sample;            /**< first sample of the capture in the file */
+    double freq;
+    double rate;
+    osmosdr::time_spec_t time;  /**< host time of that sample */
+    uint64_t lost;              /**< samples lost right before it */
+  };
+
+  void record( const unsigned char *buf, size_t len );
+  void writer();
+  void write_meta();
+
+  std::string _data_path;
+  std::string _meta_path;
+  std::string _datatype;        /**< the SigMF core:datatype */
+  size_t _sample_size;          /**< bytes per sample */
+  size_t _ring_size;
+  int _fd;
+
+  sample_ring< unsigned char > _ring;
+  std::thread _thread;
+  std::atomic<bool> _running;
+
+  std::atomic<uint64_t> _lost;  /**< samples lost since the last transfer */
+  std::atomic<bool> _retuned;   /**< a setting changed since the last transfer */
+  std::atomic<double> _freq;
+  std::atomic<double> _rate;
+  uint64_t _samples;            /**< recorded, of the reader thread */
+
+  std::mutex _mutex;            /**< guards the captures */
+  std::vector< capture_t > _captures;
+  bool _dirty;                  /**< captures not in the sidecar yet */
+};
+
+#endif /* INCLUDED_OSMOSDR_RAW_RECORDER_H */
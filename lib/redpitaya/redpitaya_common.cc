@@ -20,6 +20,7 @@
  */
 
 #include <fstream>
+#include <iostream>
 #include <string>
 #include <sstream>
 #include <stdexcept>
@@ -46,3 +47,33 @@ void redpitaya_send_command( SOCKET socket, uint32_t command )
     throw std::runtime_error( message.str() );
   }
 }
+
+void redpitaya_tune_socket( SOCKET socket, int rcvbuf, int sndbuf )
+{
+  int nodelay = 1;
+
+  if ( rcvbuf > 0 &&
+       setsockopt( socket, SOL_SOCKET, SO_RCVBUF, (char *)&rcvbuf, sizeof(rcvbuf) ) < 0 )
+    std::cerr << "Setting SO_RCVBUF to " << rcvbuf << " failed." << std::endl;
+
+  if ( sndbuf > 0 &&
+       setsockopt( socket, SOL_SOCKET, SO_SNDBUF, (char *)&sndbuf, sizeof(sndbuf) ) < 0 )
+    std::cerr << "Setting SO_SNDBUF to " << sndbuf << " failed." << std::endl;
+
+  if ( setsockopt( socket, IPPROTO_TCP, TCP_NODELAY, (char *)&nodelay, sizeof(nodelay) ) < 0 )
+    std::cerr << "Setting TCP_NODELAY failed." << std::endl;
+}
+
+bool redpitaya_wait_socket( SOCKET socket, bool write, int timeout_ms )
+{
+  fd_set fds;
+  FD_ZERO( &fds );
+  FD_SET( socket, &fds );
+
+  timeval tv;
+  tv.tv_sec = timeout_ms / 1000;
+  tv.tv_usec = ( timeout_ms % 1000 ) * 1000;
+
+  return select( int(socket) + 1, write ? NULL : &fds, write ? &fds : NULL,
+                 NULL, &tv ) > 0;
+}
@@ -29,6 +29,9 @@
 #pragma comment(lib, "ws2_32.lib")
 #include <windows.h>
 #define INVSOC INVALID_SOCKET
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
 #else
 #include <unistd.h>
 #include <fcntl.h>
@@ -37,6 +40,7 @@
 #include <sys/socket.h>
 #include <sys/select.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #ifndef SOCKET
 #define SOCKET int
@@ -50,6 +54,22 @@
 #endif
 #endif
 
+/* bytes of samples buffered between work() and the network thread */
+#define REDPITAYA_RING_SIZE   (16 << 20)
+
+/* kernel socket buffers requested by default, see rcvbuf= and sndbuf= */
+#define REDPITAYA_SOCKET_BUF  (1 << 20)
+
 void redpitaya_send_command( SOCKET socket, uint32_t command );
 
+/*
+ * Sizes the kernel buffers of a socket, where positive, and disables
+ * Nagle's algorithm. Called before connecting, for the TCP window to
+ * follow the receive buffer.
+ */
+void redpitaya_tune_socket( SOCKET socket, int rcvbuf, int sndbuf );
+
+/* wait up to timeout_ms for the socket to become readable or writable */
+bool redpitaya_wait_socket( SOCKET socket, bool write, int timeout_ms );
+
 #endif // REDPITAYA_COMMON_H
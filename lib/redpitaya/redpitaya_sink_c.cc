@@ -19,7 +19,11 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <fstream>
+#include <iostream>
 #include <string>
 #include <sstream>
 #include <stdexcept>
@@ -27,6 +31,8 @@
 #include <boost/assign.hpp>
 #include <boost/format.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include <gnuradio/io_signature.h>
 
@@ -36,6 +42,13 @@
 
 using namespace boost::assign;
 
+/* the queue between work() and the network thread, see buffers= */
+#define CHUNK_SIZE        16384
+#define DEFAULT_CHUNK_NUM 32
+
+/* how long work() waits for the network before dropping samples */
+#define STALL_MS          1000
+
 redpitaya_sink_c_sptr make_redpitaya_sink_c(const std::string &args)
 {
   return gnuradio::get_initial_sptr(new redpitaya_sink_c(args));
@@ -44,7 +57,14 @@ redpitaya_sink_c_sptr make_redpitaya_sink_c(const std::string &args)
 redpitaya_sink_c::redpitaya_sink_c(const std::string &args) :
   gr::sync_block("redpitaya_sink_c",
                  gr::io_signature::make(1, 1, sizeof(gr_complex)),
-                 gr::io_signature::make(0, 0, 0))
+                 gr::io_signature::make(0, 0, 0)),
+  _sndbuf(0),
+  _chunk_num(DEFAULT_CHUNK_NUM),
+  _have_cur(false),
+  _stalled(false),
+  _running(false),
+  _failed(false),
+  _tuning(args)
 {
   std::string host = "192.168.1.100";
   std::stringstream message;
@@ -78,6 +98,14 @@ redpitaya_sink_c::redpitaya_sink_c(const std::string &args) :
   if ( dict.count("ptt") )
     ptt = boost::lexical_cast< unsigned short >( dict["ptt"] );
 
+  if ( dict.count( "sndbuf" ) )
+    _sndbuf = boost::lexical_cast< int >( dict["sndbuf"] );
+
+  if ( dict.count( "buffers" ) )
+    _chunk_num = std::max< size_t >( boost::lexical_cast< size_t >( dict["buffers"] ), 2 );
+
+  _stats.set_quiet( args_to_quiet( args ) );
+
   if ( !host.length() )
     host = "192.168.1.100";
 
@@ -96,6 +124,8 @@ redpitaya_sink_c::redpitaya_sink_c(const std::string &args) :
     inet_pton( AF_INET, host.c_str(), &addr.sin_addr );
     addr.sin_port = htons( port );
 
+    redpitaya_tune_socket( _sockets[i], 0, i ? _sndbuf : 0 );
+
     if ( ::connect( _sockets[i], (struct sockaddr *)&addr, sizeof(addr) ) < 0 )
     {
       message << "Could not connect to " << host << ":" << port << ".";
@@ -108,10 +138,18 @@ redpitaya_sink_c::redpitaya_sink_c(const std::string &args) :
 
   command = ptt ? 2<<28 : 3<<28;
   redpitaya_send_command( _sockets[0], command );
+
+  _tuning.allocate( [this] {
+    _storage.assign( _chunk_num * CHUNK_SIZE );
+    _full.resize( _chunk_num );
+    _free.resize( _chunk_num );
+  } );
 }
 
 redpitaya_sink_c::~redpitaya_sink_c()
 {
+  stop();
+
 #if defined(_WIN32)
   ::closesocket( _sockets[1] );
   ::closesocket( _sockets[0] );
@@ -122,28 +160,157 @@ redpitaya_sink_c::~redpitaya_sink_c()
 #endif
 }
 
-int redpitaya_sink_c::work( int noutput_items,
-                            gr_vector_const_void_star &input_items,
-                            gr_vector_void_star &output_items )
+bool redpitaya_sink_c::start()
+{
+  if ( _running )
+    return true;
+
+  _full.clear();
+  _full.resume();
+  _free.clear();
+
+  for (size_t i = 0; i < _chunk_num; i++) {
+    chunk c = { &_storage[i * CHUNK_SIZE], 0 };
+    _free.push( &c, 1 );
+  }
+
+  _have_cur = false;
+  _stalled = false;
+  _failed = false;
+  _running = true;
+  _thread = gr::thread::thread( boost::bind( &redpitaya_sink_c::send_task, this ) );
+
+  return true;
+}
+
+bool redpitaya_sink_c::stop()
 {
-  const gr_complex *in = (const gr_complex *)input_items[0];
+  if ( ! _running )
+    return true;
+
+  /* hand over the partially filled chunk, then let the thread drain */
+  if ( _have_cur && _cur.len )
+    _full.push( &_cur, 1 );
+  _have_cur = false;
+
+  _running = false;
+  _full.interrupt();
+  _thread.join();
+
+  return true;
+}
+
+/*
+ * Sends the queued chunks over the data socket. After stop() interrupted
+ * _full, wait_read() keeps returning true until every chunk is sent, or
+ * the socket stays blocked for a while.
+ */
+void redpitaya_sink_c::send_task()
+{
+  _tuning.apply();
+
+  chunk c;
+
+  while ( _full.wait_read( 1 ) ) {
+    _full.pop( &c, 1 );
+
+    size_t sent = 0;
+
+    while ( sent < c.len && ! _failed ) {
+      if ( ! redpitaya_wait_socket( _sockets[1], true, 100 ) ) {
+        if ( ! _running )
+          break;
+        continue;
+      }
 
 #if defined(_WIN32)
-  int size;
-  int total = sizeof(gr_complex) * noutput_items;
-  size = ::send( _sockets[1], (char *)in, total, 0 );
+      int size = ::send( _sockets[1], (char *)c.data + sent, int(c.len - sent), 0 );
 #else
-  ssize_t size;
-  ssize_t total = sizeof(gr_complex) * noutput_items;
-  size = ::send( _sockets[1], in, total, MSG_NOSIGNAL );
+      ssize_t size = ::send( _sockets[1], c.data + sent, c.len - sent, MSG_NOSIGNAL );
+
+      if ( size < 0 && errno == EINTR )
+        continue;
 #endif
 
-  if ( size != total )
+      if ( size <= 0 ) {
+        std::cerr << "Sending samples failed." << std::endl;
+        _failed = true;
+        break;
+      }
+
+      sent += size;
+    }
+
+    _free.push( &c, 1 );
+
+    if ( _failed )
+      break;
+  }
+}
+
+/*
+ * Takes the next chunk for work(), waiting up to STALL_MS for the network
+ * thread to return one. Once that timed out, work() drops samples right
+ * away until a chunk is free again.
+ */
+bool redpitaya_sink_c::next_free()
+{
+  if ( _free.pop( &_cur, 1 ) != 1 ) {
+    if ( _stalled )
+      return false;
+
+    for (int waited = 0; ! _free.wait_read( 1, 100 ); waited += 100) {
+      boost::this_thread::interruption_point();
+
+      if ( _failed || waited >= STALL_MS ) {
+        _stalled = true;
+        return false;
+      }
+    }
+
+    _free.pop( &_cur, 1 );
+  }
+
+  _cur.len = 0;
+  _have_cur = true;
+  _stalled = false;
+
+  return true;
+}
+
+int redpitaya_sink_c::work( int noutput_items,
+                            gr_vector_const_void_star &input_items,
+                            gr_vector_void_star &output_items )
+{
+  const unsigned char *in = (const unsigned char *)input_items[0];
+  const size_t total = sizeof(gr_complex) * noutput_items;
+  size_t done = 0;
+
+  if ( _failed )
     throw std::runtime_error( "Sending samples failed." );
 
-  consume(0, noutput_items);
+  while ( done < total ) {
+    if ( ! _have_cur && ! next_free() ) {
+      _stats.overflow( ( total - done ) / sizeof(gr_complex) );
+      break;
+    }
+
+    const size_t len = std::min( CHUNK_SIZE - _cur.len, total - done );
 
-  return 0;
+    memcpy( _cur.data + _cur.len, in + done, len );
+    _cur.len += len;
+    done += len;
+
+    if ( _cur.len == CHUNK_SIZE ) {
+      _full.push( &_cur, 1 );
+      _have_cur = false;
+      _stats.fill_level( _full.read_available() * ( CHUNK_SIZE / sizeof(gr_complex) ) );
+    }
+  }
+
+  _stats.delivered( done / sizeof(gr_complex) );
+
+  return noutput_items;
 }
 
 std::string redpitaya_sink_c::name()
@@ -170,6 +337,13 @@ size_t redpitaya_sink_c::get_num_channels( void )
   return 1;
 }
 
+osmosdr::stream_stats_t redpitaya_sink_c::get_stream_stats( size_t chan )
+{
+  osmosdr::stream_stats_t stats = _stats.get();
+  stats.fill = _full.read_available() * ( CHUNK_SIZE / sizeof(gr_complex) );
+  return stats;
+}
+
 osmosdr::meta_range_t redpitaya_sink_c::get_sample_rates( void )
 {
   osmosdr::meta_range_t range;
@@ -21,11 +21,18 @@
 #ifndef REDPITAYA_SINK_C_H
 #define REDPITAYA_SINK_C_H
 
+#include <atomic>
+#include <vector>
+
 #include <gnuradio/sync_block.h>
+#include <gnuradio/thread/thread.h>
 
 #include "sink_iface.h"
 
 #include "redpitaya_common.h"
+#include "sample_ring.h"
+#include "stream_counters.h"
+#include "thread_tuning.h"
 
 class redpitaya_sink_c;
 
@@ -45,6 +52,9 @@ private:
 public:
   ~redpitaya_sink_c();
 
+  bool start();
+  bool stop();
+
   int work( int noutput_items,
             gr_vector_const_void_star &input_items,
             gr_vector_void_star &output_items );
@@ -54,6 +64,7 @@ public:
   static std::vector< std::string > get_devices( bool fake = false );
 
   size_t get_num_channels( void );
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
@@ -78,8 +89,32 @@ public:
   std::string get_antenna( size_t chan = 0 );
 
 private:
+  struct chunk
+  {
+    unsigned char *data;
+    size_t len;
+  };
+
+  void send_task();
+  bool next_free();
+
   double _freq, _rate, _corr;
   SOCKET _sockets[2];
+  int _sndbuf;
+
+  size_t _chunk_num;
+  pooled_buffer<unsigned char> _storage;
+  sample_ring<chunk> _full;     /**< chunks queued for the network thread */
+  sample_ring<chunk> _free;     /**< chunks available to work() */
+  chunk _cur;                   /**< chunk work() is filling */
+  bool _have_cur;
+  bool _stalled;                /**< no chunk came back in time, drop */
+
+  stream_counters _stats;
+  std::atomic<bool> _running;
+  std::atomic<bool> _failed;
+  gr::thread::thread _thread;
+  thread_tuning _tuning;
 };
 
 #endif // REDPITAYA_SINK_C_H
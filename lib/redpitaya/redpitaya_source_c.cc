@@ -19,7 +19,11 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <fstream>
+#include <iostream>
 #include <string>
 #include <sstream>
 #include <stdexcept>
@@ -27,6 +31,8 @@
 #include <boost/assign.hpp>
 #include <boost/format.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include <gnuradio/io_signature.h>
 
@@ -44,7 +50,11 @@ redpitaya_source_c_sptr make_redpitaya_source_c(const std::string &args)
 redpitaya_source_c::redpitaya_source_c(const std::string &args) :
   gr::sync_block("redpitaya_source_c",
                  gr::io_signature::make(0, 0, 0),
-                 gr::io_signature::make(1, 1, sizeof(gr_complex)))
+                 gr::io_signature::make(1, 1, sizeof(gr_complex))),
+  _rcvbuf(REDPITAYA_SOCKET_BUF),
+  _running(false),
+  _failed(false),
+  _tuning(args)
 {
   std::string host = "192.168.1.100";
   std::stringstream message;
@@ -75,6 +85,12 @@ redpitaya_source_c::redpitaya_source_c(const std::string &args) :
       port = boost::lexical_cast< unsigned short >( tokens[1] );
   }
 
+  if ( dict.count( "rcvbuf" ) )
+    _rcvbuf = boost::lexical_cast< int >( dict["rcvbuf"] );
+
+  _stats.set_quiet( args_to_quiet( args ) );
+  _ring.configure( args, sizeof(gr_complex) );
+
   if ( !host.length() )
     host = "192.168.1.100";
 
@@ -91,6 +107,9 @@ redpitaya_source_c::redpitaya_source_c(const std::string &args) :
     inet_pton( AF_INET, host.c_str(), &addr.sin_addr );
     addr.sin_port = htons( port );
 
+    /* the large receive window is for the data socket */
+    redpitaya_tune_socket( _sockets[i], i ? _rcvbuf : 0, 0 );
+
     if ( ::connect( _sockets[i], (struct sockaddr *)&addr, sizeof(addr) ) < 0 )
     {
       message << "Could not connect to " << host << ":" << port << ".";
@@ -100,10 +119,15 @@ redpitaya_source_c::redpitaya_source_c(const std::string &args) :
     command = i;
     redpitaya_send_command( _sockets[i], command );
   }
+
+  _scratch.assign( 65536 );
+  _tuning.allocate( [this] { _ring.resize( REDPITAYA_RING_SIZE ); } );
 }
 
 redpitaya_source_c::~redpitaya_source_c()
 {
+  stop();
+
 #if defined(_WIN32)
   ::closesocket( _sockets[1] );
   ::closesocket( _sockets[0] );
@@ -114,26 +138,116 @@ redpitaya_source_c::~redpitaya_source_c()
 #endif
 }
 
-int redpitaya_source_c::work( int noutput_items,
-                              gr_vector_const_void_star &input_items,
-                              gr_vector_void_star &output_items )
+bool redpitaya_source_c::start()
 {
-  gr_complex *out = (gr_complex *)output_items[0];
+  if ( _running )
+    return true;
+
+  _ring.clear();
+  _ring.resume();
+
+  _failed = false;
+  _running = true;
+  _thread = gr::thread::thread( boost::bind( &redpitaya_source_c::receive_task, this ) );
+
+  return true;
+}
+
+bool redpitaya_source_c::stop()
+{
+  if ( ! _running )
+    return true;
+
+  _running = false;
+  _ring.interrupt();
+  _thread.join();
+
+  return true;
+}
+
+/*
+ * Drains the data socket into the ring. A stalled work() shows up as
+ * overflows while the socket keeps being read, a network error ends the
+ * stream once work() handed out what was received before.
+ */
+void redpitaya_source_c::receive_task()
+{
+  _tuning.apply();
+
+  while ( _running ) {
+    if ( ! redpitaya_wait_socket( _sockets[1], false, 100 ) )
+      continue;
+
+    size_t len;
+    unsigned char *buf = _ring.write_span( len, _scratch.size() );
+    bool dropping = false;
+
+    if ( ! len ) {
+      buf = &_scratch[0];
+      len = _scratch.size();
+      dropping = true;
+    }
 
 #if defined(_WIN32)
-  int size;
-  int total = sizeof(gr_complex) * noutput_items;
-  size = ::recv( _sockets[1], (char *)out, total, MSG_WAITALL );
+    int size = ::recv( _sockets[1], (char *)buf, int(len), 0 );
 #else
-  ssize_t size;
-  ssize_t total = sizeof(gr_complex) * noutput_items;
-  size = ::recv( _sockets[1], out, total, MSG_WAITALL );
+    ssize_t size = ::recv( _sockets[1], buf, len, 0 );
+
+    if ( size < 0 && errno == EINTR )
+      continue;
 #endif
 
-  if ( size != total )
-    throw std::runtime_error( "Receiving samples failed." );
+    if ( size <= 0 ) {
+      std::cerr << "Receiving samples failed." << std::endl;
+      _failed = true;
+      _ring.interrupt();
+      break;
+    }
 
-  return noutput_items;
+    if ( dropping ) {
+      _ring.commit( 0, size );
+      _stats.overflow( size / sizeof(gr_complex) );
+    } else {
+      _ring.commit( size );
+    }
+  }
+}
+
+int redpitaya_source_c::work( int noutput_items,
+                              gr_vector_const_void_star &input_items,
+                              gr_vector_void_star &output_items )
+{
+  unsigned char *out = (unsigned char *)output_items[0];
+  const size_t total = sizeof(gr_complex) * noutput_items;
+  size_t done = 0;
+
+  /* never block the scheduler on the network, hand out what we have */
+  if ( ! _ring.wait_read( sizeof(gr_complex), 100 ) ) {
+    if ( _failed )
+      throw std::runtime_error( "Receiving samples failed." );
+    return 0;
+  }
+
+  /* the ring wraps at a multiple of the item size */
+  while ( done < total ) {
+    size_t len;
+    const unsigned char *buf = _ring.read_span( len );
+    if ( size_t lost = _ring.discarded() )
+      _stats.overflow( lost / sizeof(gr_complex) );
+
+    len = std::min( len, total - done ) / sizeof(gr_complex) * sizeof(gr_complex);
+
+    if ( ! len )
+      break;
+
+    memcpy( out + done, buf, len );
+    _ring.consume( len );
+    done += len;
+  }
+
+  _stats.delivered( done / sizeof(gr_complex) );
+
+  return done / sizeof(gr_complex);
 }
 
 std::string redpitaya_source_c::name()
@@ -160,6 +274,14 @@ size_t redpitaya_source_c::get_num_channels( void )
   return 1;
 }
 
+osmosdr::stream_stats_t redpitaya_source_c::get_stream_stats( size_t chan )
+{
+  osmosdr::stream_stats_t stats = _stats.get();
+  stats.high_water = _ring.high_water() / sizeof(gr_complex);
+  stats.fill = _ring.read_available() / sizeof(gr_complex);
+  return stats;
+}
+
 osmosdr::meta_range_t redpitaya_source_c::get_sample_rates( void )
 {
   osmosdr::meta_range_t range;
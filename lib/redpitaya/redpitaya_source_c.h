@@ -21,11 +21,18 @@
 #ifndef REDPITAYA_SOURCE_C_H
 #define REDPITAYA_SOURCE_C_H
 
+#include <atomic>
+#include <vector>
+
 #include <gnuradio/sync_block.h>
+#include <gnuradio/thread/thread.h>
 
 #include "source_iface.h"
 
 #include "redpitaya_common.h"
+#include "sample_ring.h"
+#include "stream_counters.h"
+#include "thread_tuning.h"
 
 class redpitaya_source_c;
 
@@ -45,6 +52,9 @@ private:
 public:
   ~redpitaya_source_c();
 
+  bool start();
+  bool stop();
+
   int work( int noutput_items,
             gr_vector_const_void_star &input_items,
             gr_vector_void_star &output_items );
@@ -54,6 +64,7 @@ public:
   static std::vector< std::string > get_devices( bool fake = false );
 
   size_t get_num_channels( void );
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
@@ -78,8 +89,19 @@ public:
   std::string get_antenna( size_t chan = 0 );
 
 private:
+  void receive_task();
+
   double _freq, _rate, _corr;
   SOCKET _sockets[2];
+  int _rcvbuf;
+
+  sample_ring<unsigned char> _ring;
+  pooled_buffer<unsigned char> _scratch;  /**< receives what a full ring drops */
+  stream_counters _stats;
+  std::atomic<bool> _running;
+  std::atomic<bool> _failed;
+  gr::thread::thread _thread;
+  thread_tuning _tuning;
 };
 
 #endif // REDPITAYA_SOURCE_C_H
@@ -43,6 +43,7 @@
 #include <libgen.h> /* basename */
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -56,6 +57,7 @@
 #include <gnuradio/io_signature.h>
 
 #include "arg_helpers.h"
+#include "sample_convert.h"
 #include "rfspace_source_c.h"
 
 using namespace boost::assign;
@@ -63,6 +65,10 @@ using namespace boost::assign;
 #define DEFAULT_HOST  "127.0.0.1" /* We assume a running "siqs" from CuteSDR project */
 #define DEFAULT_PORT  50000
 
+#define DEFAULT_RCVBUF  (4 * 1024 * 1024) /* bytes of socket receive buffer */
+#define UDP_BATCH       32 /* datagrams fetched per receive call */
+#define UDP_MAX_SIZE    2048 /* largest datagram we expect from a radio */
+
 /*
  * Create a new instance of rfspace_source_c and return
  * a boost shared_ptr.  This is effectively the public constructor.
@@ -100,16 +106,23 @@ rfspace_source_c::rfspace_source_c (const std::string &args)
     _running(false),
     _keep_running(false),
     _sequence(0),
+    _24bit(false),
     _nchan(1),
     _sample_rate(NAN),
     _bandwidth(0.0f),
-    _fifo(NULL)
+    _run_usb_read_task(false),
+    _run_udp_read_task(false),
+    _fifo(0),
+    _resp_count(0),
+    _tuning(args)
 {
   std::string host = "";
   unsigned short port = 0;
 
   dict_t dict = params_to_dict(args);
 
+  _stats.set_quiet( args_to_quiet( args ) );
+
   if ( dict.count("sdr-iq") )
     dict["rfspace"] = dict["sdr-iq"];
 
@@ -167,6 +180,19 @@ rfspace_source_c::rfspace_source_c (const std::string &args)
   if ( _nchan < 1 || _nchan > 2 )
     throw std::runtime_error("Number of channels (nchan) must be 1 or 2");
 
+  _tagger.set_num_channels( _nchan );
+  _fifo.configure( args, _nchan );
+
+  if (dict.count("bits"))
+  {
+    unsigned int bits = boost::lexical_cast< unsigned int >( dict["bits"] );
+
+    if ( 16 != bits && 24 != bits )
+      throw std::runtime_error("Sample size (bits) must be 16 or 24");
+
+    _24bit = ( 24 == bits );
+  }
+
   if ( ! host.length() )
     host = DEFAULT_HOST;
 
@@ -210,9 +236,7 @@ rfspace_source_c::rfspace_source_c (const std::string &args)
 
     _radio = RFSPACE_SDR_IQ; /* legitimate assumption */
 
-    _fifo = new boost::circular_buffer<gr_complex>( 200000 );
-    if ( ! _fifo )
-      throw std::runtime_error( "Failed to allocate sample FIFO" );
+    _tuning.allocate( [this] { _fifo.resize( 200000 ); } );
 
     _run_usb_read_task = true;
 
@@ -287,6 +311,31 @@ rfspace_source_c::rfspace_source_c (const std::string &args)
     sockoptval = 1;
     setsockopt(_udp, SOL_SOCKET, SO_REUSEADDR, &sockoptval, sizeof(int));
 
+    /* a large receive buffer rides out scheduling hiccups of the reader */
+    int rcvbuf = DEFAULT_RCVBUF;
+    if ( dict.count("rcvbuf") )
+      rcvbuf = boost::lexical_cast< int >( dict["rcvbuf"] );
+
+    setsockopt(_udp, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(int));
+
+    int actual = 0;
+    socklen_t optlen = sizeof(actual);
+    getsockopt(_udp, SOL_SOCKET, SO_RCVBUF, &actual, &optlen);
+
+#ifdef __linux__
+    actual /= 2; /* the kernel reports twice the size for bookkeeping */
+#endif
+    if ( actual < rcvbuf )
+      std::cerr << "UDP receive buffer limited to " << actual << " bytes "
+                << "instead of " << rcvbuf << ", consider raising "
+                << "net.core.rmem_max" << std::endl;
+
+    /* let the reader task check for shutdown periodically */
+    struct timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = 100000;
+    setsockopt(_udp, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
     /* fill in the hosts's address and data */
     memset(&host_sa, 0, sizeof(host_sa));
     host_sa.sin_family = AF_INET;
@@ -444,6 +493,12 @@ rfspace_source_c::rfspace_source_c (const std::string &args)
   {
     _run_tcp_keepalive_task = true;
     _thread = gr::thread::thread( boost::bind(&rfspace_source_c::tcp_keepalive_task, this) );
+
+    /* holds about half a second of samples at the highest NetSDR rate */
+    _tuning.allocate( [this] { _fifo.resize( _nchan * 1024 * 1024 ); } );
+
+    _run_udp_read_task = true;
+    _udp_thread = gr::thread::thread( boost::bind(&rfspace_source_c::udp_read_task, this) );
   }
 
 #if 0
@@ -465,12 +520,21 @@ rfspace_source_c::rfspace_source_c (const std::string &args)
  */
 rfspace_source_c::~rfspace_source_c ()
 {
+  if ( _run_udp_read_task )
+  {
+    _run_udp_read_task = false;
+    _fifo.interrupt();
+
+    _udp_thread.join();
+  }
+
   close(_tcp);
   close(_udp);
 
   if ( RFSPACE_SDR_IQ == _radio )
   {
     _run_usb_read_task = false;
+    _fifo.interrupt();
 
     _thread.join();
   }
@@ -482,12 +546,6 @@ rfspace_source_c::~rfspace_source_c ()
   }
 
   close(_usb);
-
-  if ( _fifo )
-  {
-    delete _fifo;
-    _fifo = NULL;
-  }
 }
 
 void rfspace_source_c::apply_channel( unsigned char *cmd, size_t chan )
@@ -542,21 +600,30 @@ bool rfspace_source_c::transaction( const unsigned char *cmd, size_t size,
   printf("\n");
 #endif
 
+  /* the keepalive and the setters may ask concurrently */
+  std::lock_guard<std::mutex> transact(_tcp_lock);
+
   if ( RFSPACE_SDR_IQ == _radio )
   {
+    /* the reader thread hands over the response, which may well arrive
+     * before we wait, and never delays the samples for us */
+    std::unique_lock<std::mutex> lock(_resp_lock);
+    const uint64_t count = _resp_count;
+    lock.unlock();
+
     if ( write(_usb, cmd, size) != (int)size )
       return false;
 
-    std::unique_lock<std::mutex> lock(_resp_lock);
-    _resp_avail.wait(lock);
+    lock.lock();
+    if ( ! _resp_avail.wait_for( lock, std::chrono::seconds(1),
+                                 [&]{ return _resp_count != count; } ) )
+      return false;
 
-    rx_bytes = _resp.size();
+    rx_bytes = std::min( _resp.size(), sizeof(data) );
     memcpy( data, _resp.data(), rx_bytes );
   }
   else
   {
-    std::lock_guard<std::mutex> lock(_tcp_lock);
-
     if ( write(_tcp, cmd, size) != (int)size )
       return false;
 
@@ -614,7 +681,8 @@ static size_t read_bytes( int fd, char *data, size_t size, bool &run )
 void rfspace_source_c::usb_read_task()
 {
   char data[1024*10];
-  size_t n_avail, to_copy;
+
+  _tuning.apply();
 
   if ( -1 == _usb )
     return;
@@ -648,41 +716,36 @@ void rfspace_source_c::usb_read_task()
 
     if ( 1024*8 == length )
     {
-      /* push samples into the fifo */
-
-      _fifo_lock.lock();
+      /* convert samples straight into the fifo */
 
       size_t num_samples = length / 4;
-      n_avail = _fifo->capacity() - _fifo->size();
-      to_copy = (n_avail < num_samples ? n_avail : num_samples);
-
-      #define SCALE_16  (1.0f/32768.0f)
+      size_t to_copy = 0;
 
-      int16_t *sample = (int16_t *)(data + 2);
+      const int16_t *sample = (const int16_t *)(data + 2);
 
-      for ( size_t i = 0; i < to_copy; i++ )
+      while ( to_copy < num_samples )
       {
-        /* Push sample to the fifo */
-        _fifo->push_back( gr_complex( *(sample+0) * SCALE_16,
-                                      *(sample+1) * SCALE_16 ) );
+        size_t n_avail;
+        gr_complex *out = _fifo.write_span( n_avail, num_samples - to_copy );
 
-        /* offset to the next I+Q sample */
-        sample += 2;
-      }
-
-      #undef SCALE_16
+        n_avail = std::min( n_avail, num_samples - to_copy );
+        if ( ! n_avail )
+          break;
 
-      _fifo_lock.unlock();
+        convert_cs16_fc32_deinterleave( sample + to_copy * 2, &out, 1, n_avail, 32768.0f );
 
-      /* We have made some new samples available to the consumer in work() */
-      if (to_copy) {
-//        std::cerr << "+" << std::flush;
-        _samp_avail.notify_one();
+        _fifo.commit( n_avail );
+        to_copy += n_avail;
       }
 
+      _tagger.stored( to_copy );
+
       /* Indicate overrun, if neccesary */
-      if (to_copy < num_samples)
-        std::cerr << "O" << std::flush;
+      if (to_copy < num_samples) {
+        _fifo.commit( 0, num_samples - to_copy ); /* account the drop */
+        _tagger.lost( num_samples - to_copy );
+        _stats.overflow( num_samples - to_copy );
+      }
     }
     else
     {
@@ -693,6 +756,7 @@ void rfspace_source_c::usb_read_task()
       _resp.clear();
       _resp.resize( length + 2 );
       memcpy( _resp.data(), data, length + 2 );
+      _resp_count++;
 
       _resp_lock.unlock();
 
@@ -723,6 +787,9 @@ bool rfspace_source_c::start()
   _running = true;
   _keep_running = false;
 
+  _fifo.resume();
+  _tagger.retag();
+
   /* SDR-IP 4.2.1 Receiver State */
   /* NETSDR 4.2.1 Receiver State */
   unsigned char start[] = { 0x08, 0x00, 0x18, 0x00, 0x80, 0x02, 0x00, 0x00 };
@@ -733,7 +800,7 @@ bool rfspace_source_c::start()
 
   unsigned char mode = 0; /* 0 = 16 bit Contiguous Mode */
 
-  if ( 0 ) /* TODO: 24 bit Contiguous mode */
+  if ( _24bit && RFSPACE_SDR_IQ != _radio ) /* 24 bit Contiguous mode */
     mode |= 0x80;
 
   if ( 0 ) /* TODO: Hardware Triggered Pulse mode */
@@ -746,13 +813,12 @@ bool rfspace_source_c::start()
 
 bool rfspace_source_c::stop()
 {
-  if ( ! _keep_running )
+  if ( ! _keep_running ) {
     _running = false;
+    _fifo.interrupt();
+  }
   _keep_running = false;
 
-  if ( _fifo )
-    _fifo->clear();
-
   /* SDR-IP 4.2.1 Receiver State */
   /* NETSDR 4.2.1 Receiver State */
   unsigned char stop[] = { 0x08, 0x00, 0x18, 0x00, 0x00, 0x01, 0x00, 0x00 };
@@ -769,8 +835,6 @@ int rfspace_source_c::work( int noutput_items,
                            gr_vector_const_void_star &input_items,
                            gr_vector_void_star &output_items )
 {
-  unsigned char data[1024*2];
-
   if ( ! _running )
     return WORK_DONE;
 
@@ -780,56 +844,167 @@ int rfspace_source_c::work( int noutput_items,
     {
       gr_complex *out = (gr_complex *)output_items[0];
 
-      std::unique_lock<std::mutex> lock(_fifo_lock);
-
       /* Wait until we have the requested number of samples */
-      int n_samples_avail = _fifo->size();
+      if ( ! _fifo.wait_read( noutput_items ) )
+        return WORK_DONE;
+
+      size_t lost;
+      _fifo.pop( out, noutput_items, &lost );
+      if ( lost ) {
+        _stats.overflow( lost );
+        _tagger.skipped( nitems_written( 0 ), lost );
+      }
 
-      while ( n_samples_avail < noutput_items )
-      {
-        _samp_avail.wait(lock);
-        n_samples_avail = _fifo->size();
+//      std::cerr << "-" << std::flush;
+    }
+
+    _tagger.update( this, noutput_items );
+    _stats.delivered( noutput_items );
+
+    return noutput_items;
+  }
+
+  /* network radios, the reader task has queued the channel multiplex */
+  if ( ! _fifo.wait_read( _nchan ) )
+    return WORK_DONE;
+
+  size_t nitems = std::min( _fifo.read_available() / _nchan,
+                            size_t(noutput_items) );
+
+  if ( 1 == _nchan )
+  {
+    size_t lost;
+    _fifo.pop( (gr_complex *)output_items[0], nitems, &lost );
+    if ( lost ) {
+      _stats.overflow( lost );
+      _tagger.skipped( nitems_written( 0 ), lost );
+    }
+  }
+  else
+  {
+    gr_complex *out1 = (gr_complex *)output_items[0];
+    gr_complex *out2 = (gr_complex *)output_items[1];
+
+    for ( size_t i = 0; i < nitems; )
+    {
+      size_t len;
+      const gr_complex *span = _fifo.read_span( len );
+      if ( size_t lost = _fifo.discarded() ) {
+        _stats.overflow( lost / 2 );
+        _tagger.skipped( nitems_written( 0 ) + i, lost / 2 );
       }
 
-      for ( int i = 0; i < noutput_items; ++i )
+      /* the ring holds whole sample pairs, so spans are of even length */
+      len = std::min( len / 2, nitems - i );
+
+      for ( size_t j = 0; j < len; j++, i++ )
       {
-        out[i] = _fifo->at(0);
-        _fifo->pop_front();
+        out1[i] = span[2*j + 0];
+        out2[i] = span[2*j + 1];
       }
 
-//      std::cerr << "-" << std::flush;
+      _fifo.consume( len * 2 );
     }
+  }
 
-    return noutput_items;
+  _tagger.update( this, nitems );
+  _stats.delivered( nitems );
+
+  return nitems;
+}
+
+/* receive data packets from networked radios and queue their samples */
+void rfspace_source_c::udp_read_task()
+{
+  _tuning.apply();
+
+  std::vector< unsigned char > data( UDP_BATCH * UDP_MAX_SIZE );
+  struct sockaddr_in sa_in[UDP_BATCH];
+
+#ifdef __linux__
+  struct iovec iov[UDP_BATCH];
+  struct mmsghdr msgs[UDP_BATCH];
+
+  memset( msgs, 0, sizeof(msgs) );
+
+  for ( size_t i = 0; i < UDP_BATCH; i++ )
+  {
+    iov[i].iov_base = &data[i * UDP_MAX_SIZE];
+    iov[i].iov_len = UDP_MAX_SIZE;
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_name = &sa_in[i];
   }
+#endif
 
-  struct sockaddr_in sa_in;           /* remote address */
-  socklen_t addrlen = sizeof(sa_in);  /* length of addresses */
-  ssize_t rx_bytes = recvfrom(_udp, data, sizeof(data), 0, (struct sockaddr *)&sa_in, &addrlen);
-  if ( rx_bytes <= 0 )
+  while ( _run_udp_read_task )
   {
-    std::cerr << "recvfrom returned " << rx_bytes << std::endl;
-    return WORK_DONE;
+#ifdef __linux__
+    for ( size_t i = 0; i < UDP_BATCH; i++ )
+      msgs[i].msg_hdr.msg_namelen = sizeof(sa_in[i]);
+
+    /* block for the first datagram only, then take what is queued */
+    int count = recvmmsg( _udp, msgs, UDP_BATCH, MSG_WAITFORONE, NULL );
+    if ( count < 0 )
+    {
+      if ( EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno )
+      {
+        std::cerr << "recvmmsg failed: " << strerror(errno) << std::endl;
+        break;
+      }
+
+      continue;
+    }
+
+    for ( int i = 0; i < count; i++ )
+      handle_datagram( &data[i * UDP_MAX_SIZE], msgs[i].msg_len, sa_in[i] );
+#else
+    socklen_t addrlen = sizeof(sa_in[0]);
+    ssize_t rx_bytes = recvfrom( _udp, &data[0], UDP_MAX_SIZE, 0,
+                                 (struct sockaddr *)&sa_in[0], &addrlen );
+    if ( rx_bytes < 0 )
+    {
+      if ( EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno )
+      {
+        std::cerr << "recvfrom failed: " << strerror(errno) << std::endl;
+        break;
+      }
+
+      continue;
+    }
+
+    handle_datagram( &data[0], rx_bytes, sa_in[0] );
+#endif
   }
 
+  /* let work() return instead of waiting for samples that won't come */
+  _fifo.interrupt();
+}
+
+void rfspace_source_c::handle_datagram( const unsigned char *data,
+                                        ssize_t length,
+                                        const struct sockaddr_in &sa_in )
+{
   #define HEADER_SIZE 2
   #define SEQNUM_SIZE 2
 
-//  bool is_24_bit = false;   // TODO: implement 24 bit sample format
+  bool is_24_bit = false;
+
+  if ( length < HEADER_SIZE + SEQNUM_SIZE )
+    return;
 
   /* check header */
   if ( (0x04 == data[0] && (0x84 == data[1] || 0x82 == data[1])) )
   {
-//    is_24_bit = false;
+    is_24_bit = false;
   }
   else if ( (0xA4 == data[0] && 0x85 == data[1]) ||
             (0x84 == data[0] && 0x81 == data[1]) )
   {
-//    is_24_bit = true;
-    return 0;
+    is_24_bit = true;
   }
   else
-    return 0;
+    return;
 
   uint16_t sequence = *((uint16_t *)(data + HEADER_SIZE));
 
@@ -837,54 +1012,61 @@ int rfspace_source_c::work( int noutput_items,
 
   if ( diff > 1 )
   {
-    std::cerr << "Lost " << diff << " packets from "
-              << inet_ntoa(sa_in.sin_addr) << ":" << ntohs(sa_in.sin_port)
-              << std::endl;
+    if ( ! _stats.quiet() )
+      std::cerr << "Lost " << diff << " packets from "
+                << inet_ntoa(sa_in.sin_addr) << ":" << ntohs(sa_in.sin_port)
+                << std::endl;
   }
 
   _sequence = (0xffff == sequence) ? 0 : sequence;
 
   /* get pointer to samples */
-  int16_t *sample = (int16_t *)(data + HEADER_SIZE + SEQNUM_SIZE);
+  const unsigned char *sample = data + HEADER_SIZE + SEQNUM_SIZE;
+  size_t sample_size = is_24_bit ? 6 : 4;
 
-  size_t rx_samples = (rx_bytes - HEADER_SIZE - SEQNUM_SIZE) / (sizeof(int16_t) * 2);
+  /* queue whole sample pairs of all channels */
+  size_t rx_samples = (length - HEADER_SIZE - SEQNUM_SIZE) / sample_size;
+  rx_samples -= rx_samples % _nchan;
 
-  #define SCALE_16  (1.0f/32768.0f)
+  if ( diff > 1 ) { /* assuming the lost packets were of the same size */
+    _stats.lost( (diff - 1) * (rx_samples / _nchan) );
+    _tagger.lost( (diff - 1) * (rx_samples / _nchan) );
+  }
 
-  if ( 1 == _nchan )
-  {
-    gr_complex *out = (gr_complex *)output_items[0];
-    for ( size_t i = 0; i < rx_samples; i++ )
-    {
-      out[i] = gr_complex( *(sample+0) * SCALE_16,
-                           *(sample+1) * SCALE_16 );
+  #undef SEQNUM_SIZE
+  #undef HEADER_SIZE
 
-      sample += 2;
-    }
-  }
-  else if ( 2 == _nchan )
+  size_t to_copy = 0;
+
+  while ( to_copy < rx_samples )
   {
-    rx_samples /= 2;
+    size_t n_avail;
+    gr_complex *out = _fifo.write_span( n_avail, rx_samples - to_copy );
 
-    gr_complex *out1 = (gr_complex *)output_items[0];
-    gr_complex *out2 = (gr_complex *)output_items[1];
-    for ( size_t i = 0; i < rx_samples; i++ )
-    {
-      out1[i] = gr_complex( *(sample+0) * SCALE_16,
-                            *(sample+1) * SCALE_16 );
+    n_avail = std::min( n_avail, rx_samples - to_copy );
+    if ( ! n_avail )
+      break;
 
-      out2[i] = gr_complex( *(sample+2) * SCALE_16,
-                            *(sample+3) * SCALE_16 );
+    /* the multiplex is converted as a single stream, work() splits it */
+    if ( is_24_bit )
+      convert_cs24_fc32( sample + sample_size * to_copy, out, n_avail );
+    else
+      convert_cs16_fc32_deinterleave( (const int16_t *)(sample + sample_size * to_copy),
+                                      &out, 1, n_avail, 32768.0f );
 
-      sample += 4;
-    }
+    _fifo.commit( n_avail );
+    to_copy += n_avail;
   }
 
-  #undef SCALE_16
+  _tagger.stored( to_copy / _nchan );
 
-  noutput_items = rx_samples;
-
-  return noutput_items;
+  /* Indicate overrun, if neccesary */
+  if ( to_copy < rx_samples )
+  {
+    _fifo.commit( 0, rx_samples - to_copy ); /* account the drop */
+    _tagger.lost( (rx_samples - to_copy) / _nchan );
+    _stats.overflow( (rx_samples - to_copy) / _nchan );
+  }
 }
 
 /* discovery protocol internals taken from CuteSDR project */
@@ -1199,6 +1381,14 @@ size_t rfspace_source_c::get_num_channels()
   return _nchan;
 }
 
+osmosdr::stream_stats_t rfspace_source_c::get_stream_stats( size_t chan )
+{
+  osmosdr::stream_stats_t stats = _stats.get();
+  stats.high_water = _fifo.high_water() / _nchan;
+  stats.fill = _fifo.read_available() / _nchan;
+  return stats;
+}
+
 #define NETSDR_MAX_RATE  2e6  /* same for SDR-IP & NETSDR */
 #define NETSDR_ADC_CLOCK 80e6 /* same for SDR-IP & NETSDR */
 #define SDR_IQ_ADC_CLOCK 66666667 /* SDR-IQ 5.2.4 I/Q Data Output Sample Rate */
@@ -1319,6 +1509,7 @@ double rfspace_source_c::set_sample_rate( double rate )
   u32_rate |= response[sizeof(samprate)-1] << 24;
 
   _sample_rate = u32_rate;
+  _tagger.set_rate( _sample_rate );
 
   if ( rate != _sample_rate )
     std::cerr << "Radio reported a sample rate of " << (uint32_t)_sample_rate << " Hz"
@@ -1332,6 +1523,11 @@ double rfspace_source_c::get_sample_rate()
   return _sample_rate;
 }
 
+double rfspace_source_c::get_measured_sample_rate( size_t chan )
+{
+  return _tagger.measured_rate();
+}
+
 osmosdr::freq_range_t rfspace_source_c::get_freq_range( size_t chan )
 {
   osmosdr::freq_range_t range;
@@ -1395,7 +1591,10 @@ double rfspace_source_c::set_center_freq( double freq, size_t chan )
 
   transaction( tune, sizeof(tune) );
 
-  return get_center_freq( chan );
+  freq = get_center_freq( chan );
+  _tagger.set_freq( freq, chan );
+
+  return freq;
 }
 
 double rfspace_source_c::get_center_freq( size_t chan )
@@ -24,13 +24,15 @@
 #include <gnuradio/block.h>
 #include <gnuradio/sync_block.h>
 
-#include <boost/circular_buffer.hpp>
-
 #include <mutex>
 #include <condition_variable>
 
 #include "osmosdr/ranges.h"
 #include "source_iface.h"
+#include "sample_ring.h"
+#include "rx_tagger.h"
+#include "stream_counters.h"
+#include "thread_tuning.h"
 class rfspace_source_c;
 
 #ifndef SOCKET
@@ -83,10 +85,12 @@ public:
   static std::vector< std::string > get_devices( bool fake = false );
 
   size_t get_num_channels( void );
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
   double get_sample_rate( void );
+  double get_measured_sample_rate( size_t chan = 0 );
 
   osmosdr::freq_range_t get_freq_range( size_t chan = 0 );
   double set_center_freq( double freq, size_t chan = 0 );
@@ -121,8 +125,12 @@ private: /* functions */
                     std::vector< unsigned char > &response );
 
   void usb_read_task();
+  void udp_read_task();
   void tcp_keepalive_task();
 
+  void handle_datagram( const unsigned char *data, ssize_t length,
+                        const struct sockaddr_in &sa_in );
+
 private: /* members */
   enum radio_type
   {
@@ -141,23 +149,29 @@ private: /* members */
   bool _running;
   bool _keep_running;
   uint16_t _sequence;
+  bool _24bit;
 
   size_t _nchan;
   double _sample_rate;
   double _bandwidth;
 
   gr::thread::thread _thread;
+  gr::thread::thread _udp_thread;
   bool _run_usb_read_task;
+  bool _run_udp_read_task;
   bool _run_tcp_keepalive_task;
-  std::mutex _tcp_lock;
+  std::mutex _tcp_lock;          /**< one transaction at a time */
 
-  boost::circular_buffer<gr_complex> *_fifo;
-  std::mutex _fifo_lock;
-  std::condition_variable _samp_avail;
+  sample_ring<gr_complex> _fifo;
+  rx_tagger _tagger;
+  stream_counters _stats;
 
   std::vector< unsigned char > _resp;
+  uint64_t _resp_count;          /**< responses received, see _resp_avail */
   std::mutex _resp_lock;
   std::condition_variable _resp_avail;
+
+  thread_tuning _tuning;
 };
 
 #endif /* INCLUDED_RFSPACE_SOURCE_C_H */
@@ -0,0 +1,195 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <stdexcept>
+
+#include "rtl_decimator.h"
+
+/*
+ * Kaiser windowed half-band kernels in Q15, named by their length. Only
+ * the taps at odd distances from the center (0.5) are listed, they sum up
+ * to a quarter so the DC gain is exactly one. The stage running at the
+ * highest rate gets the widest transition band, the last /2 before the
+ * output passes 80% of its Nyquist band with about 70 dB of rejection.
+ */
+#define KERNEL_CENTER 16384
+
+static const int32_t KERNEL_7[] = { 9235, -1043 };
+static const int32_t KERNEL_11[] = { 9928, -2131, 395 };
+static const int32_t KERNEL_15[] = { 9805, -1957, 358, -14 };
+static const int32_t KERNEL_47[] = { 10364, -3284, 1778, -1086, 682, -422,
+                                     252, -141, 72, -32, 11, -2 };
+
+/*
+ * Filter and decimate the fill samples of buf by 2 into out, returning the
+ * number of output samples. Output j is centered on input 2 j + ntaps / 2,
+ * the result is (acc - bias) >> shift, rounded.
+ */
+template <typename T>
+static size_t halfband( const T *buf, size_t fill, const int32_t *taps,
+                        size_t ntaps, int32_t bias, int shift, int32_t *out )
+{
+  if ( fill < ntaps )
+    return 0;
+
+  const size_t nout = (fill - ntaps) / 2 + 1;
+  const size_t nodd = (ntaps + 1) / 4;
+  const int32_t offset = (1 << (shift - 1)) - bias;
+
+  for ( size_t j = 0; j < nout; j++ ) {
+    const T *c = buf + 2 * (2 * j + ntaps / 2);
+
+    int32_t acc_i = KERNEL_CENTER * int32_t(c[0]);
+    int32_t acc_q = KERNEL_CENTER * int32_t(c[1]);
+
+    for ( size_t k = 0; k < nodd; k++ ) {
+      const ptrdiff_t d = 2 * (2 * k + 1);
+      acc_i += taps[k] * (int32_t(c[-d]) + int32_t(c[d]));
+      acc_q += taps[k] * (int32_t(c[1 - d]) + int32_t(c[1 + d]));
+    }
+
+    out[2 * j] = (acc_i + offset) >> shift;
+    out[2 * j + 1] = (acc_q + offset) >> shift;
+  }
+
+  return nout;
+}
+
+rtl_decimator::rtl_decimator() :
+  _decim(1),
+  _pending(0),
+  _raw_fill(0)
+{
+}
+
+void rtl_decimator::set_decimation( unsigned int decim )
+{
+  if ( decim < 1 || decim > 64 || (decim & (decim - 1)) )
+    throw std::runtime_error( "Unsupported decimation, must be 1, 2, 4, 8, 16, 32 or 64" );
+
+  _decim = decim;
+  _stages.clear();
+
+  for ( unsigned int remaining = decim; remaining > 1; remaining /= 2 )
+  {
+    stage_t stage;
+    stage.fill = 0;
+
+    switch ( remaining ) {
+    case 2:  stage.taps = KERNEL_47; stage.ntaps = 47; break;
+    case 4:  stage.taps = KERNEL_15; stage.ntaps = 15; break;
+    case 8:  stage.taps = KERNEL_11; stage.ntaps = 11; break;
+    default: stage.taps = KERNEL_7;  stage.ntaps = 7;  break;
+    }
+
+    _stages.push_back( stage );
+  }
+
+  reset();
+}
+
+void rtl_decimator::reset()
+{
+  _pending = 0;
+
+  if ( _stages.empty() )
+    return;
+
+  /* ntaps - 2 samples of history, so two more inputs make an output */
+  _raw_fill = _stages[0].ntaps - 2;
+  _raw.assign( 2 * _raw_fill, 128 );
+
+  for ( size_t i = 1; i < _stages.size(); i++ ) {
+    stage_t &stage = _stages[i];
+    stage.fill = stage.ntaps - 2;
+    stage.buf.assign( 2 * stage.fill, 0 );
+  }
+}
+
+size_t rtl_decimator::process( const uint8_t *in, size_t nitems, gr_complex *out )
+{
+  if ( _stages.empty() ) {
+    for ( size_t i = 0; i < nitems; i++ )
+      out[i] = gr_complex( (in[2 * i] - 127.4f) * (1.0f / 128.0f),
+                           (in[2 * i + 1] - 127.4f) * (1.0f / 128.0f) );
+    return nitems;
+  }
+
+  _pending = (_pending + nitems) % _decim;
+
+  _raw.resize( 2 * (_raw_fill + nitems) );
+  memcpy( &_raw[2 * _raw_fill], in, 2 * nitems );
+  _raw_fill += nitems;
+
+  /* the first stage maps x to 2 (2 x - 255): its DC gain 2^15 less 13 bits */
+  const stage_t &first = _stages[0];
+  size_t n;
+
+  {
+    stage_t *next = _stages.size() > 1 ? &_stages[1] : NULL;
+    std::vector<int32_t> &dst = next ? next->buf : _out;
+    const size_t at = next ? next->fill : 0;
+
+    dst.resize( 2 * (at + (_raw_fill + 1) / 2) );
+    n = halfband( _raw.data(), _raw_fill, first.taps, first.ntaps,
+                  255 << 14, 13, &dst[2 * at] );
+
+    memmove( _raw.data(), &_raw[4 * n], 2 * (_raw_fill - 2 * n) );
+    _raw_fill -= 2 * n;
+
+    if ( next )
+      next->fill += n;
+  }
+
+  /* each stage filters straight into the input area of the next one */
+  for ( size_t i = 1; i < _stages.size(); i++ ) {
+    stage_t &stage = _stages[i];
+    stage_t *next = i + 1 < _stages.size() ? &_stages[i + 1] : NULL;
+    std::vector<int32_t> &dst = next ? next->buf : _out;
+    const size_t at = next ? next->fill : 0;
+
+    dst.resize( 2 * (at + (stage.fill + 1) / 2) );
+    n = halfband( stage.buf.data(), stage.fill, stage.taps, stage.ntaps,
+                  0, 14, &dst[2 * at] );
+
+    memmove( stage.buf.data(), &stage.buf[4 * n], 4 * 2 * (stage.fill - 2 * n) );
+    stage.fill -= 2 * n;
+
+    if ( next )
+      next->fill += n;
+  }
+
+  /* (x - 127.5) / 128, grown by a bit per stage, and the rest of 127.4 */
+  const float scale = 1.0f / float(256 << _stages.size());
+  const float offset = 0.1f / 128.0f;
+
+  for ( size_t i = 0; i < n; i++ )
+    out[i] = gr_complex( _out[2 * i] * scale + offset,
+                         _out[2 * i + 1] * scale + offset );
+
+  return n;
+}
@@ -0,0 +1,79 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_RTL_DECIMATOR_H
+#define INCLUDED_RTL_DECIMATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include <gnuradio/gr_complex.h>
+
+/*!
+ * Cascade of decimate-by-2 half-band stages running in integer arithmetic
+ * straight on the unsigned 8 bit I/Q samples of the RTL2832U, so only the
+ * decimated stream is ever converted to complex float.
+ *
+ * The taps are Q15 with an exact DC gain of one, every stage keeps one
+ * more fractional bit than its input. Each stage keeps its own history,
+ * the stream may be fed in chunks of any size; floor(total / decimation())
+ * samples have been delivered after total samples went in.
+ */
+class rtl_decimator
+{
+public:
+  rtl_decimator();
+
+  /*! \param decim total decimation, 1 (bypass) or a power of 2 up to 64 */
+  void set_decimation( unsigned int decim );
+  unsigned int decimation() const { return _decim; }
+
+  /*! drop the filter history of all stages */
+  void reset();
+
+  /*! the input samples to hand to process() for nout more output samples */
+  size_t input_for( size_t nout ) const { return nout * _decim - _pending; }
+
+  /*!
+   * \param in 2 * nitems bytes of interleaved I/Q
+   * \param nitems number of input samples
+   * \return the number of samples written to out
+   */
+  size_t process( const uint8_t *in, size_t nitems, gr_complex *out );
+
+private:
+  struct stage_t
+  {
+    const int32_t *taps;        /* the odd taps right of the center */
+    size_t ntaps;
+    std::vector<int32_t> buf;   /* history followed by new input, I/Q */
+    size_t fill;                /* samples in buf */
+  };
+
+  unsigned int _decim;
+  size_t _pending;              /* inputs since the last output */
+  std::vector<uint8_t> _raw;    /* input of the first stage */
+  size_t _raw_fill;
+  std::vector<stage_t> _stages;
+  std::vector<int32_t> _out;    /* output of the last stage */
+};
+
+#endif /* INCLUDED_RTL_DECIMATOR_H */
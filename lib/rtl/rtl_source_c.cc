@@ -36,6 +36,7 @@
 
 #include <stdexcept>
 #include <iostream>
+#include <cmath>
 #include <stdio.h>
 
 #include <rtl-sdr.h>
@@ -48,6 +49,11 @@ using namespace boost::assign;
 #define BUF_NUM   15
 #define BUF_SKIP  1 // buffers to skip due to initial garbage
 
+/* latency_ms=N, the transfers queued cover this much, within these limits */
+#define AUTO_QUEUE_MS     500
+#define AUTO_MIN_BUF_NUM  4
+#define AUTO_MAX_BUF_NUM  64
+
 #define BYTES_PER_SAMPLE  2 // rtl device delivers 8 bit unsigned IQ data
 
 /*
@@ -80,14 +86,23 @@ static const int MAX_OUT = 1;	// maximum number of output streams
 rtl_source_c::rtl_source_c (const std::string &args)
   : gr::sync_block ("rtl_source_c",
         gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
-        gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
+        gr::io_signature::make(MIN_OUT, MAX_OUT,
+                               cpu_format_item_size( args_to_cpu_format( args, "cu8" ) ))),
     _dev(NULL),
-    _buf(NULL),
     _running(false),
+    _wait_len(0),
+    _latency_ms(0),
+    _rearming(false),
+    _zerocopy(false),
+    _zc_buf(NULL),
+    _zc_len(0),
+    _commands(&_tagger),
+    _sweep(&_tagger, [this](double freq) { return sweep_tune( freq ); }),
     _no_tuner(false),
     _auto_gain(false),
     _if_gain(0),
-    _skipped(0)
+    _skipped(0),
+    _tuning(args)
 {
   int ret;
   int index;
@@ -100,6 +115,9 @@ rtl_source_c::rtl_source_c (const std::string &args)
 
   dict_t dict = params_to_dict(args);
 
+  _stats.set_quiet( args_to_quiet( args ) );
+  _ring.configure( args, BYTES_PER_SAMPLE );
+
   if (dict.count("rtl")) {
     std::string value = dict["rtl"];
 
@@ -153,7 +171,7 @@ rtl_source_c::rtl_source_c (const std::string &args)
   if (dict.count("bias"))
     bias_tee = boost::lexical_cast<bool>( dict["bias"] );
 
-  _buf_num = _buf_len = _buf_head = _buf_used = _buf_offset = 0;
+  _buf_num = _buf_len = _buf_offset = 0;
 
   if (dict.count("buffers"))
     _buf_num = boost::lexical_cast< unsigned int >( dict["buffers"] );
@@ -161,6 +179,46 @@ rtl_source_c::rtl_source_c (const std::string &args)
   if (dict.count("buflen"))
     _buf_len = boost::lexical_cast< unsigned int >( dict["buflen"] );
 
+  if (dict.count("latency_ms"))
+    _latency_ms = std::max( boost::lexical_cast< double >( dict["latency_ms"] ), 0.0 );
+
+  if (dict.count("zerocopy"))
+    _zerocopy = boost::lexical_cast< bool >( dict["zerocopy"] );
+
+  if (dict.count("latency"))
+    _latency.enable( boost::lexical_cast< bool >( dict["latency"] ) );
+  _cpu_format = args_to_cpu_format( args, "cu8" );
+  _native = ("cu8" == _cpu_format); /* pass the raw samples through */
+
+  if (dict.count("decim"))
+    _decimator.set_decimation( boost::lexical_cast< unsigned int >( dict["decim"] ) );
+
+  if (_native && _decimator.decimation() > 1)
+    throw std::runtime_error("decim requires cpu_format=fc32.");
+
+  if (dict.count("soft_agc")) {
+    if (_native)
+      throw std::runtime_error("soft_agc requires cpu_format=fc32.");
+    _dc.set_agc( boost::lexical_cast< double >( dict["soft_agc"] ) );
+  }
+
+  if (dict.count("power_tags")) {
+    if (_native)
+      throw std::runtime_error("power_tags requires cpu_format=fc32.");
+    _dc.set_power_tags( boost::lexical_cast< size_t >( dict["power_tags"] ) );
+  }
+
+  if (dict.count("record"))
+    _record.open( dict["record"], "cu8", args );
+
+  if (dict.count("squelch_db")) {
+    if (_native)
+      throw std::runtime_error("squelch_db requires cpu_format=fc32.");
+    _dc.set_squelch( boost::lexical_cast< double >( dict["squelch_db"] ),
+                     dict.count("pre") ? boost::lexical_cast< size_t >( dict["pre"] ) : 0,
+                     dict.count("post") ? boost::lexical_cast< size_t >( dict["post"] ) : 0 );
+  }
+
   if (0 == _buf_num)
     _buf_num = BUF_NUM;
 
@@ -172,12 +230,9 @@ rtl_source_c::rtl_source_c (const std::string &args)
               << std::endl;
   }
 
+  _wait_len = 3 * _buf_len; // collect at least 3 buffers
   _samp_avail = _buf_len / BYTES_PER_SAMPLE;
 
-  // create a lookup table for gr_complex values
-  for (unsigned int i = 0; i < 0x100; i++)
-    _lut.push_back((i - 127.4f) / 128.0f);
-
   _dev = NULL;
   ret = rtlsdr_open( &_dev, dev_index );
   if (ret < 0)
@@ -230,12 +285,16 @@ rtl_source_c::rtl_source_c (const std::string &args)
 
   set_if_gain( 24 ); /* preset to a reasonable default (non-GRC use case) */
 
-  _buf = (unsigned char **)malloc(_buf_num * sizeof(unsigned char *));
-
-  if (_buf) {
-    for(unsigned int i = 0; i < _buf_num; ++i)
-      _buf[i] = (unsigned char *)malloc(_buf_len);
+  if (_zerocopy) {
+    /* samples are converted straight out of the librtlsdr transfers */
+    std::cerr << "Using zero-copy transfer handoff." << std::endl;
+  } else {
+    /* the default buffers hold more than latency_ms=N queues at 3.2 MS/s */
+    _tuning.allocate( [this] { _ring.resize( _buf_num * _buf_len ); } );
   }
+
+  if (_latency_ms > 0)
+    size_buffers();
 }
 
 /*
@@ -243,10 +302,14 @@ rtl_source_c::rtl_source_c (const std::string &args)
  */
 rtl_source_c::~rtl_source_c ()
 {
+  _commands.shutdown();
+
   if (_dev) {
     if (_running)
     {
       _running = false;
+      _buf_cond.notify_all();
+      _ring.interrupt();
       rtlsdr_cancel_async( _dev );
       _thread.join();
     }
@@ -254,19 +317,20 @@ rtl_source_c::~rtl_source_c ()
     rtlsdr_close( _dev );
     _dev = NULL;
   }
-
-  if (_buf) {
-    for(unsigned int i = 0; i < _buf_num; ++i) {
-      free(_buf[i]);
-    }
-
-    free(_buf);
-    _buf = NULL;
-  }
 }
 
 bool rtl_source_c::start()
 {
+  std::lock_guard<std::mutex> rearm( _rearm_mutex );
+
+  _decimator.reset();
+  _ring.clear();
+  _ring.resume();
+  _latency.reset();
+  _tagger.reset();
+  _commands.reset();
+  _dc.reset();
+  _record.start( get_sample_rate() * _decimator.decimation(), get_center_freq() );
   _running = true;
   _thread = gr::thread::thread(_rtlsdr_wait, this);
 
@@ -275,10 +339,18 @@ bool rtl_source_c::start()
 
 bool rtl_source_c::stop()
 {
-  _running = false;
+  std::lock_guard<std::mutex> rearm( _rearm_mutex );
+
+  {
+    std::lock_guard<std::mutex> lock( _buf_mutex );
+    _running = false;
+  }
+  _buf_cond.notify_all(); /* release a callback blocked in zerocopy mode */
+  _ring.interrupt();
   if (_dev)
     rtlsdr_cancel_async( _dev );
   _thread.join();
+  _record.stop();
 
   return true;
 }
@@ -296,21 +368,38 @@ void rtl_source_c::rtlsdr_callback(unsigned char *buf, uint32_t len)
     return;
   }
 
-  {
-    std::lock_guard<std::mutex> lock( _buf_mutex );
+  _record.write( buf, len );
 
-    int buf_tail = (_buf_head + _buf_used) % _buf_num;
-    memcpy(_buf[buf_tail], buf, len);
+  if (_zerocopy) {
+    /* Hand the transfer over to work() and keep it from being resubmitted
+     * by librtlsdr until it has been converted. The remaining transfers
+     * stay queued on the USB side meanwhile. */
+    std::unique_lock<std::mutex> lock( _buf_mutex );
 
-    if (_buf_used == _buf_num) {
-      std::cerr << "O" << std::flush;
-      _buf_head = (_buf_head + 1) % _buf_num;
-    } else {
-      _buf_used++;
-    }
+    _zc_buf = buf;
+    _zc_len = len;
+    _buf_offset = 0;
+    _samp_avail = len / BYTES_PER_SAMPLE;
+    _latency.arrived( len );
+    _commands.stored( len / BYTES_PER_SAMPLE / _decimator.decimation() );
+    _tagger.stored( len / BYTES_PER_SAMPLE / _decimator.decimation() );
+    _buf_cond.notify_all();
+
+    while (_zc_buf && _running)
+      _buf_cond.wait( lock );
+
+    _zc_buf = NULL;
+    return;
   }
 
-  _buf_cond.notify_one();
+  size_t pushed = _ring.push( buf, len );
+  _latency.arrived( pushed );
+  _commands.stored( pushed / BYTES_PER_SAMPLE / _decimator.decimation() );
+  _tagger.stored( pushed / BYTES_PER_SAMPLE / _decimator.decimation() );
+  if (pushed < len) {
+    _stats.overflow( (len - pushed) / BYTES_PER_SAMPLE );
+    _tagger.lost( (len - pushed) / BYTES_PER_SAMPLE / _decimator.decimation() );
+  }
 }
 
 void rtl_source_c::_rtlsdr_wait(rtl_source_c *obj)
@@ -320,57 +409,135 @@ void rtl_source_c::_rtlsdr_wait(rtl_source_c *obj)
 
 void rtl_source_c::rtlsdr_wait()
 {
+  /* the libusb callbacks run on this thread */
+  _tuning.apply();
+
   int ret = rtlsdr_read_async( _dev, _rtlsdr_callback, (void *)this, _buf_num, _buf_len );
 
+  if (_rearming) /* restarted with other buffers, the stream goes on */
+    return;
+
   _running = false;
 
   if ( ret != 0 )
     std::cerr << "rtlsdr_read_async returned with " << ret << std::endl;
 
-  _buf_cond.notify_one();
+  _buf_cond.notify_all();
+  _ring.interrupt();
 }
 
-int rtl_source_c::work( int noutput_items,
-                        gr_vector_const_void_star &input_items,
-                        gr_vector_void_star &output_items )
+int rtl_source_c::work_zerocopy( int noutput_items, void *out )
 {
-  gr_complex *out = (gr_complex *)output_items[0];
-
   {
     std::unique_lock<std::mutex> lock( _buf_mutex );
 
-    while (_buf_used < 3 && _running) // collect at least 3 buffers
+    while (!_zc_buf && _running)
       _buf_cond.wait( lock );
   }
 
   if (!_running)
     return WORK_DONE;
 
-  while (noutput_items && _buf_used) {
-    const int nout = std::min(noutput_items, _samp_avail);
-    const unsigned char *buf = _buf[_buf_head] + _buf_offset * 2;
+  /* the callback thread is parked until we release _zc_buf */
+  const unsigned char *buf = _zc_buf + _buf_offset * BYTES_PER_SAMPLE;
+  size_t nin = _samp_avail;
+  const int nout = convert( buf, nin, out, noutput_items );
 
-    for (int i = 0; i < nout; ++i)
-      *out++ = gr_complex(_lut[buf[i * 2]], _lut[buf[i * 2 + 1]]);
+  _samp_avail -= nin;
+  _buf_offset += nin;
+  _latency.consumed( nin * BYTES_PER_SAMPLE );
 
-    noutput_items -= nout;
-    _samp_avail -= nout;
+  if (!_samp_avail) {
+    {
+      std::lock_guard<std::mutex> lock( _buf_mutex );
+      _zc_buf = NULL;
+    }
+    _buf_cond.notify_all();
+  }
 
-    if (!_samp_avail) {
-      {
-        std::lock_guard<std::mutex> lock( _buf_mutex );
+  return nout;
+}
 
-        _buf_head = (_buf_head + 1) % _buf_num;
-        _buf_used--;
-      }
-      _samp_avail = _buf_len / BYTES_PER_SAMPLE;
-      _buf_offset = 0;
-    } else {
-      _buf_offset += nout;
+/* converts from up to nin samples at buf, nin returns how many were used */
+int rtl_source_c::convert( const unsigned char *buf, size_t &nin,
+                           void *out, int noutput_items )
+{
+  if (_decimator.decimation() > 1) {
+    nin = std::min( nin, _decimator.input_for( noutput_items ) );
+    const int nout = _decimator.process( buf, nin, (gr_complex *)out );
+    _dc.process( (gr_complex *)out, nout );
+    return nout;
+  }
+
+  nin = std::min( nin, size_t(noutput_items) );
+
+  if (_native)
+    memcpy( out, buf, nin * BYTES_PER_SAMPLE );
+  else
+    _dc.convert( buf, (gr_complex *)out, nin );
+
+  return nin;
+}
+
+int rtl_source_c::work( int noutput_items,
+                        gr_vector_const_void_star &input_items,
+                        gr_vector_void_star &output_items )
+{
+  unsigned char *out = (unsigned char *)output_items[0];
+  const size_t item_size = _native ? BYTES_PER_SAMPLE : sizeof(gr_complex);
+  int produced = 0;
+
+  _commands.anchor( nitems_written( 0 ) );
+
+  if (_zerocopy) {
+    produced = work_zerocopy( noutput_items, out );
+    if (produced > 0) {
+      produced = _dc.gate( this, output_items[0], produced, &_tagger );
+      _dc.tag_levels( this, produced );
+      produced = _sweep.process( this, output_items[0], produced, item_size );
+    }
+    _tagger.update( this, produced );
+    if (produced > 0)
+      _stats.delivered( produced );
+    return produced;
+  }
+
+  _ring.wait_read( _wait_len );
+
+  if (!_running)
+    return WORK_DONE;
+
+  while (noutput_items) {
+    size_t len;
+    const unsigned char *buf = _ring.read_span( len );
+    if ( size_t lost = _ring.discarded() ) {
+      _latency.consumed( lost );
+      _stats.overflow( lost / BYTES_PER_SAMPLE );
+      _tagger.skipped( nitems_written( 0 ) + produced,
+                       lost / BYTES_PER_SAMPLE / _decimator.decimation() );
     }
+
+    size_t nin = len / BYTES_PER_SAMPLE;
+    const int nout = convert( buf, nin, out, noutput_items );
+
+    if (!nin)
+      break;
+
+    _ring.consume( nin * BYTES_PER_SAMPLE );
+    _latency.consumed( nin * BYTES_PER_SAMPLE );
+
+    out += nout * item_size;
+    produced += nout;
+    noutput_items -= nout;
   }
 
-  return (out - ((gr_complex *)output_items[0]));
+  produced = _dc.gate( this, output_items[0], produced, &_tagger );
+  _dc.tag_levels( this, produced );
+  produced = _sweep.process( this, output_items[0], produced, item_size );
+  _tagger.update( this, produced );
+  _stats.delivered( produced );
+
+  return produced;
 }
 
 std::vector<std::string> rtl_source_c::get_devices()
@@ -409,6 +576,20 @@ std::vector<std::string> rtl_source_c::get_devices()
   return devices;
 }
 
+std::string rtl_source_c::get_cpu_format()
+{
+  return _cpu_format;
+}
+
+osmosdr::stream_stats_t rtl_source_c::get_stream_stats( size_t chan )
+{
+  osmosdr::stream_stats_t stats = _stats.get();
+  stats.high_water = _ring.high_water() / BYTES_PER_SAMPLE;
+  stats.fill = _ring.read_available() / BYTES_PER_SAMPLE;
+  _latency.get( stats );
+  return stats;
+}
+
 size_t rtl_source_c::get_num_channels()
 {
   return 1;
@@ -432,26 +613,80 @@ osmosdr::meta_range_t rtl_source_c::get_sample_rates()
 //  range += osmosdr::range_t( 3000000 ); // may work
 //  range += osmosdr::range_t( 3200000 ); // max rate
 
+  if (_decimator.decimation() > 1) {
+    osmosdr::meta_range_t decimated;
+    for (const osmosdr::range_t &r : range)
+      decimated += osmosdr::range_t( r.start() / _decimator.decimation() );
+    return decimated;
+  }
+
   return range;
 }
 
 double rtl_source_c::set_sample_rate(double rate)
 {
   if (_dev) {
-    rtlsdr_set_sample_rate( _dev, (uint32_t)rate );
+    rtlsdr_set_sample_rate( _dev, (uint32_t)(rate * _decimator.decimation()) );
+    _tagger.set_rate( get_sample_rate() );
+    _record.set_rate( get_sample_rate() * _decimator.decimation() );
+
+    if (_latency_ms > 0)
+      size_buffers();
   }
 
   return get_sample_rate();
 }
 
+/* latency_ms=N: one transfer takes half of N at the sample rate, work()
+ * hands it out once it arrived */
+void rtl_source_c::size_buffers()
+{
+  std::lock_guard<std::mutex> rearm( _rearm_mutex );
+
+  const double bytes_per_sec = rtlsdr_get_sample_rate( _dev ) * BYTES_PER_SAMPLE;
+
+  unsigned int len = (unsigned int)(bytes_per_sec * _latency_ms / 2000) / 512 * 512;
+  len = std::min( std::max( len, 512u ), (unsigned int)BUF_LEN );
+
+  unsigned int num = (unsigned int)ceil( bytes_per_sec * AUTO_QUEUE_MS / 1000 / len );
+  num = std::min( std::max( num, (unsigned int)AUTO_MIN_BUF_NUM ),
+                  (unsigned int)AUTO_MAX_BUF_NUM );
+
+  if ( len == _buf_len && num == _buf_num )
+    return;
+
+  /* librtlsdr takes the transfers when its reader starts */
+  const bool rearm_reader = _running && _thread.joinable();
+  if ( rearm_reader ) {
+    _rearming = true;
+    rtlsdr_cancel_async( _dev );
+    _thread.join();
+    _rearming = false;
+  }
+
+  _buf_num = num;
+  _buf_len = len;
+  _wait_len = _zerocopy ? len : std::min( len, (unsigned int)_ring.capacity() );
+
+  if ( rearm_reader ) {
+    _tagger.retag();
+    _thread = gr::thread::thread(_rtlsdr_wait, this);
+  }
+}
+
 double rtl_source_c::get_sample_rate()
 {
   if (_dev)
-    return (double)rtlsdr_get_sample_rate( _dev );
+    return (double)rtlsdr_get_sample_rate( _dev ) / _decimator.decimation();
 
   return 0;
 }
 
+double rtl_source_c::get_measured_sample_rate( size_t chan )
+{
+  return _tagger.measured_rate();
+}
+
 osmosdr::freq_range_t rtl_source_c::get_freq_range( size_t chan )
 {
   osmosdr::freq_range_t range;
@@ -488,8 +723,14 @@ osmosdr::freq_range_t rtl_source_c::get_freq_range( size_t chan )
 
 double rtl_source_c::set_center_freq( double freq, size_t chan )
 {
-  if (_dev)
+  if ( _commands.defer( [=]{ set_center_freq( freq, chan ); } ) )
+    return freq;
+
+  if (_dev) {
     rtlsdr_set_center_freq( _dev, (uint32_t)freq );
+    _tagger.set_freq( get_center_freq( chan ) );
+    _record.set_freq( get_center_freq( chan ) );
+  }
 
   return get_center_freq( chan );
 }
@@ -504,6 +745,9 @@ double rtl_source_c::get_center_freq( size_t chan )
 
 double rtl_source_c::set_freq_corr( double ppm, size_t chan )
 {
+  if ( _commands.defer( [=]{ set_freq_corr( ppm, chan ); } ) )
+    return ppm;
+
   if ( _dev )
     rtlsdr_set_freq_correction( _dev, (int)ppm );
 
@@ -568,6 +812,9 @@ osmosdr::gain_range_t rtl_source_c::get_gain_range( const std::string & name, si
 
 bool rtl_source_c::set_gain_mode( bool automatic, size_t chan )
 {
+  if ( _commands.defer( [=]{ set_gain_mode( automatic, chan ); } ) )
+    return automatic;
+
   if (_dev) {
     if (!rtlsdr_set_tuner_gain_mode(_dev, int(!automatic))) {
       _auto_gain = automatic;
@@ -586,6 +833,9 @@ bool rtl_source_c::get_gain_mode( size_t chan )
 
 double rtl_source_c::set_gain( double gain, size_t chan )
 {
+  if ( _commands.defer( [=]{ set_gain( gain, chan ); } ) )
+    return gain;
+
   osmosdr::gain_range_t rf_gains = rtl_source_c::get_gain_range( chan );
 
   if (_dev) {
@@ -623,6 +873,9 @@ double rtl_source_c::get_gain( const std::string & name, size_t chan )
 
 double rtl_source_c::set_if_gain(double gain, size_t chan)
 {
+  if ( _commands.defer( [=]{ set_if_gain( gain, chan ); } ) )
+    return gain;
+
   if ( _dev ) {
     if ( rtlsdr_get_tuner_type(_dev) != RTLSDR_TUNER_E4000 ) {
       _if_gain = 0;
@@ -704,3 +957,61 @@ std::string rtl_source_c::get_antenna( size_t chan )
 {
   return "RX";
 }
+
+void rtl_source_c::set_dc_offset_mode( int mode, size_t chan )
+{
+  _dc.set_mode( mode );
+}
+
+void rtl_source_c::set_dc_offset( const std::complex<double> &offset, size_t chan )
+{
+  _dc.set_offset( offset );
+}
+
+void rtl_source_c::set_command_time( const osmosdr::time_spec_t &time_spec, size_t mboard )
+{
+  _commands.set_time( time_spec );
+}
+
+void rtl_source_c::set_command_sample( uint64_t sample, size_t chan )
+{
+  _commands.set_item( sample );
+}
+
+void rtl_source_c::clear_command_time( size_t mboard )
+{
+  _commands.clear();
+}
+
+bool rtl_source_c::set_sweep( const std::vector<double> &freqs,
+                              double dwell, double settle, size_t chan )
+{
+  const double rate = get_sample_rate();
+
+  if (_dc.squelching())
+    throw std::runtime_error("set_sweep does not work with squelch_db.");
+
+  _sweep.set( freqs, size_t(dwell * rate + 0.5), size_t(settle * rate + 0.5) );
+
+  return true;
+}
+
+void rtl_source_c::clear_sweep( size_t chan )
+{
+  _sweep.clear();
+}
+
+/* called from work() by the sweep, returns the samples received before */
+size_t rtl_source_c::sweep_tune( double freq )
+{
+  if (_dev) {
+    rtlsdr_set_center_freq( _dev, (uint32_t)freq );
+    _tagger.set_freq( get_center_freq() );
+    _record.set_freq( get_center_freq() );
+  }
+
+  if (_zerocopy)
+    return _samp_avail / _decimator.decimation();
+
+  return _ring.read_available() / BYTES_PER_SAMPLE / _decimator.decimation();
+}
@@ -30,6 +30,16 @@
 #include <condition_variable>
 
 #include "source_iface.h"
+#include "sample_ring.h"
+#include "rx_tagger.h"
+#include "command_queue.h"
+#include "sweep_engine.h"
+#include "stream_counters.h"
+#include "latency_probe.h"
+#include "thread_tuning.h"
+#include "dc_remover.h"
+#include "raw_recorder.h"
+#include "rtl_decimator.h"
 
 class rtl_source_c;
 typedef struct rtlsdr_dev rtlsdr_dev_t;
@@ -86,10 +96,13 @@ public:
   static std::vector< std::string > get_devices();
 
   size_t get_num_channels( void );
+  std::string get_cpu_format( void );
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
   double get_sample_rate( void );
+  double get_measured_sample_rate( size_t chan = 0 );
 
   osmosdr::freq_range_t get_freq_range( size_t chan = 0 );
   double set_center_freq( double freq, size_t chan = 0 );
@@ -113,6 +126,17 @@ public:
   std::string set_antenna( const std::string & antenna, size_t chan = 0 );
   std::string get_antenna( size_t chan = 0 );
 
+  void set_dc_offset_mode( int mode, size_t chan = 0 );
+  void set_dc_offset( const std::complex<double> &offset, size_t chan = 0 );
+
+  void set_command_time( const osmosdr::time_spec_t &time_spec, size_t mboard = 0 );
+  void set_command_sample( uint64_t sample, size_t chan = 0 );
+  void clear_command_time( size_t mboard = 0 );
+
+  bool set_sweep( const std::vector<double> &freqs,
+                  double dwell, double settle, size_t chan = 0 );
+  void clear_sweep( size_t chan = 0 );
+
 protected:
   bool start();
   bool stop();
@@ -122,27 +146,51 @@ private:
   void rtlsdr_callback(unsigned char *buf, uint32_t len);
   static void _rtlsdr_wait(rtl_source_c *obj);
   void rtlsdr_wait();
-
-  std::vector<float> _lut;
+  int work_zerocopy( int noutput_items, void *out );
+  int convert( const unsigned char *buf, size_t &nin, void *out, int noutput_items );
+  size_t sweep_tune( double freq );
+  void size_buffers();
 
   rtlsdr_dev_t *_dev;
   gr::thread::thread _thread;
-  unsigned char **_buf;
+  sample_ring<unsigned char> _ring;
   unsigned int _buf_num;
   unsigned int _buf_len;
-  unsigned int _buf_head;
-  unsigned int _buf_used;
   std::mutex _buf_mutex;
   std::condition_variable _buf_cond;
   bool _running;
 
+  /* latency_ms=N, the reader is restarted when the buffers change */
+  std::atomic<unsigned int> _wait_len;  /**< bytes work() waits for */
+  double _latency_ms;
+  std::atomic<bool> _rearming;
+  std::mutex _rearm_mutex;
+
   unsigned int _buf_offset;
   int _samp_avail;
 
+  /* zerocopy mode: transfer handed over by the callback, not yet consumed */
+  bool _zerocopy;
+  unsigned char *_zc_buf;
+  unsigned int _zc_len;
+
+  std::string _cpu_format;
+  bool _native;
+  rtl_decimator _decimator;
+
+  rx_tagger _tagger;
+  stream_counters _stats;
+  latency_probe _latency;
+  command_queue _commands;
+  sweep_engine _sweep;
+  dc_remover _dc;
+  raw_recorder _record;          /**< see record= */
+
   bool _no_tuner;
   bool _auto_gain;
   double _if_gain;
   unsigned int _skipped;
+  thread_tuning _tuning;
 };
 
 #endif /* INCLUDED_RTLSDR_SOURCE_C_H */
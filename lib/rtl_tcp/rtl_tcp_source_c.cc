@@ -29,6 +29,7 @@
 
 #include "rtl_tcp_source_c.h"
 #include "arg_helpers.h"
+#include "sample_convert.h"
 
 #if defined(_WIN32)
 // if not posix, assume winsock
@@ -40,7 +41,9 @@
 typedef char* optval_t;
 #else
 #include <netdb.h>
+#include <unistd.h>
 #include <sys/types.h>
+#include <sys/select.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
@@ -61,6 +64,9 @@ typedef ptrdiff_t ssize_t;
 
 #define BYTES_PER_SAMPLE  2 // rtl_tcp device delivers 8 bit unsigned IQ data
 
+#define RING_SIZE  (16 * 1024 * 1024) // ~3.5 seconds at 2.4 Msps
+#define RECONNECT_INTERVAL_MS  1000
+
 /* copied from rtl sdr code */
 typedef struct { /* structure size must be multiple of 2 bytes */
   char magic[4];
@@ -144,18 +150,23 @@ rtl_tcp_source_c_sptr make_rtl_tcp_source_c(const std::string &args)
 rtl_tcp_source_c::rtl_tcp_source_c(const std::string &args) :
   gr::sync_block("rtl_tcp_source_c",
                  gr::io_signature::make(0, 0, 0),
-                 gr::io_signature::make(1, 1, sizeof (gr_complex))),
+                 gr::io_signature::make(1, 1,
+                                        cpu_format_item_size( args_to_cpu_format( args, "cu8" ) ))),
   d_socket(-1),
+  _port(1234),
+  _rcvbuf(0),
+  _direct_samp(0),
+  _offset_tune(0),
+  _bias_tee(0),
   _no_tuner(false),
   _auto_gain(false),
-  _if_gain(0)
+  _if_gain(0),
+  _running(false),
+  _tuning(args)
 {
-  std::string host = "127.0.0.1";
-  unsigned short port = 1234;
   int payload_size = 16384;
-  unsigned int direct_samp = 0, offset_tune = 0;
-  int bias_tee = 0;
 
+  _host = "127.0.0.1";
   _freq = 0;
   _rate = 0;
   _gain = 0;
@@ -163,34 +174,43 @@ rtl_tcp_source_c::rtl_tcp_source_c(const std::string &args) :
 
   dict_t dict = params_to_dict(args);
 
+  _stats.set_quiet( args_to_quiet( args ) );
+  _ring.configure( args, BYTES_PER_SAMPLE );
+
   if (dict.count("rtl_tcp")) {
     std::vector< std::string > tokens;
     boost::algorithm::split( tokens, dict["rtl_tcp"], boost::is_any_of(":") );
 
     if ( tokens[0].length() && (tokens.size() == 1 || tokens.size() == 2 ) )
-      host = tokens[0];
+      _host = tokens[0];
 
     if ( tokens.size() == 2 ) // port given
-      port = boost::lexical_cast< unsigned short >( tokens[1] );
+      _port = boost::lexical_cast< unsigned short >( tokens[1] );
   }
 
   if (dict.count("psize"))
     payload_size = boost::lexical_cast< int >( dict["psize"] );
 
+  if (dict.count("rcvbuf"))
+    _rcvbuf = boost::lexical_cast< int >( dict["rcvbuf"] );
+
   if (dict.count("direct_samp"))
-    direct_samp = boost::lexical_cast< unsigned int >( dict["direct_samp"] );
+    _direct_samp = boost::lexical_cast< unsigned int >( dict["direct_samp"] );
 
   if (dict.count("offset_tune"))
-    offset_tune = boost::lexical_cast< unsigned int >( dict["offset_tune"] );
+    _offset_tune = boost::lexical_cast< unsigned int >( dict["offset_tune"] );
 
   if (dict.count("bias"))
-    bias_tee = boost::lexical_cast<bool>( dict["bias"] );
+    _bias_tee = boost::lexical_cast<bool>( dict["bias"] );
+
+  _cpu_format = args_to_cpu_format( args, "cu8" );
+  _native = ("cu8" == _cpu_format); /* pass the raw samples through */
 
-  if (!host.length())
-    host = "127.0.0.1";
+  if (!_host.length())
+    _host = "127.0.0.1";
 
-  if (0 == port)
-    port = 1234;
+  if (0 == _port)
+    _port = 1234;
 
   if (payload_size <= 0)
     payload_size = 16384;
@@ -204,6 +224,32 @@ rtl_tcp_source_c::rtl_tcp_source_c(const std::string &args) :
   }
 #endif
 
+  _payload_size = payload_size;
+  d_temp_buff = new unsigned char[payload_size];   // allow it to hold up to payload_size bytes
+
+  _tuning.allocate( [this] { _ring.resize( RING_SIZE ); } );
+
+  d_socket = connect_server( true );
+
+  if (d_tuner_type != RTLSDR_TUNER_UNKNOWN) {
+    std::cerr << "The RTL TCP server reports a "
+              << get_tuner_name()
+              << " tuner with "
+              << d_tuner_gain_count << " RF and "
+              << d_tuner_if_gain_count << " IF gains."
+              << std::endl;
+  }
+
+  set_gain_mode(false); /* enable manual gain mode by default */
+}
+
+/*
+ * Open the TCP connection to the server, read the dongle info and apply the
+ * settings given as device arguments. With fatal set, errors throw, otherwise
+ * they are reported and -1 is returned so the caller may retry.
+ */
+int rtl_tcp_source_c::connect_server( bool fatal )
+{
   // Set up the address stucture for the source address and port numbers
   // Get the source IP address from the host name
   struct addrinfo *ip_src;      // store the source IP address to use
@@ -214,37 +260,42 @@ rtl_tcp_source_c::rtl_tcp_source_c(const std::string &args) :
   hints.ai_protocol = IPPROTO_TCP;
   hints.ai_flags = AI_PASSIVE;
   char port_str[12];
-  sprintf( port_str, "%d", port );
+  sprintf( port_str, "%d", _port );
 
-  // FIXME leaks if report_error throws below
-  int ret = getaddrinfo(host.c_str(), port_str, &hints, &ip_src);
-  if (ret != 0)
+  int ret = getaddrinfo(_host.c_str(), port_str, &hints, &ip_src);
+  if (ret != 0) {
     report_error("rtl_tcp_source_c/getaddrinfo",
-                 "can't initialize source socket" );
-
-  d_temp_buff = new unsigned char[payload_size];   // allow it to hold up to payload_size bytes
-  d_LUT = new float[0x100];
-  for (int i = 0; i < 0x100; ++i)
-    d_LUT[i] = (((float)(i & 0xff)) - 127.4f) * (1.0f / 128.0f);
+                 fatal ? "can't initialize source socket" : NULL );
+    return -1;
+  }
 
   // create socket
-  d_socket = socket(ip_src->ai_family, ip_src->ai_socktype,
+  int sock = socket(ip_src->ai_family, ip_src->ai_socktype,
                     ip_src->ai_protocol);
-  if (d_socket == -1)
-    report_error("socket open","can't open socket");
+  if (sock == -1) {
+    freeaddrinfo(ip_src);
+    report_error("socket open", fatal ? "can't open socket" : NULL);
+    return -1;
+  }
 
   // Turn on reuse address
   int opt_val = 1;
-  if (setsockopt(d_socket, SOL_SOCKET, SO_REUSEADDR, (optval_t)&opt_val, sizeof(int)) == -1)
-    report_error("SO_REUSEADDR","can't set socket option SO_REUSEADDR");
+  if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (optval_t)&opt_val, sizeof(int)) == -1)
+    report_error("SO_REUSEADDR", fatal ? "can't set socket option SO_REUSEADDR" : NULL);
 
   // Don't wait when shutting down
   linger lngr;
   lngr.l_onoff  = 1;
   lngr.l_linger = 0;
-  if (setsockopt(d_socket, SOL_SOCKET, SO_LINGER, (optval_t)&lngr, sizeof(linger)) == -1)
+  if (setsockopt(sock, SOL_SOCKET, SO_LINGER, (optval_t)&lngr, sizeof(linger)) == -1)
     if (!is_error(ENOPROTOOPT)) // no SO_LINGER for SOCK_DGRAM on Windows
-      report_error("SO_LINGER","can't set socket option SO_LINGER");
+      report_error("SO_LINGER", fatal ? "can't set socket option SO_LINGER" : NULL);
+
+  // A large kernel buffer rides out scheduling hiccups of the reader thread
+  // and has to be requested before connecting to affect the TCP window
+  if (_rcvbuf > 0)
+    if (setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (optval_t)&_rcvbuf, sizeof(int)) == -1)
+      report_error("SO_RCVBUF", NULL);
 
 #if USE_RCV_TIMEO
   // Set a timeout on the receive function to not block indefinitely
@@ -257,19 +308,24 @@ rtl_tcp_source_c::rtl_tcp_source_c(const std::string &args) :
   timeout.tv_sec = 1;
   timeout.tv_usec = 0;
 #endif
-  if (setsockopt(d_socket, SOL_SOCKET, SO_RCVTIMEO, (optval_t)&timeout, sizeof(timeout)) == -1)
+  if (setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (optval_t)&timeout, sizeof(timeout)) == -1)
     report_error("SO_RCVTIMEO","can't set socket option SO_RCVTIMEO");
 #endif // USE_RCV_TIMEO
 
-  if (::connect(d_socket, ip_src->ai_addr, ip_src->ai_addrlen) != 0)
-    report_error("rtl_tcp_source_c/connect","can't open TCP connection");
+  if (::connect(sock, ip_src->ai_addr, ip_src->ai_addrlen) != 0) {
+    freeaddrinfo(ip_src);
+    close_socket(sock);
+    report_error("rtl_tcp_source_c/connect",
+                 fatal ? "can't open TCP connection" : NULL);
+    return -1;
+  }
   freeaddrinfo(ip_src);
 
   int flag = 1;
-  setsockopt(d_socket, IPPROTO_TCP, TCP_NODELAY, (char *)&flag,sizeof(flag));
+  setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (char *)&flag,sizeof(flag));
 
   dongle_info_t dongle_info;
-  ret = recv(d_socket, (char*)&dongle_info, sizeof(dongle_info), 0);
+  ret = recv(sock, (char*)&dongle_info, sizeof(dongle_info), 0);
   if (sizeof(dongle_info) != ret)
     fprintf(stderr,"failed to read dongle info\n");
 
@@ -284,48 +340,76 @@ rtl_tcp_source_c::rtl_tcp_source_c(const std::string &args) :
       d_tuner_if_gain_count = 53;
   }
 
-  if (d_tuner_type != RTLSDR_TUNER_UNKNOWN) {
-    std::cerr << "The RTL TCP server reports a "
-              << get_tuner_name()
-              << " tuner with "
-              << d_tuner_gain_count << " RF and "
-              << d_tuner_if_gain_count << " IF gains."
-              << std::endl;
-  }
-
-  set_gain_mode(false); /* enable manual gain mode by default */
-
   // set direct sampling
   struct command cmd;
 
-  cmd = { 0x09, htonl(direct_samp) };
-  send(d_socket, (const char*)&cmd, sizeof(cmd), 0);
-  if (direct_samp)
+  cmd = { 0x09, htonl(_direct_samp) };
+  send(sock, (const char*)&cmd, sizeof(cmd), 0);
+  if (_direct_samp)
     _no_tuner = true;
 
   // set offset tuning
-  cmd = { 0x0a, htonl(offset_tune) };
-  send(d_socket, (const char*)&cmd, sizeof(cmd), 0);
+  cmd = { 0x0a, htonl(_offset_tune) };
+  send(sock, (const char*)&cmd, sizeof(cmd), 0);
 
   // set bias tee
-  cmd = { 0x0e, htonl(bias_tee) };
-  send(d_socket, (const char*)&cmd, sizeof(cmd), 0);
+  cmd = { 0x0e, htonl(_bias_tee) };
+  send(sock, (const char*)&cmd, sizeof(cmd), 0);
+
+  return sock;
 }
 
-rtl_tcp_source_c::~rtl_tcp_source_c()
+void rtl_tcp_source_c::close_socket( int sock )
 {
-  delete [] d_LUT;
-  delete [] d_temp_buff;
-
-  if (d_socket != -1) {
-    shutdown(d_socket, SHUT_RDWR);
+  if (sock != -1) {
+    shutdown(sock, SHUT_RDWR);
 #if defined(USING_WINSOCK)
-    closesocket(d_socket);
+    closesocket(sock);
 #else
-    ::close(d_socket);
+    ::close(sock);
 #endif
-    d_socket = -1;
   }
+}
+
+void rtl_tcp_source_c::send_command( unsigned char cmd, unsigned int param )
+{
+  struct command c = { cmd, htonl(param) };
+
+  std::lock_guard<std::mutex> lock( _socket_mutex );
+
+  if (d_socket != -1)
+    send(d_socket, (const char*)&c, sizeof(c), 0);
+}
+
+/* re-apply everything the user configured after the server came back */
+void rtl_tcp_source_c::restore_settings()
+{
+  if (_rate)
+    set_sample_rate( _rate );
+
+  if (_freq)
+    set_center_freq( _freq );
+
+  if (_corr)
+    set_freq_corr( _corr );
+
+  set_gain_mode( _auto_gain );
+
+  if (!_auto_gain)
+    set_gain( _gain );
+
+  if (_if_gain)
+    set_if_gain( _if_gain );
+}
+
+rtl_tcp_source_c::~rtl_tcp_source_c()
+{
+  stop();
+
+  delete [] d_temp_buff;
+
+  close_socket(d_socket);
+  d_socket = -1;
 
 #if defined(USING_WINSOCK) // for Windows (with MinGW)
   // free winsock resources
@@ -334,29 +418,149 @@ rtl_tcp_source_c::~rtl_tcp_source_c()
 }
 
 
+bool rtl_tcp_source_c::start()
+{
+  if (_running)
+    return true;
+
+  _ring.clear();
+  _ring.resume();
+
+  _running = true;
+  _thread = gr::thread::thread( boost::bind(&rtl_tcp_source_c::receive_task, this) );
+
+  return true;
+}
+
+bool rtl_tcp_source_c::stop()
+{
+  if (!_running)
+    return true;
+
+  _running = false;
+  _ring.interrupt();
+  _thread.join();
+
+  return true;
+}
+
+/* wait up to timeout_ms for the socket to become readable */
+static bool wait_readable( int sock, int timeout_ms )
+{
+  fd_set readfds;
+  FD_ZERO(&readfds);
+  FD_SET(sock, &readfds);
+
+  timeval tv;
+  tv.tv_sec = timeout_ms / 1000;
+  tv.tv_usec = (timeout_ms % 1000) * 1000;
+
+  return select(sock + 1, &readfds, NULL, NULL, &tv) > 0;
+}
+
+/* drain the socket into the ring, reconnecting whenever the server drops us */
+void rtl_tcp_source_c::receive_task()
+{
+  _tuning.apply();
+
+  while (_running) {
+    if (d_socket == -1) {
+      for (int ms = 0; ms < RECONNECT_INTERVAL_MS && _running; ms += 100)
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+
+      if (!_running)
+        break;
+
+      int sock = connect_server( false );
+      if (sock == -1)
+        continue;
+
+      {
+        std::lock_guard<std::mutex> lock( _socket_mutex );
+        d_socket = sock;
+      }
+
+      restore_settings();
+
+      std::cerr << "rtl_tcp_source_c: reconnected to "
+                << _host << ":" << _port << std::endl;
+    }
+
+    if (!wait_readable( d_socket, 100 ))
+      continue;
+
+    /* read as much as fits in one go, straight into the ring */
+    size_t len;
+    unsigned char *buf = _ring.write_span( len, _payload_size );
+    bool dropping = false;
+
+    if (!len) {
+      buf = d_temp_buff;
+      len = _payload_size;
+      dropping = true;
+    }
+
+    ssize_t received = recv(d_socket, (char*)buf, len, 0);
+
+    if (received > 0) {
+      if (dropping) {
+        _ring.commit( 0, received );
+        _stats.overflow( received / BYTES_PER_SAMPLE );
+      } else {
+        _ring.commit( received );
+      }
+      continue;
+    }
+
+    if (received == -1 && is_error(EAGAIN))
+      continue;
+
+    std::cerr << "rtl_tcp_source_c: connection to "
+              << _host << ":" << _port << " lost, reconnecting" << std::endl;
+
+    std::lock_guard<std::mutex> lock( _socket_mutex );
+    close_socket(d_socket);
+    d_socket = -1;
+  }
+}
+
 int rtl_tcp_source_c::work(int noutput_items,
 			   gr_vector_const_void_star &input_items,
 			   gr_vector_void_star &output_items)
 {
-  gr_complex *out = (gr_complex *)output_items[0];
-  int bytesleft = noutput_items * BYTES_PER_SAMPLE;
-  int index = 0;
-  int receivedbytes = 0;
-  while (bytesleft > 0) {
-    receivedbytes = recv(d_socket, (char*)&d_temp_buff[index], bytesleft, 0);
+  unsigned char *out = (unsigned char *)output_items[0];
+  const size_t item_size = _native ? BYTES_PER_SAMPLE : sizeof(gr_complex);
+  int produced = 0;
 
-    if (receivedbytes == -1 && !is_error(EAGAIN)) {
-      fprintf(stderr, "socket error\n");
-      return -1;
-    }
-    bytesleft -= receivedbytes;
-    index += receivedbytes;
+  /* never block the scheduler on the network, hand out what we have */
+  if (!_ring.wait_read( BYTES_PER_SAMPLE, 100 ))
+    return 0;
+
+  while (noutput_items) {
+    size_t len;
+    const unsigned char *buf = _ring.read_span( len );
+    if ( size_t lost = _ring.discarded() )
+      _stats.overflow( lost / BYTES_PER_SAMPLE );
+
+    const int nout = std::min(noutput_items, int(len / BYTES_PER_SAMPLE));
+
+    if (!nout)
+      break;
+
+    if (_native)
+      memcpy( out, buf, nout * BYTES_PER_SAMPLE );
+    else
+      convert_cu8_fc32( buf, (gr_complex *)out, nout );
+    _ring.consume( nout * BYTES_PER_SAMPLE );
+
+    out += nout * item_size;
+    produced += nout;
+    noutput_items -= nout;
   }
 
-  for (int i = 0; i < noutput_items; i++)
-    out[i] = gr_complex(d_LUT[d_temp_buff[i * 2]], d_LUT[d_temp_buff[i * 2 + 1]]);
+  _stats.delivered( produced );
 
-  return noutput_items;
+  return produced;
 }
 
 std::string rtl_tcp_source_c::name()
@@ -378,11 +582,24 @@ std::vector<std::string> rtl_tcp_source_c::get_devices( bool fake )
   return devices;
 }
 
+std::string rtl_tcp_source_c::get_cpu_format( void )
+{
+  return _cpu_format;
+}
+
 size_t rtl_tcp_source_c::get_num_channels( void )
 {
   return 1;
 }
 
+osmosdr::stream_stats_t rtl_tcp_source_c::get_stream_stats( size_t chan )
+{
+  osmosdr::stream_stats_t stats = _stats.get();
+  stats.high_water = _ring.high_water() / BYTES_PER_SAMPLE;
+  stats.fill = _ring.read_available() / BYTES_PER_SAMPLE;
+  return stats;
+}
+
 osmosdr::meta_range_t rtl_tcp_source_c::get_sample_rates( void )
 {
   osmosdr::meta_range_t range;
@@ -406,8 +623,7 @@ osmosdr::meta_range_t rtl_tcp_source_c::get_sample_rates( void )
 
 double rtl_tcp_source_c::set_sample_rate( double rate )
 {
-  struct command cmd = { 0x02, htonl(rate) };
-  send(d_socket, (const char*)&cmd, sizeof(cmd), 0);
+  send_command( 0x02, rate );
 
   _rate = rate;
 
@@ -455,8 +671,7 @@ osmosdr::freq_range_t rtl_tcp_source_c::get_freq_range( size_t chan )
 
 double rtl_tcp_source_c::set_center_freq( double freq, size_t chan )
 {
-  struct command cmd = { 0x01, htonl(freq) };
-  send(d_socket, (const char*)&cmd, sizeof(cmd), 0);
+  send_command( 0x01, freq );
 
   _freq = freq;
 
@@ -470,8 +685,7 @@ double rtl_tcp_source_c::get_center_freq( size_t chan )
 
 double rtl_tcp_source_c::set_freq_corr( double ppm, size_t chan )
 {
-  struct command cmd = { 0x05, htonl(ppm) };
-  send(d_socket, (const char*)&cmd, sizeof(cmd), 0);
+  send_command( 0x05, ppm );
 
   _corr = ppm;
 
@@ -563,12 +777,10 @@ osmosdr::gain_range_t rtl_tcp_source_c::get_gain_range( const std::string & name
 bool rtl_tcp_source_c::set_gain_mode( bool automatic, size_t chan )
 {
   // gain mode
-  struct command cmd = { 0x03, htonl(!automatic) };
-  send(d_socket, (const char*)&cmd, sizeof(cmd), 0);
+  send_command( 0x03, !automatic );
 
   // AGC mode
-  cmd = { 0x08, htonl(automatic) };
-  send(d_socket, (const char*)&cmd, sizeof(cmd), 0);
+  send_command( 0x08, automatic );
 
   _auto_gain = automatic;
 
@@ -584,8 +796,7 @@ double rtl_tcp_source_c::set_gain( double gain, size_t chan )
 {
   osmosdr::gain_range_t gains = rtl_tcp_source_c::get_gain_range( chan );
 
-  struct command cmd = { 0x04, htonl(int(gains.clip(gain) * 10.0)) };
-  send(d_socket, (const char*)&cmd, sizeof(cmd), 0);
+  send_command( 0x04, int(gains.clip(gain) * 10.0) );
 
   _gain = gain;
 
@@ -671,8 +882,7 @@ double rtl_tcp_source_c::set_if_gain(double gain, size_t chan)
   for (unsigned int stage = 1; stage <= gains.size(); stage++) {
     int gain_i = int(gains[stage] * 10.0);
     uint32_t params = stage << 16 | (gain_i & 0xffff);
-    struct command cmd = { 0x06, htonl(params) };
-    send(d_socket, (const char*)&cmd, sizeof(cmd), 0);
+    send_command( 0x06, params );
   }
 
   _if_gain = gain;
@@ -21,8 +21,15 @@
 #define RTL_TCP_SOURCE_C_H
 
 #include <gnuradio/sync_block.h>
+#include <gnuradio/thread/thread.h>
+
+#include <atomic>
+#include <mutex>
 
 #include "source_iface.h"
+#include "sample_ring.h"
+#include "stream_counters.h"
+#include "thread_tuning.h"
 
 class rtl_tcp_source_c;
 
@@ -51,9 +58,18 @@ private:
   rtl_tcp_source_c(const std::string &args);
   const char * get_tuner_name(void);
 
+  int connect_server( bool fatal );
+  static void close_socket( int sock );
+  void send_command( unsigned char cmd, unsigned int param );
+  void restore_settings();
+  void receive_task();
+
 public:
   ~rtl_tcp_source_c();
 
+  bool start();
+  bool stop();
+
   int work(int noutput_items,
 	   gr_vector_const_void_star &input_items,
 	   gr_vector_void_star &output_items);
@@ -63,6 +79,8 @@ public:
   static std::vector< std::string > get_devices( bool fake = false );
 
   size_t get_num_channels( void );
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+  std::string get_cpu_format( void );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
@@ -92,7 +110,15 @@ public:
 
 private:
   int d_socket;		  // handle to socket
+  std::mutex _socket_mutex;
+  std::string _host;
+  unsigned short _port;
+  int _rcvbuf;
+  unsigned int _direct_samp, _offset_tune;
+  int _bias_tee;
   double _freq, _rate, _gain, _corr;
+  std::string _cpu_format;
+  bool _native;
   bool _no_tuner;
   bool _auto_gain;
   double _if_gain;
@@ -100,8 +126,14 @@ private:
   enum rtlsdr_tuner d_tuner_type;
   unsigned int d_tuner_gain_count;
   unsigned int d_tuner_if_gain_count;
-  unsigned char *d_temp_buff; // hold buffer between calls
-  float *d_LUT;
+  unsigned char *d_temp_buff; // scratch for data dropped on overflow
+  size_t _payload_size;
+
+  sample_ring<unsigned char> _ring;
+  stream_counters _stats;
+  std::atomic<bool> _running;
+  gr::thread::thread _thread;
+  thread_tuning _tuning;
 };
 
 #endif // RTL_TCP_SOURCE_C_H
@@ -0,0 +1,323 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "rx_tagger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+/* seconds of arrivals before the measured rate is used, the jitter of
+ * the arrivals averages out over it to about a ppm */
+#define RATE_FIT_SECS   30.0
+
+/* change of the measured rate which anchors the stream again */
+#define RATE_RETAG_PPM  1.0
+
+static double steady_secs()
+{
+  return std::chrono::duration< double >(
+           std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+static double system_secs()
+{
+  return std::chrono::duration< double >(
+           std::chrono::system_clock::now().time_since_epoch() ).count();
+}
+
+rx_tagger::rx_tagger( size_t nchan ) :
+  _retag( 0 ),
+  _stored( 0 ),
+  _gaps_pending( false ),
+  _base( NO_ITEM ),
+  _skipped( 0 )
+{
+  reset_fit();
+  set_num_channels( nchan );
+}
+
+void rx_tagger::set_num_channels( size_t nchan )
+{
+  if ( nchan > RX_TAGGER_MAX_CHANNELS )
+    throw std::runtime_error( "Too many channels for rx_time tags." );
+
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  settings_t settings = _settings.read();
+  for ( size_t chan = settings.nchan; chan < nchan; chan++ )
+    settings.freq[chan] = 0;
+  settings.nchan = nchan;
+  _settings.publish( settings );
+}
+
+void rx_tagger::reset()
+{
+  {
+    std::lock_guard< std::mutex > lock( _gaps_mutex );
+    _gaps.clear();
+    _gaps_pending = false;
+  }
+
+  _stored = 0;
+  _base = NO_ITEM;
+  _skipped = 0;
+  _skips.clear();
+  reset_fit();
+  retag();
+}
+
+void rx_tagger::lost( uint64_t nitems )
+{
+  if ( ! nitems )
+    return;
+
+  {
+    std::lock_guard< std::mutex > fit( _fit_mutex );
+    _fit_count += nitems;
+    _fit_lost += nitems;
+  }
+
+  std::lock_guard< std::mutex > lock( _gaps_mutex );
+
+  /* back to back drops make one gap */
+  const uint64_t at = _stored.load();
+  if ( _gaps.size() && _gaps.back().at == at ) {
+    _gaps.back().lost += nitems;
+  } else {
+    gap_t gap = { at, nitems };
+    _gaps.push_back( gap );
+  }
+
+  _gaps_pending = true;
+}
+
+void rx_tagger::set_rate( double rate )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  settings_t settings = _settings.read();
+  settings.rate = rate;
+  _settings.publish( settings );
+
+  reset_fit();
+  retag();
+}
+
+double rx_tagger::measured_rate()
+{
+  std::lock_guard< std::mutex > lock( _fit_mutex );
+  return fitted_rate();
+}
+
+void rx_tagger::reset_fit()
+{
+  std::lock_guard< std::mutex > lock( _fit_mutex );
+
+  _fit_count = 0;
+  _fit_lost = 0;
+  _fit_points = 0;
+  _fit_t0 = 0;
+  _fit_wall = 0;
+  _fit_span = 0;
+  _fit_mx = _fit_my = 0;
+  _fit_sxx = _fit_sxy = 0;
+  _tagged_rate = 0;
+}
+
+/* the inverse slope of the fit, with _fit_mutex held */
+double rx_tagger::fitted_rate() const
+{
+  if ( _fit_span < RATE_FIT_SECS || _fit_sxy <= 0 )
+    return 0;
+
+  return _fit_sxx / _fit_sxy;
+}
+
+/*
+ * Adds the arrival of nitems to the fit, on the capture thread. The
+ * means and co-moments are updated in the numerically stable way of
+ * Welford, so days of samples don't lose the precision of the slope.
+ */
+void rx_tagger::sampled( uint64_t nitems )
+{
+  const double now = steady_secs();
+
+  std::lock_guard< std::mutex > lock( _fit_mutex );
+
+  if ( ! _fit_points ) {
+    _fit_t0 = now;
+    _fit_wall = system_secs() - now;
+  }
+
+  _fit_count += nitems;
+  _fit_points++;
+
+  /* the last of the items was sampled right before they arrived */
+  const double x = double( _fit_count );
+  const double y = now - _fit_t0;
+  const double dx = x - _fit_mx;
+
+  _fit_mx += dx / _fit_points;
+  _fit_my += ( y - _fit_my ) / _fit_points;
+  _fit_sxx += dx * ( x - _fit_mx );
+  _fit_sxy += dx * ( y - _fit_my );
+  _fit_span = y;
+
+  /* the first measurement and any drift after it start a new anchor */
+  const double rate = fitted_rate();
+  if ( rate > 0 && ( _tagged_rate <= 0 ||
+                     std::fabs( rate / _tagged_rate - 1 ) > RATE_RETAG_PPM * 1e-6 ) )
+    retag();
+}
+
+void rx_tagger::set_freq( double freq, size_t chan )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+
+  settings_t settings = _settings.read();
+  if ( chan < settings.nchan ) {
+    settings.freq[chan] = freq;
+    _settings.publish( settings );
+  }
+
+  retag();
+}
+
+void rx_tagger::tag( gr::block *block, size_t nitems )
+{
+  static const pmt::pmt_t GAP_KEY = pmt::string_to_symbol( "rx_gap" );
+
+  const uint64_t first = block->nitems_written( 0 );
+  const uint64_t end = first + nitems;
+
+  uint64_t anchored = NO_ITEM;
+
+  const settings_t settings = _settings.read();
+
+  uint64_t requested = _retag.load();
+  const uint64_t item = std::max( requested, first );
+
+  /* a later request is anchored by a later call, a newer one as well */
+  if ( requested != NO_ITEM && item < end &&
+       _retag.compare_exchange_strong( requested, NO_ITEM ) ) {
+    anchor( block, settings, item, end );
+    anchored = item;
+  }
+
+  while ( _skips.size() ) {
+    const gap_t &gap = _skips.front();
+    const uint64_t at = std::max( gap.at, first );
+
+    if ( at >= end )
+      break;
+
+    const pmt::pmt_t lost = pmt::from_long( gap.lost );
+    for ( size_t chan = 0; chan < settings.nchan; chan++ )
+      block->add_item_tag( chan, at, GAP_KEY, lost );
+
+    if ( at != anchored ) {
+      anchor( block, settings, at, end );
+      anchored = at;
+    }
+
+    _skips.pop_front();
+  }
+
+  if ( ! _gaps_pending.load() )
+    return;
+
+  std::lock_guard< std::mutex > lock( _gaps_mutex );
+
+  while ( _gaps.size() ) {
+    const gap_t &gap = _gaps.front();
+    /* a gap among discarded items is tagged with them */
+    const uint64_t at = gap.at > _skipped ?
+                        std::max( _base + gap.at - _skipped, first ) : first;
+
+    if ( at >= end )
+      break;
+
+    const pmt::pmt_t lost = pmt::from_long( gap.lost );
+    for ( size_t chan = 0; chan < settings.nchan; chan++ )
+      block->add_item_tag( chan, at, GAP_KEY, lost );
+
+    if ( at != anchored ) {
+      anchor( block, settings, at, end );
+      anchored = at;
+    }
+
+    _gaps.pop_front();
+  }
+
+  _gaps_pending = _gaps.size() > 0;
+}
+
+void rx_tagger::anchor( gr::block *block, const settings_t &settings,
+                        uint64_t item, uint64_t end )
+{
+  static const pmt::pmt_t TIME_KEY = pmt::string_to_symbol( "rx_time" );
+  static const pmt::pmt_t RATE_KEY = pmt::string_to_symbol( "rx_rate" );
+  static const pmt::pmt_t FREQ_KEY = pmt::string_to_symbol( "rx_freq" );
+
+  double rate = settings.rate;
+  double now;
+
+  {
+    std::lock_guard< std::mutex > fit( _fit_mutex );
+
+    const double measured = fitted_rate();
+    if ( measured > 0 ) {
+      /* the time the fit gives for the device counter of the item, taking
+       * the items lost so far as lost before it */
+      const double x = double( item - _base + _skipped + _fit_lost + 1 );
+
+      now = _fit_wall + _fit_t0 + _fit_my + ( x - _fit_mx ) / measured;
+      rate = measured;
+    } else {
+      /* the items have just been received, so the first of them was
+       * sampled about their duration ago */
+      now = system_secs();
+      if ( settings.rate > 0 )
+        now -= ( end - item ) / settings.rate;
+    }
+
+    _tagged_rate = measured;
+  }
+
+  const uint64_t secs = uint64_t( now );
+  const pmt::pmt_t time = pmt::make_tuple( pmt::from_uint64( secs ),
+                                           pmt::from_double( now - secs ) );
+
+  for ( size_t chan = 0; chan < settings.nchan; chan++ )
+  {
+    block->add_item_tag( chan, item, TIME_KEY, time );
+    if ( rate > 0 )
+      block->add_item_tag( chan, item, RATE_KEY, pmt::from_double( rate ) );
+    block->add_item_tag( chan, item, FREQ_KEY, pmt::from_double( settings.freq[chan] ) );
+  }
+}
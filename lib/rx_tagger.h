@@ -0,0 +1,191 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_RX_TAGGER_H
+#define INCLUDED_OSMOSDR_RX_TAGGER_H
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <gnuradio/block.h>
+
+#include <osmosdr/api.h>
+
+#include "settings_snapshot.h"
+
+/* channels of a single device sharing one rx_tagger */
+#define RX_TAGGER_MAX_CHANNELS 8
+
+/*!
+ * rx_time, rx_rate and rx_freq stream tags for sources without hardware
+ * timestamps.
+ *
+ * The item counter of the block (nitems_written) serves as the sample
+ * clock. Whenever it stops being continuous with real time, i.e. at
+ * stream start, after samples were lost or after the device has been
+ * retuned, the driver calls retag() and the next update() anchors the
+ * produced items to the host clock, in the format gr-uhd uses.
+ *
+ * Drivers buffering the samples report the items they store with stored()
+ * and the items they had to drop with lost(). The first item stored after
+ * such a gap is tagged rx_gap with the number of items lost, like the
+ * soapy source does, and re-anchored, so downstream blocks can skip
+ * ahead by exactly that many items instead of searching for sync again.
+ * Without stored() the tags go on the next item produced. Items discarded
+ * unread are reported by work() with skipped().
+ *
+ * The arrival times of the stored items are fitted against the sample
+ * counter of the device, stored and lost items, by least squares. Once
+ * they span RATE_FIT_SECS the measured sample rate replaces the nominal
+ * one in rx_rate and rx_time follows the fit instead of the arrival of
+ * each buffer, so the tags track the actual clock of a free-running
+ * device. Whenever the estimate moves by more than RATE_RETAG_PPM from
+ * the rate tagged last, the stream is anchored again.
+ *
+ * retag(), retag_at(), stored(), lost() and the setters may be called
+ * from any thread, reset() only while work() is not running, skipped()
+ * and update() only from work(). The rate and frequencies are published
+ * to work() as a settings_snapshot, so retuning never blocks it.
+ */
+class OSMOSDR_API rx_tagger
+{
+public:
+  explicit rx_tagger( size_t nchan = 1 );
+
+  void set_num_channels( size_t nchan );
+
+  /*! anchor the next items produced to the host clock */
+  void retag()
+  {
+    uint64_t none = NO_ITEM;
+    _retag.compare_exchange_strong( none, 0 ); /* keeps a pending retag_at() */
+  }
+
+  /*!
+   * Anchor the given item of the stream instead, e.g. the first one
+   * received after a timed command took effect. Replaces a pending retag().
+   */
+  void retag_at( uint64_t item ) { _retag.store( item ); }
+
+  /*! streaming (re)starts, nothing has been stored yet, implies retag() */
+  void reset();
+
+  /*! the capture side stored nitems more items for work(), just now */
+  void stored( size_t nitems )
+  {
+    _stored.fetch_add( nitems );
+    sampled( nitems );
+  }
+
+  /*! nitems items were lost right after those stored so far */
+  void lost( uint64_t nitems );
+
+  /*!
+   * nitems items stored were discarded before they were read, e.g. by
+   * overflow=drop-oldest, item is the stream index following them
+   */
+  void skipped( uint64_t item, uint64_t nitems )
+  {
+    gap_t gap = { item, nitems };
+    _skips.push_back( gap );
+    _skipped += nitems;
+  }
+
+  /*! new sample rate, implies retag() */
+  void set_rate( double rate );
+
+  /*! the sample rate measured against the host clock, 0 until known */
+  double measured_rate();
+
+  /*! new center frequency of channel chan, implies retag() */
+  void set_freq( double freq, size_t chan = 0 );
+
+  /*!
+   * Tag the first of nitems items work() is about to return, or the item
+   * given to retag_at() if it is among them, if a new anchor has been
+   * requested since, and the gaps among them.
+   */
+  void update( gr::block *block, int nitems )
+  {
+    if ( nitems <= 0 )
+      return;
+
+    if ( _base == NO_ITEM )
+      _base = block->nitems_written( 0 );
+
+    if ( _retag.load() != NO_ITEM || _gaps_pending.load() || _skips.size() )
+      tag( block, nitems );
+  }
+
+private:
+  static const uint64_t NO_ITEM = ~uint64_t(0);
+
+  struct gap_t
+  {
+    uint64_t at;    /**< items stored before the gap, or its stream index */
+    uint64_t lost;
+  };
+
+  /* what the setters publish to work() */
+  struct settings_t
+  {
+    double rate;
+    size_t nchan;
+    double freq[ RX_TAGGER_MAX_CHANNELS ];
+  };
+
+  void tag( gr::block *block, size_t nitems );
+  void anchor( gr::block *block, const settings_t &settings,
+               uint64_t item, uint64_t end );
+
+  void sampled( uint64_t nitems );
+  void reset_fit();
+  double fitted_rate() const;
+
+  std::atomic<uint64_t> _retag; /**< item to anchor, 0 for the next one */
+
+  std::atomic<uint64_t> _stored;
+  std::atomic<bool> _gaps_pending;
+  std::mutex _gaps_mutex;
+  std::deque< gap_t > _gaps;
+  uint64_t _base;               /**< stream index of the first item stored */
+  uint64_t _skipped;            /**< stored items discarded unread */
+  std::deque< gap_t > _skips;   /**< owned by work() as well */
+
+  std::mutex _mutex;             /**< serializes the setters, not work() */
+  settings_snapshot< settings_t > _settings;
+
+  /* arrival time over sample counter, see sampled() */
+  std::mutex _fit_mutex;
+  uint64_t _fit_count;          /**< items sampled, stored or lost */
+  uint64_t _fit_lost;           /**< of them lost */
+  uint64_t _fit_points;
+  double _fit_t0;               /**< steady clock seconds of the first point */
+  double _fit_wall;             /**< system clock ahead of the steady clock */
+  double _fit_span;             /**< seconds since the first point */
+  double _fit_mx, _fit_my;      /**< means of counter and seconds */
+  double _fit_sxx, _fit_sxy;    /**< co-moments */
+  double _tagged_rate;          /**< measured rate of the last anchor, or 0 */
+};
+
+#endif /* INCLUDED_OSMOSDR_RX_TAGGER_H */
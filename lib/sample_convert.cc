@@ -0,0 +1,2539 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "sample_convert.h"
+
+#include <algorithm>
+#include <cmath>
+
+/*
+ * GCC and Clang allow compiling individual functions for a newer ISA than
+ * the rest of the translation unit and can query the CPU at runtime, with
+ * MSVC we stick to what the target architecture guarantees.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CONVERT_X86_DISPATCH
+#define CONVERT_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && \
+    (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define CONVERT_X86_SSE2
+#define CONVERT_TARGET(isa)
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CONVERT_NEON
+#endif
+
+namespace {
+
+/***********************************************************************
+ * Generic implementations
+ **********************************************************************/
+
+struct cu8_lut_t
+{
+  float v[0x100];
+
+  cu8_lut_t()
+  {
+    for (unsigned int i = 0; i < 0x100; i++)
+      v[i] = (float(i) - 127.4f) * (1.0f / 128.0f);
+  }
+};
+
+const cu8_lut_t _cu8_lut;
+
+void convert_cu8_fc32_generic( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  const float *lut = _cu8_lut.v;
+
+  for (size_t i = 0; i < nitems; i++)
+    out[i] = gr_complex( lut[in[i * 2]], lut[in[i * 2 + 1]] );
+}
+
+void convert_cu8_fc32_deinterleave_generic( const uint8_t *in,
+                                            gr_complex * const *out,
+                                            size_t nchan, size_t nitems )
+{
+  const float *lut = _cu8_lut.v;
+
+  for (size_t i = 0; i < nitems; i++)
+    for (size_t c = 0; c < nchan; c++, in += 2)
+      out[c][i] = gr_complex( lut[in[0]], lut[in[1]] );
+}
+
+void convert_cs8_fc32_generic( const int8_t *in, gr_complex *out, size_t nitems )
+{
+  for (size_t i = 0; i < nitems; i++)
+    out[i] = gr_complex( in[i * 2] * (1.0f / 128.0f),
+                         in[i * 2 + 1] * (1.0f / 128.0f) );
+}
+
+void convert_cs8_fc32_x2_generic( const int8_t *in, gr_complex *out0,
+                                  gr_complex *out1, size_t nitems )
+{
+  for (size_t i = 0; i < nitems; i++, in += 4) {
+    out0[i] = gr_complex( in[0] * (1.0f / 128.0f), in[1] * (1.0f / 128.0f) );
+    out1[i] = gr_complex( in[2] * (1.0f / 128.0f), in[3] * (1.0f / 128.0f) );
+  }
+}
+
+void convert_cs8_fc32_deinterleave_generic( const int8_t *in,
+                                            gr_complex * const *out,
+                                            size_t nchan, size_t nitems )
+{
+  for (size_t i = 0; i < nitems; i++)
+    for (size_t c = 0; c < nchan; c++, in += 2)
+      out[c][i] = gr_complex( in[0] * (1.0f / 128.0f), in[1] * (1.0f / 128.0f) );
+}
+
+void convert_cs16_fc32_generic( const int16_t *in, gr_complex *out,
+                                size_t nitems, float scale )
+{
+  const float k = 1.0f / scale;
+
+  for (size_t i = 0; i < nitems; i++)
+    out[i] = gr_complex( in[i * 2] * k, in[i * 2 + 1] * k );
+}
+
+void convert_cs16_fc32_x2_generic( const int16_t *in, gr_complex *out0,
+                                   gr_complex *out1, size_t nitems, float scale )
+{
+  const float k = 1.0f / scale;
+
+  for (size_t i = 0; i < nitems; i++, in += 4) {
+    out0[i] = gr_complex( in[0] * k, in[1] * k );
+    out1[i] = gr_complex( in[2] * k, in[3] * k );
+  }
+}
+
+void convert_cs16_fc32_deinterleave_generic( const int16_t *in,
+                                             gr_complex * const *out,
+                                             size_t nchan, size_t nitems,
+                                             float scale )
+{
+  const float k = 1.0f / scale;
+
+  for (size_t i = 0; i < nitems; i++)
+    for (size_t c = 0; c < nchan; c++, in += 2)
+      out[c][i] = gr_complex( in[0] * k, in[1] * k );
+}
+
+gr_complex convert_cu8_fc32_dc_generic( const uint8_t *in, gr_complex *out,
+                                        size_t nitems, gr_complex dc )
+{
+  const float *lut = _cu8_lut.v;
+  float sum_i = 0.0f, sum_q = 0.0f;
+
+  for (size_t i = 0; i < nitems; i++) {
+    const float v_i = lut[in[i * 2]] - dc.real();
+    const float v_q = lut[in[i * 2 + 1]] - dc.imag();
+
+    out[i] = gr_complex( v_i, v_q );
+    sum_i += v_i;
+    sum_q += v_q;
+  }
+
+  return gr_complex( sum_i, sum_q );
+}
+
+gr_complex convert_cs8_fc32_dc_generic( const int8_t *in, gr_complex *out,
+                                        size_t nitems, gr_complex dc )
+{
+  float sum_i = 0.0f, sum_q = 0.0f;
+
+  for (size_t i = 0; i < nitems; i++) {
+    const float v_i = in[i * 2] * (1.0f / 128.0f) - dc.real();
+    const float v_q = in[i * 2 + 1] * (1.0f / 128.0f) - dc.imag();
+
+    out[i] = gr_complex( v_i, v_q );
+    sum_i += v_i;
+    sum_q += v_q;
+  }
+
+  return gr_complex( sum_i, sum_q );
+}
+
+gr_complex convert_cs16_fc32_dc_generic( const int16_t *in, gr_complex *out,
+                                         size_t nitems, float scale, gr_complex dc )
+{
+  const float k = 1.0f / scale;
+  float sum_i = 0.0f, sum_q = 0.0f;
+
+  for (size_t i = 0; i < nitems; i++) {
+    const float v_i = in[i * 2] * k - dc.real();
+    const float v_q = in[i * 2 + 1] * k - dc.imag();
+
+    out[i] = gr_complex( v_i, v_q );
+    sum_i += v_i;
+    sum_q += v_q;
+  }
+
+  return gr_complex( sum_i, sum_q );
+}
+
+gr_complex remove_dc_fc32_generic( const gr_complex *in, gr_complex *out,
+                                   size_t nitems, gr_complex dc )
+{
+  float sum_i = 0.0f, sum_q = 0.0f;
+
+  for (size_t i = 0; i < nitems; i++) {
+    const float v_i = in[i].real() - dc.real();
+    const float v_q = in[i].imag() - dc.imag();
+
+    out[i] = gr_complex( v_i, v_q );
+    sum_i += v_i;
+    sum_q += v_q;
+  }
+
+  return gr_complex( sum_i, sum_q );
+}
+
+/*
+ * The kernels of the software AGC: out = in * k - off, with the DC offset
+ * and the gain folded into k and off. They return the sum of out and add
+ * the sum of |out|^2 to power.
+ */
+gr_complex convert_cu8_fc32_agc_generic( const uint8_t *in, gr_complex *out, size_t nitems,
+                                         float k, gr_complex off, float clip, sample_level_t &level )
+{
+  float sum_i = 0.0f, sum_q = 0.0f, pwr = 0.0f, peak = level.peak;
+  size_t clipped = 0;
+
+  for (size_t i = 0; i < nitems; i++) {
+    const float v_i = in[i * 2] * k - off.real();
+    const float v_q = in[i * 2 + 1] * k - off.imag();
+
+    out[i] = gr_complex( v_i, v_q );
+    sum_i += v_i;
+    sum_q += v_q;
+    pwr += v_i * v_i + v_q * v_q;
+
+    const float a_i = std::fabs( v_i ), a_q = std::fabs( v_q );
+    peak = std::max( peak, std::max( a_i, a_q ) );
+    clipped += ( a_i >= clip ) + ( a_q >= clip );
+  }
+
+  level.power += pwr;
+  level.peak = peak;
+  level.clipped += clipped;
+  return gr_complex( sum_i, sum_q );
+}
+
+gr_complex convert_cs8_fc32_agc_generic( const int8_t *in, gr_complex *out, size_t nitems,
+                                         float k, gr_complex off, float clip, sample_level_t &level )
+{
+  float sum_i = 0.0f, sum_q = 0.0f, pwr = 0.0f, peak = level.peak;
+  size_t clipped = 0;
+
+  for (size_t i = 0; i < nitems; i++) {
+    const float v_i = in[i * 2] * k - off.real();
+    const float v_q = in[i * 2 + 1] * k - off.imag();
+
+    out[i] = gr_complex( v_i, v_q );
+    sum_i += v_i;
+    sum_q += v_q;
+    pwr += v_i * v_i + v_q * v_q;
+
+    const float a_i = std::fabs( v_i ), a_q = std::fabs( v_q );
+    peak = std::max( peak, std::max( a_i, a_q ) );
+    clipped += ( a_i >= clip ) + ( a_q >= clip );
+  }
+
+  level.power += pwr;
+  level.peak = peak;
+  level.clipped += clipped;
+  return gr_complex( sum_i, sum_q );
+}
+
+gr_complex convert_cs16_fc32_agc_generic( const int16_t *in, gr_complex *out, size_t nitems,
+                                          float k, gr_complex off, float clip, sample_level_t &level )
+{
+  float sum_i = 0.0f, sum_q = 0.0f, pwr = 0.0f, peak = level.peak;
+  size_t clipped = 0;
+
+  for (size_t i = 0; i < nitems; i++) {
+    const float v_i = in[i * 2] * k - off.real();
+    const float v_q = in[i * 2 + 1] * k - off.imag();
+
+    out[i] = gr_complex( v_i, v_q );
+    sum_i += v_i;
+    sum_q += v_q;
+    pwr += v_i * v_i + v_q * v_q;
+
+    const float a_i = std::fabs( v_i ), a_q = std::fabs( v_q );
+    peak = std::max( peak, std::max( a_i, a_q ) );
+    clipped += ( a_i >= clip ) + ( a_q >= clip );
+  }
+
+  level.power += pwr;
+  level.peak = peak;
+  level.clipped += clipped;
+  return gr_complex( sum_i, sum_q );
+}
+
+gr_complex scale_fc32_agc_generic( const gr_complex *in, gr_complex *out, size_t nitems,
+                                   float k, gr_complex off, float clip, sample_level_t &level )
+{
+  float sum_i = 0.0f, sum_q = 0.0f, pwr = 0.0f, peak = level.peak;
+  size_t clipped = 0;
+
+  for (size_t i = 0; i < nitems; i++) {
+    const float v_i = in[i].real() * k - off.real();
+    const float v_q = in[i].imag() * k - off.imag();
+
+    out[i] = gr_complex( v_i, v_q );
+    sum_i += v_i;
+    sum_q += v_q;
+    pwr += v_i * v_i + v_q * v_q;
+
+    const float a_i = std::fabs( v_i ), a_q = std::fabs( v_q );
+    peak = std::max( peak, std::max( a_i, a_q ) );
+    clipped += ( a_i >= clip ) + ( a_q >= clip );
+  }
+
+  level.power += pwr;
+  level.peak = peak;
+  level.clipped += clipped;
+  return gr_complex( sum_i, sum_q );
+}
+
+inline int8_t float_to_cs8( float v )
+{
+  v *= 127.0f;
+  v = std::min( std::max( v, -128.0f ), 127.0f );
+  return int8_t( std::lrint( v ) );
+}
+
+void convert_cs16_planar_fc32_generic( const int16_t *in_i, const int16_t *in_q,
+                                       gr_complex *out, size_t nitems,
+                                       float scale )
+{
+  const float k = 1.0f / scale;
+
+  for (size_t i = 0; i < nitems; i++)
+    out[i] = gr_complex( in_i[i] * k, in_q[i] * k );
+}
+
+void convert_cs24_fc32_generic( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  /* place each value in the upper 24 bits, 2^31 then scales it exactly
+   * like a sign extension followed by a division by 2^23 would */
+  float *outf = (float *)out;
+
+  for (size_t i = 0; i < nitems * 2; i++, in += 3) {
+    int32_t v = (int32_t)( ((uint32_t)in[0] << 8) |
+                           ((uint32_t)in[1] << 16) |
+                           ((uint32_t)in[2] << 24) );
+    outf[i] = v * (1.0f / 2147483648.0f);
+  }
+}
+
+void convert_cs12_fc32_generic( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  /* move each value into the upper 12 bits of a 16 bit word, the
+   * arithmetic shift back down then extends the sign */
+  const float k = 1.0f / 2048.0f;
+
+  for (size_t i = 0; i < nitems; i++, in += 3) {
+    int16_t v_i = (int16_t)( (in[0] << 4) | (in[1] << 12) ) >> 4;
+    int16_t v_q = (int16_t)( in[1] | (in[2] << 8) ) >> 4;
+    out[i] = gr_complex( v_i * k, v_q * k );
+  }
+}
+
+void convert_fc32_cs8_generic( const gr_complex *in, int8_t *out, size_t nitems )
+{
+  const float *inf = (const float *)in;
+
+  for (size_t i = 0; i < nitems * 2; i++)
+    out[i] = float_to_cs8( inf[i] );
+}
+
+void convert_fc32_cs16_generic( const gr_complex *in, int16_t *out,
+                                size_t nitems, float scale )
+{
+  const float *inf = (const float *)in;
+
+  for (size_t i = 0; i < nitems * 2; i++) {
+    const float v = std::min( std::max( inf[i] * scale, -32768.0f ), 32767.0f );
+    out[i] = int16_t( std::lrint( v ) );
+  }
+}
+
+inline int16_t float_to_cs12( float v )
+{
+  v *= 2048.0f;
+  v = std::min( std::max( v, -2048.0f ), 2047.0f );
+  return int16_t( std::lrint( v ) );
+}
+
+void convert_fc32_cs12_generic( const gr_complex *in, uint8_t *out, size_t nitems )
+{
+  for (size_t i = 0; i < nitems; i++, out += 3) {
+    const uint16_t v_i = float_to_cs12( in[i].real() ) & 0xfff;
+    const uint16_t v_q = float_to_cs12( in[i].imag() ) & 0xfff;
+    out[0] = uint8_t( v_i );
+    out[1] = uint8_t( (v_i >> 8) | (v_q << 4) );
+    out[2] = uint8_t( v_q >> 4 );
+  }
+}
+
+/***********************************************************************
+ * x86 implementations
+ **********************************************************************/
+
+#if defined(CONVERT_X86_DISPATCH) || defined(CONVERT_X86_SSE2)
+CONVERT_TARGET("sse2")
+void convert_cu8_fc32_sse2( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  const __m128 offset = _mm_set1_ps( 127.4f );
+  const __m128 scale = _mm_set1_ps( 1.0f / 128.0f );
+  const __m128i zero = _mm_setzero_si128();
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    __m128i b = _mm_loadu_si128( (const __m128i *)(in + i) );
+    __m128i lo = _mm_unpacklo_epi8( b, zero );
+    __m128i hi = _mm_unpackhi_epi8( b, zero );
+
+    __m128 f0 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( lo, zero ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_unpackhi_epi16( lo, zero ) );
+    __m128 f2 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( hi, zero ) );
+    __m128 f3 = _mm_cvtepi32_ps( _mm_unpackhi_epi16( hi, zero ) );
+
+    _mm_storeu_ps( outf + i +  0, _mm_mul_ps( _mm_sub_ps( f0, offset ), scale ) );
+    _mm_storeu_ps( outf + i +  4, _mm_mul_ps( _mm_sub_ps( f1, offset ), scale ) );
+    _mm_storeu_ps( outf + i +  8, _mm_mul_ps( _mm_sub_ps( f2, offset ), scale ) );
+    _mm_storeu_ps( outf + i + 12, _mm_mul_ps( _mm_sub_ps( f3, offset ), scale ) );
+  }
+
+  convert_cu8_fc32_generic( in + i, out + i / 2, (nbytes - i) / 2 );
+}
+
+CONVERT_TARGET("sse2")
+void convert_cs8_fc32_sse2( const int8_t *in, gr_complex *out, size_t nitems )
+{
+  const __m128 scale = _mm_set1_ps( 1.0f / 128.0f );
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    __m128i b = _mm_loadu_si128( (const __m128i *)(in + i) );
+
+    /* sign extend by moving each byte into the upper half and shifting */
+    __m128i lo = _mm_srai_epi16( _mm_unpacklo_epi8( b, b ), 8 );
+    __m128i hi = _mm_srai_epi16( _mm_unpackhi_epi8( b, b ), 8 );
+
+    __m128 f0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( lo, lo ), 16 ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( lo, lo ), 16 ) );
+    __m128 f2 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( hi, hi ), 16 ) );
+    __m128 f3 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( hi, hi ), 16 ) );
+
+    _mm_storeu_ps( outf + i +  0, _mm_mul_ps( f0, scale ) );
+    _mm_storeu_ps( outf + i +  4, _mm_mul_ps( f1, scale ) );
+    _mm_storeu_ps( outf + i +  8, _mm_mul_ps( f2, scale ) );
+    _mm_storeu_ps( outf + i + 12, _mm_mul_ps( f3, scale ) );
+  }
+
+  convert_cs8_fc32_generic( in + i, out + i / 2, (nbytes - i) / 2 );
+}
+
+CONVERT_TARGET("sse2")
+void convert_cs8_fc32_x2_sse2( const int8_t *in, gr_complex *out0,
+                               gr_complex *out1, size_t nitems )
+{
+  const __m128 scale = _mm_set1_ps( 1.0f / 128.0f );
+
+  size_t i = 0;
+
+  for (; i + 4 <= nitems; i += 4) {
+    /* one I/Q pair per 16 bit lane: a0 b0 a1 b1 a2 b2 a3 b3, gather the
+     * pairs of channel 0 into the low and those of channel 1 into the
+     * high 64 bits */
+    __m128i v = _mm_loadu_si128( (const __m128i *)(in + i * 4) );
+    v = _mm_shufflelo_epi16( v, _MM_SHUFFLE(3, 1, 2, 0) );
+    v = _mm_shufflehi_epi16( v, _MM_SHUFFLE(3, 1, 2, 0) );
+    v = _mm_shuffle_epi32( v, _MM_SHUFFLE(3, 1, 2, 0) );
+
+    /* sign extend by moving each byte into the upper half and shifting */
+    __m128i a = _mm_srai_epi16( _mm_unpacklo_epi8( v, v ), 8 );
+    __m128i b = _mm_srai_epi16( _mm_unpackhi_epi8( v, v ), 8 );
+
+    __m128 a0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( a, a ), 16 ) );
+    __m128 a1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( a, a ), 16 ) );
+    __m128 b0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( b, b ), 16 ) );
+    __m128 b1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( b, b ), 16 ) );
+
+    _mm_storeu_ps( (float *)(out0 + i) + 0, _mm_mul_ps( a0, scale ) );
+    _mm_storeu_ps( (float *)(out0 + i) + 4, _mm_mul_ps( a1, scale ) );
+    _mm_storeu_ps( (float *)(out1 + i) + 0, _mm_mul_ps( b0, scale ) );
+    _mm_storeu_ps( (float *)(out1 + i) + 4, _mm_mul_ps( b1, scale ) );
+  }
+
+  convert_cs8_fc32_x2_generic( in + i * 4, out0 + i, out1 + i, nitems - i );
+}
+
+CONVERT_TARGET("sse2")
+void convert_cs16_fc32_sse2( const int16_t *in, gr_complex *out,
+                             size_t nitems, float scale )
+{
+  const __m128 k = _mm_set1_ps( 1.0f / scale );
+
+  float *outf = (float *)out;
+  const size_t nvals = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 8 <= nvals; i += 8) {
+    __m128i v = _mm_loadu_si128( (const __m128i *)(in + i) );
+
+    /* sign extend by moving each value into the upper half and shifting */
+    __m128 f0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 ) );
+
+    _mm_storeu_ps( outf + i + 0, _mm_mul_ps( f0, k ) );
+    _mm_storeu_ps( outf + i + 4, _mm_mul_ps( f1, k ) );
+  }
+
+  convert_cs16_fc32_generic( in + i, out + i / 2, (nvals - i) / 2, scale );
+}
+
+CONVERT_TARGET("sse2")
+void convert_cs16_planar_fc32_sse2( const int16_t *in_i, const int16_t *in_q,
+                                    gr_complex *out, size_t nitems,
+                                    float scale )
+{
+  const __m128 k = _mm_set1_ps( 1.0f / scale );
+
+  float *outf = (float *)out;
+  size_t i = 0;
+
+  for (; i + 8 <= nitems; i += 8) {
+    __m128i vi = _mm_loadu_si128( (const __m128i *)(in_i + i) );
+    __m128i vq = _mm_loadu_si128( (const __m128i *)(in_q + i) );
+
+    /* interleave to I/Q pairs, then sign extend as above */
+    __m128i lo = _mm_unpacklo_epi16( vi, vq );
+    __m128i hi = _mm_unpackhi_epi16( vi, vq );
+
+    __m128 f0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( lo, lo ), 16 ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( lo, lo ), 16 ) );
+    __m128 f2 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( hi, hi ), 16 ) );
+    __m128 f3 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( hi, hi ), 16 ) );
+
+    _mm_storeu_ps( outf + i * 2 +  0, _mm_mul_ps( f0, k ) );
+    _mm_storeu_ps( outf + i * 2 +  4, _mm_mul_ps( f1, k ) );
+    _mm_storeu_ps( outf + i * 2 +  8, _mm_mul_ps( f2, k ) );
+    _mm_storeu_ps( outf + i * 2 + 12, _mm_mul_ps( f3, k ) );
+  }
+
+  convert_cs16_planar_fc32_generic( in_i + i, in_q + i, out + i, nitems - i, scale );
+}
+
+CONVERT_TARGET("sse2")
+void convert_cs16_fc32_x2_sse2( const int16_t *in, gr_complex *out0,
+                                gr_complex *out1, size_t nitems, float scale )
+{
+  const __m128 k = _mm_set1_ps( 1.0f / scale );
+
+  size_t i = 0;
+
+  for (; i + 2 <= nitems; i += 2) {
+    /* one I/Q pair per 32 bit lane: a0 b0 a1 b1 -> a0 a1 b0 b1 */
+    __m128i v = _mm_loadu_si128( (const __m128i *)(in + i * 4) );
+    v = _mm_shuffle_epi32( v, _MM_SHUFFLE(3, 1, 2, 0) );
+
+    __m128 f0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 ) );
+
+    _mm_storeu_ps( (float *)(out0 + i), _mm_mul_ps( f0, k ) );
+    _mm_storeu_ps( (float *)(out1 + i), _mm_mul_ps( f1, k ) );
+  }
+
+  convert_cs16_fc32_x2_generic( in + i * 4, out0 + i, out1 + i, nitems - i, scale );
+}
+
+CONVERT_TARGET("sse2")
+void convert_fc32_cs8_sse2( const gr_complex *in, int8_t *out, size_t nitems )
+{
+  const __m128 scale = _mm_set1_ps( 127.0f );
+  /* out of range floats convert to INT_MIN, clamp them beforehand */
+  const __m128 lo = _mm_set1_ps( -128.0f );
+  const __m128 hi = _mm_set1_ps( 127.0f );
+
+  const float *inf = (const float *)in;
+  const size_t nfloats = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nfloats; i += 16) {
+    __m128 f0 = _mm_mul_ps( _mm_loadu_ps( inf + i +  0 ), scale );
+    __m128 f1 = _mm_mul_ps( _mm_loadu_ps( inf + i +  4 ), scale );
+    __m128 f2 = _mm_mul_ps( _mm_loadu_ps( inf + i +  8 ), scale );
+    __m128 f3 = _mm_mul_ps( _mm_loadu_ps( inf + i + 12 ), scale );
+
+    __m128i i0 = _mm_cvtps_epi32( _mm_min_ps( _mm_max_ps( f0, lo ), hi ) );
+    __m128i i1 = _mm_cvtps_epi32( _mm_min_ps( _mm_max_ps( f1, lo ), hi ) );
+    __m128i i2 = _mm_cvtps_epi32( _mm_min_ps( _mm_max_ps( f2, lo ), hi ) );
+    __m128i i3 = _mm_cvtps_epi32( _mm_min_ps( _mm_max_ps( f3, lo ), hi ) );
+
+    __m128i s0 = _mm_packs_epi32( i0, i1 );
+    __m128i s1 = _mm_packs_epi32( i2, i3 );
+
+    _mm_storeu_si128( (__m128i *)(out + i), _mm_packs_epi16( s0, s1 ) );
+  }
+
+  convert_fc32_cs8_generic( in + i / 2, out + i, (nfloats - i) / 2 );
+}
+
+CONVERT_TARGET("sse2")
+void convert_fc32_cs16_sse2( const gr_complex *in, int16_t *out,
+                             size_t nitems, float scale )
+{
+  const __m128 k = _mm_set1_ps( scale );
+  /* out of range floats convert to INT_MIN, clamp them beforehand */
+  const __m128 lo = _mm_set1_ps( -32768.0f );
+  const __m128 hi = _mm_set1_ps( 32767.0f );
+
+  const float *inf = (const float *)in;
+  const size_t nfloats = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 8 <= nfloats; i += 8) {
+    __m128 f0 = _mm_mul_ps( _mm_loadu_ps( inf + i + 0 ), k );
+    __m128 f1 = _mm_mul_ps( _mm_loadu_ps( inf + i + 4 ), k );
+
+    __m128i i0 = _mm_cvtps_epi32( _mm_min_ps( _mm_max_ps( f0, lo ), hi ) );
+    __m128i i1 = _mm_cvtps_epi32( _mm_min_ps( _mm_max_ps( f1, lo ), hi ) );
+
+    _mm_storeu_si128( (__m128i *)(out + i), _mm_packs_epi32( i0, i1 ) );
+  }
+
+  convert_fc32_cs16_generic( in + i / 2, out + i, (nfloats - i) / 2, scale );
+}
+
+/* the sum of the I and of the Q lanes of an I, Q, I, Q accumulator */
+CONVERT_TARGET("sse2")
+inline gr_complex sum_iq_sse2( __m128 acc )
+{
+  float v[4];
+  _mm_storeu_ps( v, acc );
+  return gr_complex( v[0] + v[2], v[1] + v[3] );
+}
+
+CONVERT_TARGET("sse2")
+gr_complex convert_cu8_fc32_dc_sse2( const uint8_t *in, gr_complex *out,
+                                     size_t nitems, gr_complex dc )
+{
+  /* (x - 127.4) / 128 - dc, folded into one multiply and subtract */
+  const __m128 offset = _mm_setr_ps( 127.4f / 128.0f + dc.real(), 127.4f / 128.0f + dc.imag(),
+                                     127.4f / 128.0f + dc.real(), 127.4f / 128.0f + dc.imag() );
+  const __m128 scale = _mm_set1_ps( 1.0f / 128.0f );
+  const __m128i zero = _mm_setzero_si128();
+  __m128 acc = _mm_setzero_ps();
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    __m128i b = _mm_loadu_si128( (const __m128i *)(in + i) );
+    __m128i lo = _mm_unpacklo_epi8( b, zero );
+    __m128i hi = _mm_unpackhi_epi8( b, zero );
+
+    __m128 f0 = _mm_sub_ps( _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( lo, zero ) ), scale ), offset );
+    __m128 f1 = _mm_sub_ps( _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( lo, zero ) ), scale ), offset );
+    __m128 f2 = _mm_sub_ps( _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( hi, zero ) ), scale ), offset );
+    __m128 f3 = _mm_sub_ps( _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( hi, zero ) ), scale ), offset );
+
+    _mm_storeu_ps( outf + i +  0, f0 );
+    _mm_storeu_ps( outf + i +  4, f1 );
+    _mm_storeu_ps( outf + i +  8, f2 );
+    _mm_storeu_ps( outf + i + 12, f3 );
+
+    acc = _mm_add_ps( acc, _mm_add_ps( _mm_add_ps( f0, f1 ), _mm_add_ps( f2, f3 ) ) );
+  }
+
+  return sum_iq_sse2( acc ) +
+         convert_cu8_fc32_dc_generic( in + i, out + i / 2, (nbytes - i) / 2, dc );
+}
+
+CONVERT_TARGET("sse2")
+gr_complex convert_cs8_fc32_dc_sse2( const int8_t *in, gr_complex *out,
+                                     size_t nitems, gr_complex dc )
+{
+  const __m128 offset = _mm_setr_ps( dc.real(), dc.imag(), dc.real(), dc.imag() );
+  const __m128 scale = _mm_set1_ps( 1.0f / 128.0f );
+  __m128 acc = _mm_setzero_ps();
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    __m128i b = _mm_loadu_si128( (const __m128i *)(in + i) );
+
+    __m128i lo = _mm_srai_epi16( _mm_unpacklo_epi8( b, b ), 8 );
+    __m128i hi = _mm_srai_epi16( _mm_unpackhi_epi8( b, b ), 8 );
+
+    __m128 f0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( lo, lo ), 16 ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( lo, lo ), 16 ) );
+    __m128 f2 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( hi, hi ), 16 ) );
+    __m128 f3 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( hi, hi ), 16 ) );
+
+    f0 = _mm_sub_ps( _mm_mul_ps( f0, scale ), offset );
+    f1 = _mm_sub_ps( _mm_mul_ps( f1, scale ), offset );
+    f2 = _mm_sub_ps( _mm_mul_ps( f2, scale ), offset );
+    f3 = _mm_sub_ps( _mm_mul_ps( f3, scale ), offset );
+
+    _mm_storeu_ps( outf + i +  0, f0 );
+    _mm_storeu_ps( outf + i +  4, f1 );
+    _mm_storeu_ps( outf + i +  8, f2 );
+    _mm_storeu_ps( outf + i + 12, f3 );
+
+    acc = _mm_add_ps( acc, _mm_add_ps( _mm_add_ps( f0, f1 ), _mm_add_ps( f2, f3 ) ) );
+  }
+
+  return sum_iq_sse2( acc ) +
+         convert_cs8_fc32_dc_generic( in + i, out + i / 2, (nbytes - i) / 2, dc );
+}
+
+CONVERT_TARGET("sse2")
+gr_complex convert_cs16_fc32_dc_sse2( const int16_t *in, gr_complex *out,
+                                      size_t nitems, float scale, gr_complex dc )
+{
+  const __m128 offset = _mm_setr_ps( dc.real(), dc.imag(), dc.real(), dc.imag() );
+  const __m128 k = _mm_set1_ps( 1.0f / scale );
+  __m128 acc = _mm_setzero_ps();
+
+  float *outf = (float *)out;
+  const size_t nvals = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 8 <= nvals; i += 8) {
+    __m128i v = _mm_loadu_si128( (const __m128i *)(in + i) );
+
+    __m128 f0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 ) );
+
+    f0 = _mm_sub_ps( _mm_mul_ps( f0, k ), offset );
+    f1 = _mm_sub_ps( _mm_mul_ps( f1, k ), offset );
+
+    _mm_storeu_ps( outf + i + 0, f0 );
+    _mm_storeu_ps( outf + i + 4, f1 );
+
+    acc = _mm_add_ps( acc, _mm_add_ps( f0, f1 ) );
+  }
+
+  return sum_iq_sse2( acc ) +
+         convert_cs16_fc32_dc_generic( in + i, out + i / 2, (nvals - i) / 2, scale, dc );
+}
+
+CONVERT_TARGET("sse2")
+gr_complex remove_dc_fc32_sse2( const gr_complex *in, gr_complex *out,
+                                size_t nitems, gr_complex dc )
+{
+  const __m128 offset = _mm_setr_ps( dc.real(), dc.imag(), dc.real(), dc.imag() );
+  __m128 acc = _mm_setzero_ps();
+
+  const float *inf = (const float *)in;
+  float *outf = (float *)out;
+  const size_t nfloats = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 8 <= nfloats; i += 8) {
+    __m128 f0 = _mm_sub_ps( _mm_loadu_ps( inf + i + 0 ), offset );
+    __m128 f1 = _mm_sub_ps( _mm_loadu_ps( inf + i + 4 ), offset );
+
+    _mm_storeu_ps( outf + i + 0, f0 );
+    _mm_storeu_ps( outf + i + 4, f1 );
+
+    acc = _mm_add_ps( acc, _mm_add_ps( f0, f1 ) );
+  }
+
+  return sum_iq_sse2( acc ) +
+         remove_dc_fc32_generic( in + i / 2, out + i / 2, (nfloats - i) / 2, dc );
+}
+
+/* the per lane peak and count of clipped values of the software AGC */
+CONVERT_TARGET("sse2")
+inline void level_sse2( __m128 f, __m128 limit, __m128 &peak, __m128i &clipped )
+{
+  const __m128 a = _mm_andnot_ps( _mm_set1_ps( -0.0f ), f );
+  peak = _mm_max_ps( peak, a );
+  clipped = _mm_sub_epi32( clipped, _mm_castps_si128( _mm_cmpge_ps( a, limit ) ) );
+}
+
+CONVERT_TARGET("sse2")
+inline void add_level_sse2( __m128 pacc, __m128 peak, __m128i clipped, sample_level_t &level )
+{
+  float p[4], m[4];
+  int32_t c[4];
+  _mm_storeu_ps( p, pacc );
+  _mm_storeu_ps( m, peak );
+  _mm_storeu_si128( (__m128i *)c, clipped );
+
+  level.power += p[0] + p[1] + p[2] + p[3];
+  level.peak = std::max( std::max( m[0], m[1] ), std::max( m[2], m[3] ) );
+  level.clipped += c[0] + c[1] + c[2] + c[3];
+}
+
+CONVERT_TARGET("sse2")
+gr_complex convert_cu8_fc32_agc_sse2( const uint8_t *in, gr_complex *out, size_t nitems,
+                                      float k, gr_complex off, float clip, sample_level_t &level )
+{
+  const __m128 offset = _mm_setr_ps( off.real(), off.imag(), off.real(), off.imag() );
+  const __m128 scale = _mm_set1_ps( k );
+  const __m128i zero = _mm_setzero_si128();
+  __m128 acc = _mm_setzero_ps(), pacc = _mm_setzero_ps();
+  const __m128 limit = _mm_set1_ps( clip );
+  __m128 peak = _mm_set1_ps( level.peak );
+  __m128i clipped = _mm_setzero_si128();
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    __m128i b = _mm_loadu_si128( (const __m128i *)(in + i) );
+    __m128i lo = _mm_unpacklo_epi8( b, zero );
+    __m128i hi = _mm_unpackhi_epi8( b, zero );
+
+    __m128 f0 = _mm_sub_ps( _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( lo, zero ) ), scale ), offset );
+    __m128 f1 = _mm_sub_ps( _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( lo, zero ) ), scale ), offset );
+    __m128 f2 = _mm_sub_ps( _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( hi, zero ) ), scale ), offset );
+    __m128 f3 = _mm_sub_ps( _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( hi, zero ) ), scale ), offset );
+
+    _mm_storeu_ps( outf + i +  0, f0 );
+    _mm_storeu_ps( outf + i +  4, f1 );
+    _mm_storeu_ps( outf + i +  8, f2 );
+    _mm_storeu_ps( outf + i + 12, f3 );
+
+    acc = _mm_add_ps( acc, _mm_add_ps( _mm_add_ps( f0, f1 ), _mm_add_ps( f2, f3 ) ) );
+    pacc = _mm_add_ps( pacc, _mm_add_ps( _mm_add_ps( _mm_mul_ps( f0, f0 ), _mm_mul_ps( f1, f1 ) ),
+                                         _mm_add_ps( _mm_mul_ps( f2, f2 ), _mm_mul_ps( f3, f3 ) ) ) );
+    level_sse2( f0, limit, peak, clipped );
+    level_sse2( f1, limit, peak, clipped );
+    level_sse2( f2, limit, peak, clipped );
+    level_sse2( f3, limit, peak, clipped );
+  }
+
+  add_level_sse2( pacc, peak, clipped, level );
+
+  return sum_iq_sse2( acc ) +
+         convert_cu8_fc32_agc_generic( in + i, out + i / 2, (nbytes - i) / 2, k, off, clip, level );
+}
+
+CONVERT_TARGET("sse2")
+gr_complex convert_cs8_fc32_agc_sse2( const int8_t *in, gr_complex *out, size_t nitems,
+                                      float k, gr_complex off, float clip, sample_level_t &level )
+{
+  const __m128 offset = _mm_setr_ps( off.real(), off.imag(), off.real(), off.imag() );
+  const __m128 scale = _mm_set1_ps( k );
+  __m128 acc = _mm_setzero_ps(), pacc = _mm_setzero_ps();
+  const __m128 limit = _mm_set1_ps( clip );
+  __m128 peak = _mm_set1_ps( level.peak );
+  __m128i clipped = _mm_setzero_si128();
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    __m128i b = _mm_loadu_si128( (const __m128i *)(in + i) );
+
+    __m128i lo = _mm_srai_epi16( _mm_unpacklo_epi8( b, b ), 8 );
+    __m128i hi = _mm_srai_epi16( _mm_unpackhi_epi8( b, b ), 8 );
+
+    __m128 f0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( lo, lo ), 16 ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( lo, lo ), 16 ) );
+    __m128 f2 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( hi, hi ), 16 ) );
+    __m128 f3 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( hi, hi ), 16 ) );
+
+    f0 = _mm_sub_ps( _mm_mul_ps( f0, scale ), offset );
+    f1 = _mm_sub_ps( _mm_mul_ps( f1, scale ), offset );
+    f2 = _mm_sub_ps( _mm_mul_ps( f2, scale ), offset );
+    f3 = _mm_sub_ps( _mm_mul_ps( f3, scale ), offset );
+
+    _mm_storeu_ps( outf + i +  0, f0 );
+    _mm_storeu_ps( outf + i +  4, f1 );
+    _mm_storeu_ps( outf + i +  8, f2 );
+    _mm_storeu_ps( outf + i + 12, f3 );
+
+    acc = _mm_add_ps( acc, _mm_add_ps( _mm_add_ps( f0, f1 ), _mm_add_ps( f2, f3 ) ) );
+    pacc = _mm_add_ps( pacc, _mm_add_ps( _mm_add_ps( _mm_mul_ps( f0, f0 ), _mm_mul_ps( f1, f1 ) ),
+                                         _mm_add_ps( _mm_mul_ps( f2, f2 ), _mm_mul_ps( f3, f3 ) ) ) );
+    level_sse2( f0, limit, peak, clipped );
+    level_sse2( f1, limit, peak, clipped );
+    level_sse2( f2, limit, peak, clipped );
+    level_sse2( f3, limit, peak, clipped );
+  }
+
+  add_level_sse2( pacc, peak, clipped, level );
+
+  return sum_iq_sse2( acc ) +
+         convert_cs8_fc32_agc_generic( in + i, out + i / 2, (nbytes - i) / 2, k, off, clip, level );
+}
+
+CONVERT_TARGET("sse2")
+gr_complex convert_cs16_fc32_agc_sse2( const int16_t *in, gr_complex *out, size_t nitems,
+                                       float k, gr_complex off, float clip, sample_level_t &level )
+{
+  const __m128 offset = _mm_setr_ps( off.real(), off.imag(), off.real(), off.imag() );
+  const __m128 scale = _mm_set1_ps( k );
+  __m128 acc = _mm_setzero_ps(), pacc = _mm_setzero_ps();
+  const __m128 limit = _mm_set1_ps( clip );
+  __m128 peak = _mm_set1_ps( level.peak );
+  __m128i clipped = _mm_setzero_si128();
+
+  float *outf = (float *)out;
+  const size_t nvals = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 8 <= nvals; i += 8) {
+    __m128i v = _mm_loadu_si128( (const __m128i *)(in + i) );
+
+    __m128 f0 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 ) );
+    __m128 f1 = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 ) );
+
+    f0 = _mm_sub_ps( _mm_mul_ps( f0, scale ), offset );
+    f1 = _mm_sub_ps( _mm_mul_ps( f1, scale ), offset );
+
+    _mm_storeu_ps( outf + i + 0, f0 );
+    _mm_storeu_ps( outf + i + 4, f1 );
+
+    acc = _mm_add_ps( acc, _mm_add_ps( f0, f1 ) );
+    pacc = _mm_add_ps( pacc, _mm_add_ps( _mm_mul_ps( f0, f0 ), _mm_mul_ps( f1, f1 ) ) );
+    level_sse2( f0, limit, peak, clipped );
+    level_sse2( f1, limit, peak, clipped );
+  }
+
+  add_level_sse2( pacc, peak, clipped, level );
+
+  return sum_iq_sse2( acc ) +
+         convert_cs16_fc32_agc_generic( in + i, out + i / 2, (nvals - i) / 2, k, off, clip, level );
+}
+
+CONVERT_TARGET("sse2")
+gr_complex scale_fc32_agc_sse2( const gr_complex *in, gr_complex *out, size_t nitems,
+                                float k, gr_complex off, float clip, sample_level_t &level )
+{
+  const __m128 offset = _mm_setr_ps( off.real(), off.imag(), off.real(), off.imag() );
+  const __m128 scale = _mm_set1_ps( k );
+  __m128 acc = _mm_setzero_ps(), pacc = _mm_setzero_ps();
+  const __m128 limit = _mm_set1_ps( clip );
+  __m128 peak = _mm_set1_ps( level.peak );
+  __m128i clipped = _mm_setzero_si128();
+
+  const float *inf = (const float *)in;
+  float *outf = (float *)out;
+  const size_t nfloats = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 8 <= nfloats; i += 8) {
+    __m128 f0 = _mm_sub_ps( _mm_mul_ps( _mm_loadu_ps( inf + i + 0 ), scale ), offset );
+    __m128 f1 = _mm_sub_ps( _mm_mul_ps( _mm_loadu_ps( inf + i + 4 ), scale ), offset );
+
+    _mm_storeu_ps( outf + i + 0, f0 );
+    _mm_storeu_ps( outf + i + 4, f1 );
+
+    acc = _mm_add_ps( acc, _mm_add_ps( f0, f1 ) );
+    pacc = _mm_add_ps( pacc, _mm_add_ps( _mm_mul_ps( f0, f0 ), _mm_mul_ps( f1, f1 ) ) );
+    level_sse2( f0, limit, peak, clipped );
+    level_sse2( f1, limit, peak, clipped );
+  }
+
+  add_level_sse2( pacc, peak, clipped, level );
+
+  return sum_iq_sse2( acc ) +
+         scale_fc32_agc_generic( in + i / 2, out + i / 2, (nfloats - i) / 2, k, off, clip, level );
+}
+#endif
+
+#ifdef CONVERT_X86_DISPATCH
+CONVERT_TARGET("avx")
+void convert_fc32_cs8_avx( const gr_complex *in, int8_t *out, size_t nitems )
+{
+  const __m256 scale = _mm256_set1_ps( 127.0f );
+  const __m256 lo = _mm256_set1_ps( -128.0f );
+  const __m256 hi = _mm256_set1_ps( 127.0f );
+
+  const float *inf = (const float *)in;
+  const size_t nfloats = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nfloats; i += 16) {
+    __m256 f0 = _mm256_mul_ps( _mm256_loadu_ps( inf + i + 0 ), scale );
+    __m256 f1 = _mm256_mul_ps( _mm256_loadu_ps( inf + i + 8 ), scale );
+
+    __m256i i0 = _mm256_cvtps_epi32( _mm256_min_ps( _mm256_max_ps( f0, lo ), hi ) );
+    __m256i i1 = _mm256_cvtps_epi32( _mm256_min_ps( _mm256_max_ps( f1, lo ), hi ) );
+
+    __m128i s0 = _mm_packs_epi32( _mm256_castsi256_si128( i0 ),
+                                  _mm256_extractf128_si256( i0, 1 ) );
+    __m128i s1 = _mm_packs_epi32( _mm256_castsi256_si128( i1 ),
+                                  _mm256_extractf128_si256( i1, 1 ) );
+
+    _mm_storeu_si128( (__m128i *)(out + i), _mm_packs_epi16( s0, s1 ) );
+  }
+
+  convert_fc32_cs8_generic( in + i / 2, out + i, (nfloats - i) / 2 );
+}
+
+CONVERT_TARGET("avx")
+void convert_fc32_cs16_avx( const gr_complex *in, int16_t *out,
+                            size_t nitems, float scale )
+{
+  const __m256 k = _mm256_set1_ps( scale );
+  const __m256 lo = _mm256_set1_ps( -32768.0f );
+  const __m256 hi = _mm256_set1_ps( 32767.0f );
+
+  const float *inf = (const float *)in;
+  const size_t nfloats = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nfloats; i += 16) {
+    __m256 f0 = _mm256_mul_ps( _mm256_loadu_ps( inf + i + 0 ), k );
+    __m256 f1 = _mm256_mul_ps( _mm256_loadu_ps( inf + i + 8 ), k );
+
+    __m256i i0 = _mm256_cvtps_epi32( _mm256_min_ps( _mm256_max_ps( f0, lo ), hi ) );
+    __m256i i1 = _mm256_cvtps_epi32( _mm256_min_ps( _mm256_max_ps( f1, lo ), hi ) );
+
+    _mm_storeu_si128( (__m128i *)(out + i + 0),
+                      _mm_packs_epi32( _mm256_castsi256_si128( i0 ),
+                                       _mm256_extractf128_si256( i0, 1 ) ) );
+    _mm_storeu_si128( (__m128i *)(out + i + 8),
+                      _mm_packs_epi32( _mm256_castsi256_si128( i1 ),
+                                       _mm256_extractf128_si256( i1, 1 ) ) );
+  }
+
+  convert_fc32_cs16_generic( in + i / 2, out + i, (nfloats - i) / 2, scale );
+}
+
+CONVERT_TARGET("avx512f")
+void convert_fc32_cs8_avx512( const gr_complex *in, int8_t *out, size_t nitems )
+{
+  const __m512 scale = _mm512_set1_ps( 127.0f );
+  const __m512 lo = _mm512_set1_ps( -128.0f );
+  const __m512 hi = _mm512_set1_ps( 127.0f );
+  /* the unmasked forms merge into an undefined register, which makes
+   * gcc warn about an uninitialized use */
+  const __mmask16 all = 0xffff;
+
+  const float *inf = (const float *)in;
+  const size_t nfloats = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 32 <= nfloats; i += 32) {
+    __m512 f0 = _mm512_mul_ps( _mm512_loadu_ps( inf + i +  0 ), scale );
+    __m512 f1 = _mm512_mul_ps( _mm512_loadu_ps( inf + i + 16 ), scale );
+
+    __m512i i0 = _mm512_maskz_cvtps_epi32( all,
+                   _mm512_maskz_min_ps( all, _mm512_maskz_max_ps( all, f0, lo ), hi ) );
+    __m512i i1 = _mm512_maskz_cvtps_epi32( all,
+                   _mm512_maskz_min_ps( all, _mm512_maskz_max_ps( all, f1, lo ), hi ) );
+
+    _mm512_mask_cvtsepi32_storeu_epi8( out + i +  0, all, i0 );
+    _mm512_mask_cvtsepi32_storeu_epi8( out + i + 16, all, i1 );
+  }
+
+  convert_fc32_cs8_generic( in + i / 2, out + i, (nfloats - i) / 2 );
+}
+
+CONVERT_TARGET("avx2")
+void convert_cs8_fc32_avx2( const int8_t *in, gr_complex *out, size_t nitems )
+{
+  const __m256 scale = _mm256_set1_ps( 1.0f / 128.0f );
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 32 <= nbytes; i += 32) {
+    for (size_t j = 0; j < 32; j += 8) {
+      __m128i b = _mm_loadl_epi64( (const __m128i *)(in + i + j) );
+      __m256 f = _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( b ) );
+      _mm256_storeu_ps( outf + i + j, _mm256_mul_ps( f, scale ) );
+    }
+  }
+
+  convert_cs8_fc32_generic( in + i, out + i / 2, (nbytes - i) / 2 );
+}
+
+CONVERT_TARGET("avx2")
+void convert_cs8_fc32_x2_avx2( const int8_t *in, gr_complex *out0,
+                               gr_complex *out1, size_t nitems )
+{
+  const __m256 scale = _mm256_set1_ps( 1.0f / 128.0f );
+
+  /* within each 128 bit lane move the 16 bit I/Q pairs of channel 0 to the
+   * low and those of channel 1 to the high 64 bits */
+  const __m256i shuf = _mm256_setr_epi8( 0, 1, 4, 5, 8, 9, 12, 13,
+                                         2, 3, 6, 7, 10, 11, 14, 15,
+                                         0, 1, 4, 5, 8, 9, 12, 13,
+                                         2, 3, 6, 7, 10, 11, 14, 15 );
+
+  size_t i = 0;
+
+  for (; i + 8 <= nitems; i += 8) {
+    __m256i v = _mm256_loadu_si256( (const __m256i *)(in + i * 4) );
+    v = _mm256_shuffle_epi8( v, shuf );
+    v = _mm256_permute4x64_epi64( v, _MM_SHUFFLE(3, 1, 2, 0) );
+
+    __m128i a = _mm256_castsi256_si128( v );
+    __m128i b = _mm256_extracti128_si256( v, 1 );
+
+    __m256 a0 = _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( a ) );
+    __m256 a1 = _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( _mm_srli_si128( a, 8 ) ) );
+    __m256 b0 = _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( b ) );
+    __m256 b1 = _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( _mm_srli_si128( b, 8 ) ) );
+
+    _mm256_storeu_ps( (float *)(out0 + i) + 0, _mm256_mul_ps( a0, scale ) );
+    _mm256_storeu_ps( (float *)(out0 + i) + 8, _mm256_mul_ps( a1, scale ) );
+    _mm256_storeu_ps( (float *)(out1 + i) + 0, _mm256_mul_ps( b0, scale ) );
+    _mm256_storeu_ps( (float *)(out1 + i) + 8, _mm256_mul_ps( b1, scale ) );
+  }
+
+  convert_cs8_fc32_x2_generic( in + i * 4, out0 + i, out1 + i, nitems - i );
+}
+
+CONVERT_TARGET("avx2")
+void convert_cs16_fc32_avx2( const int16_t *in, gr_complex *out,
+                             size_t nitems, float scale )
+{
+  const __m256 k = _mm256_set1_ps( 1.0f / scale );
+
+  float *outf = (float *)out;
+  const size_t nvals = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nvals; i += 16) {
+    __m128i v0 = _mm_loadu_si128( (const __m128i *)(in + i) );
+    __m128i v1 = _mm_loadu_si128( (const __m128i *)(in + i + 8) );
+
+    __m256 f0 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( v0 ) );
+    __m256 f1 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( v1 ) );
+
+    _mm256_storeu_ps( outf + i + 0, _mm256_mul_ps( f0, k ) );
+    _mm256_storeu_ps( outf + i + 8, _mm256_mul_ps( f1, k ) );
+  }
+
+  convert_cs16_fc32_generic( in + i, out + i / 2, (nvals - i) / 2, scale );
+}
+
+CONVERT_TARGET("avx2")
+void convert_cs16_fc32_x2_avx2( const int16_t *in, gr_complex *out0,
+                                gr_complex *out1, size_t nitems, float scale )
+{
+  const __m256 k = _mm256_set1_ps( 1.0f / scale );
+  const __m256i perm = _mm256_setr_epi32( 0, 2, 4, 6, 1, 3, 5, 7 );
+
+  size_t i = 0;
+
+  for (; i + 4 <= nitems; i += 4) {
+    /* one I/Q pair per 32 bit lane, gather channel 0 into the low half */
+    __m256i v = _mm256_loadu_si256( (const __m256i *)(in + i * 4) );
+    v = _mm256_permutevar8x32_epi32( v, perm );
+
+    __m256 f0 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( _mm256_castsi256_si128( v ) ) );
+    __m256 f1 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( _mm256_extracti128_si256( v, 1 ) ) );
+
+    _mm256_storeu_ps( (float *)(out0 + i), _mm256_mul_ps( f0, k ) );
+    _mm256_storeu_ps( (float *)(out1 + i), _mm256_mul_ps( f1, k ) );
+  }
+
+  convert_cs16_fc32_x2_generic( in + i * 4, out0 + i, out1 + i, nitems - i, scale );
+}
+
+CONVERT_TARGET("avx2")
+void convert_cs16_planar_fc32_avx2( const int16_t *in_i, const int16_t *in_q,
+                                    gr_complex *out, size_t nitems,
+                                    float scale )
+{
+  const __m256 k = _mm256_set1_ps( 1.0f / scale );
+
+  float *outf = (float *)out;
+  size_t i = 0;
+
+  for (; i + 16 <= nitems; i += 16) {
+    for (size_t j = 0; j < 16; j += 8) {
+      __m128i vi = _mm_loadu_si128( (const __m128i *)(in_i + i + j) );
+      __m128i vq = _mm_loadu_si128( (const __m128i *)(in_q + i + j) );
+
+      __m256 f0 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( _mm_unpacklo_epi16( vi, vq ) ) );
+      __m256 f1 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( _mm_unpackhi_epi16( vi, vq ) ) );
+
+      _mm256_storeu_ps( outf + (i + j) * 2 + 0, _mm256_mul_ps( f0, k ) );
+      _mm256_storeu_ps( outf + (i + j) * 2 + 8, _mm256_mul_ps( f1, k ) );
+    }
+  }
+
+  convert_cs16_planar_fc32_generic( in_i + i, in_q + i, out + i, nitems - i, scale );
+}
+
+CONVERT_TARGET("avx2")
+void convert_cs24_fc32_avx2( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  const __m256 scale = _mm256_set1_ps( 1.0f / 2147483648.0f );
+
+  /* each lane holds four 24 bit values, move them into the upper three
+   * bytes of a 32 bit word and clear the lowest one */
+  const __m256i shuf = _mm256_setr_epi8( -1, 0, 1, 2, -1, 3, 4, 5,
+                                         -1, 6, 7, 8, -1, 9, 10, 11,
+                                         -1, 0, 1, 2, -1, 3, 4, 5,
+                                         -1, 6, 7, 8, -1, 9, 10, 11 );
+
+  float *outf = (float *)out;
+  size_t i = 0;
+
+  /* the last load reads 4 bytes beyond the 48 bytes consumed */
+  for (; i + 9 <= nitems; i += 8) {
+    const uint8_t *p = in + i * 6;
+
+    for (size_t j = 0; j < 2; j++, p += 24) {
+      __m256i v = _mm256_castsi128_si256( _mm_loadu_si128( (const __m128i *)p ) );
+      v = _mm256_inserti128_si256( v, _mm_loadu_si128( (const __m128i *)(p + 12) ), 1 );
+      v = _mm256_shuffle_epi8( v, shuf );
+
+      _mm256_storeu_ps( outf + i * 2 + j * 8,
+                        _mm256_mul_ps( _mm256_cvtepi32_ps( v ), scale ) );
+    }
+  }
+
+  convert_cs24_fc32_generic( in + i * 6, out + i, nitems - i );
+}
+
+CONVERT_TARGET("avx2")
+void convert_cs12_fc32_avx2( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  const __m256 scale = _mm256_set1_ps( 1.0f / 2048.0f );
+
+  /* each lane expands two samples (6 bytes) into I, Q, I, Q words, with
+   * the two bytes holding each value in the upper half of the word */
+  const __m256i shuf = _mm256_setr_epi8( -1, -1, 0, 1, -1, -1, 1, 2,
+                                         -1, -1, 3, 4, -1, -1, 4, 5,
+                                         -1, -1, 6, 7, -1, -1, 7, 8,
+                                         -1, -1, 9, 10, -1, -1, 10, 11 );
+  /* I sits 4 bits lower than Q, align both to the top before the shift */
+  const __m256i align = _mm256_setr_epi32( 4, 0, 4, 0, 4, 0, 4, 0 );
+
+  float *outf = (float *)out;
+  size_t i = 0;
+
+  /* each load reads 4 bytes beyond the 12 bytes consumed */
+  for (; i + 6 <= nitems; i += 4) {
+    __m256i v = _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i *)(in + i * 3) ) );
+    v = _mm256_shuffle_epi8( v, shuf );
+    v = _mm256_srai_epi32( _mm256_sllv_epi32( v, align ), 20 );
+
+    _mm256_storeu_ps( outf + i * 2, _mm256_mul_ps( _mm256_cvtepi32_ps( v ), scale ) );
+  }
+
+  convert_cs12_fc32_generic( in + i * 3, out + i, nitems - i );
+}
+
+CONVERT_TARGET("avx2")
+void convert_cu8_fc32_avx2( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  const __m256 offset = _mm256_set1_ps( 127.4f );
+  const __m256 scale = _mm256_set1_ps( 1.0f / 128.0f );
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 32 <= nbytes; i += 32) {
+    for (size_t j = 0; j < 32; j += 8) {
+      __m128i b = _mm_loadl_epi64( (const __m128i *)(in + i + j) );
+      __m256 f = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( b ) );
+      _mm256_storeu_ps( outf + i + j, _mm256_mul_ps( _mm256_sub_ps( f, offset ), scale ) );
+    }
+  }
+
+  convert_cu8_fc32_generic( in + i, out + i / 2, (nbytes - i) / 2 );
+}
+
+CONVERT_TARGET("avx2")
+inline gr_complex sum_iq_avx2( __m256 acc )
+{
+  float v[8];
+  _mm256_storeu_ps( v, acc );
+  return gr_complex( v[0] + v[2] + v[4] + v[6], v[1] + v[3] + v[5] + v[7] );
+}
+
+CONVERT_TARGET("avx2")
+gr_complex convert_cu8_fc32_dc_avx2( const uint8_t *in, gr_complex *out,
+                                     size_t nitems, gr_complex dc )
+{
+  const float off_i = 127.4f / 128.0f + dc.real();
+  const float off_q = 127.4f / 128.0f + dc.imag();
+  const __m256 offset = _mm256_setr_ps( off_i, off_q, off_i, off_q,
+                                        off_i, off_q, off_i, off_q );
+  const __m256 scale = _mm256_set1_ps( 1.0f / 128.0f );
+
+  /* two accumulators, to not wait on the previous add */
+  __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    __m256 f0 = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( _mm_loadl_epi64( (const __m128i *)(in + i) ) ) );
+    __m256 f1 = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( _mm_loadl_epi64( (const __m128i *)(in + i + 8) ) ) );
+
+    f0 = _mm256_sub_ps( _mm256_mul_ps( f0, scale ), offset );
+    f1 = _mm256_sub_ps( _mm256_mul_ps( f1, scale ), offset );
+
+    _mm256_storeu_ps( outf + i + 0, f0 );
+    _mm256_storeu_ps( outf + i + 8, f1 );
+
+    acc0 = _mm256_add_ps( acc0, f0 );
+    acc1 = _mm256_add_ps( acc1, f1 );
+  }
+
+  return sum_iq_avx2( _mm256_add_ps( acc0, acc1 ) ) +
+         convert_cu8_fc32_dc_generic( in + i, out + i / 2, (nbytes - i) / 2, dc );
+}
+
+CONVERT_TARGET("avx2")
+gr_complex convert_cs8_fc32_dc_avx2( const int8_t *in, gr_complex *out,
+                                     size_t nitems, gr_complex dc )
+{
+  const __m256 offset = _mm256_setr_ps( dc.real(), dc.imag(), dc.real(), dc.imag(),
+                                        dc.real(), dc.imag(), dc.real(), dc.imag() );
+  const __m256 scale = _mm256_set1_ps( 1.0f / 128.0f );
+
+  __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    __m256 f0 = _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( _mm_loadl_epi64( (const __m128i *)(in + i) ) ) );
+    __m256 f1 = _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( _mm_loadl_epi64( (const __m128i *)(in + i + 8) ) ) );
+
+    f0 = _mm256_sub_ps( _mm256_mul_ps( f0, scale ), offset );
+    f1 = _mm256_sub_ps( _mm256_mul_ps( f1, scale ), offset );
+
+    _mm256_storeu_ps( outf + i + 0, f0 );
+    _mm256_storeu_ps( outf + i + 8, f1 );
+
+    acc0 = _mm256_add_ps( acc0, f0 );
+    acc1 = _mm256_add_ps( acc1, f1 );
+  }
+
+  return sum_iq_avx2( _mm256_add_ps( acc0, acc1 ) ) +
+         convert_cs8_fc32_dc_generic( in + i, out + i / 2, (nbytes - i) / 2, dc );
+}
+
+CONVERT_TARGET("avx2")
+gr_complex convert_cs16_fc32_dc_avx2( const int16_t *in, gr_complex *out,
+                                      size_t nitems, float scale, gr_complex dc )
+{
+  const __m256 offset = _mm256_setr_ps( dc.real(), dc.imag(), dc.real(), dc.imag(),
+                                        dc.real(), dc.imag(), dc.real(), dc.imag() );
+  const __m256 k = _mm256_set1_ps( 1.0f / scale );
+  __m256 acc = _mm256_setzero_ps();
+
+  float *outf = (float *)out;
+  const size_t nvals = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nvals; i += 16) {
+    __m128i v0 = _mm_loadu_si128( (const __m128i *)(in + i) );
+    __m128i v1 = _mm_loadu_si128( (const __m128i *)(in + i + 8) );
+
+    __m256 f0 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( v0 ) );
+    __m256 f1 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( v1 ) );
+
+    f0 = _mm256_sub_ps( _mm256_mul_ps( f0, k ), offset );
+    f1 = _mm256_sub_ps( _mm256_mul_ps( f1, k ), offset );
+
+    _mm256_storeu_ps( outf + i + 0, f0 );
+    _mm256_storeu_ps( outf + i + 8, f1 );
+
+    acc = _mm256_add_ps( acc, _mm256_add_ps( f0, f1 ) );
+  }
+
+  return sum_iq_avx2( acc ) +
+         convert_cs16_fc32_dc_generic( in + i, out + i / 2, (nvals - i) / 2, scale, dc );
+}
+
+CONVERT_TARGET("avx2")
+gr_complex remove_dc_fc32_avx2( const gr_complex *in, gr_complex *out,
+                                size_t nitems, gr_complex dc )
+{
+  const __m256 offset = _mm256_setr_ps( dc.real(), dc.imag(), dc.real(), dc.imag(),
+                                        dc.real(), dc.imag(), dc.real(), dc.imag() );
+  __m256 acc = _mm256_setzero_ps();
+
+  const float *inf = (const float *)in;
+  float *outf = (float *)out;
+  const size_t nfloats = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nfloats; i += 16) {
+    __m256 f0 = _mm256_sub_ps( _mm256_loadu_ps( inf + i + 0 ), offset );
+    __m256 f1 = _mm256_sub_ps( _mm256_loadu_ps( inf + i + 8 ), offset );
+
+    _mm256_storeu_ps( outf + i + 0, f0 );
+    _mm256_storeu_ps( outf + i + 8, f1 );
+
+    acc = _mm256_add_ps( acc, _mm256_add_ps( f0, f1 ) );
+  }
+
+  return sum_iq_avx2( acc ) +
+         remove_dc_fc32_generic( in + i / 2, out + i / 2, (nfloats - i) / 2, dc );
+}
+
+/* the per lane peak and count of clipped values of the software AGC */
+CONVERT_TARGET("avx2")
+inline void level_avx2( __m256 f, __m256 limit, __m256 &peak, __m256i &clipped )
+{
+  const __m256 a = _mm256_andnot_ps( _mm256_set1_ps( -0.0f ), f );
+  peak = _mm256_max_ps( peak, a );
+  clipped = _mm256_sub_epi32( clipped, _mm256_castps_si256( _mm256_cmp_ps( a, limit, _CMP_GE_OQ ) ) );
+}
+
+CONVERT_TARGET("avx2")
+inline void add_level_avx2( __m256 pacc, __m256 peak, __m256i clipped, sample_level_t &level )
+{
+  float p[8], m[8];
+  int32_t c[8];
+  _mm256_storeu_ps( p, pacc );
+  _mm256_storeu_ps( m, peak );
+  _mm256_storeu_si256( (__m256i *)c, clipped );
+
+  for (int j = 0; j < 8; j++) {
+    level.power += p[j];
+    level.peak = std::max( level.peak, m[j] );
+    level.clipped += c[j];
+  }
+}
+
+CONVERT_TARGET("avx2")
+gr_complex convert_cu8_fc32_agc_avx2( const uint8_t *in, gr_complex *out, size_t nitems,
+                                      float k, gr_complex off, float clip, sample_level_t &level )
+{
+  const __m256 offset = _mm256_setr_ps( off.real(), off.imag(), off.real(), off.imag(),
+                                        off.real(), off.imag(), off.real(), off.imag() );
+  const __m256 scale = _mm256_set1_ps( k );
+  __m256 acc = _mm256_setzero_ps(), pacc = _mm256_setzero_ps();
+  const __m256 limit = _mm256_set1_ps( clip );
+  __m256 peak = _mm256_set1_ps( level.peak );
+  __m256i clipped = _mm256_setzero_si256();
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    __m256 f0 = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( _mm_loadl_epi64( (const __m128i *)(in + i) ) ) );
+    __m256 f1 = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( _mm_loadl_epi64( (const __m128i *)(in + i + 8) ) ) );
+
+    f0 = _mm256_sub_ps( _mm256_mul_ps( f0, scale ), offset );
+    f1 = _mm256_sub_ps( _mm256_mul_ps( f1, scale ), offset );
+
+    _mm256_storeu_ps( outf + i + 0, f0 );
+    _mm256_storeu_ps( outf + i + 8, f1 );
+
+    acc = _mm256_add_ps( acc, _mm256_add_ps( f0, f1 ) );
+    pacc = _mm256_add_ps( pacc, _mm256_add_ps( _mm256_mul_ps( f0, f0 ), _mm256_mul_ps( f1, f1 ) ) );
+    level_avx2( f0, limit, peak, clipped );
+    level_avx2( f1, limit, peak, clipped );
+  }
+
+  add_level_avx2( pacc, peak, clipped, level );
+
+  return sum_iq_avx2( acc ) +
+         convert_cu8_fc32_agc_generic( in + i, out + i / 2, (nbytes - i) / 2, k, off, clip, level );
+}
+
+CONVERT_TARGET("avx2")
+gr_complex convert_cs8_fc32_agc_avx2( const int8_t *in, gr_complex *out, size_t nitems,
+                                      float k, gr_complex off, float clip, sample_level_t &level )
+{
+  const __m256 offset = _mm256_setr_ps( off.real(), off.imag(), off.real(), off.imag(),
+                                        off.real(), off.imag(), off.real(), off.imag() );
+  const __m256 scale = _mm256_set1_ps( k );
+  __m256 acc = _mm256_setzero_ps(), pacc = _mm256_setzero_ps();
+  const __m256 limit = _mm256_set1_ps( clip );
+  __m256 peak = _mm256_set1_ps( level.peak );
+  __m256i clipped = _mm256_setzero_si256();
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    __m256 f0 = _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( _mm_loadl_epi64( (const __m128i *)(in + i) ) ) );
+    __m256 f1 = _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( _mm_loadl_epi64( (const __m128i *)(in + i + 8) ) ) );
+
+    f0 = _mm256_sub_ps( _mm256_mul_ps( f0, scale ), offset );
+    f1 = _mm256_sub_ps( _mm256_mul_ps( f1, scale ), offset );
+
+    _mm256_storeu_ps( outf + i + 0, f0 );
+    _mm256_storeu_ps( outf + i + 8, f1 );
+
+    acc = _mm256_add_ps( acc, _mm256_add_ps( f0, f1 ) );
+    pacc = _mm256_add_ps( pacc, _mm256_add_ps( _mm256_mul_ps( f0, f0 ), _mm256_mul_ps( f1, f1 ) ) );
+    level_avx2( f0, limit, peak, clipped );
+    level_avx2( f1, limit, peak, clipped );
+  }
+
+  add_level_avx2( pacc, peak, clipped, level );
+
+  return sum_iq_avx2( acc ) +
+         convert_cs8_fc32_agc_generic( in + i, out + i / 2, (nbytes - i) / 2, k, off, clip, level );
+}
+
+CONVERT_TARGET("avx2")
+gr_complex convert_cs16_fc32_agc_avx2( const int16_t *in, gr_complex *out, size_t nitems,
+                                       float k, gr_complex off, float clip, sample_level_t &level )
+{
+  const __m256 offset = _mm256_setr_ps( off.real(), off.imag(), off.real(), off.imag(),
+                                        off.real(), off.imag(), off.real(), off.imag() );
+  const __m256 scale = _mm256_set1_ps( k );
+  __m256 acc = _mm256_setzero_ps(), pacc = _mm256_setzero_ps();
+  const __m256 limit = _mm256_set1_ps( clip );
+  __m256 peak = _mm256_set1_ps( level.peak );
+  __m256i clipped = _mm256_setzero_si256();
+
+  float *outf = (float *)out;
+  const size_t nvals = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nvals; i += 16) {
+    __m128i v0 = _mm_loadu_si128( (const __m128i *)(in + i) );
+    __m128i v1 = _mm_loadu_si128( (const __m128i *)(in + i + 8) );
+
+    __m256 f0 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( v0 ) );
+    __m256 f1 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( v1 ) );
+
+    f0 = _mm256_sub_ps( _mm256_mul_ps( f0, scale ), offset );
+    f1 = _mm256_sub_ps( _mm256_mul_ps( f1, scale ), offset );
+
+    _mm256_storeu_ps( outf + i + 0, f0 );
+    _mm256_storeu_ps( outf + i + 8, f1 );
+
+    acc = _mm256_add_ps( acc, _mm256_add_ps( f0, f1 ) );
+    pacc = _mm256_add_ps( pacc, _mm256_add_ps( _mm256_mul_ps( f0, f0 ), _mm256_mul_ps( f1, f1 ) ) );
+    level_avx2( f0, limit, peak, clipped );
+    level_avx2( f1, limit, peak, clipped );
+  }
+
+  add_level_avx2( pacc, peak, clipped, level );
+
+  return sum_iq_avx2( acc ) +
+         convert_cs16_fc32_agc_generic( in + i, out + i / 2, (nvals - i) / 2, k, off, clip, level );
+}
+
+CONVERT_TARGET("avx2")
+gr_complex scale_fc32_agc_avx2( const gr_complex *in, gr_complex *out, size_t nitems,
+                                float k, gr_complex off, float clip, sample_level_t &level )
+{
+  const __m256 offset = _mm256_setr_ps( off.real(), off.imag(), off.real(), off.imag(),
+                                        off.real(), off.imag(), off.real(), off.imag() );
+  const __m256 scale = _mm256_set1_ps( k );
+  __m256 acc = _mm256_setzero_ps(), pacc = _mm256_setzero_ps();
+  const __m256 limit = _mm256_set1_ps( clip );
+  __m256 peak = _mm256_set1_ps( level.peak );
+  __m256i clipped = _mm256_setzero_si256();
+
+  const float *inf = (const float *)in;
+  float *outf = (float *)out;
+  const size_t nfloats = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nfloats; i += 16) {
+    __m256 f0 = _mm256_sub_ps( _mm256_mul_ps( _mm256_loadu_ps( inf + i + 0 ), scale ), offset );
+    __m256 f1 = _mm256_sub_ps( _mm256_mul_ps( _mm256_loadu_ps( inf + i + 8 ), scale ), offset );
+
+    _mm256_storeu_ps( outf + i + 0, f0 );
+    _mm256_storeu_ps( outf + i + 8, f1 );
+
+    acc = _mm256_add_ps( acc, _mm256_add_ps( f0, f1 ) );
+    pacc = _mm256_add_ps( pacc, _mm256_add_ps( _mm256_mul_ps( f0, f0 ), _mm256_mul_ps( f1, f1 ) ) );
+    level_avx2( f0, limit, peak, clipped );
+    level_avx2( f1, limit, peak, clipped );
+  }
+
+  add_level_avx2( pacc, peak, clipped, level );
+
+  return sum_iq_avx2( acc ) +
+         scale_fc32_agc_generic( in + i / 2, out + i / 2, (nfloats - i) / 2, k, off, clip, level );
+}
+#endif
+
+/***********************************************************************
+ * ARM implementations
+ **********************************************************************/
+
+#ifdef CONVERT_NEON
+void convert_cu8_fc32_neon( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  const float32x4_t offset = vdupq_n_f32( 127.4f );
+  const float32x4_t scale = vdupq_n_f32( 1.0f / 128.0f );
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    uint8x16_t b = vld1q_u8( in + i );
+    uint16x8_t lo = vmovl_u8( vget_low_u8( b ) );
+    uint16x8_t hi = vmovl_u8( vget_high_u8( b ) );
+
+    float32x4_t f0 = vcvtq_f32_u32( vmovl_u16( vget_low_u16( lo ) ) );
+    float32x4_t f1 = vcvtq_f32_u32( vmovl_u16( vget_high_u16( lo ) ) );
+    float32x4_t f2 = vcvtq_f32_u32( vmovl_u16( vget_low_u16( hi ) ) );
+    float32x4_t f3 = vcvtq_f32_u32( vmovl_u16( vget_high_u16( hi ) ) );
+
+    vst1q_f32( outf + i +  0, vmulq_f32( vsubq_f32( f0, offset ), scale ) );
+    vst1q_f32( outf + i +  4, vmulq_f32( vsubq_f32( f1, offset ), scale ) );
+    vst1q_f32( outf + i +  8, vmulq_f32( vsubq_f32( f2, offset ), scale ) );
+    vst1q_f32( outf + i + 12, vmulq_f32( vsubq_f32( f3, offset ), scale ) );
+  }
+
+  convert_cu8_fc32_generic( in + i, out + i / 2, (nbytes - i) / 2 );
+}
+
+void convert_cs8_fc32_neon( const int8_t *in, gr_complex *out, size_t nitems )
+{
+  const float32x4_t scale = vdupq_n_f32( 1.0f / 128.0f );
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    int8x16_t b = vld1q_s8( in + i );
+    int16x8_t lo = vmovl_s8( vget_low_s8( b ) );
+    int16x8_t hi = vmovl_s8( vget_high_s8( b ) );
+
+    float32x4_t f0 = vcvtq_f32_s32( vmovl_s16( vget_low_s16( lo ) ) );
+    float32x4_t f1 = vcvtq_f32_s32( vmovl_s16( vget_high_s16( lo ) ) );
+    float32x4_t f2 = vcvtq_f32_s32( vmovl_s16( vget_low_s16( hi ) ) );
+    float32x4_t f3 = vcvtq_f32_s32( vmovl_s16( vget_high_s16( hi ) ) );
+
+    vst1q_f32( outf + i +  0, vmulq_f32( f0, scale ) );
+    vst1q_f32( outf + i +  4, vmulq_f32( f1, scale ) );
+    vst1q_f32( outf + i +  8, vmulq_f32( f2, scale ) );
+    vst1q_f32( outf + i + 12, vmulq_f32( f3, scale ) );
+  }
+
+  convert_cs8_fc32_generic( in + i, out + i / 2, (nbytes - i) / 2 );
+}
+
+void convert_cs8_fc32_x2_neon( const int8_t *in, gr_complex *out0,
+                               gr_complex *out1, size_t nitems )
+{
+  const float32x4_t scale = vdupq_n_f32( 1.0f / 128.0f );
+
+  size_t i = 0;
+
+  for (; i + 8 <= nitems; i += 8) {
+    /* the structure load splits the I/Q pairs of both channels for us */
+    int16x8x2_t v = vld2q_s16( (const int16_t *)(in + i * 4) );
+    int8x16_t a = vreinterpretq_s8_s16( v.val[0] );
+    int8x16_t b = vreinterpretq_s8_s16( v.val[1] );
+
+    int16x8_t a_lo = vmovl_s8( vget_low_s8( a ) );
+    int16x8_t a_hi = vmovl_s8( vget_high_s8( a ) );
+    int16x8_t b_lo = vmovl_s8( vget_low_s8( b ) );
+    int16x8_t b_hi = vmovl_s8( vget_high_s8( b ) );
+
+    float *o0 = (float *)(out0 + i);
+    float *o1 = (float *)(out1 + i);
+
+    vst1q_f32( o0 +  0, vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( a_lo ) ) ), scale ) );
+    vst1q_f32( o0 +  4, vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( a_lo ) ) ), scale ) );
+    vst1q_f32( o0 +  8, vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( a_hi ) ) ), scale ) );
+    vst1q_f32( o0 + 12, vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( a_hi ) ) ), scale ) );
+    vst1q_f32( o1 +  0, vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( b_lo ) ) ), scale ) );
+    vst1q_f32( o1 +  4, vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( b_lo ) ) ), scale ) );
+    vst1q_f32( o1 +  8, vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( b_hi ) ) ), scale ) );
+    vst1q_f32( o1 + 12, vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( b_hi ) ) ), scale ) );
+  }
+
+  convert_cs8_fc32_x2_generic( in + i * 4, out0 + i, out1 + i, nitems - i );
+}
+
+void convert_cs16_fc32_neon( const int16_t *in, gr_complex *out,
+                             size_t nitems, float scale )
+{
+  const float32x4_t k = vdupq_n_f32( 1.0f / scale );
+
+  float *outf = (float *)out;
+  const size_t nvals = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 8 <= nvals; i += 8) {
+    int16x8_t v = vld1q_s16( in + i );
+
+    float32x4_t f0 = vcvtq_f32_s32( vmovl_s16( vget_low_s16( v ) ) );
+    float32x4_t f1 = vcvtq_f32_s32( vmovl_s16( vget_high_s16( v ) ) );
+
+    vst1q_f32( outf + i + 0, vmulq_f32( f0, k ) );
+    vst1q_f32( outf + i + 4, vmulq_f32( f1, k ) );
+  }
+
+  convert_cs16_fc32_generic( in + i, out + i / 2, (nvals - i) / 2, scale );
+}
+
+void convert_cs16_fc32_x2_neon( const int16_t *in, gr_complex *out0,
+                                gr_complex *out1, size_t nitems, float scale )
+{
+  const float32x4_t k = vdupq_n_f32( 1.0f / scale );
+
+  size_t i = 0;
+
+  for (; i + 4 <= nitems; i += 4) {
+    /* the structure load splits the I/Q pairs of both channels for us */
+    int32x4x2_t v = vld2q_s32( (const int32_t *)(in + i * 4) );
+    int16x8_t a = vreinterpretq_s16_s32( v.val[0] );
+    int16x8_t b = vreinterpretq_s16_s32( v.val[1] );
+
+    vst1q_f32( (float *)(out0 + i) + 0,
+               vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( a ) ) ), k ) );
+    vst1q_f32( (float *)(out0 + i) + 4,
+               vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( a ) ) ), k ) );
+    vst1q_f32( (float *)(out1 + i) + 0,
+               vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( b ) ) ), k ) );
+    vst1q_f32( (float *)(out1 + i) + 4,
+               vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( b ) ) ), k ) );
+  }
+
+  convert_cs16_fc32_x2_generic( in + i * 4, out0 + i, out1 + i, nitems - i, scale );
+}
+
+void convert_cs16_planar_fc32_neon( const int16_t *in_i, const int16_t *in_q,
+                                    gr_complex *out, size_t nitems,
+                                    float scale )
+{
+  const float32x4_t k = vdupq_n_f32( 1.0f / scale );
+
+  float *outf = (float *)out;
+  size_t i = 0;
+
+  for (; i + 8 <= nitems; i += 8) {
+    int16x8x2_t v = vzipq_s16( vld1q_s16( in_i + i ), vld1q_s16( in_q + i ) );
+
+    for (int j = 0; j < 2; j++) {
+      float32x4_t f0 = vcvtq_f32_s32( vmovl_s16( vget_low_s16( v.val[j] ) ) );
+      float32x4_t f1 = vcvtq_f32_s32( vmovl_s16( vget_high_s16( v.val[j] ) ) );
+
+      vst1q_f32( outf + i * 2 + j * 8 + 0, vmulq_f32( f0, k ) );
+      vst1q_f32( outf + i * 2 + j * 8 + 4, vmulq_f32( f1, k ) );
+    }
+  }
+
+  convert_cs16_planar_fc32_generic( in_i + i, in_q + i, out + i, nitems - i, scale );
+}
+
+void convert_cs24_fc32_neon( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  const float32x4_t scale = vdupq_n_f32( 1.0f / 2147483648.0f );
+  const uint8x16_t zero = vdupq_n_u8( 0 );
+
+  float *outf = (float *)out;
+  size_t i = 0;
+
+  for (; i + 8 <= nitems; i += 8) {
+    /* split 16 values into their low, middle and high bytes */
+    uint8x16x3_t b = vld3q_u8( in + i * 6 );
+
+    /* and reassemble them as 0, low, mid, high in each 32 bit word */
+    uint8x16x2_t lo = vzipq_u8( zero, b.val[0] );
+    uint8x16x2_t hi = vzipq_u8( b.val[1], b.val[2] );
+
+    for (int j = 0; j < 2; j++) {
+      uint16x8x2_t w = vzipq_u16( vreinterpretq_u16_u8( lo.val[j] ),
+                                   vreinterpretq_u16_u8( hi.val[j] ) );
+
+      for (int k = 0; k < 2; k++) {
+        float32x4_t f = vcvtq_f32_s32( vreinterpretq_s32_u16( w.val[k] ) );
+        vst1q_f32( outf + i * 2 + j * 8 + k * 4, vmulq_f32( f, scale ) );
+      }
+    }
+  }
+
+  convert_cs24_fc32_generic( in + i * 6, out + i, nitems - i );
+}
+
+/* round to the nearest integer, saturating like the narrowing moves */
+inline int32x4_t round_s32_neon( float32x4_t f )
+{
+#if defined(__aarch64__)
+  return vcvtnq_s32_f32( f );
+#else
+  /* ARMv7 only truncates, round half away from zero by hand */
+  const uint32x4_t neg = vcltq_f32( f, vdupq_n_f32( 0.0f ) );
+  const float32x4_t half = vbslq_f32( neg, vdupq_n_f32( -0.5f ), vdupq_n_f32( 0.5f ) );
+  return vcvtq_s32_f32( vaddq_f32( f, half ) );
+#endif
+}
+
+void convert_cs12_fc32_neon( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  const float32x4_t k = vdupq_n_f32( 1.0f / 2048.0f );
+
+  float *outf = (float *)out;
+  size_t i = 0;
+
+  for (; i + 8 <= nitems; i += 8) {
+    /* split 8 samples into their first, middle and last bytes */
+    uint8x8x3_t b = vld3_u8( in + i * 3 );
+
+    /* as in the generic version, move each value into the upper 12 bits
+     * so the arithmetic shift extends the sign */
+    uint16x8_t w_i = vorrq_u16( vshlq_n_u16( vmovl_u8( b.val[0] ), 4 ),
+                                vshlq_n_u16( vmovl_u8( b.val[1] ), 12 ) );
+    uint16x8_t w_q = vorrq_u16( vmovl_u8( b.val[1] ),
+                                vshlq_n_u16( vmovl_u8( b.val[2] ), 8 ) );
+
+    int16x8_t v_i = vshrq_n_s16( vreinterpretq_s16_u16( w_i ), 4 );
+    int16x8_t v_q = vshrq_n_s16( vreinterpretq_s16_u16( w_q ), 4 );
+
+    /* the structure store interleaves I and Q again */
+    float32x4x2_t f;
+    f.val[0] = vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( v_i ) ) ), k );
+    f.val[1] = vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( v_q ) ) ), k );
+    vst2q_f32( outf + i * 2 + 0, f );
+    f.val[0] = vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( v_i ) ) ), k );
+    f.val[1] = vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( v_q ) ) ), k );
+    vst2q_f32( outf + i * 2 + 8, f );
+  }
+
+  convert_cs12_fc32_generic( in + i * 3, out + i, nitems - i );
+}
+
+void convert_fc32_cs16_neon( const gr_complex *in, int16_t *out,
+                             size_t nitems, float scale )
+{
+  const float32x4_t k = vdupq_n_f32( scale );
+
+  const float *inf = (const float *)in;
+  const size_t nfloats = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 8 <= nfloats; i += 8) {
+    int32x4_t n0 = round_s32_neon( vmulq_f32( vld1q_f32( inf + i + 0 ), k ) );
+    int32x4_t n1 = round_s32_neon( vmulq_f32( vld1q_f32( inf + i + 4 ), k ) );
+
+    vst1q_s16( out + i, vcombine_s16( vqmovn_s32( n0 ), vqmovn_s32( n1 ) ) );
+  }
+
+  convert_fc32_cs16_generic( in + i / 2, out + i, (nfloats - i) / 2, scale );
+}
+
+void convert_fc32_cs12_neon( const gr_complex *in, uint8_t *out, size_t nitems )
+{
+  const float32x4_t k = vdupq_n_f32( 2048.0f );
+  const float32x4_t lo = vdupq_n_f32( -2048.0f );
+  const float32x4_t hi = vdupq_n_f32( 2047.0f );
+  const uint16x8_t mask = vdupq_n_u16( 0xfff );
+
+  const float *inf = (const float *)in;
+  size_t i = 0;
+
+  for (; i + 8 <= nitems; i += 8) {
+    /* the structure loads split I and Q of 4 samples each */
+    float32x4x2_t a = vld2q_f32( inf + i * 2 + 0 );
+    float32x4x2_t b = vld2q_f32( inf + i * 2 + 8 );
+
+    int16x8_t v[2];
+    for (int j = 0; j < 2; j++) {
+      float32x4_t fa = vminq_f32( vmaxq_f32( vmulq_f32( a.val[j], k ), lo ), hi );
+      float32x4_t fb = vminq_f32( vmaxq_f32( vmulq_f32( b.val[j], k ), lo ), hi );
+      v[j] = vcombine_s16( vmovn_s32( round_s32_neon( fa ) ),
+                           vmovn_s32( round_s32_neon( fb ) ) );
+    }
+
+    uint16x8_t v_i = vandq_u16( vreinterpretq_u16_s16( v[0] ), mask );
+    uint16x8_t v_q = vandq_u16( vreinterpretq_u16_s16( v[1] ), mask );
+
+    uint8x8x3_t o;
+    o.val[0] = vmovn_u16( v_i );
+    o.val[1] = vmovn_u16( vorrq_u16( vshrq_n_u16( v_i, 8 ), vshlq_n_u16( v_q, 4 ) ) );
+    o.val[2] = vmovn_u16( vshrq_n_u16( v_q, 4 ) );
+    vst3_u8( out + i * 3, o );
+  }
+
+  convert_fc32_cs12_generic( in + i, out + i * 3, nitems - i );
+}
+
+void convert_fc32_cs8_neon( const gr_complex *in, int8_t *out, size_t nitems )
+{
+  const float32x4_t scale = vdupq_n_f32( 127.0f );
+
+  const float *inf = (const float *)in;
+  const size_t nfloats = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nfloats; i += 16) {
+    int32x4_t n[4];
+
+    for (int j = 0; j < 4; j++)
+      n[j] = round_s32_neon( vmulq_f32( vld1q_f32( inf + i + j * 4 ), scale ) );
+
+    int16x8_t s0 = vcombine_s16( vqmovn_s32( n[0] ), vqmovn_s32( n[1] ) );
+    int16x8_t s1 = vcombine_s16( vqmovn_s32( n[2] ), vqmovn_s32( n[3] ) );
+
+    vst1q_s8( out + i, vcombine_s8( vqmovn_s16( s0 ), vqmovn_s16( s1 ) ) );
+  }
+
+  convert_fc32_cs8_generic( in + i / 2, out + i, (nfloats - i) / 2 );
+}
+
+/* the sum of the I and of the Q lanes of an I, Q, I, Q accumulator */
+inline gr_complex sum_iq_neon( float32x4_t acc )
+{
+  float v[4];
+  vst1q_f32( v, acc );
+  return gr_complex( v[0] + v[2], v[1] + v[3] );
+}
+
+gr_complex convert_cu8_fc32_dc_neon( const uint8_t *in, gr_complex *out,
+                                     size_t nitems, gr_complex dc )
+{
+  const float off[4] = { 127.4f / 128.0f + dc.real(), 127.4f / 128.0f + dc.imag(),
+                         127.4f / 128.0f + dc.real(), 127.4f / 128.0f + dc.imag() };
+  const float32x4_t offset = vld1q_f32( off );
+  const float32x4_t scale = vdupq_n_f32( 1.0f / 128.0f );
+  float32x4_t acc = vdupq_n_f32( 0.0f );
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    uint8x16_t b = vld1q_u8( in + i );
+    uint16x8_t lo = vmovl_u8( vget_low_u8( b ) );
+    uint16x8_t hi = vmovl_u8( vget_high_u8( b ) );
+
+    float32x4_t f0 = vsubq_f32( vmulq_f32( vcvtq_f32_u32( vmovl_u16( vget_low_u16( lo ) ) ), scale ), offset );
+    float32x4_t f1 = vsubq_f32( vmulq_f32( vcvtq_f32_u32( vmovl_u16( vget_high_u16( lo ) ) ), scale ), offset );
+    float32x4_t f2 = vsubq_f32( vmulq_f32( vcvtq_f32_u32( vmovl_u16( vget_low_u16( hi ) ) ), scale ), offset );
+    float32x4_t f3 = vsubq_f32( vmulq_f32( vcvtq_f32_u32( vmovl_u16( vget_high_u16( hi ) ) ), scale ), offset );
+
+    vst1q_f32( outf + i +  0, f0 );
+    vst1q_f32( outf + i +  4, f1 );
+    vst1q_f32( outf + i +  8, f2 );
+    vst1q_f32( outf + i + 12, f3 );
+
+    acc = vaddq_f32( acc, vaddq_f32( vaddq_f32( f0, f1 ), vaddq_f32( f2, f3 ) ) );
+  }
+
+  return sum_iq_neon( acc ) +
+         convert_cu8_fc32_dc_generic( in + i, out + i / 2, (nbytes - i) / 2, dc );
+}
+
+gr_complex convert_cs8_fc32_dc_neon( const int8_t *in, gr_complex *out,
+                                     size_t nitems, gr_complex dc )
+{
+  const float off[4] = { dc.real(), dc.imag(), dc.real(), dc.imag() };
+  const float32x4_t offset = vld1q_f32( off );
+  const float32x4_t scale = vdupq_n_f32( 1.0f / 128.0f );
+  float32x4_t acc = vdupq_n_f32( 0.0f );
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    int8x16_t b = vld1q_s8( in + i );
+    int16x8_t lo = vmovl_s8( vget_low_s8( b ) );
+    int16x8_t hi = vmovl_s8( vget_high_s8( b ) );
+
+    float32x4_t f0 = vsubq_f32( vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( lo ) ) ), scale ), offset );
+    float32x4_t f1 = vsubq_f32( vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( lo ) ) ), scale ), offset );
+    float32x4_t f2 = vsubq_f32( vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( hi ) ) ), scale ), offset );
+    float32x4_t f3 = vsubq_f32( vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( hi ) ) ), scale ), offset );
+
+    vst1q_f32( outf + i +  0, f0 );
+    vst1q_f32( outf + i +  4, f1 );
+    vst1q_f32( outf + i +  8, f2 );
+    vst1q_f32( outf + i + 12, f3 );
+
+    acc = vaddq_f32( acc, vaddq_f32( vaddq_f32( f0, f1 ), vaddq_f32( f2, f3 ) ) );
+  }
+
+  return sum_iq_neon( acc ) +
+         convert_cs8_fc32_dc_generic( in + i, out + i / 2, (nbytes - i) / 2, dc );
+}
+
+gr_complex convert_cs16_fc32_dc_neon( const int16_t *in, gr_complex *out,
+                                      size_t nitems, float scale, gr_complex dc )
+{
+  const float off[4] = { dc.real(), dc.imag(), dc.real(), dc.imag() };
+  const float32x4_t offset = vld1q_f32( off );
+  const float32x4_t k = vdupq_n_f32( 1.0f / scale );
+  float32x4_t acc = vdupq_n_f32( 0.0f );
+
+  float *outf = (float *)out;
+  const size_t nvals = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 8 <= nvals; i += 8) {
+    int16x8_t v = vld1q_s16( in + i );
+
+    float32x4_t f0 = vsubq_f32( vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( v ) ) ), k ), offset );
+    float32x4_t f1 = vsubq_f32( vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( v ) ) ), k ), offset );
+
+    vst1q_f32( outf + i + 0, f0 );
+    vst1q_f32( outf + i + 4, f1 );
+
+    acc = vaddq_f32( acc, vaddq_f32( f0, f1 ) );
+  }
+
+  return sum_iq_neon( acc ) +
+         convert_cs16_fc32_dc_generic( in + i, out + i / 2, (nvals - i) / 2, scale, dc );
+}
+
+gr_complex remove_dc_fc32_neon( const gr_complex *in, gr_complex *out,
+                                size_t nitems, gr_complex dc )
+{
+  const float off[4] = { dc.real(), dc.imag(), dc.real(), dc.imag() };
+  const float32x4_t offset = vld1q_f32( off );
+  float32x4_t acc = vdupq_n_f32( 0.0f );
+
+  const float *inf = (const float *)in;
+  float *outf = (float *)out;
+  const size_t nfloats = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 8 <= nfloats; i += 8) {
+    float32x4_t f0 = vsubq_f32( vld1q_f32( inf + i + 0 ), offset );
+    float32x4_t f1 = vsubq_f32( vld1q_f32( inf + i + 4 ), offset );
+
+    vst1q_f32( outf + i + 0, f0 );
+    vst1q_f32( outf + i + 4, f1 );
+
+    acc = vaddq_f32( acc, vaddq_f32( f0, f1 ) );
+  }
+
+  return sum_iq_neon( acc ) +
+         remove_dc_fc32_generic( in + i / 2, out + i / 2, (nfloats - i) / 2, dc );
+}
+
+/* the per lane peak and count of clipped values of the software AGC */
+inline void level_neon( float32x4_t f, float32x4_t limit, float32x4_t &peak, uint32x4_t &clipped )
+{
+  const float32x4_t a = vabsq_f32( f );
+  peak = vmaxq_f32( peak, a );
+  clipped = vsubq_u32( clipped, vcgeq_f32( a, limit ) );
+}
+
+inline void add_level_neon( float32x4_t pacc, float32x4_t peak, uint32x4_t clipped, sample_level_t &level )
+{
+  float p[4], m[4];
+  uint32_t c[4];
+  vst1q_f32( p, pacc );
+  vst1q_f32( m, peak );
+  vst1q_u32( c, clipped );
+
+  level.power += p[0] + p[1] + p[2] + p[3];
+  level.peak = std::max( std::max( m[0], m[1] ), std::max( m[2], m[3] ) );
+  level.clipped += c[0] + c[1] + c[2] + c[3];
+}
+
+gr_complex convert_cu8_fc32_agc_neon( const uint8_t *in, gr_complex *out, size_t nitems,
+                                      float k, gr_complex off, float clip, sample_level_t &level )
+{
+  const float o[4] = { off.real(), off.imag(), off.real(), off.imag() };
+  const float32x4_t offset = vld1q_f32( o );
+  const float32x4_t scale = vdupq_n_f32( k );
+  float32x4_t acc = vdupq_n_f32( 0.0f ), pacc = vdupq_n_f32( 0.0f );
+  const float32x4_t limit = vdupq_n_f32( clip );
+  float32x4_t peak = vdupq_n_f32( level.peak );
+  uint32x4_t clipped = vdupq_n_u32( 0 );
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    uint8x16_t b = vld1q_u8( in + i );
+    uint16x8_t lo = vmovl_u8( vget_low_u8( b ) );
+    uint16x8_t hi = vmovl_u8( vget_high_u8( b ) );
+
+    float32x4_t f0 = vsubq_f32( vmulq_f32( vcvtq_f32_u32( vmovl_u16( vget_low_u16( lo ) ) ), scale ), offset );
+    float32x4_t f1 = vsubq_f32( vmulq_f32( vcvtq_f32_u32( vmovl_u16( vget_high_u16( lo ) ) ), scale ), offset );
+    float32x4_t f2 = vsubq_f32( vmulq_f32( vcvtq_f32_u32( vmovl_u16( vget_low_u16( hi ) ) ), scale ), offset );
+    float32x4_t f3 = vsubq_f32( vmulq_f32( vcvtq_f32_u32( vmovl_u16( vget_high_u16( hi ) ) ), scale ), offset );
+
+    vst1q_f32( outf + i +  0, f0 );
+    vst1q_f32( outf + i +  4, f1 );
+    vst1q_f32( outf + i +  8, f2 );
+    vst1q_f32( outf + i + 12, f3 );
+
+    acc = vaddq_f32( acc, vaddq_f32( vaddq_f32( f0, f1 ), vaddq_f32( f2, f3 ) ) );
+    pacc = vmlaq_f32( vmlaq_f32( vmlaq_f32( vmlaq_f32( pacc, f0, f0 ), f1, f1 ), f2, f2 ), f3, f3 );
+    level_neon( f0, limit, peak, clipped );
+    level_neon( f1, limit, peak, clipped );
+    level_neon( f2, limit, peak, clipped );
+    level_neon( f3, limit, peak, clipped );
+  }
+
+  add_level_neon( pacc, peak, clipped, level );
+
+  return sum_iq_neon( acc ) +
+         convert_cu8_fc32_agc_generic( in + i, out + i / 2, (nbytes - i) / 2, k, off, clip, level );
+}
+
+gr_complex convert_cs8_fc32_agc_neon( const int8_t *in, gr_complex *out, size_t nitems,
+                                      float k, gr_complex off, float clip, sample_level_t &level )
+{
+  const float o[4] = { off.real(), off.imag(), off.real(), off.imag() };
+  const float32x4_t offset = vld1q_f32( o );
+  const float32x4_t scale = vdupq_n_f32( k );
+  float32x4_t acc = vdupq_n_f32( 0.0f ), pacc = vdupq_n_f32( 0.0f );
+  const float32x4_t limit = vdupq_n_f32( clip );
+  float32x4_t peak = vdupq_n_f32( level.peak );
+  uint32x4_t clipped = vdupq_n_u32( 0 );
+
+  float *outf = (float *)out;
+  const size_t nbytes = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 16 <= nbytes; i += 16) {
+    int8x16_t b = vld1q_s8( in + i );
+    int16x8_t lo = vmovl_s8( vget_low_s8( b ) );
+    int16x8_t hi = vmovl_s8( vget_high_s8( b ) );
+
+    float32x4_t f0 = vsubq_f32( vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( lo ) ) ), scale ), offset );
+    float32x4_t f1 = vsubq_f32( vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( lo ) ) ), scale ), offset );
+    float32x4_t f2 = vsubq_f32( vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( hi ) ) ), scale ), offset );
+    float32x4_t f3 = vsubq_f32( vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( hi ) ) ), scale ), offset );
+
+    vst1q_f32( outf + i +  0, f0 );
+    vst1q_f32( outf + i +  4, f1 );
+    vst1q_f32( outf + i +  8, f2 );
+    vst1q_f32( outf + i + 12, f3 );
+
+    acc = vaddq_f32( acc, vaddq_f32( vaddq_f32( f0, f1 ), vaddq_f32( f2, f3 ) ) );
+    pacc = vmlaq_f32( vmlaq_f32( vmlaq_f32( vmlaq_f32( pacc, f0, f0 ), f1, f1 ), f2, f2 ), f3, f3 );
+    level_neon( f0, limit, peak, clipped );
+    level_neon( f1, limit, peak, clipped );
+    level_neon( f2, limit, peak, clipped );
+    level_neon( f3, limit, peak, clipped );
+  }
+
+  add_level_neon( pacc, peak, clipped, level );
+
+  return sum_iq_neon( acc ) +
+         convert_cs8_fc32_agc_generic( in + i, out + i / 2, (nbytes - i) / 2, k, off, clip, level );
+}
+
+gr_complex convert_cs16_fc32_agc_neon( const int16_t *in, gr_complex *out, size_t nitems,
+                                       float k, gr_complex off, float clip, sample_level_t &level )
+{
+  const float o[4] = { off.real(), off.imag(), off.real(), off.imag() };
+  const float32x4_t offset = vld1q_f32( o );
+  const float32x4_t scale = vdupq_n_f32( k );
+  float32x4_t acc = vdupq_n_f32( 0.0f ), pacc = vdupq_n_f32( 0.0f );
+  const float32x4_t limit = vdupq_n_f32( clip );
+  float32x4_t peak = vdupq_n_f32( level.peak );
+  uint32x4_t clipped = vdupq_n_u32( 0 );
+
+  float *outf = (float *)out;
+  const size_t nvals = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 8 <= nvals; i += 8) {
+    int16x8_t v = vld1q_s16( in + i );
+
+    float32x4_t f0 = vsubq_f32( vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_low_s16( v ) ) ), scale ), offset );
+    float32x4_t f1 = vsubq_f32( vmulq_f32( vcvtq_f32_s32( vmovl_s16( vget_high_s16( v ) ) ), scale ), offset );
+
+    vst1q_f32( outf + i + 0, f0 );
+    vst1q_f32( outf + i + 4, f1 );
+
+    acc = vaddq_f32( acc, vaddq_f32( f0, f1 ) );
+    pacc = vmlaq_f32( vmlaq_f32( pacc, f0, f0 ), f1, f1 );
+    level_neon( f0, limit, peak, clipped );
+    level_neon( f1, limit, peak, clipped );
+    level_neon( f2, limit, peak, clipped );
+    level_neon( f3, limit, peak, clipped );
+  }
+
+  add_level_neon( pacc, peak, clipped, level );
+
+  return sum_iq_neon( acc ) +
+         convert_cs16_fc32_agc_generic( in + i, out + i / 2, (nvals - i) / 2, k, off, clip, level );
+}
+
+gr_complex scale_fc32_agc_neon( const gr_complex *in, gr_complex *out, size_t nitems,
+                                float k, gr_complex off, float clip, sample_level_t &level )
+{
+  const float o[4] = { off.real(), off.imag(), off.real(), off.imag() };
+  const float32x4_t offset = vld1q_f32( o );
+  const float32x4_t scale = vdupq_n_f32( k );
+  float32x4_t acc = vdupq_n_f32( 0.0f ), pacc = vdupq_n_f32( 0.0f );
+  const float32x4_t limit = vdupq_n_f32( clip );
+  float32x4_t peak = vdupq_n_f32( level.peak );
+  uint32x4_t clipped = vdupq_n_u32( 0 );
+
+  const float *inf = (const float *)in;
+  float *outf = (float *)out;
+  const size_t nfloats = nitems * 2;
+  size_t i = 0;
+
+  for (; i + 8 <= nfloats; i += 8) {
+    float32x4_t f0 = vsubq_f32( vmulq_f32( vld1q_f32( inf + i + 0 ), scale ), offset );
+    float32x4_t f1 = vsubq_f32( vmulq_f32( vld1q_f32( inf + i + 4 ), scale ), offset );
+
+    vst1q_f32( outf + i + 0, f0 );
+    vst1q_f32( outf + i + 4, f1 );
+
+    acc = vaddq_f32( acc, vaddq_f32( f0, f1 ) );
+    pacc = vmlaq_f32( vmlaq_f32( pacc, f0, f0 ), f1, f1 );
+    level_neon( f0, limit, peak, clipped );
+    level_neon( f1, limit, peak, clipped );
+    level_neon( f2, limit, peak, clipped );
+    level_neon( f3, limit, peak, clipped );
+  }
+
+  add_level_neon( pacc, peak, clipped, level );
+
+  return sum_iq_neon( acc ) +
+         scale_fc32_agc_generic( in + i / 2, out + i / 2, (nfloats - i) / 2, k, off, clip, level );
+}
+#endif
+
+/***********************************************************************
+ * Runtime dispatch
+ **********************************************************************/
+
+struct kernels_t
+{
+  void (*cu8_fc32)( const uint8_t *, gr_complex *, size_t );
+  void (*cs8_fc32)( const int8_t *, gr_complex *, size_t );
+  void (*cs8_fc32_x2)( const int8_t *, gr_complex *, gr_complex *, size_t );
+  void (*cs16_fc32)( const int16_t *, gr_complex *, size_t, float );
+  void (*cs16_fc32_x2)( const int16_t *, gr_complex *, gr_complex *, size_t, float );
+  void (*cs16_planar_fc32)( const int16_t *, const int16_t *, gr_complex *, size_t, float );
+  void (*cs24_fc32)( const uint8_t *, gr_complex *, size_t );
+  void (*cs12_fc32)( const uint8_t *, gr_complex *, size_t );
+  void (*fc32_cs8)( const gr_complex *, int8_t *, size_t );
+  void (*fc32_cs16)( const gr_complex *, int16_t *, size_t, float );
+  void (*fc32_cs12)( const gr_complex *, uint8_t *, size_t );
+  gr_complex (*cu8_fc32_dc)( const uint8_t *, gr_complex *, size_t, gr_complex );
+  gr_complex (*cs8_fc32_dc)( const int8_t *, gr_complex *, size_t, gr_complex );
+  gr_complex (*cs16_fc32_dc)( const int16_t *, gr_complex *, size_t, float, gr_complex );
+  gr_complex (*fc32_dc)( const gr_complex *, gr_complex *, size_t, gr_complex );
+  gr_complex (*cu8_fc32_agc)( const uint8_t *, gr_complex *, size_t, float, gr_complex, float, sample_level_t & );
+  gr_complex (*cs8_fc32_agc)( const int8_t *, gr_complex *, size_t, float, gr_complex, float, sample_level_t & );
+  gr_complex (*cs16_fc32_agc)( const int16_t *, gr_complex *, size_t, float, gr_complex, float, sample_level_t & );
+  gr_complex (*fc32_agc)( const gr_complex *, gr_complex *, size_t, float, gr_complex, float, sample_level_t & );
+  const char *arch;
+
+  kernels_t() :
+    cu8_fc32( convert_cu8_fc32_generic ),
+    cs8_fc32( convert_cs8_fc32_generic ),
+    cs8_fc32_x2( convert_cs8_fc32_x2_generic ),
+    cs16_fc32( convert_cs16_fc32_generic ),
+    cs16_fc32_x2( convert_cs16_fc32_x2_generic ),
+    cs16_planar_fc32( convert_cs16_planar_fc32_generic ),
+    cs24_fc32( convert_cs24_fc32_generic ),
+    cs12_fc32( convert_cs12_fc32_generic ),
+    fc32_cs8( convert_fc32_cs8_generic ),
+    fc32_cs16( convert_fc32_cs16_generic ),
+    fc32_cs12( convert_fc32_cs12_generic ),
+    cu8_fc32_dc( convert_cu8_fc32_dc_generic ),
+    cs8_fc32_dc( convert_cs8_fc32_dc_generic ),
+    cs16_fc32_dc( convert_cs16_fc32_dc_generic ),
+    fc32_dc( remove_dc_fc32_generic ),
+    cu8_fc32_agc( convert_cu8_fc32_agc_generic ),
+    cs8_fc32_agc( convert_cs8_fc32_agc_generic ),
+    cs16_fc32_agc( convert_cs16_fc32_agc_generic ),
+    fc32_agc( scale_fc32_agc_generic ),
+    arch( "generic" )
+  {
+#if defined(CONVERT_X86_DISPATCH)
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports( "sse2" ) ) {
+      cu8_fc32 = convert_cu8_fc32_sse2;
+      cs8_fc32 = convert_cs8_fc32_sse2;
+      cs8_fc32_x2 = convert_cs8_fc32_x2_sse2;
+      cs16_fc32 = convert_cs16_fc32_sse2;
+      cs16_fc32_x2 = convert_cs16_fc32_x2_sse2;
+      cs16_planar_fc32 = convert_cs16_planar_fc32_sse2;
+      fc32_cs8 = convert_fc32_cs8_sse2;
+      fc32_cs16 = convert_fc32_cs16_sse2;
+      cu8_fc32_dc = convert_cu8_fc32_dc_sse2;
+      cs8_fc32_dc = convert_cs8_fc32_dc_sse2;
+      cs16_fc32_dc = convert_cs16_fc32_dc_sse2;
+      fc32_dc = remove_dc_fc32_sse2;
+      cu8_fc32_agc = convert_cu8_fc32_agc_sse2;
+      cs8_fc32_agc = convert_cs8_fc32_agc_sse2;
+      cs16_fc32_agc = convert_cs16_fc32_agc_sse2;
+      fc32_agc = scale_fc32_agc_sse2;
+      arch = "sse2";
+    }
+    if ( __builtin_cpu_supports( "avx" ) ) {
+      fc32_cs8 = convert_fc32_cs8_avx;
+      fc32_cs16 = convert_fc32_cs16_avx;
+      arch = "avx";
+    }
+    if ( __builtin_cpu_supports( "avx2" ) ) {
+      cu8_fc32 = convert_cu8_fc32_avx2;
+      cs8_fc32 = convert_cs8_fc32_avx2;
+      cs8_fc32_x2 = convert_cs8_fc32_x2_avx2;
+      cs16_fc32 = convert_cs16_fc32_avx2;
+      cs16_fc32_x2 = convert_cs16_fc32_x2_avx2;
+      cs16_planar_fc32 = convert_cs16_planar_fc32_avx2;
+      cs24_fc32 = convert_cs24_fc32_avx2;
+      cs12_fc32 = convert_cs12_fc32_avx2;
+      cu8_fc32_dc = convert_cu8_fc32_dc_avx2;
+      cs8_fc32_dc = convert_cs8_fc32_dc_avx2;
+      cs16_fc32_dc = convert_cs16_fc32_dc_avx2;
+      fc32_dc = remove_dc_fc32_avx2;
+      cu8_fc32_agc = convert_cu8_fc32_agc_avx2;
+      cs8_fc32_agc = convert_cs8_fc32_agc_avx2;
+      cs16_fc32_agc = convert_cs16_fc32_agc_avx2;
+      fc32_agc = scale_fc32_agc_avx2;
+      arch = "avx2";
+    }
+    if ( __builtin_cpu_supports( "avx512f" ) ) {
+      fc32_cs8 = convert_fc32_cs8_avx512;
+      arch = "avx512";
+    }
+#elif defined(CONVERT_X86_SSE2)
+    cu8_fc32 = convert_cu8_fc32_sse2;
+    cs8_fc32 = convert_cs8_fc32_sse2;
+    cs8_fc32_x2 = convert_cs8_fc32_x2_sse2;
+    cs16_fc32 = convert_cs16_fc32_sse2;
+    cs16_fc32_x2 = convert_cs16_fc32_x2_sse2;
+    cs16_planar_fc32 = convert_cs16_planar_fc32_sse2;
+    fc32_cs8 = convert_fc32_cs8_sse2;
+    fc32_cs16 = convert_fc32_cs16_sse2;
+    cu8_fc32_dc = convert_cu8_fc32_dc_sse2;
+    cs8_fc32_dc = convert_cs8_fc32_dc_sse2;
+    cs16_fc32_dc = convert_cs16_fc32_dc_sse2;
+    fc32_dc = remove_dc_fc32_sse2;
+    cu8_fc32_agc = convert_cu8_fc32_agc_sse2;
+    cs8_fc32_agc = convert_cs8_fc32_agc_sse2;
+    cs16_fc32_agc = convert_cs16_fc32_agc_sse2;
+    fc32_agc = scale_fc32_agc_sse2;
+    arch = "sse2";
+#elif defined(CONVERT_NEON)
+    cu8_fc32 = convert_cu8_fc32_neon;
+    cs8_fc32 = convert_cs8_fc32_neon;
+    cs8_fc32_x2 = convert_cs8_fc32_x2_neon;
+    cs16_fc32 = convert_cs16_fc32_neon;
+    cs16_fc32_x2 = convert_cs16_fc32_x2_neon;
+    cs16_planar_fc32 = convert_cs16_planar_fc32_neon;
+    cs24_fc32 = convert_cs24_fc32_neon;
+    cs12_fc32 = convert_cs12_fc32_neon;
+    fc32_cs8 = convert_fc32_cs8_neon;
+    fc32_cs16 = convert_fc32_cs16_neon;
+    fc32_cs12 = convert_fc32_cs12_neon;
+    cu8_fc32_dc = convert_cu8_fc32_dc_neon;
+    cs8_fc32_dc = convert_cs8_fc32_dc_neon;
+    cs16_fc32_dc = convert_cs16_fc32_dc_neon;
+    fc32_dc = remove_dc_fc32_neon;
+    cu8_fc32_agc = convert_cu8_fc32_agc_neon;
+    cs8_fc32_agc = convert_cs8_fc32_agc_neon;
+    cs16_fc32_agc = convert_cs16_fc32_agc_neon;
+    fc32_agc = scale_fc32_agc_neon;
+    arch = "neon";
+#endif
+  }
+};
+
+const kernels_t &kernels()
+{
+  static const kernels_t k;
+  return k;
+}
+
+} // namespace
+
+void convert_cu8_fc32( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  kernels().cu8_fc32( in, out, nitems );
+}
+
+void convert_cs8_fc32( const int8_t *in, gr_complex *out, size_t nitems )
+{
+  kernels().cs8_fc32( in, out, nitems );
+}
+
+void convert_cu8_fc32_deinterleave( const uint8_t *in, gr_complex * const *out,
+                                    size_t nchan, size_t nitems )
+{
+  if ( 1 == nchan )
+    kernels().cu8_fc32( in, out[0], nitems );
+  else
+    convert_cu8_fc32_deinterleave_generic( in, out, nchan, nitems );
+}
+
+void convert_cs8_fc32_deinterleave( const int8_t *in, gr_complex * const *out,
+                                    size_t nchan, size_t nitems )
+{
+  if ( 1 == nchan )
+    kernels().cs8_fc32( in, out[0], nitems );
+  else if ( 2 == nchan )
+    kernels().cs8_fc32_x2( in, out[0], out[1], nitems );
+  else
+    convert_cs8_fc32_deinterleave_generic( in, out, nchan, nitems );
+}
+
+void convert_cs16_fc32_deinterleave( const int16_t *in, gr_complex * const *out,
+                                     size_t nchan, size_t nitems, float scale )
+{
+  if ( 1 == nchan )
+    kernels().cs16_fc32( in, out[0], nitems, scale );
+  else if ( 2 == nchan )
+    kernels().cs16_fc32_x2( in, out[0], out[1], nitems, scale );
+  else
+    convert_cs16_fc32_deinterleave_generic( in, out, nchan, nitems, scale );
+}
+
+void convert_cs16_planar_fc32( const int16_t *i, const int16_t *q,
+                               gr_complex *out, size_t nitems, float scale )
+{
+  kernels().cs16_planar_fc32( i, q, out, nitems, scale );
+}
+
+void convert_cs24_fc32( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  kernels().cs24_fc32( in, out, nitems );
+}
+
+void convert_cs12_fc32( const uint8_t *in, gr_complex *out, size_t nitems )
+{
+  kernels().cs12_fc32( in, out, nitems );
+}
+
+void convert_fc32_cs8( const gr_complex *in, int8_t *out, size_t nitems )
+{
+  kernels().fc32_cs8( in, out, nitems );
+}
+
+void convert_fc32_cs16( const gr_complex *in, int16_t *out, size_t nitems,
+                        float scale )
+{
+  kernels().fc32_cs16( in, out, nitems, scale );
+}
+
+void convert_fc32_cs12( const gr_complex *in, uint8_t *out, size_t nitems )
+{
+  kernels().fc32_cs12( in, out, nitems );
+}
+
+/* moves dc towards the mean of the nitems samples it has been removed from */
+static void update_dc( gr_complex &dc, gr_complex sum, size_t nitems, float alpha )
+{
+  if ( ! nitems || alpha <= 0.0f )
+    return;
+
+  /* the weight of nitems steps of the one pole filter, 1 - (1 - alpha)^n */
+  const float weight = -std::expm1( double(nitems) * std::log1p( -double(alpha) ) );
+
+  dc += sum * (weight / float(nitems));
+}
+
+void convert_cu8_fc32_dc( const uint8_t *in, gr_complex *out, size_t nitems,
+                          gr_complex &dc, float alpha )
+{
+  update_dc( dc, kernels().cu8_fc32_dc( in, out, nitems, dc ), nitems, alpha );
+}
+
+void convert_cs8_fc32_dc( const int8_t *in, gr_complex *out, size_t nitems,
+                          gr_complex &dc, float alpha )
+{
+  update_dc( dc, kernels().cs8_fc32_dc( in, out, nitems, dc ), nitems, alpha );
+}
+
+void convert_cs16_fc32_dc( const int16_t *in, gr_complex *out, size_t nitems,
+                           float scale, gr_complex &dc, float alpha )
+{
+  update_dc( dc, kernels().cs16_fc32_dc( in, out, nitems, scale, dc ), nitems, alpha );
+}
+
+void remove_dc_fc32( const gr_complex *in, gr_complex *out, size_t nitems,
+                     gr_complex &dc, float alpha )
+{
+  update_dc( dc, kernels().fc32_dc( in, out, nitems, dc ), nitems, alpha );
+}
+
+/* values this close to full scale count as clipped */
+#define CLIP_LEVEL 0.99f
+
+/* the kernels subtract dc and apply gain in one multiply and subtract */
+void convert_cu8_fc32_agc( const uint8_t *in, gr_complex *out, size_t nitems,
+                           gr_complex &dc, float alpha, float gain, sample_level_t &level )
+{
+  const gr_complex off = ( gr_complex( 127.4f / 128.0f, 127.4f / 128.0f ) + dc ) * gain;
+
+  level = sample_level_t();
+  const gr_complex sum = kernels().cu8_fc32_agc( in, out, nitems, gain / 128.0f, off,
+                                                 CLIP_LEVEL * gain, level );
+  update_dc( dc, sum / gain, nitems, alpha );
+}
+
+void convert_cs8_fc32_agc( const int8_t *in, gr_complex *out, size_t nitems,
+                           gr_complex &dc, float alpha, float gain, sample_level_t &level )
+{
+  level = sample_level_t();
+  const gr_complex sum = kernels().cs8_fc32_agc( in, out, nitems, gain / 128.0f, dc * gain,
+                                                 CLIP_LEVEL * gain, level );
+  update_dc( dc, sum / gain, nitems, alpha );
+}
+
+void convert_cs16_fc32_agc( const int16_t *in, gr_complex *out, size_t nitems, float scale,
+                            gr_complex &dc, float alpha, float gain, sample_level_t &level )
+{
+  level = sample_level_t();
+  const gr_complex sum = kernels().cs16_fc32_agc( in, out, nitems, gain / scale, dc * gain,
+                                                  CLIP_LEVEL * gain, level );
+  update_dc( dc, sum / gain, nitems, alpha );
+}
+
+void scale_fc32_agc( const gr_complex *in, gr_complex *out, size_t nitems,
+                     gr_complex &dc, float alpha, float gain, sample_level_t &level )
+{
+  level = sample_level_t();
+  const gr_complex sum = kernels().fc32_agc( in, out, nitems, gain, dc * gain,
+                                             CLIP_LEVEL * gain, level );
+  update_dc( dc, sum / gain, nitems, alpha );
+}
+
+const char *sample_convert_arch( void )
+{
+  return kernels().arch;
+}
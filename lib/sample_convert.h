@@ -0,0 +1,215 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_SAMPLE_CONVERT_H
+#define INCLUDED_OSMOSDR_SAMPLE_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <gnuradio/gr_complex.h>
+
+#include <osmosdr/api.h>
+
+/*
+ * Sample format conversion kernels shared by the device drivers.
+ *
+ * Every kernel has a portable (lookup table or scalar) implementation and
+ * optional SIMD variants. The variant is picked once at load time based on
+ * the capabilities of the CPU we are running on, not the one we were built
+ * for, so baseline distribution builds still use AVX2 where available.
+ */
+
+/*!
+ * Convert interleaved unsigned 8 bit I/Q as delivered by RTL2832U based
+ * devices to complex float, out = (in - 127.4) / 128.
+ * \param in 2 * nitems bytes
+ * \param out nitems complex samples
+ * \param nitems number of complex samples to convert
+ */
+OSMOSDR_API void convert_cu8_fc32( const uint8_t *in, gr_complex *out, size_t nitems );
+
+/*!
+ * Convert interleaved signed 8 bit I/Q as delivered by HackRF to complex
+ * float, out = in / 128.
+ * \param in 2 * nitems bytes
+ * \param out nitems complex samples
+ * \param nitems number of complex samples to convert
+ */
+OSMOSDR_API void convert_cs8_fc32( const int8_t *in, gr_complex *out, size_t nitems );
+
+/*!
+ * Convert packed little endian signed 24 bit I/Q as delivered by the
+ * RFSPACE radios in 24 bit mode to complex float, out = in / 2^23.
+ * \param in 6 * nitems bytes
+ * \param out nitems complex samples
+ * \param nitems number of complex samples to convert
+ */
+OSMOSDR_API void convert_cs24_fc32( const uint8_t *in, gr_complex *out, size_t nitems );
+
+/*!
+ * Convert packed little endian signed 12 bit I/Q as written by the bladeRF
+ * tools in SC16 Q11 packed format to complex float, out = in / 2048. Each
+ * sample occupies 3 bytes, I in the lower and Q in the upper 12 bits.
+ * \param in 3 * nitems bytes
+ * \param out nitems complex samples
+ * \param nitems number of complex samples to convert
+ */
+OSMOSDR_API void convert_cs12_fc32( const uint8_t *in, gr_complex *out, size_t nitems );
+
+/*!
+ * Convert interleaved signed 8 bit I/Q carrying a multiplex of nchan
+ * channels (bladeRF SC8 Q7) into one complex float buffer per channel,
+ * out[c][i] = in[i * nchan + c] / 128.
+ * \param in 2 * nchan * nitems bytes
+ * \param out nchan buffers of nitems complex samples each
+ * \param nchan number of channels in the multiplex, 1 for a plain stream
+ * \param nitems number of complex samples per channel
+ */
+OSMOSDR_API void convert_cs8_fc32_deinterleave( const int8_t *in, gr_complex * const *out,
+                                                size_t nchan, size_t nitems );
+
+/*!
+ * Convert interleaved unsigned 8 bit I/Q carrying a multiplex of nchan
+ * channels, e.g. a recording of several RTL dongles, into one complex
+ * float buffer per channel, out[c][i] = (in[i * nchan + c] - 127.4) / 128.
+ * \param in 2 * nchan * nitems bytes
+ * \param out nchan buffers of nitems complex samples each
+ * \param nchan number of channels in the multiplex, 1 for a plain stream
+ * \param nitems number of complex samples per channel
+ */
+OSMOSDR_API void convert_cu8_fc32_deinterleave( const uint8_t *in, gr_complex * const *out,
+                                                size_t nchan, size_t nitems );
+
+/*!
+ * Convert interleaved signed 16 bit I/Q carrying a multiplex of nchan
+ * channels (as delivered by bladeRF MIMO layouts) straight into one complex
+ * float buffer per channel, out[c][i] = in[i * nchan + c] / scale.
+ * \param in 2 * nchan * nitems values
+ * \param out nchan buffers of nitems complex samples each
+ * \param nchan number of channels in the multiplex, 1 for a plain stream
+ * \param nitems number of complex samples per channel
+ * \param scale full scale value, e.g. 2048 for SC16 Q11
+ */
+OSMOSDR_API void convert_cs16_fc32_deinterleave( const int16_t *in, gr_complex * const *out,
+                                                 size_t nchan, size_t nitems, float scale );
+
+/*!
+ * Convert signed 16 bit I and Q held in separate arrays (as delivered by
+ * the SDRplay API) to complex float, out[n] = (i[n] + j q[n]) / scale.
+ * \param i nitems in-phase values
+ * \param q nitems quadrature values
+ * \param out nitems complex samples
+ * \param nitems number of complex samples to convert
+ * \param scale full scale value, e.g. 2048 for 12 bit samples
+ */
+OSMOSDR_API void convert_cs16_planar_fc32( const int16_t *i, const int16_t *q,
+                                           gr_complex *out, size_t nitems, float scale );
+
+/*!
+ * Convert complex float to interleaved signed 8 bit I/Q as consumed by
+ * HackRF, out = round(in * 127), saturated to [-128, 127].
+ * \param in nitems complex samples
+ * \param out 2 * nitems bytes
+ * \param nitems number of complex samples to convert
+ */
+OSMOSDR_API void convert_fc32_cs8( const gr_complex *in, int8_t *out, size_t nitems );
+
+/*!
+ * Convert complex float to interleaved signed 16 bit I/Q,
+ * out = round(in * scale), saturated to [-32768, 32767].
+ * \param in nitems complex samples
+ * \param out 2 * nitems values
+ * \param nitems number of complex samples to convert
+ * \param scale full scale of the device, e.g. 2048 for 12 bit converters
+ */
+OSMOSDR_API void convert_fc32_cs16( const gr_complex *in, int16_t *out, size_t nitems,
+                                    float scale );
+
+/*!
+ * Convert complex float to packed signed 12 bit I/Q, the counterpart of
+ * convert_cs12_fc32(), out = round(in * 2048), saturated to [-2048, 2047].
+ * \param in nitems complex samples
+ * \param out 3 * nitems bytes
+ * \param nitems number of complex samples to convert
+ */
+OSMOSDR_API void convert_fc32_cs12( const gr_complex *in, uint8_t *out, size_t nitems );
+
+/*!
+ * Variants of the conversions above removing a DC offset on the way, for
+ * devices without DC correction of their own. dc is subtracted from every
+ * converted sample and afterwards moved towards the mean of the result,
+ * a one pole IIR (pole 1 - alpha per sample) evaluated once per call, so
+ * a constant offset decays with a time constant of about 1 / alpha
+ * samples. With alpha 0 dc stays as it is, for a manual correction.
+ * \param dc the offset estimate, carried from one call to the next
+ * \param alpha the per sample weight of the estimate update
+ */
+OSMOSDR_API void convert_cu8_fc32_dc( const uint8_t *in, gr_complex *out, size_t nitems,
+                                      gr_complex &dc, float alpha );
+OSMOSDR_API void convert_cs8_fc32_dc( const int8_t *in, gr_complex *out, size_t nitems,
+                                      gr_complex &dc, float alpha );
+OSMOSDR_API void convert_cs16_fc32_dc( const int16_t *in, gr_complex *out, size_t nitems,
+                                       float scale, gr_complex &dc, float alpha );
+
+/*!
+ * The same DC removal for samples the library already delivers as complex
+ * float, in == out is allowed.
+ */
+OSMOSDR_API void remove_dc_fc32( const gr_complex *in, gr_complex *out, size_t nitems,
+                                 gr_complex &dc, float alpha );
+
+/*! the level of converted samples, as measured by the *_agc kernels */
+struct sample_level_t
+{
+  sample_level_t() : power( 0.0f ), peak( 0.0f ), clipped( 0 ) {}
+
+  float power;                  /**< sum of |out|^2 */
+  float peak;                   /**< largest |I| or |Q| */
+  size_t clipped;               /**< I and Q values within 1 % of full scale */
+};
+
+/*!
+ * Variants of the DC removing conversions for the software AGC and the
+ * power tags, which also scale the result by gain and measure its level
+ * in the same pass, out = (converted - dc) * gain. The DC estimate is
+ * updated as above, before the gain is applied.
+ * \param gain the scale applied to the result, > 0
+ * \param level set to the level of out, full scale being gain
+ */
+OSMOSDR_API void convert_cu8_fc32_agc( const uint8_t *in, gr_complex *out, size_t nitems,
+                                       gr_complex &dc, float alpha, float gain, sample_level_t &level );
+OSMOSDR_API void convert_cs8_fc32_agc( const int8_t *in, gr_complex *out, size_t nitems,
+                                       gr_complex &dc, float alpha, float gain, sample_level_t &level );
+OSMOSDR_API void convert_cs16_fc32_agc( const int16_t *in, gr_complex *out, size_t nitems, float scale,
+                                        gr_complex &dc, float alpha, float gain, sample_level_t &level );
+
+/*! the same for complex float samples, in == out is allowed */
+OSMOSDR_API void scale_fc32_agc( const gr_complex *in, gr_complex *out, size_t nitems,
+                                 gr_complex &dc, float alpha, float gain, sample_level_t &level );
+
+/*!
+ * Name of the most capable instruction set the conversion kernels have been
+ * dispatched to, e.g. "avx512", "avx2", "sse2", "neon" or "generic".
+ */
+OSMOSDR_API const char *sample_convert_arch( void );
+
+#endif /* INCLUDED_OSMOSDR_SAMPLE_CONVERT_H */
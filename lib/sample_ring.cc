@@ -0,0 +1,161 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "sample_ring.h"
+#include "arg_helpers.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#else
+#include <chrono>
+#endif
+
+sample_ring_base::sample_ring_base() :
+  _policy(DROP_NEWEST),
+  _min_bytes(0),
+  _granule(1),
+  _seq(0),
+  _waiting(false),
+  _space_seq(0),
+  _space_waiting(false),
+  _interrupted(false),
+  _overflows(0),
+  _dropped(0),
+  _high_water(0)
+{
+}
+
+void sample_ring_base::configure( const std::string &args, size_t granule )
+{
+  dict_t dict = params_to_dict( args );
+
+  _granule = std::max( granule, size_t(1) );
+
+  if ( dict.count( "overflow" ) ) {
+    const std::string &policy = dict["overflow"];
+
+    if ( "drop-newest" == policy )
+      _policy = DROP_NEWEST;
+    else if ( "drop-oldest" == policy )
+      _policy = DROP_OLDEST;
+    else if ( "block" == policy )
+      _policy = BLOCK;
+    else
+      throw std::runtime_error( "Unknown overflow policy " + policy +
+                                ", use drop-newest, drop-oldest or block" );
+  }
+
+  if ( dict.count( "ring_mb" ) )
+    _min_bytes = size_t( boost::lexical_cast< double >( dict["ring_mb"] ) * 1024 * 1024 );
+}
+
+#if defined(__linux__)
+static int futex( std::atomic<uint32_t> *addr, int op, uint32_t val,
+                  const struct timespec *timeout )
+{
+  return syscall( SYS_futex, reinterpret_cast<uint32_t *>(addr),
+                  op, val, timeout, NULL, 0 );
+}
+#endif
+
+void sample_ring_base::wake( std::atomic<uint32_t> &seq, std::atomic<bool> &waiting )
+{
+  seq.fetch_add( 1 );
+
+  if ( ! waiting.load() )
+    return;
+
+#if defined(__linux__)
+  futex( &seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL );
+#else
+  std::lock_guard<std::mutex> lock( _mutex );
+  _cond.notify_all();
+#endif
+}
+
+void sample_ring_base::interrupt()
+{
+  _interrupted.store( true );
+  _seq.fetch_add( 1 );
+  _space_seq.fetch_add( 1 );
+
+  /* wake unconditionally, no data has been published */
+#if defined(__linux__)
+  futex( &_seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL );
+  futex( &_space_seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL );
+#else
+  std::lock_guard<std::mutex> lock( _mutex );
+  _cond.notify_all();
+#endif
+}
+
+bool sample_ring_base::sleep( std::atomic<uint32_t> &seq, std::atomic<bool> &waiting,
+                              uint32_t value, int timeout_ms )
+{
+  bool woken = true;
+
+  waiting.store( true );
+
+#if defined(__linux__)
+  struct timespec ts;
+  struct timespec *timeout = NULL;
+
+  if ( timeout_ms >= 0 ) {
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+    timeout = &ts;
+  }
+
+  /* returns immediately with EAGAIN if the producer got in between */
+  if ( ! _interrupted.load() &&
+       futex( &seq, FUTEX_WAIT_PRIVATE, value, timeout ) != 0 &&
+       errno == ETIMEDOUT )
+    woken = false;
+#else
+  std::unique_lock<std::mutex> lock( _mutex );
+
+  if ( timeout_ms < 0 ) {
+    while ( seq.load() == value && ! _interrupted.load() )
+      _cond.wait( lock );
+  } else {
+    woken = _cond.wait_for( lock, std::chrono::milliseconds( timeout_ms ),
+                            [&]{ return seq.load() != value ||
+                                        _interrupted.load(); } );
+  }
+#endif
+
+  waiting.store( false );
+
+  return woken;
+}
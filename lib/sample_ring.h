@@ -0,0 +1,459 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_SAMPLE_RING_H
+#define INCLUDED_OSMOSDR_SAMPLE_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <osmosdr/api.h>
+
+#include "buffer_pool.h"
+
+#if !defined(__linux__)
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#define SAMPLE_RING_CACHE_LINE 64
+
+/*!
+ * Wakeup primitive and statistics shared by all sample_ring instances.
+ *
+ * The consumer only sleeps in the kernel (futex on Linux, a condition
+ * variable on other platforms) when it actually ran dry, the producer only
+ * issues a wakeup if the consumer announced that it is about to sleep.
+ * Neither side takes a lock in the streaming path.
+ *
+ * What the producer does once the ring is full is set by the overflow=
+ * device argument, the same for all drivers:
+ *
+ * overflow=drop-newest (default) drops the items that don't fit.
+ * overflow=drop-oldest discards the oldest items to make room, so the
+ * latency stays at the ring size. Items the consumer is converting at
+ * that moment are kept, the new ones are dropped then.
+ * overflow=block makes the producer wait until the consumer made room,
+ * back-pressure up to the size of the ring, which ring_mb=N raises to at
+ * least N MiB. The device drops samples once its own buffers run full.
+ */
+class OSMOSDR_API sample_ring_base
+{
+public:
+  enum overflow_t { DROP_NEWEST, DROP_OLDEST, BLOCK };
+
+  /*!
+   * Apply the overflow= and ring_mb= device arguments, before resize().
+   * \param granule overflow=drop-oldest discards multiples of it, e.g. the
+   * bytes of a sample or the channels of a multiplex
+   * \throws std::runtime_error for an unknown overflow policy
+   */
+  void configure( const std::string &args, size_t granule = 1 );
+
+  void set_overflow( overflow_t policy ) { _policy = policy; }
+  overflow_t overflow() const { return _policy; }
+
+  /*! the size resize() allocates at least, in bytes */
+  void set_min_bytes( size_t bytes ) { _min_bytes = bytes; }
+
+  /*! number of push() calls that could not store all items */
+  uint64_t overflows() const { return _overflows.load( std::memory_order_relaxed ); }
+
+  /*! total number of items rejected because the ring was full */
+  uint64_t dropped() const { return _dropped.load( std::memory_order_relaxed ); }
+
+  /*! highest fill level observed by the producer, in items */
+  size_t high_water() const { return _high_water.load( std::memory_order_relaxed ); }
+
+  /*!
+   * Make a blocked or future wait_read() return immediately, used to shut
+   * down the consumer when the stream is being stopped. A producer blocked
+   * by overflow=block drops its items.
+   */
+  void interrupt();
+
+  /*! undo interrupt() */
+  void resume() { _interrupted.store( false ); }
+
+  bool interrupted() const { return _interrupted.load(); }
+
+protected:
+  sample_ring_base();
+
+  /* producer side, called after new items have been published */
+  void wake() { wake( _seq, _waiting ); }
+
+  /* consumer side, sleep until wake() bumped the sequence past seq */
+  bool sleep( uint32_t seq, int timeout_ms ) { return sleep( _seq, _waiting, seq, timeout_ms ); }
+
+  uint32_t sequence() const { return _seq.load(); }
+
+  /* the same for overflow=block, the other way around */
+  void wake_space()
+  {
+    if ( BLOCK == _policy )
+      wake( _space_seq, _space_waiting );
+  }
+
+  void sleep_space( uint32_t seq ) { sleep( _space_seq, _space_waiting, seq, -1 ); }
+
+  uint32_t space_sequence() const { return _space_seq.load(); }
+
+  void account_push( size_t pushed, size_t requested, size_t fill )
+  {
+    if ( pushed < requested ) {
+      _overflows.fetch_add( 1, std::memory_order_relaxed );
+      _dropped.fetch_add( requested - pushed, std::memory_order_relaxed );
+    }
+    if ( fill > _high_water.load( std::memory_order_relaxed ) )
+      _high_water.store( fill, std::memory_order_relaxed );
+  }
+
+  void account_discard( size_t discarded )
+  {
+    _overflows.fetch_add( 1, std::memory_order_relaxed );
+    _dropped.fetch_add( discarded, std::memory_order_relaxed );
+  }
+
+  void reset_stats()
+  {
+    _overflows.store( 0 );
+    _dropped.store( 0 );
+    _high_water.store( 0 );
+  }
+
+  overflow_t _policy;
+  size_t _min_bytes;
+  size_t _granule;
+
+private:
+  void wake( std::atomic<uint32_t> &seq, std::atomic<bool> &waiting );
+  bool sleep( std::atomic<uint32_t> &seq, std::atomic<bool> &waiting,
+              uint32_t value, int timeout_ms );
+
+  std::atomic<uint32_t> _seq;
+  std::atomic<bool> _waiting;
+  std::atomic<uint32_t> _space_seq;
+  std::atomic<bool> _space_waiting;
+  std::atomic<bool> _interrupted;
+#if !defined(__linux__)
+  std::mutex _mutex;
+  std::condition_variable _cond;
+#endif
+
+  std::atomic<uint64_t> _overflows;
+  std::atomic<uint64_t> _dropped;
+  std::atomic<size_t> _high_water;
+};
+
+/*!
+ * Wait-free single producer / single consumer ring of items of type T.
+ *
+ * Data is moved in blocks: push() and pop() copy at most two contiguous
+ * spans, and the write_span()/commit() and read_span()/consume() pairs let
+ * either side convert directly into or out of the ring storage.
+ *
+ * The storage comes from the buffer_pool, pre-faulted by resize().
+ *
+ * Exactly one thread may act as producer and one as consumer at a time.
+ * clear() must only be called while neither of them is active. The
+ * consumer releases what it got from read_span() with consume(), which
+ * keeps overflow=drop-oldest from discarding it meanwhile.
+ */
+template <typename T>
+class sample_ring : public sample_ring_base
+{
+public:
+  /*!
+   * \param capacity minimum number of items the ring can hold, rounded up
+   * to the next power of two
+   */
+  explicit sample_ring( size_t capacity = 0 ) :
+    _read(0), _consumed(0), _write(0)
+  {
+    resize( capacity );
+  }
+
+  /*! reallocate the storage, discards all content */
+  void resize( size_t capacity )
+  {
+    capacity = std::max( capacity, _min_bytes / sizeof(T) );
+
+    size_t size = 1;
+    while ( size < capacity )
+      size <<= 1;
+
+    _storage.assign( size );
+    _mask = size - 1;
+    clear();
+  }
+
+  void clear()
+  {
+    _read.store( 0 );
+    _consumed = 0;
+    _write.store( 0 );
+    reset_stats();
+  }
+
+  size_t capacity() const { return _storage.size(); }
+
+  size_t read_available() const
+  {
+    return fill( _write.load( std::memory_order_acquire ),
+                 _read.load( std::memory_order_relaxed ) );
+  }
+
+  size_t write_available() const
+  {
+    return capacity() - fill( _write.load( std::memory_order_relaxed ),
+                              _read.load( std::memory_order_acquire ) );
+  }
+
+  /***********************************************************************
+   * Producer side
+   **********************************************************************/
+
+  /*!
+   * Copy up to nitems into the ring. Items that don't fit after applying
+   * the overflow policy are dropped and accounted as an overflow.
+   * \return the number of items stored
+   */
+  size_t push( const T *items, size_t nitems )
+  {
+    make_room( nitems );
+
+    const size_t n = std::min( nitems, write_available() );
+    const size_t w = _write.load( std::memory_order_relaxed );
+
+    size_t done = 0;
+    while ( done < n ) {
+      const size_t pos = (w + done) & _mask;
+      const size_t len = std::min( n - done, capacity() - pos );
+      memcpy( &_storage[pos], items + done, len * sizeof(T) );
+      done += len;
+    }
+
+    commit( n, nitems );
+    return n;
+  }
+
+  /*!
+   * Get the contiguous free region at the write position.
+   * \param len receives the number of items that may be written
+   * \param wanted number of items the producer is about to store, room is
+   * made for them according to the overflow policy
+   */
+  T *write_span( size_t &len, size_t wanted = 0 )
+  {
+    make_room( wanted );
+
+    const size_t w = _write.load( std::memory_order_relaxed );
+    const size_t pos = w & _mask;
+    len = std::min( write_available(), capacity() - pos );
+    return &_storage[pos];
+  }
+
+  /*!
+   * Publish n items written through write_span().
+   * \param requested number of items the producer wanted to store, the
+   * difference to n is accounted as dropped
+   */
+  void commit( size_t n, size_t requested = 0 )
+  {
+    const size_t w = _write.load( std::memory_order_relaxed ) + n;
+    _write.store( w, std::memory_order_release );
+
+    account_push( n, std::max( n, requested ),
+                  fill( w, _read.load( std::memory_order_relaxed ) ) );
+    wake();
+  }
+
+  /*! apply the overflow policy unless wanted items fit already */
+  void make_room( size_t wanted )
+  {
+    wanted = std::min( wanted, capacity() );
+
+    if ( DROP_NEWEST != _policy && write_available() < wanted )
+      make_room_slow( wanted );
+  }
+
+  /***********************************************************************
+   * Consumer side
+   **********************************************************************/
+
+  /*!
+   * Block until at least nitems are available.
+   * \param timeout_ms give up after this many milliseconds, -1 waits forever
+   * \return true if nitems are available, false on timeout or interrupt()
+   */
+  bool wait_read( size_t nitems, int timeout_ms = -1 )
+  {
+    while ( read_available() < nitems ) {
+      const uint32_t seq = sequence();
+
+      if ( read_available() >= nitems )
+        break;
+
+      if ( interrupted() || ! sleep( seq, timeout_ms ) )
+        return read_available() >= nitems;
+    }
+
+    return true;
+  }
+
+  /*!
+   * Get the contiguous readable region at the read position.
+   * \param len receives the number of items that may be read
+   */
+  const T *read_span( size_t &len )
+  {
+    /* claim the items, the producer may move the read position meanwhile */
+    size_t r = _read.load( std::memory_order_acquire );
+    while ( ! ( r & BUSY ) &&
+            fill( _write.load( std::memory_order_acquire ), r ) &&
+            ! _read.compare_exchange_weak( r, r | BUSY ) )
+      ;
+
+    const size_t pos = ( r >> 1 ) & _mask;
+    len = _read.load( std::memory_order_relaxed ) & BUSY ?
+          std::min( read_available(), capacity() - pos ) : 0;
+    return &_storage[pos];
+  }
+
+  /*! release n items obtained through read_span() */
+  void consume( size_t n )
+  {
+    /* succeeds right away unless nothing was claimed */
+    size_t r = _read.load( std::memory_order_relaxed );
+    while ( ! _read.compare_exchange_weak( r, ( ( r >> 1 ) + n ) << 1,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed ) )
+      ;
+    if ( r & BUSY )
+      _consumed = ( r >> 1 ) + n;
+    wake_space();
+  }
+
+  /*!
+   * The number of items discarded by overflow=drop-oldest since the last
+   * call. They were the next ones to be read, so the gap is right before
+   * the items read from now on. Call it after read_span(), while the span
+   * is held the producer can't move the read position any further.
+   */
+  size_t discarded()
+  {
+    /* the gap is where the read position is ahead of our own, both come
+     * from the same atomic so a discard in flight can't be missed */
+    const size_t r = _read.load( std::memory_order_acquire ) >> 1;
+    const size_t lost = ( r - _consumed ) & ( ~size_t(0) >> 1 );
+    _consumed = r;
+    return lost;
+  }
+
+  /*!
+   * Copy up to nitems out of the ring.
+   * \param discarded receives discarded(), the items dropped right before
+   * those copied
+   * \return the number of items copied
+   */
+  size_t pop( T *items, size_t nitems, size_t *discarded = NULL )
+  {
+    size_t len;
+    const T *span = read_span( len );
+
+    if ( discarded )
+      *discarded = this->discarded();
+
+    /* the second span, if any, starts at the beginning of the storage */
+    size_t done = std::min( len, nitems );
+    memcpy( items, span, done * sizeof(T) );
+
+    if ( done < nitems && span + len == &_storage[0] + capacity() ) {
+      const size_t rest = std::min( nitems - done, read_available() - done );
+      memcpy( items + done, &_storage[0], rest * sizeof(T) );
+      done += rest;
+    }
+
+    consume( done );
+    return done;
+  }
+
+private:
+  /* the lowest bit of _read is set while the consumer holds a span */
+  static const size_t BUSY = 1;
+
+  /* _read keeps one bit less of the free running index */
+  static size_t fill( size_t w, size_t r )
+  {
+    return ( w - ( r >> 1 ) ) & ( ~size_t(0) >> 1 );
+  }
+
+  void make_room_slow( size_t wanted )
+  {
+    if ( BLOCK == _policy ) {
+      while ( write_available() < wanted && ! interrupted() ) {
+        const uint32_t seq = space_sequence();
+
+        if ( write_available() >= wanted )
+          break;
+
+        sleep_space( seq );
+      }
+      return;
+    }
+
+    const size_t w = _write.load( std::memory_order_relaxed );
+    size_t r = _read.load( std::memory_order_acquire );
+
+    while ( ! ( r & BUSY ) ) {
+      const size_t used = fill( w, r );
+      if ( capacity() - used >= wanted )
+        return;
+
+      size_t drop = wanted - ( capacity() - used );
+      drop = std::min( used, ( drop + _granule - 1 ) / _granule * _granule );
+      if ( _read.compare_exchange_weak( r, ( ( r >> 1 ) + drop ) << 1 ) ) {
+        account_discard( drop );
+        return;
+      }
+    }
+  }
+
+  pooled_buffer<T> _storage;
+  size_t _mask;
+
+  /* free running indices, written by one side only and kept on separate
+   * cache lines to avoid false sharing between the threads, but for
+   * overflow=drop-oldest moving an unclaimed read position */
+  char _pad0[SAMPLE_RING_CACHE_LINE];
+  std::atomic<size_t> _read;
+  size_t _consumed; /* consumer only, the read position it left behind */
+  char _pad1[SAMPLE_RING_CACHE_LINE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+  std::atomic<size_t> _write;
+  char _pad2[SAMPLE_RING_CACHE_LINE - sizeof(std::atomic<size_t>)];
+};
+
+#endif /* INCLUDED_OSMOSDR_SAMPLE_RING_H */
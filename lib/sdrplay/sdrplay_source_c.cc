@@ -36,6 +36,7 @@
 #include <boost/assign.hpp>
 #include <boost/format.hpp>
 
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 #include <stdio.h>
@@ -44,6 +45,7 @@
 #include <mirsdrapi-rsp.h>
 
 #include "arg_helpers.h"
+#include "sample_convert.h"
 
 #define MAX_SUPPORTED_DEVICES   4
 
@@ -77,7 +79,8 @@ using namespace boost::assign;
 #define SDRPLAY_L_MIN     1450e6
 #define SDRPLAY_L_MAX     1675e6
 
-#define SDRPLAY_MAX_BUF_SIZE 504
+/* samples buffered between the streaming callback and work() */
+#define SDRPLAY_FIFO_SIZE (4 << 20)
 
 /*
  * Create a new instance of sdrplay_source_c and return
@@ -110,8 +113,8 @@ sdrplay_source_c::sdrplay_source_c (const std::string &args)
   : gr::sync_block ("sdrplay_source_c",
         gr::io_signature::make(MIN_IN, MAX_IN, sizeof (gr_complex)),
         gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof (gr_complex))),
+    _next_sample(0),
     _running(false),
-    _uninit(false),
     _auto_gain(false)
 {
    _dev = (sdrplay_dev_t *)malloc(sizeof(sdrplay_dev_t));
@@ -128,13 +131,9 @@ sdrplay_source_c::sdrplay_source_c (const std::string &args)
    _dev->gRdB = 60;
    set_gain_limits(_dev->rfHz);
    _dev->gain_dB = _dev->maxGain - _dev->gRdB;
-   
-   _bufi.reserve(SDRPLAY_MAX_BUF_SIZE);
-   _bufq.reserve(SDRPLAY_MAX_BUF_SIZE);   
 
-   _buf_mutex.lock();
-   _buf_offset = 0;
-   _buf_mutex.unlock();
+   _fifo.configure(args);
+   _fifo.resize(SDRPLAY_FIFO_SIZE);
 }
 
 /*
@@ -142,40 +141,132 @@ sdrplay_source_c::sdrplay_source_c (const std::string &args)
  */
 sdrplay_source_c::~sdrplay_source_c ()
 {
+   if (_running)
+   {
+      stop();
+   }
    free(_dev);
    _dev = NULL;
-   _buf_mutex.lock();
-   if (_running)
+}
+
+void sdrplay_source_c::_stream_callback(short *xi, short *xq, unsigned int firstSampleNum,
+                                        int grChanged, int rfChanged, int fsChanged,
+                                        unsigned int numSamples, unsigned int reset,
+                                        void *cbContext)
+{
+   sdrplay_source_c *obj = (sdrplay_source_c *)cbContext;
+
+   obj->stream_callback(xi, xq, firstSampleNum, numSamples, reset != 0);
+}
+
+void sdrplay_source_c::_gain_callback(unsigned int gRdB, unsigned int lnaGRdB,
+                                      void *cbContext)
+{
+   /* the gain is only changed through set_gain(), there is no AGC yet */
+}
+
+void sdrplay_source_c::stream_callback(short *xi, short *xq, unsigned int firstSampleNum,
+                                       unsigned int numSamples, bool reset)
+{
+   /* the API numbers the samples, a gap means it lost some */
+   if (reset)
    {
-      _running = false;
+      _tagger.retag();
+   }
+   else if (firstSampleNum != _next_sample)
+   {
+      _stats.overflow(firstSampleNum - _next_sample);
+      _tagger.lost(firstSampleNum - _next_sample);
+   }
+   _next_sample = firstSampleNum + numSamples;
+
+   size_t done = 0;
+   while (done < numSamples)
+   {
+      size_t len;
+      gr_complex *span = _fifo.write_span(len, numSamples - done);
+      len = std::min(len, size_t(numSamples - done));
+      if (!len)
+      {
+         break;
+      }
+      convert_cs16_planar_fc32(xi + done, xq + done, span, len, 2048.0f);
+      _fifo.commit(len);
+      done += len;
+   }
+   _tagger.stored(done);
+
+   if (done < numSamples)
+   {
+      _fifo.commit(0, numSamples - done);
+      _stats.overflow(numSamples - done);
+      _tagger.lost(numSamples - done);
    }
-   _uninit = true;
-   _buf_mutex.unlock();
 }
 
 void sdrplay_source_c::reinit_device()
 {
-   std::cerr << "reinit_device started" << std::endl;
-   _buf_mutex.lock();
-   std::cerr << "after mutex.lock" << std::endl;
+   std::lock_guard<std::mutex> lock(_dev_mutex);
+
    if (_running)
    {
-      std::cerr << "mir_sdr_Uninit started" << std::endl;
-      mir_sdr_Uninit();
+      mir_sdr_StreamUninit();
    }
 
-   std::cerr << "mir_sdr_Init started" << std::endl;
-   mir_sdr_Init(_dev->gRdB, _dev->fsHz / 1e6, _dev->rfHz / 1e6, _dev->bwType, _dev->ifType, &_dev->samplesPerPacket);
+   int gRdBsystem = 0;
+   mir_sdr_ErrT err = mir_sdr_StreamInit(&_dev->gRdB, _dev->fsHz / 1e6, _dev->rfHz / 1e6,
+                                         _dev->bwType, _dev->ifType, 0, &gRdBsystem,
+                                         mir_sdr_USE_SET_GR, &_dev->samplesPerPacket,
+                                         _stream_callback, _gain_callback, this);
+   if (err != mir_sdr_Success)
+   {
+      _running = false;
+      throw std::runtime_error("Failed to start SDRplay streaming (" +
+                               boost::lexical_cast<std::string>(err) + ")");
+   }
 
    if (_dev->dcMode)
    {
-      std::cerr << "mir_sdr_SetDcMode started" << std::endl;
       mir_sdr_SetDcMode(4, 1);
    }
 
-   _buf_offset = 0;
-   _buf_mutex.unlock();
-   std::cerr << "reinit_device end" << std::endl;
+   _tagger.retag();
+   _running = true;
+}
+
+bool sdrplay_source_c::start()
+{
+   _fifo.clear();
+   _fifo.resume();
+   _next_sample = 0;
+   _tagger.reset();
+
+   try
+   {
+      reinit_device();
+   }
+   catch (const std::runtime_error &e)
+   {
+      std::cerr << e.what() << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+bool sdrplay_source_c::stop()
+{
+   _fifo.interrupt();
+
+   std::lock_guard<std::mutex> lock(_dev_mutex);
+
+   if (_running)
+   {
+      _running = false;
+      mir_sdr_StreamUninit();
+   }
+
+   return true;
 }
 
 void sdrplay_source_c::set_gain_limits(double freq)
@@ -212,55 +303,23 @@ int sdrplay_source_c::work( int noutput_items,
                             gr_vector_void_star &output_items )
 {
    gr_complex *out = (gr_complex *)output_items[0];
-   int cnt = noutput_items;
-   unsigned int sampNum;
-   int grChanged;
-   int rfChanged;
-   int fsChanged;
 
-   if (_uninit)
+   /* whatever the callback stored, without waiting for noutput_items */
+   if (!_fifo.wait_read(1))
    {
       return WORK_DONE;
    }
 
-   if (!_running)
-   {
-      reinit_device();
-      _running = true;
-   }
-
-   _buf_mutex.lock();
-
-   if (_buf_offset)
+   size_t lost;
+   noutput_items = _fifo.pop(out, noutput_items, &lost);
+   if (lost)
    {
-      for (int i = _buf_offset; i < _dev->samplesPerPacket; i++)
-      {
-         *out++ = gr_complex( float(_bufi[i]) * (1.0f/2048.0f), float(_bufq[i]) * (1.0f/2048.0f) );
-      }
-      cnt -= (_dev->samplesPerPacket - _buf_offset);
+      _stats.overflow(lost);
+      _tagger.skipped(nitems_written(0), lost);
    }
 
-   while ((cnt - _dev->samplesPerPacket) >= 0)
-   {
-      mir_sdr_ReadPacket(_bufi.data(), _bufq.data(), &sampNum, &grChanged, &rfChanged, &fsChanged);
-      for (int i = 0; i < _dev->samplesPerPacket; i++)
-      {
-         *out++ = gr_complex( float(_bufi[i]) * (1.0f/2048.0f), float(_bufq[i]) * (1.0f/2048.0f) );
-      }
-      cnt -= _dev->samplesPerPacket;
-   }
-
-   _buf_offset = 0;
-   if (cnt)
-   {
-      mir_sdr_ReadPacket(_bufi.data(), _bufq.data(), &sampNum, &grChanged, &rfChanged, &fsChanged);
-      for (int i = 0; i < cnt; i++)
-      {
-         *out++ = gr_complex( float(_bufi[i]) * (1.0f/2048.0f), float(_bufq[i]) * (1.0f/2048.0f) );
-      }
-      _buf_offset = cnt;
-   }
-   _buf_mutex.unlock();
+   _tagger.update( this, noutput_items );
+   _stats.delivered( noutput_items );
 
    return noutput_items;
 }
@@ -298,6 +357,12 @@ size_t sdrplay_source_c::get_num_channels()
    return 1;
 }
 
+osmosdr::stream_stats_t sdrplay_source_c::get_stream_stats( size_t chan )
+{
+   /* gaps in the sample numbers of the callback count as overflows */
+   return _stats.get();
+}
+
 osmosdr::meta_range_t sdrplay_source_c::get_sample_rates()
 {
    osmosdr::meta_range_t range;
@@ -312,6 +377,7 @@ double sdrplay_source_c::set_sample_rate(double rate)
    std::cerr << "set_sample_rate start" << std::endl;
    double diff = rate - _dev->fsHz;
    _dev->fsHz = rate;
+   _tagger.set_rate(rate);
 
    std::cerr << "rate = " << rate << std::endl;
    std::cerr << "diff = " << diff << std::endl;
@@ -320,6 +386,7 @@ double sdrplay_source_c::set_sample_rate(double rate)
       if (fabs(diff) < 10000.0)
       {
          std::cerr << "mir_sdr_SetFs started" << std::endl;
+         std::lock_guard<std::mutex> lock(_dev_mutex);
          mir_sdr_SetFs(diff, 0, 0, 0);
       }
       else
@@ -344,6 +411,11 @@ double sdrplay_source_c::get_sample_rate()
    return _dev->fsHz;
 }
 
+double sdrplay_source_c::get_measured_sample_rate( size_t chan )
+{
+   return _tagger.measured_rate();
+}
+
 osmosdr::freq_range_t sdrplay_source_c::get_freq_range( size_t chan )
 {
    osmosdr::freq_range_t range;
@@ -364,12 +436,14 @@ double sdrplay_source_c::set_center_freq( double freq, size_t chan )
    double diff = freq - _dev->rfHz;
    std::cerr << "diff = " << diff << std::endl;
    _dev->rfHz = freq;
+   _tagger.set_freq(freq);
    set_gain_limits(freq);
    if (_running) 
    {
       if (fabs(diff) < 10000.0)
       {
          std::cerr << "mir_sdr_SetRf started" << std::endl;
+         std::lock_guard<std::mutex> lock(_dev_mutex);
          mir_sdr_SetRf(diff, 0, 0);
       }
       else
@@ -468,6 +542,7 @@ double sdrplay_source_c::set_gain( double gain, size_t chan )
    if (_running) 
    {
       std::cerr << "mir_sdr_SetGr started" << std::endl;
+      std::lock_guard<std::mutex> lock(_dev_mutex);
       mir_sdr_SetGr(_dev->gRdB, 1, 0);
    }
 
@@ -522,6 +597,7 @@ void sdrplay_source_c::set_dc_offset_mode( int mode, size_t chan )
       _dev->dcMode = 0;
       if (_running)
       {
+         std::lock_guard<std::mutex> lock(_dev_mutex);
          mir_sdr_SetDcMode(4, 1);
       }
    }
@@ -531,6 +607,7 @@ void sdrplay_source_c::set_dc_offset_mode( int mode, size_t chan )
       _dev->dcMode = 0;
       if (_running)
       {
+         std::lock_guard<std::mutex> lock(_dev_mutex);
          mir_sdr_SetDcMode(4, 1);
       }
    }
@@ -539,6 +616,7 @@ void sdrplay_source_c::set_dc_offset_mode( int mode, size_t chan )
       _dev->dcMode = 1;
       if (_running)
       {
+         std::lock_guard<std::mutex> lock(_dev_mutex);
          mir_sdr_SetDcMode(4, 1);
       }
    }
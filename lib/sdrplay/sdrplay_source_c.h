@@ -25,12 +25,15 @@
 
 #include <gnuradio/thread/thread.h>
 
+#include <atomic>
 #include <mutex>
-#include <condition_variable>
 
 #include "osmosdr/ranges.h"
 
 #include "source_iface.h"
+#include "sample_ring.h"
+#include "rx_tagger.h"
+#include "stream_counters.h"
 
 class sdrplay_source_c;
 typedef struct sdrplay_dev sdrplay_dev_t;
@@ -79,6 +82,9 @@ private:
 public:
    ~sdrplay_source_c ();	// public destructor
 
+   bool start();
+   bool stop();
+
    int work( int noutput_items,
             gr_vector_const_void_star &input_items,
             gr_vector_void_star &output_items );
@@ -86,10 +92,12 @@ public:
    static std::vector< std::string > get_devices();
 
    size_t get_num_channels( void );
+   osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
 
    osmosdr::meta_range_t get_sample_rates( void );
    double set_sample_rate( double rate );
    double get_sample_rate( void );
+   double get_measured_sample_rate( size_t chan = 0 );
 
    osmosdr::freq_range_t get_freq_range( size_t chan = 0 );
    double set_center_freq( double freq, size_t chan = 0 );
@@ -119,18 +127,29 @@ public:
    osmosdr::freq_range_t get_bandwidth_range( size_t chan = 0 );
 
 private:
+   static void _stream_callback(short *xi, short *xq, unsigned int firstSampleNum,
+                                int grChanged, int rfChanged, int fsChanged,
+                                unsigned int numSamples, unsigned int reset,
+                                void *cbContext);
+   static void _gain_callback(unsigned int gRdB, unsigned int lnaGRdB,
+                              void *cbContext);
+   void stream_callback(short *xi, short *xq, unsigned int firstSampleNum,
+                        unsigned int numSamples, bool reset);
+
    void reinit_device(void);
    void set_gain_limits(double freq);
 
    sdrplay_dev_t *_dev;
 
-   std::vector< short > _bufi;
-   std::vector< short > _bufq;
-   int _buf_offset;
-   std::mutex _buf_mutex;
+   /* filled by the streaming thread of the API, emptied by work() */
+   sample_ring<gr_complex> _fifo;
+   unsigned int _next_sample;
+
+   rx_tagger _tagger;
+   stream_counters _stats;
+   std::mutex _dev_mutex;  /**< serializes the control calls, not streaming */
 
-   bool _running;
-   bool _uninit;
+   std::atomic<bool> _running;
    bool _auto_gain;
 };
 
@@ -0,0 +1,622 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+/*
+ * Serves the receiver of any osmosdr device to any number of net= sources
+ * on the network, see net_protocol.h.
+ *
+ * The samples are read through osmosdr::stream without a flowgraph,
+ * encoded once into datagrams of the wire format and sent to every
+ * subscribed client, or to a multicast group. Devices delivering integer
+ * samples with cpu_format= are sent as they are. cs12 packs 16 bit
+ * samples into 12 bits for links where bandwidth is scarce.
+ *
+ * usage: osmosdr_server [--args=ARGS] [--port=N] [--bind=ADDR]
+ *                       [--format=cs16|cs12|cs8|fc32] [--mtu=BYTES]
+ *                       [--multicast=GROUP[:PORT]] [--ttl=N] [--read-only]
+ *                       [--rate=R] [--freq=F] [--gain=G]
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <osmosdr/stream.h>
+
+#include "arg_helpers.h"
+#include "net_protocol.h"
+#include "sample_convert.h"
+
+#define DATAGRAM_BATCH  32   /* datagrams encoded per read of the device */
+#define SEND_BATCH      64   /* datagrams handed to the kernel per call */
+#define DEFAULT_SNDBUF  (4 * 1024 * 1024)
+#define READ_TIMEOUT    0.5  /* seconds */
+
+static std::atomic<bool> quit( false );
+
+static void on_signal( int )
+{
+  quit = true;
+}
+
+static bool same_addr( const sockaddr_in &a, const sockaddr_in &b )
+{
+  return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+}
+
+static std::string addr_name( const sockaddr_in &addr )
+{
+  char host[INET_ADDRSTRLEN];
+  inet_ntop( AF_INET, &addr.sin_addr, host, sizeof(host) );
+  return std::string( host ) + ":" + std::to_string( ntohs( addr.sin_port ) );
+}
+
+static std::string to_text( double value )
+{
+  return boost::lexical_cast< std::string >( value );
+}
+
+class net_server
+{
+public:
+  net_server( const std::string &args, int format, size_t mtu, bool readonly ) :
+    _readonly( readonly ),
+    _sock( -1 ),
+    _multicast( false ),
+    _auto_gain( false ),
+    _seq( 0 ),
+    _sample( 0 )
+  {
+    _stream = osmosdr::stream::open( args );
+
+    if ( _stream->get_num_channels() > 1 )
+      std::cerr << "Serving channel 0 of " << _stream->get_num_channels()
+                << " only" << std::endl;
+
+    /* integer samples the device delivers itself go out as they are */
+    const std::string cpu_format = _stream->get_cpu_format();
+    _native = ( "fc32" != cpu_format );
+
+    if ( _native ) {
+      const int native = net_format_from_name( cpu_format );
+      if ( native < 0 || ( format >= 0 && format != native ) )
+        throw std::runtime_error( "cpu_format " + cpu_format +
+                                  " of the device does not match --format" );
+      format = native;
+    }
+
+    _format = format < 0 ? NET_CS16 : format;
+    _item_size = net_item_size( _format );
+    _items_per_datagram = ( mtu - sizeof(net_header_t) ) / _item_size;
+
+    if ( mtu > NET_MAX_DATAGRAM || _items_per_datagram < 1 )
+      throw std::runtime_error( "--mtu out of range" );
+
+    _name = params_to_vector( args ).size() ?
+            param_to_pair( params_to_vector( args )[0] ).first : "default";
+
+    _rate = _stream->get_sample_rate();
+    _freq = _stream->get_center_freq();
+
+    /* a client can tell a restarted server from lost datagrams */
+    _session = uint32_t( std::chrono::steady_clock::now().time_since_epoch().count() ) ^
+               uint32_t( getpid() );
+
+    const size_t batch = _items_per_datagram * DATAGRAM_BATCH;
+    _samples.resize( batch * _stream->get_item_size() );
+
+    /* the other channels are read into a buffer of their own and dropped */
+    _buffs.push_back( &_samples[0] );
+    if ( _stream->get_num_channels() > 1 )
+      _discard.resize( _samples.size() );
+    while ( _buffs.size() < _stream->get_num_channels() )
+      _buffs.push_back( &_discard[0] );
+    _datagrams.resize( DATAGRAM_BATCH * mtu );
+    _mtu = mtu;
+  }
+
+  ~net_server()
+  {
+    if ( _sock >= 0 )
+      close( _sock );
+  }
+
+  void listen( const std::string &bind_addr, unsigned short port )
+  {
+    if ( ( _sock = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP ) ) < 0 )
+      throw std::runtime_error( std::string("socket: ") + strerror(errno) );
+
+    struct sockaddr_in local;
+    memset( &local, 0, sizeof(local) );
+    local.sin_family = AF_INET;
+    local.sin_port = htons( port );
+
+    if ( inet_pton( AF_INET, bind_addr.c_str(), &local.sin_addr ) != 1 )
+      throw std::runtime_error( "Invalid address " + bind_addr );
+
+    if ( bind( _sock, (struct sockaddr *)&local, sizeof(local) ) < 0 )
+      throw std::runtime_error( std::string("bind: ") + strerror(errno) );
+
+    int sndbuf = DEFAULT_SNDBUF;
+    setsockopt( _sock, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf) );
+
+    struct timeval tv = { 0, 200000 };
+    setsockopt( _sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv) );
+  }
+
+  void set_multicast( const std::string &group, unsigned short port, int ttl )
+  {
+    memset( &_group, 0, sizeof(_group) );
+    _group.sin_family = AF_INET;
+    _group.sin_port = htons( port );
+
+    if ( inet_pton( AF_INET, group.c_str(), &_group.sin_addr ) != 1 ||
+         ! IN_MULTICAST( ntohl( _group.sin_addr.s_addr ) ) )
+      throw std::runtime_error( "Invalid multicast group " + group );
+
+    unsigned char mttl = ttl;
+    setsockopt( _sock, IPPROTO_IP, IP_MULTICAST_TTL, &mttl, sizeof(mttl) );
+
+    _multicast = true;
+  }
+
+  /* apply "key=value,..." settings, as from the command line or NET_SET */
+  void apply( const std::string &settings )
+  {
+    dict_t dict = params_to_dict( settings );
+
+    try {
+      if ( dict.count("rate") )
+        _stream->set_sample_rate( boost::lexical_cast< double >( dict["rate"] ) );
+      if ( dict.count("freq") )
+        _stream->set_center_freq( boost::lexical_cast< double >( dict["freq"] ) );
+      if ( dict.count("gain_mode") ) {
+        _auto_gain = ( "1" == dict["gain_mode"] );
+        _stream->set_gain_mode( _auto_gain );
+      }
+      if ( dict.count("gain") )
+        _stream->set_gain( boost::lexical_cast< double >( dict["gain"] ) );
+      if ( dict.count("antenna") )
+        _stream->set_antenna( dict["antenna"] );
+      if ( dict.count("bandwidth") )
+        _stream->set_bandwidth( boost::lexical_cast< double >( dict["bandwidth"] ) );
+    } catch ( const std::exception &ex ) {
+      std::cerr << "Failed to apply " << settings << ": " << ex.what() << std::endl;
+    }
+
+    std::lock_guard< std::mutex > lock( _mutex );
+    _rate = _stream->get_sample_rate();
+    _freq = _stream->get_center_freq();
+  }
+
+  /* subscriptions and settings from the clients, on a thread of its own */
+  void control()
+  {
+    std::vector< unsigned char > msg( NET_MAX_DATAGRAM );
+
+    while ( ! quit ) {
+      struct sockaddr_in from;
+      socklen_t fromlen = sizeof(from);
+
+      ssize_t len = recvfrom( _sock, &msg[0], msg.size(), 0,
+                              (struct sockaddr *)&from, &fromlen );
+
+      expire();
+
+      net_header_t hdr;
+      if ( len < 0 || ! net_parse_header( &msg[0], len, hdr ) ||
+           hdr.nitems > len - sizeof(hdr) )
+        continue;
+
+      if ( NET_SUBSCRIBE == hdr.type ) {
+        if ( subscribe( from, hdr.flags & NET_FLAG_MULTICAST ) )
+          send_info( from );
+      } else if ( NET_UNSUBSCRIBE == hdr.type ) {
+        unsubscribe( from );
+      } else if ( NET_SET == hdr.type ) {
+        const std::string settings( (const char *)&msg[sizeof(hdr)], hdr.nitems );
+        if ( settings.size() && ! _readonly )
+          apply( settings );
+        send_info( from );
+      }
+    }
+  }
+
+  /* read, encode and fan out until interrupted or the device stops */
+  void run()
+  {
+    std::thread control_thread( &net_server::control, this );
+
+    std::cerr << "Serving " << _name << " as " << net_format_name( _format )
+              << ( _multicast ? " to multicast group " + addr_name( _group ) : "" )
+              << std::endl;
+
+    const size_t batch = _items_per_datagram * DATAGRAM_BATCH;
+
+    while ( ! quit ) {
+      osmosdr::rx_metadata_t md;
+      const size_t nitems = _stream->read( _buffs, batch, READ_TIMEOUT, md );
+
+      if ( md.end_of_stream ) {
+        std::cerr << "The device stopped streaming" << std::endl;
+        break;
+      }
+
+      if ( ! nitems )
+        continue;
+
+      std::vector< sockaddr_in > dests = destinations();
+      if ( dests.size() )
+        send( encode( nitems ), dests );
+
+      _sample += nitems;
+    }
+
+    quit = true;
+    control_thread.join();
+    _stream->close();
+  }
+
+private:
+  struct client_t
+  {
+    sockaddr_in addr;
+    bool multicast;
+    std::chrono::steady_clock::time_point seen;
+  };
+
+  /* true for a client not known before */
+  bool subscribe( const sockaddr_in &addr, bool multicast )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    for ( client_t &client : _clients ) {
+      if ( same_addr( client.addr, addr ) ) {
+        client.seen = std::chrono::steady_clock::now();
+        return false;
+      }
+    }
+
+    client_t client = { addr, multicast, std::chrono::steady_clock::now() };
+    _clients.push_back( client );
+
+    std::cerr << "Client " << addr_name( addr ) << " subscribed, "
+              << _clients.size() << " connected" << std::endl;
+
+    return true;
+  }
+
+  void unsubscribe( const sockaddr_in &addr )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    for ( size_t i = 0; i < _clients.size(); i++ ) {
+      if ( same_addr( _clients[i].addr, addr ) ) {
+        _clients.erase( _clients.begin() + i );
+        std::cerr << "Client " << addr_name( addr ) << " left, "
+                  << _clients.size() << " connected" << std::endl;
+        return;
+      }
+    }
+  }
+
+  /* drop the clients which stopped sending keepalives */
+  void expire()
+  {
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    for ( size_t i = 0; i < _clients.size(); ) {
+      if ( now - _clients[i].seen > std::chrono::milliseconds( NET_EXPIRE_MS ) ) {
+        std::cerr << "Client " << addr_name( _clients[i].addr ) << " timed out, "
+                  << _clients.size() - 1 << " connected" << std::endl;
+        _clients.erase( _clients.begin() + i );
+      } else {
+        i++;
+      }
+    }
+  }
+
+  /* the group, or the unicast clients; empty while nobody listens */
+  std::vector< sockaddr_in > destinations()
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    std::vector< sockaddr_in > dests;
+
+    if ( _multicast ) {
+      if ( _clients.size() )
+        dests.push_back( _group );
+      return dests;
+    }
+
+    for ( const client_t &client : _clients )
+      if ( ! client.multicast )
+        dests.push_back( client.addr );
+
+    return dests;
+  }
+
+  void send_info( const sockaddr_in &to )
+  {
+    std::string text = "name=" + _name;
+    text += ",format=" + std::string( net_format_name( _format ) );
+
+    net_header_t hdr = net_make_header( NET_INFO );
+    hdr.format = _format;
+    hdr.session = _session;
+    hdr.flags = _readonly ? NET_FLAG_READONLY : 0;
+
+    try {
+      text += ",rates=" + net_format_ranges( _stream->get_sample_rates() );
+      text += ",freqs=" + net_format_ranges( _stream->get_freq_range() );
+      text += ",gains=" + net_format_ranges( _stream->get_gain_range() );
+      text += ",gain=" + to_text( _stream->get_gain() );
+      text += ",gain_mode=" + std::string( _auto_gain ? "1" : "0" );
+      text += ",bandwidth=" + to_text( _stream->get_bandwidth() );
+
+      const std::string antenna = _stream->get_antenna();
+      if ( antenna.size() )
+        text += ",antenna=" + antenna;
+    } catch ( const std::exception &ex ) {
+      std::cerr << "Failed to describe the device: " << ex.what() << std::endl;
+    }
+
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      hdr.rate = _rate;
+      hdr.freq = _freq;
+    }
+
+    text += ",rate=" + to_text( hdr.rate ) + ",freq=" + to_text( hdr.freq );
+    hdr.nitems = text.size();
+
+    std::vector< unsigned char > msg( sizeof(hdr) + text.size() );
+    memcpy( &msg[0], &hdr, sizeof(hdr) );
+    memcpy( &msg[sizeof(hdr)], text.data(), text.size() );
+
+    sendto( _sock, &msg[0], msg.size(), 0, (const struct sockaddr *)&to, sizeof(to) );
+  }
+
+  /* encode nitems samples into datagrams, returns their sizes */
+  std::vector< size_t > encode( size_t nitems )
+  {
+    std::vector< size_t > sizes;
+
+    net_header_t hdr = net_make_header( NET_DATA );
+    hdr.format = _format;
+    hdr.session = _session;
+
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      hdr.rate = _rate;
+      hdr.freq = _freq;
+    }
+
+    const size_t in_size = _stream->get_item_size();
+
+    for ( size_t done = 0; done < nitems; ) {
+      const size_t n = std::min( _items_per_datagram, nitems - done );
+      unsigned char *dgram = &_datagrams[sizes.size() * _mtu];
+      unsigned char *payload = dgram + sizeof(hdr);
+      const unsigned char *in = &_samples[done * in_size];
+      const gr_complex *samples = (const gr_complex *)in;
+
+      hdr.seq = _seq++;
+      hdr.sample = _sample + done;
+      hdr.nitems = n;
+      memcpy( dgram, &hdr, sizeof(hdr) );
+
+      if ( _native || NET_FC32 == _format )
+        memcpy( payload, in, n * _item_size );
+      else if ( NET_CS16 == _format )
+        convert_fc32_cs16( samples, (int16_t *)payload, n, 32767.0f );
+      else if ( NET_CS12 == _format )
+        convert_fc32_cs12( samples, payload, n );
+      else
+        convert_fc32_cs8( samples, (int8_t *)payload, n );
+
+      sizes.push_back( sizeof(hdr) + n * _item_size );
+      done += n;
+    }
+
+    return sizes;
+  }
+
+  /* every datagram to every destination, in as few calls as possible */
+  void send( const std::vector< size_t > &sizes, const std::vector< sockaddr_in > &dests )
+  {
+#ifdef __linux__
+    struct iovec iov[SEND_BATCH];
+    struct mmsghdr msgs[SEND_BATCH];
+    size_t count = 0;
+
+    memset( msgs, 0, sizeof(msgs) );
+
+    for ( size_t i = 0; i < sizes.size(); i++ ) {
+      for ( const sockaddr_in &dest : dests ) {
+        iov[count].iov_base = &_datagrams[i * _mtu];
+        iov[count].iov_len = sizes[i];
+        msgs[count].msg_hdr.msg_iov = &iov[count];
+        msgs[count].msg_hdr.msg_iovlen = 1;
+        msgs[count].msg_hdr.msg_name = (void *)&dest;
+        msgs[count].msg_hdr.msg_namelen = sizeof(dest);
+
+        if ( ++count == SEND_BATCH ) {
+          flush( msgs, count );
+          count = 0;
+        }
+      }
+    }
+
+    flush( msgs, count );
+#else
+    for ( size_t i = 0; i < sizes.size(); i++ )
+      for ( const sockaddr_in &dest : dests )
+        sendto( _sock, &_datagrams[i * _mtu], sizes[i], 0,
+                (const struct sockaddr *)&dest, sizeof(dest) );
+#endif
+  }
+
+#ifdef __linux__
+  void flush( struct mmsghdr *msgs, size_t count )
+  {
+    /* a datagram the kernel can't queue is lost like on the wire */
+    for ( size_t sent = 0; sent < count; ) {
+      int ret = sendmmsg( _sock, msgs + sent, count - sent, 0 );
+      if ( ret < 0 ) {
+        if ( EINTR == errno )
+          continue;
+        sent++;
+      } else {
+        sent += ret;
+      }
+    }
+  }
+#endif
+
+  osmosdr::stream::sptr _stream;
+  std::string _name;
+  bool _native;
+  int _format;
+  size_t _item_size;
+  size_t _items_per_datagram;
+  size_t _mtu;
+  bool _readonly;
+
+  int _sock;
+  bool _multicast;
+  sockaddr_in _group;
+
+  std::mutex _mutex;            /**< guards _clients, _rate and _freq */
+  std::vector< client_t > _clients;
+  double _rate;
+  double _freq;
+  bool _auto_gain;
+
+  uint32_t _session;
+  uint32_t _seq;
+  uint64_t _sample;
+  std::vector< unsigned char > _samples;
+  std::vector< unsigned char > _discard;
+  std::vector< void * > _buffs;
+  std::vector< unsigned char > _datagrams;
+};
+
+static void usage( const char *argv0 )
+{
+  fprintf( stderr,
+           "usage: %s [--args=ARGS] [--port=N] [--bind=ADDR]\n"
+           "          [--format=cs16|cs12|cs8|fc32] [--mtu=BYTES]\n"
+           "          [--multicast=GROUP[:PORT]] [--ttl=N] [--read-only]\n"
+           "          [--rate=R] [--freq=F] [--gain=G]\n"
+           "  ARGS are the device arguments of osmosdr::source, e.g. rtl=0\n"
+           "  clients connect with a source of net=host[:port] (default %d)\n",
+           argv0, NET_DEFAULT_PORT );
+}
+
+int main( int argc, char **argv )
+{
+  std::string args, bind_addr = "0.0.0.0", group, settings;
+  unsigned short port = NET_DEFAULT_PORT, group_port = 0;
+  int format = -1, ttl = 1;
+  size_t mtu = NET_DEFAULT_MTU;
+  bool readonly = false;
+
+  for ( int i = 1; i < argc; i++ ) {
+    std::string arg = argv[i];
+    const size_t eq = arg.find( '=' );
+    const std::string key = arg.substr( 0, eq );
+    const std::string value = eq != std::string::npos ? arg.substr( eq + 1 ) : "";
+
+    if ( "--args" == key ) {
+      args = value;
+    } else if ( "--port" == key ) {
+      port = atoi( value.c_str() );
+    } else if ( "--bind" == key ) {
+      bind_addr = value;
+    } else if ( "--format" == key ) {
+      format = net_format_from_name( value );
+      if ( format < 0 || NET_CU8 == format ) {
+        usage( argv[0] );
+        return 1;
+      }
+    } else if ( "--mtu" == key ) {
+      mtu = atoi( value.c_str() );
+    } else if ( "--multicast" == key ) {
+      const size_t colon = value.find( ':' );
+      group = value.substr( 0, colon );
+      if ( colon != std::string::npos )
+        group_port = atoi( value.c_str() + colon + 1 );
+    } else if ( "--ttl" == key ) {
+      ttl = atoi( value.c_str() );
+    } else if ( "--read-only" == key ) {
+      readonly = true;
+    } else if ( "--rate" == key || "--freq" == key || "--gain" == key ) {
+      settings += ( settings.size() ? "," : "" ) + arg.substr( 2 );
+    } else if ( "-h" == key || "--help" == key ) {
+      usage( argv[0] );
+      return 0;
+    } else {
+      usage( argv[0] );
+      return 1;
+    }
+  }
+
+  signal( SIGINT, on_signal );
+  signal( SIGTERM, on_signal );
+
+  try {
+    net_server server( args, format, mtu, readonly );
+
+    server.listen( bind_addr, port );
+    if ( group.size() )
+      server.set_multicast( group, group_port ? group_port : port, ttl );
+
+    server.apply( settings );
+    server.run();
+  } catch ( const std::exception &ex ) {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
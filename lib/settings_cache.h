@@ -0,0 +1,197 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_SETTINGS_CACHE_H
+#define INCLUDED_OSMOSDR_SETTINGS_CACHE_H
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+
+/*!
+ * Write-through cache of the settings of the channels of source_impl and
+ * sink_impl, so that polling the getters does not go to the device, e.g.
+ * a USB or TCP round trip competing with the stream for the control path.
+ *
+ * The setters store what the device reports to have applied, the getters
+ * read the device once and then the cache. Settings the device may change
+ * on its own, the gains under AGC or the frequency while sweeping, are
+ * marked volatile and always read from the device, and while commands are
+ * timed nothing is cached since the device applies them later.
+ */
+class settings_cache
+{
+public:
+  enum setting_t {
+    SAMPLE_RATE,
+    CENTER_FREQ,
+    FREQ_CORR,
+    GAIN_MODE,
+    GAIN,
+    NAMED_GAIN,
+    ANTENNA,
+    BANDWIDTH
+  };
+
+  settings_cache() : _suspended( false ) {}
+
+  /*!
+   * The cached value, or the one fetch() reads from the device, which is
+   * cached then.
+   */
+  template< typename T, typename F >
+  T get( setting_t setting, size_t chan, F fetch, const std::string &name = "" )
+  {
+    const key_t key( setting, chan, name );
+    T value;
+
+    if ( lookup( key, value ) )
+      return value;
+
+    value = fetch();
+    store( key, value );
+
+    return value;
+  }
+
+  /*! write-through from a setter, value as applied by the device */
+  template< typename T >
+  T put( setting_t setting, size_t chan, const T &value, const std::string &name = "" )
+  {
+    store( key_t( setting, chan, name ), value );
+    return value;
+  }
+
+  /*! forget a setting of a channel, all of its names for NAMED_GAIN */
+  void invalidate( setting_t setting, size_t chan )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    erase( _values, setting, chan );
+    erase( _strings, setting, chan );
+  }
+
+  /*! forget a setting of all channels */
+  void invalidate( setting_t setting )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    erase( _values, setting );
+    erase( _strings, setting );
+  }
+
+  /*! forget everything */
+  void clear()
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _values.clear();
+    _strings.clear();
+  }
+
+  /*! always read a setting of a channel from the device while set */
+  void set_volatile( setting_t setting, size_t chan, bool vol )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    const std::pair< int, size_t > entry( setting, chan );
+
+    if ( vol ) {
+      _volatile.insert( entry );
+      erase( _values, setting, chan );
+      erase( _strings, setting, chan );
+    } else {
+      _volatile.erase( entry );
+    }
+  }
+
+  /*! cache nothing while set, e.g. while commands are timed */
+  void suspend( bool suspended )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _suspended = suspended;
+    _values.clear();
+    _strings.clear();
+  }
+
+private:
+  typedef std::tuple< int, size_t, std::string > key_t;
+
+  bool cacheable( const key_t &key ) const
+  {
+    return ! _suspended &&
+           ! _volatile.count( std::make_pair( std::get<0>( key ), std::get<1>( key ) ) );
+  }
+
+  template< typename T >
+  bool lookup( const key_t &key, T &value )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    return find( map_of( value ), key, value );
+  }
+
+  template< typename T >
+  void store( const key_t &key, const T &value )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    if ( cacheable( key ) )
+      map_of( value )[ key ] = value;
+  }
+
+  template< typename M, typename T >
+  static bool find( const M &map, const key_t &key, T &value )
+  {
+    typename M::const_iterator it = map.find( key );
+    if ( it == map.end() )
+      return false;
+
+    value = T( it->second );
+    return true;
+  }
+
+  /* doubles and bools share a map, antennas have one of their own */
+  std::map< key_t, double > &map_of( double ) { return _values; }
+  std::map< key_t, double > &map_of( bool ) { return _values; }
+  std::map< key_t, std::string > &map_of( const std::string & ) { return _strings; }
+
+  template< typename M >
+  static void erase( M &map, int setting, size_t chan )
+  {
+    typename M::iterator it = map.lower_bound( key_t( setting, chan, "" ) );
+    while ( it != map.end() && std::get<0>( it->first ) == setting &&
+            std::get<1>( it->first ) == chan )
+      it = map.erase( it );
+  }
+
+  template< typename M >
+  static void erase( M &map, int setting )
+  {
+    typename M::iterator it = map.lower_bound( key_t( setting, 0, "" ) );
+    while ( it != map.end() && std::get<0>( it->first ) == setting )
+      it = map.erase( it );
+  }
+
+  std::mutex _mutex;
+  std::map< key_t, double > _values;
+  std::map< key_t, std::string > _strings;
+  std::set< std::pair< int, size_t > > _volatile;
+  bool _suspended;
+};
+
+#endif /* INCLUDED_OSMOSDR_SETTINGS_CACHE_H */
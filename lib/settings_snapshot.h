@@ -0,0 +1,110 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_SETTINGS_SNAPSHOT_H
+#define INCLUDED_OSMOSDR_SETTINGS_SNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+/*!
+ * Settings written by the control calls and read by the streaming side,
+ * published as a whole so the reader never waits for a writer.
+ *
+ * A sequence lock: publish() bumps the sequence to odd, stores the words
+ * of the new value and bumps it to even again, read() copies the words
+ * and retries if the sequence was odd or moved meanwhile. Writers only
+ * serialize among themselves, so a control call firing many updates a
+ * second costs work() a few loads per read and never a lock, and it
+ * always sees one consistent value, never half of an update. T has to
+ * be trivially copyable and is meant to be a few words in size.
+ */
+template< typename T >
+class settings_snapshot
+{
+public:
+  explicit settings_snapshot( const T &value = T() ) :
+    _seq( 0 )
+  {
+    static_assert( std::is_trivially_copyable< T >::value,
+                   "settings_snapshot requires a trivially copyable type" );
+    store( value );
+  }
+
+  /*! make value the current settings, from any thread */
+  void publish( const T &value )
+  {
+    std::lock_guard< std::mutex > lock( _write_mutex );
+
+    const uint64_t seq = _seq.load( std::memory_order_relaxed );
+    _seq.store( seq + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    store( value );
+
+    _seq.store( seq + 2, std::memory_order_release );
+  }
+
+  /*! the current settings, lock-free */
+  T read() const
+  {
+    uint64_t words[ WORDS ];
+    uint64_t before, after;
+
+    do {
+      before = _seq.load( std::memory_order_acquire );
+
+      for ( size_t i = 0; i < WORDS; i++ )
+        words[i] = _words[i].load( std::memory_order_relaxed );
+
+      std::atomic_thread_fence( std::memory_order_acquire );
+      after = _seq.load( std::memory_order_relaxed );
+    } while ( ( before & 1 ) || before != after );
+
+    T value;
+    memcpy( &value, words, sizeof(T) );
+    return value;
+  }
+
+  /*! changes with every publish(), to skip reading unchanged settings */
+  uint64_t version() const { return _seq.load( std::memory_order_acquire ); }
+
+private:
+  static const size_t WORDS = ( sizeof(T) + sizeof(uint64_t) - 1 ) / sizeof(uint64_t);
+
+  void store( const T &value )
+  {
+    uint64_t words[ WORDS ] = { 0 };
+    memcpy( words, &value, sizeof(T) );
+
+    for ( size_t i = 0; i < WORDS; i++ )
+      _words[i].store( words[i], std::memory_order_relaxed );
+  }
+
+  std::mutex _write_mutex;      /**< one publish() at a time */
+  std::atomic< uint64_t > _seq;
+  std::atomic< uint64_t > _words[ WORDS ];
+};
+
+#endif /* INCLUDED_OSMOSDR_SETTINGS_SNAPSHOT_H */
@@ -0,0 +1,499 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+#include <boost/assign.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <gnuradio/io_signature.h>
+
+#include "sim_source_c.h"
+
+#include "arg_helpers.h"
+#include "sample_convert.h"
+
+using namespace boost::assign;
+
+/* 256 KiB transfers of 8 bit samples, like rtl and hackrf */
+#define DEFAULT_TRANSFER (16 * 32 * 512 / 2)
+#define DEFAULT_BUF_NUM 15
+#define DEFAULT_RATE 20e6
+
+/* wire format of the simulated device, see format= */
+static std::string args_to_format( const std::string &args )
+{
+  dict_t dict = params_to_dict( args );
+
+  std::string format = dict.count( "format" ) ? dict["format"] : "cu8";
+
+  if ( "cu8" != format && "cs8" != format &&
+       "cs16" != format && "fc32" != format )
+    throw std::runtime_error( "Unsupported sim format '" + format +
+                              "', must be one of cu8, cs8, cs16, fc32" );
+
+  return format;
+}
+
+sim_source_c_sptr make_sim_source_c( const std::string & args )
+{
+  return gnuradio::get_initial_sptr( new sim_source_c( args ) );
+}
+
+sim_source_c::sim_source_c( const std::string & args ) :
+  gr::sync_block( "sim_source_c",
+                  gr::io_signature::make( 0, 0, 0 ),
+                  gr::io_signature::make( 1, 1, cpu_format_item_size(
+                      args_to_cpu_format( args, args_to_format( args ) ) ) ) ),
+  _transfer( DEFAULT_TRANSFER ),
+  _buf_num( DEFAULT_BUF_NUM ),
+  _jitter( 0 ),
+  _running( false ),
+  _rate( DEFAULT_RATE ),
+  _freq( 0 ),
+  _commands( &_tagger ),
+  _sweep( &_tagger, [this]( double freq ) { return sweep_tune( freq ); } ),
+  _tuning( args )
+{
+  dict_t dict = params_to_dict( args );
+
+  _format = args_to_format( args );
+  _cpu_format = args_to_cpu_format( args, _format );
+  _item_size = cpu_format_item_size( _format );
+
+  _stats.set_quiet( args_to_quiet( args ) );
+  _ring.configure( args, _item_size );
+
+  if ( dict.count( "rate" ) )
+    _rate = boost::lexical_cast< double >( dict["rate"] );
+
+  if ( dict.count( "freq" ) )
+    _freq = boost::lexical_cast< double >( dict["freq"] );
+
+  if ( dict.count( "transfer" ) )
+    _transfer = boost::lexical_cast< size_t >( dict["transfer"] );
+
+  if ( dict.count( "buffers" ) )
+    _buf_num = boost::lexical_cast< size_t >( dict["buffers"] );
+
+  if ( dict.count( "jitter" ) ) /* given in microseconds */
+    _jitter = boost::lexical_cast< double >( dict["jitter"] ) * 1e-6;
+
+  if ( dict.count( "latency" ) )
+    _latency.enable( dict["latency"] == "1" );
+
+  if ( _rate <= 0 )
+    throw std::runtime_error( "sim rate must be positive" );
+
+  if ( 0 == _transfer || 0 == _buf_num )
+    throw std::runtime_error( "sim transfer and buffers must be positive" );
+
+  std::cerr << "Using " << _buf_num << " transfers of " << _transfer
+            << " " << _format << " samples at " << _rate / 1e6 << " MS/s";
+  if ( _jitter > 0 )
+    std::cerr << " with " << _jitter * 1e6 << " us jitter";
+  std::cerr << "." << std::endl;
+
+  generate_signal();
+  _tuning.allocate( [this] { _ring.resize( _buf_num * _signal.size() ); } );
+
+  _tagger.set_rate( _rate );
+  _tagger.set_freq( _freq );
+}
+
+sim_source_c::~sim_source_c()
+{
+  _commands.shutdown();
+  stop();
+}
+
+/*
+ * One transfer of a full scale / 2 tone at about a quarter of the Nyquist
+ * frequency plus a little noise. The tone completes an integral number of
+ * cycles per transfer, so back to back transfers form a continuous signal.
+ */
+void sim_source_c::generate_signal()
+{
+  const size_t cycles = std::max( _transfer / 8, size_t(1) );
+  std::minstd_rand rng( 1 );
+  std::uniform_real_distribution<float> noise( -0.05f, 0.05f );
+
+  _signal.resize( _transfer * _item_size );
+
+  for ( size_t n = 0; n < _transfer; n++ ) {
+    const double phase = 2 * M_PI * double(cycles) * n / _transfer;
+    const float i = 0.5f * std::cos( phase ) + noise( rng );
+    const float q = 0.5f * std::sin( phase ) + noise( rng );
+    unsigned char *out = &_signal[n * _item_size];
+
+    if ( "cu8" == _format ) {
+      out[0] = std::min( std::max( std::lround( i * 128 + 127.4f ), 0L ), 255L );
+      out[1] = std::min( std::max( std::lround( q * 128 + 127.4f ), 0L ), 255L );
+    } else if ( "cs8" == _format ) {
+      ((int8_t *)out)[0] = std::min( std::max( std::lround( i * 127 ), -128L ), 127L );
+      ((int8_t *)out)[1] = std::min( std::max( std::lround( q * 127 ), -128L ), 127L );
+    } else if ( "cs16" == _format ) { /* SC16 Q11 like bladeRF */
+      const int16_t iq[2] = {
+        int16_t( std::min( std::max( std::lround( i * 2048 ), -2048L ), 2047L ) ),
+        int16_t( std::min( std::max( std::lround( q * 2048 ), -2048L ), 2047L ) )
+      };
+      memcpy( out, iq, sizeof(iq) );
+    } else {
+      const gr_complex s( i, q );
+      memcpy( out, &s, sizeof(s) );
+    }
+  }
+}
+
+/*
+ * Stand-in for the callback thread of a device library. Transfers are
+ * scheduled on a fixed grid derived from the sample rate, the jitter only
+ * moves the individual deliveries around their slot, so the long term rate
+ * stays exact.
+ */
+void sim_source_c::producer()
+{
+  _tuning.apply();
+
+  typedef std::chrono::steady_clock clock;
+  typedef std::chrono::duration<double> seconds;
+
+  std::minstd_rand rng( 2 );
+  std::uniform_real_distribution<double> jitter( -_jitter, _jitter );
+  clock::time_point next = clock::now();
+  const size_t len = _signal.size();
+
+  while ( _running ) {
+    const double rate = _rate.load();
+
+    next += std::chrono::duration_cast<clock::duration>( seconds( _transfer / rate ) );
+
+    clock::time_point when = next;
+    if ( _jitter > 0 )
+      when += std::chrono::duration_cast<clock::duration>( seconds( jitter( rng ) ) );
+
+    /* sleep in slices to react to stop() at low rates */
+    while ( _running && clock::now() < when )
+      std::this_thread::sleep_until( std::min( when, clock::now() +
+                                               std::chrono::milliseconds( 10 ) ) );
+
+    if ( ! _running )
+      break;
+
+    /* if the thread couldn't run for longer than the ring holds, e.g. the
+     * host was suspended, restart the grid rather than catch up in a burst */
+    const clock::time_point now = clock::now();
+    if ( now - next > seconds( _buf_num * _transfer / rate ) )
+      next = now;
+
+    size_t pushed = _ring.push( &_signal[0], len );
+    _latency.arrived( pushed );
+    _commands.stored( pushed / _item_size );
+    _tagger.stored( pushed / _item_size );
+    if ( pushed < len ) {
+      _stats.overflow( (len - pushed) / _item_size );
+      _tagger.lost( (len - pushed) / _item_size );
+    }
+  }
+}
+
+bool sim_source_c::start()
+{
+  if ( _running )
+    return true;
+
+  _ring.clear();
+  _ring.resume();
+  _latency.reset();
+  _tagger.reset();
+  _commands.reset();
+
+  _running = true;
+  _thread = std::thread( &sim_source_c::producer, this );
+
+  return true;
+}
+
+bool sim_source_c::stop()
+{
+  _running = false;
+  _ring.interrupt();
+
+  if ( _thread.joinable() )
+    _thread.join();
+
+  return true;
+}
+
+void sim_source_c::convert( const unsigned char *in, void *out, size_t nitems )
+{
+  gr_complex *dst = (gr_complex *)out;
+
+  if ( _cpu_format == _format )
+    memcpy( out, in, nitems * _item_size );
+  else if ( "cu8" == _format )
+    convert_cu8_fc32( in, dst, nitems );
+  else if ( "cs8" == _format )
+    convert_cs8_fc32( (const int8_t *)in, dst, nitems );
+  else if ( "cs16" == _format )
+    convert_cs16_fc32_deinterleave( (const int16_t *)in, &dst, 1, nitems, 2048.0f );
+}
+
+int sim_source_c::work( int noutput_items,
+                        gr_vector_const_void_star &input_items,
+                        gr_vector_void_star &output_items )
+{
+  unsigned char *out = (unsigned char *)output_items[0];
+  const size_t out_size = cpu_format_item_size( _cpu_format );
+  int produced = 0;
+
+  _commands.anchor( nitems_written( 0 ) );
+
+  if ( ! _running || ! _ring.wait_read( _item_size ) )
+    return WORK_DONE;
+
+  while ( noutput_items ) {
+    size_t len;
+    const unsigned char *buf = _ring.read_span( len );
+    if ( size_t lost = _ring.discarded() ) {
+      _latency.consumed( lost );
+      _stats.overflow( lost / _item_size );
+      _tagger.skipped( nitems_written( 0 ) + produced, lost / _item_size );
+    }
+
+    const int nout = std::min( noutput_items, int(len / _item_size) );
+
+    if ( ! nout )
+      break;
+
+    convert( buf, out, nout );
+    _ring.consume( nout * _item_size );
+    _latency.consumed( nout * _item_size );
+
+    out += nout * out_size;
+    produced += nout;
+    noutput_items -= nout;
+  }
+
+  produced = _sweep.process( this, output_items[0], produced, out_size );
+  _tagger.update( this, produced );
+  _stats.delivered( produced );
+
+  return produced;
+}
+
+std::string sim_source_c::name()
+{
+  return "Synthetic Source";
+}
+
+std::vector< std::string > sim_source_c::get_devices( bool fake )
+{
+  std::vector< std::string > devices;
+
+  if ( fake )
+  {
+    std::string args = "sim=0,rate=20e6,transfer=131072,format=cu8";
+    args += ",label='Synthetic Source'";
+    devices.push_back( args );
+  }
+
+  return devices;
+}
+
+size_t sim_source_c::get_num_channels()
+{
+  return 1;
+}
+
+std::string sim_source_c::get_cpu_format()
+{
+  return _cpu_format;
+}
+
+osmosdr::stream_stats_t sim_source_c::get_stream_stats( size_t chan )
+{
+  osmosdr::stream_stats_t stats = _stats.get();
+  stats.high_water = _ring.high_water() / _item_size;
+  stats.fill = _ring.read_available() / _item_size;
+  _latency.get( stats );
+  return stats;
+}
+
+osmosdr::meta_range_t sim_source_c::get_sample_rates()
+{
+  osmosdr::meta_range_t range;
+
+  range += osmosdr::range_t( 1e3, 200e6 );
+
+  return range;
+}
+
+double sim_source_c::set_sample_rate( double rate )
+{
+  if ( rate > 0 ) {
+    _rate = rate;
+    _tagger.set_rate( rate );
+  }
+
+  return get_sample_rate();
+}
+
+double sim_source_c::get_sample_rate()
+{
+  return _rate;
+}
+
+double sim_source_c::get_measured_sample_rate( size_t chan )
+{
+  return _tagger.measured_rate();
+}
+
+osmosdr::freq_range_t sim_source_c::get_freq_range( size_t chan )
+{
+  return osmosdr::freq_range_t( 0, 6e9 );
+}
+
+double sim_source_c::set_center_freq( double freq, size_t chan )
+{
+  if ( _commands.defer( [=]{ set_center_freq( freq, chan ); } ) )
+    return freq;
+
+  _freq = freq;
+  _tagger.set_freq( freq );
+
+  return get_center_freq( chan );
+}
+
+double sim_source_c::get_center_freq( size_t chan )
+{
+  return _freq;
+}
+
+double sim_source_c::set_freq_corr( double ppm, size_t chan )
+{
+  return get_freq_corr( chan );
+}
+
+double sim_source_c::get_freq_corr( size_t chan )
+{
+  return 0;
+}
+
+std::vector<std::string> sim_source_c::get_gain_names( size_t chan )
+{
+  return std::vector< std::string >();
+}
+
+osmosdr::gain_range_t sim_source_c::get_gain_range( size_t chan )
+{
+  return osmosdr::gain_range_t();
+}
+
+osmosdr::gain_range_t sim_source_c::get_gain_range( const std::string & name, size_t chan )
+{
+  return get_gain_range( chan );
+}
+
+double sim_source_c::set_gain( double gain, size_t chan )
+{
+  return get_gain( chan );
+}
+
+double sim_source_c::set_gain( double gain, const std::string & name, size_t chan )
+{
+  return set_gain( gain, chan );
+}
+
+double sim_source_c::get_gain( size_t chan )
+{
+  return 0;
+}
+
+double sim_source_c::get_gain( const std::string & name, size_t chan )
+{
+  return get_gain( chan );
+}
+
+std::vector< std::string > sim_source_c::get_antennas( size_t chan )
+{
+  return std::vector< std::string >();
+}
+
+std::string sim_source_c::set_antenna( const std::string & antenna, size_t chan )
+{
+  return get_antenna( chan );
+}
+
+std::string sim_source_c::get_antenna( size_t chan )
+{
+  return "";
+}
+
+void sim_source_c::set_command_time( const osmosdr::time_spec_t &time_spec, size_t mboard )
+{
+  _commands.set_time( time_spec );
+}
+
+void sim_source_c::set_command_sample( uint64_t sample, size_t chan )
+{
+  _commands.set_item( sample );
+}
+
+void sim_source_c::clear_command_time( size_t mboard )
+{
+  _commands.clear();
+}
+
+bool sim_source_c::set_sweep( const std::vector<double> &freqs,
+                              double dwell, double settle, size_t chan )
+{
+  const double rate = get_sample_rate();
+
+  _sweep.set( freqs, size_t(dwell * rate + 0.5), size_t(settle * rate + 0.5) );
+
+  return true;
+}
+
+void sim_source_c::clear_sweep( size_t chan )
+{
+  _sweep.clear();
+}
+
+/* called from work() by the sweep, returns the samples received before */
+size_t sim_source_c::sweep_tune( double freq )
+{
+  _freq = freq;
+  _tagger.set_freq( freq );
+
+  return _ring.read_available() / _item_size;
+}
@@ -0,0 +1,143 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_SIM_SOURCE_C_H
+#define INCLUDED_SIM_SOURCE_C_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+
+#include "source_iface.h"
+#include "sample_ring.h"
+#include "rx_tagger.h"
+#include "command_queue.h"
+#include "sweep_engine.h"
+#include "stream_counters.h"
+#include "latency_probe.h"
+#include "thread_tuning.h"
+
+class sim_source_c;
+
+typedef boost::shared_ptr< sim_source_c > sim_source_c_sptr;
+
+sim_source_c_sptr make_sim_source_c( const std::string & args = "" );
+
+/*!
+ * \brief Synthetic device for load testing flowgraphs without hardware.
+ *
+ * A producer thread plays the role of the USB callback thread of a real
+ * driver: it delivers transfer sized bursts of a test signal in the given
+ * wire format at the configured sample rate, optionally with timing jitter.
+ * The bursts pass through the same sample_ring and conversion kernels as
+ * in the rtl, hackrf, bladerf and airspy drivers, so a consumer that can't
+ * keep up overflows the ring just like it would with a radio.
+ */
+class sim_source_c :
+    public gr::sync_block,
+    public source_iface
+{
+private:
+  friend sim_source_c_sptr make_sim_source_c(const std::string &args);
+
+  sim_source_c(const std::string &args);
+
+public:
+  ~sim_source_c();
+
+  bool start();
+  bool stop();
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+  std::string name();
+
+  static std::vector< std::string > get_devices( bool fake = false );
+
+  size_t get_num_channels( void );
+  std::string get_cpu_format( void );
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
+  osmosdr::meta_range_t get_sample_rates( void );
+  double set_sample_rate( double rate );
+  double get_sample_rate( void );
+  double get_measured_sample_rate( size_t chan = 0 );
+
+  osmosdr::freq_range_t get_freq_range( size_t chan = 0 );
+  double set_center_freq( double freq, size_t chan = 0 );
+  double get_center_freq( size_t chan = 0 );
+  double set_freq_corr( double ppm, size_t chan = 0 );
+  double get_freq_corr( size_t chan = 0 );
+
+  std::vector<std::string> get_gain_names( size_t chan = 0 );
+  osmosdr::gain_range_t get_gain_range( size_t chan = 0 );
+  osmosdr::gain_range_t get_gain_range( const std::string & name, size_t chan = 0 );
+  double set_gain( double gain, size_t chan = 0 );
+  double set_gain( double gain, const std::string & name, size_t chan = 0 );
+  double get_gain( size_t chan = 0 );
+  double get_gain( const std::string & name, size_t chan = 0 );
+
+  std::vector< std::string > get_antennas( size_t chan = 0 );
+  std::string set_antenna( const std::string & antenna, size_t chan = 0 );
+  std::string get_antenna( size_t chan = 0 );
+
+  void set_command_time( const osmosdr::time_spec_t &time_spec, size_t mboard = 0 );
+  void set_command_sample( uint64_t sample, size_t chan = 0 );
+  void clear_command_time( size_t mboard = 0 );
+
+  bool set_sweep( const std::vector<double> &freqs,
+                  double dwell, double settle, size_t chan = 0 );
+  void clear_sweep( size_t chan = 0 );
+
+private:
+  void generate_signal();
+  void producer();
+  void convert( const unsigned char *in, void *out, size_t nitems );
+  size_t sweep_tune( double freq );
+
+  std::string _format;          /**< wire format: cu8, cs8, cs16 or fc32 */
+  std::string _cpu_format;      /**< fc32 or the wire format */
+  size_t _item_size;            /**< bytes per sample on the wire */
+  size_t _transfer;             /**< samples per transfer */
+  size_t _buf_num;              /**< ring capacity in transfers */
+  double _jitter;               /**< maximum delivery jitter in seconds */
+
+  std::vector<unsigned char> _signal; /**< one transfer of test signal */
+  sample_ring<unsigned char> _ring;
+
+  std::thread _thread;
+  std::atomic<bool> _running;
+  std::atomic<double> _rate;
+  double _freq;
+
+  rx_tagger _tagger;
+  stream_counters _stats;
+  latency_probe _latency;
+  command_queue _commands;
+  sweep_engine _sweep;
+  thread_tuning _tuning;
+};
+
+#endif /* INCLUDED_SIM_SOURCE_C_H */
@@ -23,6 +23,7 @@
 
 #include <osmosdr/ranges.h>
 #include <osmosdr/time_spec.h>
+#include <osmosdr/stream_stats.h>
 #include <gnuradio/basic_block.h>
 
 /*!
@@ -363,6 +364,36 @@ public:
    * \param time_spec the new time
    */
   virtual void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec) { }
+
+  /*!
+   * Set the time at which the following settings take effect.
+   * \param time_spec the device time
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                                size_t mboard = 0) { }
+
+  /*!
+   * Apply the following settings immediately again.
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void clear_command_time(size_t mboard = 0) { }
+
+  /*!
+   * Get the streaming statistics of a channel.
+   * \param chan the channel index 0 to N-1
+   * \return the counters, all zero if the device doesn't track them
+   */
+  virtual ::osmosdr::stream_stats_t get_stream_stats(size_t chan = 0)
+  {
+    return ::osmosdr::stream_stats_t();
+  }
+
+  /*!
+   * Whether the device block has a "trigger" message input, which the
+   * sink then exports.
+   */
+  virtual bool has_trigger(void) { return false; }
 };
 
 #endif // OSMOSDR_SINK_IFACE_H
@@ -30,29 +30,10 @@
 #include <gnuradio/io_signature.h>
 #include <gnuradio/constants.h>
 
-#ifdef ENABLE_UHD
-#include "uhd_sink_c.h"
-#endif
-#ifdef ENABLE_HACKRF
-#include "hackrf_sink_c.h"
-#endif
-#ifdef ENABLE_BLADERF
-#include "bladerf_sink_c.h"
-#endif
-#ifdef ENABLE_SOAPY
-#include "soapy_sink_c.h"
-#endif
-#ifdef ENABLE_REDPITAYA
-#include "redpitaya_sink_c.h"
-#endif
-#ifdef ENABLE_FREESRP
-#include <freesrp_sink_c.h>
-#endif
-#ifdef ENABLE_FILE
-#include "file_sink_c.h"
-#endif
-
 #include "arg_helpers.h"
+#include "control_port.h"
+#include "device_enum.h"
+#include "driver_registry.h"
 #include "sink_impl.h"
 
 /*
@@ -76,88 +57,44 @@ sink_impl::sink_impl( const std::string &args )
 {
   size_t channel = 0;
   bool device_specified = false;
+  bool trigger_port = false;
 
   std::vector< std::string > arg_list = args_to_vector(args);
 
-  std::vector< std::string > dev_types;
-
-#ifdef ENABLE_UHD
-  dev_types.push_back("uhd");
-#endif
-#ifdef ENABLE_HACKRF
-  dev_types.push_back("hackrf");
-#endif
-#ifdef ENABLE_BLADERF
-  dev_types.push_back("bladerf");
-#endif
-#ifdef ENABLE_SOAPY
-  dev_types.push_back("soapy");
-#endif
-#ifdef ENABLE_REDPITAYA
-  dev_types.push_back("redpitaya");
-#endif
-#ifdef ENABLE_FREESRP
-  dev_types.push_back("freesrp");
-#endif
-#ifdef ENABLE_FILE
-  dev_types.push_back("file");
-#endif
+  driver_registry &registry = driver_registry::get();
 
   std::cerr << "gr-osmosdr "
             << GR_OSMOSDR_VERSION << " (" << GR_OSMOSDR_LIBVER << ") "
             << "gnuradio " << gr::version() << std::endl;
   std::cerr << "built-in sink types: ";
-  for (std::string dev_type : dev_types)
+  for (std::string dev_type : registry.names( true ))
     std::cerr << dev_type << " ";
   std::cerr << std::endl;
 
   for (std::string arg : arg_list) {
     dict_t dict = params_to_dict(arg);
-    for (std::string dev_type : dev_types) {
-      if ( dict.count( dev_type ) ) {
+    for (dict_t::value_type &entry : dict) {
+      const driver_registry::driver_t *driver = registry.find( entry.first );
+      if ( driver && driver->make_sink ) {
         device_specified = true;
         break;
       }
     }
   }
 
+  /* the first device found, with every driver enumerated concurrently */
   if ( ! device_specified ) {
-    std::vector< std::string > dev_list;
-#ifdef ENABLE_UHD
-    for (std::string dev : uhd_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_BLADERF
-    for (std::string dev : bladerf_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_HACKRF
-    for (std::string dev : hackrf_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_SOAPY
-    for (std::string dev : soapy_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_REDPITAYA
-    for (std::string dev : redpitaya_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_FREESRP
-    for (std::string dev : freesrp_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_FILE
-    for (std::string dev : file_sink_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-
-//    std::cerr << std::endl;
-//    for (std::string dev : dev_list)
-//      std::cerr << "'" << dev << "'" << std::endl;
+    device_enumerator devices( args_to_enum_timeout( arg_list ) );
+    for (const driver_registry::driver_t *driver : registry.all()) {
+      if ( driver->sink_devices ) {
+        driver_registry::lister_t lister = driver->sink_devices;
+        devices.add( driver->name, [lister]{ return lister( false ); } );
+      }
+    }
 
-    if ( dev_list.size() )
-      arg_list.push_back( dev_list.front() );
+    std::string dev = devices.first();
+    if ( dev.length() )
+      arg_list.push_back( dev );
     else
       throw std::runtime_error("No supported devices found (check the connection and/or udev rules).");
   }
@@ -173,48 +110,23 @@ sink_impl::sink_impl( const std::string &args )
     sink_iface *iface = NULL;
     gr::basic_block_sptr block;
 
-#ifdef ENABLE_UHD
-    if ( dict.count("uhd") ) {
-      uhd_sink_c_sptr sink = make_uhd_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_HACKRF
-    if ( dict.count("hackrf") ) {
-      hackrf_sink_c_sptr sink = make_hackrf_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_BLADERF
-    if ( dict.count("bladerf") ) {
-      bladerf_sink_c_sptr sink = make_bladerf_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_SOAPY
-    if ( dict.count("soapy") ) {
-      soapy_sink_c_sptr sink = make_soapy_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_REDPITAYA
-    if ( dict.count("redpitaya") ) {
-      redpitaya_sink_c_sptr sink = make_redpitaya_sink_c( arg );
-      block = sink; iface = sink.get();
-    }
-#endif
-#ifdef ENABLE_FREESRP
-    if ( dict.count("freesrp") ) {
-      freesrp_sink_c_sptr sink = make_freesrp_sink_c( arg );
-      block = sink; iface = sink.get();
+    for (dict_t::value_type &entry : dict) {
+      const driver_registry::driver_t *driver = registry.find( entry.first );
+      if ( driver && driver->make_sink ) {
+        driver_registry::sink_block_t sink = driver->make_sink( arg );
+        block = sink.block; iface = sink.iface;
+        break;
+      }
     }
-#endif
-#ifdef ENABLE_FILE
-    if ( dict.count("file") ) {
-      file_sink_c_sptr sink = make_file_sink_c( arg );
-      block = sink; iface = sink.get();
+
+    /* export the pre-trigger ring dump port of ring_seconds file sinks */
+    if ( iface != NULL && iface->has_trigger() ) {
+      if ( ! trigger_port ) {
+        message_port_register_hier_in( pmt::string_to_symbol("trigger") );
+        trigger_port = true;
+      }
+      msg_connect( self(), "trigger", block, "trigger" );
     }
-#endif
 
     if ( iface != NULL && long(block.get()) != 0 ) {
       _devs.push_back( iface );
@@ -229,6 +141,15 @@ sink_impl::sink_impl( const std::string &args )
 
   if (!_devs.size())
     throw std::runtime_error("No devices specified via device arguments.");
+
+  /* settings posted as messages are applied on the thread of the port */
+  control_port_sptr control = control_port::make(
+    [this]( const pmt::pmt_t &cmd ) { return control_port::apply( *this, cmd ); } );
+
+  message_port_register_hier_in( pmt::string_to_symbol("command") );
+  message_port_register_hier_out( pmt::string_to_symbol("status") );
+  msg_connect( self(), "command", control, "command" );
+  msg_connect( control, "status", self(), "status" );
 }
 
 size_t sink_impl::get_num_channels()
@@ -266,6 +187,10 @@ double sink_impl::set_sample_rate(double rate)
     for (sink_iface *dev : _devs)
       sample_rate = dev->set_sample_rate(rate);
 
+    /* the devices may adapt their filters to the rate */
+    _settings.invalidate( settings_cache::BANDWIDTH );
+    _settings.put( settings_cache::SAMPLE_RATE, 0, sample_rate );
+
     _sample_rate = sample_rate;
   }
 
@@ -276,8 +201,11 @@ double sink_impl::get_sample_rate()
 {
   double sample_rate = 0;
 
-  if (!_devs.empty())
-    sample_rate = _devs[0]->get_sample_rate(); // assume same devices used in the group
+  if (!_devs.empty()) {
+    sink_iface *dev = _devs[0]; // assume same devices used in the group
+    sample_rate = _settings.get< double >( settings_cache::SAMPLE_RATE, 0,
+                    [dev] { return dev->get_sample_rate(); } );
+  }
 #if 0
   else
     throw std::runtime_error(NO_DEVICES_MSG);
@@ -304,7 +232,8 @@ double sink_impl::set_center_freq( double freq, size_t chan )
       if ( chan == channel++ ) {
         if ( _center_freq[ chan ] != freq ) {
           _center_freq[ chan ] = freq;
-          return dev->set_center_freq( freq, dev_chan );
+          return _settings.put( settings_cache::CENTER_FREQ, chan,
+                                dev->set_center_freq( freq, dev_chan ) );
         } else { return _center_freq[ chan ]; }
       }
 
@@ -317,7 +246,8 @@ double sink_impl::get_center_freq( size_t chan )
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ )
-        return dev->get_center_freq( dev_chan );
+        return _settings.get< double >( settings_cache::CENTER_FREQ, chan,
+                 [dev, dev_chan] { return dev->get_center_freq( dev_chan ); } );
 
   return 0;
 }
@@ -330,7 +260,10 @@ double sink_impl::set_freq_corr( double ppm, size_t chan )
       if ( chan == channel++ ) {
         if ( _freq_corr[ chan ] != ppm ) {
           _freq_corr[ chan ] = ppm;
-          return dev->set_freq_corr( ppm, dev_chan );
+          /* the frequency reported may include the correction */
+          _settings.invalidate( settings_cache::CENTER_FREQ, chan );
+          return _settings.put( settings_cache::FREQ_CORR, chan,
+                                dev->set_freq_corr( ppm, dev_chan ) );
         } else { return _freq_corr[ chan ]; }
       }
 
@@ -343,7 +276,8 @@ double sink_impl::get_freq_corr( size_t chan )
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ )
-        return dev->get_freq_corr( dev_chan );
+        return _settings.get< double >( settings_cache::FREQ_CORR, chan,
+                 [dev, dev_chan] { return dev->get_freq_corr( dev_chan ); } );
 
   return 0;
 }
@@ -390,6 +324,10 @@ bool sink_impl::set_gain_mode( bool automatic, size_t chan )
         if ( _gain_mode[ chan ] != automatic ) {
           _gain_mode[ chan ] = automatic;
           bool mode = dev->set_gain_mode( automatic, dev_chan );
+          _settings.put( settings_cache::GAIN_MODE, chan, mode );
+          /* the AGC changes the gains on its own */
+          _settings.set_volatile( settings_cache::GAIN, chan, mode );
+          _settings.set_volatile( settings_cache::NAMED_GAIN, chan, mode );
           if (!automatic) // reapply gain value when switched to manual mode
             dev->set_gain( _gain[ chan ], dev_chan );
           return mode;
@@ -405,7 +343,8 @@ bool sink_impl::get_gain_mode( size_t chan )
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ )
-        return dev->get_gain_mode( dev_chan );
+        return _settings.get< bool >( settings_cache::GAIN_MODE, chan,
+                 [dev, dev_chan] { return dev->get_gain_mode( dev_chan ); } );
 
   return false;
 }
@@ -418,7 +357,9 @@ double sink_impl::set_gain( double gain, size_t chan )
       if ( chan == channel++ ) {
         if ( _gain[ chan ] != gain ) {
           _gain[ chan ] = gain;
-          return dev->set_gain( gain, dev_chan );
+          _settings.invalidate( settings_cache::NAMED_GAIN, chan );
+          return _settings.put( settings_cache::GAIN, chan,
+                                dev->set_gain( gain, dev_chan ) );
         } else { return _gain[ chan ]; }
       }
 
@@ -430,8 +371,13 @@ double sink_impl::set_gain( double gain, const std::string & name, size_t chan)
   size_t channel = 0;
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->set_gain( gain, name, dev_chan );
+      if ( chan == channel++ ) {
+        /* the other stages and the total may follow */
+        _settings.invalidate( settings_cache::GAIN, chan );
+        _settings.invalidate( settings_cache::NAMED_GAIN, chan );
+        return _settings.put( settings_cache::NAMED_GAIN, chan,
+                              dev->set_gain( gain, name, dev_chan ), name );
+      }
 
   return 0;
 }
@@ -442,7 +388,8 @@ double sink_impl::get_gain( size_t chan )
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ )
-        return dev->get_gain( dev_chan );
+        return _settings.get< double >( settings_cache::GAIN, chan,
+                 [dev, dev_chan] { return dev->get_gain( dev_chan ); } );
 
   return 0;
 }
@@ -453,7 +400,9 @@ double sink_impl::get_gain( const std::string & name, size_t chan )
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ )
-        return dev->get_gain( name, dev_chan );
+        return _settings.get< double >( settings_cache::NAMED_GAIN, chan,
+                 [dev, dev_chan, &name] { return dev->get_gain( name, dev_chan ); },
+                 name );
 
   return 0;
 }
@@ -466,6 +415,8 @@ double sink_impl::set_if_gain( double gain, size_t chan )
       if ( chan == channel++ ) {
         if ( _if_gain[ chan ] != gain ) {
           _if_gain[ chan ] = gain;
+          _settings.invalidate( settings_cache::GAIN, chan );
+          _settings.invalidate( settings_cache::NAMED_GAIN, chan );
           return dev->set_if_gain( gain, dev_chan );
         } else { return _if_gain[ chan ]; }
       }
@@ -481,6 +432,8 @@ double sink_impl::set_bb_gain( double gain, size_t chan )
       if ( chan == channel++ ) {
         if ( _bb_gain[ chan ] != gain ) {
           _bb_gain[ chan ] = gain;
+          _settings.invalidate( settings_cache::GAIN, chan );
+          _settings.invalidate( settings_cache::NAMED_GAIN, chan );
           return dev->set_bb_gain( gain, dev_chan );
         } else { return _bb_gain[ chan ]; }
       }
@@ -507,7 +460,8 @@ std::string sink_impl::set_antenna( const std::string & antenna, size_t chan )
       if ( chan == channel++ ) {
         if ( _antenna[ chan ] != antenna ) {
           _antenna[ chan ] = antenna;
-          return dev->set_antenna( antenna, dev_chan );
+          return _settings.put( settings_cache::ANTENNA, chan,
+                                dev->set_antenna( antenna, dev_chan ) );
         } else { return _antenna[ chan ]; }
       }
 
@@ -520,7 +474,8 @@ std::string sink_impl::get_antenna( size_t chan )
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ )
-        return dev->get_antenna( dev_chan );
+        return _settings.get< std::string >( settings_cache::ANTENNA, chan,
+                 [dev, dev_chan] { return dev->get_antenna( dev_chan ); } );
 
   return "";
 }
@@ -551,7 +506,8 @@ double sink_impl::set_bandwidth( double bandwidth, size_t chan )
       if ( chan == channel++ ) {
         if ( _bandwidth[ chan ] != bandwidth || 0.0f == bandwidth ) {
           _bandwidth[ chan ] = bandwidth;
-          return dev->set_bandwidth( bandwidth, dev_chan );
+          return _settings.put( settings_cache::BANDWIDTH, chan,
+                                dev->set_bandwidth( bandwidth, dev_chan ) );
         } else { return _bandwidth[ chan ]; }
       }
 
@@ -564,7 +520,8 @@ double sink_impl::get_bandwidth( size_t chan )
   for (sink_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ )
-        return dev->get_bandwidth( dev_chan );
+        return _settings.get< double >( settings_cache::BANDWIDTH, chan,
+                 [dev, dev_chan] { return dev->get_bandwidth( dev_chan ); } );
 
   return 0;
 }
@@ -678,3 +635,48 @@ void sink_impl::set_time_unknown_pps(const osmosdr::time_spec_t &time_spec)
     dev->set_time_unknown_pps( time_spec );
   }
 }
+
+void sink_impl::set_command_time(const osmosdr::time_spec_t &time_spec, size_t mboard)
+{
+  /* the settings which follow are applied later */
+  _settings.suspend( true );
+
+  if (mboard != osmosdr::ALL_MBOARDS){
+      _devs.at(mboard)->set_command_time( time_spec );
+      return;
+  }
+
+  for (size_t m = 0; m < _devs.size(); m++){ /* propagate ALL_MBOARDS */
+      _devs.at(m)->set_command_time( time_spec, osmosdr::ALL_MBOARDS );
+  }
+}
+
+void sink_impl::clear_command_time(size_t mboard)
+{
+  _settings.suspend( false );
+
+  if (mboard != osmosdr::ALL_MBOARDS){
+      _devs.at(mboard)->clear_command_time();
+      return;
+  }
+
+  for (size_t m = 0; m < _devs.size(); m++){ /* propagate ALL_MBOARDS */
+      _devs.at(m)->clear_command_time( osmosdr::ALL_MBOARDS );
+  }
+}
+
+osmosdr::stream_stats_t sink_impl::get_stream_stats(size_t chan)
+{
+  size_t channel = 0;
+  for (sink_iface *dev : _devs)
+    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
+      if ( chan == channel++ )
+        return dev->get_stream_stats( dev_chan );
+
+  return osmosdr::stream_stats_t();
+}
+
+void sink_impl::clear_settings_cache()
+{
+  _settings.clear();
+}
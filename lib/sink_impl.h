@@ -23,6 +23,7 @@
 #include "osmosdr/sink.h"
 
 #include "sink_iface.h"
+#include "settings_cache.h"
 
 #include <map>
 
@@ -81,6 +82,10 @@ public:
   void set_time_now(const ::osmosdr::time_spec_t &time_spec, size_t mboard = 0);
   void set_time_next_pps(const ::osmosdr::time_spec_t &time_spec);
   void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec);
+  void set_command_time(const ::osmosdr::time_spec_t &time_spec, size_t mboard = 0);
+  void clear_command_time(size_t mboard = 0);
+  ::osmosdr::stream_stats_t get_stream_stats(size_t chan = 0);
+  void clear_settings_cache();
 
 private:
   std::vector< sink_iface * > _devs;
@@ -94,6 +99,7 @@ private:
   std::map< size_t, double > _if_gain;
   std::map< size_t, double > _bb_gain;
   std::map< size_t, std::string > _antenna;
+  settings_cache _settings;      /**< what the devices applied, for the getters */
   std::map< size_t, double > _bandwidth;
 };
 
@@ -30,6 +30,7 @@
 
 #include <iostream>
 #include <algorithm> //find
+#include <cmath>
 
 #include <boost/assign.hpp>
 #include <boost/format.hpp>
@@ -62,6 +63,8 @@ soapy_sink_c::soapy_sink_c (const std::string &args)
                     args_to_io_signature(args),
                     gr::io_signature::make (0, 0, 0))
 {
+    _stats.set_quiet(args_to_quiet(args));
+
     {
         std::lock_guard<std::mutex> l(get_soapy_maker_mutex());
         _device = SoapySDR::Device::make(params_to_dict(args));
@@ -93,14 +96,97 @@ int soapy_sink_c::work( int noutput_items,
                             gr_vector_const_void_star &input_items,
                             gr_vector_void_star &output_items )
 {
-    int flags = 0;
-    long long timeNs = 0;
-    int ret = _device->writeStream(
-        _stream, &input_items[0],
-        noutput_items, flags, timeNs);
+    static const pmt::pmt_t SOB_KEY = pmt::string_to_symbol("tx_sob");
+    static const pmt::pmt_t EOB_KEY = pmt::string_to_symbol("tx_eob");
+    static const pmt::pmt_t TIME_KEY = pmt::string_to_symbol("tx_time");
+
+    std::vector<gr::tag_t> tags;
+    get_tags_in_window(tags, 0, 0, noutput_items);
+
+    /* Without framing tags the samples are streamed continuously */
+    if (tags.empty())
+    {
+        int flags = 0;
+        long long timeNs = 0;
+        int ret = _device->writeStream(
+            _stream, &input_items[0],
+            noutput_items, flags, timeNs);
+
+        if (ret == SOAPY_SDR_UNDERFLOW) _stats.underrun();
+        if (ret < 0) return 0; //call again
+
+        _stats.delivered(ret);
+        return ret;
+    }
+
+    std::sort(tags.begin(), tags.end(), gr::tag_t::offset_compare);
 
-    if (ret < 0) return 0; //call again
-    return ret;
+    const uint64_t base = nitems_read(0);
+    std::vector<const void *> buffs(_nchan);
+    size_t pos = 0;
+
+    /* Split the input at the tags: tx_sob and tx_time start a new write,
+     * the latter timed, tx_eob ends the burst with its sample */
+    while (pos < size_t(noutput_items))
+    {
+        size_t end = noutput_items;
+        int flags = 0;
+        long long timeNs = 0;
+
+        for (const gr::tag_t &tag : tags)
+        {
+            const size_t rel = tag.offset - base;
+
+            if (pmt::eqv(tag.key, TIME_KEY) && rel == pos)
+            {
+                flags |= SOAPY_SDR_HAS_TIME;
+                timeNs = pmt::to_uint64(pmt::tuple_ref(tag.value, 0)) * 1000000000LL +
+                         llround(pmt::to_double(pmt::tuple_ref(tag.value, 1)) * 1e9);
+            }
+            else if ((pmt::eqv(tag.key, TIME_KEY) || pmt::eqv(tag.key, SOB_KEY)) &&
+                     rel > pos)
+            {
+                end = std::min(end, rel);
+            }
+            else if (pmt::eqv(tag.key, EOB_KEY) && rel >= pos)
+            {
+                end = std::min(end, rel + 1);
+            }
+        }
+
+        for (const gr::tag_t &tag : tags)
+        {
+            if (pmt::eqv(tag.key, EOB_KEY) && tag.offset - base + 1 == end)
+                flags |= SOAPY_SDR_END_BURST;
+        }
+
+        /* the driver may take fewer samples than offered, only the first
+         * write of a segment is timed */
+        while (pos < end)
+        {
+            for (size_t c = 0; c < _nchan; c++)
+                buffs[c] = static_cast<const gr_complex *>(input_items[c]) + pos;
+
+            int ret_flags = flags;
+            int ret = _device->writeStream(
+                _stream, buffs.data(),
+                end - pos, ret_flags, timeNs);
+
+            if (ret == SOAPY_SDR_UNDERFLOW) _stats.underrun();
+            if (ret <= 0)
+            {
+                _stats.delivered(pos);
+                return pos; //call again with the rest
+            }
+
+            pos += ret;
+            flags &= ~SOAPY_SDR_HAS_TIME;
+        }
+    }
+
+    _stats.delivered(noutput_items);
+
+    return noutput_items;
 }
 
 std::vector<std::string> soapy_sink_c::get_devices()
@@ -120,6 +206,11 @@ size_t soapy_sink_c::get_num_channels( void )
     return _nchan;
 }
 
+osmosdr::stream_stats_t soapy_sink_c::get_stream_stats( size_t chan )
+{
+    return _stats.get();
+}
+
 osmosdr::meta_range_t soapy_sink_c::get_sample_rates( void )
 {
     osmosdr::meta_range_t result;
@@ -366,12 +457,12 @@ void soapy_sink_c::set_clock_rate(double rate, size_t)
 
 ::osmosdr::time_spec_t soapy_sink_c::get_time_now(size_t)
 {
-    return ::osmosdr::time_spec_t::from_ticks(_device->getHardwareTime(), 1e6);
+    return ::osmosdr::time_spec_t::from_ticks(_device->getHardwareTime(), 1e9);
 }
 
 ::osmosdr::time_spec_t soapy_sink_c::get_time_last_pps(size_t)
 {
-    return ::osmosdr::time_spec_t::from_ticks(_device->getHardwareTime("PPS"), 1e6);
+    return ::osmosdr::time_spec_t::from_ticks(_device->getHardwareTime("PPS"), 1e9);
 }
 
 void soapy_sink_c::set_time_now(const ::osmosdr::time_spec_t &time_spec,
@@ -26,6 +26,7 @@
 
 #include "osmosdr/ranges.h"
 #include "sink_iface.h"
+#include "stream_counters.h"
 
 class soapy_sink_c;
 
@@ -81,6 +82,7 @@ public:
   static std::vector< std::string > get_devices();
 
 size_t get_num_channels( void );
+osmosdr::stream_stats_t get_stream_stats( size_t chan );
 osmosdr::meta_range_t get_sample_rates( void );
 double set_sample_rate( double rate );
 double get_sample_rate( void );
@@ -133,6 +135,8 @@ private:
     SoapySDR::Device *_device;
     SoapySDR::Stream *_stream;
     size_t _nchan;
+
+    stream_counters _stats;
 };
 
 #endif /* INCLUDED_SOAPY_SINK_C_H */
@@ -30,19 +30,25 @@
 
 #include <iostream>
 #include <algorithm> //find
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 
 #include <boost/assign.hpp>
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string.hpp>
 
 #include <gnuradio/io_signature.h>
 
 #include "arg_helpers.h"
+#include "sample_convert.h"
 #include "soapy_source_c.h"
 #include "soapy_common.h"
 #include "osmosdr/source.h"
 #include <SoapySDR/Device.hpp>
 #include <SoapySDR/Version.hpp>
+#include <SoapySDR/Formats.hpp>
 
 using namespace boost::assign;
 
@@ -61,20 +67,87 @@ soapy_source_c_sptr make_soapy_source_c (const std::string &args)
 soapy_source_c::soapy_source_c (const std::string &args)
   : gr::sync_block ("soapy_source_c",
                     gr::io_signature::make (0, 0, 0),
-                    args_to_io_signature(args))
-{
+                    args_to_io_signature(args, true)),
+    _direct(false),
+    _full_scale(0.0),
+    _native_size(0),
+    _direct_handle(0),
+    _direct_items(0),
+    _direct_offset(0),
+    _pool(args),
+    _tag_time(true),
+    _sample_rate(0.0),
+    _overflow(false),
+    _next_time_ns(0),
+    _start_ns(-1),
+    _check_ns(-1)
+{
+    dict_t dict = params_to_dict(args);
+
+    _stats.set_quiet(args_to_quiet(args));
+
     {
         std::lock_guard<std::mutex> l(get_soapy_maker_mutex());
         _device = SoapySDR::Device::make(params_to_dict(args));
     }
-    _nchan = std::max(1, args_to_io_signature(args)->max_streams());
+    _nchan = std::max(1, args_to_io_signature(args, true)->max_streams());
     std::vector<size_t> channels;
     for (size_t i = 0; i < _nchan; i++) channels.push_back(i);
-    _stream = _device->setupStream(SOAPY_SDR_RX, "CF32", channels);
+
+    /* SoapySDR converts to any of these on its own, the integer formats
+     * are what most devices deliver natively */
+    std::vector<std::string> formats;
+    formats.push_back("cs16");
+    formats.push_back("cs8");
+    formats.push_back("cu8");
+
+    /* format=CS16|CS8|CU8 in SoapySDR spelling selects the same as
+     * cpu_format, args_to_io_signature() sized the output for it */
+    _cpu_format = args_to_cpu_format(args, formats);
+
+    std::string format = SOAPY_SDR_CF32;
+    if (_cpu_format == "cs16") format = SOAPY_SDR_CS16;
+    else if (_cpu_format == "cs8") format = SOAPY_SDR_CS8;
+    else if (_cpu_format == "cu8") format = SOAPY_SDR_CU8;
+
+    /* Take the samples straight from the driver's DMA buffers. These are
+     * in the native stream format, which we then convert or copy once */
+    if (dict.count("zerocopy") && dict["zerocopy"] == "1")
+    {
+        _native_format = _device->getNativeStreamFormat(SOAPY_SDR_RX, 0, _full_scale);
+
+        if (_native_format == format ||
+            (_cpu_format == "fc32" && (_native_format == SOAPY_SDR_CS16 ||
+                                       _native_format == SOAPY_SDR_CS8 ||
+                                       _native_format == SOAPY_SDR_CU8)))
+        {
+            _stream = _device->setupStream(SOAPY_SDR_RX, _native_format, channels);
+
+            if (_device->getNumDirectAccessBuffers(_stream) > 0)
+                _direct = true;
+            else
+                _device->closeStream(_stream);
+        }
+
+        if (!_direct)
+            std::cerr << "SoapySDR: no direct buffer access for native format "
+                      << _native_format << ", disabling zerocopy" << std::endl;
+    }
+
+    if (_direct)
+    {
+        _native_size = SoapySDR::formatToSize(_native_format);
+        _direct_buffs.resize(_nchan);
+    }
+    else
+    {
+        _stream = _device->setupStream(SOAPY_SDR_RX, format, channels);
+    }
 }
 
 soapy_source_c::~soapy_source_c(void)
 {
+    release_direct();
     _device->closeStream(_stream);
     std::lock_guard<std::mutex> l(get_soapy_maker_mutex());
     SoapySDR::Device::unmake(_device);
@@ -82,11 +155,37 @@ soapy_source_c::~soapy_source_c(void)
 
 bool soapy_source_c::start()
 {
-    return _device->activateStream(_stream) == 0;
+    _sample_rate = _device->getSampleRate(SOAPY_SDR_RX, 0);
+    _tag_time = true;
+    _overflow = false;
+
+    /* all channels of the stream start at the same sample, as do all
+     * devices given the same time, see sync=pps */
+    int flags = 0;
+    long long timeNs = 0;
+    _check_ns = -1;
+
+    if (_start_ns >= 0)
+    {
+        if (_device->getHardwareTime() < _start_ns)
+        {
+            flags = SOAPY_SDR_HAS_TIME;
+            timeNs = _check_ns = _start_ns;
+        }
+        else
+            std::cerr << "SoapySDR: the start time has passed, streaming right away"
+                      << std::endl;
+
+        _start_ns = -1;
+    }
+
+    return _device->activateStream(_stream, flags, timeNs) == 0;
 }
 
 bool soapy_source_c::stop()
 {
+    release_direct();
+
     return _device->deactivateStream(_stream) == 0;
 }
 
@@ -97,18 +196,171 @@ int soapy_source_c::work( int noutput_items,
     int flags = 0;
     long long timeNs = 0;
     int ret;
-    int retries = 1;
 
-    do {
-        ret = _device->readStream(
-            _stream, &output_items[0],
-            noutput_items, flags, timeNs);
-    } while (retries-- && (ret == SOAPY_SDR_OVERFLOW));
+    if (_direct)
+    {
+        ret = work_direct(noutput_items, output_items);
+        _stats.delivered(ret);
+        return ret;
+    }
+
+    ret = _device->readStream(
+        _stream, &output_items[0],
+        noutput_items, flags, timeNs);
+
+    if (ret == SOAPY_SDR_OVERFLOW) _overflow = true;
+    if (ret <= 0) return 0; //call again
+
+    tag_stream(0, ret, flags, timeNs);
+    _stats.delivered(ret);
 
-    if (ret < 0) return 0; //call again
     return ret;
 }
 
+void soapy_source_c::tag_stream( size_t offset, size_t nitems,
+                                 int flags, long long timeNs )
+{
+    static const pmt::pmt_t TIME_KEY = pmt::string_to_symbol("rx_time");
+    static const pmt::pmt_t RATE_KEY = pmt::string_to_symbol("rx_rate");
+    static const pmt::pmt_t FREQ_KEY = pmt::string_to_symbol("rx_freq");
+    static const pmt::pmt_t GAP_KEY = pmt::string_to_symbol("rx_gap");
+
+    const uint64_t item = nitems_written(0) + offset;
+    const bool has_time = flags & SOAPY_SDR_HAS_TIME;
+    const double rate = _sample_rate;
+
+    /* the gap tag carries the number of samples lost, or -1 if the stream
+     * has no timestamps to tell */
+    if (_overflow)
+    {
+        long lost = -1;
+        if (has_time && !_tag_time && rate > 0)
+            lost = std::max(0LL, llround((timeNs - _next_time_ns) * 1e-9 * rate));
+
+        for (size_t c = 0; c < _nchan; c++)
+            add_item_tag(c, item, GAP_KEY, pmt::from_long(lost));
+
+        /* the driver has printed its "O" already */
+        _stats.lost(std::max(0L, lost));
+    }
+
+    if (!has_time)
+    {
+        _overflow = false;
+        _check_ns = -1;
+        return;
+    }
+
+    /* retag whenever the timeline is not continuous with the previous read,
+     * like gr-uhd does at start and after overflows */
+    const long long tolerance = rate > 0 ? llround(0.5e9 / rate) : 0;
+
+    /* a timed start is only aligned if the first sample is the one asked for */
+    if (_check_ns >= 0)
+    {
+        if (llabs(timeNs - _check_ns) > tolerance)
+            std::cerr << "SoapySDR: streaming started "
+                      << (timeNs - _check_ns) * 1e-9 * rate
+                      << " samples off the start time" << std::endl;
+        _check_ns = -1;
+    }
+
+    if (_tag_time.exchange(false) || _overflow ||
+        llabs(timeNs - _next_time_ns) > tolerance)
+    {
+        const pmt::pmt_t time = pmt::make_tuple(
+            pmt::from_uint64(timeNs / 1000000000LL),
+            pmt::from_double((timeNs % 1000000000LL) * 1e-9));
+
+        for (size_t c = 0; c < _nchan; c++)
+        {
+            add_item_tag(c, item, TIME_KEY, time);
+            add_item_tag(c, item, RATE_KEY, pmt::from_double(rate));
+            add_item_tag(c, item, FREQ_KEY,
+                         pmt::from_double(_device->getFrequency(SOAPY_SDR_RX, c)));
+        }
+    }
+
+    _overflow = false;
+    _next_time_ns = timeNs + (rate > 0 ? llround(nitems * 1e9 / rate) : 0);
+}
+
+int soapy_source_c::work_direct( int noutput_items,
+                                 gr_vector_void_star &output_items )
+{
+    size_t produced = 0;
+
+    while (produced < size_t(noutput_items))
+    {
+        if (!_direct_items)
+        {
+            int flags = 0;
+            long long timeNs = 0;
+
+            /* only block if there is nothing to return yet */
+            int ret = _device->acquireReadBuffer(
+                _stream, _direct_handle, _direct_buffs.data(),
+                flags, timeNs, produced ? 0 : 100000);
+
+            if (ret == SOAPY_SDR_OVERFLOW) _overflow = true;
+            if (ret <= 0) break;
+
+            _direct_items = ret;
+            _direct_offset = 0;
+
+            tag_stream(produced, _direct_items, flags, timeNs);
+        }
+
+        size_t n = std::min(noutput_items - produced,
+                            _direct_items - _direct_offset);
+
+        for (size_t c = 0; c < _nchan; c++)
+        {
+            const char *in = static_cast<const char *>(_direct_buffs[c]) +
+                             _direct_offset * _native_size;
+
+            if (_cpu_format != "fc32" || _native_format == SOAPY_SDR_CF32)
+            {
+                memcpy(static_cast<char *>(output_items[c]) + produced * _native_size,
+                       in, n * _native_size);
+                continue;
+            }
+
+            gr_complex *out = static_cast<gr_complex *>(output_items[c]) + produced;
+
+            /* sliced across the convert_threads */
+            _pool.run(n, [&](size_t begin, size_t end)
+            {
+                gr_complex *o = out + begin;
+
+                if (_native_format == SOAPY_SDR_CS16)
+                    convert_cs16_fc32_deinterleave(reinterpret_cast<const int16_t *>(in) + begin * 2,
+                                                   &o, 1, end - begin, _full_scale);
+                else if (_native_format == SOAPY_SDR_CS8)
+                    convert_cs8_fc32(reinterpret_cast<const int8_t *>(in) + begin * 2, o, end - begin);
+                else
+                    convert_cu8_fc32(reinterpret_cast<const uint8_t *>(in) + begin * 2, o, end - begin);
+            });
+        }
+
+        _direct_offset += n;
+        produced += n;
+
+        if (_direct_offset == _direct_items)
+            release_direct();
+    }
+
+    return produced;
+}
+
+void soapy_source_c::release_direct( void )
+{
+    if (!_direct_items) return;
+
+    _device->releaseReadBuffer(_stream, _direct_handle);
+    _direct_items = 0;
+}
+
 std::vector<std::string> soapy_source_c::get_devices()
 {
     std::vector<std::string> result;
@@ -121,11 +373,21 @@ std::vector<std::string> soapy_source_c::get_devices()
     return result;
 }
 
+std::string soapy_source_c::get_cpu_format( void )
+{
+    return _cpu_format;
+}
+
 size_t soapy_source_c::get_num_channels( void )
 {
     return _nchan;
 }
 
+osmosdr::stream_stats_t soapy_source_c::get_stream_stats( size_t chan )
+{
+    return _stats.get();
+}
+
 osmosdr::meta_range_t soapy_source_c::get_sample_rates( void )
 {
     osmosdr::meta_range_t result;
@@ -146,7 +408,9 @@ osmosdr::meta_range_t soapy_source_c::get_sample_rates( void )
 double soapy_source_c::set_sample_rate( double rate )
 {
     _device->setSampleRate(SOAPY_SDR_RX, 0, rate);
-    return this->get_sample_rate();
+    _sample_rate = this->get_sample_rate();
+    _tag_time = true;
+    return _sample_rate;
 }
 
 double soapy_source_c::get_sample_rate( void )
@@ -167,6 +431,7 @@ osmosdr::freq_range_t soapy_source_c::get_freq_range( size_t chan )
 double soapy_source_c::set_center_freq( double freq, size_t chan )
 {
     _device->setFrequency(SOAPY_SDR_RX, chan, freq);
+    _tag_time = true;
     return this->get_center_freq(chan);
 }
 
@@ -395,12 +660,12 @@ void soapy_source_c::set_clock_rate(double rate, size_t)
 
 ::osmosdr::time_spec_t soapy_source_c::get_time_now(size_t)
 {
-    return ::osmosdr::time_spec_t::from_ticks(_device->getHardwareTime(), 1e6);
+    return ::osmosdr::time_spec_t::from_ticks(_device->getHardwareTime(), 1e9);
 }
 
 ::osmosdr::time_spec_t soapy_source_c::get_time_last_pps(size_t)
 {
-    return ::osmosdr::time_spec_t::from_ticks(_device->getHardwareTime("PPS"), 1e6);
+    return ::osmosdr::time_spec_t::from_ticks(_device->getHardwareTime("PPS"), 1e9);
 }
 
 void soapy_source_c::set_time_now(const ::osmosdr::time_spec_t &time_spec,
@@ -418,3 +683,9 @@ void soapy_source_c::set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spe
 {
     _device->setHardwareTime(time_spec.to_ticks(1e9), "UNKNOWN_PPS");
 }
+
+bool soapy_source_c::set_start_time(const ::osmosdr::time_spec_t &time_spec)
+{
+    _start_ns = time_spec.to_ticks(1e9);
+    return true;
+}
@@ -24,8 +24,12 @@
 #include <gnuradio/block.h>
 #include <gnuradio/sync_block.h>
 
+#include <atomic>
+
 #include "osmosdr/ranges.h"
+#include "convert_pool.h"
 #include "source_iface.h"
+#include "stream_counters.h"
 
 class soapy_source_c;
 
@@ -81,6 +85,8 @@ public:
   static std::vector< std::string > get_devices();
 
 size_t get_num_channels( void );
+std::string get_cpu_format( void );
+osmosdr::stream_stats_t get_stream_stats( size_t chan );
 osmosdr::meta_range_t get_sample_rates( void );
 double set_sample_rate( double rate );
 double get_sample_rate( void );
@@ -130,11 +136,42 @@ void set_time_now(const ::osmosdr::time_spec_t &time_spec,
                             size_t mboard);
 void set_time_next_pps(const ::osmosdr::time_spec_t &time_spec);
 void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec);
+bool set_start_time(const ::osmosdr::time_spec_t &time_spec);
 
 private:
+    int work_direct( int noutput_items, gr_vector_void_star &output_items );
+    void release_direct( void );
+
+    /* Attach timing and gap tags to nitems read at output offset */
+    void tag_stream( size_t offset, size_t nitems, int flags, long long timeNs );
+
     SoapySDR::Device *_device;
     SoapySDR::Stream *_stream;
     size_t _nchan;
+    std::string _cpu_format;
+
+    /* direct access to the driver's buffers, see zerocopy=1 */
+    bool _direct;
+    std::string _native_format;         /**< format of the driver buffers */
+    double _full_scale;                 /**< full scale of integer formats */
+    size_t _native_size;                /**< bytes per native sample */
+    size_t _direct_handle;              /**< buffer acquired from the driver */
+    std::vector<const void *> _direct_buffs; /**< its per channel addresses */
+    size_t _direct_items;               /**< items in the acquired buffer */
+    size_t _direct_offset;              /**< items already delivered */
+    convert_pool _pool;                 /**< see convert_threads= */
+
+    /* stream tagging, see tag_stream() */
+    std::atomic<bool> _tag_time;        /**< next timestamp starts a tag */
+    std::atomic<double> _sample_rate;   /**< rate the timestamps advance at */
+    bool _overflow;                     /**< samples were lost before the next read */
+    long long _next_time_ns;            /**< expected time of the next read */
+
+    /* timed activation, see set_start_time() */
+    long long _start_ns;                /**< for the next start(), -1 for right away */
+    long long _check_ns;                /**< the first timestamp expected, or -1 */
+
+    stream_counters _stats;
 };
 
 #endif /* INCLUDED_SOAPY_SOURCE_C_H */
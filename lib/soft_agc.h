@@ -0,0 +1,93 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_SOFT_AGC_H
+#define INCLUDED_OSMOSDR_SOFT_AGC_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+/* per sample weights of the level estimate, rising and falling power */
+#define SOFT_AGC_ATTACK 1e-3f
+#define SOFT_AGC_DECAY 1e-5f
+
+/* the range of the digital gain, -20 to +80 dB */
+#define SOFT_AGC_MIN_GAIN 0.1f
+#define SOFT_AGC_MAX_GAIN 1e4f
+
+/*!
+ * The gain of the software AGC of the soft_agc=<dBFS> device argument,
+ * driven by the power the *_agc conversion kernels measure while they
+ * convert, so levelling costs no pass over the samples of its own.
+ *
+ * The gain found for one call is applied to the next, moving towards the
+ * reference level with a time constant of about 1 / SOFT_AGC_ATTACK
+ * samples when the level rises and 1 / SOFT_AGC_DECAY when it falls.
+ * Belongs to the thread calling work(), set_reference() aside.
+ */
+class soft_agc
+{
+public:
+  soft_agc() :
+    _enabled( false ),
+    _ref( 0.01f ),
+    _gain( 1.0f )
+  {
+  }
+
+  /*! level the mean power of the samples at dbfs, 0 is full scale */
+  void set_reference( double dbfs )
+  {
+    _ref = float( std::pow( 10.0, dbfs / 10.0 ) );
+    _enabled = true;
+  }
+
+  bool enabled() const { return _enabled; }
+
+  /*! the gain to apply to the next samples */
+  float gain() const { return _gain; }
+
+  /*! power is the sum of |x|^2 of nitems samples converted with gain() */
+  void update( float power, size_t nitems )
+  {
+    /* nothing to level on silence, e.g. while the tuner settles */
+    if ( ! nitems || power <= 0.0f )
+      return;
+
+    const double mean = double(power) / nitems;
+    const double alpha = mean > _ref ? SOFT_AGC_ATTACK : SOFT_AGC_DECAY;
+
+    /* the weight of nitems steps of the one pole filter, 1 - (1 - alpha)^n */
+    const double weight = -std::expm1( double(nitems) * std::log1p( -alpha ) );
+
+    /* in the log domain, half for the amplitude */
+    const float gain = float( _gain * std::pow( _ref / mean, 0.5 * weight ) );
+    _gain = std::min( std::max( gain, SOFT_AGC_MIN_GAIN ), SOFT_AGC_MAX_GAIN );
+  }
+
+private:
+  bool _enabled;
+  float _ref;                   /**< the mean power to level at */
+  float _gain;
+};
+
+#endif /* INCLUDED_OSMOSDR_SOFT_AGC_H */
@@ -23,6 +23,7 @@
 
 #include <osmosdr/ranges.h>
 #include <osmosdr/time_spec.h>
+#include <osmosdr/stream_stats.h>
 #include <gnuradio/basic_block.h>
 
 /*!
@@ -38,6 +39,13 @@ public:
    */
   virtual size_t get_num_channels( void ) = 0;
 
+  /*!
+   * Get the sample format delivered on the output streams, as selected by
+   * the cpu_format device argument.
+   * \return "fc32" for complex float, or "cu8", "cs8", "cs16"
+   */
+  virtual std::string get_cpu_format( void ) { return "fc32"; }
+
   /*!
    * \brief seek file to \p seek_point relative to \p whence
    *
@@ -47,6 +55,18 @@ public:
    */
   virtual bool seek( long seek_point, int whence, size_t chan = 0 ) { return false; }
 
+  /*!
+   * \brief seek file to the sample recorded at \p time
+   *
+   * Recordings with an index holding timestamps, e.g. SigMF captures with
+   * core:datetime, are sought by absolute time, others by the time since
+   * the start of the file at its sample rate.
+   *
+   * \param time	time of the sample to continue with
+   * \return true on success
+   */
+  virtual bool seek_time( const osmosdr::time_spec_t &time, size_t chan = 0 ) { return false; }
+
   /*!
    * Get the possible sample rates for the underlying radio hardware.
    * \return a range of rates in Sps
@@ -67,6 +87,13 @@ public:
    */
   virtual double get_sample_rate( void ) = 0;
 
+  /*!
+   * Get the sample rate measured against the host clock.
+   * \param chan the channel index 0 to N-1
+   * \return the measured rate in Sps, 0 if unknown
+   */
+  virtual double get_measured_sample_rate( size_t chan = 0 ) { return 0; }
+
   /*!
    * Get the tunable frequency range for the underlying radio hardware.
    * \param chan the channel index 0 to N-1
@@ -395,6 +422,67 @@ public:
    * \param time_spec the new time
    */
   virtual void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec) { }
+
+  /*!
+   * Set the time at which the following settings take effect.
+   * \param time_spec the device time
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void set_command_time(const ::osmosdr::time_spec_t &time_spec,
+                                size_t mboard = 0) { }
+
+  /*!
+   * Set the sample at which the following settings take effect.
+   * \param sample the index of the first sample with the new settings
+   * \param chan the channel index 0 to N-1
+   */
+  virtual void set_command_sample(uint64_t sample, size_t chan = 0) { }
+
+  /*!
+   * Apply the following settings immediately again.
+   * \param mboard the motherboard index 0 to M-1
+   */
+  virtual void clear_command_time(size_t mboard = 0) { }
+
+  /*!
+   * Start streaming at the given device time.
+   * \param time_spec the device time
+   * \return false if the device can't start at a given time
+   */
+  virtual bool set_start_time(const ::osmosdr::time_spec_t &time_spec)
+  {
+    return false;
+  }
+
+  /*!
+   * Sweep the channel over a list of center frequencies.
+   * \param freqs the center frequencies in Hz
+   * \param dwell seconds of samples delivered at each frequency
+   * \param settle seconds of samples dropped after each retune
+   * \param chan the channel index 0 to N-1
+   * \return false if the device doesn't support sweeping
+   */
+  virtual bool set_sweep(const std::vector<double> &freqs,
+                         double dwell, double settle, size_t chan = 0)
+  {
+    return false;
+  }
+
+  /*!
+   * Stop sweeping and stay at the current frequency.
+   * \param chan the channel index 0 to N-1
+   */
+  virtual void clear_sweep(size_t chan = 0) { }
+
+  /*!
+   * Get the streaming statistics of a channel.
+   * \param chan the channel index 0 to N-1
+   * \return the counters, all zero if the device doesn't track them
+   */
+  virtual ::osmosdr::stream_stats_t get_stream_stats(size_t chan = 0)
+  {
+    return ::osmosdr::stream_stats_t();
+  }
 };
 
 #endif // OSMOSDR_SOURCE_IFACE_H
@@ -27,78 +27,91 @@
 #include "config.h"
 #endif
 
+#include <cmath>
+
 #include <gnuradio/io_signature.h>
 #include <gnuradio/blocks/null_source.h>
 #include <gnuradio/blocks/throttle.h>
 #include <gnuradio/constants.h>
 
-#ifdef ENABLE_FCD
-#include <fcd_source_c.h>
-#endif
-
-#ifdef ENABLE_FILE
-#include <file_source_c.h>
-#endif
-
-#ifdef ENABLE_RTL
-#include <rtl_source_c.h>
-#endif
-
-#ifdef ENABLE_RTL_TCP
-#include <rtl_tcp_source_c.h>
-#endif
-
-#ifdef ENABLE_UHD
-#include <uhd_source_c.h>
-#endif
-
-#ifdef ENABLE_SDRPLAY
-#include <sdrplay_source_c.h>
-#endif
-
-#ifdef ENABLE_HACKRF
-#include <hackrf_source_c.h>
-#endif
+#include <boost/thread/thread.hpp>
 
-#ifdef ENABLE_BLADERF
-#include <bladerf_source_c.h>
-#endif
+#include "arg_helpers.h"
+#include "channel_align.h"
+#include "control_port.h"
+#include "device_enum.h"
+#include "driver_registry.h"
+#include "source_impl.h"
+#include "spectrum_probe.h"
 
-#ifdef ENABLE_RFSPACE
-#include <rfspace_source_c.h>
-#endif
+/*
+ * Create a new instance of source_impl and return
+ * a boost shared_ptr.  This is effectively the public constructor.
+ */
+osmosdr::source::sptr
+osmosdr::source::make( const std::string &args )
+{
+  return gnuradio::get_initial_sptr( new source_impl(args) );
+}
 
-#ifdef ENABLE_AIRSPY
-#include <airspy_source_c.h>
-#endif
+#ifdef HAVE_IQBALANCE
+/* samples the optimizer estimates on per iq_period, see below */
+#define DEFAULT_IQ_LEN  8192
 
-#ifdef ENABLE_AIRSPYHF
-#include <airspyhf_source_c.h>
-#endif
+/*
+ * iq_period=<ms> lets the IQ balance optimizer only see iq_len samples
+ * every that many milliseconds, instead of the whole stream, while the
+ * correction still applies to every sample.
+ */
+static double args_to_iq_period( const std::vector< std::string > &args )
+{
+  for (const std::string &arg : args) {
+    dict_t dict = params_to_dict( arg );
+    if ( dict.count( "iq_period" ) )
+      return std::max( std::stod( dict["iq_period"] ), 0.0 ) / 1000.0;
+  }
 
-#ifdef ENABLE_SOAPY
-#include <soapy_source_c.h>
-#endif
+  return 0;
+}
 
-#ifdef ENABLE_REDPITAYA
-#include <redpitaya_source_c.h>
-#endif
+static size_t args_to_iq_len( const std::vector< std::string > &args )
+{
+  for (const std::string &arg : args) {
+    dict_t dict = params_to_dict( arg );
+    if ( dict.count( "iq_len" ) )
+      return std::max< size_t >( std::stoul( dict["iq_len"] ), 1024 );
+  }
 
-#ifdef ENABLE_FREESRP
-#include <freesrp_source_c.h>
+  return DEFAULT_IQ_LEN;
+}
 #endif
 
-#include "arg_helpers.h"
-#include "source_impl.h"
+/* seconds from sync=pps until the common stream start, see start_delay */
+#define DEFAULT_START_DELAY  2.0
 
 /*
- * Create a new instance of source_impl and return
- * a boost shared_ptr.  This is effectively the public constructor.
+ * sync=pps sets the time of every device at the same PPS edge and starts
+ * them streaming at the same time, start_delay=<s> after the source was
+ * made, by when the flowgraph has to be running.
  */
-osmosdr::source::sptr
-osmosdr::source::make( const std::string &args )
+static bool args_to_sync( const std::vector< std::string > &args,
+                          double &delay )
 {
-  return gnuradio::get_initial_sptr( new source_impl(args) );
+  bool sync = false;
+  delay = DEFAULT_START_DELAY;
+
+  for (const std::string &arg : args) {
+    dict_t dict = params_to_dict( arg );
+    if ( dict.count( "sync" ) ) {
+      if ( dict["sync"] != "pps" )
+        throw std::runtime_error("sync='" + dict["sync"] + "' is not supported, only sync=pps.");
+      sync = true;
+    }
+    if ( dict.count( "start_delay" ) )
+      delay = std::max( std::stod( dict["start_delay"] ), 0.0 );
+  }
+
+  return sync;
 }
 
 /*
@@ -107,140 +120,55 @@ osmosdr::source::make( const std::string &args )
 source_impl::source_impl( const std::string &args )
   : gr::hier_block2 ("source_impl",
         gr::io_signature::make(0, 0, 0),
-        args_to_io_signature(args)),
+        args_to_io_signature(args, true)),
     _sample_rate(NAN)
 {
-  size_t channel = 0;
   bool device_specified = false;
 
   std::vector< std::string > arg_list = args_to_vector(args);
 
-  std::vector< std::string > dev_types;
-
-#ifdef ENABLE_FILE
-  dev_types.push_back("file");
-#endif
-#ifdef ENABLE_FCD
-  dev_types.push_back("fcd");
-#endif
-#ifdef ENABLE_RTL
-  dev_types.push_back("rtl");
-#endif
-#ifdef ENABLE_RTL_TCP
-  dev_types.push_back("rtl_tcp");
-#endif
-#ifdef ENABLE_UHD
-  dev_types.push_back("uhd");
-#endif
-#ifdef ENABLE_SDRPLAY
-  dev_types.push_back("sdrplay");
-#endif
-#ifdef ENABLE_HACKRF
-  dev_types.push_back("hackrf");
-#endif
-#ifdef ENABLE_BLADERF
-  dev_types.push_back("bladerf");
-#endif
-#ifdef ENABLE_RFSPACE
-  dev_types.push_back("rfspace");
-#endif
-#ifdef ENABLE_AIRSPY
-  dev_types.push_back("airspy");
-#endif
-#ifdef ENABLE_AIRSPYHF
-  dev_types.push_back("airspyhf");
-#endif
-#ifdef ENABLE_SOAPY
-  dev_types.push_back("soapy");
-#endif
-#ifdef ENABLE_REDPITAYA
-  dev_types.push_back("redpitaya");
-#endif
-#ifdef ENABLE_FREESRP
-  dev_types.push_back("freesrp");
+#ifdef HAVE_IQBALANCE
+  _iq_period = args_to_iq_period( arg_list );
+  _iq_len = args_to_iq_len( arg_list );
 #endif
+
+  /* the block and port of every channel, connected to the outputs last */
+  std::vector< std::pair< gr::basic_block_sptr, int > > outputs;
+
+  driver_registry &registry = driver_registry::get();
+
   std::cerr << "gr-osmosdr "
             << GR_OSMOSDR_VERSION << " (" << GR_OSMOSDR_LIBVER << ") "
             << "gnuradio " << gr::version() << std::endl;
   std::cerr << "built-in source types: ";
-  for (std::string dev_type : dev_types)
+  for (std::string dev_type : registry.names( false ))
     std::cerr << dev_type << " ";
   std::cerr << std::endl;
 
-#ifdef ENABLE_RFSPACE
-  dev_types.push_back("sdr-iq"); /* additional aliases for rfspace backend */
-  dev_types.push_back("sdr-ip");
-  dev_types.push_back("netsdr");
-  dev_types.push_back("cloudiq");
-#endif
-
   for (std::string arg : arg_list) {
     dict_t dict = params_to_dict(arg);
-    for (std::string dev_type : dev_types) {
-      if ( dict.count( dev_type ) ) {
+    for (dict_t::value_type &entry : dict) {
+      const driver_registry::driver_t *driver = registry.find( entry.first );
+      if ( driver && driver->make_source ) {
         device_specified = true;
         break;
       }
     }
   }
 
+  /* the first device found, with every driver enumerated concurrently */
   if ( ! device_specified ) {
-    std::vector< std::string > dev_list;
-#ifdef ENABLE_FCD
-    for (std::string dev : fcd_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_RTL
-    for (std::string dev : rtl_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_UHD
-    for (std::string dev : uhd_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_SDRPLAY
-    for (std::string dev : sdrplay_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_BLADERF
-    for (std::string dev : bladerf_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_RFSPACE
-    for (std::string dev : rfspace_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_HACKRF
-    for (std::string dev : hackrf_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_AIRSPY
-    for (std::string dev : airspy_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_AIRSPYHF
-    for (std::string dev : airspyhf_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_SOAPY
-    for (std::string dev : soapy_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_REDPITAYA
-    for (std::string dev : redpitaya_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-#ifdef ENABLE_FREESRP
-    for (std::string dev : freesrp_source_c::get_devices())
-      dev_list.push_back( dev );
-#endif
-
-//    std::cerr << std::endl;
-//    for (std::string dev : dev_list)
-//      std::cerr << "'" << dev << "'" << std::endl;
+    device_enumerator devices( args_to_enum_timeout( arg_list ) );
+    for (const driver_registry::driver_t *driver : registry.all()) {
+      if ( driver->source_devices ) {
+        driver_registry::lister_t lister = driver->source_devices;
+        devices.add( driver->name, [lister]{ return lister( false ); } );
+      }
+    }
 
-    if ( dev_list.size() )
-      arg_list.push_back( dev_list.front() );
+    std::string dev = devices.first();
+    if ( dev.length() )
+      arg_list.push_back( dev );
     else
       throw std::runtime_error("No supported devices found (check the connection and/or udev rules).");
   }
@@ -256,126 +184,68 @@ source_impl::source_impl( const std::string &args )
     source_iface *iface = NULL;
     gr::basic_block_sptr block;
 
-#ifdef ENABLE_FCD
-    if ( dict.count("fcd") ) {
-      fcd_source_c_sptr src = make_fcd_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_FILE
-    if ( dict.count("file") ) {
-      file_source_c_sptr src = make_file_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_RTL
-    if ( dict.count("rtl") ) {
-      rtl_source_c_sptr src = make_rtl_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_RTL_TCP
-    if ( dict.count("rtl_tcp") ) {
-      rtl_tcp_source_c_sptr src = make_rtl_tcp_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_UHD
-    if ( dict.count("uhd") ) {
-      uhd_source_c_sptr src = make_uhd_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_SDRPLAY
-    if ( dict.count("sdrplay") ) {
-      sdrplay_source_c_sptr src = make_sdrplay_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_HACKRF
-    if ( dict.count("hackrf") ) {
-      hackrf_source_c_sptr src = make_hackrf_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_BLADERF
-    if ( dict.count("bladerf") ) {
-      bladerf_source_c_sptr src = make_bladerf_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_RFSPACE
-    if ( dict.count("rfspace") ||
-         dict.count("sdr-iq") ||
-         dict.count("sdr-ip") ||
-         dict.count("netsdr") ||
-         dict.count("cloudiq") ) {
-      rfspace_source_c_sptr src = make_rfspace_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_AIRSPY
-    if ( dict.count("airspy") ) {
-      airspy_source_c_sptr src = make_airspy_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
-
-#ifdef ENABLE_AIRSPYHF
-    if ( dict.count("airspyhf") ) {
-      airspyhf_source_c_sptr src = make_airspyhf_source_c( arg );
-      block = src; iface = src.get();
+    for (dict_t::value_type &entry : dict) {
+      const driver_registry::driver_t *driver = registry.find( entry.first );
+      if ( driver && driver->make_source ) {
+        driver_registry::source_block_t src = driver->make_source( arg );
+        block = src.block; iface = src.iface;
+        break;
+      }
     }
-#endif
 
-#ifdef ENABLE_SOAPY
-    if ( dict.count("soapy") ) {
-      soapy_source_c_sptr src = make_soapy_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+    if ( iface != NULL && long(block.get()) != 0 ) {
+      /* devices not overriding get_cpu_format() only deliver fc32 */
+      const std::string cpu_format = dict_to_cpu_format( dict );
+      if ( ! cpu_format.empty() &&
+           cpu_format_item_size( cpu_format ) !=
+           cpu_format_item_size( iface->get_cpu_format() ) )
+        throw std::runtime_error("cpu_format '" + cpu_format +
+                                 "' is not supported by this device.");
 
-#ifdef ENABLE_REDPITAYA
-    if ( dict.count("redpitaya") ) {
-      redpitaya_source_c_sptr src = make_redpitaya_source_c( arg );
-      block = src; iface = src.get();
-    }
-#endif
+      _devs.push_back( iface );
 
-#ifdef ENABLE_FREESRP
-    if ( dict.count("freesrp") ) {
-      freesrp_source_c_sptr src = make_freesrp_source_c( arg );
-      block = src; iface = src.get();
-    }
+#ifdef HAVE_IQBALANCE
+      /* the IQ balance blocks only operate on complex float */
+      const bool native = ( iface->get_cpu_format() != "fc32" );
 #endif
 
-    if ( iface != NULL && long(block.get()) != 0 ) {
-      _devs.push_back( iface );
-
       for (size_t i = 0; i < iface->get_num_channels(); i++) {
 #ifdef HAVE_IQBALANCE
+        if ( native ) {
+          outputs.push_back( std::make_pair( block, int(i) ) );
+          _iq_opt.push_back( gr::iqbalance::optimize_c::sptr() );
+          _iq_fix.push_back( gr::iqbalance::fix_cc::sptr() );
+          _iq_keep.push_back( gr::blocks::keep_m_in_n::sptr() );
+          continue;
+        }
+
+        /* always connected, so the mode can change while running */
         gr::iqbalance::optimize_c::sptr iq_opt = gr::iqbalance::optimize_c::make( 0 );
         gr::iqbalance::fix_cc::sptr     iq_fix = gr::iqbalance::fix_cc::make();
 
         connect(block, i, iq_fix, 0);
-        connect(iq_fix, 0, self(), channel++);
+        outputs.push_back( std::make_pair( iq_fix, 0 ) );
+
+        if ( _iq_period > 0 ) {
+          /* the optimizer only sees one block of samples per period */
+          gr::blocks::keep_m_in_n::sptr iq_keep =
+            gr::blocks::keep_m_in_n::make( sizeof(gr_complex), _iq_len, _iq_len, 0 );
 
-        connect(block, i, iq_opt, 0);
+          connect(block, i, iq_keep, 0);
+          connect(iq_keep, 0, iq_opt, 0);
+
+          _iq_keep.push_back( iq_keep );
+        } else {
+          connect(block, i, iq_opt, 0);
+
+          _iq_keep.push_back( gr::blocks::keep_m_in_n::sptr() );
+        }
         msg_connect(iq_opt, "iqbal_corr", iq_fix, "iqbal_corr");
 
-        _iq_opt.push_back( iq_opt.get() );
-        _iq_fix.push_back( iq_fix.get() );
+        _iq_opt.push_back( iq_opt );
+        _iq_fix.push_back( iq_fix );
 #else
-        connect(block, i, self(), channel++);
+        outputs.push_back( std::make_pair( block, int(i) ) );
 #endif
       }
     } else if ( (iface != NULL) || (long(block.get()) != 0) )
@@ -385,6 +255,80 @@ source_impl::source_impl( const std::string &args )
 
   if (!_devs.size())
     throw std::runtime_error("No devices specified via device arguments.");
+
+  double start_delay;
+  if ( args_to_sync( arg_list, start_delay ) )
+    sync_start( start_delay );
+
+  /* sample align receivers sharing a clock */
+  const size_t max_lag = args_to_align_lag( arg_list );
+  const std::vector< double > channels = args_to_channels( arg_list );
+
+  if ( max_lag && outputs.size() > 1 ) {
+    for (source_iface *dev : _devs)
+      if ( dev->get_cpu_format() != "fc32" )
+        throw std::runtime_error("align requires fc32 samples on every channel.");
+
+    channel_align_sptr align = make_channel_align( outputs.size(), max_lag,
+                                                   args_to_align_len( arg_list ),
+                                                   args_to_align_corr( arg_list ) );
+
+    for (size_t channel = 0; channel < outputs.size(); channel++) {
+      /* room for a whole correlation window upstream */
+      gr::block_sptr upstream = boost::dynamic_pointer_cast< gr::block >( outputs[channel].first );
+      if ( upstream )
+        upstream->set_min_output_buffer( 2 * align->window() );
+
+      connect(outputs[channel].first, outputs[channel].second, align, channel);
+      connect(align, channel, self(), channel);
+    }
+  } else if ( channels.size() ) {
+    /* narrowband channels out of a single wideband one */
+    if ( outputs.size() != 1 || _devs[0]->get_cpu_format() != "fc32" )
+      throw std::runtime_error("channels requires a single channel of fc32 samples.");
+
+    _channelizer = make_channelizer( channels, args_to_chan_bins( arg_list ),
+                                     args_to_chan_bw( arg_list ),
+                                     args_to_chan_backend( arg_list ),
+                                     args_to_chan_device( arg_list ) );
+    _channelizer->set_sample_rate( _devs[0]->get_sample_rate() );
+
+    connect(outputs[0].first, outputs[0].second, _channelizer, 0);
+    for (size_t channel = 0; channel < channels.size(); channel++)
+      connect(_channelizer, channel, self(), channel);
+  } else {
+    for (size_t channel = 0; channel < outputs.size(); channel++)
+      connect(outputs[channel].first, outputs[channel].second, self(), channel);
+  }
+
+  /* low rate spectra of the device channels, next to their consumers */
+  if ( const size_t fft_size = args_to_fft_size( arg_list ) ) {
+    const double fft_rate = args_to_fft_rate( arg_list );
+    const size_t fft_avg = args_to_fft_avg( arg_list );
+
+    for (source_iface *dev : _devs)
+      if ( dev->get_cpu_format() != "fc32" )
+        throw std::runtime_error("fft_size requires fc32 samples on every channel.");
+
+    message_port_register_hier_out( pmt::string_to_symbol("spectrum") );
+
+    for (size_t channel = 0; channel < outputs.size(); channel++) {
+      spectrum_probe_sptr probe = make_spectrum_probe( channel, fft_size, fft_rate, fft_avg,
+                                                       get_sample_rate(),
+                                                       get_center_freq( channel ) );
+      connect(outputs[channel].first, outputs[channel].second, probe, 0);
+      msg_connect( probe, "spectrum", self(), "spectrum" );
+    }
+  }
+
+  /* settings posted as messages are applied on the thread of the port */
+  control_port_sptr control = control_port::make(
+    [this]( const pmt::pmt_t &cmd ) { return control_port::apply( *this, cmd ); } );
+
+  message_port_register_hier_in( pmt::string_to_symbol("command") );
+  message_port_register_hier_out( pmt::string_to_symbol("status") );
+  msg_connect( self(), "command", control, "command" );
+  msg_connect( control, "status", self(), "status" );
 }
 
 size_t source_impl::get_num_channels()
@@ -408,6 +352,17 @@ bool source_impl::seek( long seek_point, int whence, size_t chan )
   return false;
 }
 
+bool source_impl::seek_time( const osmosdr::time_spec_t &time, size_t chan )
+{
+  size_t channel = 0;
+  for (source_iface *dev : _devs)
+    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
+      if ( chan == channel++ )
+        return dev->seek_time( time, dev_chan );
+
+  return false;
+}
+
 #define NO_DEVICES_MSG  "FATAL: No device(s) available to work with."
 
 osmosdr::meta_range_t source_impl::get_sample_rates()
@@ -433,17 +388,19 @@ double source_impl::set_sample_rate(double rate)
     for (source_iface *dev : _devs)
       sample_rate = dev->set_sample_rate(rate);
 
+    /* the devices may adapt their filters to the rate */
+    _settings.invalidate( settings_cache::BANDWIDTH );
+    _settings.put( settings_cache::SAMPLE_RATE, 0, sample_rate );
+
 #ifdef HAVE_IQBALANCE
     size_t channel = 0;
     for (source_iface *dev : _devs) {
       for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++) {
-        if ( channel < _iq_opt.size() ) {
-          gr::iqbalance::optimize_c *opt = _iq_opt[channel];
+        if ( channel < _iq_opt.size() && _iq_opt[channel] ) {
+          gr::iqbalance::optimize_c *opt = _iq_opt[channel].get();
 
-          if ( opt->period() > 0 ) { /* optimize is enabled */
-            opt->set_period( dev->get_sample_rate() / 5 );
-            opt->reset();
-          }
+          if ( opt->period() > 0 ) /* optimize is enabled */
+            restart_iq_opt( dev, channel );
         }
 
         channel++;
@@ -451,18 +408,63 @@ double source_impl::set_sample_rate(double rate)
     }
 #endif
 
+    if ( _channelizer )
+      _channelizer->set_sample_rate( sample_rate );
+
     _sample_rate = sample_rate;
   }
 
   return _sample_rate;
 }
 
+#ifdef HAVE_IQBALANCE
+void source_impl::restart_iq_opt( source_iface *dev, size_t chan )
+{
+  gr::iqbalance::optimize_c *opt = _iq_opt[chan].get();
+  gr::blocks::keep_m_in_n *keep = _iq_keep[chan].get();
+
+  if ( keep ) {
+    const double rate = dev->get_sample_rate();
+    keep->set_n( std::max( size_t(rate * _iq_period), _iq_len ) );
+
+    /* once per block kept */
+    opt->set_period( _iq_len );
+  } else {
+    opt->set_period( dev->get_sample_rate() / 5 );
+  }
+
+  opt->reset();
+}
+
+/*
+ * Off passes the samples through the fix block unchanged, keeping its
+ * values for a later Manual, without touching the connections.
+ */
+void source_impl::enable_iq( size_t chan, bool enable )
+{
+  gr::iqbalance::fix_cc *fix = _iq_fix[chan].get();
+
+  if ( ! enable && ! _iq_off.count( chan ) ) {
+    _iq_off[chan] = std::pair< float, float >( fix->mag(), fix->phase() );
+    fix->set_mag( 0.0f );
+    fix->set_phase( 0.0f );
+  } else if ( enable && _iq_off.count( chan ) ) {
+    fix->set_mag( _iq_off[chan].first );
+    fix->set_phase( _iq_off[chan].second );
+    _iq_off.erase( chan );
+  }
+}
+#endif
+
 double source_impl::get_sample_rate()
 {
   double sample_rate = 0;
 
-  if (!_devs.empty())
-    sample_rate = _devs[0]->get_sample_rate(); // assume same devices used in the group
+  if (!_devs.empty()) {
+    source_iface *dev = _devs[0]; // assume same devices used in the group
+    sample_rate = _settings.get< double >( settings_cache::SAMPLE_RATE, 0,
+                    [dev] { return dev->get_sample_rate(); } );
+  }
 #if 0
   else
     throw std::runtime_error(NO_DEVICES_MSG);
@@ -470,6 +472,17 @@ double source_impl::get_sample_rate()
   return sample_rate;
 }
 
+double source_impl::get_measured_sample_rate( size_t chan )
+{
+  size_t channel = 0;
+  for (source_iface *dev : _devs)
+    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
+      if ( chan == channel++ )
+        return dev->get_measured_sample_rate( dev_chan );
+
+  return 0;
+}
+
 osmosdr::freq_range_t source_impl::get_freq_range( size_t chan )
 {
   size_t channel = 0;
@@ -489,7 +502,8 @@ double source_impl::set_center_freq( double freq, size_t chan )
       if ( chan == channel++ ) {
         if ( _center_freq[ chan ] != freq ) {
           _center_freq[ chan ] = freq;
-          return dev->set_center_freq( freq, dev_chan );
+          return _settings.put( settings_cache::CENTER_FREQ, chan,
+                                dev->set_center_freq( freq, dev_chan ) );
         } else { return _center_freq[ chan ]; }
       }
 
@@ -502,7 +516,8 @@ double source_impl::get_center_freq( size_t chan )
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ )
-        return dev->get_center_freq( dev_chan );
+        return _settings.get< double >( settings_cache::CENTER_FREQ, chan,
+                 [dev, dev_chan] { return dev->get_center_freq( dev_chan ); } );
 
   return 0;
 }
@@ -515,7 +530,10 @@ double source_impl::set_freq_corr( double ppm, size_t chan )
       if ( chan == channel++ ) {
         if ( _freq_corr[ chan ] != ppm ) {
           _freq_corr[ chan ] = ppm;
-          return dev->set_freq_corr( ppm, dev_chan );
+          /* the frequency reported may include the correction */
+          _settings.invalidate( settings_cache::CENTER_FREQ, chan );
+          return _settings.put( settings_cache::FREQ_CORR, chan,
+                                dev->set_freq_corr( ppm, dev_chan ) );
         } else { return _freq_corr[ chan ]; }
       }
 
@@ -528,7 +546,8 @@ double source_impl::get_freq_corr( size_t chan )
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ )
-        return dev->get_freq_corr( dev_chan );
+        return _settings.get< double >( settings_cache::FREQ_CORR, chan,
+                 [dev, dev_chan] { return dev->get_freq_corr( dev_chan ); } );
 
   return 0;
 }
@@ -575,6 +594,10 @@ bool source_impl::set_gain_mode( bool automatic, size_t chan )
         if ( _gain_mode[ chan ] != automatic ) {
           _gain_mode[ chan ] = automatic;
           bool mode = dev->set_gain_mode( automatic, dev_chan );
+          _settings.put( settings_cache::GAIN_MODE, chan, mode );
+          /* the AGC changes the gains on its own */
+          _settings.set_volatile( settings_cache::GAIN, chan, mode );
+          _settings.set_volatile( settings_cache::NAMED_GAIN, chan, mode );
           if (!automatic) // reapply gain value when switched to manual mode
             dev->set_gain( _gain[ chan ], dev_chan );
           return mode;
@@ -590,7 +613,8 @@ bool source_impl::get_gain_mode( size_t chan )
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ )
-        return dev->get_gain_mode( dev_chan );
+        return _settings.get< bool >( settings_cache::GAIN_MODE, chan,
+                 [dev, dev_chan] { return dev->get_gain_mode( dev_chan ); } );
 
   return false;
 }
@@ -603,7 +627,9 @@ double source_impl::set_gain( double gain, size_t chan )
       if ( chan == channel++ ) {
         if ( _gain[ chan ] != gain ) {
           _gain[ chan ] = gain;
-          return dev->set_gain( gain, dev_chan );
+          _settings.invalidate( settings_cache::NAMED_GAIN, chan );
+          return _settings.put( settings_cache::GAIN, chan,
+                                dev->set_gain( gain, dev_chan ) );
         } else { return _gain[ chan ]; }
       }
 
@@ -615,8 +641,13 @@ double source_impl::set_gain( double gain, const std::string & name, size_t chan
   size_t channel = 0;
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
-      if ( chan == channel++ )
-        return dev->set_gain( gain, name, dev_chan );
+      if ( chan == channel++ ) {
+        /* the other stages and the total may follow */
+        _settings.invalidate( settings_cache::GAIN, chan );
+        _settings.invalidate( settings_cache::NAMED_GAIN, chan );
+        return _settings.put( settings_cache::NAMED_GAIN, chan,
+                              dev->set_gain( gain, name, dev_chan ), name );
+      }
 
   return 0;
 }
@@ -627,7 +658,8 @@ double source_impl::get_gain( size_t chan )
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ )
-        return dev->get_gain( dev_chan );
+        return _settings.get< double >( settings_cache::GAIN, chan,
+                 [dev, dev_chan] { return dev->get_gain( dev_chan ); } );
 
   return 0;
 }
@@ -638,7 +670,9 @@ double source_impl::get_gain( const std::string & name, size_t chan )
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ )
-        return dev->get_gain( name, dev_chan );
+        return _settings.get< double >( settings_cache::NAMED_GAIN, chan,
+                 [dev, dev_chan, &name] { return dev->get_gain( name, dev_chan ); },
+                 name );
 
   return 0;
 }
@@ -651,6 +685,8 @@ double source_impl::set_if_gain( double gain, size_t chan )
       if ( chan == channel++ ) {
         if ( _if_gain[ chan ] != gain ) {
           _if_gain[ chan ] = gain;
+          _settings.invalidate( settings_cache::GAIN, chan );
+          _settings.invalidate( settings_cache::NAMED_GAIN, chan );
           return dev->set_if_gain( gain, dev_chan );
         } else { return _if_gain[ chan ]; }
       }
@@ -666,6 +702,8 @@ double source_impl::set_bb_gain( double gain, size_t chan )
       if ( chan == channel++ ) {
         if ( _bb_gain[ chan ] != gain ) {
           _bb_gain[ chan ] = gain;
+          _settings.invalidate( settings_cache::GAIN, chan );
+          _settings.invalidate( settings_cache::NAMED_GAIN, chan );
           return dev->set_bb_gain( gain, dev_chan );
         } else { return _bb_gain[ chan ]; }
       }
@@ -692,7 +730,8 @@ std::string source_impl::set_antenna( const std::string & antenna, size_t chan )
       if ( chan == channel++ ) {
         if ( _antenna[ chan ] != antenna ) {
           _antenna[ chan ] = antenna;
-          return dev->set_antenna( antenna, dev_chan );
+          return _settings.put( settings_cache::ANTENNA, chan,
+                                dev->set_antenna( antenna, dev_chan ) );
         } else { return _antenna[ chan ]; }
       }
 
@@ -705,7 +744,8 @@ std::string source_impl::get_antenna( size_t chan )
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ )
-        return dev->get_antenna( dev_chan );
+        return _settings.get< std::string >( settings_cache::ANTENNA, chan,
+                 [dev, dev_chan] { return dev->get_antenna( dev_chan ); } );
 
   return "";
 }
@@ -735,27 +775,21 @@ void source_impl::set_iq_balance_mode( int mode, size_t chan )
   for (source_iface *dev : _devs) {
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++) {
       if ( chan == channel++ ) {
+        if ( chan < _iq_opt.size() && ! _iq_opt[chan] ) /* native cpu_format */
+          return dev->set_iq_balance_mode( mode, dev_chan );
+
         if ( chan < _iq_opt.size() && chan < _iq_fix.size() ) {
-          gr::iqbalance::optimize_c *opt = _iq_opt[chan];
-          gr::iqbalance::fix_cc *fix = _iq_fix[chan];
+          gr::iqbalance::optimize_c *opt = _iq_opt[chan].get();
 
           if ( IQBalanceOff == mode  ) {
             opt->set_period( 0 );
-            /* store current values in order to be able to restore them later */
-            _vals[ chan ] = std::pair< float, float >( fix->mag(), fix->phase() );
-            fix->set_mag( 0.0f );
-            fix->set_phase( 0.0f );
+            enable_iq( chan, false );
           } else if ( IQBalanceManual == mode ) {
-            if ( opt->period() == 0 ) { /* transition from Off to Manual */
-              /* restore previous values */
-              std::pair< float, float > val = _vals[ chan ];
-              fix->set_mag( val.first );
-              fix->set_phase( val.second );
-            }
             opt->set_period( 0 );
+            enable_iq( chan, true );
           } else if ( IQBalanceAutomatic == mode ) {
-            opt->set_period( dev->get_sample_rate() / 5 );
-            opt->reset();
+            enable_iq( chan, true );
+            restart_iq_opt( dev, chan );
           }
         }
       }
@@ -776,11 +810,16 @@ void source_impl::set_iq_balance( const std::complex<double> &balance, size_t ch
   for (source_iface *dev : _devs) {
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++) {
       if ( chan == channel++ ) {
+        if ( chan < _iq_opt.size() && ! _iq_opt[chan] ) /* native cpu_format */
+          return dev->set_iq_balance( balance, dev_chan );
+
         if ( chan < _iq_opt.size() && chan < _iq_fix.size() ) {
-          gr::iqbalance::optimize_c *opt = _iq_opt[chan];
-          gr::iqbalance::fix_cc *fix = _iq_fix[chan];
+          gr::iqbalance::optimize_c *opt = _iq_opt[chan].get();
+          gr::iqbalance::fix_cc *fix = _iq_fix[chan].get();
 
-          if ( opt->period() == 0 ) { /* automatic optimization desabled */
+          if ( _iq_off.count( chan ) ) { /* applied when switched to Manual */
+            _iq_off[chan] = std::pair< float, float >( balance.real(), balance.imag() );
+          } else if ( opt->period() == 0 ) { /* automatic optimization desabled */
             fix->set_mag( balance.real() );
             fix->set_phase( balance.imag() );
           }
@@ -804,7 +843,8 @@ double source_impl::set_bandwidth( double bandwidth, size_t chan )
       if ( chan == channel++ ) {
         if ( _bandwidth[ chan ] != bandwidth || 0.0f == bandwidth ) {
           _bandwidth[ chan ] = bandwidth;
-          return dev->set_bandwidth( bandwidth, dev_chan );
+          return _settings.put( settings_cache::BANDWIDTH, chan,
+                                dev->set_bandwidth( bandwidth, dev_chan ) );
         } else { return _bandwidth[ chan ]; }
       }
 
@@ -817,7 +857,8 @@ double source_impl::get_bandwidth( size_t chan )
   for (source_iface *dev : _devs)
     for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
       if ( chan == channel++ )
-        return dev->get_bandwidth( dev_chan );
+        return _settings.get< double >( settings_cache::BANDWIDTH, chan,
+                 [dev, dev_chan] { return dev->get_bandwidth( dev_chan ); } );
 
   return 0;
 }
@@ -931,3 +972,140 @@ void source_impl::set_time_unknown_pps(const osmosdr::time_spec_t &time_spec)
     dev->set_time_unknown_pps( time_spec );
   }
 }
+
+void source_impl::set_command_time(const osmosdr::time_spec_t &time_spec, size_t mboard)
+{
+  /* the settings which follow are applied later */
+  _settings.suspend( true );
+
+  if (mboard != osmosdr::ALL_MBOARDS){
+      _devs.at(mboard)->set_command_time( time_spec );
+      return;
+  }
+
+  for (size_t m = 0; m < _devs.size(); m++){ /* propagate ALL_MBOARDS */
+      _devs.at(m)->set_command_time( time_spec, osmosdr::ALL_MBOARDS );
+  }
+}
+
+void source_impl::set_command_sample(uint64_t sample, size_t chan)
+{
+  _settings.suspend( true );
+
+  size_t channel = 0;
+  for (source_iface *dev : _devs)
+    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
+      if ( chan == channel++ ) {
+        dev->set_command_sample( sample, dev_chan );
+        return;
+      }
+}
+
+void source_impl::clear_command_time(size_t mboard)
+{
+  _settings.suspend( false );
+
+  if (mboard != osmosdr::ALL_MBOARDS){
+      _devs.at(mboard)->clear_command_time();
+      return;
+  }
+
+  for (size_t m = 0; m < _devs.size(); m++){ /* propagate ALL_MBOARDS */
+      _devs.at(m)->clear_command_time( osmosdr::ALL_MBOARDS );
+  }
+}
+
+bool source_impl::set_start_time(const osmosdr::time_spec_t &time_spec)
+{
+  bool timed = true;
+
+  for (source_iface *dev : _devs)
+    timed = dev->set_start_time( time_spec ) && timed;
+
+  return timed;
+}
+
+/*
+ * Sets the time of all devices at one PPS edge, which has to be shared:
+ * right after an edge there is almost a second left to reach every device
+ * before the next one. Then streaming is set to start delay seconds later.
+ */
+void source_impl::sync_start( double delay )
+{
+  const osmosdr::time_spec_t last = _devs[0]->get_time_last_pps();
+
+  /* wait for an edge to pass, for a bit more than a second */
+  for (int ms = 0; _devs[0]->get_time_last_pps() == last; ms += 10) {
+    if ( ms > 1500 )
+      throw std::runtime_error("sync=pps requires a PPS signal, none was seen.");
+    boost::this_thread::sleep_for( boost::chrono::milliseconds( 10 ) );
+  }
+
+  for (source_iface *dev : _devs)
+    dev->set_time_next_pps( osmosdr::time_spec_t( 0.0 ) );
+
+  /* past the edge the times were set at */
+  boost::this_thread::sleep_for( boost::chrono::milliseconds( 1100 ) );
+
+  osmosdr::time_spec_t start = _devs[0]->get_time_now();
+
+  /* a device which latched another edge is whole seconds off */
+  for (size_t i = 1; i < _devs.size(); i++) {
+    const double off = ( _devs[i]->get_time_now() - start ).get_real_secs();
+    if ( std::fabs( off ) > 0.5 )
+      std::cerr << "-- Device " << i << " is " << off << " s off the time of device 0, "
+                << "check that they share the PPS signal." << std::endl;
+  }
+
+  start += osmosdr::time_spec_t( delay );
+
+  if ( ! set_start_time( start ) )
+    throw std::runtime_error("sync=pps requires devices which can start at a given time, e.g. uhd or soapy.");
+
+  std::cerr << "-- Streaming starts at device time " << start.get_real_secs()
+            << " s." << std::endl;
+}
+
+bool source_impl::set_sweep(const std::vector<double> &freqs,
+                            double dwell, double settle, size_t chan)
+{
+  size_t channel = 0;
+  for (source_iface *dev : _devs)
+    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
+      if ( chan == channel++ ) {
+        const bool sweeping = dev->set_sweep( freqs, dwell, settle, dev_chan );
+        _settings.set_volatile( settings_cache::CENTER_FREQ, chan, sweeping );
+        return sweeping;
+      }
+
+  return false;
+}
+
+void source_impl::clear_sweep(size_t chan)
+{
+  size_t channel = 0;
+  for (source_iface *dev : _devs)
+    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
+      if ( chan == channel++ ) {
+        dev->clear_sweep( dev_chan );
+        _settings.set_volatile( settings_cache::CENTER_FREQ, chan, false );
+        _settings.invalidate( settings_cache::CENTER_FREQ, chan );
+        return;
+      }
+}
+
+osmosdr::stream_stats_t source_impl::get_stream_stats(size_t chan)
+{
+  size_t channel = 0;
+  for (source_iface *dev : _devs)
+    for (size_t dev_chan = 0; dev_chan < dev->get_num_channels(); dev_chan++)
+      if ( chan == channel++ )
+        return dev->get_stream_stats( dev_chan );
+
+  return osmosdr::stream_stats_t();
+}
+
+void source_impl::clear_settings_cache()
+{
+  _settings.clear();
+}
@@ -25,9 +25,12 @@
 #ifdef HAVE_IQBALANCE
 #include <gnuradio/iqbalance/optimize_c.h>
 #include <gnuradio/iqbalance/fix_cc.h>
+#include <gnuradio/blocks/keep_m_in_n.h>
 #endif
 
 #include <source_iface.h>
+#include "channelizer.h"
+#include "settings_cache.h"
 
 #include <map>
 
@@ -39,10 +42,12 @@ public:
   size_t get_num_channels( void );
 
   bool seek( long seek_point, int whence, size_t chan );
+  bool seek_time( const osmosdr::time_spec_t &time, size_t chan );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
   double get_sample_rate( void );
+  double get_measured_sample_rate( size_t chan = 0 );
 
   osmosdr::freq_range_t get_freq_range( size_t chan = 0 );
   double set_center_freq( double freq, size_t chan = 0 );
@@ -90,8 +95,24 @@ public:
   void set_time_now(const ::osmosdr::time_spec_t &time_spec, size_t mboard = 0);
   void set_time_next_pps(const ::osmosdr::time_spec_t &time_spec);
   void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec);
+  void set_command_time(const ::osmosdr::time_spec_t &time_spec, size_t mboard = 0);
+  void set_command_sample(uint64_t sample, size_t chan = 0);
+  void clear_command_time(size_t mboard = 0);
+  bool set_start_time(const ::osmosdr::time_spec_t &time_spec);
+
+  bool set_sweep(const std::vector<double> &freqs,
+                 double dwell, double settle, size_t chan = 0);
+  void clear_sweep(size_t chan = 0);
+  ::osmosdr::stream_stats_t get_stream_stats(size_t chan = 0);
+  void clear_settings_cache();
 
 private:
+#ifdef HAVE_IQBALANCE
+  void restart_iq_opt( source_iface *dev, size_t chan );
+  void enable_iq( size_t chan, bool enable );
+#endif
+  void sync_start( double delay );
+
   std::vector< source_iface * > _devs;
 
   /* cache to prevent multiple device calls with the same value coming from grc */
@@ -104,11 +125,17 @@ private:
   std::map< size_t, double > _bb_gain;
   std::map< size_t, std::string > _antenna;
 #ifdef HAVE_IQBALANCE
-  std::vector< gr::iqbalance::fix_cc * > _iq_fix;
-  std::vector< gr::iqbalance::optimize_c * > _iq_opt;
-  std::map< size_t, std::pair<float, float> > _vals;
+  /* per channel, NULL for channels of a native cpu_format */
+  std::vector< gr::iqbalance::fix_cc::sptr > _iq_fix;
+  std::vector< gr::iqbalance::optimize_c::sptr > _iq_opt;
+  std::vector< gr::blocks::keep_m_in_n::sptr > _iq_keep; /**< NULL at full rate */
+  std::map< size_t, std::pair< float, float > > _iq_off; /**< mag/phase while Off */
+  double _iq_period;            /**< seconds between estimates, 0 for every sample */
+  size_t _iq_len;               /**< samples per estimate */
 #endif
   std::map< size_t, double > _bandwidth;
+  channelizer_sptr _channelizer; /**< unset without channels= */
+  settings_cache _settings;      /**< what the devices applied, for the getters */
 };
 
 #endif /* INCLUDED_OSMOSDR_SOURCE_IMPL_H */
@@ -0,0 +1,208 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/fft/window.h>
+#include <volk/volk.h>
+
+#include "arg_helpers.h"
+#include "spectrum_probe.h"
+
+#define DEFAULT_FFT_RATE  15.0
+#define DEFAULT_FFT_AVG   4
+
+spectrum_probe_sptr make_spectrum_probe( size_t chan, size_t size, double rate,
+                                         size_t avg, double sample_rate, double freq )
+{
+  return gnuradio::get_initial_sptr( new spectrum_probe( chan, size, rate, avg,
+                                                         sample_rate, freq ) );
+}
+
+static std::string find_arg( const std::vector< std::string > &args,
+                             const std::string &key )
+{
+  for (const std::string &arg : args) {
+    dict_t dict = params_to_dict( arg );
+    if ( dict.count( key ) )
+      return dict[ key ];
+  }
+
+  return "";
+}
+
+size_t args_to_fft_size( const std::vector< std::string > &args )
+{
+  const std::string value = find_arg( args, "fft_size" );
+  return value.empty() ? 0 : std::max< size_t >( std::stoul( value ), 16 );
+}
+
+double args_to_fft_rate( const std::vector< std::string > &args )
+{
+  const std::string value = find_arg( args, "fft_rate" );
+  const double rate = value.empty() ? DEFAULT_FFT_RATE : std::stod( value );
+  if ( rate <= 0 )
+    throw std::runtime_error( "fft_rate must be positive." );
+  return rate;
+}
+
+size_t args_to_fft_avg( const std::vector< std::string > &args )
+{
+  const std::string value = find_arg( args, "fft_avg" );
+  return value.empty() ? DEFAULT_FFT_AVG : std::max< size_t >( std::stoul( value ), 1 );
+}
+
+spectrum_probe::spectrum_probe( size_t chan, size_t size, double rate,
+                                size_t avg, double sample_rate, double freq ) :
+  gr::sync_block( "spectrum_probe",
+                  gr::io_signature::make( 1, 1, sizeof(gr_complex) ),
+                  gr::io_signature::make( 0, 0, 0 ) ),
+  _chan( chan ),
+  _size( size ),
+  _rate( rate ),
+  _avg( avg ),
+  _sample_rate( sample_rate ),
+  _freq( freq ),
+  _fft( new gr::fft::fft_complex( int(size), true, 1 ) ),
+  _window( gr::fft::window::blackmanharris( int(size) ) ),
+  _mag( size ),
+  _acc( size, 0.0f )
+{
+  double sum = 0;
+  for (float w : _window)
+    sum += w;
+  _scale = float( 1.0 / ( sum * sum ) );
+
+  message_port_register_out( pmt::string_to_symbol( "spectrum" ) );
+}
+
+bool spectrum_probe::start()
+{
+  _skip = 0;
+  _filled = 0;
+  _frames = 0;
+  std::fill( _acc.begin(), _acc.end(), 0.0f );
+
+  return true;
+}
+
+void spectrum_probe::read_tags( uint64_t first, uint64_t end )
+{
+  static const pmt::pmt_t RATE_KEY = pmt::string_to_symbol( "rx_rate" );
+  static const pmt::pmt_t FREQ_KEY = pmt::string_to_symbol( "rx_freq" );
+
+  std::vector< gr::tag_t > tags;
+  get_tags_in_range( tags, 0, first, end );
+
+  for (const gr::tag_t &tag : tags) {
+    if ( pmt::eq( tag.key, RATE_KEY ) && pmt::is_number( tag.value ) )
+      _sample_rate = pmt::to_double( tag.value );
+    else if ( pmt::eq( tag.key, FREQ_KEY ) && pmt::is_number( tag.value ) )
+      _freq = pmt::to_double( tag.value );
+  }
+}
+
+void spectrum_probe::transform()
+{
+  _fft->execute();
+  volk_32fc_magnitude_squared_32f( _mag.data(), _fft->get_outbuf(), _size );
+  volk_32f_x2_add_32f( _acc.data(), _acc.data(), _mag.data(), _size );
+
+  if ( ++_frames < _avg )
+    return;
+
+  post();
+
+  /* the samples up to the next spectrum go by unread */
+  const double interval = _sample_rate / _rate;
+  const double taken = double(_avg) * _size;
+  _skip = interval > taken ? uint64_t( interval - taken ) : 0;
+  _frames = 0;
+  std::fill( _acc.begin(), _acc.end(), 0.0f );
+}
+
+void spectrum_probe::post()
+{
+  /* from the lowest frequency up, DC in the middle */
+  std::vector< float > power( _size );
+  const float scale = _scale / _avg;
+  const size_t half = _size / 2;
+
+  for (size_t i = 0; i < _size; i++) {
+    const float value = _acc[ ( i + _size - half ) % _size ] * scale;
+    power[i] = value > 0.0f ? 10.0f * std::log10( value ) : -HUGE_VALF;
+  }
+
+  pmt::pmt_t msg = pmt::make_dict();
+  msg = pmt::dict_add( msg, pmt::intern( "chan" ), pmt::from_uint64( _chan ) );
+  msg = pmt::dict_add( msg, pmt::intern( "freq" ), pmt::from_double( _freq ) );
+  msg = pmt::dict_add( msg, pmt::intern( "rate" ), pmt::from_double( _sample_rate ) );
+  msg = pmt::dict_add( msg, pmt::intern( "item" ), pmt::from_uint64( _first ) );
+  msg = pmt::dict_add( msg, pmt::intern( "power" ),
+                       pmt::init_f32vector( _size, power.data() ) );
+
+  message_port_pub( pmt::string_to_symbol( "spectrum" ), msg );
+}
+
+int spectrum_probe::work( int noutput_items,
+                          gr_vector_const_void_star &input_items,
+                          gr_vector_void_star &output_items )
+{
+  const gr_complex *in = (const gr_complex *)input_items[0];
+  const uint64_t first = nitems_read( 0 );
+  size_t done = 0;
+
+  read_tags( first, first + noutput_items );
+
+  while ( done < size_t(noutput_items) ) {
+    if ( _skip ) {
+      const uint64_t len = std::min< uint64_t >( _skip, noutput_items - done );
+      _skip -= len;
+      done += len;
+      continue;
+    }
+
+    if ( ! _filled && ! _frames )
+      _first = first + done;
+
+    const size_t len = std::min( _size - _filled, noutput_items - done );
+    volk_32fc_32f_multiply_32fc( _fft->get_inbuf() + _filled, in + done,
+                                 _window.data() + _filled, len );
+    _filled += len;
+    done += len;
+
+    if ( _filled == _size ) {
+      _filled = 0;
+      transform();
+    }
+  }
+
+  return noutput_items;
+}
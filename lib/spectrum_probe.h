@@ -0,0 +1,98 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_SPECTRUM_PROBE_H
+#define INCLUDED_OSMOSDR_SPECTRUM_PROBE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+#include <gnuradio/fft/fft.h>
+
+class spectrum_probe;
+
+typedef boost::shared_ptr< spectrum_probe > spectrum_probe_sptr;
+
+/*!
+ * The low rate power spectra of the "spectrum" message port of
+ * osmosdr::source, for waterfalls and level displays.
+ *
+ * Taps a channel next to its consumers and computes avg Blackman-Harris
+ * windowed FFTs of size consecutive samples, rate times a second. The
+ * samples in between are consumed unread, so the cost is that of the FFTs
+ * plus passing the buffers on. Each average is posted as a dict of chan,
+ * freq and rate (from the rx_freq/rx_rate tags, if the device tags them),
+ * item, the index of its first sample, and power, an f32vector of the
+ * bins in dBFS from the lowest frequency up. A full scale tone reads
+ * 0 dBFS. fc32 only.
+ */
+spectrum_probe_sptr make_spectrum_probe( size_t chan, size_t size, double rate,
+                                         size_t avg, double sample_rate, double freq );
+
+/*! the fft_size=, fft_rate= and fft_avg= args of any device, 0 size for none */
+size_t args_to_fft_size( const std::vector< std::string > &args );
+double args_to_fft_rate( const std::vector< std::string > &args );
+size_t args_to_fft_avg( const std::vector< std::string > &args );
+
+class spectrum_probe : public gr::sync_block
+{
+private:
+  friend spectrum_probe_sptr make_spectrum_probe( size_t chan, size_t size, double rate,
+                                                  size_t avg, double sample_rate,
+                                                  double freq );
+
+  spectrum_probe( size_t chan, size_t size, double rate,
+                  size_t avg, double sample_rate, double freq );
+
+public:
+  bool start();
+
+  int work( int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items );
+
+private:
+  void read_tags( uint64_t first, uint64_t end );
+  void transform();
+  void post();
+
+  size_t _chan;
+  size_t _size;
+  double _rate;                 /**< spectra per second */
+  size_t _avg;
+  double _sample_rate;
+  double _freq;
+
+  std::unique_ptr< gr::fft::fft_complex > _fft;
+  std::vector< float > _window;
+  float _scale;                 /**< 1 / (sum of the window)^2 */
+  std::vector< float > _mag;
+  std::vector< float > _acc;    /**< summed |X|^2 of the frames so far */
+
+  uint64_t _skip;               /**< items left to consume unread */
+  size_t _filled;               /**< samples of the current frame */
+  size_t _frames;               /**< frames accumulated */
+  uint64_t _first;              /**< stream index of the first sample */
+};
+
+#endif /* INCLUDED_OSMOSDR_SPECTRUM_PROBE_H */
@@ -0,0 +1,112 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_STREAM_COUNTERS_H
+#define INCLUDED_OSMOSDR_STREAM_COUNTERS_H
+
+#include <atomic>
+#include <iostream>
+
+#include <osmosdr/stream_stats.h>
+
+/*!
+ * Lock-free bookkeeping behind get_stream_stats().
+ *
+ * The event methods may be called from any thread, including the callback
+ * threads of the device libraries. Unless quiet, overflow() and underrun()
+ * keep printing the traditional "O" and "U" to stderr.
+ */
+class stream_counters
+{
+public:
+  stream_counters() :
+    _quiet( false ),
+    _delivered( 0 ),
+    _overflows( 0 ),
+    _dropped( 0 ),
+    _underruns( 0 ),
+    _high_water( 0 )
+  {
+  }
+
+  /*! suppress the "O"/"U" prints, see the quiet device argument */
+  void set_quiet( bool quiet ) { _quiet = quiet; }
+  bool quiet() const { return _quiet; }
+
+  void delivered( uint64_t nitems )
+  {
+    _delivered.fetch_add( nitems, std::memory_order_relaxed );
+  }
+
+  /*! count an overflow which lost nitems samples, if known */
+  void overflow( uint64_t nitems = 0 )
+  {
+    _overflows.fetch_add( 1, std::memory_order_relaxed );
+    _dropped.fetch_add( nitems, std::memory_order_relaxed );
+    if ( ! _quiet )
+      std::cerr << "O" << std::flush;
+  }
+
+  /*! count an overflow reported elsewhere without printing, e.g. by the
+   * device library itself or as packet loss on the network */
+  void lost( uint64_t nitems )
+  {
+    _overflows.fetch_add( 1, std::memory_order_relaxed );
+    _dropped.fetch_add( nitems, std::memory_order_relaxed );
+  }
+
+  void underrun()
+  {
+    _underruns.fetch_add( 1, std::memory_order_relaxed );
+    if ( ! _quiet )
+      std::cerr << "U" << std::flush;
+  }
+
+  /*! record the current number of buffered samples */
+  void fill_level( uint64_t nitems )
+  {
+    if ( nitems > _high_water.load( std::memory_order_relaxed ) )
+      _high_water.store( nitems, std::memory_order_relaxed );
+  }
+
+  osmosdr::stream_stats_t get() const
+  {
+    osmosdr::stream_stats_t stats;
+
+    stats.delivered = _delivered.load( std::memory_order_relaxed );
+    stats.overflows = _overflows.load( std::memory_order_relaxed );
+    stats.dropped = _dropped.load( std::memory_order_relaxed );
+    stats.underruns = _underruns.load( std::memory_order_relaxed );
+    stats.high_water = _high_water.load( std::memory_order_relaxed );
+
+    return stats;
+  }
+
+private:
+  std::atomic<bool> _quiet;
+  std::atomic<uint64_t> _delivered;
+  std::atomic<uint64_t> _overflows;
+  std::atomic<uint64_t> _dropped;
+  std::atomic<uint64_t> _underruns;
+  std::atomic<uint64_t> _high_water;
+};
+
+#endif /* INCLUDED_OSMOSDR_STREAM_COUNTERS_H */
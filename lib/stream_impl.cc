@@ -0,0 +1,369 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/pointer_cast.hpp>
+
+#include "arg_helpers.h"
+#include "device_enum.h"
+#include "driver_registry.h"
+#include "stream_impl.h"
+
+/* items per call of the driver, bounded like the scheduler bounds them */
+#define STREAM_CHUNK 16384
+
+osmosdr::stream::sptr
+osmosdr::stream::open( const std::string &args )
+{
+  return osmosdr::stream::sptr( new stream_impl( args ) );
+}
+
+/* the arguments of the first source device among args, or of any */
+static std::string first_device( const std::vector< std::string > &arg_list )
+{
+  driver_registry &registry = driver_registry::get();
+
+  for (std::string arg : arg_list) {
+    dict_t dict = params_to_dict( arg );
+    for (dict_t::value_type &entry : dict) {
+      const driver_registry::driver_t *driver = registry.find( entry.first );
+      if ( driver && driver->make_source )
+        return arg;
+    }
+  }
+
+  device_enumerator devices( args_to_enum_timeout( arg_list ) );
+  for (const driver_registry::driver_t *driver : registry.all()) {
+    if ( driver->source_devices ) {
+      driver_registry::lister_t lister = driver->source_devices;
+      devices.add( driver->name, [lister]{ return lister( false ); } );
+    }
+  }
+
+  std::string dev = devices.first();
+  if ( dev.empty() )
+    throw std::runtime_error("No supported devices found (check the connection and/or udev rules).");
+
+  /* the options given apply to the device found as well */
+  return arg_list.size() ? dev + "," + arg_list[0] : dev;
+}
+
+stream_impl::stream_impl( const std::string &args ) :
+  _block( NULL ),
+  _dev( NULL ),
+  _running( false ),
+  _item_size( 0 ),
+  _has_anchor( false ),
+  _anchor_item( 0 ),
+  _anchor_rate( 0 ),
+  _freq( 0 )
+{
+  const std::string arg = first_device( args_to_vector( args ) );
+  dict_t dict = params_to_dict( arg );
+
+  driver_registry &registry = driver_registry::get();
+
+  for (dict_t::value_type &entry : dict) {
+    const driver_registry::driver_t *driver = registry.find( entry.first );
+    if ( driver && driver->make_source ) {
+      driver_registry::source_block_t src = driver->make_source( arg );
+      _holder = src.block;
+      _dev = src.iface;
+      break;
+    }
+  }
+
+  if ( ! _dev )
+    throw std::runtime_error("No source driver for '" + arg + "'.");
+
+  boost::shared_ptr< gr::sync_block > block =
+    boost::dynamic_pointer_cast< gr::sync_block >( _holder );
+  if ( ! block )
+    throw std::runtime_error( _holder->name() +
+                              " is a hierarchical block, it needs a flowgraph." );
+  _block = block.get();
+
+  _item_size = cpu_format_item_size( _dev->get_cpu_format() );
+
+  const size_t nchan = _dev->get_num_channels();
+  _detail = gr::make_block_detail( 0, nchan );
+  for (size_t chan = 0; chan < nchan; chan++) {
+    gr::buffer_sptr buffer = gr::make_buffer( STREAM_CHUNK, _item_size, block );
+    _detail->set_output( chan, buffer );
+    _readers.push_back( gr::buffer_add_reader( buffer, 0 ) );
+  }
+  _block->set_detail( _detail );
+
+  _freq = _dev->get_center_freq( 0 );
+
+  if ( ! _block->start() )
+    throw std::runtime_error("Failed to start " + _holder->name() + ".");
+
+  _running = true;
+}
+
+stream_impl::~stream_impl()
+{
+  close();
+}
+
+void stream_impl::close()
+{
+  std::lock_guard< std::mutex > lock( _read_mutex );
+
+  if ( ! _running )
+    return;
+
+  _running = false;
+  _block->stop();
+}
+
+size_t stream_impl::get_num_channels()
+{
+  return _dev->get_num_channels();
+}
+
+std::string stream_impl::get_cpu_format()
+{
+  return _dev->get_cpu_format();
+}
+
+size_t stream_impl::get_item_size()
+{
+  return _item_size;
+}
+
+bool stream_impl::time_at( uint64_t item, osmosdr::time_spec_t &time )
+{
+  if ( ! _has_anchor || item < _anchor_item ||
+       ( item > _anchor_item && _anchor_rate <= 0 ) )
+    return false;
+
+  time = _anchor_time;
+  if ( item > _anchor_item )
+    time += osmosdr::time_spec_t( double( item - _anchor_item ) / _anchor_rate );
+
+  return true;
+}
+
+void stream_impl::scan_tags( uint64_t first, size_t nitems, size_t done,
+                             osmosdr::rx_metadata_t &metadata )
+{
+  static const pmt::pmt_t TIME_KEY = pmt::string_to_symbol( "rx_time" );
+  static const pmt::pmt_t RATE_KEY = pmt::string_to_symbol( "rx_rate" );
+  static const pmt::pmt_t FREQ_KEY = pmt::string_to_symbol( "rx_freq" );
+
+  std::vector< gr::tag_t > tags;
+  _readers[0]->get_tags_in_range( tags, first, first + nitems, _block->unique_id() );
+  std::sort( tags.begin(), tags.end(), gr::tag_t::offset_compare );
+
+  for (const gr::tag_t &tag : tags) {
+    const size_t index = done + ( tag.offset - first );
+
+    if ( pmt::eq( tag.key, RATE_KEY ) ) {
+      _anchor_rate = pmt::to_double( tag.value );
+    } else if ( pmt::eq( tag.key, FREQ_KEY ) ) {
+      _freq = pmt::to_double( tag.value );
+      if ( 0 == index )
+        metadata.freq = _freq;
+    } else if ( pmt::eq( tag.key, TIME_KEY ) ) {
+      _anchor_time = osmosdr::time_spec_t(
+        time_t( pmt::to_uint64( pmt::tuple_ref( tag.value, 0 ) ) ),
+        pmt::to_double( pmt::tuple_ref( tag.value, 1 ) ) );
+      _anchor_item = tag.offset;
+
+      if ( 0 == index ) {
+        metadata.has_time_spec = true;
+        metadata.time_spec = _anchor_time;
+      } else if ( _has_anchor && ! metadata.anchored ) {
+        metadata.anchored = true;
+        metadata.anchor_index = index;
+      }
+      _has_anchor = true;
+    }
+  }
+}
+
+size_t stream_impl::read( const std::vector< void * > &buffs, size_t nitems,
+                          double timeout, osmosdr::rx_metadata_t &metadata )
+{
+  std::lock_guard< std::mutex > lock( _read_mutex );
+
+  metadata = osmosdr::rx_metadata_t();
+
+  if ( ! _running )
+    return 0;
+
+  if ( buffs.size() != _readers.size() )
+    throw std::runtime_error("Expected one buffer per channel.");
+
+  const std::chrono::steady_clock::time_point deadline =
+    std::chrono::steady_clock::now() +
+    std::chrono::duration_cast< std::chrono::steady_clock::duration >(
+      std::chrono::duration< double >( timeout ) );
+
+  /* from the previous tags, unless the first item is tagged again */
+  metadata.has_time_spec = time_at( _block->nitems_written( 0 ), metadata.time_spec );
+  metadata.freq = _freq;
+
+  gr_vector_const_void_star inputs;
+  gr_vector_void_star outputs( buffs.size() );
+  size_t done = 0;
+
+  /* work() may rely on the limits the scheduler would respect, e.g. the
+   * bladeRF buffers are sized for max_noutput_items() */
+  size_t chunk = STREAM_CHUNK;
+  if ( _block->is_set_max_noutput_items() && _block->max_noutput_items() > 0 )
+    chunk = std::min( chunk, size_t(_block->max_noutput_items()) );
+
+  const size_t multiple = std::max( _block->output_multiple(), 1 );
+  chunk = std::max( chunk - chunk % multiple, multiple );
+
+  while ( done < nitems ) {
+    for (size_t chan = 0; chan < buffs.size(); chan++)
+      outputs[chan] = (char *)buffs[chan] + done * _item_size;
+
+    const uint64_t first = _block->nitems_written( 0 );
+    const int n = std::min( nitems - done, chunk ) / multiple * multiple;
+    if ( ! n ) /* less room left than a single output_multiple() */
+      break;
+
+    int produced;
+    try {
+      produced = _block->work( n, inputs, outputs );
+    } catch ( const std::exception &e ) {
+      /* the scheduler would stop the flowgraph on this */
+      std::cerr << _holder->name() << ": " << e.what() << std::endl;
+      produced = gr::block::WORK_DONE;
+    }
+
+    if ( gr::block::WORK_CALLED_PRODUCE == produced ) {
+      produced = int( _block->nitems_written( 0 ) - first );
+    } else if ( produced > 0 ) {
+      _detail->produce_each( produced );
+    }
+
+    if ( produced < 0 ) {
+      metadata.end_of_stream = true;
+      break;
+    }
+
+    if ( produced > 0 ) {
+      scan_tags( first, produced, done, metadata );
+
+      for (size_t chan = 0; chan < _readers.size(); chan++) {
+        _readers[chan]->update_read_pointer( produced );
+        _detail->output( chan )->prune_tags( first + produced );
+      }
+
+      done += produced;
+    }
+
+    if ( std::chrono::steady_clock::now() >= deadline )
+      break;
+  }
+
+  return done;
+}
+
+osmosdr::meta_range_t stream_impl::get_sample_rates()
+{
+  return _dev->get_sample_rates();
+}
+
+double stream_impl::set_sample_rate( double rate )
+{
+  return _dev->set_sample_rate( rate );
+}
+
+double stream_impl::get_sample_rate()
+{
+  return _dev->get_sample_rate();
+}
+
+osmosdr::freq_range_t stream_impl::get_freq_range( size_t chan )
+{
+  return _dev->get_freq_range( chan );
+}
+
+double stream_impl::set_center_freq( double freq, size_t chan )
+{
+  return _dev->set_center_freq( freq, chan );
+}
+
+double stream_impl::get_center_freq( size_t chan )
+{
+  return _dev->get_center_freq( chan );
+}
+
+osmosdr::gain_range_t stream_impl::get_gain_range( size_t chan )
+{
+  return _dev->get_gain_range( chan );
+}
+
+bool stream_impl::set_gain_mode( bool automatic, size_t chan )
+{
+  return _dev->set_gain_mode( automatic, chan );
+}
+
+double stream_impl::set_gain( double gain, size_t chan )
+{
+  return _dev->set_gain( gain, chan );
+}
+
+double stream_impl::get_gain( size_t chan )
+{
+  return _dev->get_gain( chan );
+}
+
+std::string stream_impl::set_antenna( const std::string &antenna, size_t chan )
+{
+  return _dev->set_antenna( antenna, chan );
+}
+
+std::string stream_impl::get_antenna( size_t chan )
+{
+  return _dev->get_antenna( chan );
+}
+
+double stream_impl::set_bandwidth( double bandwidth, size_t chan )
+{
+  return _dev->set_bandwidth( bandwidth, chan );
+}
+
+double stream_impl::get_bandwidth( size_t chan )
+{
+  return _dev->get_bandwidth( chan );
+}
+
+osmosdr::stream_stats_t stream_impl::get_stream_stats( size_t chan )
+{
+  return _dev->get_stream_stats( chan );
+}
@@ -0,0 +1,95 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_STREAM_IMPL_H
+#define INCLUDED_OSMOSDR_STREAM_IMPL_H
+
+#include <mutex>
+
+#include <osmosdr/stream.h>
+
+#include <gnuradio/sync_block.h>
+#include <gnuradio/block_detail.h>
+#include <gnuradio/buffer.h>
+
+#include "source_iface.h"
+
+class stream_impl : public osmosdr::stream
+{
+public:
+  stream_impl( const std::string & args );
+  ~stream_impl();
+
+  size_t get_num_channels( void );
+  std::string get_cpu_format( void );
+  size_t get_item_size( void );
+
+  size_t read( const std::vector< void * > &buffs, size_t nitems,
+               double timeout, osmosdr::rx_metadata_t &metadata );
+  void close( void );
+
+  osmosdr::meta_range_t get_sample_rates( void );
+  double set_sample_rate( double rate );
+  double get_sample_rate( void );
+
+  osmosdr::freq_range_t get_freq_range( size_t chan = 0 );
+  double set_center_freq( double freq, size_t chan = 0 );
+  double get_center_freq( size_t chan = 0 );
+
+  osmosdr::gain_range_t get_gain_range( size_t chan = 0 );
+  bool set_gain_mode( bool automatic, size_t chan = 0 );
+  double set_gain( double gain, size_t chan = 0 );
+  double get_gain( size_t chan = 0 );
+
+  std::string set_antenna( const std::string & antenna, size_t chan = 0 );
+  std::string get_antenna( size_t chan = 0 );
+
+  double set_bandwidth( double bandwidth, size_t chan = 0 );
+  double get_bandwidth( size_t chan = 0 );
+
+  osmosdr::stream_stats_t get_stream_stats( size_t chan = 0 );
+
+private:
+  bool time_at( uint64_t item, osmosdr::time_spec_t &time );
+  void scan_tags( uint64_t first, size_t nitems, size_t done,
+                  osmosdr::rx_metadata_t &metadata );
+
+  gr::basic_block_sptr _holder;   /**< keeps the driver alive */
+  gr::sync_block *_block;
+  source_iface *_dev;
+
+  /* stand in for the flowgraph buffers, they only carry the tags */
+  gr::block_detail_sptr _detail;
+  std::vector< gr::buffer_reader_sptr > _readers;
+
+  std::mutex _read_mutex;   /**< one read() at a time, and close() */
+  bool _running;
+  size_t _item_size;
+
+  /* the latest rx_time and rx_freq tags of channel 0 */
+  bool _has_anchor;
+  uint64_t _anchor_item;
+  osmosdr::time_spec_t _anchor_time;
+  double _anchor_rate;
+  double _freq;
+};
+
+#endif /* INCLUDED_OSMOSDR_STREAM_IMPL_H */
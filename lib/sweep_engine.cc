@@ -0,0 +1,127 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#include "sweep_engine.h"
+
+sweep_engine::sweep_engine( rx_tagger *tagger, const tuner_t &tuner ) :
+  _tagger( tagger ),
+  _tuner( tuner ),
+  _pending( false ),
+  _next_dwell( 0 ),
+  _next_settle( 0 ),
+  _active( false ),
+  _dwell( 0 ),
+  _settle( 0 ),
+  _index( 0 ),
+  _settling( false ),
+  _remaining( 0 )
+{
+}
+
+void sweep_engine::set( const std::vector< double > &freqs, size_t dwell, size_t settle )
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _next_freqs = freqs;
+  _next_dwell = std::max< size_t >( dwell, 1 );
+  _next_settle = settle;
+  _pending = true;
+}
+
+void sweep_engine::clear()
+{
+  std::lock_guard< std::mutex > lock( _mutex );
+  _next_freqs.clear();
+  _pending = true;
+}
+
+void sweep_engine::retune( uint64_t next, size_t unread )
+{
+  const size_t held = _tuner( _freqs[ _index ] );
+
+  /* the items after the dwell were received at the old frequency as well */
+  _settling = true;
+  _remaining = _settle + held + unread;
+
+  /* overrides the retag() of the tuner, the settling items are dropped */
+  if ( _tagger )
+    _tagger->retag_at( next );
+}
+
+int sweep_engine::sweep( gr::block *block, char *out, int nitems, size_t item_size )
+{
+  const uint64_t first = block->nitems_written( 0 );
+
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    if ( _pending ) {
+      _pending = false;
+      _freqs.swap( _next_freqs );
+      _next_freqs.clear();
+      _dwell = _next_dwell;
+      _settle = _next_settle;
+      _index = 0;
+      _active = ! _freqs.empty();
+
+      if ( _active )
+        retune( first, nitems );
+    }
+  }
+
+  if ( ! _active )
+    return nitems;
+
+  size_t in = 0, kept = 0;
+
+  while ( in < size_t(nitems) ) {
+    const size_t n = std::min( _remaining, size_t(nitems) - in );
+
+    if ( ! _settling ) {
+      if ( kept != in )
+        memmove( out + kept * item_size, out + in * item_size, n * item_size );
+      kept += n;
+    }
+
+    in += n;
+    _remaining -= n;
+
+    if ( _remaining )
+      continue;
+
+    if ( _settling ) {
+      _settling = false;
+      _remaining = _dwell;
+    } else {
+      _index = ( _index + 1 ) % _freqs.size();
+      retune( first + kept, nitems - in );
+    }
+  }
+
+  return kept;
+}
@@ -0,0 +1,106 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_SWEEP_ENGINE_H
+#define INCLUDED_OSMOSDR_SWEEP_ENGINE_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <gnuradio/block.h>
+
+#include <osmosdr/api.h>
+
+#include "rx_tagger.h"
+
+/*!
+ * Frequency sweeps run by a source from its work() thread.
+ *
+ * The driver passes the items its work() wrote to process(), which drops
+ * the ones received while the tuner settles and retunes to the next
+ * frequency once the dwell at the current one is complete. The first item
+ * of every dwell is anchored in the rx_tagger, so its rx_time/rx_freq tags
+ * mark where the samples of the new frequency start.
+ *
+ * The tuner returns how many items the driver holds already, which were
+ * received at the old frequency and are dropped in addition to the settle
+ * time. Transfers queued on the device side still have to be covered by
+ * the settle time.
+ *
+ * set() and clear() may be called from any thread, process() only from
+ * work().
+ */
+class OSMOSDR_API sweep_engine
+{
+public:
+  /*! retunes to freq, returns the items already held by the driver */
+  typedef std::function< size_t( double freq ) > tuner_t;
+
+  sweep_engine( rx_tagger *tagger, const tuner_t &tuner );
+
+  /*!
+   * Visit freqs in turn for dwell items each, after dropping settle items
+   * following every retune. Restarts from the first frequency.
+   */
+  void set( const std::vector< double > &freqs, size_t dwell, size_t settle );
+
+  /*! stop sweeping and stay at the current frequency */
+  void clear();
+
+  /*!
+   * Sweep over the nitems items of item_size bytes work() wrote to out,
+   * moving the items to keep to its front.
+   * \return the number of items kept
+   */
+  int process( gr::block *block, void *out, int nitems, size_t item_size )
+  {
+    if ( ! _active && ! _pending )
+      return nitems;
+
+    return sweep( block, (char *)out, nitems, item_size );
+  }
+
+private:
+  int sweep( gr::block *block, char *out, int nitems, size_t item_size );
+  void retune( uint64_t next, size_t unread );
+
+  rx_tagger *_tagger;
+  tuner_t _tuner;
+
+  std::mutex _mutex;
+  std::atomic< bool > _pending;   /**< set() since the last process() */
+  std::vector< double > _next_freqs;
+  size_t _next_dwell;
+  size_t _next_settle;
+
+  /* owned by process() */
+  bool _active;
+  std::vector< double > _freqs;
+  size_t _dwell;
+  size_t _settle;
+  size_t _index;                  /**< of the current frequency */
+  bool _settling;
+  size_t _remaining;              /**< items left to settle or dwell */
+};
+
+#endif /* INCLUDED_OSMOSDR_SWEEP_ENGINE_H */
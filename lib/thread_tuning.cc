@@ -0,0 +1,127 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <boost/lexical_cast.hpp>
+
+#include <gnuradio/thread/thread.h>
+
+#include "arg_helpers.h"
+#include "buffer_pool.h"
+#include "thread_tuning.h"
+
+thread_tuning::thread_tuning( const std::string &args ) :
+  _cpu( -1 ),
+  _rt_prio( 0 ),
+  _numa( false ),
+  _hugepages( false ),
+  _warned( false ),
+  _applied( false )
+{
+  dict_t dict = params_to_dict( args );
+
+  if ( dict.count( "cpu" ) )
+    _cpu = boost::lexical_cast< int >( dict["cpu"] );
+
+  if ( dict.count( "rt_prio" ) )
+    _rt_prio = boost::lexical_cast< int >( dict["rt_prio"] );
+
+  if ( dict.count( "numa" ) )
+    _numa = boost::lexical_cast< bool >( dict["numa"] );
+
+  if ( dict.count( "hugepages" ) )
+    _hugepages = boost::lexical_cast< bool >( dict["hugepages"] );
+
+  _enabled = _cpu >= 0 || _rt_prio > 0;
+}
+
+void thread_tuning::apply()
+{
+  if ( _cpu >= 0 )
+    gr::thread::thread_bind_to_processor( _cpu );
+
+  if ( _rt_prio <= 0 )
+    return;
+
+#ifdef _WIN32
+  const bool ok = SetThreadPriority( GetCurrentThread(),
+                                     THREAD_PRIORITY_TIME_CRITICAL );
+  const char *error = "SetThreadPriority failed";
+#else
+  struct sched_param param;
+  memset( &param, 0, sizeof(param) );
+  param.sched_priority = _rt_prio;
+
+  const int ret = pthread_setschedparam( pthread_self(), SCHED_FIFO, &param );
+  const bool ok = ( 0 == ret );
+  const char *error = strerror( ret );
+#endif
+
+  /* once, the threads of every restart would repeat it */
+  if ( ! ok && ! _warned ) {
+    _warned = true;
+    std::cerr << "Failed to set real-time priority " << _rt_prio
+              << " (" << error << ")" << std::endl;
+  }
+}
+
+void thread_tuning::allocate( const std::function< void() > &alloc )
+{
+  if ( ! _numa || _cpu < 0 ) {
+    buffer_pool::hugepage_scope scope( _hugepages );
+    alloc();
+    return;
+  }
+
+  const int cpu = _cpu;
+  const bool hugepages = _hugepages;
+  std::exception_ptr error;
+
+  std::thread thread( [cpu, hugepages, &alloc, &error] {
+    try {
+      gr::thread::thread_bind_to_processor( cpu );
+      buffer_pool::hugepage_scope scope( hugepages );
+      alloc();
+    } catch ( ... ) {
+      error = std::current_exception();
+    }
+  } );
+  thread.join();
+
+  if ( error )
+    std::rethrow_exception( error );
+}
@@ -0,0 +1,78 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Free Software Foundation, Inc.
+ *
+ * This file is part of gr-osmosdr
+ *
+ * gr-osmosdr is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-osmosdr is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-osmosdr; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef INCLUDED_OSMOSDR_THREAD_TUNING_H
+#define INCLUDED_OSMOSDR_THREAD_TUNING_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+
+#include <osmosdr/api.h>
+
+/*!
+ * Scheduling of the thread feeding the ring of a driver, from the cpu=,
+ * rt_prio=, numa= and hugepages= device arguments.
+ *
+ * cpu=N binds the thread to a core, rt_prio=N runs it SCHED_FIFO at that
+ * priority (which needs CAP_SYS_NICE or an rtprio limit), and numa=1
+ * allocates the ring from the given core, so that its pages are local to
+ * it under the first touch policy. hugepages=1 backs the ring with huge
+ * pages of the buffer_pool.
+ *
+ * Drivers call apply() from their own reader threads and apply_once()
+ * from the callbacks of threads owned by the device library.
+ */
+class OSMOSDR_API thread_tuning
+{
+public:
+  explicit thread_tuning( const std::string &args );
+
+  /*! configure the calling thread */
+  void apply();
+
+  /*! configure the calling thread, once per reset() */
+  void apply_once()
+  {
+    if ( _enabled && ! _applied.exchange( true ) )
+      apply();
+  }
+
+  /*! the next apply_once() configures the thread again */
+  void reset() { _applied.store( false ); }
+
+  /*!
+   * run alloc on a thread bound to the core with numa=1, or right away,
+   * in a buffer_pool::hugepage_scope with hugepages=1
+   */
+  void allocate( const std::function< void() > &alloc );
+
+private:
+  bool _enabled;
+  int _cpu;
+  int _rt_prio;
+  bool _numa;
+  bool _hugepages;
+  bool _warned;
+  std::atomic< bool > _applied;
+};
+
+#endif /* INCLUDED_OSMOSDR_THREAD_TUNING_H */
@@ -422,3 +422,13 @@ void uhd_sink_c::set_time_unknown_pps(const osmosdr::time_spec_t &time_spec)
 {
   _snk->set_time_unknown_pps( uhd::time_spec_t( time_spec.get_full_secs(), time_spec.get_frac_secs() ) );
 }
+
+void uhd_sink_c::set_command_time(const osmosdr::time_spec_t &time_spec, size_t mboard)
+{
+  _snk->set_command_time( uhd::time_spec_t( time_spec.get_full_secs(), time_spec.get_frac_secs() ), mboard );
+}
+
+void uhd_sink_c::clear_command_time(size_t mboard)
+{
+  _snk->clear_command_time( mboard );
+}
@@ -35,24 +35,10 @@ uhd_source_c_sptr make_uhd_source_c(const std::string &args)
   return gnuradio::get_initial_sptr(new uhd_source_c(args));
 }
 
-static size_t parse_nchan(const std::string &args)
-{
-  size_t nchan = 1;
-
-  dict_t dict = params_to_dict(args);
-
-  if (dict.count("nchan"))
-    nchan = boost::lexical_cast< size_t >( dict["nchan"] );
-
-  return nchan;
-}
-
 uhd_source_c::uhd_source_c(const std::string &args) :
     gr::hier_block2("uhd_source_c",
                    gr::io_signature::make(0, 0, 0),
-                   gr::io_signature::make(parse_nchan(args),
-                                          parse_nchan(args),
-                                          sizeof(gr_complex))),
+                   args_to_io_signature(args, true)),
     _center_freq(0.0f),
     _freq_corr(0.0f),
     _lo_offset(0.0f)
@@ -114,14 +100,9 @@ uhd_source_c::uhd_source_c(const std::string &args) :
 
   if (0.0 != _lo_offset)
     std::cerr << "-- Using LO offset of " << _lo_offset << " Hz." << std::endl;
-#if 0
-  std::vector<int> sizes = _src->output_signature()->sizeof_stream_items();
-
-  while ( sizes.size() > nchan )
-    sizes.erase( sizes.end() );
-  // TODO: setting the output signature is broken for hier blocks (gnuradio bug #719)
-  set_output_signature( gr::io_signature::makev( nchan, nchan, sizes ) );
-#endif
+
+  /* the output signature has been sized for cpu_format already */
+  _cpu_format = stream_args.cpu_format;
   for ( size_t i = 0; i < nchan; i++ )
     connect( _src, i, self(), i );
 }
@@ -180,6 +161,11 @@ std::string uhd_source_c::name()
   return mboard_name;
 }
 
+std::string uhd_source_c::get_cpu_format()
+{
+  return _cpu_format;
+}
+
 size_t uhd_source_c::get_num_channels()
 {
 //  return _src->get_device()->get_rx_num_channels();
@@ -454,3 +440,19 @@ void uhd_source_c::set_time_unknown_pps(const osmosdr::time_spec_t &time_spec)
 {
   _src->set_time_unknown_pps( uhd::time_spec_t( time_spec.get_full_secs(), time_spec.get_frac_secs() ) );
 }
+
+void uhd_source_c::set_command_time(const osmosdr::time_spec_t &time_spec, size_t mboard)
+{
+  _src->set_command_time( uhd::time_spec_t( time_spec.get_full_secs(), time_spec.get_frac_secs() ), mboard );
+}
+
+void uhd_source_c::clear_command_time(size_t mboard)
+{
+  _src->clear_command_time( mboard );
+}
+
+bool uhd_source_c::set_start_time(const osmosdr::time_spec_t &time_spec)
+{
+  _src->set_start_time( uhd::time_spec_t( time_spec.get_full_secs(), time_spec.get_frac_secs() ) );
+  return true;
+}
@@ -48,6 +48,7 @@ public:
   std::string name();
 
   size_t get_num_channels( void );
+  std::string get_cpu_format( void );
 
   osmosdr::meta_range_t get_sample_rates( void );
   double set_sample_rate( double rate );
@@ -94,11 +95,15 @@ public:
   void set_time_now(const ::osmosdr::time_spec_t &time_spec, size_t mboard = 0);
   void set_time_next_pps(const ::osmosdr::time_spec_t &time_spec);
   void set_time_unknown_pps(const ::osmosdr::time_spec_t &time_spec);
+  void set_command_time(const ::osmosdr::time_spec_t &time_spec, size_t mboard = 0);
+  void clear_command_time(size_t mboard = 0);
+  bool set_start_time(const ::osmosdr::time_spec_t &time_spec);
 
 private:
   double _center_freq;
   double _freq_corr;
   double _lo_offset;
+  std::string _cpu_format;
   gr::uhd::usrp_source::sptr _src;
 };
 
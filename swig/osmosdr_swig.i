@@ -14,6 +14,7 @@
 #include "osmosdr/device.h"
 #include "osmosdr/source.h"
 #include "osmosdr/sink.h"
+#include "osmosdr/stream.h"
 %}
 
 // Workaround for a SWIG 2.0.4 bug with templates. Probably needs to be looked in to.
@@ -25,6 +26,81 @@
 #endif
 %}
 
+// The calls below wait for the device: USB control transfers, network
+// round trips, tuning. They run without the GIL, so other Python threads
+// keep going meanwhile; the exceptions they throw are raised once it is
+// held again.
+%include "exception.i"
+
+%define OSMOSDR_RELEASE_GIL(NAME)
+%exception NAME {
+    {
+        PyThreadState *_save = PyEval_SaveThread();
+        try {
+            $action
+        } catch (const std::invalid_argument &e) {
+            PyEval_RestoreThread(_save);
+            SWIG_exception(SWIG_ValueError, e.what());
+        } catch (const std::out_of_range &e) {
+            PyEval_RestoreThread(_save);
+            SWIG_exception(SWIG_IndexError, e.what());
+        } catch (const std::exception &e) {
+            PyEval_RestoreThread(_save);
+            SWIG_exception(SWIG_RuntimeError, e.what());
+        } catch (...) {
+            PyEval_RestoreThread(_save);
+            SWIG_exception(SWIG_UnknownError, "unknown exception");
+        }
+        PyEval_RestoreThread(_save);
+    }
+}
+%enddef
+
+%define OSMOSDR_RELEASE_GIL_CONTROL(CLASS)
+OSMOSDR_RELEASE_GIL(CLASS::make);
+OSMOSDR_RELEASE_GIL(CLASS::set_sample_rate);
+OSMOSDR_RELEASE_GIL(CLASS::set_center_freq);
+OSMOSDR_RELEASE_GIL(CLASS::set_freq_corr);
+OSMOSDR_RELEASE_GIL(CLASS::set_gain_mode);
+OSMOSDR_RELEASE_GIL(CLASS::set_gain);
+OSMOSDR_RELEASE_GIL(CLASS::set_if_gain);
+OSMOSDR_RELEASE_GIL(CLASS::set_bb_gain);
+OSMOSDR_RELEASE_GIL(CLASS::set_antenna);
+OSMOSDR_RELEASE_GIL(CLASS::set_dc_offset_mode);
+OSMOSDR_RELEASE_GIL(CLASS::set_dc_offset);
+OSMOSDR_RELEASE_GIL(CLASS::set_iq_balance_mode);
+OSMOSDR_RELEASE_GIL(CLASS::set_iq_balance);
+OSMOSDR_RELEASE_GIL(CLASS::set_bandwidth);
+OSMOSDR_RELEASE_GIL(CLASS::set_time_source);
+OSMOSDR_RELEASE_GIL(CLASS::set_clock_source);
+OSMOSDR_RELEASE_GIL(CLASS::set_clock_rate);
+OSMOSDR_RELEASE_GIL(CLASS::get_clock_rate);
+OSMOSDR_RELEASE_GIL(CLASS::get_time_now);
+OSMOSDR_RELEASE_GIL(CLASS::get_time_last_pps);
+OSMOSDR_RELEASE_GIL(CLASS::set_time_now);
+OSMOSDR_RELEASE_GIL(CLASS::set_time_next_pps);
+OSMOSDR_RELEASE_GIL(CLASS::set_time_unknown_pps);
+%enddef
+
+OSMOSDR_RELEASE_GIL(osmosdr::device::find);
+
+OSMOSDR_RELEASE_GIL_CONTROL(osmosdr::source);
+OSMOSDR_RELEASE_GIL(osmosdr::source::seek);
+OSMOSDR_RELEASE_GIL(osmosdr::source::seek_time);
+OSMOSDR_RELEASE_GIL(osmosdr::source::set_start_time);
+OSMOSDR_RELEASE_GIL(osmosdr::source::set_sweep);
+
+OSMOSDR_RELEASE_GIL_CONTROL(osmosdr::sink);
+
+OSMOSDR_RELEASE_GIL(osmosdr::stream::open);
+OSMOSDR_RELEASE_GIL(osmosdr::stream::close);
+OSMOSDR_RELEASE_GIL(osmosdr::stream::set_sample_rate);
+OSMOSDR_RELEASE_GIL(osmosdr::stream::set_center_freq);
+OSMOSDR_RELEASE_GIL(osmosdr::stream::set_gain_mode);
+OSMOSDR_RELEASE_GIL(osmosdr::stream::set_gain);
+OSMOSDR_RELEASE_GIL(osmosdr::stream::set_antenna);
+OSMOSDR_RELEASE_GIL(osmosdr::stream::set_bandwidth);
+
 %template(string_vector_t) std::vector<std::string>;
 
 //%template(size_vector_t) std::vector<size_t>;
@@ -47,6 +123,9 @@
 
 %include <osmosdr/time_spec.h>
 
+%template(uint64_vector_t) std::vector<uint64_t>; //define before stream_stats
+%include <osmosdr/stream_stats.h>
+
 %extend osmosdr::time_spec_t{
     osmosdr::time_spec_t __add__(const osmosdr::time_spec_t &what)
     {
@@ -76,6 +155,43 @@ BASE_NAME = BASE_NAME.make;
 OSMOSDR_SWIG_BLOCK_MAGIC2(osmosdr,source);
 OSMOSDR_SWIG_BLOCK_MAGIC2(osmosdr,sink);
 
+// read() takes raw pointers, Python reads into objects with the buffer
+// protocol instead, e.g. numpy arrays of one row per channel
+%ignore osmosdr::stream::read;
+%template(stream_sptr) boost::shared_ptr<osmosdr::stream>;
+%include "osmosdr/stream.h"
+
+%extend osmosdr::stream{
+    size_t read_into(PyObject *buff, double timeout, osmosdr::rx_metadata_t &metadata)
+    {
+        Py_buffer view;
+        if (PyObject_GetBuffer(buff, &view, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS) != 0)
+            throw std::runtime_error("read_into() needs a writable contiguous buffer");
+
+        const size_t nchan = $self->get_num_channels();
+        const size_t nitems = view.len / $self->get_item_size() / nchan;
+
+        std::vector<void *> buffs;
+        for (size_t chan = 0; chan < nchan; chan++)
+            buffs.push_back((char *)view.buf + chan * nitems * $self->get_item_size());
+
+        // the driver may block, other Python threads keep running meanwhile
+        size_t done = 0;
+        PyThreadState *state = PyEval_SaveThread();
+        try {
+            done = $self->read(buffs, nitems, timeout, metadata);
+        } catch (...) {
+            PyEval_RestoreThread(state);
+            PyBuffer_Release(&view);
+            throw;
+        }
+        PyEval_RestoreThread(state);
+
+        PyBuffer_Release(&view);
+        return done;
+    }
+};
+
 %{
 static const size_t ALL_MBOARDS = osmosdr::ALL_MBOARDS;
 %}